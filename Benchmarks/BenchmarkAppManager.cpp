@@ -0,0 +1,85 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "BenchmarkAppManager.h"
+
+#include <map>
+#include <list>
+#include <string>
+#include <cassert>
+
+#include <QtCore/QStringList>
+
+#include "Engine/LibraryBinary.h"
+
+#include "BenchmarkEffects.h"
+
+NATRON_NAMESPACE_ENTER
+
+BenchmarkAppManager::BenchmarkAppManager()
+    : AppManager()
+{
+}
+
+BenchmarkAppManager::~BenchmarkAppManager()
+{
+}
+
+template <typename PLUGIN>
+void
+BenchmarkAppManager::registerBenchmarkPlugin()
+{
+    // Same as AppManager::registerBuiltInPlugin(), which is only instantiated in the engine
+    EffectInstancePtr node( PLUGIN::BuildEffect( NodePtr() ) );
+    std::map<std::string, void (*)()> functions;
+
+    functions.insert( std::make_pair("BuildEffect", ( void (*)() ) & PLUGIN::BuildEffect) );
+    LibraryBinary *binary = new LibraryBinary(functions);
+    assert(binary);
+
+    std::list<std::string> grouping;
+    node->getPluginGrouping(&grouping);
+    QStringList qgrouping;
+
+    for (std::list<std::string>::iterator it = grouping.begin(); it != grouping.end(); ++it) {
+        qgrouping.push_back( QString::fromUtf8( it->c_str() ) );
+    }
+
+    registerPlugin(QString(), qgrouping, QString::fromUtf8( node->getPluginID().c_str() ), QString::fromUtf8( node->getPluginLabel().c_str() ),
+                   QString(), QStringList(), false, false, binary, node->renderThreadSafety() == eRenderSafetyUnsafe, node->getMajorVersion(), node->getMinorVersion(), false);
+}
+
+void
+BenchmarkAppManager::loadBuiltinNodePlugins(IOPluginsMap* readersMap,
+                                            IOPluginsMap* writersMap)
+{
+    AppManager::loadBuiltinNodePlugins(readersMap, writersMap);
+
+    registerBenchmarkPlugin<BenchmarkGenerator>();
+    registerBenchmarkPlugin<BenchmarkFilter>();
+    registerBenchmarkPlugin<BenchmarkMerge>();
+    registerBenchmarkPlugin<BenchmarkShape>();
+}
+
+NATRON_NAMESPACE_EXIT
@@ -0,0 +1,61 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef Benchmarks_BenchmarkAppManager_h
+#define Benchmarks_BenchmarkAppManager_h
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include "Engine/AppManager.h"
+#include "Engine/EngineFwd.h"
+
+NATRON_NAMESPACE_ENTER
+
+/**
+ * @brief The application manager of the benchmark harness: a background AppManager that also registers
+ * the synthetic effects of BenchmarkEffects.h, so that the generated projects never depend on plug-ins.
+ **/
+class BenchmarkAppManager
+    : public AppManager
+{
+public:
+
+    BenchmarkAppManager();
+
+    virtual ~BenchmarkAppManager();
+
+protected:
+
+    virtual void loadBuiltinNodePlugins(IOPluginsMap* readersMap,
+                                        IOPluginsMap* writersMap) OVERRIDE FINAL;
+
+private:
+
+    template <typename PLUGIN>
+    void registerBenchmarkPlugin();
+};
+
+NATRON_NAMESPACE_EXIT
+
+#endif // Benchmarks_BenchmarkAppManager_h
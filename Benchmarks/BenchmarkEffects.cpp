@@ -0,0 +1,434 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "BenchmarkEffects.h"
+
+#include <algorithm> // min, max, fill, copy, sort
+#include <cmath>
+#include <cassert>
+
+#include <QtCore/QMutex>
+
+#include "Engine/AppManager.h"
+#include "Engine/Image.h"
+#include "Engine/KnobTypes.h"
+#include "Engine/ViewIdx.h"
+
+NATRON_NAMESPACE_ENTER
+
+namespace {
+QMutex renderCountMutex;
+int renderCount = 0;
+
+bool
+isFloatRGBA(const Image* image)
+{
+    return image->getComponentsCount() == 4 && image->getBitDepth() == eImageBitDepthFloat;
+}
+
+/**
+ * @brief Copies the row y of src between x1 and x2 to buf, with transparent black outside of the image bounds.
+ **/
+void
+fetchRow(const Image* src,
+         const Image::ReadAccess& acc,
+         int y,
+         int x1,
+         int x2,
+         float* buf)
+{
+    std::fill(buf, buf + (x2 - x1) * 4, 0.f);
+    if (!src) {
+        return;
+    }
+    const RectI& bounds = src->getBounds();
+    if ( (y < bounds.y1) || (y >= bounds.y2) ) {
+        return;
+    }
+    int sx1 = std::max(x1, bounds.x1);
+    int sx2 = std::min(x2, bounds.x2);
+    if (sx1 >= sx2) {
+        return;
+    }
+    const float* pix = (const float*)acc.pixelAt(sx1, y);
+    assert(pix);
+    std::copy(pix, pix + (sx2 - sx1) * 4, buf + (sx1 - x1) * 4);
+}
+} // anon namespace
+
+BenchmarkEffect::BenchmarkEffect(NodePtr node)
+    : EffectInstance(node)
+{
+    setSupportsRenderScaleMaybe(eSupportsYes);
+}
+
+BenchmarkEffect::~BenchmarkEffect()
+{
+}
+
+void
+BenchmarkEffect::addAcceptedComponents(int /*inputNb*/,
+                                       std::list<ImagePlaneDesc>* comps)
+{
+    comps->push_back( ImagePlaneDesc::getRGBAComponents() );
+}
+
+void
+BenchmarkEffect::addSupportedBitDepth(std::list<ImageBitDepthEnum>* depths) const
+{
+    depths->push_back(eImageBitDepthFloat);
+}
+
+bool
+BenchmarkEffect::isHostChannelSelectorSupported(bool* /*defaultR*/,
+                                                bool* /*defaultG*/,
+                                                bool* /*defaultB*/,
+                                                bool* /*defaultA*/) const
+{
+    return false;
+}
+
+int
+BenchmarkEffect::getRenderCount()
+{
+    QMutexLocker k(&renderCountMutex);
+
+    return renderCount;
+}
+
+void
+BenchmarkEffect::resetRenderCount()
+{
+    QMutexLocker k(&renderCountMutex);
+
+    renderCount = 0;
+}
+
+void
+BenchmarkEffect::incrementRenderCount()
+{
+    QMutexLocker k(&renderCountMutex);
+
+    ++renderCount;
+}
+
+BenchmarkGenerator::BenchmarkGenerator(NodePtr node)
+    : BenchmarkEffect(node)
+{
+}
+
+BenchmarkGenerator::~BenchmarkGenerator()
+{
+}
+
+void
+BenchmarkGenerator::initializeKnobs()
+{
+    KnobPagePtr page = AppManager::createKnob<KnobPage>( this, tr("Controls") );
+    KnobDoublePtr value = AppManager::createKnob<KnobDouble>( this, tr("Value") );
+
+    value->setName("value");
+    value->setDefaultValue(1.);
+    page->addKnob(value);
+    _value = value;
+}
+
+StatusEnum
+BenchmarkGenerator::render(const RenderActionArgs& args)
+{
+    incrementRenderCount();
+
+    const double value = _value.lock()->getValueAtTime(args.time);
+    const RectI format = getOutputFormat();
+    const double width = std::max(1, format.width() ) * args.mappedScale.x;
+    const double height = std::max(1, format.height() ) * args.mappedScale.y;
+
+    for (std::list<std::pair<ImagePlaneDesc, ImagePtr> >::const_iterator it = args.outputPlanes.begin(); it != args.outputPlanes.end(); ++it) {
+        if ( !isFloatRGBA( it->second.get() ) ) {
+            return eStatusFailed;
+        }
+        Image::WriteAccess acc = it->second->getWriteRights();
+        for (int y = args.roi.y1; y < args.roi.y2; ++y) {
+            float* dst = (float*)acc.pixelAt(args.roi.x1, y);
+            assert(dst);
+            const float g = value * (y + 0.5) / height;
+            for (int x = args.roi.x1; x < args.roi.x2; ++x, dst += 4) {
+                dst[0] = value * (x + 0.5) / width;
+                dst[1] = g;
+                dst[2] = value;
+                dst[3] = 1.f;
+            }
+        }
+    }
+
+    return eStatusOK;
+}
+
+BenchmarkFilter::BenchmarkFilter(NodePtr node)
+    : BenchmarkEffect(node)
+{
+}
+
+BenchmarkFilter::~BenchmarkFilter()
+{
+}
+
+void
+BenchmarkFilter::initializeKnobs()
+{
+    KnobPagePtr page = AppManager::createKnob<KnobPage>( this, tr("Controls") );
+    KnobDoublePtr gain = AppManager::createKnob<KnobDouble>( this, tr("Gain") );
+
+    gain->setName("gain");
+    gain->setDefaultValue(1.);
+    page->addKnob(gain);
+    _gain = gain;
+
+    KnobDoublePtr offset = AppManager::createKnob<KnobDouble>( this, tr("Offset") );
+    offset->setName("offset");
+    offset->setDefaultValue(0.);
+    page->addKnob(offset);
+    _offset = offset;
+}
+
+StatusEnum
+BenchmarkFilter::render(const RenderActionArgs& args)
+{
+    incrementRenderCount();
+
+    const float gain = _gain.lock()->getValueAtTime(args.time);
+    const float offset = _offset.lock()->getValueAtTime(args.time);
+    std::vector<float> row( (args.roi.x2 - args.roi.x1) * 4 );
+
+    for (std::list<std::pair<ImagePlaneDesc, ImagePtr> >::const_iterator it = args.outputPlanes.begin(); it != args.outputPlanes.end(); ++it) {
+        RectI roiPixel;
+        ImagePtr srcImg = getImage(0, args.time, args.mappedScale, args.view, NULL, &it->first, false /*mapToClipPrefs*/, true /*dontUpscale*/, eStorageModeRAM /*useOpenGL*/, 0 /*textureDepth*/, &roiPixel);
+        if ( !isFloatRGBA( it->second.get() ) || ( srcImg && !isFloatRGBA( srcImg.get() ) ) ) {
+            return eStatusFailed;
+        }
+        Image::ReadAccess srcAcc( srcImg.get() );
+        Image::WriteAccess acc = it->second->getWriteRights();
+        for (int y = args.roi.y1; y < args.roi.y2; ++y) {
+            fetchRow(srcImg.get(), srcAcc, y, args.roi.x1, args.roi.x2, &row.front());
+            float* dst = (float*)acc.pixelAt(args.roi.x1, y);
+            assert(dst);
+            const float* src = &row.front();
+            for (int x = args.roi.x1; x < args.roi.x2; ++x, dst += 4, src += 4) {
+                dst[0] = src[0] * gain + offset;
+                dst[1] = src[1] * gain + offset;
+                dst[2] = src[2] * gain + offset;
+                dst[3] = src[3];
+            }
+        }
+    }
+
+    return eStatusOK;
+}
+
+BenchmarkMerge::BenchmarkMerge(NodePtr node)
+    : BenchmarkEffect(node)
+{
+}
+
+BenchmarkMerge::~BenchmarkMerge()
+{
+}
+
+void
+BenchmarkMerge::initializeKnobs()
+{
+    KnobPagePtr page = AppManager::createKnob<KnobPage>( this, tr("Controls") );
+    KnobDoublePtr mix = AppManager::createKnob<KnobDouble>( this, tr("Mix") );
+
+    mix->setName("mix");
+    mix->setDefaultValue(1.);
+    page->addKnob(mix);
+    _mix = mix;
+}
+
+StatusEnum
+BenchmarkMerge::render(const RenderActionArgs& args)
+{
+    incrementRenderCount();
+
+    const float mix = _mix.lock()->getValueAtTime(args.time);
+    const int width = args.roi.x2 - args.roi.x1;
+    std::vector<float> rowB(width * 4);
+    std::vector<float> rowA(width * 4);
+
+    for (std::list<std::pair<ImagePlaneDesc, ImagePtr> >::const_iterator it = args.outputPlanes.begin(); it != args.outputPlanes.end(); ++it) {
+        RectI roiPixel;
+        ImagePtr bImg = getImage(0, args.time, args.mappedScale, args.view, NULL, &it->first, false /*mapToClipPrefs*/, true /*dontUpscale*/, eStorageModeRAM /*useOpenGL*/, 0 /*textureDepth*/, &roiPixel);
+        ImagePtr aImg = getImage(1, args.time, args.mappedScale, args.view, NULL, &it->first, false /*mapToClipPrefs*/, true /*dontUpscale*/, eStorageModeRAM /*useOpenGL*/, 0 /*textureDepth*/, &roiPixel);
+        if ( !isFloatRGBA( it->second.get() ) || ( bImg && !isFloatRGBA( bImg.get() ) ) || ( aImg && !isFloatRGBA( aImg.get() ) ) ) {
+            return eStatusFailed;
+        }
+        Image::ReadAccess bAcc( bImg.get() );
+        Image::ReadAccess aAcc( aImg.get() );
+        Image::WriteAccess acc = it->second->getWriteRights();
+        for (int y = args.roi.y1; y < args.roi.y2; ++y) {
+            fetchRow(bImg.get(), bAcc, y, args.roi.x1, args.roi.x2, &rowB.front());
+            fetchRow(aImg.get(), aAcc, y, args.roi.x1, args.roi.x2, &rowA.front());
+            float* dst = (float*)acc.pixelAt(args.roi.x1, y);
+            assert(dst);
+            const float* b = &rowB.front();
+            const float* a = &rowA.front();
+            for (int x = 0; x < width; ++x, dst += 4, a += 4, b += 4) {
+                const float oneMinusAlpha = 1.f - a[3];
+                for (int c = 0; c < 4; ++c) {
+                    const float over = a[c] + b[c] * oneMinusAlpha;
+                    dst[c] = b[c] + (over - b[c]) * mix;
+                }
+            }
+        }
+    }
+
+    return eStatusOK;
+}
+
+BenchmarkShape::BenchmarkShape(NodePtr node)
+    : BenchmarkEffect(node)
+{
+}
+
+BenchmarkShape::~BenchmarkShape()
+{
+}
+
+void
+BenchmarkShape::initializeKnobs()
+{
+    KnobPagePtr page = AppManager::createKnob<KnobPage>( this, tr("Controls") );
+    KnobDoublePtr value = AppManager::createKnob<KnobDouble>( this, tr("Value") );
+
+    value->setName("value");
+    value->setDefaultValue(1.);
+    page->addKnob(value);
+    _value = value;
+
+    // By default the control points are on a circle
+    for (int i = 0; i < kBenchmarkShapeControlPoints; ++i) {
+        KnobDoublePtr point = AppManager::createKnob<KnobDouble>( this, tr("Point %1").arg(i), 2 );
+        point->setName( QString::fromUtf8("point%1").arg(i).toStdString() );
+        double angle = 2. * M_PI * i / kBenchmarkShapeControlPoints;
+        point->setDefaultValue(500. + 200. * std::cos(angle), 0);
+        point->setDefaultValue(300. + 200. * std::sin(angle), 1);
+        page->addKnob(point);
+        _points.push_back(point);
+    }
+}
+
+KnobDoublePtr
+BenchmarkShape::getControlPointKnob(int index) const
+{
+    if ( (index < 0) || ( index >= (int)_points.size() ) ) {
+        return KnobDoublePtr();
+    }
+
+    return _points[index].lock();
+}
+
+StatusEnum
+BenchmarkShape::getRegionOfDefinition(U64 /*hash*/,
+                                      double time,
+                                      const RenderScale & /*scale*/,
+                                      ViewIdx /*view*/,
+                                      RectD* rod)
+{
+    rod->clear();
+    for (std::size_t i = 0; i < _points.size(); ++i) {
+        KnobDoublePtr point = _points[i].lock();
+        double x = point->getValueAtTime(time, 0);
+        double y = point->getValueAtTime(time, 1);
+        if (i == 0) {
+            rod->x1 = rod->x2 = x;
+            rod->y1 = rod->y2 = y;
+        } else {
+            rod->x1 = std::min(rod->x1, x);
+            rod->x2 = std::max(rod->x2, x);
+            rod->y1 = std::min(rod->y1, y);
+            rod->y2 = std::max(rod->y2, y);
+        }
+    }
+
+    return eStatusOK;
+}
+
+StatusEnum
+BenchmarkShape::render(const RenderActionArgs& args)
+{
+    incrementRenderCount();
+
+    const float value = _value.lock()->getValueAtTime(args.time);
+    const std::size_t nPoints = _points.size();
+    std::vector<double> xs(nPoints);
+    std::vector<double> ys(nPoints);
+
+    // The polygon in pixel coordinates
+    for (std::size_t i = 0; i < nPoints; ++i) {
+        KnobDoublePtr point = _points[i].lock();
+        xs[i] = point->getValueAtTime(args.time, 0) * args.mappedScale.x;
+        ys[i] = point->getValueAtTime(args.time, 1) * args.mappedScale.y;
+    }
+
+    std::vector<double> crossings;
+    crossings.reserve(nPoints);
+    for (std::list<std::pair<ImagePlaneDesc, ImagePtr> >::const_iterator it = args.outputPlanes.begin(); it != args.outputPlanes.end(); ++it) {
+        if ( !isFloatRGBA( it->second.get() ) ) {
+            return eStatusFailed;
+        }
+        Image::WriteAccess acc = it->second->getWriteRights();
+        for (int y = args.roi.y1; y < args.roi.y2; ++y) {
+            float* dst = (float*)acc.pixelAt(args.roi.x1, y);
+            assert(dst);
+            std::fill(dst, dst + (args.roi.x2 - args.roi.x1) * 4, 0.f);
+
+            // Even-odd scanline fill, sampling the pixel centers
+            const double yc = y + 0.5;
+            crossings.clear();
+            for (std::size_t i = 0, j = nPoints - 1; i < nPoints; j = i++) {
+                if ( (ys[i] <= yc) != (ys[j] <= yc) ) {
+                    crossings.push_back( xs[i] + (yc - ys[i]) * (xs[j] - xs[i]) / (ys[j] - ys[i]) );
+                }
+            }
+            std::sort( crossings.begin(), crossings.end() );
+            for (std::size_t k = 0; k + 1 < crossings.size(); k += 2) {
+                int x1 = std::max( args.roi.x1, (int)std::ceil(crossings[k] - 0.5) );
+                int x2 = std::min( args.roi.x2, (int)std::ceil(crossings[k + 1] - 0.5) );
+                for (int x = x1; x < x2; ++x) {
+                    float* pix = dst + (x - args.roi.x1) * 4;
+                    pix[0] = pix[1] = pix[2] = value;
+                    pix[3] = 1.f;
+                }
+            }
+        }
+    }
+
+    return eStatusOK;
+} // BenchmarkShape::render
+
+NATRON_NAMESPACE_EXIT
+NATRON_NAMESPACE_USING
+
+#include "moc_BenchmarkEffects.cpp"
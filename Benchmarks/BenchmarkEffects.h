@@ -0,0 +1,358 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef Benchmarks_BenchmarkEffects_h
+#define Benchmarks_BenchmarkEffects_h
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <vector>
+
+#include "Engine/EffectInstance.h"
+#include "Engine/ViewIdx.h"
+#include "Engine/EngineFwd.h"
+
+#define PLUGINID_BENCHMARK_GENERATOR (NATRON_ORGANIZATION_DOMAIN_TOPLEVEL "." NATRON_ORGANIZATION_DOMAIN_SUB ".benchmark.Generator")
+#define PLUGINID_BENCHMARK_FILTER    (NATRON_ORGANIZATION_DOMAIN_TOPLEVEL "." NATRON_ORGANIZATION_DOMAIN_SUB ".benchmark.Filter")
+#define PLUGINID_BENCHMARK_MERGE     (NATRON_ORGANIZATION_DOMAIN_TOPLEVEL "." NATRON_ORGANIZATION_DOMAIN_SUB ".benchmark.Merge")
+#define PLUGINID_BENCHMARK_SHAPE     (NATRON_ORGANIZATION_DOMAIN_TOPLEVEL "." NATRON_ORGANIZATION_DOMAIN_SUB ".benchmark.Shape")
+
+#define PLUGIN_GROUP_BENCHMARK "Benchmark"
+
+// Number of animated control points of a BenchmarkShape
+#define kBenchmarkShapeControlPoints 16
+
+NATRON_NAMESPACE_ENTER
+
+/**
+ * @brief Base class of the synthetic effects used by the benchmark harness.
+ * They only depend on the engine so that the benchmarks measure the host and not the plug-ins installed
+ * on the machine. They all process float RGBA images and count how many times their render action
+ * was called, which lets the harness compute how many images were fetched from the cache instead.
+ **/
+class BenchmarkEffect
+    : public EffectInstance
+{
+GCC_DIAG_SUGGEST_OVERRIDE_OFF
+    Q_OBJECT
+GCC_DIAG_SUGGEST_OVERRIDE_ON
+
+public:
+
+    BenchmarkEffect(NodePtr node);
+
+    virtual ~BenchmarkEffect();
+
+    virtual int getMajorVersion() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return 1;
+    }
+
+    virtual int getMinorVersion() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return 0;
+    }
+
+    virtual void getPluginGrouping(std::list<std::string>* grouping) const OVERRIDE FINAL
+    {
+        grouping->push_back(PLUGIN_GROUP_BENCHMARK);
+    }
+
+    virtual void addAcceptedComponents(int inputNb, std::list<ImagePlaneDesc>* comps) OVERRIDE FINAL;
+    virtual void addSupportedBitDepth(std::list<ImageBitDepthEnum>* depths) const OVERRIDE FINAL;
+
+    // Each render action processes a whole frame, so that the number of render actions is the number of images computed
+    virtual RenderSafetyEnum renderThreadSafety() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return eRenderSafetyFullySafe;
+    }
+
+    virtual bool supportsTiles() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return true;
+    }
+
+    virtual bool getCreateChannelSelectorKnob() const OVERRIDE FINAL WARN_UNUSED_RETURN { return false; }
+
+    virtual bool isHostChannelSelectorSupported(bool* defaultR, bool* defaultG, bool* defaultB, bool* defaultA) const OVERRIDE FINAL WARN_UNUSED_RETURN;
+
+    /**
+     * @brief Returns the number of render actions of all the benchmark effects since the last call to resetRenderCount().
+     **/
+    static int getRenderCount();
+    static void resetRenderCount();
+
+protected:
+
+    static void incrementRenderCount();
+};
+
+/**
+ * @brief Fills the output with a gradient scaled by the "value" parameter.
+ **/
+class BenchmarkGenerator
+    : public BenchmarkEffect
+{
+GCC_DIAG_SUGGEST_OVERRIDE_OFF
+    Q_OBJECT
+GCC_DIAG_SUGGEST_OVERRIDE_ON
+
+public:
+
+    static EffectInstance* BuildEffect(NodePtr n)
+    {
+        return new BenchmarkGenerator(n);
+    }
+
+    BenchmarkGenerator(NodePtr node);
+
+    virtual ~BenchmarkGenerator();
+
+    virtual int getNInputs() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return 0;
+    }
+
+    virtual bool isInputOptional(int /*inputNb*/) const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return true;
+    }
+
+    virtual bool isGenerator() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return true;
+    }
+
+    virtual std::string getPluginID() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return PLUGINID_BENCHMARK_GENERATOR;
+    }
+
+    virtual std::string getPluginLabel() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return "BenchmarkGenerator";
+    }
+
+    virtual std::string getPluginDescription() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return "Synthetic generator used by the benchmark harness.";
+    }
+
+    virtual void initializeKnobs() OVERRIDE FINAL;
+
+private:
+
+    virtual StatusEnum render(const RenderActionArgs& args) OVERRIDE WARN_UNUSED_RETURN;
+
+    KnobDoubleWPtr _value;
+};
+
+/**
+ * @brief Multiplies the color of its input by the "gain" parameter and adds the "offset" parameter.
+ **/
+class BenchmarkFilter
+    : public BenchmarkEffect
+{
+GCC_DIAG_SUGGEST_OVERRIDE_OFF
+    Q_OBJECT
+GCC_DIAG_SUGGEST_OVERRIDE_ON
+
+public:
+
+    static EffectInstance* BuildEffect(NodePtr n)
+    {
+        return new BenchmarkFilter(n);
+    }
+
+    BenchmarkFilter(NodePtr node);
+
+    virtual ~BenchmarkFilter();
+
+    virtual int getNInputs() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return 1;
+    }
+
+    virtual bool isInputOptional(int /*inputNb*/) const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return false;
+    }
+
+    virtual std::string getPluginID() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return PLUGINID_BENCHMARK_FILTER;
+    }
+
+    virtual std::string getPluginLabel() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return "BenchmarkFilter";
+    }
+
+    virtual std::string getPluginDescription() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return "Synthetic color correction used by the benchmark harness.";
+    }
+
+    virtual void initializeKnobs() OVERRIDE FINAL;
+
+private:
+
+    virtual StatusEnum render(const RenderActionArgs& args) OVERRIDE WARN_UNUSED_RETURN;
+
+    KnobDoubleWPtr _gain;
+    KnobDoubleWPtr _offset;
+};
+
+/**
+ * @brief Composites the A input over the B input, mixed with the B input by the "mix" parameter.
+ **/
+class BenchmarkMerge
+    : public BenchmarkEffect
+{
+GCC_DIAG_SUGGEST_OVERRIDE_OFF
+    Q_OBJECT
+GCC_DIAG_SUGGEST_OVERRIDE_ON
+
+public:
+
+    static EffectInstance* BuildEffect(NodePtr n)
+    {
+        return new BenchmarkMerge(n);
+    }
+
+    BenchmarkMerge(NodePtr node);
+
+    virtual ~BenchmarkMerge();
+
+    virtual int getNInputs() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return 2;
+    }
+
+    virtual bool isInputOptional(int inputNb) const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return inputNb == 1;
+    }
+
+    virtual std::string getInputLabel(int inputNb) const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return inputNb == 0 ? "B" : "A";
+    }
+
+    virtual std::string getPluginID() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return PLUGINID_BENCHMARK_MERGE;
+    }
+
+    virtual std::string getPluginLabel() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return "BenchmarkMerge";
+    }
+
+    virtual std::string getPluginDescription() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return "Synthetic over operator used by the benchmark harness.";
+    }
+
+    virtual void initializeKnobs() OVERRIDE FINAL;
+
+private:
+
+    virtual StatusEnum render(const RenderActionArgs& args) OVERRIDE WARN_UNUSED_RETURN;
+
+    KnobDoubleWPtr _mix;
+};
+
+/**
+ * @brief Rasterizes a polygon whose kBenchmarkShapeControlPoints vertices are animated parameters,
+ * which mimics the work of a roto shape: dense animation curves, a region of definition that depends on
+ * the animation and a scanline fill.
+ **/
+class BenchmarkShape
+    : public BenchmarkEffect
+{
+GCC_DIAG_SUGGEST_OVERRIDE_OFF
+    Q_OBJECT
+GCC_DIAG_SUGGEST_OVERRIDE_ON
+
+public:
+
+    static EffectInstance* BuildEffect(NodePtr n)
+    {
+        return new BenchmarkShape(n);
+    }
+
+    BenchmarkShape(NodePtr node);
+
+    virtual ~BenchmarkShape();
+
+    virtual int getNInputs() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return 0;
+    }
+
+    virtual bool isInputOptional(int /*inputNb*/) const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return true;
+    }
+
+    virtual bool isGenerator() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return true;
+    }
+
+    virtual std::string getPluginID() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return PLUGINID_BENCHMARK_SHAPE;
+    }
+
+    virtual std::string getPluginLabel() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return "BenchmarkShape";
+    }
+
+    virtual std::string getPluginDescription() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return "Synthetic animated shape used by the benchmark harness.";
+    }
+
+    virtual void initializeKnobs() OVERRIDE FINAL;
+
+    /**
+     * @brief Returns the parameter holding the position of the given control point, in canonical coordinates.
+     **/
+    KnobDoublePtr getControlPointKnob(int index) const;
+
+private:
+
+    virtual StatusEnum getRegionOfDefinition(U64 hash, double time, const RenderScale & scale, ViewIdx view, RectD* rod) OVERRIDE WARN_UNUSED_RETURN;
+    virtual StatusEnum render(const RenderActionArgs& args) OVERRIDE WARN_UNUSED_RETURN;
+
+    std::vector<KnobDoubleWPtr> _points;
+    KnobDoubleWPtr _value;
+};
+
+NATRON_NAMESPACE_EXIT
+
+#endif // Benchmarks_BenchmarkEffects_h
@@ -0,0 +1,475 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "BenchmarkRunner.h"
+
+#include <algorithm> // min, max, find
+#include <cmath>
+#include <iomanip> // setprecision, setw, setfill
+#include <iostream>
+#include <map>
+#include <sstream> // stringstream
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+
+#include "Global/GitVersion.h"
+
+#include "Engine/AbortableRenderInfo.h"
+#include "Engine/AppInstance.h"
+#include "Engine/AppManager.h"
+#include "Engine/EffectInstance.h"
+#include "Engine/Format.h"
+#include "Engine/Image.h"
+#include "Engine/KnobTypes.h"
+#include "Engine/MemoryInfo.h"
+#include "Engine/Node.h"
+#include "Engine/ParallelRenderArgs.h"
+#include "Engine/Project.h"
+#include "Engine/TimeLine.h"
+#include "Engine/Timer.h"
+#include "Engine/ViewIdx.h"
+
+#include "BenchmarkEffects.h"
+#include "ProjectGenerators.h"
+
+// Number of parameter changes per iteration of the parameter change benchmark
+#define kBenchmarkKnobSetsPerIteration 50
+
+// Number of distinct times per iteration of the parameter evaluation benchmark
+#define kBenchmarkKnobEvalTimesPerIteration 20
+
+NATRON_NAMESPACE_ENTER
+
+namespace {
+struct ScenarioResult
+{
+    std::string name;
+    std::string description;
+    int size;
+    std::string error;
+
+    // In the order in which they were measured
+    std::vector<std::pair<std::string, double> > metrics;
+
+    ScenarioResult()
+        : name()
+        , description()
+        , size(0)
+        , error()
+        , metrics()
+    {
+    }
+
+    void addMetric(const std::string& metric,
+                   double value)
+    {
+        metrics.push_back( std::make_pair(metric, value) );
+    }
+};
+
+std::string
+toJsonString(const std::string& str)
+{
+    std::string ret = "\"";
+
+    for (std::size_t i = 0; i < str.size(); ++i) {
+        unsigned char c = str[i];
+        switch (c) {
+        case '"':
+            ret += "\\\"";
+            break;
+        case '\\':
+            ret += "\\\\";
+            break;
+        case '\n':
+            ret += "\\n";
+            break;
+        case '\t':
+            ret += "\\t";
+            break;
+        default:
+            if (c < 0x20) {
+                std::stringstream ss;
+                ss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c;
+                ret += ss.str();
+            } else {
+                ret += (char)c;
+            }
+            break;
+        }
+    }
+    ret += "\"";
+
+    return ret;
+}
+
+std::string
+toJsonNumber(double value)
+{
+    // JSON has no representation for NaN and infinity
+    if ( (value != value) || (std::fabs(value) > 1e300) ) {
+        return "null";
+    }
+    std::stringstream ss;
+    ss << std::setprecision(10) << value;
+
+    return ss.str();
+}
+
+/**
+ * @brief Renders the full region of definition of node at the given time and scale 1, like an analysis would.
+ * @returns False if the render failed.
+ **/
+bool
+renderFrame(const NodePtr& node,
+            double time)
+{
+    EffectInstancePtr effect = node->getEffectInstance();
+    RenderScale scale(1.);
+    RectD rod;
+    bool isProjectFormat;
+    StatusEnum stat = effect->getRegionOfDefinition_public(node->getHashValue(), time, scale, ViewIdx(0), &rod, &isProjectFormat);
+
+    if ( (stat == eStatusFailed) || rod.isNull() ) {
+        return false;
+    }
+    RectI roi;
+    rod.toPixelEnclosing(0, effect->getAspectRatio(-1), &roi);
+
+    AbortableRenderInfoPtr abortInfo = AbortableRenderInfo::create(false, 0);
+    ParallelRenderArgsSetter frameRenderArgs( time,
+                                              ViewIdx(0),
+                                              false, // isRenderUserInteraction
+                                              false, // isSequential
+                                              abortInfo, // abort info
+                                              node, // requester
+                                              0, //texture index
+                                              node->getApp()->getTimeLine().get(), // timeline
+                                              NodePtr(), //rotoPaint node
+                                              true, // isAnalysis
+                                              false, // isDraft
+                                              RenderStatsPtr() );
+    FrameRequestMap request;
+    stat = EffectInstance::computeRequestPass(time, ViewIdx(0), 0, rod, node, request);
+    if (stat == eStatusFailed) {
+        return false;
+    }
+    frameRenderArgs.updateNodesRequest(request);
+
+    std::list<ImagePlaneDesc> requestedComps;
+    requestedComps.push_back( ImagePlaneDesc::getRGBAComponents() );
+    EffectInstance::RenderRoIArgs args( time,
+                                        scale,
+                                        0, // mipMapLevel
+                                        ViewIdx(0),
+                                        false, // byPassCache
+                                        roi,
+                                        rod,
+                                        requestedComps,
+                                        eImageBitDepthFloat,
+                                        false,
+                                        effect.get(),
+                                        eStorageModeRAM /*returnStorage*/,
+                                        time /*callerRenderTime*/);
+    std::map<ImagePlaneDesc, ImagePtr> planes;
+    EffectInstance::RenderRoIRetCode retCode = effect->renderRoI(args, &planes);
+
+    return retCode == EffectInstance::eRenderRoIRetCodeOk && !planes.empty();
+}
+} // anon namespace
+
+BenchmarkOptions::BenchmarkOptions()
+    : scenarios()
+    , scale(1.)
+    , firstFrame(1)
+    , lastFrame(10)
+    , width(1920)
+    , height(1080)
+    , iterations(10)
+    , workDir( QDir::tempPath() )
+{
+}
+
+struct BenchmarkRunnerPrivate
+{
+    BenchmarkOptions options;
+    std::list<ScenarioResult> results;
+
+    BenchmarkRunnerPrivate(const BenchmarkOptions& options)
+        : options(options)
+        , results()
+    {
+    }
+
+    void runScenario(const ProjectGenerator& generator, ScenarioResult* result);
+
+    /**
+     * @brief Renders the frame range and adds the time per frame and the cache hit rate to the results,
+     * with the given suffix.
+     **/
+    void measureRender(const BenchmarkProject& project, const std::string& suffix, ScenarioResult* result);
+
+    void writeJson(std::ostream& os) const;
+};
+
+BenchmarkRunner::BenchmarkRunner(const BenchmarkOptions& options)
+    : _imp( new BenchmarkRunnerPrivate(options) )
+{
+}
+
+BenchmarkRunner::~BenchmarkRunner()
+{
+}
+
+bool
+BenchmarkRunner::run(std::ostream& os)
+{
+    std::list<ProjectGenerator> generators;
+
+    getProjectGenerators(&generators);
+
+    bool ok = true;
+    for (std::list<ProjectGenerator>::const_iterator it = generators.begin(); it != generators.end(); ++it) {
+        const std::list<std::string>& scenarios = _imp->options.scenarios;
+        if ( !scenarios.empty() && ( std::find(scenarios.begin(), scenarios.end(), it->name) == scenarios.end() ) ) {
+            continue;
+        }
+        ScenarioResult result;
+        result.name = it->name;
+        result.description = it->description;
+        result.size = std::max( 1, (int)std::floor(it->defaultSize * _imp->options.scale + 0.5) );
+        std::cerr << "Running " << it->name << " (size " << result.size << ")..." << std::endl;
+        try {
+            _imp->runScenario(*it, &result);
+        } catch (const std::exception& e) {
+            result.error = e.what();
+            std::cerr << it->name << " failed: " << e.what() << std::endl;
+            ok = false;
+        }
+
+        // Always leave an empty project for the next scenario
+        appPTR->getTopLevelInstance()->getProject()->closeProject_blocking(false);
+        _imp->results.push_back(result);
+    }
+
+    _imp->writeJson(os);
+
+    return ok;
+}
+
+void
+BenchmarkRunnerPrivate::runScenario(const ProjectGenerator& generator,
+                                    ScenarioResult* result)
+{
+    AppInstancePtr app = appPTR->getTopLevelInstance();
+    ProjectPtr project = app->getProject();
+
+    // The peak RSS is the one of the whole process, only the growth of the current RSS belongs to this scenario
+    const std::size_t startRSS = getCurrentRSS();
+
+    project->setOrAddProjectFormat( Format(0, 0, options.width, options.height, "Benchmark", 1.) );
+    appPTR->clearNodeCache();
+
+    // Creation, with all the changes coalesced like when a script creates a graph
+    BenchmarkProject benchProject;
+    {
+        TimeLapse timer;
+        {
+            ChangeTransaction_RAII transaction(app);
+            generator.generate(app, result->size, &benchProject);
+        }
+        result->addMetric( "nodes", benchProject.nodes.size() );
+        result->addMetric( "createSeconds", timer.getTimeSinceCreation() );
+    }
+    if (!benchProject.output) {
+        throw std::runtime_error("The project has no output");
+    }
+
+    const int iterations = std::max(1, options.iterations);
+
+    // Hash of the whole graph
+    {
+        TimeLapse timer;
+        for (int i = 0; i < iterations; ++i) {
+            Node::computeHashOfNodes(benchProject.nodes);
+        }
+        double elapsed = timer.getTimeSinceCreation();
+        result->addMetric( "hashNodesPerSecond", elapsed > 0. ? benchProject.nodes.size() * iterations / elapsed : 0. );
+    }
+
+    // Parameter changes, each of them invalidates the hash of the nodes downstream
+    if (benchProject.editKnob) {
+        KnobDoublePtr knob = benchProject.editKnob;
+        const double original = knob->getValue();
+        const int nSets = iterations * kBenchmarkKnobSetsPerIteration;
+        TimeLapse timer;
+        for (int i = 0; i < nSets; ++i) {
+            knob->setValue( original + ( (i % 2) ? 0. : 1e-3 ) );
+        }
+        double elapsed = timer.getTimeSinceCreation();
+        knob->setValue(original);
+        result->addMetric( "knobSetsPerSecond", elapsed > 0. ? nSets / elapsed : 0. );
+    }
+
+    // Parameter evaluation at distinct fractional times, so that neither the curves nor the expressions
+    // can answer from a previously computed value
+    if ( !benchProject.evalKnobs.empty() ) {
+        const int nTimes = iterations * kBenchmarkKnobEvalTimesPerIteration;
+        double checksum = 0.;
+        long long nEvals = 0;
+        TimeLapse timer;
+        for (int t = 0; t < nTimes; ++t) {
+            const double time = 1. + std::fmod(t * 0.6180339887, 249.);
+            for (std::list<KnobDoublePtr>::const_iterator it = benchProject.evalKnobs.begin(); it != benchProject.evalKnobs.end(); ++it) {
+                const int nDims = (*it)->getDimension();
+                for (int d = 0; d < nDims; ++d) {
+                    checksum += (*it)->getValueAtTime(time, d);
+                    ++nEvals;
+                }
+            }
+        }
+        double elapsed = timer.getTimeSinceCreation();
+        Q_UNUSED(checksum);
+        result->addMetric( "knobEvalsPerSecond", elapsed > 0. ? nEvals / elapsed : 0. );
+    }
+
+    // Renders: nothing cached, everything cached, then after a parameter change in the middle of the graph
+    appPTR->clearNodeCache();
+    measureRender(benchProject, "Cold", result);
+    measureRender(benchProject, "Warm", result);
+    if (benchProject.editKnob) {
+        KnobDoublePtr knob = benchProject.editKnob;
+        knob->setValue(knob->getValue() + 0.01);
+        measureRender(benchProject, "Edit", result);
+    }
+
+    // Save and load
+    {
+        QDir workDir(options.workDir);
+        if ( !workDir.exists() && !workDir.mkpath( QString::fromUtf8(".") ) ) {
+            throw std::runtime_error("Could not create the directory " + options.workDir.toStdString() );
+        }
+        QString path = workDir.absolutePath();
+        QString name = QString::fromUtf8("NatronBenchmark_%1_%2." NATRON_PROJECT_FILE_EXT).arg( QString::fromUtf8( generator.name.c_str() ) ).arg( QCoreApplication::applicationPid() );
+        QString filePath;
+        TimeLapse saveTimer;
+        if ( !project->saveProject(path, name, &filePath) || filePath.isEmpty() ) {
+            throw std::runtime_error("Could not save the project to " + path.toStdString() );
+        }
+        result->addMetric( "saveSeconds", saveTimer.getTimeSinceCreation() );
+        result->addMetric( "projectFileBytes", QFileInfo(filePath).size() );
+
+        project->closeProject_blocking(false);
+
+        TimeLapse loadTimer;
+        bool loaded = project->loadProject(path, name, false, false);
+        double loadSeconds = loadTimer.getTimeSinceCreation();
+        QFile::remove(filePath);
+        if (!loaded) {
+            throw std::runtime_error("Could not load the project " + filePath.toStdString() );
+        }
+        result->addMetric("loadSeconds", loadSeconds);
+    }
+
+    const std::size_t endRSS = getCurrentRSS();
+    result->addMetric( "currentRSSBytes", endRSS );
+    result->addMetric( "rssGrowthBytes", (double)endRSS - (double)startRSS );
+    result->addMetric( "processPeakRSSBytes", getPeakRSS() );
+} // BenchmarkRunnerPrivate::runScenario
+
+void
+BenchmarkRunnerPrivate::measureRender(const BenchmarkProject& project,
+                                      const std::string& suffix,
+                                      ScenarioResult* result)
+{
+    const int nFrames = std::max(1, options.lastFrame - options.firstFrame + 1);
+
+    BenchmarkEffect::resetRenderCount();
+    TimeLapse timer;
+    for (int frame = options.firstFrame; frame < options.firstFrame + nFrames; ++frame) {
+        if ( !renderFrame(project.output, frame) ) {
+            throw std::runtime_error("The render failed");
+        }
+    }
+    double elapsed = timer.getTimeSinceCreation();
+    int renders = BenchmarkEffect::getRenderCount();
+
+    // Every node of the project is upstream of the output: each one that did not render was read from the cache
+    double requested = (double)project.nodes.size() * nFrames;
+    double hitRate = requested > 0. ? 1. - renders / requested : 0.;
+    result->addMetric("render" + suffix + "MsPerFrame", elapsed * 1000. / nFrames);
+    result->addMetric( "cacheHitRate" + suffix, std::max(0., std::min(1., hitRate) ) );
+}
+
+void
+BenchmarkRunnerPrivate::writeJson(std::ostream& os) const
+{
+    os << "{\n";
+    os << "  \"harness\": \"NatronBenchmarks\",\n";
+    os << "  \"formatVersion\": 1,\n";
+    os << "  \"version\": " << toJsonString(NATRON_VERSION_STRING) << ",\n";
+    os << "  \"gitBranch\": " << toJsonString(GIT_BRANCH) << ",\n";
+    os << "  \"gitCommit\": " << toJsonString(GIT_COMMIT) << ",\n";
+    os << "  \"date\": " << toJsonString( QDateTime::currentDateTime().toUTC().toString(Qt::ISODate).toStdString() ) << ",\n";
+    os << "  \"hardwareThreads\": " << appPTR->getHardwareIdealThreadCount() << ",\n";
+    os << "  \"options\": {\n";
+    os << "    \"scale\": " << toJsonNumber(options.scale) << ",\n";
+    os << "    \"firstFrame\": " << options.firstFrame << ",\n";
+    os << "    \"lastFrame\": " << options.lastFrame << ",\n";
+    os << "    \"width\": " << options.width << ",\n";
+    os << "    \"height\": " << options.height << ",\n";
+    os << "    \"iterations\": " << options.iterations << "\n";
+    os << "  },\n";
+    os << "  \"scenarios\": [";
+    for (std::list<ScenarioResult>::const_iterator it = results.begin(); it != results.end(); ++it) {
+        os << (it == results.begin() ? "\n" : ",\n");
+        os << "    {\n";
+        os << "      \"name\": " << toJsonString(it->name) << ",\n";
+        os << "      \"description\": " << toJsonString(it->description) << ",\n";
+        os << "      \"size\": " << it->size << ",\n";
+        os << "      \"ok\": " << (it->error.empty() ? "true" : "false") << ",\n";
+        if ( !it->error.empty() ) {
+            os << "      \"error\": " << toJsonString(it->error) << ",\n";
+        }
+        os << "      \"metrics\": {";
+        for (std::size_t i = 0; i < it->metrics.size(); ++i) {
+            os << (i == 0 ? "\n" : ",\n");
+            os << "        " << toJsonString(it->metrics[i].first) << ": " << toJsonNumber(it->metrics[i].second);
+        }
+        os << (it->metrics.empty() ? "}\n" : "\n      }\n");
+        os << "    }";
+    }
+    os << (results.empty() ? "],\n" : "\n  ],\n");
+    os << "  \"processPeakRSSBytes\": " << toJsonNumber( getPeakRSS() ) << "\n";
+    os << "}\n";
+} // BenchmarkRunnerPrivate::writeJson
+
+NATRON_NAMESPACE_EXIT
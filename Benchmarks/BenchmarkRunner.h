@@ -0,0 +1,99 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef Benchmarks_BenchmarkRunner_h
+#define Benchmarks_BenchmarkRunner_h
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <list>
+#include <string>
+#include <ostream>
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/scoped_ptr.hpp>
+#endif
+
+#include <QtCore/QString>
+
+#include "Engine/EngineFwd.h"
+
+NATRON_NAMESPACE_ENTER
+
+struct BenchmarkOptions
+{
+    // Names of the scenarios to run, all of them if empty
+    std::list<std::string> scenarios;
+
+    // Multiplies the default size of the generated projects
+    double scale;
+
+    // Frame range rendered by the render benchmarks
+    int firstFrame;
+    int lastFrame;
+
+    // Project format
+    int width;
+    int height;
+
+    // Number of repetitions of the hash and parameter benchmarks
+    int iterations;
+
+    // Directory where the projects are saved to measure the load time
+    QString workDir;
+
+    BenchmarkOptions();
+};
+
+struct BenchmarkRunnerPrivate;
+
+/**
+ * @brief Generates the synthetic projects and measures, for each of them: the time to create it, the hash and
+ * parameter evaluation throughput, the render time and cache hit rate of a cold, warm and edited render,
+ * the time to save and load it, and the memory used.
+ * The engine must have been loaded by a BenchmarkAppManager.
+ **/
+class BenchmarkRunner
+{
+public:
+
+    BenchmarkRunner(const BenchmarkOptions& options);
+
+    ~BenchmarkRunner();
+
+    /**
+     * @brief Runs the scenarios and writes the results as JSON to os.
+     * A scenario that fails reports its error in the results and does not prevent the others from running.
+     * @returns False if any scenario failed.
+     **/
+    bool run(std::ostream& os);
+
+private:
+
+    boost::scoped_ptr<BenchmarkRunnerPrivate> _imp;
+};
+
+NATRON_NAMESPACE_EXIT
+
+#endif // Benchmarks_BenchmarkRunner_h
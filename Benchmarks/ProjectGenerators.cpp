@@ -0,0 +1,366 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "ProjectGenerators.h"
+
+#include <algorithm> // min, max
+#include <cassert>
+#include <cmath>
+#include <sstream> // stringstream
+#include <stdexcept>
+#include <vector>
+
+#include "Engine/AppInstance.h"
+#include "Engine/CreateNodeArgs.h"
+#include "Engine/Curve.h"
+#include "Engine/Format.h"
+#include "Engine/KnobTypes.h"
+#include "Engine/Node.h"
+#include "Engine/Project.h"
+#include "Engine/ViewIdx.h"
+
+#include "BenchmarkEffects.h"
+
+// Number of frames over which the shapes and the tracks are animated, with a keyframe at every frame
+#define kBenchmarkAnimatedFrames 250
+
+// Number of tracks carried by each node of the tracker-heavy project
+#define kBenchmarkTracksPerNode 32
+
+NATRON_NAMESPACE_ENTER
+
+namespace {
+std::string
+makeNodeName(const char* prefix,
+             int index)
+{
+    std::stringstream ss;
+
+    ss << prefix << index;
+
+    return ss.str();
+}
+
+NodePtr
+createBenchmarkNode(const AppInstancePtr& app,
+                    const std::string& pluginID,
+                    const std::string& name,
+                    BenchmarkProject* project)
+{
+    CreateNodeArgs args( pluginID, app->getProject() );
+
+    args.setProperty<std::string>(kCreateNodeArgsPropNodeInitialName, name);
+    args.setProperty<bool>(kCreateNodeArgsPropAutoConnect, false);
+    args.setProperty<bool>(kCreateNodeArgsPropSettingsOpened, false);
+    args.setProperty<bool>(kCreateNodeArgsPropAddUndoRedoCommand, false);
+    NodePtr node = app->createNode(args);
+    if (!node) {
+        throw std::runtime_error("Could not create a node of type " + pluginID);
+    }
+    project->nodes.push_back(node);
+
+    return node;
+}
+
+void
+connectBenchmarkNodes(const NodePtr& input,
+                      const NodePtr& output,
+                      int inputNb)
+{
+    if ( !output->connectInput(input, inputNb) ) {
+        throw std::runtime_error("Could not connect " + input->getScriptName_mt_safe() + " to " + output->getScriptName_mt_safe() );
+    }
+}
+
+KnobDoublePtr
+getDoubleKnob(const NodePtr& node,
+              const std::string& name)
+{
+    KnobDoublePtr knob = boost::dynamic_pointer_cast<KnobDouble>( node->getKnobByName(name) );
+
+    if (!knob) {
+        throw std::runtime_error("No parameter " + name + " on " + node->getScriptName_mt_safe() );
+    }
+
+    return knob;
+}
+
+/**
+ * @brief Merges the given nodes two by two until there is only one left, which is returned.
+ * The first merge created is stored in firstMerge.
+ **/
+NodePtr
+createMergeTree(const AppInstancePtr& app,
+                std::vector<NodePtr> level,
+                BenchmarkProject* project,
+                NodePtr* firstMerge)
+{
+    int mergeIndex = 1;
+
+    while (level.size() > 1) {
+        std::vector<NodePtr> nextLevel;
+        for (std::size_t i = 0; i + 1 < level.size(); i += 2) {
+            NodePtr merge = createBenchmarkNode(app, PLUGINID_BENCHMARK_MERGE, makeNodeName("Merge", mergeIndex++), project);
+            connectBenchmarkNodes(level[i], merge, 0);
+            connectBenchmarkNodes(level[i + 1], merge, 1);
+            if (!*firstMerge) {
+                *firstMerge = merge;
+            }
+            nextLevel.push_back(merge);
+        }
+        if (level.size() % 2) {
+            nextLevel.push_back( level.back() );
+        }
+        level.swap(nextLevel);
+    }
+
+    return level.empty() ? NodePtr() : level.front();
+}
+
+/**
+ * @brief Sets a keyframe at every animated frame on the given dimension of the knob.
+ * The curve is a smooth deterministic motion that depends on seed.
+ **/
+void
+animateKnob(const KnobDoublePtr& knob,
+            int dimension,
+            double center,
+            double amplitude,
+            double seed)
+{
+    std::vector<KeyFrame> keys;
+
+    keys.reserve(kBenchmarkAnimatedFrames);
+    for (int t = 1; t <= kBenchmarkAnimatedFrames; ++t) {
+        double value = center + amplitude * ( std::sin(0.05 * t + seed) + 0.3 * std::sin(0.37 * t + 2. * seed) );
+        keys.push_back( KeyFrame(t, value) );
+    }
+    knob->setKeyFrames(keys, ViewSpec::all(), dimension, eValueChangedReasonNatronInternalEdited);
+}
+
+/**
+ * @brief A generator followed by a long chain of filters.
+ **/
+void
+generateDeepChain(const AppInstancePtr& app,
+                  int size,
+                  BenchmarkProject* project)
+{
+    NodePtr previous = createBenchmarkNode(app, PLUGINID_BENCHMARK_GENERATOR, "Generator1", project);
+    const int nFilters = std::max(1, size);
+
+    for (int i = 1; i <= nFilters; ++i) {
+        NodePtr filter = createBenchmarkNode(app, PLUGINID_BENCHMARK_FILTER, makeNodeName("Filter", i), project);
+        connectBenchmarkNodes(previous, filter, 0);
+        KnobDoublePtr gain = getDoubleKnob(filter, "gain");
+        gain->setValue(1. + 0.001 * (i % 7) - 0.003);
+        project->evalKnobs.push_back(gain);
+        if (i == (nFilters + 1) / 2) {
+            project->editKnob = gain;
+        }
+        previous = filter;
+    }
+    project->output = previous;
+}
+
+/**
+ * @brief Many generators composited together by a balanced tree of merges.
+ **/
+void
+generateWideMerge(const AppInstancePtr& app,
+                  int size,
+                  BenchmarkProject* project)
+{
+    std::vector<NodePtr> sources;
+    const int nGenerators = std::max(2, size);
+
+    for (int i = 1; i <= nGenerators; ++i) {
+        NodePtr generator = createBenchmarkNode(app, PLUGINID_BENCHMARK_GENERATOR, makeNodeName("Generator", i), project);
+        KnobDoublePtr value = getDoubleKnob(generator, "value");
+        value->setValue(1. / i);
+        project->evalKnobs.push_back(value);
+        sources.push_back(generator);
+    }
+    NodePtr firstMerge;
+    project->output = createMergeTree(app, sources, project, &firstMerge);
+    project->editKnob = getDoubleKnob(firstMerge, "mix");
+}
+
+/**
+ * @brief Many animated shapes laid out on a grid and composited together, like a roto-heavy comp.
+ **/
+void
+generateRotoHeavy(const AppInstancePtr& app,
+                  int size,
+                  BenchmarkProject* project)
+{
+    Format format;
+
+    app->getProject()->getProjectDefaultFormat(&format);
+
+    const int nShapes = std::max(2, size);
+    const int cols = (int)std::ceil( std::sqrt( (double)nShapes ) );
+    const int rows = (nShapes + cols - 1) / cols;
+    const double cellWidth = format.width() / (double)cols;
+    const double cellHeight = format.height() / (double)rows;
+    const double radius = 0.6 * std::min(cellWidth, cellHeight);
+    std::vector<NodePtr> shapes;
+
+    for (int i = 0; i < nShapes; ++i) {
+        NodePtr shapeNode = createBenchmarkNode(app, PLUGINID_BENCHMARK_SHAPE, makeNodeName("Shape", i + 1), project);
+        BenchmarkShape* shape = dynamic_cast<BenchmarkShape*>( shapeNode->getEffectInstance().get() );
+        assert(shape);
+        const double cx = format.x1 + (i % cols + 0.5) * cellWidth;
+        const double cy = format.y1 + (i / cols + 0.5) * cellHeight;
+        for (int p = 0; p < kBenchmarkShapeControlPoints; ++p) {
+            KnobDoublePtr point = shape->getControlPointKnob(p);
+            double angle = 2. * M_PI * p / kBenchmarkShapeControlPoints;
+            animateKnob(point, 0, cx + radius * std::cos(angle), 0.1 * radius, i + p);
+            animateKnob(point, 1, cy + radius * std::sin(angle), 0.1 * radius, i - p);
+            project->evalKnobs.push_back(point);
+        }
+        KnobDoublePtr value = getDoubleKnob(shapeNode, "value");
+        value->setValue( 0.2 + 0.8 * (i + 1) / nShapes );
+        if (i == nShapes / 2) {
+            project->editKnob = value;
+        }
+        shapes.push_back(shapeNode);
+    }
+    NodePtr firstMerge;
+    project->output = createMergeTree(app, shapes, project, &firstMerge);
+}
+
+/**
+ * @brief A short chain whose nodes carry many tracks keyed at every frame, like a tracker-heavy comp:
+ * the cost is in the animation curves rather than in the images.
+ **/
+void
+generateTrackerHeavy(const AppInstancePtr& app,
+                     int size,
+                     BenchmarkProject* project)
+{
+    NodePtr previous = createBenchmarkNode(app, PLUGINID_BENCHMARK_GENERATOR, "Generator1", project);
+    const int nTracks = std::max(1, size);
+    const int nNodes = (nTracks + kBenchmarkTracksPerNode - 1) / kBenchmarkTracksPerNode;
+    int track = 0;
+
+    for (int i = 1; i <= nNodes; ++i) {
+        NodePtr filter = createBenchmarkNode(app, PLUGINID_BENCHMARK_FILTER, makeNodeName("Tracker", i), project);
+        connectBenchmarkNodes(previous, filter, 0);
+        EffectInstancePtr effect = filter->getEffectInstance();
+        KnobPagePtr userPage = effect->getOrCreateUserPageKnob();
+        for (int t = 0; t < kBenchmarkTracksPerNode && track < nTracks; ++t, ++track) {
+            std::stringstream ss;
+            ss << "track" << t + 1;
+            KnobDoublePtr center = effect->createDoubleKnob(ss.str() + "_center", ss.str() + " center", 2);
+            KnobDoublePtr offset = effect->createDoubleKnob(ss.str() + "_offset", ss.str() + " offset", 2);
+            KnobDoublePtr error = effect->createDoubleKnob(ss.str() + "_error", ss.str() + " error", 1);
+            userPage->addKnob(center);
+            userPage->addKnob(offset);
+            userPage->addKnob(error);
+            animateKnob(center, 0, 960. + 10. * t, 300., track);
+            animateKnob(center, 1, 540. - 10. * t, 200., 2 * track);
+            animateKnob(offset, 0, 0., 2., track);
+            animateKnob(offset, 1, 0., 2., 3 * track);
+            animateKnob(error, 0, 0.05, 0.04, track);
+            project->evalKnobs.push_back(center);
+            project->evalKnobs.push_back(offset);
+            project->evalKnobs.push_back(error);
+        }
+        if (i == (nNodes + 1) / 2) {
+            project->editKnob = getDoubleKnob(filter, "gain");
+        }
+        previous = filter;
+    }
+    project->output = previous;
+}
+
+/**
+ * @brief A chain of filters whose gain is a Python expression of the gain of the previous filter.
+ **/
+void
+generateExpressionHeavy(const AppInstancePtr& app,
+                        int size,
+                        BenchmarkProject* project)
+{
+    NodePtr previous = createBenchmarkNode(app, PLUGINID_BENCHMARK_GENERATOR, "Generator1", project);
+    const int nFilters = std::max(2, size);
+
+    for (int i = 1; i <= nFilters; ++i) {
+        NodePtr filter = createBenchmarkNode(app, PLUGINID_BENCHMARK_FILTER, makeNodeName("Filter", i), project);
+        connectBenchmarkNodes(previous, filter, 0);
+        KnobDoublePtr gain = getDoubleKnob(filter, "gain");
+        if (i > 1) {
+            std::stringstream ss;
+            ss << previous->getScriptName_mt_safe() << ".gain.getValueAtTime(frame) * 0.999 + 0.0001 * frame";
+            gain->setExpression(0, ss.str(), false /*hasRetVariable*/, true /*failIfInvalid*/);
+        }
+        project->evalKnobs.push_back(gain);
+        if (i == (nFilters + 1) / 2) {
+            // The offset is not driven by an expression
+            project->editKnob = getDoubleKnob(filter, "offset");
+        }
+        previous = filter;
+    }
+    project->output = previous;
+}
+} // anon namespace
+
+void
+getProjectGenerators(std::list<ProjectGenerator>* generators)
+{
+    ProjectGenerator g;
+
+    g.name = "deep_chain";
+    g.description = "A generator followed by a chain of <size> filters";
+    g.defaultSize = 200;
+    g.generate = generateDeepChain;
+    generators->push_back(g);
+
+    g.name = "wide_merge";
+    g.description = "<size> generators composited by a balanced tree of merges";
+    g.defaultSize = 64;
+    g.generate = generateWideMerge;
+    generators->push_back(g);
+
+    g.name = "roto_heavy";
+    g.description = "<size> polygonal shapes whose control points are keyed at every frame, composited together";
+    g.defaultSize = 32;
+    g.generate = generateRotoHeavy;
+    generators->push_back(g);
+
+    g.name = "tracker_heavy";
+    g.description = "<size> tracks keyed at every frame, carried by a chain of filters";
+    g.defaultSize = 256;
+    g.generate = generateTrackerHeavy;
+    generators->push_back(g);
+
+    g.name = "expression_heavy";
+    g.description = "A chain of <size> filters whose gain is a Python expression of the previous gain";
+    g.defaultSize = 100;
+    g.generate = generateExpressionHeavy;
+    generators->push_back(g);
+}
+
+NATRON_NAMESPACE_EXIT
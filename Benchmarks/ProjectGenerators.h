@@ -0,0 +1,76 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef Benchmarks_ProjectGenerators_h
+#define Benchmarks_ProjectGenerators_h
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <list>
+#include <string>
+
+#include "Engine/EngineFwd.h"
+
+NATRON_NAMESPACE_ENTER
+
+/**
+ * @brief A project created by a generator, with the nodes and parameters the benchmarks work on.
+ **/
+struct BenchmarkProject
+{
+    // The node rendered by the render benchmarks
+    NodePtr output;
+
+    // All the nodes of the project
+    NodesList nodes;
+
+    // Parameter edited in the middle of the graph before re-rendering, to measure the cache hit rate after an edit
+    KnobDoublePtr editKnob;
+
+    // Parameters read by the knob evaluation benchmark, upstream first
+    std::list<KnobDoublePtr> evalKnobs;
+};
+
+typedef void (*ProjectGeneratorFunc)(const AppInstancePtr& app, int size, BenchmarkProject* project);
+
+struct ProjectGenerator
+{
+    std::string name;
+    std::string description;
+
+    // Size of the project at scale 1, its meaning depends on the generator
+    int defaultSize;
+    ProjectGeneratorFunc generate;
+};
+
+/**
+ * @brief Returns the synthetic project generators, in the order in which they are run.
+ * The generated projects only use the benchmark effects, the generators throw a std::runtime_error if a node
+ * cannot be created.
+ **/
+void getProjectGenerators(std::list<ProjectGenerator>* generators);
+
+NATRON_NAMESPACE_EXIT
+
+#endif // Benchmarks_ProjectGenerators_h
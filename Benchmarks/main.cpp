@@ -0,0 +1,187 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include <cstdio>
+#include <cstdlib> // strtod, atoi
+#include <cstring> // strcmp
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <string>
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+#include "Engine/CLArgs.h"
+
+#include "BenchmarkAppManager.h"
+#include "BenchmarkRunner.h"
+#include "ProjectGenerators.h"
+
+NATRON_NAMESPACE_USING
+
+/**
+ * @brief Sends everything the engine prints on std::cout to std::cerr for the lifetime of the object,
+ * so that the JSON results written on the original standard output stay parsable.
+ **/
+class StdoutToStderrRedirection
+{
+public:
+
+    StdoutToStderrRedirection()
+        : _stdoutBuffer( std::cout.rdbuf( std::cerr.rdbuf() ) )
+    {
+    }
+
+    ~StdoutToStderrRedirection()
+    {
+        std::cout.rdbuf(_stdoutBuffer);
+    }
+
+    std::streambuf* getStdoutBuffer() const
+    {
+        return _stdoutBuffer;
+    }
+
+private:
+
+    std::streambuf* _stdoutBuffer;
+};
+
+static void
+printUsage(const char* program)
+{
+    std::list<ProjectGenerator> generators;
+
+    getProjectGenerators(&generators);
+
+    std::cout << "Usage: " << program << " [options]\n"
+              << "Generates synthetic projects and measures the engine on them without any plug-in.\n"
+              << "The results are written as JSON, the progress and the engine messages are printed on the standard error.\n\n"
+              << "Options:\n"
+              << "  --scenario <name>    Run only the given scenario, can be repeated (default: all)\n"
+              << "  --scale <factor>     Multiply the size of the generated projects (default: 1)\n"
+              << "  --frames <first-last> Frame range rendered by the render benchmarks (default: 1-10)\n"
+              << "  --format <WxH>       Project format (default: 1920x1080)\n"
+              << "  --iterations <n>     Repetitions of the hash and parameter benchmarks (default: 10)\n"
+              << "  --work-dir <dir>     Directory where the projects are saved and loaded (default: temporary directory)\n"
+              << "  --output <file>      Write the JSON results to file instead of the standard output\n"
+              << "  --help               Print this help\n\n"
+              << "Scenarios:\n";
+    for (std::list<ProjectGenerator>::const_iterator it = generators.begin(); it != generators.end(); ++it) {
+        std::cout << "  " << it->name << " (size " << it->defaultSize << "): " << it->description << "\n";
+    }
+}
+
+int
+main(int argc,
+     char *argv[])
+{
+    BenchmarkOptions options;
+    std::string outputFile;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : 0;
+        if ( !std::strcmp(arg, "--help") || !std::strcmp(arg, "-h") ) {
+            printUsage(argv[0]);
+
+            return 0;
+        }
+        if (!value) {
+            std::cerr << "Missing value or unknown option: " << arg << std::endl;
+
+            return 1;
+        }
+        if ( !std::strcmp(arg, "--scenario") ) {
+            options.scenarios.push_back(value);
+        } else if ( !std::strcmp(arg, "--scale") ) {
+            options.scale = std::strtod(value, 0);
+        } else if ( !std::strcmp(arg, "--frames") ) {
+            if (std::sscanf(value, "%d-%d", &options.firstFrame, &options.lastFrame) != 2) {
+                std::cerr << "Invalid frame range: " << value << std::endl;
+
+                return 1;
+            }
+        } else if ( !std::strcmp(arg, "--format") ) {
+            if ( (std::sscanf(value, "%dx%d", &options.width, &options.height) != 2) || (options.width <= 0) || (options.height <= 0) ) {
+                std::cerr << "Invalid format: " << value << std::endl;
+
+                return 1;
+            }
+        } else if ( !std::strcmp(arg, "--iterations") ) {
+            options.iterations = std::atoi(value);
+        } else if ( !std::strcmp(arg, "--work-dir") ) {
+            options.workDir = QString::fromUtf8(value);
+        } else if ( !std::strcmp(arg, "--output") ) {
+            outputFile = value;
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+
+            return 1;
+        }
+        ++i;
+    }
+    if ( (options.scale <= 0.) || (options.iterations <= 0) || (options.lastFrame < options.firstFrame) ) {
+        std::cerr << "Invalid options, use --help to print usage." << std::endl;
+
+        return 1;
+    }
+
+    // Declared before the engine so that the messages it prints when it is destroyed do not end up in the results
+    StdoutToStderrRedirection redirection;
+
+    // Load the engine in background mode, without reading the user settings so that the results do not depend on them
+    BenchmarkAppManager manager;
+    {
+        int qargc = 0;
+        QStringList args;
+        args << QString::fromUtf8("--clear-cache");
+        args << QString::fromUtf8("--no-settings");
+        CLArgs cl(args, true);
+        if ( !manager.load(qargc, 0, cl) ) {
+            std::cerr << "Failed to load the engine" << std::endl;
+
+            return 1;
+        }
+    }
+
+    BenchmarkRunner runner(options);
+    bool ok;
+    if ( outputFile.empty() ) {
+        std::ostream results( redirection.getStdoutBuffer() );
+        ok = runner.run(results);
+        results.flush();
+    } else {
+        std::ofstream ofile( outputFile.c_str() );
+        if ( !ofile.good() ) {
+            std::cerr << "Could not open " << outputFile << " for writing" << std::endl;
+
+            return 1;
+        }
+        ok = runner.run(ofile);
+    }
+
+    return ok ? 0 : 1;
+} // main
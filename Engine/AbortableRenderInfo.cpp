@@ -54,6 +54,7 @@ struct AbortableRenderInfoPrivate
 {
     AbortableRenderInfo* _p;
     bool canAbort;
+    bool isSpeculative;
     QAtomicInt aborted;
     U64 age;
     mutable QMutex threadsMutex;
@@ -65,9 +66,11 @@ struct AbortableRenderInfoPrivate
 
     AbortableRenderInfoPrivate(AbortableRenderInfo* p,
                                bool canAbort,
-                               U64 age)
+                               U64 age,
+                               bool isSpeculative)
         : _p(p)
         , canAbort(canAbort)
+        , isSpeculative(isSpeculative)
         , aborted()
         , age(age)
         , threadsMutex()
@@ -86,13 +89,14 @@ struct AbortableRenderInfoPrivate
 };
 
 AbortableRenderInfo::AbortableRenderInfo()
-    : _imp( new AbortableRenderInfoPrivate(this, true, 0) )
+    : _imp( new AbortableRenderInfoPrivate(this, true, 0, false) )
 {
 }
 
 AbortableRenderInfo::AbortableRenderInfo(bool canAbort,
-                                         U64 age)
-    : _imp( new AbortableRenderInfoPrivate(this, canAbort, age) )
+                                         U64 age,
+                                         bool isSpeculative)
+    : _imp( new AbortableRenderInfoPrivate(this, canAbort, age, isSpeculative) )
 {
 }
 
@@ -116,6 +120,12 @@ AbortableRenderInfo::canAbort() const
     return _imp->canAbort;
 }
 
+bool
+AbortableRenderInfo::isSpeculative() const
+{
+    return _imp->isSpeculative;
+}
+
 bool
 AbortableRenderInfo::isAborted() const
 {
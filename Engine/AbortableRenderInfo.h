@@ -70,9 +70,11 @@ private:
      * The render age identifies one single frame render in the Viewer. The older a render is, the smaller its render age is.
      * This is used in the Viewer keep and order on the render requests, even though each request runs concurrently of another.
      * This is not used by playback since in playback the ordering is controlled by the frame number.
+     * isSpeculative is true for the frames rendered in advance by the viewer when it is idle.
      **/
     AbortableRenderInfo(bool canAbort,
-                        U64 age);
+                        U64 age,
+                        bool isSpeculative = false);
 
     /**
      * @brief Same as AbortableRenderInfo(true, 0)
@@ -89,9 +91,10 @@ public:
     //}
 
     static AbortableRenderInfoPtr create(bool canAbort,
-                                                         U64 age)
+                                                         U64 age,
+                                                         bool isSpeculative = false)
     {
-        return AbortableRenderInfoPtr( new AbortableRenderInfo(canAbort, age) );
+        return AbortableRenderInfoPtr( new AbortableRenderInfo(canAbort, age, isSpeculative) );
     }
 
     static AbortableRenderInfoPtr create()
@@ -104,6 +107,9 @@ public:
     // Is this render abortable ?
     bool canAbort() const;
 
+    // Is this a frame rendered in advance by the viewer when it is idle ?
+    bool isSpeculative() const;
+
     // Is this render aborted ? This is extremely fast as it just dereferences an atomic integer
     bool isAborted() const;
 
@@ -26,6 +26,8 @@
 
 #include <fstream>
 #include <list>
+#include <map>
+#include <set>
 #include <cassert>
 #include <stdexcept>
 #include <sstream> // stringstream
@@ -37,6 +39,7 @@
 #include <QtCore/QUrl>
 #include <QtCore/QFileInfo>
 #include <QtCore/QEventLoop>
+#include <QtCore/QPointer>
 #include <QtCore/QSettings>
 #include <QtNetwork/QNetworkReply>
 
@@ -71,6 +74,7 @@ CLANG_DIAG_ON(unknown-pragmas)
 #include "Engine/ProcessHandler.h"
 #include "Engine/ReadNode.h"
 #include "Engine/Settings.h"
+#include "Engine/ViewerInstance.h"
 #include "Engine/WriteNode.h"
 
 NATRON_NAMESPACE_ENTER
@@ -169,6 +173,16 @@ public:
 
     ProjectBeingLoadedInfo projectBeingLoaded;
 
+    // Change transactions, only used on the main thread
+    int changeTransactionLevel;
+    bool committingChangeTransaction;
+    // Holders whose changes are deferred, in the order of their first change
+    std::list<QPointer<KnobHolder> > transactionHolders;
+    // Holders whose renders were aborted by a significant change, only used for identity
+    std::set<KnobHolder*> transactionAbortedHolders;
+    std::map<Node*, NodeWPtr> transactionHashNodes;
+    std::map<Node*, NodeWPtr> transactionViewers;
+
     AppInstancePrivate(int appID,
                        AppInstance* app)
 
@@ -187,9 +201,17 @@ public:
         , invalidExprKnobsMutex()
         , invalidExprKnobs()
         , projectBeingLoaded()
+        , changeTransactionLevel(0)
+        , committingChangeTransaction(false)
+        , transactionHolders()
+        , transactionAbortedHolders()
+        , transactionHashNodes()
+        , transactionViewers()
     {
     }
 
+    void flushChangeTransaction();
+
     void declareCurrentAppVariable_Python();
 
 
@@ -230,6 +252,165 @@ AppInstance::setProjectBeingLoadedInfo(const ProjectBeingLoadedInfo& info)
     _imp->projectBeingLoaded = info;
 }
 
+void
+AppInstance::beginChangeTransaction()
+{
+    if ( QThread::currentThread() != qApp->thread() ) {
+        return;
+    }
+    ++_imp->changeTransactionLevel;
+}
+
+void
+AppInstance::commitChangeTransaction()
+{
+    if ( ( QThread::currentThread() != qApp->thread() ) || (_imp->changeTransactionLevel == 0) ) {
+        return;
+    }
+    --_imp->changeTransactionLevel;
+
+    // A transaction opened by a handler during the commit is flushed by the outer commit
+    if ( (_imp->changeTransactionLevel > 0) || _imp->committingChangeTransaction ) {
+        return;
+    }
+    _imp->flushChangeTransaction();
+}
+
+bool
+AppInstance::isChangeTransactionActive() const
+{
+    if ( QThread::currentThread() != qApp->thread() ) {
+        return false;
+    }
+
+    return _imp->changeTransactionLevel > 0 || _imp->committingChangeTransaction;
+}
+
+void
+AppInstance::flushChangeTransaction()
+{
+    // A flush requested by a handler run during the commit is a no-op: the commit itself is flushing
+    if ( !isChangeTransactionActive() || _imp->committingChangeTransaction ) {
+        return;
+    }
+    _imp->flushChangeTransaction();
+}
+
+bool
+AppInstance::deferHolderChanges(KnobHolder* holder,
+                                bool significant)
+{
+    if ( !holder || !isChangeTransactionActive() ) {
+        return false;
+    }
+    // The flag tells whether the holder is already in the list
+    if ( !holder->areChangesDeferred() ) {
+        holder->setChangesDeferred(true);
+        _imp->transactionHolders.push_back( QPointer<KnobHolder>(holder) );
+    }
+
+    // The evaluation only happens when the transaction is committed: abort the renders using the previous
+    // values now rather than letting them run until the commit. Do it once per holder, the abort walks the outputs.
+    if ( significant && _imp->transactionAbortedHolders.insert(holder).second ) {
+        holder->abortAnyEvaluation();
+    }
+
+    return true;
+}
+
+bool
+AppInstance::deferNodeHashComputation(const NodePtr& node)
+{
+    if ( !node || !isChangeTransactionActive() ) {
+        return false;
+    }
+    bool inserted = _imp->transactionHashNodes.insert( std::make_pair( node.get(), NodeWPtr(node) ) ).second;
+    if (inserted) {
+        // Renders started with the previous hash would cache results that the commit invalidates
+        EffectInstancePtr effect = node->getEffectInstance();
+        if (effect) {
+            effect->abortAnyEvaluation();
+        }
+    }
+
+    return true;
+}
+
+bool
+AppInstance::deferViewerRender(ViewerInstance* viewer)
+{
+    if ( !viewer || !isChangeTransactionActive() ) {
+        return false;
+    }
+    NodePtr node = viewer->getNode();
+    if (!node) {
+        return false;
+    }
+    _imp->transactionViewers[node.get()] = node;
+
+    return true;
+}
+
+void
+AppInstancePrivate::flushChangeTransaction()
+{
+    assert( QThread::currentThread() == qApp->thread() );
+    {
+        FlagSetter committing(true, &committingChangeTransaction);
+
+        // Run the knobChanged handlers and the evaluation of each holder once. The handlers may change
+        // other knobs which defers their holder again: loop until everything is flushed.
+        while ( !transactionHolders.empty() ) {
+            std::list<QPointer<KnobHolder> > holders;
+            holders.swap(transactionHolders);
+            for (std::list<QPointer<KnobHolder> >::iterator it = holders.begin(); it != holders.end(); ++it) {
+                KnobHolder* holder = *it;
+                if (!holder) {
+                    continue;
+                }
+                holder->setChangesDeferred(false);
+                holder->beginChanges();
+                holder->endChanges();
+            }
+        }
+        transactionAbortedHolders.clear();
+    }
+
+    // Recompute the hashes once, in topological order
+    NodesList hashNodes;
+    for (std::map<Node*, NodeWPtr>::iterator it = transactionHashNodes.begin(); it != transactionHashNodes.end(); ++it) {
+        NodePtr node = it->second.lock();
+        if (node) {
+            hashNodes.push_back(node);
+        }
+    }
+    transactionHashNodes.clear();
+    if ( !hashNodes.empty() ) {
+        Node::computeHashOfNodes(hashNodes);
+    }
+
+    // Then render each viewer once, including the viewers downstream of a node whose hash was deferred
+    std::map<Node*, NodeWPtr> viewers;
+    viewers.swap(transactionViewers);
+    for (NodesList::iterator it = hashNodes.begin(); it != hashNodes.end(); ++it) {
+        std::list<ViewerInstance*> connectedViewers;
+        (*it)->hasViewersConnected(&connectedViewers);
+        for (std::list<ViewerInstance*>::iterator it2 = connectedViewers.begin(); it2 != connectedViewers.end(); ++it2) {
+            NodePtr viewerNode = (*it2)->getNode();
+            if (viewerNode) {
+                viewers[viewerNode.get()] = viewerNode;
+            }
+        }
+    }
+    for (std::map<Node*, NodeWPtr>::iterator it = viewers.begin(); it != viewers.end(); ++it) {
+        NodePtr node = it->second.lock();
+        ViewerInstance* viewer = node ? node->isEffectViewer() : 0;
+        if (viewer) {
+            viewer->renderCurrentFrame(true);
+        }
+    }
+} // AppInstancePrivate::flushChangeTransaction
+
 const std::list<NodePtr>&
 AppInstance::getNodesBeingCreated() const
 {
@@ -588,83 +769,8 @@ AppInstance::loadInternal(const CLArgs& cl,
     ///if the app is a background project autorun and the project name is empty just throw an exception.
     if ( ( (appPTR->getAppType() == AppManager::eAppTypeBackgroundAutoRun) ||
            ( appPTR->getAppType() == AppManager::eAppTypeBackgroundAutoRunLaunchedFromGui) ) ) {
-        const QString& scriptFilename =  cl.getScriptFilename();
-
-        if ( scriptFilename.isEmpty() ) {
-            // cannot start a background process without a file
-            throw std::invalid_argument( tr("Project file name is empty.").toStdString() );
-        }
-
-
-        QFileInfo info(scriptFilename);
-        if ( !info.exists() ) {
-            throw std::invalid_argument( tr("%1: No such file.").arg(scriptFilename).toStdString() );
-        }
-
-        std::list<AppInstance::RenderWork> writersWork;
-
-
-        if ( info.suffix() == QString::fromUtf8(NATRON_PROJECT_FILE_EXT) ) {
-            ///Load the project
-            if ( !_imp->_currentProject->loadProject( info.path(), info.fileName() ) ) {
-                throw std::invalid_argument( tr("Project file loading failed.").toStdString() );
-            }
-        } else if ( info.suffix() == QString::fromUtf8("py") ) {
-            ///Load the python script
-            loadPythonScript(info);
-        } else {
-            throw std::invalid_argument( tr("%1 only accepts python scripts or .ntp project files.").arg( QString::fromUtf8(NATRON_APPLICATION_NAME) ).toStdString() );
-        }
-
-        // exec the python script specified via --onload
-        const QString& extraOnProjectCreatedScript = cl.getDefaultOnProjectLoadedScript();
-        if ( !extraOnProjectCreatedScript.isEmpty() ) {
-            QFileInfo cbInfo(extraOnProjectCreatedScript);
-            if ( cbInfo.exists() ) {
-                loadPythonScript(cbInfo);
-            }
-        }
-
-
-        getWritersWorkForCL(cl, writersWork);
-
-
-        ///Set reader parameters if specified from the command-line
-        const std::list<CLArgs::ReaderArg>& readerArgs = cl.getReaderArgs();
-        for (std::list<CLArgs::ReaderArg>::const_iterator it = readerArgs.begin(); it != readerArgs.end(); ++it) {
-            std::string readerName = it->name.toStdString();
-            NodePtr readNode = getNodeByFullySpecifiedName(readerName);
-
-            if (!readNode) {
-                std::string exc( tr("%1 does not belong to the project file. Please enter a valid Read node script-name.").arg( QString::fromUtf8( readerName.c_str() ) ).toStdString() );
-                throw std::invalid_argument(exc);
-            } else {
-                if ( !readNode->getEffectInstance()->isReader() ) {
-                    std::string exc( tr("%1 is not a Read node! It cannot render anything.").arg( QString::fromUtf8( readerName.c_str() ) ).toStdString() );
-                    throw std::invalid_argument(exc);
-                }
-            }
-
-            if ( it->filename.isEmpty() ) {
-                std::string exc( tr("%1: Filename specified is empty but [-i] or [--reader] was passed to the command-line.").arg( QString::fromUtf8( readerName.c_str() ) ).toStdString() );
-                throw std::invalid_argument(exc);
-            }
-            KnobIPtr fileKnob = readNode->getKnobByName(kOfxImageEffectFileParamName);
-            if (fileKnob) {
-                KnobFile* outFile = dynamic_cast<KnobFile*>( fileKnob.get() );
-                if (outFile) {
-                    outFile->setValue( it->filename.toStdString() );
-                }
-            }
-        }
-
-        ///launch renders
-        if ( !writersWork.empty() ) {
-            startWritersRendering(false, writersWork);
-        } else {
-            std::list<std::string> writers;
-            startWritersRenderingFromNames( cl.areRenderStatsEnabled(), false, writers, cl.getFrameRanges() );
-        }
+        loadProjectFromCommandLine(cl);
+        renderFromCommandLine(cl);
     } else if (appPTR->getAppType() == AppManager::eAppTypeInterpreter) {
         QFileInfo info( cl.getScriptFilename() );
         if ( info.exists() ) {
@@ -702,6 +808,90 @@ AppInstance::loadInternal(const CLArgs& cl,
     }
 } // AppInstance::load
 
+void
+AppInstance::loadProjectFromCommandLine(const CLArgs& cl)
+{
+    const QString& scriptFilename =  cl.getScriptFilename();
+
+    if ( scriptFilename.isEmpty() ) {
+        // cannot start a background process without a file
+        throw std::invalid_argument( tr("Project file name is empty.").toStdString() );
+    }
+
+
+    QFileInfo info(scriptFilename);
+    if ( !info.exists() ) {
+        throw std::invalid_argument( tr("%1: No such file.").arg(scriptFilename).toStdString() );
+    }
+
+    if ( info.suffix() == QString::fromUtf8(NATRON_PROJECT_FILE_EXT) ) {
+        ///Load the project
+        if ( !_imp->_currentProject->loadProject( info.path(), info.fileName() ) ) {
+            throw std::invalid_argument( tr("Project file loading failed.").toStdString() );
+        }
+    } else if ( info.suffix() == QString::fromUtf8("py") ) {
+        ///Load the python script
+        loadPythonScript(info);
+    } else {
+        throw std::invalid_argument( tr("%1 only accepts python scripts or .ntp project files.").arg( QString::fromUtf8(NATRON_APPLICATION_NAME) ).toStdString() );
+    }
+
+    // exec the python script specified via --onload
+    const QString& extraOnProjectCreatedScript = cl.getDefaultOnProjectLoadedScript();
+    if ( !extraOnProjectCreatedScript.isEmpty() ) {
+        QFileInfo cbInfo(extraOnProjectCreatedScript);
+        if ( cbInfo.exists() ) {
+            loadPythonScript(cbInfo);
+        }
+    }
+} // AppInstance::loadProjectFromCommandLine
+
+void
+AppInstance::renderFromCommandLine(const CLArgs& cl)
+{
+    std::list<AppInstance::RenderWork> writersWork;
+
+    getWritersWorkForCL(cl, writersWork);
+
+
+    ///Set reader parameters if specified from the command-line
+    const std::list<CLArgs::ReaderArg>& readerArgs = cl.getReaderArgs();
+    for (std::list<CLArgs::ReaderArg>::const_iterator it = readerArgs.begin(); it != readerArgs.end(); ++it) {
+        std::string readerName = it->name.toStdString();
+        NodePtr readNode = getNodeByFullySpecifiedName(readerName);
+
+        if (!readNode) {
+            std::string exc( tr("%1 does not belong to the project file. Please enter a valid Read node script-name.").arg( QString::fromUtf8( readerName.c_str() ) ).toStdString() );
+            throw std::invalid_argument(exc);
+        } else {
+            if ( !readNode->getEffectInstance()->isReader() ) {
+                std::string exc( tr("%1 is not a Read node! It cannot render anything.").arg( QString::fromUtf8( readerName.c_str() ) ).toStdString() );
+                throw std::invalid_argument(exc);
+            }
+        }
+
+        if ( it->filename.isEmpty() ) {
+            std::string exc( tr("%1: Filename specified is empty but [-i] or [--reader] was passed to the command-line.").arg( QString::fromUtf8( readerName.c_str() ) ).toStdString() );
+            throw std::invalid_argument(exc);
+        }
+        KnobIPtr fileKnob = readNode->getKnobByName(kOfxImageEffectFileParamName);
+        if (fileKnob) {
+            KnobFile* outFile = dynamic_cast<KnobFile*>( fileKnob.get() );
+            if (outFile) {
+                outFile->setValue( it->filename.toStdString() );
+            }
+        }
+    }
+
+    ///launch renders
+    if ( !writersWork.empty() ) {
+        startWritersRendering(false, writersWork);
+    } else {
+        std::list<std::string> writers;
+        startWritersRenderingFromNames( cl.areRenderStatsEnabled(), false, writers, cl.getFrameRanges() );
+    }
+} // AppInstance::renderFromCommandLine
+
 bool
 AppInstance::loadPythonScript(const QFileInfo& file)
 {
@@ -1757,6 +1947,8 @@ AppInstance::startWritersRendering(bool doBlockingRender,
         return;
     }
 
+    // The render must see the hashes and values of the changes recorded so far by a change transaction
+    flushChangeTransaction();
 
     bool renderInSeparateProcess = appPTR->getCurrentSettings()->isRenderInSeparatedProcessEnabled();
     QString savePath;
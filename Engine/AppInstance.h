@@ -145,14 +145,27 @@ public:
 
     void load(const CLArgs& cl, bool makeEmptyInstance);
 
+    /**
+     * @brief Loads the project or Python script given on the command-line, as well as the script
+     * passed to --onload. Throws an exception on failure.
+     **/
+    void loadProjectFromCommandLine(const CLArgs& cl);
+
+    /**
+     * @brief Applies the reader/writer overrides given on the command-line to the currently loaded
+     * project and renders the requested writers (or all writers if none was specified).
+     * Throws an exception on failure.
+     **/
+    void renderFromCommandLine(const CLArgs& cl);
+
 protected:
 
     virtual void loadInternal(const CLArgs& cl, bool makeEmptyInstance);
 
-    void executeCommandLinePythonCommands(const CLArgs& args);
-
 public:
 
+    void executeCommandLinePythonCommands(const CLArgs& args);
+
     int getAppID() const;
 
     void exportDocs(const QString path);
@@ -418,6 +431,47 @@ public:
     const ProjectBeingLoadedInfo& getProjectBeingLoadedInfo() const;
     void setProjectBeingLoadedInfo(const ProjectBeingLoadedInfo& info);
 
+    /**
+     * @brief Opens a change transaction. Until the outermost matching commitChangeTransaction() call,
+     * knob value changes made on the main thread are only recorded: the knobChanged handlers, the node hashes
+     * and the viewer renders are deferred. Transactions may be nested.
+     * This is a no-op when not called from the main thread.
+     **/
+    void beginChangeTransaction();
+
+    /**
+     * @brief Closes a change transaction opened with beginChangeTransaction(). When the outermost transaction
+     * is committed, the knobChanged handlers of each modified holder run once, the hashes of the modified nodes
+     * and their outputs are recomputed once in topological order and each viewer affected is rendered once.
+     **/
+    void commitChangeTransaction();
+
+    bool isChangeTransactionActive() const;
+
+    /**
+     * @brief Applies the changes recorded so far by the active change transaction without closing it, so that
+     * a render started now sees the current values and hashes. This is a no-op when no transaction is active.
+     **/
+    void flushChangeTransaction();
+
+    /**
+     * @brief Called when a holder records a change. Returns true if the holder joined the active transaction,
+     * in which case its endChanges() calls must not run the knobChanged handlers.
+     * The first significant change of the holder in the transaction aborts the renders using its previous values.
+     **/
+    bool deferHolderChanges(KnobHolder* holder, bool significant);
+
+    /**
+     * @brief Returns true if the hash computation of the given node was postponed to the commit of the active transaction.
+     * The renders using the previous hash are aborted the first time the node is postponed.
+     **/
+    bool deferNodeHashComputation(const NodePtr& node);
+
+    /**
+     * @brief Returns true if the render of the given viewer was postponed to the commit of the active transaction.
+     **/
+    bool deferViewerRender(ViewerInstance* viewer);
+
 public Q_SLOTS:
 
     void quit();
@@ -495,6 +549,33 @@ public:
     }
 };
 
+/**
+ * @brief Opens a change transaction on the given app for the lifetime of the object.
+ **/
+class ChangeTransaction_RAII
+{
+    AppInstanceWPtr _app;
+
+public:
+
+    ChangeTransaction_RAII(const AppInstancePtr& app)
+        : _app(app)
+    {
+        if (app) {
+            app->beginChangeTransaction();
+        }
+    }
+
+    ~ChangeTransaction_RAII()
+    {
+        AppInstancePtr a = _app.lock();
+
+        if (a) {
+            a->commitChangeTransaction();
+        }
+    }
+};
+
 NATRON_NAMESPACE_EXIT
 
 #endif // APPINSTANCE_H
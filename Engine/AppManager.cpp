@@ -112,9 +112,12 @@
 #include "Engine/FileSystemModel.h"
 #include "Engine/GroupInput.h"
 #include "Engine/GroupOutput.h"
+#include "Engine/ImageBufferNode.h"
+#include "Engine/ImageBufferPool.h"
 #include "Engine/JoinViewsNode.h"
 #include "Engine/LibraryBinary.h"
 #include "Engine/Log.h"
+#include "Engine/MemoryGovernor.h"
 #include "Engine/MemoryInfo.h" // getSystemTotalRAM, printAsRAM
 #include "Engine/Node.h"
 #include "Engine/OfxImageEffectInstance.h"
@@ -126,11 +129,14 @@
 #include "Engine/Project.h"
 #include "Engine/PrecompNode.h"
 #include "Engine/ReadNode.h"
+#include "Engine/RenderServer.h"
+#include "Engine/RenderTaskScheduler.h"
 #include "Engine/RotoPaint.h"
 #include "Engine/RotoSmear.h"
 #include "Engine/StandardPaths.h"
 #include "Engine/TrackerNode.h"
 #include "Engine/ThreadPool.h"
+#include "Engine/Timer.h"
 #include "Engine/ViewIdx.h"
 #include "Engine/ViewerInstance.h" // RenderStatsMap
 #include "Engine/WriteNode.h"
@@ -580,6 +586,7 @@ AppManager::~AppManager()
     }
 
     _imp->_backgroundIPC.reset();
+    _imp->_renderServer.reset();
 
     try {
         _imp->saveCaches();
@@ -590,6 +597,12 @@ AppManager::~AppManager()
     ///Caches may have launched some threads to delete images, wait for them to be done
     QThreadPool::globalInstance()->waitForDone();
 
+    if ( isBackground() ) {
+        std::cerr << getNodeCacheStatisticsString().toStdString() << std::endl;
+        std::cerr << ImageBufferPool::printStatistics( ImageBufferPool::getStatistics() ).toStdString() << std::endl;
+        std::cerr << RenderTaskScheduler::printStatistics( RenderTaskScheduler::getStatistics() ).toStdString() << std::endl;
+    }
+
     ///Kill caches now because decreaseNCacheFilesOpened can be called
     _imp->_nodeCache->waitForDeleterThread();
     _imp->_diskCache->waitForDeleterThread();
@@ -1071,6 +1084,9 @@ AppManager::loadInternalAfterInitGui(const CLArgs& cl)
         _imp->_nodeCache = boost::make_shared<Cache<Image> >("NodeCache", NATRON_CACHE_VERSION, maxCacheRAM, 1.);
         _imp->_diskCache = boost::make_shared<Cache<Image> >("DiskCache", NATRON_CACHE_VERSION, maxDiskCacheNode, 0.);
         _imp->_viewerCache = boost::make_shared<Cache<FrameEntry> >("ViewerCache", NATRON_CACHE_VERSION, viewerCacheSize, 0.);
+        _imp->_nodeCache->setEvictionPolicy( _imp->_settings->getCacheEvictionPolicy() );
+        _imp->_diskCache->setEvictionPolicy( _imp->_settings->getCacheEvictionPolicy() );
+        _imp->applyBufferPoolBudget();
         _imp->setViewerCacheTileSize();
     } catch (std::logic_error) {
         // ignore
@@ -1119,6 +1135,8 @@ AppManager::loadInternalAfterInitGui(const CLArgs& cl)
 
     if ( cl.isInterpreterMode() ) {
         _imp->_appType = eAppTypeInterpreter;
+    } else if ( cl.isRenderServerMode() ) {
+        _imp->_appType = eAppTypeBackgroundRenderServer;
     } else if ( isBackground() ) {
         if ( !cl.getScriptFilename().isEmpty() ) {
             if ( !cl.getIPCPipeName().isEmpty() ) {
@@ -1142,7 +1160,8 @@ AppManager::loadInternalAfterInitGui(const CLArgs& cl)
         args = cl;
     }
 
-    AppInstancePtr mainInstance = newAppInstance(args, false);
+    // The render server starts with an empty project: projects are loaded on demand by each job
+    AppInstancePtr mainInstance = newAppInstance(args, _imp->_appType == eAppTypeBackgroundRenderServer);
 
     hideSplashScreen();
 
@@ -1153,9 +1172,24 @@ AppManager::loadInternalAfterInitGui(const CLArgs& cl)
     } else {
         onLoadCompleted();
 
+        if (_imp->_appType == eAppTypeBackgroundRenderServer) {
+            _imp->_renderServer.reset( new RenderServer(mainInstance) );
+            if ( !_imp->_renderServer->listen( cl.getRenderServerName() ) ) {
+                _imp->_renderServer.reset();
+                mainInstance->quitNow();
+
+                return false;
+            }
+
+            // Serve jobs until a client asks the server to quit
+            exec();
+            _imp->_renderServer.reset();
+        }
+
         ///In background project auto-run the rendering is finished at this point, just exit the instance
         if ( ( (_imp->_appType == eAppTypeBackgroundAutoRun) ||
                ( _imp->_appType == eAppTypeBackgroundAutoRunLaunchedFromGui) ||
+               ( _imp->_appType == eAppTypeBackgroundRenderServer) ||
                ( _imp->_appType == eAppTypeInterpreter) ) && mainInstance ) {
             bool wasKilled = true;
             const AppInstanceVec& instances = appPTR->getAppInstances();
@@ -1489,10 +1523,11 @@ AppManager::writeToOutputPipe(const QString & longMessage,
 void
 AppManager::setApplicationsCachesMaximumMemoryPercent(double p)
 {
-    size_t maxCacheRAM = p * getSystemTotalRAM_conditionnally();
+    size_t maxCacheRAM = p * getSystemTotalRAM_conditionnally() * _imp->memoryGovernor->getStatus().cacheBudgetFactor;
 
     _imp->_nodeCache->setMaximumCacheSize(maxCacheRAM);
     _imp->_nodeCache->setMaximumInMemorySize(1);
+    _imp->applyBufferPoolBudget();
 }
 
 void
@@ -1507,6 +1542,42 @@ AppManager::setApplicationsCachesMaximumDiskSpace(unsigned long long size)
     _imp->_diskCache->setMaximumCacheSize(size);
 }
 
+void
+AppManager::setApplicationsCachesEvictionPolicy(CacheEvictionPolicyEnum policy)
+{
+    if ( !_imp->_nodeCache || !_imp->_diskCache || (_imp->_nodeCache->getEvictionPolicy() == policy) ) {
+        return;
+    }
+    CacheStatistics stats = _imp->_nodeCache->getStatistics();
+    if (stats.hits + stats.misses > 0) {
+        QString message = getNodeCacheStatisticsString();
+        writeToErrorLog_mt_safe( tr("Cache"), QDateTime::currentDateTime(), message );
+        if ( isBackground() ) {
+            std::cout << tr("Cache").toStdString() << ": " << message.toStdString() << std::endl;
+        }
+    }
+    _imp->_nodeCache->setEvictionPolicy(policy);
+    _imp->_diskCache->setEvictionPolicy(policy);
+    _imp->_nodeCache->resetStatistics();
+}
+
+QString
+AppManager::getNodeCacheStatisticsString() const
+{
+    if (!_imp->_nodeCache) {
+        return QString();
+    }
+    CacheStatistics stats = _imp->_nodeCache->getStatistics();
+    QString policy = _imp->_nodeCache->getEvictionPolicy() == eCacheEvictionPolicyCostAware ? tr("cost-aware") : tr("LRU");
+
+    return tr("Node cache (%1 eviction): %2 hits, %3 misses, hit ratio %4%, %5 of rendering saved")
+           .arg(policy)
+           .arg(stats.hits)
+           .arg(stats.misses)
+           .arg(stats.getHitRatio() * 100., 0, 'f', 1)
+           .arg( Timer::printAsTime(stats.savedTime, false) );
+}
+
 void
 AppManager::loadAllPlugins()
 {
@@ -1661,6 +1732,8 @@ AppManager::loadBuiltinNodePlugins(IOPluginsMap* /*readersMap*/,
     registerBuiltInPlugin<TrackerNode>(QString::fromUtf8(NATRON_IMAGES_PATH "trackerNodeIcon.png"), false, false);
     registerBuiltInPlugin<JoinViewsNode>(QString::fromUtf8(NATRON_IMAGES_PATH "joinViewsNode.png"), false, false);
     registerBuiltInPlugin<OneViewNode>(QString::fromUtf8(NATRON_IMAGES_PATH "oneViewNode.png"), false, false);
+    // Only useful from Python, see Effect::createImageBuffer
+    registerBuiltInPlugin<ImageBufferNode>(QString::fromUtf8(""), false, true);
 #ifdef NATRON_ENABLE_IO_META_NODES
     registerBuiltInPlugin<ReadNode>(QString::fromUtf8(NATRON_IMAGES_PATH "readImage.png"), false, false);
     registerBuiltInPlugin<WriteNode>(QString::fromUtf8(NATRON_IMAGES_PATH "writeImage.png"), false, false);
@@ -2504,6 +2577,13 @@ AppManager::getImage(const ImageKey & key,
     return _imp->_nodeCache->get(key, returnValue);
 }
 
+bool
+AppManager::peekImage(const ImageKey & key,
+                      std::list<ImagePtr>* returnValue) const
+{
+    return _imp->_nodeCache->peek(key, returnValue);
+}
+
 bool
 AppManager::getImageOrCreate(const ImageKey & key,
                              const ImageParamsPtr& params,
@@ -2557,7 +2637,8 @@ AppManager::isAggressiveCachingEnabled() const
 U64
 AppManager::getCachesTotalMemorySize() const
 {
-    return  _imp->_nodeCache->getMemoryCacheSize();
+    // Free buffers kept for reuse are not returned to the system, count them as well
+    return  _imp->_nodeCache->getMemoryCacheSize() + ImageBufferPool::getStatistics().pooledBytes;
 }
 
 U64
@@ -2867,10 +2948,20 @@ AppManager::isNodeCacheAlmostFull() const
 void
 AppManager::checkCacheFreeMemoryIsGoodEnough()
 {
+    updateMemoryGovernor();
+
     ///Before allocating the memory check that there's enough space to fit in memory
     size_t systemRAMToKeepFree = getSystemTotalRAM() * appPTR->getCurrentSettings()->getUnreachableRamPercent();
     size_t totalFreeRAM = getAmountFreePhysicalRAM();
 
+    if (totalFreeRAM <= systemRAMToKeepFree) {
+        // Give the free image buffers back to the system before evicting cached images
+        ImageBufferPool::trim(0);
+        // The cgroup usage is only read when sampled: sample it again to see what was released
+        updateMemoryGovernor(true);
+        totalFreeRAM = getAmountFreePhysicalRAM();
+    }
+
     while (totalFreeRAM <= systemRAMToKeepFree) {
 #ifdef NATRON_DEBUG_CACHE
         qDebug() << "Total system free RAM is below the threshold:" << printAsRAM(totalFreeRAM)
@@ -2880,11 +2971,38 @@ AppManager::checkCacheFreeMemoryIsGoodEnough()
             break;
         }
 
-
+        updateMemoryGovernor(true);
         totalFreeRAM = getAmountFreePhysicalRAM();
     }
 }
 
+void
+AppManager::updateMemoryGovernor(bool force)
+{
+    if ( !_imp->memoryGovernor->update(force) ) {
+        return;
+    }
+    _imp->applyMemoryGovernorBudgets();
+
+    QString message = MemoryGovernor::printStatus( _imp->memoryGovernor->getStatus() );
+    writeToErrorLog_mt_safe( tr("Memory Governor"), QDateTime::currentDateTime(), message );
+    if ( isBackground() ) {
+        std::cerr << tr("Memory Governor").toStdString() << ": " << message.toStdString() << std::endl;
+    }
+}
+
+MemoryGovernorStatus
+AppManager::getMemoryGovernorStatus() const
+{
+    return _imp->memoryGovernor->getStatus();
+}
+
+int
+AppManager::getMaxParallelRendersForMemory(int nRenders) const
+{
+    return _imp->memoryGovernor->throttleParallelRenders(nRenders);
+}
+
 void
 AppManager::onOCIOConfigPathChanged(const std::string& path)
 {
@@ -109,6 +109,8 @@ public:
 
         eAppTypeBackgroundAutoRunLaunchedFromGui, //same as eAppTypeBackgroundAutoRun but a bg process launched by GUI of a main process
 
+        eAppTypeBackgroundRenderServer, //< a background AppInstance that stays alive and renders the jobs it receives on a local socket
+
         eAppTypeInterpreter, //< running in Python interpreter mode
 
         eAppTypeGui //< a GUI AppInstance, the end-user can interact with it.
@@ -198,6 +200,11 @@ public:
      **/
     bool getImage(const ImageKey & key, std::list<ImagePtr>* returnValue) const;
 
+    /**
+     * @brief Same as getImage, but the images found are not marked as used and the lookup is not counted in the cache statistics.
+     **/
+    bool peekImage(const ImageKey & key, std::list<ImagePtr>* returnValue) const;
+
     /**
      * @brief Same as getImage, but if it couldn't find a matching image in the cache, it will create one with the given parameters.
      **/
@@ -227,6 +234,17 @@ public:
 
     void setApplicationsCachesMaximumDiskSpace(unsigned long long size);
 
+    /**
+     * @brief Selects the eviction policy of the image caches. The statistics gathered with the previous policy
+     * are logged and reset so that policies can be compared.
+     **/
+    void setApplicationsCachesEvictionPolicy(CacheEvictionPolicyEnum policy);
+
+    /**
+     * @brief Returns a one line summary of the node cache policy, hit ratio and render time saved by cache hits.
+     **/
+    QString getNodeCacheStatisticsString() const;
+
     void removeFromNodeCache(const ImagePtr & image);
     void removeFromViewerCache(const FrameEntryPtr & texture);
 
@@ -351,6 +369,20 @@ public:
      **/
     void checkCacheFreeMemoryIsGoodEnough();
 
+    /**
+     * @brief Samples the memory available to the process (see MemoryGovernor). If the memory state changed,
+     * the caches budgets are adjusted and the change is logged.
+     * The sample is rate limited unless force is true, e.g to see the memory released by evicting cache entries.
+     **/
+    void updateMemoryGovernor(bool force = false);
+
+    MemoryGovernorStatus getMemoryGovernorStatus() const;
+
+    /**
+     * @brief Returns how many of the given number of parallel renders may run given the memory state.
+     **/
+    int getMaxParallelRendersForMemory(int nRenders) const;
+
     void onCheckerboardSettingsChanged() { Q_EMIT checkerboardSettingsChanged(); }
 
     void onOCIOConfigPathChanged(const std::string& path);
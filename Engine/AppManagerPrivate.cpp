@@ -65,11 +65,15 @@ GCC_DIAG_ON(unused-parameter)
 #include "Engine/Format.h"
 #include "Engine/FrameEntry.h"
 #include "Engine/Image.h"
+#include "Engine/ImageBufferPool.h"
+#include "Engine/MemoryInfo.h" // getSystemTotalRAM_conditionnally
 #include "Engine/OfxHost.h"
 #include "Engine/OSGLContext.h"
 #include "Engine/ProcessHandler.h" // ProcessInputChannel
 #include "Engine/RectDSerialization.h"
 #include "Engine/RectISerialization.h"
+#include "Engine/RenderServer.h"
+#include "Engine/Settings.h"
 #include "Engine/StandardPaths.h"
 
 
@@ -77,6 +81,9 @@ GCC_DIAG_ON(unused-parameter)
 #define NATRON_OPENGL_VERSION_REQUIRED_MAJOR 2
 #define NATRON_OPENGL_VERSION_REQUIRED_MINOR 0
 
+// Maximum size of the free buffers kept by the ImageBufferPool, as a fraction of the node cache RAM budget
+#define NATRON_BUFFER_POOL_CACHE_FRACTION 0.125
+
 BOOST_CLASS_EXPORT(NATRON_NAMESPACE::FrameParams)
 BOOST_CLASS_EXPORT(NATRON_NAMESPACE::ImageParams)
 
@@ -98,9 +105,11 @@ AppManagerPrivate::AppManagerPrivate()
     , _nodeCache()
     , _diskCache()
     , _viewerCache()
+    , memoryGovernor( new MemoryGovernor() )
     , diskCachesLocationMutex()
     , diskCachesLocation()
     , _backgroundIPC()
+    , _renderServer()
     , _loaded(false)
     , _binaryPath()
     , _nodesGlobalMemoryUse(0)
@@ -393,6 +402,41 @@ AppManagerPrivate::restoreCaches()
     restoreCache<Image>( this, _diskCache.get() );
 } // restoreCaches
 
+void
+AppManagerPrivate::applyMemoryGovernorBudgets()
+{
+    if ( !_nodeCache || !_settings ) {
+        return;
+    }
+    double factor = memoryGovernor->getStatus().cacheBudgetFactor;
+
+    _nodeCache->setMaximumCacheSize( factor * _settings->getRamMaximumPercent() * getSystemTotalRAM_conditionnally() );
+    _nodeCache->setMaximumInMemorySize(1);
+
+    applyBufferPoolBudget();
+
+    // Do not wait for the next insertion to release the memory that is no longer part of the budget
+    while ( _nodeCache->getMemoryCacheSize() > _nodeCache->getMaximumMemorySize() ) {
+        if ( !_nodeCache->evictLRUInMemoryEntry() ) {
+            break;
+        }
+    }
+}
+
+void
+AppManagerPrivate::applyBufferPoolBudget()
+{
+    if (!_nodeCache) {
+        return;
+    }
+    if (memoryGovernor->getStatus().state == eMemoryGovernorStateCritical) {
+        // Every byte counts, do not keep any free buffer
+        ImageBufferPool::setMaximumPooledBytes(0);
+    } else {
+        ImageBufferPool::setMaximumPooledBytes( _nodeCache->getMaximumMemorySize() * NATRON_BUFFER_POOL_CACHE_FRACTION );
+    }
+}
+
 bool
 AppManagerPrivate::checkForCacheDiskStructure(const QString & cachePath, bool isTiled)
 {
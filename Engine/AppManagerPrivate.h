@@ -51,6 +51,7 @@
 #include "Engine/Cache.h"
 #include "Engine/FrameEntry.h"
 #include "Engine/Image.h"
+#include "Engine/MemoryGovernor.h"
 #include "Engine/GPUContextPool.h"
 #include "Engine/GenericSchedulerThreadWatcher.h"
 #include "Engine/TLSHolder.h"
@@ -100,10 +101,12 @@ public:
     ImageCachePtr _nodeCache; //< Images cache
     ImageCachePtr _diskCache; //< Images disk cache (used by DiskCache nodes)
     FrameEntryCachePtr _viewerCache; //< Viewer textures cache
+    boost::scoped_ptr<MemoryGovernor> memoryGovernor; //< adapts the caches budgets to the memory available to the process
     mutable QMutex diskCachesLocationMutex;
     QString diskCachesLocation;
     boost::scoped_ptr<ProcessInputChannel> _backgroundIPC; //< object used to communicate with the main app
     //if this app is background, see the ProcessInputChannel def
+    boost::scoped_ptr<RenderServer> _renderServer; //< the persistent render server, if launched with --render-server
     bool _loaded; //< true when the first instance is completly loaded.
     QString _binaryPath; //< the path to the application's binary
     U64 _nodesGlobalMemoryUse; //< how much memory all the nodes are using (besides the cache)
@@ -212,6 +215,19 @@ public:
 
     void restoreCaches();
 
+    /**
+     * @brief Scales the node cache maximum size set in the preferences by the budget factor
+     * of the memory governor and evicts in-memory entries that no longer fit.
+     * The viewer cache is not scaled: its maximum size set in the preferences is a disk space budget.
+     **/
+    void applyMemoryGovernorBudgets();
+
+    /**
+     * @brief Sets the maximum size of the free image buffers kept by the ImageBufferPool as a fraction of
+     * the node cache RAM budget.
+     **/
+    void applyBufferPoolBudget();
+
     static void addOpenGLRequirementsString(QString& str, OpenGLRequirementsTypeEnum type);
 
     bool checkForCacheDiskStructure(const QString & cachePath, bool isTiled);
@@ -61,6 +61,7 @@ public:
     bool useDefaultSettings;
     bool clearCacheOnLaunch;
     QString ipcPipe;
+    QString renderServerName;
     int error;
     bool isInterpreterMode;
     std::list<std::pair<int, std::pair<int, int> > > frameRanges;
@@ -88,6 +89,7 @@ public:
         , useDefaultSettings(false)
         , clearCacheOnLaunch(false)
         , ipcPipe()
+        , renderServerName()
         , error(0)
         , isInterpreterMode(false)
         , frameRanges()
@@ -224,6 +226,7 @@ CLArgs::operator=(const CLArgs& other)
     _imp->settingCommands = other._imp->settingCommands;
     _imp->isBackground = other._imp->isBackground;
     _imp->ipcPipe = other._imp->ipcPipe;
+    _imp->renderServerName = other._imp->renderServerName;
     _imp->error = other._imp->error;
     _imp->isInterpreterMode = other._imp->isInterpreterMode;
     _imp->frameRanges = other._imp->frameRanges;
@@ -288,6 +291,14 @@ CLArgs::printUsage(const std::string& programName)
         "  --settings name=value\n"
         "    Sets the named %1 setting to the given value. This is done after loading\n"
         "    the settings and prior to executing Python commands or loading the project.\n"
+        "  --render-server <name>\n"
+        "    Start a persistent render server listening on the local socket <name>.\n"
+        "    Plug-ins and caches are loaded once and kept warm between jobs. Each\n"
+        "    job is a single line containing the command-line arguments that would\n"
+        "    be given to %1Renderer, separated by tab characters. A job for the\n"
+        "    project that is already loaded (and unmodified on disk) reuses it.\n"
+        "    The server answers each job with a single line: \"done\" or\n"
+        "    \"error <message>\". Send \"quit\" to stop the server.\n"
         "  -c [ --cmd ] \"PythonCommand\"\n"
         "    Execute custom Python code passed as a script prior to executing the Python\n"
         "    script or loading the project passed as parameter. This option may be used\n"
@@ -338,6 +349,9 @@ CLArgs::printUsage(const std::string& programName)
         "     breakdown contains informations about each nodes, render times etc...\n"
         "     This option is useful for debugging purposes or to control that a render\n"
         "     is working correctly.\n"
+        "     A timeline of the actions called on each node and thread is also written\n"
+        "     once the sequence is rendered, next to the images with a -trace.json\n"
+        "     extension. It can be viewed in chrome://tracing or https://ui.perfetto.dev\n"
         "     **Please note** that it does not work when writing video files."
         "Sample uses:\n"
         "  %1 /Users/Me/MyNatronProjects/MyProject.ntp\n"
@@ -394,7 +408,11 @@ CLArgs::printUsage(const std::string& programName)
         "Sample uses:\n"
         "  %1 -t\n"
         "  %1Renderer -t\n"
-        "  %1Renderer -t /Users/Me/MyNatronScripts/MyScript.py\n")
+        "  %1Renderer -t /Users/Me/MyNatronScripts/MyScript.py\n"
+        "\n"
+        /* Text must hold in 80 columns ************************************************/
+        "Sample uses of the render server mode:\n"
+        "  %1Renderer --render-server /tmp/natron-render.sock\n")
                   .arg( /*%1=*/ QString::fromUtf8(NATRON_APPLICATION_NAME) ).arg( /*%2=*/ QString::fromUtf8(NATRON_PROJECT_FILE_EXT) ).arg( /*%3=*/ QString::fromUtf8( programName.c_str() ) );
     std::cout << msg.toStdString() << std::endl;
 } // CLArgs::printUsage
@@ -511,6 +529,18 @@ CLArgs::getIPCPipeName() const
     return _imp->ipcPipe;
 }
 
+const QString&
+CLArgs::getRenderServerName() const
+{
+    return _imp->renderServerName;
+}
+
+bool
+CLArgs::isRenderServerMode() const
+{
+    return !_imp->renderServerName.isEmpty();
+}
+
 bool
 CLArgs::areRenderStatsEnabled() const
 {
@@ -910,6 +940,23 @@ CLArgsPrivate::parse()
         }
     }
 
+    {
+        QStringList::iterator it = hasToken( QString::fromUtf8("render-server"), QString() );
+        if ( it != args.end() ) {
+            it = args.erase(it);
+            if ( it != args.end() ) {
+                renderServerName = *it;
+                isBackground = true;
+                args.erase(it);
+            } else {
+                std::cout << tr("You must specify the render server name after --render-server").toStdString() << std::endl;
+                error = 1;
+
+                return;
+            }
+        }
+    }
+
     {
         QStringList::iterator it = hasToken( QString::fromUtf8("onload"), QString::fromUtf8("l") );
         if ( it != args.end() ) {
@@ -947,7 +994,7 @@ CLArgsPrivate::parse()
         QStringList::iterator it = findFileNameWithExtension( QString::fromUtf8(NATRON_PROJECT_FILE_EXT) );
         if ( it == args.end() ) {
             it = findFileNameWithExtension( QString::fromUtf8("py") );
-            if ( ( it == args.end() ) && !isInterpreterMode && isBackground ) {
+            if ( ( it == args.end() ) && !isInterpreterMode && isBackground && renderServerName.isEmpty() ) {
                 std::cout << tr("You must specify the filename of a script or %1 project. (.%2)").arg( QString::fromUtf8(NATRON_APPLICATION_NAME) ).arg( QString::fromUtf8(NATRON_PROJECT_FILE_EXT) ).toStdString() << std::endl;
                 error = 1;
 
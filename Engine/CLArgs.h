@@ -131,6 +131,13 @@ public:
     const QString& getDefaultOnProjectLoadedScript() const;
     const QString& getIPCPipeName() const;
 
+    /*
+     * @brief The name of the local socket the render server listens on, if --render-server was given.
+     */
+    const QString& getRenderServerName() const;
+
+    bool isRenderServerMode() const;
+
     bool isPythonScript() const;
 
     bool areRenderStatsEnabled() const;
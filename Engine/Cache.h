@@ -32,6 +32,7 @@
 #include <fstream>
 #include <functional>
 #include <list>
+#include <map>
 #include <set>
 #include <cstddef>
 #include <utility>
@@ -61,12 +62,16 @@ GCC_DIAG_ON(deprecated)
 #include "Engine/MemoryInfo.h" // getSystemTotalRAM
 #include "Engine/Settings.h"
 #include "Engine/StandardPaths.h"
+#include "Engine/Timer.h"
 
 #include "Engine/EngineFwd.h"
 
 //Beyond that percentage of occupation, the cache will start evicting LRU entries
 #define NATRON_CACHE_LIMIT_PERCENT 0.9
 
+///Minimum delay before the cache looks again for entries to compact after it could not free enough memory by compacting them
+#define NATRON_CACHE_COMPACTION_RETRY_SECONDS 1.
+
 #define NATRON_TILE_CACHE_FILE_SIZE_BYTES 2000000000
 
 ///When defined, number of opened files, memory size and disk size of the cache are printed whenever there's activity.
@@ -322,6 +327,33 @@ private:
 };
 
 
+/**
+ * @brief The changes of the entries of a cache since the last notification, see CacheSignalEmitter::entriesChanged().
+ * Only the last state of each frame is kept, so that a burst of insertions and evictions (e.g during playback)
+ * is delivered as a single batch.
+ **/
+struct CacheEntriesChanges
+{
+    // For each modified frame, the storage of the frame, or eStorageModeNone if it was removed
+    std::map<SequenceTime, StorageModeEnum> frames;
+
+    // If true, the frames in RAM (resp. on disk) were all removed before the changes in frames
+    bool clearedInMemoryPortion;
+    bool clearedDiskPortion;
+
+    CacheEntriesChanges()
+        : frames()
+        , clearedInMemoryPortion(false)
+        , clearedDiskPortion(false)
+    {
+    }
+
+    bool empty() const
+    {
+        return frames.empty() && !clearedInMemoryPortion && !clearedDiskPortion;
+    }
+};
+
 class CacheSignalEmitter
     : public QObject
 {
@@ -329,6 +361,9 @@ class CacheSignalEmitter
 
 public:
     CacheSignalEmitter()
+        : _changesMutex()
+        , _changes()
+        , _changesPending(false)
     {
     }
 
@@ -338,30 +373,49 @@ public:
 
     void emitSignalClearedInMemoryPortion()
     {
+        recordClear(eStorageModeRAM);
         Q_EMIT clearedInMemoryPortion();
     }
 
     void emitClearedDiskPortion()
     {
+        recordClear(eStorageModeDisk);
         Q_EMIT clearedDiskPortion();
     }
 
     void emitAddedEntry(SequenceTime time)
     {
-        Q_EMIT addedEntry(time);
+        recordChange(time, eStorageModeRAM);
     }
 
     void emitRemovedEntry(SequenceTime time,
-                          int storage)
+                          int /*storage*/)
     {
-        Q_EMIT removedEntry(time, storage);
+        recordChange(time, eStorageModeNone);
     }
 
     void emitEntryStorageChanged(SequenceTime time,
-                                 int oldStorage,
+                                 int /*oldStorage*/,
                                  int newStorage)
     {
-        Q_EMIT entryStorageChanged(time, oldStorage, newStorage);
+        recordChange(time, (StorageModeEnum)newStorage);
+    }
+
+public Q_SLOTS:
+
+    void onChangesPending()
+    {
+        CacheEntriesChanges changes;
+        {
+            QMutexLocker k(&_changesMutex);
+            changes.frames.swap(_changes.frames);
+            std::swap(changes.clearedInMemoryPortion, _changes.clearedInMemoryPortion);
+            std::swap(changes.clearedDiskPortion, _changes.clearedDiskPortion);
+            _changesPending = false;
+        }
+        if ( !changes.empty() ) {
+            Q_EMIT entriesChanged(changes);
+        }
     }
 
 Q_SIGNALS:
@@ -370,9 +424,101 @@ Q_SIGNALS:
 
     void clearedDiskPortion();
 
-    void addedEntry(SequenceTime);
-    void removedEntry(SequenceTime, int);
-    void entryStorageChanged(SequenceTime, int, int);
+    // Emitted in the main thread with all the changes since the last emission
+    void entriesChanged(const CacheEntriesChanges&);
+
+private:
+
+    bool hasEntriesListeners() const
+    {
+        return receivers( SIGNAL(entriesChanged(CacheEntriesChanges)) ) > 0;
+    }
+
+    /*
+     * The cache may be modified by many threads at once: changes are merged into _changes and only the
+     * first change after a delivery posts an event to the main thread.
+     * The event is posted with invokeMethod so that it is not lost if the signals get blocked in between.
+     */
+    void recordChange(SequenceTime time,
+                      StorageModeEnum storage)
+    {
+        if ( signalsBlocked() || !hasEntriesListeners() ) {
+            // The cache is being cleared, or no one is interested
+            return;
+        }
+        bool notify;
+        {
+            QMutexLocker k(&_changesMutex);
+            _changes.frames[time] = storage;
+            notify = !_changesPending;
+            _changesPending = true;
+        }
+        if (notify) {
+            QMetaObject::invokeMethod(this, "onChangesPending", Qt::QueuedConnection);
+        }
+    }
+
+    void recordClear(StorageModeEnum storage)
+    {
+        if ( !hasEntriesListeners() ) {
+            return;
+        }
+        bool notify;
+        {
+            QMutexLocker k(&_changesMutex);
+            // Changes made before the clear to frames of that storage are obsolete
+            std::map<SequenceTime, StorageModeEnum>::iterator it = _changes.frames.begin();
+            while ( it != _changes.frames.end() ) {
+                if (it->second == storage) {
+                    _changes.frames.erase(it++);
+                } else {
+                    ++it;
+                }
+            }
+            if (storage == eStorageModeRAM) {
+                _changes.clearedInMemoryPortion = true;
+            } else {
+                _changes.clearedDiskPortion = true;
+            }
+            notify = !_changesPending;
+            _changesPending = true;
+        }
+        if (notify) {
+            QMetaObject::invokeMethod(this, "onChangesPending", Qt::QueuedConnection);
+        }
+    }
+
+    QMutex _changesMutex;
+    CacheEntriesChanges _changes;
+    bool _changesPending;
+};
+
+
+/**
+ * @brief Counters used to compare the efficiency of the eviction policies.
+ **/
+struct CacheStatistics
+{
+    // Number of look-ups that returned an entry
+    U64 hits;
+
+    // Number of look-ups that found nothing and had to compute the entry
+    U64 misses;
+
+    // Sum of the recompute cost (in seconds) of the entries returned by successful look-ups
+    double savedTime;
+
+    CacheStatistics()
+        : hits(0)
+        , misses(0)
+        , savedTime(0.)
+    {
+    }
+
+    double getHitRatio() const
+    {
+        return (hits + misses) > 0 ? (double)hits / (hits + misses) : 0.;
+    }
 };
 
 
@@ -480,6 +626,14 @@ private:
          when we call get() and we want this function to be const.*/
     mutable CacheContainer _memoryCache;
     mutable CacheContainer _diskCache;
+
+    // Protected by _lock
+    CacheEvictionPolicyEnum _evictionPolicy;
+    mutable bool _compactionExhausted; // the last compaction could not free enough memory, @see compactInMemoryEntries()
+    mutable double _compactionExhaustedTime; // when it happened, in seconds since the cache creation
+    TimeLapse _cacheTimer;
+    mutable QMutex _statsLock; // protects _stats
+    mutable CacheStatistics _stats;
     const std::string _cacheName;
     const unsigned int _version;
 
@@ -527,6 +681,12 @@ public:
         , _getLock()
         , _memoryCache()
         , _diskCache()
+        , _evictionPolicy(eCacheEvictionPolicyLRU)
+        , _compactionExhausted(false)
+        , _compactionExhaustedTime(0.)
+        , _cacheTimer()
+        , _statsLock()
+        , _stats()
         , _cacheName(cacheName)
         , _version(version)
         , _signalEmitter()
@@ -605,10 +765,75 @@ public:
 
         ///lock the cache before reading it.
         QMutexLocker locker(&_lock);
+        bool found = getInternal(key, returnValue);
+        double cost = 0.;
+        if (found) {
+            for (typename std::list<EntryTypePtr>::const_iterator it = returnValue->begin(); it != returnValue->end(); ++it) {
+                cost = (std::max)( cost, (*it)->getRecomputeCost() );
+            }
+        }
+        recordLookup(found, cost);
 
-        return getInternal(key, returnValue);
+        return found;
     } // get
 
+    /**
+     * @brief Same as get() but only looks for entries in memory, does not mark them as used and does not count as a
+     * lookup in the statistics. This is used to probe the cache for entries that may be useful without making them
+     * more likely to stay in the cache.
+     **/
+    bool peek(const typename EntryType::key_type & key,
+              std::list<EntryTypePtr>* returnValue) const
+    {
+        QMutexLocker locker(&_lock);
+        CacheIterator memoryCached = _memoryCache.find( key.getHash() );
+
+        if ( memoryCached == _memoryCache.end() ) {
+            return false;
+        }
+        const std::list<EntryTypePtr> & entries = getValueFromIterator(memoryCached);
+        for (typename std::list<EntryTypePtr>::const_iterator it = entries.begin(); it != entries.end(); ++it) {
+            if ( (*it)->getKey() == key ) {
+                returnValue->push_back(*it);
+            }
+        }
+
+        return !returnValue->empty();
+    }
+
+    /**
+     * @brief Selects which entries are evicted first when the cache is full.
+     **/
+    void setEvictionPolicy(CacheEvictionPolicyEnum policy)
+    {
+        QMutexLocker locker(&_lock);
+
+        _evictionPolicy = policy;
+        _memoryCache.setCostAwareEvictionEnabled(policy == eCacheEvictionPolicyCostAware);
+        _diskCache.setCostAwareEvictionEnabled(policy == eCacheEvictionPolicyCostAware);
+    }
+
+    CacheEvictionPolicyEnum getEvictionPolicy() const
+    {
+        QMutexLocker locker(&_lock);
+
+        return _evictionPolicy;
+    }
+
+    CacheStatistics getStatistics() const
+    {
+        QMutexLocker k(&_statsLock);
+
+        return _stats;
+    }
+
+    void resetStatistics()
+    {
+        QMutexLocker k(&_statsLock);
+
+        _stats = CacheStatistics();
+    }
+
 private:
 
 
@@ -799,6 +1024,10 @@ private:
             memoryCacheSize = _memoryCacheSize;
             maximumInMemorySize = std::max( (std::size_t)1, _maximumInMemorySize );
         }
+        ///Before erasing entries, try to make room by compacting them.
+        if ( (double)memoryCacheSize / maximumInMemorySize > NATRON_CACHE_LIMIT_PERCENT ) {
+            memoryCacheSize -= compactInMemoryEntries( memoryCacheSize - (U64)(maximumInMemorySize * NATRON_CACHE_LIMIT_PERCENT) );
+        }
         {
             QMutexLocker locker(&_lock);
             std::list<EntryTypePtr> entriesToBeDeleted;
@@ -986,12 +1215,14 @@ public:
                 for (typename std::list<EntryTypePtr>::iterator it = entries.begin(); it != entries.end(); ++it) {
                     if (*(*it)->getParams() == *params) {
                         *returnValue = *it;
+                        recordLookup( true, (*it)->getRecomputeCost() );
 
                         return true;
                     }
                 }
             }
 
+            recordLookup(false, 0.);
             createInternal(key, params, locker, returnValue);
 
             return false;
@@ -1133,13 +1364,18 @@ public:
         std::list<EntryTypePtr> entriesToBeDeleted;
 
         {
-            QMutexLocker locker(&_lock);
             U64 memoryCacheSize, maximumInMemorySize;
             {
                 QMutexLocker k(&_sizeLock);
                 memoryCacheSize = _memoryCacheSize;
                 maximumInMemorySize = std::max( (std::size_t)1, _maximumInMemorySize );
             }
+            if ( (double)memoryCacheSize / maximumInMemorySize >= NATRON_CACHE_LIMIT_PERCENT ) {
+                // Without holding _lock, @see compactInMemoryEntries()
+                memoryCacheSize -= compactInMemoryEntries( memoryCacheSize - (U64)(maximumInMemorySize * NATRON_CACHE_LIMIT_PERCENT) );
+            }
+
+            QMutexLocker locker(&_lock);
             double occupationPercentage = (double)memoryCacheSize / maximumInMemorySize;
             while (occupationPercentage >= NATRON_CACHE_LIMIT_PERCENT) {
                 std::list<EntryTypePtr> deleted;
@@ -1614,6 +1850,9 @@ private:
         {
             QMutexLocker locker(&_lock);
 
+            newMemCache.setCostAwareEvictionEnabled(_evictionPolicy == eCacheEvictionPolicyCostAware);
+            newDiskCache.setCostAwareEvictionEnabled(_evictionPolicy == eCacheEvictionPolicyCostAware);
+
             for (CacheIterator memIt = _memoryCache.begin(); memIt != _memoryCache.end(); ++memIt) {
                 std::list<EntryTypePtr> & entries = getValueFromIterator(memIt);
                 if ( !entries.empty() ) {
@@ -1661,6 +1900,19 @@ private:
         }
     } // removeAllEntriesWithDifferentNodeHashForHolderPrivate
 
+    void recordLookup(bool hit,
+                      double savedTime) const
+    {
+        QMutexLocker k(&_statsLock);
+
+        if (hit) {
+            ++_stats.hits;
+            _stats.savedTime += savedTime;
+        } else {
+            ++_stats.misses;
+        }
+    }
+
     bool getInternal(const typename EntryType::key_type & key,
                      std::list<EntryTypePtr>* returnValue) const
     {
@@ -1803,6 +2055,59 @@ private:
         }
     }
 
+    /**
+     * @brief Compacts the in-memory entries that are not used elsewhere (@see CacheEntryHelper::compactMemory())
+     * until at least bytesToFree bytes are freed. Returns the number of bytes freed, at most bytesToFree.
+     * The entries stay in the cache and are restored when they are used again.
+     * The candidates are collected under _lock but converted without it, each one under its own lock, so that the other
+     * threads may use the cache meanwhile. When a scan could not free enough memory, the cache is not scanned again
+     * before NATRON_CACHE_COMPACTION_RETRY_SECONDS: the remaining entries are most likely already compacted or cannot be.
+     **/
+    U64 compactInMemoryEntries(U64 bytesToFree) const
+    {
+        //_lock must not be taken here
+        std::list<EntryTypePtr> candidates;
+        {
+            QMutexLocker locker(&_lock);
+            if ( _compactionExhausted && (_cacheTimer.getTimeSinceCreation() - _compactionExhaustedTime < NATRON_CACHE_COMPACTION_RETRY_SECONDS) ) {
+                return 0;
+            }
+            // Compacting an entry at most halves its size
+            U64 maxFreed = 0;
+            for (CacheIterator it = _memoryCache.begin(); it != _memoryCache.end() && maxFreed < bytesToFree; ++it) {
+                const std::list<EntryTypePtr> & entries = getValueFromIterator(it);
+                for (typename std::list<EntryTypePtr>::const_iterator it2 = entries.begin(); it2 != entries.end() && maxFreed < bytesToFree; ++it2) {
+                    // An entry with a use_count greater than 1 may be read or written at the same time. Weak pointers are not
+                    // counted: the entries refuse to be compacted while weak pointers to them may be locked without calling
+                    // allocateMemory() (@see Image::registerWeakReference())
+                    if ( it2->unique() ) {
+                        candidates.push_back(*it2);
+                        maxFreed += (*it2)->size() / 2;
+                    }
+                }
+            }
+        }
+
+        U64 freed = 0;
+        for (typename std::list<EntryTypePtr>::const_iterator it = candidates.begin(); it != candidates.end() && freed < bytesToFree; ++it) {
+            std::size_t oldSize = (*it)->size();
+            // Referenced by the cache and the candidates list only, unless another thread got it in the meantime
+            if ( (*it)->compactMemoryIfUnused(*it, 2) ) {
+                std::size_t newSize = (*it)->size();
+                freed += oldSize > newSize ? oldSize - newSize : 0;
+            }
+        }
+
+        {
+            QMutexLocker locker(&_lock);
+            _compactionExhausted = freed < bytesToFree;
+            _compactionExhaustedTime = _cacheTimer.getTimeSinceCreation();
+        }
+
+        // The entries evicted in the meantime are destroyed here, outside of _lock
+        return std::min(freed, bytesToFree);
+    }
+
     bool tryEvictInMemoryEntry(std::list<EntryTypePtr> & entriesToBeDeleted) const
     {
         assert( !_lock.tryLock() );
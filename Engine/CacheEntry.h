@@ -60,6 +60,7 @@
 
 #include "Engine/Hash64.h"
 #include "Engine/CacheEntryHolder.h"
+#include "Engine/ImageBufferPool.h"
 #include "Engine/MemoryFile.h"
 #include "Engine/NonKeyParams.h"
 #include "Engine/Texture.h"
@@ -75,30 +76,30 @@ NATRON_NAMESPACE_ENTER
 template <typename T>
 class RamBuffer
 {
-    T* data;
+    ImageBufferPool::Block block;
     U64 count;
 
 public:
 
     RamBuffer()
-        : data(0)
+        : block()
         , count(0)
     {
     }
 
     T* getData()
     {
-        return data;
+        return (T*)block.data;
     }
 
     const T* getData() const
     {
-        return data;
+        return (const T*)block.data;
     }
 
     void swap(RamBuffer& other)
     {
-        std::swap(data, other.data);
+        std::swap(block, other.block);
         std::swap(count, other.count);
     }
 
@@ -113,34 +114,19 @@ public:
             return;
         }
         count = size;
-        if (data) {
-            free(data);
-            data = 0;
-        }
-        if (count == 0) {
-            return;
-        }
-        data = (T*)malloc( size * sizeof(T) );
-        if (!data) {
-            throw std::bad_alloc();
-        }
+        ImageBufferPool::release(&block);
+        block = ImageBufferPool::allocate( size * sizeof(T) );
     }
 
     void clear()
     {
         count = 0;
-        if (data) {
-            free(data);
-            data = 0;
-        }
+        ImageBufferPool::release(&block);
     }
 
     ~RamBuffer()
     {
-        if (data) {
-            free(data);
-            data = 0;
-        }
+        ImageBufferPool::release(&block);
     }
 };
 
@@ -767,6 +753,7 @@ public:
         , _data()
         , _cache()
         , _entryLock(QReadWriteLock::Recursive)
+        , _recomputeCostLock()
         , _removeBackingFileBeforeDestruction(false)
     {
     }
@@ -785,6 +772,7 @@ public:
         , _data()
         , _cache(cache)
         , _entryLock(QReadWriteLock::Recursive)
+        , _recomputeCostLock()
         , _removeBackingFileBeforeDestruction(false)
     {
     }
@@ -888,6 +876,35 @@ public:
     {
     }
 
+    /**
+     * @brief Called by the cache when it is full, on entries that are only referenced by the cache, to reduce their memory
+     * footprint without removing them. The next call to allocateMemory() must restore the entry.
+     * Returns true if the entry is now smaller. The default implementation does nothing.
+     **/
+    virtual bool compactMemory()
+    {
+        return false;
+    }
+
+    /**
+     * @brief Calls compactMemory() if the entry is referenced by at most maxUseCount shared pointers, i.e. only by the
+     * cache and the caller. The use count is checked under the entry lock: a thread that gets the entry from the cache
+     * afterwards calls allocateMemory(), which waits for the compaction to be done and restores the entry.
+     **/
+    template <typename EntryPtr>
+    bool compactMemoryIfUnused(const EntryPtr& entry,
+                               long maxUseCount)
+    {
+        assert(entry.get() == this);
+        QWriteLocker k(&_entryLock);
+
+        if (entry.use_count() > maxUseCount) {
+            return false;
+        }
+
+        return compactMemory();
+    }
+
     const KeyType & getKey() const OVERRIDE FINAL
     {
         return _key;
@@ -1088,6 +1105,29 @@ public:
         return _params;
     }
 
+    /**
+     * @brief Accumulates the time in seconds spent computing the data of this entry.
+     * This is the cost the cache saves each time the entry is retrieved instead of being recomputed.
+     **/
+    void addRecomputeCost(double seconds)
+    {
+        if (!_params) {
+            return;
+        }
+        QMutexLocker k(&_recomputeCostLock);
+        _params->setRecomputeCost(_params->getRecomputeCost() + seconds);
+    }
+
+    double getRecomputeCost() const WARN_UNUSED_RETURN
+    {
+        if (!_params) {
+            return 0.;
+        }
+        QMutexLocker k(&_recomputeCostLock);
+
+        return _params->getRecomputeCost();
+    }
+
     std::size_t getSizeInBytesFromParams() const
     {
         return getElementsCountFromParams() * sizeof(DataType);
@@ -1249,6 +1289,7 @@ protected:
     Buffer<DataType> _data;
     const CacheAPI* _cache;
     mutable QReadWriteLock _entryLock;
+    mutable QMutex _recomputeCostLock;
     bool _removeBackingFileBeforeDestruction;
 };
 
@@ -441,6 +441,43 @@ Curve::addKeyFrame(KeyFrame key)
     return it.second;
 }
 
+int
+Curve::addKeyFrames(const std::vector<KeyFrame>& keys)
+{
+    if ( keys.empty() ) {
+        return 0;
+    }
+
+    QMutexLocker l(&_imp->_lock);
+    const bool constantInterp = ( (_imp->type == CurvePrivate::eCurveTypeBool) || (_imp->type == CurvePrivate::eCurveTypeString) ||
+                                  ( _imp->type == CurvePrivate::eCurveTypeInt) ||
+                                  ( _imp->type == CurvePrivate::eCurveTypeIntConstantInterp) );
+    int nAdded = 0;
+    for (std::vector<KeyFrame>::const_iterator it = keys.begin(); it != keys.end(); ++it) {
+        if (constantInterp) {
+            KeyFrame k(*it);
+            k.setInterpolation(eKeyframeTypeConstant);
+            nAdded += (int)addKeyFrameNoUpdate(k).second;
+        } else {
+            nAdded += (int)addKeyFrameNoUpdate(*it).second;
+        }
+    }
+
+    // Automatic derivatives only depend on the neighbouring keyframes: refresh them all in a single pass
+    // instead of refreshing the neighbourhood of each inserted keyframe.
+    KeyFrameSet::iterator it = _imp->keyFrames.begin();
+    while ( it != _imp->keyFrames.end() ) {
+        KeyframeTypeEnum interp = it->getInterpolation();
+        if ( (interp != eKeyframeTypeBroken) && (interp != eKeyframeTypeFree) && (interp != eKeyframeTypeNone) ) {
+            it = refreshDerivatives(eCurveChangedReasonDerivativesChanged, it);
+        }
+        ++it;
+    }
+    onCurveChanged();
+
+    return nAdded;
+}
+
 std::pair<KeyFrameSet::iterator, bool> Curve::addKeyFrameNoUpdate(const KeyFrame & cp)
 {
     // PRIVATE - should not lock
@@ -766,6 +803,20 @@ Curve::getNKeyFramesInRange(double first,
     return ret;
 }
 
+void
+Curve::getKeyFramesInRange(double first,
+                           double last,
+                           std::vector<KeyFrame>* keys) const
+{
+    QMutexLocker k(&_imp->_lock);
+    // keyFrames is sorted by time: only the keyframes in the range are visited
+    KeyFrameSet::const_iterator it = _imp->keyFrames.lower_bound( KeyFrame(first, 0.) );
+
+    for (; it != _imp->keyFrames.end() && it->getTime() <= last; ++it) {
+        keys->push_back(*it);
+    }
+}
+
 bool
 Curve::getKeyFrameWithTime(double time,
                            KeyFrame* k) const
@@ -212,6 +212,14 @@ public:
     ///existing key at this time.
     bool addKeyFrame(KeyFrame key);
 
+    /**
+     * @brief Adds all the given keyframes at once, replacing the existing keyframes at the same times.
+     * Unlike calling addKeyFrame for each of them, the derivatives are refreshed in a single pass
+     * over the curve once all keyframes are inserted, and the curve is notified of the change only once.
+     * @returns The number of keyframes that were added, i.e. that did not replace an existing keyframe.
+     **/
+    int addKeyFrames(const std::vector<KeyFrame>& keys);
+
     void removeKeyFrameWithTime(double time);
 
     void removeKeyFrameWithIndex(int index);
@@ -239,6 +247,12 @@ public:
      */
     int getNKeyFramesInRange(double first, double last) const WARN_UNUSED_RETURN;
 
+    /*
+     * @brief Appends to keys the keyframes in the range [first,last], by increasing time.
+     * This is in O(log(n) + m) where m is the number of keyframes in the range.
+     */
+    void getKeyFramesInRange(double first, double last, std::vector<KeyFrame>* keys) const;
+
     bool getKeyFrameWithIndex(int index, KeyFrame* k) const WARN_UNUSED_RETURN;
 
     int getKeyFramesCount() const WARN_UNUSED_RETURN;
@@ -0,0 +1,219 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef Engine_DirectoryContent_h
+#define Engine_DirectoryContent_h
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/shared_ptr.hpp>
+#endif
+
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+
+#include "Global/GlobalDefines.h"
+#include "Engine/EngineFwd.h"
+
+NATRON_NAMESPACE_ENTER
+
+// The name and whether it is a directory of each entry of a directory
+typedef std::vector<std::pair<QString, bool> > DirectoryEntries;
+
+/**
+ * @brief New items gathered for a directory and the new state of sequence items already published
+ **/
+struct FileGathererContent
+{
+    struct SequenceUpdate
+    {
+        QString filename;
+        QString userFriendlySequenceName;
+        SequenceParsing::SequenceFromFilesPtr sequence;
+        int filesCount;
+
+        // Set if the metadata is needed to sort the items
+        QDateTime dateModified;
+        quint64 size;
+        bool hasMetadata;
+
+        SequenceUpdate()
+            : filename()
+            , userFriendlySequenceName()
+            , sequence()
+            , filesCount(0)
+            , dateModified()
+            , size(0)
+            , hasMetadata(false)
+        {
+        }
+    };
+
+    typedef std::map<FileSystemItemPtr, SequenceUpdate> SequenceUpdates;
+
+    FileSystemItemPtr directory;
+    std::vector<FileSystemItemPtr> newItems;
+    SequenceUpdates updates;
+
+    // True if this is the first content of the gathering: the previous children of the directory must be removed
+    bool isFirstContent;
+
+    // True if the directory was entirely gathered
+    bool isLastContent;
+
+    FileGathererContent()
+        : directory()
+        , newItems()
+        , updates()
+        , isFirstContent(false)
+        , isLastContent(false)
+    {
+    }
+
+    /**
+     * @brief Removes the new items from the registry of their model. This must be called when the content is dropped
+     * instead of being inserted in the model.
+     **/
+    void unregisterNewItems() const;
+};
+
+/**
+ * @brief Keeps the entries of the last directories listed, so that going back to a directory
+ * with many files does not list it again. An entry is valid as long as the modification date of the directory
+ * did not change.
+ * This class is MT-safe.
+ **/
+class DirectoryListingCache
+{
+    struct Listing
+    {
+        QDateTime lastModified;
+        QDir::Filters filters;
+        DirectoryEntries entries;
+        U64 lastUsed;
+    };
+
+    typedef std::map<QString, Listing> ListingMap;
+
+public:
+
+    DirectoryListingCache();
+
+    /**
+     * @brief Returns true and the entries of the directory if it was listed with the same filters and
+     * its modification date did not change since
+     **/
+    bool get(const QString& path,
+             QDir::Filters filters,
+             const QDateTime& lastModified,
+             DirectoryEntries* entries);
+
+    /**
+     * @brief Stores the entries of the directory. Directories modified within the last seconds are not stored, since
+     * the modification date has a precision of a second.
+     **/
+    void insert(const QString& path,
+                QDir::Filters filters,
+                const QDateTime& lastModified,
+                const DirectoryEntries& entries);
+
+private:
+
+    void erase(const QString& path);
+
+    QMutex _lock;
+    ListingMap _listings;
+    std::size_t _entriesCount;
+    U64 _usageCounter;
+};
+
+/**
+ * @brief Groups the entries of a directory in sequences as they are listed and creates the
+ * corresponding items.
+ **/
+class DirectoryContentGrouper
+{
+    struct Group
+    {
+        bool isDir;
+        QString firstFileName;
+        SequenceParsing::SequenceFromFilesPtr sequence;
+        int filesCount;
+
+        // The item created for the group when it was published to the model
+        FileSystemItemPtr item;
+
+        // True if files were added to the sequence since the item was published
+        bool modified;
+    };
+
+public:
+
+    /**
+     * @param sequenceMode If true, numbered files are grouped in sequences
+     * @param fetchMetadata If true, the date and size of the items are fetched when they are created
+     **/
+    DirectoryContentGrouper(const FileSystemItemPtr& directory,
+                            const FileSystemModelPtr& model,
+                            bool sequenceMode,
+                            bool fetchMetadata);
+
+    void addEntry(const QString& filename, bool isDir);
+
+    /**
+     * @brief Creates the items of the groups added since the last call and the updates of the
+     * sequences that changed. Sequences are only given to the items with the last content, since they are
+     * modified by this thread until then.
+     **/
+    boost::shared_ptr<FileGathererContent> takeContent(bool isLastContent);
+
+private:
+
+    void addGroup(bool isDir, const QString& filename, const SequenceParsing::SequenceFromFilesPtr& sequence);
+
+    static void getSequenceNames(const Group& group, QString* filename, QString* userFriendlyFilename);
+
+    void getMetadata(const Group& group, QDateTime* dateModified, quint64* size) const;
+
+    FileSystemItemPtr _directory;
+    FileSystemModelPtr _model;
+    bool _sequenceMode;
+    bool _fetchMetadata;
+    std::vector<Group> _groups;
+    std::map<QString, std::vector<std::size_t> > _groupsBySequenceKey;
+    std::size_t _firstUnpublishedGroup;
+    std::vector<std::size_t> _modifiedGroups;
+    bool _published;
+};
+
+NATRON_NAMESPACE_EXIT
+
+#endif // Engine_DirectoryContent_h
@@ -63,6 +63,7 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #include "Engine/Log.h"
 #include "Engine/MemoryInfo.h" // printAsRAM
 #include "Engine/Node.h"
+#include "Engine/NumaPlacement.h"
 #include "Engine/OfxEffectInstance.h"
 #include "Engine/OfxOverlayInteract.h"
 #include "Engine/OfxImageEffectInstance.h"
@@ -71,7 +72,9 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #include "Engine/OutputSchedulerThread.h"
 #include "Engine/PluginMemory.h"
 #include "Engine/Project.h"
+#include "Engine/RenderAbortToken.h"
 #include "Engine/RenderStats.h"
+#include "Engine/RenderTaskScheduler.h"
 #include "Engine/RotoContext.h"
 #include "Engine/RotoDrawableItem.h"
 #include "Engine/ReadNode.h"
@@ -323,6 +326,7 @@ EffectInstance::setParallelRenderArgsTLS(double time,
     args->rotoPaintNodes = rotoPaintNodes;
     args->doNansHandling = isAnalysis ? false : doNanHandling;
     args->draftMode = draftMode;
+    args->isSpeculativeRender = abortInfo && abortInfo->isSpeculative();
     args->tilesSupported = getNode()->getCurrentSupportTiles();
     args->stats = stats;
     args->openGLContext = glContext;
@@ -420,64 +424,16 @@ EffectInstance::getRenderHash() const
     return args->nodeHash;
 }
 
-bool
-EffectInstance::Implementation::aborted(bool isRenderResponseToUserInteraction,
-                                        const AbortableRenderInfoPtr& abortInfo,
-                                        const EffectInstancePtr& treeRoot)
-{
-    if (!isRenderResponseToUserInteraction) {
-        // Rendering is playback or render on disk
-
-        // If we have abort info, e just peek the atomic int inside the abort info, this is very fast
-        if ( abortInfo && abortInfo->isAborted() ) {
-            return true;
-        }
-
-        // Fallback on the flag set on the node that requested the render in OutputSchedulerThread
-        if (treeRoot) {
-            OutputEffectInstance* effect = dynamic_cast<OutputEffectInstance*>( treeRoot.get() );
-            assert(effect);
-            if (effect) {
-                return effect->isSequentialRenderBeingAborted();
-            }
-        }
-
-        // We have no other means to know if abort was called
-        return false;
-    } else {
-        // This is a render issued to refresh the image on the Viewer
-
-        if ( !abortInfo || !abortInfo->canAbort() ) {
-            // We do not have any abortInfo set or this render is not abortable. This should be avoided as much as possible!
-            return false;
-        }
-
-        // This is very fast, we just peek the atomic int inside the abort info
-        if ( (int)abortInfo->isAborted() ) {
-            return true;
-        }
-
-        // If this node can start sequential renders (e.g: start playback like on the viewer or render on disk) and it is already doing a sequential render, abort
-        // this render
-        OutputEffectInstance* isRenderEffect = dynamic_cast<OutputEffectInstance*>( treeRoot.get() );
-        if (isRenderEffect) {
-            if ( isRenderEffect->isDoingSequentialRender() ) {
-                return true;
-            }
-        }
-
-        // The render was not aborted
-        return false;
-    }
-}
-
 bool
 EffectInstance::aborted() const
 {
-    QThread* thisThread = QThread::currentThread();
+    // Fast path: the render running on this thread has a token, see RenderAbortToken
+    bool isAborted;
+    if ( RenderAbortToken::isCurrentThreadAborted(&isAborted) ) {
+        return isAborted;
+    }
 
-    /* If this thread is an AbortableThread, this function will be extremely fast*/
-    AbortableThread* isAbortableThread = dynamic_cast<AbortableThread*>(thisThread);
+    AbortableThread* isAbortableThread = AbortableThread::getCurrentThread();
 
     /**
        The solution here is to store per-render info on the thread that we retrieve.
@@ -513,10 +469,9 @@ EffectInstance::aborted() const
         }
     }
 
-    // The internal function that given a AbortableRenderInfoPtr determines if a render was aborted or not
-    return Implementation::aborted(isRenderUserInteraction,
-                                   abortInfo,
-                                   treeRoot);
+    return RenderAbortToken::isRenderAborted(isRenderUserInteraction,
+                                             abortInfo,
+                                             treeRoot);
 } // EffectInstance::aborted
 
 bool
@@ -844,6 +799,7 @@ EffectInstance::getImage(int inputNb,
     EffectInstance::InputImagesMap inputImagesThreadLocal;
     OSGLContextPtr glContext;
     AbortableRenderInfoPtr renderInfo;
+    RenderStatsPtr stats;
     if ( !tls || ( !tls->currentRenderArgs.validArgs && tls->frameArgs.empty() ) ) {
         /*
            This is either a huge bug or an unknown thread that called clipGetImage from the OpenFX plug-in.
@@ -875,6 +831,7 @@ EffectInstance::getImage(int inputNb,
             isAnalysisPass = frameRenderArgs->isAnalysis;
             glContext = frameRenderArgs->openGLContext.lock();
             renderInfo = frameRenderArgs->abortInfo.lock();
+            stats = frameRenderArgs->stats;
         } else {
             //This is a bug, when entering here, frameArgs TLS should always have been set, except for unknown threads.
             nodeHash = getHash();
@@ -1054,7 +1011,7 @@ EffectInstance::getImage(int inputNb,
         }
 
         if (mapToClipPrefs) {
-            inputImg = convertPlanesFormatsIfNeeded(getApp(), inputImg, pixelRoI, clipPrefComps, depth, node->usesAlpha0ToConvertFromRGBToRGBA(), eImagePremultiplicationPremultiplied, channelForMask);
+            inputImg = convertPlanesFormatsIfNeeded(getApp(), inputImg, pixelRoI, clipPrefComps, depth, node->usesAlpha0ToConvertFromRGBToRGBA(), eImagePremultiplicationPremultiplied, channelForMask, stats, node);
         }
 
         return inputImg;
@@ -1150,7 +1107,7 @@ EffectInstance::getImage(int inputNb,
 
 
     if (mapToClipPrefs) {
-        inputImg = convertPlanesFormatsIfNeeded(getApp(), inputImg, pixelRoI, clipPrefComps, depth, node->usesAlpha0ToConvertFromRGBToRGBA(), outputPremult, channelForMask);
+        inputImg = convertPlanesFormatsIfNeeded(getApp(), inputImg, pixelRoI, clipPrefComps, depth, node->usesAlpha0ToConvertFromRGBToRGBA(), outputPremult, channelForMask, stats, node);
     }
 
 #ifdef DEBUG
@@ -1474,6 +1431,7 @@ static void
 getOrCreateFromCacheInternal(const ImageKey & key,
                              const ImageParamsPtr & params,
                              bool useCache,
+                             bool allowHalfStorage,
                              ImagePtr* image)
 {
     if (!useCache) {
@@ -1512,6 +1470,9 @@ getOrCreateFromCacheInternal(const ImageKey & key,
 
 
         (*image)->ensureBounds( params->getBounds() );
+
+        // The cache may store the image as half floats once it is rendered, if it is full
+        (*image)->setHalfStorageAllowed( allowHalfStorage, appPTR->getCurrentSettings()->getHalfCacheStorageMaxError() );
     }
 }
 
@@ -1525,7 +1486,7 @@ EffectInstance::convertOpenGLTextureToCachedRAMImage(const ImagePtr& image)
     info.mode = eStorageModeRAM;
 
     ImagePtr ramImage;
-    getOrCreateFromCacheInternal(image->getKey(), params, true /*useCache*/, &ramImage);
+    getOrCreateFromCacheInternal(image->getKey(), params, true /*useCache*/, getNode()->isHalfCacheStorageEnabled(), &ramImage);
     if (!ramImage) {
         return ramImage;
     }
@@ -1608,7 +1569,7 @@ EffectInstance::convertRAMImageToOpenGLTexture(const ImagePtr& image)
 
     // The creation of the image will use glTexImage2D and will get filled with the PBO
     ImagePtr gpuImage;
-    getOrCreateFromCacheInternal(image->getKey(), params, false /*useCache*/, &gpuImage);
+    getOrCreateFromCacheInternal(image->getKey(), params, false /*useCache*/, false /*allowHalfStorage*/, &gpuImage);
 
     // it is good idea to release PBOs with ID 0 after use.
     // Once bound with 0, all pixel operations are back to normal ways.
@@ -1636,6 +1597,7 @@ EffectInstance::getImageFromCacheAndConvertIfNeeded(bool /*useCache*/,
                                                     const OSGLContextAttacherPtr& glContextAttacher,
                                                     ImagePtr* image)
 {
+    RenderStatsTraceScope traceScope( stats, getNode(), "cacheLookup", key.getTime() );
     ImageList cachedImages;
     bool isCached = false;
 
@@ -1774,7 +1736,7 @@ EffectInstance::getImageFromCacheAndConvertIfNeeded(bool /*useCache*/,
 
 
                 ImagePtr img;
-                getOrCreateFromCacheInternal(key, imageParams, imageToConvert->usesBitMap(), &img);
+                getOrCreateFromCacheInternal(key, imageParams, imageToConvert->usesBitMap(), getNode()->isHalfCacheStorageEnabled(), &img);
                 if (!img) {
                     return;
                 }
@@ -1995,6 +1957,8 @@ EffectInstance::allocateImagePlane(const ImageKey & key,
                                    ImagePtr* fullScaleImage,
                                    ImagePtr* downscaleImage)
 {
+    const bool allowHalfStorage = getNode()->isHalfCacheStorageEnabled();
+
     //If we're rendering full scale and with input images at full scale, don't cache the downscale image since it is cheap to
     //recreate, instead cache the full-scale image
     if (renderFullScaleThenDownscale) {
@@ -2013,7 +1977,7 @@ EffectInstance::allocateImagePlane(const ImageKey & key,
         //The upscaled image will be rendered with input images at full def, it is then the best possibly rendered image so cache it!
 
         fullScaleImage->reset();
-        getOrCreateFromCacheInternal(key, upscaledImageParams, createInCache, fullScaleImage);
+        getOrCreateFromCacheInternal(key, upscaledImageParams, createInCache, allowHalfStorage, fullScaleImage);
 
         if (!*fullScaleImage) {
             return false;
@@ -2037,7 +2001,7 @@ EffectInstance::allocateImagePlane(const ImageKey & key,
         ///When calling allocateMemory() on the image, the cache already has the lock since it added it
         ///so taking this lock now ensures the image will be allocated completetly
 
-        getOrCreateFromCacheInternal(key, cachedImgParams, createInCache, downscaleImage);
+        getOrCreateFromCacheInternal(key, cachedImgParams, createInCache, allowHalfStorage, downscaleImage);
         if (!*downscaleImage) {
             return false;
         }
@@ -2155,6 +2119,19 @@ EffectInstance::Implementation::tiledRenderingFunctor(EffectInstance::Implementa
         appPTR->getAppTLS()->copyTLS(callingThread, curThread);
     }
 
+    ///Render the tile on the same NUMA node as the frame so that the images stay in local memory.
+    ///This does nothing on the thread that rendered the frame, which is already placed on that node.
+    NumaPlacement::ThreadScope numaScope(args.numaNode);
+
+    ///The thread that launched the tiles already waited for its turn when it started its own tile, do not let the
+    ///tiles it waits for be delayed by lower priority renders
+    EffectTLSDataPtr tls = tlsData->getTLSData();
+    ParallelRenderArgsPtr frameArgs;
+    if ( tls && !tls->frameArgs.empty() ) {
+        frameArgs = tls->frameArgs.back();
+    }
+    RenderTaskScheduler::TileScope tileScope(frameArgs, !args.launchedFromTile);
+
 
     EffectInstance::RenderingFunctorRetEnum ret = tiledRenderingFunctor(specificData,
                                                                         args.renderFullScaleThenDownscale,
@@ -2214,6 +2191,9 @@ EffectInstance::Implementation::tiledRenderingFunctor(const RectToRender & rectT
 
     assert( !rectToRender.rect.isNull() );
 
+    ///Wait for renders of a higher priority class, this does nothing if the tile was already scheduled by the caller
+    RenderTaskScheduler::TileScope tileScope( tls->frameArgs.empty() ? ParallelRenderArgsPtr() : tls->frameArgs.back() );
+
     /*
      * renderMappedRectToRender is in the mapped mipmap level, i.e the expected mipmap level of the render action of the plug-in
      */
@@ -2397,13 +2377,10 @@ EffectInstance::Implementation::renderHandler(const EffectTLSDataPtr& tls,
                                               const ImagePremultiplicationEnum originalImagePremultiplication,
                                               ImagePlanesToRender & planes)
 {
-    TimeLapsePtr timeRecorder;
+    // Always measured: the render time is stored in the cached images for the cost-aware eviction policy
+    TimeLapsePtr timeRecorder = boost::make_shared<TimeLapse>();
     const ParallelRenderArgsPtr& frameArgs = tls->frameArgs.back();
 
-    if (frameArgs->stats) {
-        timeRecorder = boost::make_shared<TimeLapse>();
-    }
-
     const EffectInstance::PlaneToRender & firstPlane = planes.planes.begin()->second;
     const double time = tls->currentRenderArgs.time;
     const ViewIdx view = tls->currentRenderArgs.view;
@@ -2646,6 +2623,8 @@ EffectInstance::Implementation::renderHandler(const EffectTLSDataPtr& tls,
 
     bool renderAborted = false;
     std::map<ImagePlaneDesc, EffectInstance::PlaneToRender> outputPlanes;
+    // Time spent in the render action for each plane, charged to the cached images below
+    std::map<ImagePlaneDesc, double> planesRenderActionTime;
     for (std::list<std::list<std::pair<ImagePlaneDesc, ImagePtr> > >::iterator it = planesLists.begin(); it != planesLists.end(); ++it) {
         if (!multiPlanar) {
             assert( !it->empty() );
@@ -2695,7 +2674,17 @@ EffectInstance::Implementation::renderHandler(const EffectTLSDataPtr& tls,
             }
         }
 
-        StatusEnum st = _publicInterface->render_public(actionArgs);
+        StatusEnum st;
+        const double renderActionStart = timeRecorder->getTimeSinceCreation();
+        {
+            RenderStatsTraceScope traceScope(frameArgs->stats, _publicInterface->getNode(), "render", time);
+            st = _publicInterface->render_public(actionArgs);
+        }
+        // A multi-planar render action produces all planes at once: share its time among them
+        const double renderActionTime = ( timeRecorder->getTimeSinceCreation() - renderActionStart ) / it->size();
+        for (std::list<std::pair<ImagePlaneDesc, ImagePtr> >::const_iterator it2 = it->begin(); it2 != it->end(); ++it2) {
+            planesRenderActionTime[it2->first] += renderActionTime;
+        }
 
         if (planes.useOpenGL) {
             glDisable(GL_SCISSOR_TEST);
@@ -2754,6 +2743,7 @@ EffectInstance::Implementation::renderHandler(const EffectTLSDataPtr& tls,
 
     //Check for NaNs, copy to output image and mark for rendered
     for (std::map<ImagePlaneDesc, EffectInstance::PlaneToRender>::const_iterator it = outputPlanes.begin(); it != outputPlanes.end(); ++it) {
+        const double planeStart = timeRecorder->getTimeSinceCreation();
         bool unPremultRequired = unPremultIfNeeded && it->second.tmpImage->getComponentsCount() == 4 && it->second.renderMappedImage->getComponentsCount() == 3;
 
         if ( frameArgs->doNansHandling && it->second.tmpImage->checkForNaNs(actionArgs.roi) ) {
@@ -2823,10 +2813,18 @@ EffectInstance::Implementation::renderHandler(const EffectTLSDataPtr& tls,
                 }
 
                 if (mappedOriginalInputImage) {
-                    it->second.tmpImage->copyUnProcessedChannels(renderMappedRectToRender, planes.outputPremult, originalImagePremultiplication, processChannels, mappedOriginalInputImage, true);
-                    if (useMaskMix) {
-                        it->second.tmpImage->applyMaskMix(renderMappedRectToRender, maskImage.get(), mappedOriginalInputImage.get(), doMask, false, mix);
-                    }
+                    Image::PostRenderSteps steps;
+                    steps.copyUnProcessedChannels = true;
+                    steps.processChannels = processChannels;
+                    steps.outputPremult = planes.outputPremult;
+                    steps.originalImagePremult = originalImagePremultiplication;
+                    steps.ignorePremult = true;
+                    steps.originalImage = mappedOriginalInputImage;
+                    steps.maskMix = useMaskMix;
+                    steps.maskImg = maskImage.get();
+                    steps.masked = doMask;
+                    steps.mix = mix;
+                    it->second.tmpImage->applyPostRenderSteps(renderMappedRectToRender, steps);
                 }
                 if ( ( it->second.fullscaleImage->getComponents() != it->second.tmpImage->getComponents() ) ||
                      ( it->second.fullscaleImage->getBitDepth() != it->second.tmpImage->getBitDepth() ) ) {
@@ -2900,11 +2898,31 @@ EffectInstance::Implementation::renderHandler(const EffectTLSDataPtr& tls,
                     }
                 }
 
-                it->second.downscaleImage->copyUnProcessedChannels(actionArgs.roi, planes.outputPremult, originalImagePremultiplication, processChannels, originalInputImage, true, glContext);
-                if (useMaskMix) {
-                    it->second.downscaleImage->applyMaskMix(actionArgs.roi, maskImage.get(), originalInputImage.get(), doMask, false, mix, glContext);
-                }
+                Image::PostRenderSteps steps;
+                steps.copyUnProcessedChannels = true;
+                steps.processChannels = processChannels;
+                steps.outputPremult = planes.outputPremult;
+                steps.originalImagePremult = originalImagePremultiplication;
+                steps.ignorePremult = true;
+                steps.originalImage = originalInputImage;
+                steps.maskMix = useMaskMix;
+                steps.maskImg = maskImage.get();
+                steps.masked = doMask;
+                steps.mix = mix;
+                it->second.downscaleImage->applyPostRenderSteps(actionArgs.roi, steps, glContext);
             } // if (renderFullScaleThenDownscale) {
+
+            ///Accumulate the time spent on this rectangle for this plane only in the cached images so the cache
+            ///knows how expensive they are to recompute
+            std::map<ImagePlaneDesc, double>::const_iterator foundActionTime = planesRenderActionTime.find(it->first);
+            const double renderTime = ( foundActionTime != planesRenderActionTime.end() ? foundActionTime->second : 0. ) +
+                                      ( timeRecorder->getTimeSinceCreation() - planeStart );
+            if (it->second.downscaleImage) {
+                it->second.downscaleImage->addRecomputeCost(renderTime);
+            }
+            if ( it->second.fullscaleImage && (it->second.fullscaleImage != it->second.downscaleImage) ) {
+                it->second.fullscaleImage->addRecomputeCost(renderTime);
+            }
         } // if (it->second.isAllocatedOnTheFly) {
 
         if ( frameArgs->stats && frameArgs->stats->isInDepthProfilingEnabled() ) {
@@ -3084,10 +3102,15 @@ EffectInstance::evaluate(bool isSignificant,
     double time = getCurrentTime();
     std::list<ViewerInstance* > viewers;
     node->hasViewersConnected(&viewers);
+    AppInstancePtr app = getApp();
     for (std::list<ViewerInstance* >::iterator it = viewers.begin();
          it != viewers.end();
          ++it) {
         if (isSignificant) {
+            if ( app && app->deferViewerRender(*it) ) {
+                // Rendered once when the change transaction is committed
+                continue;
+            }
             (*it)->renderCurrentFrame(true);
         } else {
             (*it)->redrawViewer();
@@ -3906,6 +3929,8 @@ EffectInstance::getRegionOfDefinition_public(U64 hash,
         {
             RECURSIVE_ACTION();
 
+            ParallelRenderArgsPtr frameArgs = getParallelRenderArgsTLS();
+            RenderStatsTraceScope traceScope(frameArgs ? frameArgs->stats : RenderStatsPtr(), getNode(), "getRegionOfDefinition", time);
 
             ret = getRegionOfDefinition(hash, time, supportsRenderScaleMaybe() == eSupportsNo ? scaleOne : scale, view, rod);
 
@@ -3971,6 +3996,8 @@ EffectInstance::getFramesNeeded_public(U64 hash,
     }
 
     try {
+        ParallelRenderArgsPtr frameArgs = getParallelRenderArgsTLS();
+        RenderStatsTraceScope traceScope(frameArgs ? frameArgs->stats : RenderStatsPtr(), getNode(), "getFramesNeeded", time);
         framesNeeded = getFramesNeeded(time, view);
     } catch (std::exception &e) {
         if ( !hasPersistentMessage() ) { // plugin may already have set a message
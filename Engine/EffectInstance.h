@@ -107,6 +107,7 @@
 #define PLUGINID_NATRON_READ    (NATRON_ORGANIZATION_DOMAIN_TOPLEVEL "." NATRON_ORGANIZATION_DOMAIN_SUB ".built-in.Read")
 #define PLUGINID_NATRON_WRITE    (NATRON_ORGANIZATION_DOMAIN_TOPLEVEL "." NATRON_ORGANIZATION_DOMAIN_SUB ".built-in.Write")
 #define PLUGINID_NATRON_ONEVIEW    (NATRON_ORGANIZATION_DOMAIN_TOPLEVEL "." NATRON_ORGANIZATION_DOMAIN_SUB ".built-in.OneView")
+#define PLUGINID_NATRON_IMAGEBUFFER    (NATRON_ORGANIZATION_DOMAIN_TOPLEVEL "." NATRON_ORGANIZATION_DOMAIN_SUB ".built-in.ImageBuffer")
 
 #define kReaderParamNameOriginalFrameRange "originalFrameRange"
 
@@ -2186,7 +2187,9 @@ private:
                                                                  ImageBitDepthEnum targetDepth,
                                                                  bool useAlpha0ForRGBToRGBAConversion,
                                                                  ImagePremultiplicationEnum outputPremult,
-                                                                 int channelForAlpha);
+                                                                 int channelForAlpha,
+                                                                 const RenderStatsPtr& stats = RenderStatsPtr(),
+                                                                 const NodePtr& caller = NodePtr());
 
 
     /**
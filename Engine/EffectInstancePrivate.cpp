@@ -31,6 +31,7 @@
 #include "Engine/AppInstance.h"
 #include "Engine/Node.h"
 #include "Engine/NodeGroup.h"
+#include "Engine/RenderTaskScheduler.h"
 #include "Engine/ViewIdx.h"
 
 
@@ -597,6 +598,8 @@ EffectInstance::Implementation::waitForImageBeingRenderedElsewhere(const RectI &
 
     bool ab = _publicInterface->aborted();
 
+    // Do not let the render producing the image be paused by the render task scheduler while we wait for it
+    RenderTaskScheduler::PendingImageWaitScope pendingImageWait;
     QMutexLocker kk(&ibr->lock);
     while (!ab && isBeingRenderedElseWhere && !ibr->failed && ibr->refCount > 1) {
         ibr->cond.wait(&ibr->lock, 50);
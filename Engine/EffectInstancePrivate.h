@@ -334,6 +334,8 @@ public:
         bool byPassCache;
         std::bitset<4> processChannels;
         ImagePlanesToRenderPtr planes;
+        int numaNode; // NUMA node of the thread that launched the tiled rendering
+        bool launchedFromTile; // true if the thread that launched the tiled rendering was itself rendering a tile
     };
 
     RenderingFunctorRetEnum tiledRenderingFunctor(TiledRenderingFunctorArgs & args,  const RectToRender & specificData,
@@ -396,10 +398,6 @@ public:
                                           const ImagePremultiplicationEnum originalImagePremultiplication,
                                           ImagePlanesToRender & planes);
 
-    static bool aborted(bool isRenderResponseToUserInteraction,
-                        const AbortableRenderInfoPtr& abortInfo,
-                        const EffectInstancePtr& treeRoot)  WARN_UNUSED_RETURN;
-
     void checkMetadata(NodeMetadata &metadata);
 };
 
@@ -61,6 +61,7 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #include "Engine/KnobTypes.h"
 #include "Engine/Log.h"
 #include "Engine/Node.h"
+#include "Engine/NumaPlacement.h"
 #include "Engine/OfxEffectInstance.h"
 #include "Engine/OfxEffectInstance.h"
 #include "Engine/OfxImageEffectInstance.h"
@@ -70,6 +71,7 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #include "Engine/PluginMemory.h"
 #include "Engine/Project.h"
 #include "Engine/RenderStats.h"
+#include "Engine/RenderTaskScheduler.h"
 #include "Engine/RotoContext.h"
 #include "Engine/RotoDrawableItem.h"
 #include "Engine/Settings.h"
@@ -171,7 +173,9 @@ EffectInstance::convertPlanesFormatsIfNeeded(const AppInstancePtr& app,
                                              ImageBitDepthEnum targetDepth,
                                              bool useAlpha0ForRGBToRGBAConversion,
                                              ImagePremultiplicationEnum outputPremult,
-                                             int channelForAlpha)
+                                             int channelForAlpha,
+                                             const RenderStatsPtr& stats,
+                                             const NodePtr& caller)
 {
     // Do not do any conversion for OpenGL textures, OpenGL is managing it for us.
     if (inputImage->getStorageMode() == eStorageModeGLTex) {
@@ -182,6 +186,8 @@ EffectInstance::convertPlanesFormatsIfNeeded(const AppInstancePtr& app,
     if (!imageConversionNeeded) {
         return inputImage;
     } else {
+        RenderStatsTraceScope traceScope( stats, caller, "convertFormat", inputImage->getTime() );
+
         /**
          * Lock the downscaled image so it cannot be resized while creating the temp image and calling convertToFormat.
          **/
@@ -699,7 +705,7 @@ EffectInstance::renderRoI(const RenderRoIArgs & args,
                                 premult = eImagePremultiplicationOpaque;
                             }
 
-                            ImagePtr tmp = convertPlanesFormatsIfNeeded(app, it->second, args.roi, *compIt, inputArgs->bitdepth, useAlpha0ForRGBToRGBAConversion, premult, -1);
+                            ImagePtr tmp = convertPlanesFormatsIfNeeded(app, it->second, args.roi, *compIt, inputArgs->bitdepth, useAlpha0ForRGBToRGBAConversion, premult, -1, frameArgs->stats, getNode());
                             assert(tmp);
                             convertedPlanes[it->first] = tmp;
                         }
@@ -1788,7 +1794,7 @@ EffectInstance::renderRoI(const RenderRoIArgs & args,
         assert(comp);
         ///The image might need to be converted to fit the original requested format
         if (comp) {
-            it->second.downscaleImage = convertPlanesFormatsIfNeeded(getApp(), it->second.downscaleImage, originalRoI, *comp, args.bitdepth, useAlpha0ForRGBToRGBAConversion, planesToRender->outputPremult, -1);
+            it->second.downscaleImage = convertPlanesFormatsIfNeeded(getApp(), it->second.downscaleImage, originalRoI, *comp, args.bitdepth, useAlpha0ForRGBToRGBAConversion, planesToRender->outputPremult, -1, frameArgs->stats, getNode());
             assert(it->second.downscaleImage->getComponents() == *comp && it->second.downscaleImage->getBitDepth() == args.bitdepth);
 
             StorageModeEnum imageStorage = it->second.downscaleImage->getStorageMode();
@@ -1980,6 +1986,8 @@ EffectInstance::renderRoIInternal(EffectInstance* self,
             tiledArgs->processChannels = processChannels;
             tiledArgs->planes = planesToRender;
             tiledArgs->compsNeeded = compsNeeded;
+            tiledArgs->numaNode = NumaPlacement::getCurrentThreadNode();
+            tiledArgs->launchedFromTile = RenderTaskScheduler::isCurrentThreadInTile();
 
 
 #ifdef NATRON_HOSTFRAMETHREADING_SEQUENTIAL
@@ -92,6 +92,7 @@ SOURCES += \
     FitCurve.cpp \
     FrameEntry.cpp \
     FrameKey.cpp \
+    FrameParams.cpp \
     FrameParamsSerialization.cpp \
     GLShader.cpp \
     GPUContextPool.cpp \
@@ -103,12 +104,16 @@ SOURCES += \
     HistogramCPU.cpp \
     HostOverlaySupport.cpp \
     Image.cpp \
+    ImageBufferNode.cpp \
+    ImageBufferPool.cpp \
     ImageConvert.cpp \
     ImageCopyChannels.cpp \
     ImageKey.cpp \
     ImageMaskMix.cpp \
     ImageParamsSerialization.cpp \
     ImagePlaneDesc.cpp \
+    ImagePostRender.cpp \
+    ImageHalfStorage.cpp \
     Interpolation.cpp \
     JoinViewsNode.cpp \
     Knob.cpp \
@@ -121,6 +126,7 @@ SOURCES += \
     Lut.cpp \
     Markdown.cpp \
     MemoryFile.cpp \
+    MemoryGovernor.cpp \
     MemoryInfo.cpp \
     NoOpBase.cpp \
     Node.cpp \
@@ -136,6 +142,7 @@ SOURCES += \
     Noise.cpp \
     NonKeyParams.cpp \
     NonKeyParamsSerialization.cpp \
+    NumaPlacement.cpp \
     OSGLContext.cpp \
     OSGLContext_mac.cpp \
     OSGLContext_win.cpp \
@@ -169,7 +176,10 @@ SOURCES += \
     ReadNode.cpp \
     RectD.cpp \
     RectI.cpp \
+    RenderAbortToken.cpp \
+    RenderServer.cpp \
     RenderStats.cpp \
+    RenderTaskScheduler.cpp \
     RotoContext.cpp \
     RotoDrawableItem.cpp \
     RotoItem.cpp \
@@ -213,6 +223,7 @@ SOURCES += \
     NatronEngine/booleanparam_wrapper.cpp \
     NatronEngine/boolnodecreationproperty_wrapper.cpp \
     NatronEngine/buttonparam_wrapper.cpp \
+    NatronEngine/changetransaction_wrapper.cpp \
     NatronEngine/choiceparam_wrapper.cpp \
     NatronEngine/colorparam_wrapper.cpp \
     NatronEngine/colortuple_wrapper.cpp \
@@ -227,6 +238,7 @@ SOURCES += \
     NatronEngine/floatnodecreationproperty_wrapper.cpp \
     NatronEngine/group_wrapper.cpp \
     NatronEngine/groupparam_wrapper.cpp \
+    NatronEngine/imagebuffer_wrapper.cpp \
     NatronEngine/imagelayer_wrapper.cpp \
     NatronEngine/int2dparam_wrapper.cpp \
     NatronEngine/int2dtuple_wrapper.cpp \
@@ -282,6 +294,7 @@ HEADERS += \
     CurvePrivate.h \
     CurveSerialization.h \
     DefaultShaders.h \
+    DirectoryContent.h \
     DiskCacheNode.h \
     DockablePanelI.h \
     Dot.h \
@@ -310,6 +323,8 @@ HEADERS += \
     HistogramCPU.h \
     HostOverlaySupport.h \
     Image.h \
+    ImageBufferNode.h \
+    ImageBufferPool.h \
     ImageKey.h \
     ImageLocker.h \
     ImageParams.h \
@@ -333,6 +348,7 @@ HEADERS += \
     Lut.h \
     Markdown.h \
     MemoryFile.h \
+    MemoryGovernor.h \
     MemoryInfo.h \
     MergingEnum.h \
     NoOpBase.h \
@@ -348,6 +364,7 @@ HEADERS += \
     NoiseTables.h \
     NonKeyParams.h \
     NonKeyParamsSerialization.h \
+    NumaPlacement.h \
     OSGLContext.h \
     OSGLContext_mac.h \
     OSGLContext_win.h \
@@ -387,7 +404,10 @@ HEADERS += \
     RectDSerialization.h \
     RectI.h \
     RectISerialization.h \
+    RenderAbortToken.h \
+    RenderServer.h \
     RenderStats.h \
+    RenderTaskScheduler.h \
     RotoContext.h \
     RotoContextPrivate.h \
     RotoContextSerialization.h \
@@ -479,6 +499,7 @@ HEADERS += \
     NatronEngine/booleanparam_wrapper.h \
     NatronEngine/boolnodecreationproperty_wrapper.h \
     NatronEngine/buttonparam_wrapper.h \
+    NatronEngine/changetransaction_wrapper.h \
     NatronEngine/choiceparam_wrapper.h \
     NatronEngine/colorparam_wrapper.h \
     NatronEngine/colortuple_wrapper.h \
@@ -493,6 +514,7 @@ HEADERS += \
     NatronEngine/floatnodecreationproperty_wrapper.h \
     NatronEngine/group_wrapper.h \
     NatronEngine/groupparam_wrapper.h \
+    NatronEngine/imagebuffer_wrapper.h \
     NatronEngine/imagelayer_wrapper.h \
     NatronEngine/int2dparam_wrapper.h \
     NatronEngine/int2dtuple_wrapper.h \
@@ -130,6 +130,7 @@ class BlockingBackgroundRender;
 class BufferableObject;
 class CLArgs;
 class CacheEntryHolder;
+struct CacheEntriesChanges;
 class CacheSignalEmitter;
 class ChoiceExtraData;
 class CreateNodeArgs;
@@ -193,6 +194,8 @@ class KnobTable;
 class LibraryBinary;
 class LogEntry;
 class MemoryFile;
+class MemoryGovernor;
+struct MemoryGovernorStatus;
 class Node;
 class NodeCollection;
 class NodeFrameRequest;
@@ -233,6 +236,7 @@ class ProjectSerialization;
 class RectD;
 class RectI;
 class RenderEngine;
+class RenderServer;
 class RenderStats;
 class RenderingFlagSetter;
 class RotoContext;
@@ -25,6 +25,7 @@
 #include "FileSystemModel.h"
 
 #include <vector>
+#include <algorithm>
 #include <cassert>
 #include <stdexcept>
 
@@ -43,6 +44,7 @@ CLANG_DIAG_OFF(uninitialized)
 #include <QtCore/QWaitCondition>
 #include <QtCore/QFileSystemWatcher>
 #include <QtCore/QFileInfo>
+#include <QtCore/QDirIterator>
 #include <QtCore/QDateTime>
 #include <QtCore/QCoreApplication>
 #include <QtCore/QDebug>
@@ -53,6 +55,9 @@ CLANG_DIAG_ON(uninitialized)
 
 #include <SequenceParsing.h>
 
+#include "Engine/DirectoryContent.h"
+#include "Engine/Timer.h"
+
 #ifdef DEBUG
 #include "Global/FloatingPointExceptions.h"
 #endif
@@ -185,8 +190,13 @@ struct FileSystemItemPrivate
 
     ///This will be set when the file system model is in sequence mode and this is a file
     SequenceParsing::SequenceFromFilesPtr sequence;
-    QDateTime dateModified;
-    quint64 size;
+
+    ///The date and size are fetched lazily from firstFileName if metadataFetched is false
+    mutable QDateTime dateModified;
+    mutable quint64 size;
+    mutable bool metadataFetched;
+    QString firstFileName;
+    int filesCount;
     QString fileExtension;
     QString absoluteFilePath;
 
@@ -208,8 +218,16 @@ struct FileSystemItemPrivate
         , sequence(sequence)
         , dateModified(dateModified)
         , size(size)
+        , metadataFetched(true)
+        , firstFileName()
+        , filesCount(1)
         , fileExtension()
         , absoluteFilePath()
+    {
+        updatePaths();
+    }
+
+    void updatePaths()
     {
         if (!isDir) {
             int lastDotPos = filename.lastIndexOf( QChar::fromLatin1('.') );
@@ -218,18 +236,36 @@ struct FileSystemItemPrivate
             }
         }
 
-        if (parent) {
+        FileSystemItemPtr parentItem = parent.lock();
+        if (parentItem) {
             // absoluteFilePath method of QFileInfo class cause the file system
             // query hence causes slower performance
-            if ( !parent->getParentItem() ) {
+            if ( !parentItem->getParentItem() ) {
                 // for drives, there is no filename
                 absoluteFilePath = filename;
             } else {
-                absoluteFilePath = generateChildAbsoluteName(parent.get(), filename);
+                absoluteFilePath = generateChildAbsoluteName(parentItem.get(), filename);
             }
         }
     }
 
+    void fetchMetadata() const
+    {
+        if (metadataFetched) {
+            return;
+        }
+        metadataFetched = true;
+
+        FileSystemItemPtr parentItem = parent.lock();
+        if (!parentItem) {
+            return;
+        }
+        // For sequences, the size is estimated from the size of one file
+        QFileInfo info( generateChildAbsoluteName(parentItem.get(), firstFileName) );
+        dateModified = info.lastModified();
+        size = isDir ? 0 : (quint64)info.size() * filesCount;
+    }
+
     FileSystemModelPtr getModel() const
     {
         return model.lock();
@@ -286,6 +322,16 @@ FileSystemItem::~FileSystemItem()
     }
 }
 
+void
+FileSystemItem::unregisterFromModel()
+{
+    FileSystemModelPtr model = _imp->getModel();
+
+    if (model) {
+        model->_imp->unregisterItem(this);
+    }
+}
+
 void
 FileSystemItem::resetModelPointer()
 {
@@ -373,12 +419,16 @@ FileSystemItem::fileExtension() const
 const QDateTime&
 FileSystemItem::getLastModified() const
 {
+    _imp->fetchMetadata();
+
     return _imp->dateModified;
 }
 
 quint64
 FileSystemItem::getSize() const
 {
+    _imp->fetchMetadata();
+
     return _imp->size;
 }
 
@@ -390,62 +440,141 @@ FileSystemItem::addChild(const FileSystemItemPtr& child)
     _imp->children.push_back(child);
 }
 
-void
-FileSystemItem::addChild(const SequenceParsing::SequenceFromFilesPtr& sequence,
-                         const QFileInfo& info)
+FileSystemItemPtr
+FileSystemItem::createChild(bool isDir,
+                            const QString& filename,
+                            const QString& userFriendlySequenceName,
+                            const SequenceParsing::SequenceFromFilesPtr& sequence,
+                            const QString& firstFileName,
+                            int filesCount)
 {
     FileSystemModelPtr model = _imp->getModel();
 
     if (!model) {
-        return;
+        return FileSystemItemPtr();
+    }
+
+    FileSystemItemPtr child = FileSystemItem::create( model, isDir, filename, userFriendlySequenceName, sequence, QDateTime(), 0, shared_from_this() );
+    child->_imp->metadataFetched = false;
+    child->_imp->firstFileName = firstFileName;
+    child->_imp->filesCount = filesCount;
+    model->_imp->registerItem(child);
+
+    return child;
+}
+
+void
+FileSystemItem::setSequence(const QString& filename,
+                            const QString& userFriendlySequenceName,
+                            const SequenceParsing::SequenceFromFilesPtr& sequence,
+                            int filesCount)
+{
+    assert( QThread::currentThread() == qApp->thread() );
+    _imp->filename = filename;
+    _imp->userFriendlySequenceName = userFriendlySequenceName;
+    _imp->sequence = sequence;
+    if (_imp->filesCount != filesCount) {
+        _imp->filesCount = filesCount;
+        _imp->size = 0;
+        _imp->metadataFetched = _imp->firstFileName.isEmpty();
     }
+    _imp->updatePaths();
+}
+
+void
+FileSystemItem::setMetadata(const QDateTime& dateModified,
+                            quint64 size)
+{
+    _imp->dateModified = dateModified;
+    _imp->size = size;
+    _imp->metadataFetched = true;
+}
+
+void
+FileSystemItem::appendChildren(const std::vector<FileSystemItemPtr>& children)
+{
     QMutexLocker l(&_imp->childrenMutex);
-    ///Does the child exist already ?
-    QString filename;
-    QString userFriendlyFilename;
-    if (!sequence) {
-        filename = info.fileName();
-        userFriendlyFilename = filename;
-    } else {
-        std::string pattern = sequence->generateValidSequencePattern();
-        SequenceParsing::removePath(pattern);
-        filename = QString::fromUtf8( pattern.c_str() );
-        if ( !sequence->isSingleFile() ) {
-            pattern = sequence->generateUserFriendlySequencePatternFromValidPattern(pattern);
-        }
-        userFriendlyFilename = QString::fromUtf8( pattern.c_str() );
+
+    _imp->children.insert( _imp->children.end(), children.begin(), children.end() );
+}
+
+namespace {
+// Same order as QDir::entryInfoList() with QDir::DirsFirst | QDir::IgnoreCase
+class FileSystemItemCompare
+{
+    FileSystemModel::Sections _section;
+    Qt::SortOrder _order;
+
+public:
+
+    FileSystemItemCompare(FileSystemModel::Sections section,
+                          Qt::SortOrder order)
+        : _section(section)
+        , _order(order)
+    {
+    }
+
+    bool operator()(const FileSystemItemPtr& a,
+                    const FileSystemItemPtr& b) const
+    {
+        // The descending order is the exact reverse of the ascending order
+        return _order == Qt::AscendingOrder ? lessThan(*a, *b) : lessThan(*b, *a);
     }
 
+private:
 
-    for (std::vector<FileSystemItemPtr>::iterator it = _imp->children.begin(); it != _imp->children.end(); ++it) {
-        if ( (*it)->fileName() == filename ) {
-            _imp->children.erase(it);
+    bool lessThan(const FileSystemItem& a,
+                  const FileSystemItem& b) const
+    {
+        if ( a.isDir() != b.isDir() ) {
+            return a.isDir();
+        }
+        switch (_section) {
+        case FileSystemModel::Size:
+            // Largest first
+            if ( a.getSize() != b.getSize() ) {
+                return a.getSize() > b.getSize();
+            }
+            break;
+        case FileSystemModel::DateModified:
+            // Most recent first
+            if ( a.getLastModified() != b.getLastModified() ) {
+                return a.getLastModified() > b.getLastModified();
+            }
+            break;
+        case FileSystemModel::Type: {
+            int c = QString::compare(a.fileExtension(), b.fileExtension(), Qt::CaseInsensitive);
+            if (c != 0) {
+                return c < 0;
+            }
+            break;
+        }
+        default:
             break;
         }
+
+        return QString::compare(a.fileName(), b.fileName(), Qt::CaseInsensitive) < 0;
     }
+};
+}
 
+void
+FileSystemItem::sortChildren(int section,
+                             Qt::SortOrder order,
+                             int sortedChildrenCount)
+{
+    QMutexLocker l(&_imp->childrenMutex);
+    FileSystemItemCompare compare( (FileSystemModel::Sections)section, order );
 
-    bool isDir = sequence ? false : info.isDir();
-    qint64 size;
-    if (sequence) {
-        size = sequence->getEstimatedTotalSize();
+    if ( (sortedChildrenCount <= 0) || ( sortedChildrenCount >= (int)_imp->children.size() ) ) {
+        std::stable_sort(_imp->children.begin(), _imp->children.end(), compare);
     } else {
-        size = isDir ? 0 : info.size();
+        // Only merge the new children with the ones already sorted
+        std::vector<FileSystemItemPtr>::iterator middle = _imp->children.begin() + sortedChildrenCount;
+        std::stable_sort(middle, _imp->children.end(), compare);
+        std::inplace_merge(_imp->children.begin(), middle, _imp->children.end(), compare);
     }
-
-
-    ///Create the child
-    FileSystemItemPtr child = boost::make_shared<FileSystemItem::MakeSharedEnabler>( model,
-                                                                                                    isDir,
-                                                                                                    filename,
-                                                                                                    userFriendlyFilename,
-                                                                                                    sequence,
-                                                                                                    info.lastModified(),
-                                                                                                    size,
-                                                                                                    shared_from_this() );
-    model->_imp->registerItem(child);
-    _imp->children.push_back(child);
-} // FileSystemItem::addChild
+}
 
 void
 FileSystemItem::clearChildren()
@@ -1247,6 +1376,7 @@ FileSystemModel::initGatherer()
     if (!_imp->gatherer) {
         _imp->gatherer.reset( new FileGathererThread( shared_from_this() ) );
         assert(_imp->gatherer);
+        QObject::connect( _imp->gatherer.get(), SIGNAL(contentGathered()), this, SLOT(onContentGatheredByGatherer()) );
         QObject::connect( _imp->gatherer.get(), SIGNAL(directoryLoaded(QString)), this, SLOT(onDirectoryLoadedByGatherer(QString)) );
     }
 }
@@ -1260,6 +1390,74 @@ FileSystemModelPrivate::populateItem(const FileSystemItemPtr &item)
     gatherer->fetchDirectory(item);
 }
 
+void
+FileSystemModel::onContentGatheredByGatherer()
+{
+    FileGathererContent content;
+
+    if ( !_imp->gatherer || !_imp->gatherer->takeGatheredContent(&content) ) {
+        return;
+    }
+
+    const FileSystemItemPtr& item = content.directory;
+    QModelIndex idx = index(item.get(), 0);
+    if ( !idx.isValid() ) {
+        // The directory was removed from the model in the meantime
+        content.unregisterNewItems();
+
+        return;
+    }
+
+    if (content.isFirstContent) {
+        int count = item->childCount();
+        if (count > 0) {
+            beginRemoveRows(idx, 0, count - 1);
+            item->clearChildren();
+            endRemoveRows();
+        }
+    }
+
+    int sortedChildrenCount = item->childCount();
+    if ( !content.newItems.empty() ) {
+        beginInsertRows(idx, sortedChildrenCount, sortedChildrenCount + (int)content.newItems.size() - 1);
+        item->appendChildren(content.newItems);
+        endInsertRows();
+    }
+
+    for (FileGathererContent::SequenceUpdates::const_iterator it = content.updates.begin(); it != content.updates.end(); ++it) {
+        it->first->setSequence(it->second.filename, it->second.userFriendlySequenceName, it->second.sequence, it->second.filesCount);
+        if (it->second.hasMetadata) {
+            it->first->setMetadata(it->second.dateModified, it->second.size);
+        }
+    }
+    if ( !content.updates.empty() ) {
+        // Renamed sequences may have to be moved
+        sortedChildrenCount = 0;
+        Q_EMIT dataChanged( index(0, 0, idx), index(item->childCount() - 1, (int)EndSections - 1, idx) );
+    }
+
+    if ( content.newItems.empty() && content.updates.empty() ) {
+        return;
+    }
+
+    Q_EMIT layoutAboutToBeChanged();
+    item->sortChildren(sortIndicatorSection(), sortIndicatorOrder(), sortedChildrenCount);
+
+    ///Move the persistent indexes (e.g: the selection) of the children that were sorted
+    QModelIndexList oldIndexes = persistentIndexList();
+    QModelIndexList newIndexes;
+    for (QModelIndexList::const_iterator it = oldIndexes.begin(); it != oldIndexes.end(); ++it) {
+        FileSystemItem* child = getFileSystemItem(*it);
+        if ( child && (child->getParentItem() == item) ) {
+            newIndexes.push_back( createIndex(child->indexInParent(), it->column(), child) );
+        } else {
+            newIndexes.push_back(*it);
+        }
+    }
+    changePersistentIndexList(oldIndexes, newIndexes);
+    Q_EMIT layoutChanged();
+} // FileSystemModel::onContentGatheredByGatherer
+
 void
 FileSystemModel::onDirectoryLoadedByGatherer(const QString& directory)
 {
@@ -1380,6 +1578,10 @@ struct FileGathererThreadPrivate
     FileSystemItemPtr requestedItem, itemBeingFetched;
     QMutex requestedDirMutex;
 
+    ///The content gathered that was not taken yet by the model
+    boost::shared_ptr<FileGathererContent> gatheredContent;
+    QMutex gatheredContentMutex;
+
     FileGathererThreadPrivate(const FileSystemModelPtr& model)
         : model(model)
         , mustQuit(false)
@@ -1396,6 +1598,8 @@ struct FileGathererThreadPrivate
         , requestedItem()
         , itemBeingFetched()
         , requestedDirMutex()
+        , gatheredContent()
+        , gatheredContentMutex()
     {
     }
 
@@ -1550,7 +1754,98 @@ FileGathererThread::run()
     }
 }
 
-static bool
+// The content gathered is published to the model at this interval (in seconds), so that
+// the first entries of large directories are displayed without waiting for the full listing
+#define NATRON_FILE_GATHERER_PUBLISH_INTERVAL 0.2
+
+// Maximum number of directories and entries kept in the listing cache
+#define NATRON_DIRECTORY_LISTING_CACHE_MAX_DIRECTORIES 32
+#define NATRON_DIRECTORY_LISTING_CACHE_MAX_ENTRIES 1000000
+
+void
+FileGathererContent::unregisterNewItems() const
+{
+    for (std::vector<FileSystemItemPtr>::const_iterator it = newItems.begin(); it != newItems.end(); ++it) {
+        (*it)->unregisterFromModel();
+    }
+}
+
+DirectoryListingCache::DirectoryListingCache()
+    : _lock()
+    , _listings()
+    , _entriesCount(0)
+    , _usageCounter(0)
+{
+}
+
+bool
+DirectoryListingCache::get(const QString& path,
+                           QDir::Filters filters,
+                           const QDateTime& lastModified,
+                           DirectoryEntries* entries)
+{
+    QMutexLocker k(&_lock);
+    ListingMap::iterator found = _listings.find(path);
+
+    if ( ( found == _listings.end() ) || (found->second.filters != filters) || (found->second.lastModified != lastModified) ) {
+        return false;
+    }
+    found->second.lastUsed = ++_usageCounter;
+    *entries = found->second.entries;
+
+    return true;
+}
+
+void
+DirectoryListingCache::insert(const QString& path,
+                              QDir::Filters filters,
+                              const QDateTime& lastModified,
+                              const DirectoryEntries& entries)
+{
+    // The modification date has a precision of a second: a directory modified within the last seconds
+    // could still be modified without its date changing
+    if ( !lastModified.isValid() || (lastModified.secsTo( QDateTime::currentDateTime() ) < 2) ||
+         (entries.size() > NATRON_DIRECTORY_LISTING_CACHE_MAX_ENTRIES) ) {
+        return;
+    }
+
+    QMutexLocker k(&_lock);
+    erase(path);
+    Listing& listing = _listings[path];
+    listing.lastModified = lastModified;
+    listing.filters = filters;
+    listing.entries = entries;
+    listing.lastUsed = ++_usageCounter;
+    _entriesCount += entries.size();
+
+    // Evict the least recently used listings
+    while ( (_listings.size() > NATRON_DIRECTORY_LISTING_CACHE_MAX_DIRECTORIES) || (_entriesCount > NATRON_DIRECTORY_LISTING_CACHE_MAX_ENTRIES) ) {
+        ListingMap::iterator oldest = _listings.begin();
+        for (ListingMap::iterator it = _listings.begin(); it != _listings.end(); ++it) {
+            if (it->second.lastUsed < oldest->second.lastUsed) {
+                oldest = it;
+            }
+        }
+        erase(oldest->first);
+    }
+}
+
+void
+DirectoryListingCache::erase(const QString& path)
+{
+    ListingMap::iterator found = _listings.find(path);
+
+    if ( found != _listings.end() ) {
+        _entriesCount -= found->second.entries.size();
+        _listings.erase(found);
+    }
+}
+
+namespace {
+// Shared by all file dialogs, never destroyed
+DirectoryListingCache* directoryListingCache = new DirectoryListingCache;
+
+bool
 isVideoFileExtension(const std::string& ext)
 {
     if ( (ext == "mov") ||
@@ -1573,133 +1868,311 @@ isVideoFileExtension(const std::string& ext)
     return false;
 }
 
-typedef std::list<std::pair<SequenceParsing::SequenceFromFilesPtr, QFileInfo > > FileSequences;
+/**
+ * @brief Returns the file name where each number is replaced by a '#': files that may belong to the same
+ * sequence have the same key, so that a new file is only tried against the sequences with the same key.
+ **/
+QString
+getSequenceKey(const QString& filename)
+{
+    QString key;
 
-#define KERNEL_INCR() \
-    switch (viewOrder) \
-    { \
-    case Qt::AscendingOrder: \
-        ++i; \
-        break; \
-    case Qt::DescendingOrder: \
-        --i; \
-        break; \
+    key.reserve( filename.size() );
+    for (int i = 0; i < filename.size(); ++i) {
+        if ( filename[i].isDigit() || ( ( filename[i] == QLatin1Char('-') ) && (i + 1 < filename.size()) && filename[i + 1].isDigit() ) ) {
+            while ( i + 1 < filename.size() && filename[i + 1].isDigit() ) {
+                ++i;
+            }
+            key.append( QLatin1Char('#') );
+        } else {
+            key.append(filename[i]);
+        }
     }
 
+    return key;
+}
+
+} // anon namespace
+
+DirectoryContentGrouper::DirectoryContentGrouper(const FileSystemItemPtr& directory,
+                                                 const FileSystemModelPtr& model,
+                                                 bool sequenceMode,
+                                                 bool fetchMetadata)
+    : _directory(directory)
+    , _model(model)
+    , _sequenceMode(sequenceMode)
+    , _fetchMetadata(fetchMetadata)
+    , _groups()
+    , _groupsBySequenceKey()
+    , _firstUnpublishedGroup(0)
+    , _modifiedGroups()
+    , _published(false)
+{
+}
+
 void
-FileGathererThread::gatheringKernel(const FileSystemItemPtr& item)
+DirectoryContentGrouper::addEntry(const QString& filename,
+                                  bool isDir)
 {
-    if (!item) {
+    if (isDir) {
+        addGroup(true, filename, SequenceParsing::SequenceFromFilesPtr());
+
         return;
     }
-    QDir dir( item->absoluteFilePath() );
-    FileSystemModelPtr model = _imp->getModel();
-    if (!model) {
+
+    /// If the item does not match the filter regexp set by the user, discard it
+    if ( !_model->isAcceptedByRegexps(filename) ) {
         return;
     }
 
-    Qt::SortOrder viewOrder = model->sortIndicatorOrder();
-    FileSystemModel::Sections sortSection = (FileSystemModel::Sections)model->sortIndicatorSection();
-    QDir::SortFlags sort;
-    switch (sortSection) {
-    case FileSystemModel::Name:
-        sort = QDir::Name;
-        break;
-    case FileSystemModel::Size:
-        sort = QDir::Size;
-        break;
-    case FileSystemModel::Type:
-        sort = QDir::Type;
-        break;
-    case FileSystemModel::DateModified:
-        sort = QDir::Time;
-        break;
-    default:
-        break;
+    /// If file sequence fetching is disabled, accept it
+    if (!_sequenceMode) {
+        addGroup(false, filename, SequenceParsing::SequenceFromFilesPtr());
+
+        return;
     }
-    sort |= QDir::IgnoreCase;
-    sort |= QDir::DirsFirst;
 
-    ///All entries in the directory
-    QFileInfoList all = dir.entryInfoList(model->filter(), sort);
+    /// Determine if it belongs to another sequence or we need to create a new one
+    SequenceParsing::FileNameContent fileContent( generateChildAbsoluteName(_directory.get(), filename).toStdString() );
+    if ( isVideoFileExtension( fileContent.getExtension() ) ) {
+        addGroup(false, filename, boost::make_shared<SequenceParsing::SequenceFromFiles>(fileContent, false));
 
-    ///List of all possible file sequences in the directory or directories
-    FileSequences sequences;
-    int start = 0;
-    int end = 0;
-    switch (viewOrder) {
-    case Qt::AscendingOrder:
-        start = 0;
-        end = all.size();
-        break;
-    case Qt::DescendingOrder:
-        start = all.size() - 1;
-        end = -1;
-        break;
+        return;
     }
 
-    int i = start;
-    while (i != end) {
-        ///If we must abort we do it now
-        if ( _imp->checkForAbort() ) {
+    std::vector<std::size_t>& candidates = _groupsBySequenceKey[getSequenceKey(filename)];
+    ///Note that we use a reverse iterator because we have more chance to find a match in the last recently added entries
+    for (std::vector<std::size_t>::reverse_iterator it = candidates.rbegin(); it != candidates.rend(); ++it) {
+        Group& group = _groups[*it];
+        if ( group.sequence->tryInsertFile(fileContent, false) ) {
+            ++group.filesCount;
+            if (group.item && !group.modified) {
+                group.modified = true;
+                _modifiedGroups.push_back(*it);
+            }
+
             return;
         }
+    }
 
-        if ( all[i].isDir() ) {
-            ///This is a directory
-            sequences.push_back( std::make_pair(SequenceParsing::SequenceFromFilesPtr(), all[i]) );
-        } else {
-            QString filename = all[i].fileName();
-            /// If the item does not match the filter regexp set by the user, discard it
-            if ( !model->isAcceptedByRegexps(filename) ) {
-                KERNEL_INCR();
-                continue;
-            }
+    // The size is estimated lazily when the sequence is displayed
+    candidates.push_back( _groups.size() );
+    addGroup(false, filename, boost::make_shared<SequenceParsing::SequenceFromFiles>(fileContent, false));
+}
+
+boost::shared_ptr<FileGathererContent>
+DirectoryContentGrouper::takeContent(bool isLastContent)
+{
+    boost::shared_ptr<FileGathererContent> content = boost::make_shared<FileGathererContent>();
+
+    content->directory = _directory;
+    content->isFirstContent = !_published;
+    content->isLastContent = isLastContent;
+    _published = true;
 
-            /// If file sequence fetching is disabled, accept it
-            if ( !model->isSequenceModeEnabled() ) {
-                sequences.push_back( std::make_pair(SequenceParsing::SequenceFromFilesPtr(), all[i]) );
-                KERNEL_INCR();
-                continue;
+    if (isLastContent) {
+        // Single files need no sequence: the pattern of the selection is the path of the item
+        _modifiedGroups.clear();
+        for (std::size_t i = 0; i < _firstUnpublishedGroup; ++i) {
+            if ( _groups[i].sequence && (_groups[i].filesCount > 1) ) {
+                _modifiedGroups.push_back(i);
             }
+        }
+    }
+    for (std::vector<std::size_t>::const_iterator it = _modifiedGroups.begin(); it != _modifiedGroups.end(); ++it) {
+        Group& group = _groups[*it];
+        FileGathererContent::SequenceUpdate& update = content->updates[group.item];
+        getSequenceNames(group, &update.filename, &update.userFriendlySequenceName);
+        if (isLastContent) {
+            update.sequence = group.sequence;
+        }
+        update.filesCount = group.filesCount;
+        if (_fetchMetadata) {
+            getMetadata(group, &update.dateModified, &update.size);
+            update.hasMetadata = true;
+        }
+        group.modified = false;
+    }
+    _modifiedGroups.clear();
+
+    for (; _firstUnpublishedGroup < _groups.size(); ++_firstUnpublishedGroup) {
+        Group& group = _groups[_firstUnpublishedGroup];
+        QString filename, userFriendlyFilename;
+        getSequenceNames(group, &filename, &userFriendlyFilename);
+        group.item = _directory->createChild( group.isDir, filename, userFriendlyFilename,
+                                              isLastContent ? group.sequence : SequenceParsing::SequenceFromFilesPtr(),
+                                              group.firstFileName, group.filesCount );
+        if (!group.item) {
+            continue;
+        }
+        if (_fetchMetadata) {
+            QDateTime dateModified;
+            quint64 size;
+            getMetadata(group, &dateModified, &size);
+            group.item->setMetadata(dateModified, size);
+        }
+        content->newItems.push_back(group.item);
+    }
 
-            std::string absoluteFilePath = generateChildAbsoluteName(item.get(), filename).toStdString();
-            bool foundMatchingSequence = false;
+    return content;
+}
 
-            /// If we reach here, this is a valid file and we need to determine if it belongs to another sequence or we need
-            /// to create a new one
-            SequenceParsing::FileNameContent fileContent(absoluteFilePath);
+void
+DirectoryContentGrouper::addGroup(bool isDir,
+                                  const QString& filename,
+                                  const SequenceParsing::SequenceFromFilesPtr& sequence)
+{
+    Group group;
 
-            if ( !isVideoFileExtension( fileContent.getExtension() ) ) {
-                ///Note that we use a reverse iterator because we have more chance to find a match in the last recently added entries
-                for (FileSequences::reverse_iterator it = sequences.rbegin(); it != sequences.rend(); ++it) {
-                    if ( it->first && it->first->tryInsertFile(fileContent, false) ) {
-                        foundMatchingSequence = true;
-                        break;
-                    }
-                }
+    group.isDir = isDir;
+    group.firstFileName = filename;
+    group.sequence = sequence;
+    group.filesCount = 1;
+    group.modified = false;
+    _groups.push_back(group);
+}
+
+void
+DirectoryContentGrouper::getSequenceNames(const Group& group,
+                                          QString* filename,
+                                          QString* userFriendlyFilename)
+{
+    if (!group.sequence) {
+        *filename = group.firstFileName;
+        *userFriendlyFilename = group.firstFileName;
+
+        return;
+    }
+    std::string pattern = group.sequence->generateValidSequencePattern();
+    SequenceParsing::removePath(pattern);
+    *filename = QString::fromUtf8( pattern.c_str() );
+    if ( !group.sequence->isSingleFile() ) {
+        pattern = group.sequence->generateUserFriendlySequencePatternFromValidPattern(pattern);
+    }
+    *userFriendlyFilename = QString::fromUtf8( pattern.c_str() );
+}
+
+void
+DirectoryContentGrouper::getMetadata(const Group& group,
+                                     QDateTime* dateModified,
+                                     quint64* size) const
+{
+    QFileInfo info( generateChildAbsoluteName(_directory.get(), group.firstFileName) );
+
+    *dateModified = info.lastModified();
+    *size = group.isDir ? 0 : (quint64)info.size() * group.filesCount;
+}
+
+void
+FileGathererThread::gatheringKernel(const FileSystemItemPtr& item)
+{
+    if (!item) {
+        return;
+    }
+    FileSystemModelPtr model = _imp->getModel();
+    if (!model) {
+        return;
+    }
+
+    const QString& path = item->absoluteFilePath();
+    QDir::Filters filters = model->filter();
+
+    // The size and date of each file are only fetched if needed to sort the entries, otherwise
+    // they are fetched by the items when displayed
+    FileSystemModel::Sections sortSection = (FileSystemModel::Sections)model->sortIndicatorSection();
+    DirectoryContentGrouper grouper( item, model, model->isSequenceModeEnabled(), (sortSection == FileSystemModel::Size) || (sortSection == FileSystemModel::DateModified) );
+
+    QDateTime lastModified = QFileInfo(path).lastModified();
+    DirectoryEntries entries;
+    if ( directoryListingCache->get(path, filters, lastModified, &entries) ) {
+        for (DirectoryEntries::const_iterator it = entries.begin(); it != entries.end(); ++it) {
+            ///If we must abort we do it now
+            if ( _imp->checkForAbort() ) {
+                return;
+            }
+            grouper.addEntry(it->first, it->second);
+        }
+    } else {
+        // Unlike QDir::entryInfoList, QDirIterator does not sort, hence does not need to stat the entries:
+        // whether an entry is a directory is known from the directory listing on most file-systems
+        TimeLapse timer;
+        double lastPublishTime = 0.;
+        QDirIterator it(path, filters);
+        while ( it.hasNext() ) {
+            ///If we must abort we do it now
+            if ( _imp->checkForAbort() ) {
+                return;
+            }
+            it.next();
+            entries.push_back( std::make_pair( it.fileName(), it.fileInfo().isDir() ) );
+            grouper.addEntry( entries.back().first, entries.back().second );
+
+            double time = timer.getTimeSinceCreation();
+            if (time - lastPublishTime > NATRON_FILE_GATHERER_PUBLISH_INTERVAL) {
+                publishContent( grouper.takeContent(false) );
+                lastPublishTime = time;
             }
+        }
+        directoryListingCache->insert(path, filters, lastModified, entries);
+    }
 
-            if (!foundMatchingSequence) {
-                SequenceParsing::SequenceFromFilesPtr newSequence = boost::make_shared<SequenceParsing::SequenceFromFiles>(fileContent, true);
-                sequences.push_back( std::make_pair(newSequence, all[i]) );
+    publishContent( grouper.takeContent(true) );
+
+    Q_EMIT directoryLoaded(path);
+} // FileGathererThread::gatheringKernel
+
+void
+FileGathererThread::publishContent(const boost::shared_ptr<FileGathererContent>& content)
+{
+    bool notify = false;
+    {
+        QMutexLocker k(&_imp->gatheredContentMutex);
+        if (!_imp->gatheredContent) {
+            _imp->gatheredContent = content;
+            notify = true;
+        } else {
+            // The model did not take the previous content yet
+            FileGathererContent& pending = *_imp->gatheredContent;
+            pending.newItems.insert( pending.newItems.end(), content->newItems.begin(), content->newItems.end() );
+            for (FileGathererContent::SequenceUpdates::const_iterator it = content->updates.begin(); it != content->updates.end(); ++it) {
+                pending.updates[it->first] = it->second;
             }
+            pending.isLastContent = content->isLastContent;
         }
-        KERNEL_INCR();
     }
+    if (notify) {
+        Q_EMIT contentGathered();
+    }
+}
+
+bool
+FileGathererThread::takeGatheredContent(FileGathererContent* content)
+{
+    QMutexLocker k(&_imp->gatheredContentMutex);
 
-    ///Now iterate through the sequences and create the children as necessary
-    for (FileSequences::iterator it = sequences.begin(); it != sequences.end(); ++it) {
-        item->addChild(it->first, it->second);
+    if (!_imp->gatheredContent) {
+        return false;
     }
+    *content = *_imp->gatheredContent;
+    _imp->gatheredContent.reset();
 
-    Q_EMIT directoryLoaded( item->absoluteFilePath() );
-} // FileGathererThread::gatheringKernel
+    return true;
+}
 
 void
 FileGathererThread::fetchDirectory(const FileSystemItemPtr& item)
 {
     abortGathering();
+    boost::shared_ptr<FileGathererContent> droppedContent;
+    {
+        // Drop what was gathered for the previous request
+        QMutexLocker k(&_imp->gatheredContentMutex);
+        droppedContent = _imp->gatheredContent;
+        _imp->gatheredContent.reset();
+    }
+    if (droppedContent) {
+        droppedContent->unregisterNewItems();
+    }
     {
         QMutexLocker l(&_imp->requestedDirMutex);
         _imp->requestedItem = item;
@@ -28,6 +28,7 @@
 #include "Global/Macros.h"
 
 #include <map>
+#include <vector>
 
 #if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
 #include <boost/shared_ptr.hpp>
@@ -83,6 +84,12 @@ public:
 
     void resetModelPointer();
 
+    /**
+     * @brief Removes the item from the registry of the model. Items created with createChild() are registered when
+     * created: this must be called for the items that are dropped instead of being added to the model.
+     **/
+    void unregisterFromModel();
+
     FileSystemItemPtr childAt(int position) const;
 
     int childCount() const;
@@ -109,6 +116,11 @@ public:
     const QString& fileName() const;
     const QString& getUserFriendlyFilename() const;
     const QString& fileExtension() const;
+
+    /**
+     * @brief The date and size of items created with createChild() are fetched from the file-system
+     * the first time they are requested, i.e: only for the rows that are displayed.
+     **/
     const QDateTime& getLastModified() const;
 
     quint64 getSize() const;
@@ -118,8 +130,42 @@ public:
      **/
     void addChild(const FileSystemItemPtr& child);
 
-    void addChild(const SequenceParsing::SequenceFromFilesPtr& sequence,
-                  const QFileInfo& info);
+    /**
+     * @brief Creates an item for a file, a sequence or a directory of this directory, but does not add it to the children.
+     * @param firstFileName The name of a file of the sequence, used to fetch the date and size of the item
+     * @param filesCount The number of files in the sequence
+     **/
+    FileSystemItemPtr createChild(bool isDir,
+                                  const QString& filename,
+                                  const QString& userFriendlySequenceName,
+                                  const SequenceParsing::SequenceFromFilesPtr& sequence,
+                                  const QString& firstFileName,
+                                  int filesCount);
+
+    /**
+     * @brief Updates the name of a sequence item when new files were found for the sequence.
+     * This must be called on the main-thread.
+     **/
+    void setSequence(const QString& filename,
+                     const QString& userFriendlySequenceName,
+                     const SequenceParsing::SequenceFromFilesPtr& sequence,
+                     int filesCount);
+
+    /**
+     * @brief Set the date and size of the item so that they are not fetched from the file-system
+     **/
+    void setMetadata(const QDateTime& dateModified, quint64 size);
+
+    /**
+     * @brief Add new children at the end, MT-safe
+     **/
+    void appendChildren(const std::vector<FileSystemItemPtr>& children);
+
+    /**
+     * @brief Sort the children in the order of the given section of the model, directories first.
+     * @param sortedChildrenCount The number of children at the start that are already sorted
+     **/
+    void sortChildren(int section, Qt::SortOrder order, int sortedChildrenCount);
 
     /**
      * @brief Remove all children, MT-safe
@@ -140,6 +186,7 @@ private:
 };
 
 class FileSystemModel;
+struct FileGathererContent;
 struct FileGathererThreadPrivate;
 class FileGathererThread
     : public QThread
@@ -161,8 +208,19 @@ public:
     void fetchDirectory(const FileSystemItemPtr& item);
 
     bool isWorking() const;
+
+    /**
+     * @brief Takes the content gathered since the last call, returns false if there is none.
+     **/
+    bool takeGatheredContent(FileGathererContent* content);
+
 Q_SIGNALS:
 
+    /**
+     * @brief Emitted while a directory is being gathered when new content can be taken with takeGatheredContent()
+     **/
+    void contentGathered();
+
     void directoryLoaded(QString);
 
 private:
@@ -171,6 +229,8 @@ private:
 
     void gatheringKernel(const FileSystemItemPtr& item);
 
+    void publishContent(const boost::shared_ptr<FileGathererContent>& content);
+
     boost::scoped_ptr<FileGathererThreadPrivate> _imp;
 };
 
@@ -330,6 +390,8 @@ public:
 
 public Q_SLOTS:
 
+    void onContentGatheredByGatherer();
+
     void onDirectoryLoadedByGatherer(const QString& directory);
 
     void onWatchedDirectoryChanged(const QString& directory);
@@ -0,0 +1,114 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "FrameParams.h"
+
+#include "Engine/Image.h"
+
+NATRON_NAMESPACE_ENTER
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+void
+registerWeakReference(const ImageWPtr& image)
+{
+    ImagePtr img = image.lock();
+
+    if (img) {
+        img->registerWeakReference();
+    }
+}
+
+void
+unregisterWeakReference(const ImageWPtr& image)
+{
+    ImagePtr img = image.lock();
+
+    if (img) {
+        img->unregisterWeakReference();
+    }
+}
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+FrameParams::FrameParams(const RectI & rod,
+                         int bitDepth,
+                         const RectI& bounds,
+                         const ImagePtr& originalImage)
+    : NonKeyParams()
+    , _image(originalImage)
+    , _rod(rod)
+{
+    CacheEntryStorageInfo& info = getStorageInfo();
+
+    info.mode = eStorageModeDisk;
+    info.numComponents = 4; // always RGBA
+    info.dataTypeSize = getSizeOfForBitDepth( (ImageBitDepthEnum)bitDepth );
+    info.bounds = bounds;
+    info.textureTarget = GL_TEXTURE_2D;
+
+    if (originalImage) {
+        originalImage->registerWeakReference();
+    }
+}
+
+FrameParams::FrameParams(const FrameParams & other)
+    : NonKeyParams(other)
+    , _image(other._image)
+    , _rod(other._rod)
+{
+    registerWeakReference(_image);
+}
+
+FrameParams::~FrameParams()
+{
+    // If the image is already destroyed there is nothing to unregister
+    unregisterWeakReference(_image);
+}
+
+FrameParams&
+FrameParams::operator=(const FrameParams & other)
+{
+    if (this != &other) {
+        NonKeyParams::operator=(other);
+        registerWeakReference(other._image);
+        unregisterWeakReference(_image);
+        _image = other._image;
+        _rod = other._rod;
+    }
+
+    return *this;
+}
+
+void
+FrameParams::setInternalImage(const ImagePtr& image)
+{
+    if (image) {
+        image->registerWeakReference();
+    }
+    unregisterWeakReference(_image);
+    _image = image;
+}
+
+NATRON_NAMESPACE_EXIT
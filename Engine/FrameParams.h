@@ -51,33 +51,16 @@ public:
     {
     }
 
-    FrameParams(const FrameParams & other)
-        : NonKeyParams(other)
-        , _image(other._image)
-        , _rod(other._rod)
-    {
-    }
-
     FrameParams(const RectI & rod,
                 int bitDepth,
                 const RectI& bounds,
-                const ImagePtr& originalImage)
-        : NonKeyParams()
-        , _image(originalImage)
-        , _rod(rod)
-    {
-        CacheEntryStorageInfo& info = getStorageInfo();
+                const ImagePtr& originalImage);
 
-        info.mode = eStorageModeDisk;
-        info.numComponents = 4; // always RGBA
-        info.dataTypeSize = getSizeOfForBitDepth( (ImageBitDepthEnum)bitDepth );
-        info.bounds = bounds;
-        info.textureTarget = GL_TEXTURE_2D;
-    }
+    FrameParams(const FrameParams & other);
 
-    virtual ~FrameParams()
-    {
-    }
+    virtual ~FrameParams();
+
+    FrameParams& operator=(const FrameParams & other);
 
     template<class Archive>
     void serialize(Archive & ar, const unsigned int version);
@@ -97,14 +80,11 @@ public:
         return _image.lock();
     }
 
-    void setInternalImage(const ImagePtr& image)
-    {
-        _image = image;
-    }
+    void setInternalImage(const ImagePtr& image);
 
 private:
 
-    // The image used to make this frame entry
+    // The image used to make this frame entry, registered as a weak reference to it (@see Image::registerWeakReference())
     ImageWPtr  _image;
 
     // The RoD of the image used to make this frame entry
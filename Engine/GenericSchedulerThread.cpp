@@ -36,6 +36,7 @@
 #include "Global/FloatingPointExceptions.h"
 #endif
 #include "Engine/GenericSchedulerThreadWatcher.h"
+#include "Engine/RenderAbortToken.h"
 
 #ifdef DEBUG
 //#define TRACE_GENERIC_SCHEDULER_THREAD
@@ -124,9 +125,16 @@ struct GenericSchedulerThreadPrivate
 
     void setThreadState(GenericSchedulerThread::ThreadStateEnum state)
     {
-        QMutexLocker k(&threadStateMutex);
+        {
+            QMutexLocker k(&threadStateMutex);
 
-        threadState = state;
+            if (threadState == state) {
+                return;
+            }
+            threadState = state;
+        }
+        // Renders of a viewer are aborted when its render engine starts working, see RenderAbortToken::isRenderAborted()
+        RenderAbortToken::notifyAbortStateChanged();
     }
 
     // Returns the state of the thread
@@ -354,6 +362,7 @@ GenericSchedulerThread::abortThreadedTask(bool keepOldestRender)
             ++_imp->abortRequested;
         }
     }
+    RenderAbortToken::notifyAbortStateChanged();
 
     onAbortRequested(keepOldestRender);
 
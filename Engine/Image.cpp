@@ -28,14 +28,18 @@
 #include <cassert>
 #include <cstring> // for std::memcpy, std::memset
 #include <stdexcept>
+#include <vector>
 
 #if !defined(SBK_RUN) && !defined(Q_MOC_RUN)
 GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_OFF
 #include <boost/math/special_functions/fpclassify.hpp>
 GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
+#include <boost/bind.hpp>
 #endif
 
 #include <QtCore/QDebug>
+#include <QtCore/QThreadPool>
+#include <QtConcurrentMap> // QtCore on Qt4, QtConcurrent on Qt5
 
 #include "Engine/AppManager.h"
 #include "Engine/ViewIdx.h"
@@ -49,6 +53,9 @@ NATRON_NAMESPACE_ENTER
 
 #define PIXEL_UNAVAILABLE 2
 
+// Minimum number of source pixels downscaled by each thread in buildMipMapLevel
+#define NATRON_IMAGE_DOWNSCALE_MIN_PIXELS_PER_THREAD 65536
+
 template <int trimap>
 RectI
 minimalNonMarkedBbox_internal(const RectI& roi,
@@ -685,6 +692,10 @@ Image::Image(const ImageKey & key,
              const CacheAPI* cache)
     : CacheEntryHelper<unsigned char, ImageKey, ImageParams>(key, params, cache)
     , _useBitmap(true)
+    , _halfStorageAllowed(false)
+    , _halfStorageMaxError(0.f)
+    , _weakReferencesCount(0)
+    , _halfData()
 {
     _bitDepth = params->getBitDepth();
     _depthBytesSize = getSizeOfForBitDepth(_bitDepth);
@@ -700,6 +711,10 @@ Image::Image(const ImageKey & key,
              const ImageParamsPtr& params)
     : CacheEntryHelper<unsigned char, ImageKey, ImageParams>( key, params, NULL )
     , _useBitmap(false)
+    , _halfStorageAllowed(false)
+    , _halfStorageMaxError(0.f)
+    , _weakReferencesCount(0)
+    , _halfData()
 {
     _bitDepth = params->getBitDepth();
     _depthBytesSize = getSizeOfForBitDepth(_bitDepth);
@@ -729,6 +744,10 @@ Image::Image(const ImagePlaneDesc& components,
              U32 textureTarget)
     : CacheEntryHelper<unsigned char, ImageKey, ImageParams>()
     , _useBitmap(useBitmap)
+    , _halfStorageAllowed(false)
+    , _halfStorageMaxError(0.f)
+    , _weakReferencesCount(0)
+    , _halfData()
 {
     setCacheEntry(makeKey(0, 0, false, 0, ViewIdx(0), false, false),
 #ifdef BOOST_NO_CXX11_VARIADIC_TEMPLATES
@@ -773,12 +792,21 @@ Image::Image(const ImagePlaneDesc& components,
 
 Image::~Image()
 {
+    releaseHalfStorage();
     deallocate();
 }
 
 void
 Image::onMemoryAllocated(bool diskRestoration)
 {
+    if (_halfData.size() > 0) {
+        // The image was compacted by the cache: restore it, the bitmap is still valid
+        assert(!diskRestoration);
+        expandHalfStorage();
+
+        return;
+    }
+
     if (_cache || _useBitmap) {
         _bitmap.initialize(_bounds);
     }
@@ -1807,263 +1835,6 @@ Image::getRowElements() const
     return getComponentsCount() * _bounds.width();
 }
 
-// code proofread and fixed by @devernay on 4/12/2014
-template <typename PIX, int maxValue>
-void
-Image::halveRoIForDepth(const RectI & roi,
-                        bool copyBitMap,
-                        Image* output) const
-{
-    assert( (getBitDepth() == eImageBitDepthByte && sizeof(PIX) == 1) ||
-            (getBitDepth() == eImageBitDepthShort && sizeof(PIX) == 2) ||
-            (getBitDepth() == eImageBitDepthFloat && sizeof(PIX) == 4) );
-
-    ///handle case where there is only 1 column/row
-    if ( (roi.width() == 1) || (roi.height() == 1) ) {
-        assert( !(roi.width() == 1 && roi.height() == 1) ); /// can't be 1x1
-        halve1DImage(roi, output);
-
-        return;
-    }
-
-    /// Take the lock for both bitmaps since we're about to read/write from them!
-    QWriteLocker k1(&output->_entryLock);
-    QReadLocker k2(&_entryLock);
-
-    ///The source rectangle, intersected to this image region of definition in pixels
-    const RectI &srcBounds = _bounds;
-    const RectI &dstBounds = output->_bounds;
-    const RectI &srcBmBounds = _bitmap.getBounds();
-    const RectI &dstBmBounds = output->_bitmap.getBounds();
-    assert( !copyBitMap || usesBitMap() );
-    assert( !usesBitMap() || (srcBmBounds == srcBounds && dstBmBounds == dstBounds) );
-
-    // the srcRoD of the output should be enclosed in half the roi.
-    // It does not have to be exactly half of the input.
-    //    assert(dstRoD.x1*2 >= roi.x1 &&
-    //           dstRoD.x2*2 <= roi.x2 &&
-    //           dstRoD.y1*2 >= roi.y1 &&
-    //           dstRoD.y2*2 <= roi.y2 &&
-    //           dstRoD.width()*2 <= roi.width() &&
-    //           dstRoD.height()*2 <= roi.height());
-    assert( getComponents() == output->getComponents() );
-
-    RectI dstRoI;
-    RectI srcRoI = roi;
-    srcRoI.intersect(srcBounds, &srcRoI); // intersect srcRoI with the region of definition
-
-    dstRoI.x1 = (srcRoI.x1 + 1) / 2; // equivalent to ceil(srcRoI.x1/2.0)
-    dstRoI.y1 = (srcRoI.y1 + 1) / 2; // equivalent to ceil(srcRoI.y1/2.0)
-    dstRoI.x2 = srcRoI.x2 / 2; // equivalent to floor(srcRoI.x2/2.0)
-    dstRoI.y2 = srcRoI.y2 / 2; // equivalent to floor(srcRoI.y2/2.0)
-
-
-    const PIX* const srcPixels      = (const PIX*)pixelAt(srcBounds.x1,   srcBounds.y1);
-    const char* const srcBmPixels   = _bitmap.getBitmapAt(srcBmBounds.x1, srcBmBounds.y1);
-    PIX* const dstPixels          = (PIX*)output->pixelAt(dstBounds.x1,   dstBounds.y1);
-    char* const dstBmPixels = output->_bitmap.getBitmapAt(dstBmBounds.x1, dstBmBounds.y1);
-    int srcRowSize = srcBounds.width() * _nbComponents;
-    int dstRowSize = dstBounds.width() * _nbComponents;
-
-    // offset pointers so that srcData and dstData correspond to pixel (0,0)
-    const PIX* const srcData = srcPixels - (srcBounds.x1 * _nbComponents + srcRowSize * srcBounds.y1);
-    PIX* const dstData       = dstPixels - (dstBounds.x1 * _nbComponents + dstRowSize * dstBounds.y1);
-    const int srcBmRowSize = srcBmBounds.width();
-    const int dstBmRowSize = dstBmBounds.width();
-    const char* const srcBmData = srcBmPixels - (srcBmBounds.x1 + srcBmRowSize * srcBmBounds.y1);
-    char* const dstBmData       = dstBmPixels - (dstBmBounds.x1 + dstBmRowSize * dstBmBounds.y1);
-
-    for (int y = dstRoI.y1; y < dstRoI.y2; ++y) {
-        const PIX* const srcLineStart    = srcData + y * 2 * srcRowSize;
-        PIX* const dstLineStart          = dstData + y     * dstRowSize;
-        const char* const srcBmLineStart = srcBmData + y * 2 * srcBmRowSize;
-        char* const dstBmLineStart       = dstBmData + y     * dstBmRowSize;
-
-        // The current dst row, at y, covers the src rows y*2 (thisRow) and y*2+1 (nextRow).
-        // Check that if are within srcBounds.
-        int srcy = y * 2;
-        bool pickThisRow = srcBounds.y1 <= (srcy + 0) && (srcy + 0) < srcBounds.y2;
-        bool pickNextRow = srcBounds.y1 <= (srcy + 1) && (srcy + 1) < srcBounds.y2;
-        int sumH = (int)pickNextRow + (int)pickThisRow;
-        assert(sumH == 1 || sumH == 2);
-
-        for (int x = dstRoI.x1; x < dstRoI.x2; ++x) {
-            const PIX* const srcPixStart    = srcLineStart   + x * 2 * _nbComponents;
-            const char* const srcBmPixStart = srcBmLineStart + x * 2;
-            PIX* const dstPixStart          = dstLineStart   + x * _nbComponents;
-            char* const dstBmPixStart       = dstBmLineStart + x;
-
-            // The current dst col, at y, covers the src cols x*2 (thisCol) and x*2+1 (nextCol).
-            // Check that if are within srcBounds.
-            int srcx = x * 2;
-            bool pickThisCol = srcBounds.x1 <= (srcx + 0) && (srcx + 0) < srcBounds.x2;
-            bool pickNextCol = srcBounds.x1 <= (srcx + 1) && (srcx + 1) < srcBounds.x2;
-            int sumW = (int)pickThisCol + (int)pickNextCol;
-            assert(sumW == 1 || sumW == 2);
-            const int sum = sumW * sumH;
-            assert(0 < sum && sum <= 4);
-
-            if (sum == 0) { // never happens
-                for (int k = 0; k < _nbComponents; ++k) {
-                    dstPixStart[k] = 0;
-                }
-                if (copyBitMap) {
-                    dstBmPixStart[0] = 0;
-                }
-                continue;
-            }
-
-            for (int k = 0; k < _nbComponents; ++k) {
-                ///a b
-                ///c d
-
-                const PIX a = (pickThisCol && pickThisRow) ? *(srcPixStart + k) : 0;
-                const PIX b = (pickNextCol && pickThisRow) ? *(srcPixStart + k + _nbComponents) : 0;
-                const PIX c = (pickThisCol && pickNextRow) ? *(srcPixStart + k + srcRowSize) : 0;
-                const PIX d = (pickNextCol && pickNextRow) ? *(srcPixStart + k + srcRowSize  + _nbComponents)  : 0;
-
-                assert( sumW == 2 || ( sumW == 1 && ( (a == 0 && c == 0) || (b == 0 && d == 0) ) ) );
-                assert( sumH == 2 || ( sumH == 1 && ( (a == 0 && b == 0) || (c == 0 && d == 0) ) ) );
-                dstPixStart[k] = (a + b + c + d) / sum;
-            }
-
-            if (copyBitMap) {
-                ///a b
-                ///c d
-
-                char a = (pickThisCol && pickThisRow) ? *(srcBmPixStart) : 0;
-                char b = (pickNextCol && pickThisRow) ? *(srcBmPixStart + 1) : 0;
-                char c = (pickThisCol && pickNextRow) ? *(srcBmPixStart + srcBmRowSize) : 0;
-                char d = (pickNextCol && pickNextRow) ? *(srcBmPixStart + srcBmRowSize  + 1)  : 0;
-#if NATRON_ENABLE_TRIMAP
-                /*
-                   The only correct solution is to convert pixels being rendered to 0 otherwise the caller
-                   would have to wait for the original fullscale image render to be finished and then re-downscale again.
-                 */
-                if (a == PIXEL_UNAVAILABLE) {
-                    a = 0;
-                }
-                if (b == PIXEL_UNAVAILABLE) {
-                    b = 0;
-                }
-                if (c == PIXEL_UNAVAILABLE) {
-                    c = 0;
-                }
-                if (d == PIXEL_UNAVAILABLE) {
-                    d = 0;
-                }
-#endif
-                assert( sumW == 2 || ( sumW == 1 && ( (a == 0 && c == 0) || (b == 0 && d == 0) ) ) );
-                assert( sumH == 2 || ( sumH == 1 && ( (a == 0 && b == 0) || (c == 0 && d == 0) ) ) );
-                assert(a + b + c + d <= sum); // bitmaps are 0 or 1
-                // the following is an integer division, the result can be 0 or 1
-                dstBmPixStart[0] = (a + b + c + d) / sum;
-                assert(dstBmPixStart[0] == 0 || dstBmPixStart[0] == 1);
-            }
-        }
-    }
-} // halveRoIForDepth
-
-// code proofread and fixed by @devernay on 8/8/2014
-void
-Image::halveRoI(const RectI & roi,
-                bool copyBitMap,
-                Image* output) const
-{
-    switch ( getBitDepth() ) {
-    case eImageBitDepthByte:
-        halveRoIForDepth<unsigned char, 255>(roi, copyBitMap,  output);
-        break;
-    case eImageBitDepthShort:
-        halveRoIForDepth<unsigned short, 65535>(roi, copyBitMap, output);
-        break;
-    case eImageBitDepthHalf:
-        assert(false);
-        break;
-    case eImageBitDepthFloat:
-        halveRoIForDepth<float, 1>(roi, copyBitMap, output);
-        break;
-    case eImageBitDepthNone:
-        break;
-    }
-}
-
-// code proofread and fixed by @devernay on 8/8/2014
-template <typename PIX, int maxValue>
-void
-Image::halve1DImageForDepth(const RectI & roi,
-                            Image* output) const
-{
-    int width = roi.width();
-    int height = roi.height();
-
-    assert(width == 1 || height == 1); /// must be 1D
-    assert( output->getComponents() == getComponents() );
-
-    /// Take the lock for both bitmaps since we're about to read/write from them!
-    QWriteLocker k1(&output->_entryLock);
-    QReadLocker k2(&_entryLock);
-    const RectI & srcBounds = _bounds;
-    const RectI & dstBounds = output->_bounds;
-//    assert(dstBounds.x1 * 2 == roi.x1 &&
-//           dstBounds.y1 * 2 == roi.y1 &&
-//           (
-//               dstBounds.x2 * 2 == roi.x2 || // we halve in only 1 dimension
-//               dstBounds.y2 * 2 == roi.y2)
-//           );
-    int halfWidth = width / 2;
-    int halfHeight = height / 2;
-    if (height == 1) { //1 row
-        assert(width != 1); /// widthxheight can't be 1x1
-
-        const PIX* src = (const PIX*)pixelAt(roi.x1, roi.y1);
-        PIX* dst = (PIX*)output->pixelAt(dstBounds.x1, dstBounds.y1);
-        assert(src && dst);
-        for (int x = 0; x < halfWidth; ++x) {
-            for (int k = 0; k < _nbComponents; ++k) {
-                *dst++ = PIX( (float)( *src + *(src + _nbComponents) ) / 2. );
-                ++src;
-            }
-            src += _nbComponents;
-        }
-    } else if (width == 1) {
-        int rowSize = srcBounds.width() * _nbComponents;
-        const PIX* src = (const PIX*)pixelAt(roi.x1, roi.y1);
-        PIX* dst = (PIX*)output->pixelAt(dstBounds.x1, dstBounds.y1);
-        assert(src && dst);
-        for (int y = 0; y < halfHeight; ++y) {
-            for (int k = 0; k < _nbComponents; ++k) {
-                *dst++ = PIX( (float)( *src + (*src + rowSize) ) / 2. );
-                ++src;
-            }
-            src += rowSize;
-        }
-    }
-}
-
-// code proofread and fixed by @devernay on 8/8/2014
-void
-Image::halve1DImage(const RectI & roi,
-                    Image* output) const
-{
-    switch ( getBitDepth() ) {
-    case eImageBitDepthByte:
-        halve1DImageForDepth<unsigned char, 255>(roi, output);
-        break;
-    case eImageBitDepthShort:
-        halve1DImageForDepth<unsigned short, 65535>(roi, output);
-        break;
-    case eImageBitDepthHalf:
-        assert(false);
-        break;
-    case eImageBitDepthFloat:
-        halve1DImageForDepth<float, 1>(roi, output);
-        break;
-    case eImageBitDepthNone:
-        break;
-    }
-}
-
 // code proofread and fixed by @devernay on 8/8/2014
 void
 Image::downscaleMipMap(const RectD& dstRod,
@@ -2080,28 +1851,12 @@ Image::downscaleMipMap(const RectD& dstRod,
 
     assert(_bounds.x1 <= roi.x1 && roi.x2 <= _bounds.x2 &&
            _bounds.y1 <= roi.y1 && roi.y2 <= _bounds.y2);
-    double par = getPixelAspectRatio();
-//    RectD roiCanonical;
-//    roi.toCanonical(fromLevel, par , dstRod, &roiCanonical);
-//    RectI dstRoI;
-//    roiCanonical.toPixelEnclosing(toLevel, par , &dstRoI);
     unsigned int downscaleLvls = toLevel - fromLevel;
 
     assert( !copyBitMap || _bitmap.getBitmap() );
 
-    RectI dstRoI  = roi.downscalePowerOfTwoSmallestEnclosing(downscaleLvls);
-    ImagePtr tmpImg = boost::make_shared<Image>( getComponents(), dstRod, dstRoI, toLevel, par, getBitDepth(), getPremultiplication(), getFieldingOrder(), true);
-
-    buildMipMapLevel( dstRod, roi, downscaleLvls, copyBitMap, tmpImg.get() );
-
-    // check that the downscaled mipmap is inside the output image (it may not be equal to it)
-    assert(dstRoI.x1 >= output->_bounds.x1);
-    assert(dstRoI.x2 <= output->_bounds.x2);
-    assert(dstRoI.y1 >= output->_bounds.y1);
-    assert(dstRoI.y2 <= output->_bounds.y2);
-
-    ///Now copy the result of tmpImg into the output image
-    output->pasteFrom(*tmpImg, dstRoI, copyBitMap);
+    // The downscaled pixels are written directly in the output image
+    buildMipMapLevel( dstRod, roi, downscaleLvls, copyBitMap, output );
 }
 
 bool
@@ -2242,9 +1997,127 @@ Image::upscaleMipMap(const RectI & roi,
     }
 }
 
-// code proofread and fixed by @devernay on 8/8/2014
+template <typename PIX>
+void
+Image::downscaleMipMapRowsForDepth(const RectI & roi,
+                                   unsigned int level,
+                                   bool copyBitMap,
+                                   Image* output,
+                                   const RectI & dstRows) const
+{
+    assert( (getBitDepth() == eImageBitDepthByte && sizeof(PIX) == 1) ||
+            (getBitDepth() == eImageBitDepthShort && sizeof(PIX) == 2) ||
+            (getBitDepth() == eImageBitDepthFloat && sizeof(PIX) == 4) );
+
+    const int scale = 1 << level;
+    RectI srcRoI;
+    if ( !roi.intersect(_bounds, &srcRoI) ) {
+        return;
+    }
+    const int srcWidth = srcRoI.width();
+    const int srcRowElements = srcWidth * _nbComponents;
+
+    // For each column of srcRoI, the sum of the source rows covered by the current destination row.
+    // Summing whole rows is a plain loop over contiguous memory that the compiler vectorizes.
+    std::vector<double> colSums(srcRowElements);
+    std::vector<int> colBmSums(copyBitMap ? srcWidth : 0);
+
+    for (int y = dstRows.y1; y < dstRows.y2; ++y) {
+        // The source rows covered by this row, cropped to srcRoI: they may be less than scale on the borders
+        const int srcY1 = std::max(y * scale, srcRoI.y1);
+        const int srcY2 = std::min( (y + 1) * scale, srcRoI.y2 );
+        PIX* dstPix = (PIX*)output->pixelAt(dstRows.x1, y);
+        char* dstBm = copyBitMap ? output->_bitmap.getBitmapAt(dstRows.x1, y) : 0;
+        assert(dstPix);
+        assert(!copyBitMap || dstBm);
+        if (srcY1 >= srcY2) {
+            std::fill(dstPix, dstPix + dstRows.width() * _nbComponents, PIX(0));
+            if (copyBitMap) {
+                std::fill(dstBm, dstBm + dstRows.width(), 0);
+            }
+            continue;
+        }
+
+        std::fill(colSums.begin(), colSums.end(), 0.);
+        std::fill(colBmSums.begin(), colBmSums.end(), 0);
+        double* const sums = &colSums.front();
+        for (int srcY = srcY1; srcY < srcY2; ++srcY) {
+            const PIX* const srcPix = (const PIX*)pixelAt(srcRoI.x1, srcY);
+            assert(srcPix);
+            for (int i = 0; i < srcRowElements; ++i) {
+                sums[i] += srcPix[i];
+            }
+            if (copyBitMap) {
+                const char* const srcBm = _bitmap.getBitmapAt(srcRoI.x1, srcY);
+                assert(srcBm);
+                // Pixels being rendered (PIXEL_UNAVAILABLE with the trimap) are not rendered in the downscaled image
+                for (int i = 0; i < srcWidth; ++i) {
+                    colBmSums[i] += (int)(srcBm[i] == 1);
+                }
+            }
+        }
+
+        const int rowsCount = srcY2 - srcY1;
+        for (int x = dstRows.x1; x < dstRows.x2; ++x, dstPix += _nbComponents) {
+            const int srcX1 = std::max(x * scale, srcRoI.x1);
+            const int srcX2 = std::min( (x + 1) * scale, srcRoI.x2 );
+            const int count = (srcX2 - srcX1) * rowsCount;
+            if (count <= 0) {
+                for (int k = 0; k < _nbComponents; ++k) {
+                    dstPix[k] = PIX(0);
+                }
+                if (copyBitMap) {
+                    dstBm[x - dstRows.x1] = 0;
+                }
+                continue;
+            }
+            const double* const pixSums = sums + (srcX1 - srcRoI.x1) * _nbComponents;
+            for (int k = 0; k < _nbComponents; ++k) {
+                double sum = 0.;
+                for (int i = 0; i < (srcX2 - srcX1); ++i) {
+                    sum += pixSums[i * _nbComponents + k];
+                }
+                dstPix[k] = PIX(sum / count);
+            }
+            if (copyBitMap) {
+                int bmSum = 0;
+                for (int sx = srcX1; sx < srcX2; ++sx) {
+                    bmSum += colBmSums[sx - srcRoI.x1];
+                }
+                // rendered only if all the source pixels are rendered
+                dstBm[x - dstRows.x1] = (bmSum == count) ? 1 : 0;
+            }
+        }
+    }
+} // downscaleMipMapRowsForDepth
+
 void
-Image::buildMipMapLevel(const RectD& dstRoD,
+Image::downscaleMipMapRows(const RectI & roi,
+                           unsigned int level,
+                           bool copyBitMap,
+                           Image* output,
+                           const RectI & dstRows) const
+{
+    switch ( getBitDepth() ) {
+    case eImageBitDepthByte:
+        downscaleMipMapRowsForDepth<unsigned char>(roi, level, copyBitMap, output, dstRows);
+        break;
+    case eImageBitDepthShort:
+        downscaleMipMapRowsForDepth<unsigned short>(roi, level, copyBitMap, output, dstRows);
+        break;
+    case eImageBitDepthHalf:
+        assert(false);
+        break;
+    case eImageBitDepthFloat:
+        downscaleMipMapRowsForDepth<float>(roi, level, copyBitMap, output, dstRows);
+        break;
+    case eImageBitDepthNone:
+        break;
+    }
+}
+
+void
+Image::buildMipMapLevel(const RectD& /*dstRoD*/,
                         const RectI & roi,
                         unsigned int level,
                         bool copyBitMap,
@@ -2257,6 +2130,7 @@ Image::buildMipMapLevel(const RectD& dstRoD,
     assert( output->getBounds().contains(lastLevelRoI) );
 
     assert( output->getComponents() == getComponents() );
+    assert( output->getBitDepth() == getBitDepth() );
 
     if (level == 0) {
         ///Just copy the roi and return
@@ -2265,43 +2139,45 @@ Image::buildMipMapLevel(const RectD& dstRoD,
         return;
     }
 
-    const Image* srcImg = this;
-    Image* dstImg = NULL;
-    bool mustFreeSrc = false;
-    RectI previousRoI = roi;
-    ///Build all the mipmap levels until we reach the one we are interested in
-    for (unsigned int i = 1; i <= level; ++i) {
-        ///Halve the smallest enclosing po2 rect as we need to render a minimum of the renderWindow
-        RectI halvedRoI = previousRoI.downscalePowerOfTwoSmallestEnclosing(1);
+    if ( (_nbComponents == 0) || lastLevelRoI.isNull() ) {
+        return;
+    }
 
-        ///Allocate an image with half the size of the source image
-        dstImg = new Image( getComponents(), dstRoD, halvedRoI, getMipMapLevel() + i, getPixelAspectRatio(), getBitDepth(), getPremultiplication(), getFieldingOrder(), true);
+    /*
+     * Each pixel of the last level is the average of the (up to) 2^level x 2^level pixels it covers in roi,
+     * which is computed in a single pass straight into output, instead of halving the image level by level.
+     * The rows of the output are split in bands processed in parallel.
+     */
 
-        ///Half the source image into dstImg.
-        ///We pass the closestPo2 roi which might not be the entire size of the source image
-        ///If the source image'sroi was originally a po2.
-        srcImg->halveRoI(previousRoI, copyBitMap, dstImg);
+    /// Take the lock for both bitmaps since we're about to read/write from them!
+    QWriteLocker k1(&output->_entryLock);
+    QReadLocker k2(&_entryLock);
 
-        ///Clean-up, we should use shared_ptrs for safety
-        if (mustFreeSrc) {
-            delete srcImg;
-        }
+    assert( !copyBitMap || ( usesBitMap() && output->usesBitMap() ) );
 
-        ///Switch for next pass
-        previousRoI = halvedRoI;
-        srcImg = dstImg;
-        mustFreeSrc = true;
+    int nBands = 1;
+    if (appPTR) {
+        U64 maxBandsForSize = roi.area() / NATRON_IMAGE_DOWNSCALE_MIN_PIXELS_PER_THREAD;
+        nBands = std::min( appPTR->getMaxThreadCount(), lastLevelRoI.height() );
+        nBands = (int)std::min( (U64)nBands, maxBandsForSize );
     }
+    bool runInCurrentThread = nBands <= 1 || QThreadPool::globalInstance()->activeThreadCount() >= QThreadPool::globalInstance()->maxThreadCount();
 
-    assert(srcImg->getBounds() == lastLevelRoI);
+    if (runInCurrentThread) {
+        downscaleMipMapRows(roi, level, copyBitMap, output, lastLevelRoI);
 
-    ///Finally copy the last mipmap level into output.
-    output->pasteFrom( *srcImg, srcImg->getBounds(), copyBitMap);
+        return;
+    }
 
-    ///Clean-up, we should use shared_ptrs for safety
-    if (mustFreeSrc) {
-        delete srcImg;
+    std::vector<RectI> bands(nBands);
+    const int bandHeight = lastLevelRoI.height() / nBands;
+    for (int i = 0; i < nBands; ++i) {
+        bands[i].x1 = lastLevelRoI.x1;
+        bands[i].x2 = lastLevelRoI.x2;
+        bands[i].y1 = lastLevelRoI.y1 + i * bandHeight;
+        bands[i].y2 = (i == nBands - 1) ? lastLevelRoI.y2 : bands[i].y1 + bandHeight;
     }
+    QtConcurrent::map( bands, boost::bind(&Image::downscaleMipMapRows, this, roi, level, copyBitMap, output, _1) ).waitForFinished();
 } // buildMipMapLevel
 
 double
@@ -212,6 +212,34 @@ public:
     }
 
     virtual void onMemoryAllocated(bool diskRestoration) OVERRIDE FINAL;
+
+    /**
+     * @brief Stores a float image of the color plane as half floats if it was allowed by setHalfStorageAllowed().
+     * Refused if the conversion changes a value by more than the maximum error given to setHalfStorageAllowed(), or
+     * if a value is out of the half float range.
+     * Also refused while the image has registered weak references (@see registerWeakReference()).
+     * The image is expanded back to floats by allocateMemory().
+     **/
+    virtual bool compactMemory() OVERRIDE FINAL;
+
+    /**
+     * @brief Registers a weak pointer to this image whose owner may lock it and read the pixels without calling
+     * allocateMemory(), such as the one of the viewer cache entries (@see FrameParams). The cache does not see these
+     * weak pointers, so the image is not compacted while any is registered.
+     **/
+    void registerWeakReference();
+
+    void unregisterWeakReference();
+
+    /**
+     * @brief Whether the cache may store this image as half floats when it is full, if no value changes by more than
+     * maxError. The error is absolute, in units of the nominal [0,1] range of a color channel: a half float keeps 11
+     * significant bits, so the values in [2^n, 2^(n+1)) change by up to 2^(n-11).
+     **/
+    void setHalfStorageAllowed(bool allowed, double maxError);
+
+    bool isStoredAsHalf() const;
+
     static ImageKey makeKey(const CacheEntryHolder* holder,
                             U64 nodeHashKey,
                             bool frameVaryingOrAnimated,
@@ -303,6 +331,7 @@ public:
         bool got = _entryLock.tryLockForRead();
 
         dt += _bitmap.getBounds().area();
+        dt += _halfData.size() * sizeof(unsigned short);
         if (got) {
             _entryLock.unlock();
         }
@@ -545,60 +574,48 @@ private:
         _entryLock.unlock();
     }
 
-    template <typename SRCPIX, typename DSTPIX, int srcMaxValue, int dstMaxValue>
-    static void convertToFormatInternal_sameComps(const RectI & renderWindow,
-                                                  const Image & srcImg,
-                                                  Image & dstImg,
-                                                  ViewerColorSpaceEnum srcColorSpace,
-                                                  ViewerColorSpaceEnum dstColorSpace,
-                                                  bool copyBitmap);
-
-    template <typename SRCPIX, typename DSTPIX, int srcMaxValue, int dstMaxValue, int srcNComps, int dstNComps>
-    static void convertToFormatInternal(const RectI & renderWindow,
-                                        const Image & srcImg,
-                                        Image & dstImg,
+    /**
+     * @brief Converts the given rows of this image into dstImg. convertToFormatCommon splits the render window
+     * in bands of rows converted in parallel with this function.
+     **/
+    void convertToFormatRows(const RectI & rows,
+                             ViewerColorSpaceEnum srcColorSpace,
+                             ViewerColorSpaceEnum dstColorSpace,
+                             int channelForAlpha,
+                             bool useAlpha0,
+                             bool copyBitmap,
+                             bool requiresUnpremult,
+                             Image* dstImg) const;
+
+    template <typename SRCPIX, typename DSTPIX>
+    void convertToFormatRowsForDepth(const RectI & rows,
+                                     ViewerColorSpaceEnum srcColorSpace,
+                                     ViewerColorSpaceEnum dstColorSpace,
+                                     int channelForAlpha,
+                                     bool useAlpha0,
+                                     bool copyBitmap,
+                                     bool requiresUnpremult,
+                                     Image* dstImg) const;
+
+    template <typename SRCPIX, typename DSTPIX, int srcNComps>
+    void convertToFormatRowsForSrcComps(const RectI & rows,
                                         ViewerColorSpaceEnum srcColorSpace,
                                         ViewerColorSpaceEnum dstColorSpace,
                                         int channelForAlpha,
                                         bool useAlpha0,
                                         bool copyBitmap,
-                                        bool requiresUnpremult);
-
-
-    template <typename SRCPIX, typename DSTPIX, int srcMaxValue, int dstMaxValue, int srcNComps, int dstNComps,
-              bool requiresUnpremult>
-    static void convertToFormatInternalForUnpremult(const RectI & renderWindow,
-                                                    const Image & srcImg,
-                                                    Image & dstImg,
-                                                    ViewerColorSpaceEnum srcColorSpace,
-                                                    ViewerColorSpaceEnum dstColorSpace,
-                                                    bool useAlpha0,
-                                                    bool copyBitmap,
-                                                    int channelForAlpha);
-
-
-    template <typename SRCPIX, typename DSTPIX, int srcMaxValue, int dstMaxValue, int srcNComps, int dstNComps,
-              bool requiresUnpremult, bool useColorspaces>
-    static void convertToFormatInternalForColorSpace(const RectI & renderWindow,
-                                                     const Image & srcImg,
-                                                     Image & dstImg,
-                                                     bool copyBitmap,
-                                                     bool useAlpha0,
-                                                     ViewerColorSpaceEnum srcColorSpace,
-                                                     ViewerColorSpaceEnum dstColorSpace,
-                                                     int channelForAlpha);
-
-
-    template <typename SRCPIX, typename DSTPIX, int srcMaxValue, int dstMaxValue>
-    static void convertToFormatInternalForDepth(const RectI & renderWindow,
-                                                const Image & srcImg,
-                                                Image & dstImg,
-                                                ViewerColorSpaceEnum srcColorSpace,
-                                                ViewerColorSpaceEnum dstColorSpace,
-                                                int channelForAlpha,
-                                                bool useAlpha0,
-                                                bool copyBitmap,
-                                                bool requiresUnpremult);
+                                        bool requiresUnpremult,
+                                        Image* dstImg) const;
+
+    template <typename SRCPIX, typename DSTPIX, int srcNComps, int dstNComps>
+    void convertToFormatRowsForComps(const RectI & rows,
+                                     ViewerColorSpaceEnum srcColorSpace,
+                                     ViewerColorSpaceEnum dstColorSpace,
+                                     int channelForAlpha,
+                                     bool useAlpha0,
+                                     bool copyBitmap,
+                                     bool requiresUnpremult,
+                                     Image* dstImg) const;
 
 public:
 
@@ -830,6 +847,10 @@ private:
                                bool requiresUnpremult,
                                Image* dstImg) const;
 
+    void expandHalfStorage();
+
+    void releaseHalfStorage();
+
     template <typename PIX, bool doPremult>
     void premultInternal(const RectI& roi);
     template <bool doPremult>
@@ -874,6 +895,54 @@ public:
                        float mix,
                        const OSGLContextPtr& glContext = OSGLContextPtr() );
 
+    /**
+     * @brief The post-processing steps applied to a rendered image by applyPostRenderSteps, in this order:
+     * copyUnProcessedChannels, applyMaskMix, then premultImage or unpremultImage.
+     * originalImage is the source of the unprocessed channels and the image mixed with.
+     **/
+    struct PostRenderSteps
+    {
+        bool copyUnProcessedChannels;
+        std::bitset<4> processChannels;
+        ImagePremultiplicationEnum outputPremult;
+        ImagePremultiplicationEnum originalImagePremult;
+        bool ignorePremult;
+        ImagePtr originalImage;
+        bool maskMix;
+        const Image* maskImg;
+        bool masked;
+        bool maskInvert;
+        float mix;
+        bool premult;
+        bool unpremult;
+
+        PostRenderSteps()
+            : copyUnProcessedChannels(false)
+            , processChannels()
+            , outputPremult(eImagePremultiplicationPremultiplied)
+            , originalImagePremult(eImagePremultiplicationPremultiplied)
+            , ignorePremult(false)
+            , originalImage()
+            , maskMix(false)
+            , maskImg(0)
+            , masked(false)
+            , maskInvert(false)
+            , mix(1.f)
+            , premult(false)
+            , unpremult(false)
+        {
+        }
+    };
+
+    /**
+     * @brief Applies the given post-processing steps on the roi. When more than one step has an effect,
+     * they are fused in a single pass over the image instead of one pass per step, with the same results.
+     * OpenGL textures go through the separate functions.
+     **/
+    void applyPostRenderSteps( const RectI& roi,
+                               const PostRenderSteps& steps,
+                               const OSGLContextPtr& glContext = OSGLContextPtr() );
+
     /**
      * @brief Eeturns true if image contains NaNs or infinite values, and fix them.
      * Currently, no OpenGL implementation is provided.
@@ -979,36 +1048,33 @@ private:
                                          bool originalPremult,
                                          bool ignorePremult);
 
+    template <typename PIX, int maxValue, int srcNComps, int dstNComps>
+    void applyPostRenderStepsForComponents(const RectI& roi, const PostRenderSteps& steps);
+
+    template <typename PIX, int maxValue, int srcNComps>
+    void applyPostRenderStepsForSrcComponents(const RectI& roi, const PostRenderSteps& steps);
+
+    template <typename PIX, int maxValue>
+    void applyPostRenderStepsForDepth(const RectI& roi, const PostRenderSteps& steps);
+
 
     /**
      * @brief Given the output buffer,the region of interest and the mip map level, this
      * function computes the mip map of this image in the given roi.
      * If roi is NOT a power of 2, then it will be rounded to the closest power of 2.
+     * The mip map is computed in a single pass, without intermediate levels.
      **/
     void buildMipMapLevel(const RectD& dstRoD, const RectI & roiCanonical, unsigned int level, bool copyBitMap,
                           Image* output) const;
 
-
-    /**
-     * @brief Halve the given roi of this image into output.
-     * If the RoI bounds are odd, the largest enclosing RoI with even bounds will be considered.
-     **/
-    void halveRoI(const RectI & roi, bool copyBitMap,
-                  Image* output) const;
-
-
-    template <typename PIX, int maxValue>
-    void halveRoIForDepth(const RectI & roi,
-                          bool copyBitMap,
-                          Image* output) const;
-
     /**
-     * @brief Same as halveRoI but for 1D only (either width == 1 or height == 1)
+     * @brief Computes the rows dstRows of the mip map of the given level of roi into output.
+     * Each output pixel is the average of the pixels of roi it covers.
      **/
-    void halve1DImage(const RectI & roi, Image* output) const;
+    void downscaleMipMapRows(const RectI & roi, unsigned int level, bool copyBitMap, Image* output, const RectI & dstRows) const;
 
-    template <typename PIX, int maxValue>
-    void halve1DImageForDepth(const RectI & roi, Image* output) const;
+    template <typename PIX>
+    void downscaleMipMapRowsForDepth(const RectI & roi, unsigned int level, bool copyBitMap, Image* output, const RectI & dstRows) const;
 
     template <typename PIX, int maxValue>
     void upscaleMipMapForDepth(const RectI & roi, unsigned int fromLevel, unsigned int toLevel, Image* output) const;
@@ -1036,6 +1102,10 @@ private:
     ImagePremultiplicationEnum _premult;
     bool _useBitmap;
     int _nbComponents;
+    bool _halfStorageAllowed;
+    float _halfStorageMaxError;
+    int _weakReferencesCount; // @see registerWeakReference()
+    RamBuffer<unsigned short> _halfData; // the pixels while the image is stored as half floats, @see compactMemory()
 };
 
 //template <> inline unsigned char clamp(unsigned char v) { return v; }
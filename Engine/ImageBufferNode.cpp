@@ -0,0 +1,208 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "ImageBufferNode.h"
+
+#include <cassert>
+
+#include <QtCore/QMutex>
+
+#include "Engine/AppInstance.h"
+#include "Engine/Image.h"
+#include "Engine/Node.h"
+#include "Engine/NodeMetadata.h"
+
+NATRON_NAMESPACE_ENTER
+
+struct ImageBufferNodePrivate
+{
+    // Protects buffer
+    mutable QMutex bufferMutex;
+
+    // The output of the node, at full resolution. It is never modified once set.
+    ImagePtr buffer;
+
+    ImageBufferNodePrivate()
+        : bufferMutex()
+        , buffer()
+    {
+    }
+};
+
+ImageBufferNode::ImageBufferNode(NodePtr node)
+    : EffectInstance(node)
+    , _imp( new ImageBufferNodePrivate() )
+{
+    // The buffer only exists at full resolution: let the render pipeline compute the other mipmap levels
+    setSupportsRenderScaleMaybe(eSupportsNo);
+
+    // The buffer may be set from a thread that is not the main thread, but the hash may only be computed on the main thread
+    QObject::connect( this, SIGNAL(bufferChanged()), this, SLOT(onBufferChanged()) );
+}
+
+ImageBufferNode::~ImageBufferNode()
+{
+}
+
+void
+ImageBufferNode::getPluginGrouping(std::list<std::string>* grouping) const
+{
+    grouping->push_back(PLUGIN_GROUP_IMAGE);
+}
+
+void
+ImageBufferNode::addAcceptedComponents(int /*inputNb*/,
+                                       std::list<ImagePlaneDesc>* comps)
+{
+    comps->push_back( ImagePlaneDesc::getRGBAComponents() );
+    comps->push_back( ImagePlaneDesc::getRGBComponents() );
+    comps->push_back( ImagePlaneDesc::getAlphaComponents() );
+}
+
+void
+ImageBufferNode::addSupportedBitDepth(std::list<ImageBitDepthEnum>* depths) const
+{
+    depths->push_back(eImageBitDepthFloat);
+}
+
+ImagePtr
+ImageBufferNode::createBuffer(const ImagePlaneDesc& plane,
+                              const RectI& bounds) const
+{
+    int nComps = plane.getNumComponents();
+
+    if ( !plane.isColorPlane() || ( (nComps != 1) && (nComps != 3) && (nComps != 4) ) || bounds.isNull() ) {
+        return ImagePtr();
+    }
+
+    double par = getAspectRatio(-1);
+    RectD rod;
+    bounds.toCanonical_noClipping(0, par, &rod);
+    ImagePremultiplicationEnum premult = (nComps == 3) ? eImagePremultiplicationOpaque : eImagePremultiplicationPremultiplied;
+    ImagePtr ret( new Image(plane, rod, bounds, 0, par, eImageBitDepthFloat, premult, eImageFieldingOrderNone) );
+    ret->fillBoundsZero();
+
+    ImagePtr current = getBuffer();
+    if ( current && ( current->getComponentsCount() == ret->getComponentsCount() ) ) {
+        ret->pasteFrom(*current, bounds, false);
+    }
+
+    return ret;
+}
+
+void
+ImageBufferNode::setBuffer(const ImagePtr& buffer)
+{
+    {
+        QMutexLocker k(&_imp->bufferMutex);
+        _imp->buffer = buffer;
+    }
+    Q_EMIT bufferChanged();
+}
+
+ImagePtr
+ImageBufferNode::getBuffer() const
+{
+    QMutexLocker k(&_imp->bufferMutex);
+
+    return _imp->buffer;
+}
+
+void
+ImageBufferNode::onBufferChanged()
+{
+    NodePtr node = getNode();
+
+    if ( !node || !node->isNodeCreated() ) {
+        return;
+    }
+
+    // The buffer is part of the hash through the age of the node: every image rendered from the previous
+    // buffer, by this node or downstream, no longer matches its cache key.
+    node->incrementKnobsAge();
+    evaluate(true, true);
+}
+
+StatusEnum
+ImageBufferNode::getPreferredMetadata(NodeMetadata& metadata)
+{
+    ImagePtr buffer = getBuffer();
+
+    if (buffer) {
+        metadata.setNComps( -1, (int)buffer->getComponentsCount() );
+        metadata.setComponentsType(-1, kNatronColorPlaneID);
+        metadata.setOutputPremult( buffer->getPremultiplication() );
+    }
+    metadata.setIsFrameVarying(false);
+
+    return eStatusOK;
+}
+
+StatusEnum
+ImageBufferNode::getRegionOfDefinition(U64 /*hash*/,
+                                       double /*time*/,
+                                       const RenderScale & /*scale*/,
+                                       ViewIdx /*view*/,
+                                       RectD* rod)
+{
+    ImagePtr buffer = getBuffer();
+
+    if (buffer) {
+        *rod = buffer->getRoD();
+    } else {
+        rod->clear();
+    }
+
+    return eStatusOK;
+}
+
+StatusEnum
+ImageBufferNode::render(const RenderActionArgs& args)
+{
+    ImagePtr buffer = getBuffer();
+
+    for (std::list<std::pair<ImagePlaneDesc, ImagePtr> >::const_iterator it = args.outputPlanes.begin(); it != args.outputPlanes.end(); ++it) {
+        const ImagePtr& output = it->second;
+        assert(output->getMipMapLevel() == 0);
+
+        output->fillZero(args.roi);
+        RectI roi;
+        if ( !buffer || !args.roi.intersect(buffer->getBounds(), &roi) ) {
+            continue;
+        }
+        if ( ( buffer->getComponents() != output->getComponents() ) || ( buffer->getBitDepth() != output->getBitDepth() ) ) {
+            buffer->convertToFormat( roi, getApp()->getDefaultColorSpaceForBitDepth( buffer->getBitDepth() ),
+                                     getApp()->getDefaultColorSpaceForBitDepth( output->getBitDepth() ), 3, false, false, output.get() );
+        } else {
+            output->pasteFrom(*buffer, roi, false);
+        }
+    }
+
+    return eStatusOK;
+}
+
+NATRON_NAMESPACE_EXIT
+NATRON_NAMESPACE_USING
+
+#include "moc_ImageBufferNode.cpp"
@@ -0,0 +1,172 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef Engine_ImageBufferNode_h
+#define Engine_ImageBufferNode_h
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include "Engine/EffectInstance.h"
+
+NATRON_NAMESPACE_ENTER
+
+struct ImageBufferNodePrivate;
+
+/**
+ * @brief A generator whose output is a buffer of pixels owned by the node, filled from Python
+ * (see Effect::createImageBuffer). The buffer is at full resolution: the other mipmap levels are
+ * computed by the render pipeline like for any other image.
+ * Each new buffer increments the age of the node, so that its hash changes and everything that was
+ * rendered downstream from the previous pixels is invalidated through the cache keys.
+ * The buffer is not saved with the project.
+ **/
+class ImageBufferNode
+    : public EffectInstance
+{
+GCC_DIAG_SUGGEST_OVERRIDE_OFF
+    Q_OBJECT
+GCC_DIAG_SUGGEST_OVERRIDE_ON
+
+public:
+
+    static EffectInstance* BuildEffect(NodePtr n)
+    {
+        return new ImageBufferNode(n);
+    }
+
+    ImageBufferNode(NodePtr node);
+
+    virtual ~ImageBufferNode();
+
+    virtual int getMajorVersion() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return 1;
+    }
+
+    virtual int getMinorVersion() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return 0;
+    }
+
+    virtual int getNInputs() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return 0;
+    }
+
+    virtual bool isGenerator() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return true;
+    }
+
+    virtual std::string getPluginID() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return PLUGINID_NATRON_IMAGEBUFFER;
+    }
+
+    virtual std::string getPluginLabel() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return "ImageBuffer";
+    }
+
+    virtual std::string getPluginDescription() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return "Outputs the pixels written from Python with Effect.createImageBuffer.";
+    }
+
+    virtual void getPluginGrouping(std::list<std::string>* grouping) const OVERRIDE FINAL;
+
+    virtual std::string getInputLabel(int /*inputNb*/) const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return std::string();
+    }
+
+    virtual bool isInputOptional(int /*inputNb*/) const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return false;
+    }
+
+    virtual void addAcceptedComponents(int inputNb, std::list<ImagePlaneDesc>* comps) OVERRIDE FINAL;
+    virtual void addSupportedBitDepth(std::list<ImageBitDepthEnum>* depths) const OVERRIDE FINAL;
+
+    virtual RenderSafetyEnum renderThreadSafety() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return eRenderSafetyFullySafeFrame;
+    }
+
+    virtual bool supportsTiles() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return true;
+    }
+
+    virtual bool supportsMultiResolution() const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return true;
+    }
+
+    virtual bool getCreateChannelSelectorKnob() const OVERRIDE FINAL WARN_UNUSED_RETURN { return false; }
+
+    virtual bool isHostChannelSelectorSupported(bool* /*defaultR*/,
+                                                bool* /*defaultG*/,
+                                                bool* /*defaultB*/,
+                                                bool* /*defaultA*/) const OVERRIDE FINAL WARN_UNUSED_RETURN
+    {
+        return false;
+    }
+
+    /**
+     * @brief Returns a new full resolution float buffer with the given color plane and bounds, initialized with the
+     * pixels of the current buffer where they overlap and with zeros elsewhere. The buffer becomes the output of the
+     * node once it is given back with setBuffer().
+     * Returns NULL if the plane is not a color plane or if the bounds are empty.
+     **/
+    ImagePtr createBuffer(const ImagePlaneDesc& plane, const RectI& bounds) const;
+
+    /**
+     * @brief Makes the buffer the output of the node. It must not be modified afterwards.
+     * This may be called from any thread.
+     **/
+    void setBuffer(const ImagePtr& buffer);
+
+    ImagePtr getBuffer() const;
+
+Q_SIGNALS:
+
+    void bufferChanged();
+
+public Q_SLOTS:
+
+    void onBufferChanged();
+
+private:
+
+    virtual StatusEnum getPreferredMetadata(NodeMetadata& metadata) OVERRIDE FINAL WARN_UNUSED_RETURN;
+    virtual StatusEnum getRegionOfDefinition(U64 hash, double time, const RenderScale & scale, ViewIdx view, RectD* rod) OVERRIDE FINAL WARN_UNUSED_RETURN;
+    virtual StatusEnum render(const RenderActionArgs& args) OVERRIDE FINAL WARN_UNUSED_RETURN;
+
+    boost::scoped_ptr<ImageBufferNodePrivate> _imp;
+};
+
+NATRON_NAMESPACE_EXIT
+
+#endif // Engine_ImageBufferNode_h
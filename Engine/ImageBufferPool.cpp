@@ -0,0 +1,460 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "ImageBufferPool.h"
+
+#include <algorithm> // max
+#include <cstdlib> // malloc, free
+#include <list>
+#include <map>
+#include <new> // bad_alloc
+#include <set>
+
+#ifdef __NATRON_LINUX__
+#include <stdint.h> // uintptr_t
+#include <sys/mman.h>
+#endif
+
+#include <QtCore/QMutex>
+#include <QtCore/QCoreApplication>
+
+#include "Engine/MemoryInfo.h" // printAsRAM
+#include "Engine/NumaPlacement.h"
+
+// Buffers smaller than this are allocated with malloc() and are not pooled
+#define NATRON_BUFFER_POOL_MIN_BYTES (256 * 1024)
+
+// Number of size classes between two consecutive powers of two: at most 1/8th of a block is wasted by rounding up
+#define NATRON_BUFFER_POOL_CLASSES_PER_DOUBLING 8
+
+#define NATRON_BUFFER_POOL_PAGE_SIZE 4096
+#define NATRON_BUFFER_POOL_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+// Maximum size of the free blocks until the application sets it from the cache size
+#define NATRON_BUFFER_POOL_DEFAULT_MAX_POOLED_BYTES (512 * 1024 * 1024)
+
+NATRON_NAMESPACE_ENTER
+
+namespace {
+
+enum BlockKindEnum
+{
+    eBlockKindMalloc = 0, // malloc() / free()
+    eBlockKindMmap, // mmap() / munmap(), used to place the pages on a NUMA node
+    eBlockKindTransparentHugePages, // mmap() aligned on the huge page size with MADV_HUGEPAGE / munmap()
+    eBlockKindHugeTLB // mmap() with MAP_HUGETLB / munmap()
+};
+
+typedef std::list<ImageBufferPool::Block> BlockList;
+// Free blocks are indexed by NUMA node and size
+typedef std::pair<int, std::size_t> BlockIndexKey;
+typedef std::multimap<BlockIndexKey, BlockList::iterator> BlockIndex;
+
+struct ImageBufferPoolState
+{
+    QMutex lock;
+
+    // Free blocks, the least recently released first
+    BlockList freeBlocks;
+
+    BlockIndex freeBlocksBySize;
+    U64 allocatedBytes;
+    U64 pooledBytes;
+    U64 maximumPooledBytes;
+    U64 nAllocations;
+    U64 nReused;
+    U64 nHugePageBlocks;
+    bool hugePagesEnabled;
+
+    // Set when MAP_HUGETLB failed once, usually because no huge pages are reserved on the system
+    bool hugeTLBUnavailable;
+
+    ImageBufferPoolState()
+        : lock()
+        , freeBlocks()
+        , freeBlocksBySize()
+        , allocatedBytes(0)
+        , pooledBytes(0)
+        , maximumPooledBytes(NATRON_BUFFER_POOL_DEFAULT_MAX_POOLED_BYTES)
+        , nAllocations(0)
+        , nReused(0)
+        , nHugePageBlocks(0)
+        , hugePagesEnabled(false)
+        , hugeTLBUnavailable(false)
+    {
+    }
+};
+
+// Never destroyed: buffers may still be released by static objects at exit
+ImageBufferPoolState* gPool = new ImageBufferPoolState;
+
+std::size_t
+roundUp(std::size_t bytes,
+        std::size_t multiple)
+{
+    return ( (bytes + multiple - 1) / multiple ) * multiple;
+}
+
+std::size_t
+getSizeClass(std::size_t bytes,
+             bool hugePages)
+{
+    std::size_t base = 1;
+
+    while (base <= bytes / 2) {
+        base *= 2;
+    }
+    std::size_t step = (std::max)( (std::size_t)1, base / NATRON_BUFFER_POOL_CLASSES_PER_DOUBLING );
+    std::size_t ret = roundUp(bytes, step);
+    if ( hugePages && (ret >= NATRON_BUFFER_POOL_HUGE_PAGE_SIZE) ) {
+        return roundUp(ret, NATRON_BUFFER_POOL_HUGE_PAGE_SIZE);
+    }
+
+    return roundUp(ret, NATRON_BUFFER_POOL_PAGE_SIZE);
+}
+
+bool
+isHugePageBlock(const ImageBufferPool::Block& block)
+{
+    return block.kind == eBlockKindTransparentHugePages || block.kind == eBlockKindHugeTLB;
+}
+
+/**
+ * @brief Allocates memory from the system, returns a block with no data on failure.
+ * *hugeTLBUnavailable is set to true if MAP_HUGETLB was attempted and failed.
+ **/
+ImageBufferPool::Block
+allocatePages(std::size_t bytes,
+              bool hugePages,
+              bool tryHugeTLB,
+              int numaNode,
+              bool* hugeTLBUnavailable)
+{
+    ImageBufferPool::Block ret;
+
+    ret.bytes = bytes;
+#ifdef __NATRON_LINUX__
+    if ( hugePages && (bytes >= NATRON_BUFFER_POOL_HUGE_PAGE_SIZE) ) {
+#ifdef MAP_HUGETLB
+        if (tryHugeTLB) {
+            void* p = mmap(0, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (p != MAP_FAILED) {
+                ret.data = p;
+                ret.kind = eBlockKindHugeTLB;
+
+                return ret;
+            }
+            *hugeTLBUnavailable = true;
+        }
+#else
+        Q_UNUSED(tryHugeTLB);
+        Q_UNUSED(hugeTLBUnavailable);
+#endif
+        // Transparent huge pages can only back ranges aligned on the huge page size: map more than needed
+        // and unmap what is outside of the aligned range
+        std::size_t mappedBytes = bytes + NATRON_BUFFER_POOL_HUGE_PAGE_SIZE;
+        void* p = mmap(0, mappedBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p != MAP_FAILED) {
+            uintptr_t start = (uintptr_t)p;
+            uintptr_t alignedStart = roundUp(start, NATRON_BUFFER_POOL_HUGE_PAGE_SIZE);
+            if (alignedStart > start) {
+                munmap(p, alignedStart - start);
+            }
+            std::size_t tail = (start + mappedBytes) - (alignedStart + bytes);
+            if (tail > 0) {
+                munmap( (void*)(alignedStart + bytes), tail );
+            }
+#ifdef MADV_HUGEPAGE
+            madvise( (void*)alignedStart, bytes, MADV_HUGEPAGE );
+#endif
+            ret.data = (void*)alignedStart;
+            ret.kind = eBlockKindTransparentHugePages;
+
+            return ret;
+        }
+    }
+    if (numaNode >= 0) {
+        // Fresh pages that can be placed on the node, unlike memory recycled by malloc()
+        void* p = mmap(0, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p != MAP_FAILED) {
+            ret.data = p;
+            ret.kind = eBlockKindMmap;
+
+            return ret;
+        }
+    }
+#else
+    Q_UNUSED(hugePages);
+    Q_UNUSED(tryHugeTLB);
+    Q_UNUSED(numaNode);
+    Q_UNUSED(hugeTLBUnavailable);
+#endif // ifdef __NATRON_LINUX__
+    ret.data = malloc(bytes);
+    ret.kind = eBlockKindMalloc;
+
+    return ret;
+} // allocatePages
+
+ImageBufferPool::Block
+allocateFromSystem(std::size_t bytes,
+                   bool hugePages,
+                   bool tryHugeTLB,
+                   int numaNode,
+                   bool* hugeTLBUnavailable)
+{
+    ImageBufferPool::Block ret = allocatePages(bytes, hugePages, tryHugeTLB, numaNode, hugeTLBUnavailable);
+
+    if ( ret.data && (ret.kind != eBlockKindMalloc) && (numaNode >= 0) ) {
+        // The pages were not touched yet
+        NumaPlacement::setMemoryNode(ret.data, ret.bytes, numaNode);
+        ret.numaNode = numaNode;
+    }
+
+    return ret;
+}
+
+void
+freeToSystem(const ImageBufferPool::Block& block)
+{
+    if (!block.data) {
+        return;
+    }
+#ifdef __NATRON_LINUX__
+    if (block.kind != eBlockKindMalloc) {
+        munmap(block.data, block.bytes);
+
+        return;
+    }
+#endif
+    free(block.data);
+}
+
+// Must be called with the lock held. Moves the free blocks released the longest time ago to toFree
+// until at most maxPooledBytes are pooled.
+void
+trimInternal(U64 maxPooledBytes,
+             BlockList* toFree)
+{
+    while ( (gPool->pooledBytes > maxPooledBytes) && !gPool->freeBlocks.empty() ) {
+        BlockList::iterator oldest = gPool->freeBlocks.begin();
+        std::pair<BlockIndex::iterator, BlockIndex::iterator> range = gPool->freeBlocksBySize.equal_range( BlockIndexKey(oldest->numaNode, oldest->bytes) );
+        for (BlockIndex::iterator it = range.first; it != range.second; ++it) {
+            if (it->second == oldest) {
+                gPool->freeBlocksBySize.erase(it);
+                break;
+            }
+        }
+        gPool->pooledBytes -= oldest->bytes;
+        if ( isHugePageBlock(*oldest) ) {
+            --gPool->nHugePageBlocks;
+        }
+        toFree->splice(toFree->end(), gPool->freeBlocks, oldest);
+    }
+}
+
+void
+freeBlocksToSystem(const BlockList& blocks)
+{
+    for (BlockList::const_iterator it = blocks.begin(); it != blocks.end(); ++it) {
+        freeToSystem(*it);
+    }
+}
+} // anon namespace
+
+ImageBufferPool::Block
+ImageBufferPool::allocate(std::size_t bytes)
+{
+    if (bytes < NATRON_BUFFER_POOL_MIN_BYTES) {
+        Block ret;
+        ret.data = malloc(bytes);
+        if (!ret.data) {
+            throw std::bad_alloc();
+        }
+        ret.bytes = bytes;
+        ret.kind = eBlockKindMalloc;
+
+        return ret;
+    }
+
+    bool hugePages, tryHugeTLB;
+    std::size_t classBytes;
+    const int numaNode = NumaPlacement::getCurrentThreadNode();
+    {
+        QMutexLocker k(&gPool->lock);
+        ++gPool->nAllocations;
+        hugePages = gPool->hugePagesEnabled;
+        tryHugeTLB = !gPool->hugeTLBUnavailable;
+        classBytes = getSizeClass(bytes, hugePages);
+
+        // Reuse the most recently released block of that class, its pages are the most likely to be resident
+        const BlockIndexKey key(numaNode, classBytes);
+        BlockIndex::iterator found = gPool->freeBlocksBySize.upper_bound(key);
+        if ( found != gPool->freeBlocksBySize.begin() ) {
+            --found;
+            if (found->first == key) {
+                Block ret = *found->second;
+                gPool->freeBlocks.erase(found->second);
+                gPool->freeBlocksBySize.erase(found);
+                gPool->pooledBytes -= ret.bytes;
+                gPool->allocatedBytes += ret.bytes;
+                ++gPool->nReused;
+
+                return ret;
+            }
+        }
+    }
+
+    bool hugeTLBUnavailable = false;
+    Block ret = allocateFromSystem(classBytes, hugePages, tryHugeTLB, numaNode, &hugeTLBUnavailable);
+    if (!ret.data) {
+        // Give the pooled memory back to the system and try again
+        trim(0);
+        ret = allocateFromSystem(classBytes, hugePages, false, numaNode, &hugeTLBUnavailable);
+        if (!ret.data) {
+            throw std::bad_alloc();
+        }
+    }
+
+    QMutexLocker k(&gPool->lock);
+    if (hugeTLBUnavailable) {
+        gPool->hugeTLBUnavailable = true;
+    }
+    gPool->allocatedBytes += ret.bytes;
+    if ( isHugePageBlock(ret) ) {
+        ++gPool->nHugePageBlocks;
+    }
+
+    return ret;
+} // ImageBufferPool::allocate
+
+void
+ImageBufferPool::release(Block* block)
+{
+    if (!block->data) {
+        return;
+    }
+    if (block->bytes < NATRON_BUFFER_POOL_MIN_BYTES) {
+        freeToSystem(*block);
+        *block = Block();
+
+        return;
+    }
+
+    BlockList toFree;
+    {
+        QMutexLocker k(&gPool->lock);
+        gPool->allocatedBytes -= block->bytes;
+        if (block->bytes <= gPool->maximumPooledBytes) {
+            BlockList::iterator it = gPool->freeBlocks.insert(gPool->freeBlocks.end(), *block);
+            gPool->freeBlocksBySize.insert( std::make_pair(BlockIndexKey(block->numaNode, block->bytes), it) );
+            gPool->pooledBytes += block->bytes;
+            trimInternal(gPool->maximumPooledBytes, &toFree);
+        } else {
+            if ( isHugePageBlock(*block) ) {
+                --gPool->nHugePageBlocks;
+            }
+            toFree.push_back(*block);
+        }
+    }
+    freeBlocksToSystem(toFree);
+    *block = Block();
+}
+
+void
+ImageBufferPool::setMaximumPooledBytes(U64 bytes)
+{
+    BlockList toFree;
+    {
+        QMutexLocker k(&gPool->lock);
+        gPool->maximumPooledBytes = bytes;
+        trimInternal(bytes, &toFree);
+    }
+    freeBlocksToSystem(toFree);
+}
+
+void
+ImageBufferPool::trim(U64 maxPooledBytes)
+{
+    BlockList toFree;
+    {
+        QMutexLocker k(&gPool->lock);
+        trimInternal(maxPooledBytes, &toFree);
+    }
+    freeBlocksToSystem(toFree);
+}
+
+void
+ImageBufferPool::setHugePagesEnabled(bool enabled)
+{
+    QMutexLocker k(&gPool->lock);
+
+    gPool->hugePagesEnabled = enabled;
+}
+
+ImageBufferPoolStatistics
+ImageBufferPool::getStatistics()
+{
+    QMutexLocker k(&gPool->lock);
+    ImageBufferPoolStatistics ret;
+
+    ret.allocatedBytes = gPool->allocatedBytes;
+    ret.pooledBytes = gPool->pooledBytes;
+    ret.maximumPooledBytes = gPool->maximumPooledBytes;
+    ret.nAllocations = gPool->nAllocations;
+    ret.nReused = gPool->nReused;
+    ret.nHugePageBlocks = gPool->nHugePageBlocks;
+    ret.nFreeBlocks = gPool->freeBlocks.size();
+    std::set<std::size_t> sizeClasses;
+    for (BlockIndex::const_iterator it = gPool->freeBlocksBySize.begin(); it != gPool->freeBlocksBySize.end(); ++it) {
+        sizeClasses.insert(it->first.second);
+    }
+    ret.nFreeSizeClasses = sizeClasses.size();
+
+    return ret;
+}
+
+std::size_t
+ImageBufferPool::getAllocatedSize(std::size_t bytes,
+                                  bool hugePages)
+{
+    return bytes < NATRON_BUFFER_POOL_MIN_BYTES ? bytes : getSizeClass(bytes, hugePages);
+}
+
+QString
+ImageBufferPool::printStatistics(const ImageBufferPoolStatistics& stats)
+{
+    double reusedPercent = stats.nAllocations > 0 ? (100. * stats.nReused) / stats.nAllocations : 0.;
+
+    return QCoreApplication::translate("ImageBufferPool", "Image buffer pool: %1 in use, %2 pooled in %3 blocks of %4 sizes (maximum %5), %6% of %7 allocations reused, %8 blocks backed by huge pages")
+           .arg( printAsRAM(stats.allocatedBytes) )
+           .arg( printAsRAM(stats.pooledBytes) )
+           .arg(stats.nFreeBlocks)
+           .arg(stats.nFreeSizeClasses)
+           .arg( printAsRAM(stats.maximumPooledBytes) )
+           .arg(reusedPercent, 0, 'f', 1)
+           .arg(stats.nAllocations)
+           .arg(stats.nHugePageBlocks);
+}
+
+NATRON_NAMESPACE_EXIT
@@ -0,0 +1,146 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef Engine_ImageBufferPool_h
+#define Engine_ImageBufferPool_h
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <cstddef>
+
+#include <QtCore/QString>
+
+#include "Global/GlobalDefines.h"
+
+#include "Engine/EngineFwd.h"
+
+NATRON_NAMESPACE_ENTER
+
+/**
+ * @brief Counters of the ImageBufferPool, all sizes are in bytes.
+ **/
+struct ImageBufferPoolStatistics
+{
+    U64 allocatedBytes; // size of the pooled blocks currently in use
+    U64 pooledBytes; // size of the free blocks kept for reuse
+    U64 maximumPooledBytes;
+    U64 nAllocations; // number of allocations large enough to be pooled
+    U64 nReused; // number of those allocations that were served by a free block
+    U64 nHugePageBlocks; // number of blocks, in use or free, backed by huge pages
+    U64 nFreeBlocks; // number of free blocks kept for reuse
+    U64 nFreeSizeClasses; // number of distinct size classes among the free blocks
+
+    ImageBufferPoolStatistics()
+        : allocatedBytes(0)
+        , pooledBytes(0)
+        , maximumPooledBytes(0)
+        , nAllocations(0)
+        , nReused(0)
+        , nHugePageBlocks(0)
+        , nFreeBlocks(0)
+        , nFreeSizeClasses(0)
+    {
+    }
+};
+
+/**
+ * @brief Allocator of the RAM buffers of the cache entries (see RamBuffer).
+ * Large buffers are rounded up to a size class and, once released, are kept in a pool to be reused by the next
+ * allocation of the same class instead of being returned to the system. Images of a sequence usually all have the
+ * same size, so the buffers freed by the cache deleter thread are recycled for the next frames, avoiding page faults
+ * and the fragmentation of the address space. The pool is bounded: the free blocks released the longest time ago are
+ * returned to the system first.
+ * On Linux, large buffers may optionally be backed by huge pages (MAP_HUGETLB if pages are reserved, transparent huge
+ * pages otherwise) which reduces TLB misses when processing large float images.
+ * When the allocating thread is placed on a NUMA node (see NumaPlacement), large buffers are placed in the memory of
+ * that node and free blocks are only reused by threads of the same node.
+ * Small buffers are allocated with malloc() directly.
+ * This class is MT-safe.
+ **/
+class ImageBufferPool
+{
+public:
+
+    /**
+     * @brief A buffer allocated by the pool. It must be given back with release().
+     **/
+    struct Block
+    {
+        void* data;
+        std::size_t bytes; // size of the block, which may be larger than the size requested
+        int kind; // how the memory was obtained, see ImageBufferPool.cpp
+        int numaNode; // the NUMA node the memory was placed on, -1 if none (see NumaPlacement)
+
+        Block()
+            : data(0)
+            , bytes(0)
+            , kind(0)
+            , numaNode(-1)
+        {
+        }
+    };
+
+    /**
+     * @brief Returns a block of at least the given size. Throws std::bad_alloc on failure.
+     **/
+    static Block allocate(std::size_t bytes);
+
+    /**
+     * @brief Gives the block back to the pool, or to the system if it is not pooled. The block is reset.
+     **/
+    static void release(Block* block);
+
+    /**
+     * @brief Sets the maximum size of the free blocks kept for reuse, releasing blocks if needed.
+     **/
+    static void setMaximumPooledBytes(U64 bytes);
+
+    /**
+     * @brief Returns free blocks to the system until at most the given number of bytes is pooled.
+     * This does not change the maximum pool size.
+     **/
+    static void trim(U64 maxPooledBytes);
+
+    /**
+     * @brief When enabled, large buffers allocated afterwards are backed by huge pages when possible.
+     **/
+    static void setHugePagesEnabled(bool enabled);
+
+    /**
+     * @brief Returns the size of the blocks allocated for the given size: buffers smaller than the pooling threshold
+     * are allocated with their exact size, larger ones are rounded up to their size class.
+     **/
+    static std::size_t getAllocatedSize(std::size_t bytes, bool hugePages);
+
+    static ImageBufferPoolStatistics getStatistics();
+
+    /**
+     * @brief Returns a human readable description of the statistics, used in the render statistics.
+     **/
+    static QString printStatistics(const ImageBufferPoolStatistics& stats);
+};
+
+NATRON_NAMESPACE_EXIT
+
+#endif // Engine_ImageBufferPool_h
@@ -26,21 +26,27 @@
 
 #include <algorithm> // min, max
 #include <cassert>
+#include <cstdlib> // rand
+#include <cstring> // for std::memcpy
 #include <stdexcept>
+#include <vector>
 
 #ifndef Q_MOC_RUN
-GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_OFF
-#include <boost/math/special_functions/fpclassify.hpp>
-GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
+#include <boost/bind.hpp>
 #endif
 
 #include <QtCore/QDebug>
+#include <QtCore/QThreadPool>
+#include <QtConcurrentMap> // QtCore on Qt4, QtConcurrent on Qt5
 
 #include "Engine/AppManager.h"
 #include "Engine/Lut.h"
 
 NATRON_NAMESPACE_ENTER
 
+// Minimum number of pixels converted by each thread in convertToFormat
+#define NATRON_IMAGE_CONVERT_MIN_PIXELS_PER_THREAD 65536
+
 ///explicit template instantiations
 
 template <>
@@ -132,541 +138,476 @@ lutFromColorspace(ViewerColorSpaceEnum cs)
     return lut;
 }
 
-///Fast version when components are the same
-template <typename SRCPIX, typename DSTPIX, int srcMaxValue, int dstMaxValue>
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+/*
+ * Row kernels of the conversion.
+ *
+ * The branches of the conversion (bit depths, components, colorspaces, unpremultiplication, dithering) are
+ * resolved once per row band, so that the kernels are plain loops over contiguous memory with compile-time
+ * component counts: the loops without Lut lookups are vectorized by the compiler.
+ * The colorspace conversions go through a row of linear float values, which is then converted to the
+ * destination depth. The results are the same as with a per-pixel conversion.
+ */
+
+template <typename SRCPIX, typename DSTPIX>
 void
-Image::convertToFormatInternal_sameComps(const RectI & renderWindow,
-                                         const Image & srcImg,
-                                         Image & dstImg,
-                                         ViewerColorSpaceEnum srcColorSpace,
-                                         ViewerColorSpaceEnum dstColorSpace,
-                                         bool copyBitmap)
+convertElements(const SRCPIX* src,
+                DSTPIX* dst,
+                int count)
 {
-    const RectI & r = srcImg._bounds;
-    RectI intersection;
-
-    if ( !renderWindow.intersect(r, &intersection) ) {
-        return;
+    for (int i = 0; i < count; ++i) {
+        dst[i] = Image::convertPixelDepth<SRCPIX, DSTPIX>(src[i]);
     }
+}
 
-    ImageBitDepthEnum dstDepth = dstImg.getBitDepth();
-    ImageBitDepthEnum srcDepth = srcImg.getBitDepth();
-    int nComp = (int)srcImg.getComponentsCount();
-    const Color::Lut* const srcLut_ = lutFromColorspace(srcColorSpace);
-    const Color::Lut* const dstLut_ = lutFromColorspace(dstColorSpace);
+template <typename PIX>
+void
+convertElements(const PIX* src,
+                PIX* dst,
+                int count)
+{
+    std::memcpy( dst, src, count * sizeof(PIX) );
+}
 
+/**
+ * @brief Converts the first nChannels channels of each pixel, without colorspace conversion, when the number
+ * of components changes: the remaining RGB channels are black and alpha is set to alphaFill.
+ **/
+template <typename SRCPIX, typename DSTPIX, int srcNComps, int dstNComps, int nChannels>
+void
+convertChannels(const SRCPIX* src,
+                DSTPIX* dst,
+                int width,
+                DSTPIX alphaFill)
+{
+    for (int x = 0; x < width; ++x, src += srcNComps, dst += dstNComps) {
+        for (int k = 0; k < nChannels; ++k) {
+            dst[k] = Image::convertPixelDepth<SRCPIX, DSTPIX>(src[k]);
+        }
+        for (int k = nChannels; k < 3 && k < dstNComps; ++k) {
+            dst[k] = 0;
+        }
+        if (dstNComps == 4) {
+            dst[3] = alphaFill;
+        }
+    }
+}
 
-    ///no colorspace conversion applied when luts are the same
-    const Color::Lut* const srcLut = (srcLut_ == dstLut_) ? 0 : srcLut_;
-    const Color::Lut* const dstLut = (srcLut_ == dstLut_) ? 0 : dstLut_;
-    if ( intersection.isNull() ) {
-        return;
+template <typename SRCPIX, typename DSTPIX, int srcNComps>
+void
+extractChannel(const SRCPIX* src,
+               int channel,
+               DSTPIX* dst,
+               int width)
+{
+    src += channel;
+    for (int x = 0; x < width; ++x, src += srcNComps) {
+        dst[x] = Image::convertPixelDepth<SRCPIX, DSTPIX>(*src);
     }
-    for (int y = 0; y < intersection.height(); ++y) {
-        // coverity[dont_call]
-        int start = rand() % intersection.width();
-        const SRCPIX* srcPixels = (const SRCPIX*)srcImg.pixelAt(intersection.x1 + start, intersection.y1 + y);
-        DSTPIX* dstPixels = (DSTPIX*)dstImg.pixelAt(intersection.x1 + start, intersection.y1 + y);
-        const SRCPIX* srcStart = srcPixels;
-        DSTPIX* dstStart = dstPixels;
-
-        for (int backward = 0; backward < 2; ++backward) {
-            int x = backward ? start - 1 : start;
-            int end = backward ? -1 : intersection.width();
-            unsigned error[3] = {
-                0x80, 0x80, 0x80
-            };
-
-            while ( x != end && x >= 0 && x < intersection.width() ) {
-                for (int k = 0; k < nComp; ++k) {
-#                 ifdef DEBUG
-                    assert( !(boost::math::isnan)(srcPixels[k]) ); // check for NaN
-#                 endif
-                    DSTPIX pix;
-                    if ( (k == 3) || (!srcLut && !dstLut) ) {
-                        pix = convertPixelDepth<SRCPIX, DSTPIX>(srcPixels[k]);
-                    } else {
-                        float pixFloat;
-
-                        if (srcLut) {
-                            if (srcDepth == eImageBitDepthByte) {
-                                pixFloat = srcLut->fromColorSpaceUint8ToLinearFloatFast(srcPixels[k]);
-                            } else if (srcDepth == eImageBitDepthShort) {
-                                pixFloat = srcLut->fromColorSpaceUint16ToLinearFloatFast(srcPixels[k]);
-                            } else {
-                                pixFloat = srcLut->fromColorSpaceFloatToLinearFloat(srcPixels[k]);
-                            }
-                        } else {
-                            pixFloat = convertPixelDepth<SRCPIX, float>(srcPixels[k]);
-                        }
-
-                        if (dstDepth == eImageBitDepthByte) {
-                            ///small increase in perf we use Luts. This should be anyway the most used case.
-                            error[k] = (error[k] & 0xff) + ( dstLut ? dstLut->toColorSpaceUint8xxFromLinearFloatFast(pixFloat) :
-                                                             Color::floatToInt<0xff01>(pixFloat) );
-                            pix = error[k] >> 8;
-                        } else if (dstDepth == eImageBitDepthShort) {
-                            pix = dstLut ? dstLut->toColorSpaceUint16FromLinearFloatFast(pixFloat) :
-                                  convertPixelDepth<float, DSTPIX>(pixFloat);
-                        } else {
-                            if (dstLut) {
-                                pixFloat = dstLut->toColorSpaceFloatFromLinearFloat(pixFloat);
-                            }
-                            pix = convertPixelDepth<float, DSTPIX>(pixFloat);
-                        }
-                    }
-                    dstPixels[k] =  pix;
-#                 ifdef DEBUG
-                    assert( !(boost::math::isnan)(dstPixels[k]) ); // check for NaN
-#                 endif
-                }
+}
 
-                if (backward) {
-                    --x;
-                    srcPixels -= nComp;
-                    dstPixels -= nComp;
-                } else {
-                    ++x;
-                    srcPixels += nComp;
-                    dstPixels += nComp;
-                }
-            }
-            srcPixels = srcStart - nComp;
-            dstPixels = dstStart - nComp;
+template <typename SRCPIX, typename DSTPIX, int dstNComps>
+void
+replicateChannel(const SRCPIX* src,
+                 DSTPIX* dst,
+                 int width)
+{
+    for (int x = 0; x < width; ++x, dst += dstNComps) {
+        const DSTPIX pix = Image::convertPixelDepth<SRCPIX, DSTPIX>(src[x]);
+        for (int k = 0; k < dstNComps; ++k) {
+            dst[k] = pix;
         }
+    }
+}
 
-        if (copyBitmap) {
-            dstImg.copyBitmapRowPortion(intersection.x1, intersection.x2, intersection.y1 + y, srcImg);
-        }
+template <typename DSTPIX, int dstNComps>
+void
+fillChannel(int channel,
+            DSTPIX value,
+            DSTPIX* dst,
+            int width)
+{
+    dst += channel;
+    for (int x = 0; x < width; ++x, dst += dstNComps) {
+        *dst = value;
     }
-} // convertToFormatInternal_sameComps
+}
+
+inline float
+fromColorSpaceToLinear(unsigned char v,
+                       const Color::Lut* lut)
+{
+    return lut->fromColorSpaceUint8ToLinearFloatFast(v);
+}
 
-template <typename SRCPIX, typename DSTPIX, int srcMaxValue, int dstMaxValue, int srcNComps, int dstNComps,
-          bool requiresUnpremult, bool useColorspaces>
+inline float
+fromColorSpaceToLinear(unsigned short v,
+                       const Color::Lut* lut)
+{
+    return lut->fromColorSpaceUint16ToLinearFloatFast(v);
+}
+
+inline float
+fromColorSpaceToLinear(float v,
+                       const Color::Lut* lut)
+{
+    return lut->fromColorSpaceFloatToLinearFloat(v);
+}
+
+/// Converts the first nChannels channels of each pixel to linear float, unpremultiplying them if needed
+template <typename SRCPIX, int srcNComps, int nChannels>
 void
-Image::convertToFormatInternalForColorSpace(const RectI & renderWindow,
-                                            const Image & srcImg,
-                                            Image & dstImg,
-                                            bool copyBitmap,
-                                            bool useAlpha0,
-                                            ViewerColorSpaceEnum srcColorSpace,
-                                            ViewerColorSpaceEnum dstColorSpace,
-                                            int channelForAlpha)
+convertRowToLinear(const SRCPIX* src,
+                   int width,
+                   const Color::Lut* srcLut,
+                   bool unpremult,
+                   float* linear)
 {
-    /*
-     * If channelForAlpha is -1 the user wants to convert using the default
-     * If channelForAlpha >= 0 then the user wants a specific channel to convert from. This is used mainly when converting
-     * to Alpha images (masks) to know which channel to use for the mask.
-     */
-    if (channelForAlpha != -1) {
-        switch (srcNComps) {
-        case 3:
-            //invalid value passed by the called
-            if (channelForAlpha > 2) {
-                channelForAlpha = -1;
+    if (unpremult) {
+        for (int x = 0; x < width; ++x, src += srcNComps, linear += nChannels) {
+            const float alpha = Image::convertPixelDepth<SRCPIX, float>(src[srcNComps - 1]);
+            for (int k = 0; k < nChannels; ++k) {
+                float pixFloat = Image::convertPixelDepth<SRCPIX, float>(src[k]);
+                pixFloat = alpha == 0.f ? 0.f : pixFloat / alpha;
+                linear[k] = srcLut ? srcLut->fromColorSpaceFloatToLinearFloat(pixFloat) : pixFloat;
             }
-            break;
-        case 2:
-            //invalid value passed by the called
-            if (channelForAlpha > 1) {
-                channelForAlpha = -1;
+        }
+    } else if (srcLut) {
+        for (int x = 0; x < width; ++x, src += srcNComps, linear += nChannels) {
+            for (int k = 0; k < nChannels; ++k) {
+                linear[k] = fromColorSpaceToLinear(src[k], srcLut);
             }
-        default:
-            break;
         }
     } else {
-        switch (srcNComps) {
-        case 4:
-            channelForAlpha = 3;
-            break;
-        case 3:
-        case 1:
-        default:
-            //no alpha anyway
-            break;
+        for (int x = 0; x < width; ++x, src += srcNComps, linear += nChannels) {
+            for (int k = 0; k < nChannels; ++k) {
+                linear[k] = Image::convertPixelDepth<SRCPIX, float>(src[k]);
+            }
         }
     }
+}
 
+inline unsigned
+toUint8xx(float v,
+          const Color::Lut* lut)
+{
+    return lut ? lut->toColorSpaceUint8xxFromLinearFloatFast(v) : Color::floatToInt<0xff01>(v);
+}
 
-    ///special case comp == alpha && channelForAlpha = -1 clear out the mask
-    if ( (dstNComps == 1) && (channelForAlpha == -1) ) {
-        DSTPIX* dstPixels = (DSTPIX*)dstImg.pixelAt(renderWindow.x1, renderWindow.y1);
-        int dstRowSize = dstImg._bounds.width() * dstNComps;
-        if (copyBitmap) {
-            dstImg.copyBitmapPortion(renderWindow, srcImg);
+/*
+ * 8 bits outputs are dithered: the linear values are converted to 8.8 fixed point values (0x0-0xff00)
+ * and the remainders are diffused along the row.
+ * Each row is processed from a random start to its end, then from the start back to its beginning,
+ * each channel with its own error, so that the diffusion pattern does not repeat from one row to the next.
+ */
+template <int dstNComps, int nChannels>
+void
+convertRowFromLinear(const float* linear,
+                     int width,
+                     const Color::Lut* dstLut,
+                     unsigned char* dst)
+{
+    // coverity[dont_call]
+    const int start = rand() % width;
+    unsigned error[nChannels];
+
+    std::fill(error, error + nChannels, 0x80);
+    for (int x = start; x < width; ++x) {
+        for (int k = 0; k < nChannels; ++k) {
+            error[k] = (error[k] & 0xff) + toUint8xx(linear[x * nChannels + k], dstLut);
+            dst[x * dstNComps + k] = (unsigned char)(error[k] >> 8);
         }
-        for (int y = 0; y < renderWindow.height();
-             ++y, dstPixels += dstRowSize) {
-            std::fill(dstPixels, dstPixels + renderWindow.width() * dstNComps, 0.);
+    }
+    std::fill(error, error + nChannels, 0x80);
+    for (int x = start - 1; x >= 0; --x) {
+        for (int k = 0; k < nChannels; ++k) {
+            error[k] = (error[k] & 0xff) + toUint8xx(linear[x * nChannels + k], dstLut);
+            dst[x * dstNComps + k] = (unsigned char)(error[k] >> 8);
         }
-
-        return;
     }
+}
 
-    const Color::Lut* const srcLut = useColorspaces ? lutFromColorspace( (ViewerColorSpaceEnum)srcColorSpace ) : 0;
-    const Color::Lut* const dstLut = useColorspaces ? lutFromColorspace( (ViewerColorSpaceEnum)dstColorSpace ) : 0;
-
-    for (int y = 0; y < renderWindow.height(); ++y) {
-        ///Start of the line for error diffusion
-        // coverity[dont_call]
-        int start = rand() % renderWindow.width();
-        const SRCPIX* srcPixels = (const SRCPIX*)srcImg.pixelAt(renderWindow.x1 + start, renderWindow.y1 + y);
-        DSTPIX* dstPixels = (DSTPIX*)dstImg.pixelAt(renderWindow.x1 + start, renderWindow.y1 + y);
-        const SRCPIX* srcStart = srcPixels;
-        DSTPIX* dstStart = dstPixels;
-
-        for (int backward = 0; backward < 2; ++backward) {
-            ///We do twice the loop, once from starting point to end and once from starting point - 1 to real start
-            int x = backward ? start - 1 : start;
-
-            //End is pointing to the first pixel outside the line a la stl
-            int end = backward ? -1 : renderWindow.width();
-            unsigned error[3] = {
-                0x80, 0x80, 0x80
-            };
-
-            while ( x != end && x >= 0 && x < renderWindow.width() ) {
-                if (dstNComps == 1) {
-                    ///If we're converting to alpha, we just have to handle pixel depth conversion
-                    DSTPIX pix;
-
-                    // convertPixelDepth is optimized when SRCPIX == DSTPIX
-
-                    switch (srcNComps) {
-                    case 4:
-                        //channel for alpha must be valid
-                        assert(channelForAlpha > -1 && channelForAlpha <= 3);
-                        pix = convertPixelDepth<SRCPIX, DSTPIX>(srcPixels[channelForAlpha]);
-                        break;
-                    case 3:
-                        // RGB is opaque, so no alpha, unless channelForAlpha is 0-2
-                        pix = convertPixelDepth<SRCPIX, DSTPIX>(channelForAlpha == -1 ? 0. : srcPixels[channelForAlpha]);
-                        break;
-                    case 2:
-                        // XY is opaque unless channelForAlpha is  0-1
-                        pix = convertPixelDepth<SRCPIX, DSTPIX>(channelForAlpha == -1 ? 0. : srcPixels[channelForAlpha]);
-                        break;
-                    case 1:
-                        // just copy alpha disregarding channelForAlpha
-                        pix  = convertPixelDepth<SRCPIX, DSTPIX>(*srcPixels);
-                        break;
-                    }
-
-                    dstPixels[0] = pix;
-#                 ifdef DEBUG
-                    assert( !(boost::math::isnan)(dstPixels[0]) ); // check for NaN
-#                 endif
-                } else { // if (dstNComps == 1) {
-                    if (srcNComps == 1) {
-                        DSTPIX pix = convertPixelDepth<SRCPIX, DSTPIX>(srcPixels[0]);
-#                     ifdef DEBUG
-                        assert(  !(boost::math::isnan)(pix) ); // check for NaN
-#                     endif
-                        for (int k = 0; k < dstNComps; ++k) {
-                            dstPixels[k] = pix;
-                        }
-                    } else {
-                        ///In this case we've XY, RGB or RGBA input and outputs
-                        assert(srcNComps != dstNComps);
-
-                        const bool unpremultChannel = ( //srcNComps == 4 && // test already done in convertToFormatInternalForDepth
-                                                        //dstNComps == 3 && // test already done in convertToFormatInternalForDepth
-                            requiresUnpremult);
-
-                        ///This is only set if unpremultChannel is true
-                        float alphaForUnPremult;
-                        if (unpremultChannel) {
-                            alphaForUnPremult = convertPixelDepth<SRCPIX, float>(srcPixels[srcNComps - 1]);
-                        } else {
-                            alphaForUnPremult = 1.;
-                        }
-
-                        for (int k = 0; k < 3 && k < dstNComps; ++k) {
-                            if (k >= srcNComps) { // e.g. srcNComps = 2 && dstNComps == 3 or 4
-                                dstPixels[k] =  0;
-                                continue;
-                            }
-                            SRCPIX sourcePixel = srcPixels[k];
-                            DSTPIX pix;
-                            if ( !useColorspaces || (!srcLut && !dstLut) ) {
-                                if (dstMaxValue == 255) {
-                                    float pixFloat = convertPixelDepth<SRCPIX, float>(sourcePixel);
-                                    error[k] = (error[k] & 0xff) + Color::floatToInt<0xff01>(pixFloat);
-                                    pix = error[k] >> 8;
-                                } else {
-                                    pix = convertPixelDepth<SRCPIX, DSTPIX>(sourcePixel);
-                                }
-                            } else {
-                                ///For RGB channels
-                                float pixFloat;
-
-                                ///Unpremult before doing colorspace conversion from linear to X
-                                if (unpremultChannel) {
-                                    pixFloat = convertPixelDepth<SRCPIX, float>(sourcePixel);
-                                    pixFloat = alphaForUnPremult == 0.f ? 0. : pixFloat / alphaForUnPremult;
-                                    if (srcLut) {
-                                        pixFloat = srcLut->fromColorSpaceFloatToLinearFloat(pixFloat);
-                                    }
-                                } else if (srcLut) {
-                                    if (srcMaxValue == 255) {
-                                        pixFloat = srcLut->fromColorSpaceUint8ToLinearFloatFast(sourcePixel);
-                                    } else if (srcMaxValue == 65535) {
-                                        pixFloat = srcLut->fromColorSpaceUint16ToLinearFloatFast(sourcePixel);
-                                    } else {
-                                        pixFloat = srcLut->fromColorSpaceFloatToLinearFloat(sourcePixel);
-                                    }
-                                } else {
-                                    pixFloat = convertPixelDepth<SRCPIX, float>(sourcePixel);
-                                }
-
-                                ///Apply dst color-space
-                                if (dstMaxValue == 255) {
-                                    assert(k < 3);
-                                    error[k] = (error[k] & 0xff) + ( dstLut ? dstLut->toColorSpaceUint8xxFromLinearFloatFast(pixFloat) :
-                                                                     Color::floatToInt<0xff01>(pixFloat) );
-                                    pix = error[k] >> 8;
-                                } else if (dstMaxValue == 65535) {
-                                    pix = dstLut ? dstLut->toColorSpaceUint16FromLinearFloatFast(pixFloat) :
-                                          convertPixelDepth<float, DSTPIX>(pixFloat);
-                                } else {
-                                    if (dstLut) {
-                                        pixFloat = dstLut->toColorSpaceFloatFromLinearFloat(pixFloat);
-                                    }
-                                    pix = convertPixelDepth<float, DSTPIX>(pixFloat);
-                                }
-                            } // if (!useColorspaces || (!srcLut && !dstLut)) {
-                            dstPixels[k] =  pix;
-#                 ifdef DEBUG
-                            assert( (boost::math::isnan)(srcPixels[k]) || !(boost::math::isnan)(dstPixels[k]) ); // check for NaN
-#                 endif
-                        } // for (int k = 0; k < k < 3 && k < dstNComps; ++k) {
-
-                        if (dstNComps == 4) {
-                            // For alpha channel, fill with 1, we reach here only if converting RGB-->RGBA or XY--->RGBA
-                            dstPixels[3] =  convertPixelDepth<float, DSTPIX>(useAlpha0 ? 0.f : 1.f);
-                        }
-                    } // if (srcNComps == 1) {
-                } // if (dstNComps == 1) {
-                if (backward) {
-                    --x;
-                    srcPixels -= srcNComps;
-                    dstPixels -= dstNComps;
-                } else {
-                    ++x;
-                    srcPixels += srcNComps;
-                    dstPixels += dstNComps;
-                }
-            } // while ( x != end && x >= 0 && x < renderWindow.width() ) {
-            srcPixels = srcStart - srcNComps;
-            dstPixels = dstStart - dstNComps;
-        } // for (int backward = 0; backward < 2; ++backward) {
-    }  // for (int y = 0; y < renderWindow.height(); ++y) {
-
-    if (copyBitmap) {
-        dstImg.copyBitmapPortion(renderWindow, srcImg);
+template <int dstNComps, int nChannels>
+void
+convertRowFromLinear(const float* linear,
+                     int width,
+                     const Color::Lut* dstLut,
+                     unsigned short* dst)
+{
+    for (int x = 0; x < width; ++x, linear += nChannels, dst += dstNComps) {
+        for (int k = 0; k < nChannels; ++k) {
+            dst[k] = dstLut ? dstLut->toColorSpaceUint16FromLinearFloatFast(linear[k]) :
+                     Image::convertPixelDepth<float, unsigned short>(linear[k]);
+        }
     }
-} // Image::convertToFormatInternalForColorSpace
+}
 
-template <typename SRCPIX, typename DSTPIX, int srcMaxValue, int dstMaxValue, int srcNComps, int dstNComps,
-          bool requiresUnpremult>
+template <int dstNComps, int nChannels>
 void
-Image::convertToFormatInternalForUnpremult(const RectI & renderWindow,
-                                           const Image & srcImg,
-                                           Image & dstImg,
-                                           ViewerColorSpaceEnum srcColorSpace,
-                                           ViewerColorSpaceEnum dstColorSpace,
-                                           bool useAlpha0,
-                                           bool copyBitmap,
-                                           int channelForAlpha)
+convertRowFromLinear(const float* linear,
+                     int width,
+                     const Color::Lut* dstLut,
+                     float* dst)
 {
-    if ( (srcColorSpace == eViewerColorSpaceLinear) && (dstColorSpace == eViewerColorSpaceLinear) ) {
-        convertToFormatInternalForColorSpace<SRCPIX, DSTPIX, srcMaxValue, dstMaxValue, srcNComps, dstNComps, requiresUnpremult, false>(renderWindow, srcImg, dstImg, copyBitmap, useAlpha0, srcColorSpace, dstColorSpace, channelForAlpha);
+    if (dstLut) {
+        for (int x = 0; x < width; ++x, linear += nChannels, dst += dstNComps) {
+            for (int k = 0; k < nChannels; ++k) {
+                dst[k] = dstLut->toColorSpaceFloatFromLinearFloat(linear[k]);
+            }
+        }
     } else {
-        convertToFormatInternalForColorSpace<SRCPIX, DSTPIX, srcMaxValue, dstMaxValue, srcNComps, dstNComps, requiresUnpremult, true>(renderWindow, srcImg, dstImg, copyBitmap, useAlpha0, srcColorSpace, dstColorSpace, channelForAlpha);
+        for (int x = 0; x < width; ++x, linear += nChannels, dst += dstNComps) {
+            for (int k = 0; k < nChannels; ++k) {
+                dst[k] = linear[k];
+            }
+        }
     }
 }
 
-template <typename SRCPIX, typename DSTPIX, int srcMaxValue, int dstMaxValue, int srcNComps, int dstNComps>
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+
+template <typename SRCPIX, typename DSTPIX, int srcNComps, int dstNComps>
 void
-Image::convertToFormatInternal(const RectI & renderWindow,
-                               const Image & srcImg,
-                               Image & dstImg,
-                               ViewerColorSpaceEnum srcColorSpace,
-                               ViewerColorSpaceEnum dstColorSpace,
-                               int channelForAlpha,
-                               bool useAlpha0,
-                               bool copyBitmap,
-                               bool requiresUnpremult)
+Image::convertToFormatRowsForComps(const RectI & rows,
+                                   ViewerColorSpaceEnum srcColorSpace,
+                                   ViewerColorSpaceEnum dstColorSpace,
+                                   int channelForAlpha,
+                                   bool useAlpha0,
+                                   bool copyBitmap,
+                                   bool requiresUnpremult,
+                                   Image* dstImg) const
 {
-    if (requiresUnpremult) {
-        convertToFormatInternalForUnpremult<SRCPIX, DSTPIX, srcMaxValue, dstMaxValue, srcNComps, dstNComps, true>(renderWindow, srcImg, dstImg, srcColorSpace, dstColorSpace, useAlpha0, copyBitmap, channelForAlpha);
-    } else {
-        convertToFormatInternalForUnpremult<SRCPIX, DSTPIX, srcMaxValue, dstMaxValue, srcNComps, dstNComps, false>(renderWindow, srcImg, dstImg, srcColorSpace, dstColorSpace, useAlpha0, copyBitmap, channelForAlpha);
+    const int width = rows.width();
+
+    if ( (width <= 0) || (rows.height() <= 0) ) {
+        return;
     }
-}
 
-template <typename SRCPIX, typename DSTPIX, int srcMaxValue, int dstMaxValue>
+    const bool sameComps = srcNComps == dstNComps;
+    // Number of channels converted from the source, the remaining destination channels are filled
+    const int nColorChannels = srcNComps < dstNComps ? (srcNComps < 3 ? srcNComps : 3) : (dstNComps < 3 ? dstNComps : 3);
+    const Color::Lut* srcLut = lutFromColorspace(srcColorSpace);
+    const Color::Lut* dstLut = lutFromColorspace(dstColorSpace);
+
+    if ( sameComps && (srcLut == dstLut) ) {
+        ///no colorspace conversion applied when luts are the same
+        srcLut = dstLut = 0;
+    }
+    const bool useLuts = srcLut || dstLut;
+    // Alpha is only divided out when the RGB channels go through a colorspace conversion
+    const bool unpremult = requiresUnpremult && useLuts && srcNComps == 4 && dstNComps == 3;
+    // When the components change, 8 bits outputs are dithered, even without colorspace conversion
+    const bool throughLinear = useLuts || ( !sameComps && sizeof(DSTPIX) == 1 );
+
+    /*
+     * If channelForAlpha is -1 the user wants to convert using the default
+     * If channelForAlpha >= 0 then the user wants a specific channel to convert from. This is used mainly when converting
+     * to Alpha images (masks) to know which channel to use for the mask.
+     */
+    if (channelForAlpha != -1) {
+        //invalid value passed by the caller
+        if ( ( (srcNComps == 3) && (channelForAlpha > 2) ) || ( (srcNComps == 2) && (channelForAlpha > 1) ) ) {
+            channelForAlpha = -1;
+        }
+    } else if (srcNComps == 4) {
+        channelForAlpha = 3;
+    }
+    assert(srcNComps != 4 || dstNComps != 1 || channelForAlpha <= 3);
+
+    std::vector<float> linear;
+    if (throughLinear) {
+        linear.resize(width * nColorChannels);
+    }
+
+    const DSTPIX zero = convertPixelDepth<float, DSTPIX>(0.f);
+    const DSTPIX alphaFill = convertPixelDepth<float, DSTPIX>(useAlpha0 ? 0.f : 1.f);
+    const int srcRowElements = _bounds.width() * srcNComps;
+    const int dstRowElements = dstImg->_bounds.width() * dstNComps;
+    const SRCPIX* srcPixels = (const SRCPIX*)pixelAt(rows.x1, rows.y1);
+    DSTPIX* dstPixels = (DSTPIX*)dstImg->pixelAt(rows.x1, rows.y1);
+    assert(srcPixels && dstPixels);
+
+    for (int y = rows.y1; y < rows.y2; ++y, srcPixels += srcRowElements, dstPixels += dstRowElements) {
+        if ( !sameComps && (dstNComps == 1) ) {
+            ///If we're converting to alpha, we just have to handle pixel depth conversion
+            if (channelForAlpha == -1) {
+                // RGB and XY are opaque, unless channelForAlpha is set: clear out the mask
+                std::fill(dstPixels, dstPixels + width, zero);
+            } else {
+                extractChannel<SRCPIX, DSTPIX, srcNComps>(srcPixels, channelForAlpha, dstPixels, width);
+            }
+        } else if ( !sameComps && (srcNComps == 1) ) {
+            replicateChannel<SRCPIX, DSTPIX, dstNComps>(srcPixels, dstPixels, width);
+        } else if (sameComps && !useLuts) {
+            ///Only the bit depth changes, or this is a copy
+            convertElements(srcPixels, dstPixels, width * srcNComps);
+        } else {
+            if (!throughLinear) {
+                assert(!sameComps);
+                convertChannels<SRCPIX, DSTPIX, srcNComps, dstNComps, nColorChannels>(srcPixels, dstPixels, width, alphaFill);
+            } else {
+                convertRowToLinear<SRCPIX, srcNComps, nColorChannels>(srcPixels, width, srcLut, unpremult, &linear.front());
+                convertRowFromLinear<dstNComps, nColorChannels>(&linear.front(), width, dstLut, dstPixels);
+            }
+
+            if (sameComps) {
+                if (srcNComps == 4) {
+                    // Alpha has no colorspace
+                    for (int x = 0; x < width; ++x) {
+                        dstPixels[x * dstNComps + 3] = convertPixelDepth<SRCPIX, DSTPIX>(srcPixels[x * srcNComps + 3]);
+                    }
+                }
+            } else if (throughLinear) {
+                // e.g. XY --> RGB: B is black
+                for (int k = nColorChannels; k < 3 && k < dstNComps; ++k) {
+                    fillChannel<DSTPIX, dstNComps>(k, zero, dstPixels, width);
+                }
+                if (dstNComps == 4) {
+                    // For alpha channel, fill with 1, we reach here only if converting RGB-->RGBA or XY--->RGBA
+                    fillChannel<DSTPIX, dstNComps>(3, alphaFill, dstPixels, width);
+                }
+            }
+        }
+
+        if (copyBitmap) {
+            dstImg->copyBitmapRowPortion(rows.x1, rows.x2, y, *this);
+        }
+    }
+} // Image::convertToFormatRowsForComps
+
+template <typename SRCPIX, typename DSTPIX, int srcNComps>
 void
-Image::convertToFormatInternalForDepth(const RectI & renderWindow,
-                                       const Image & srcImg,
-                                       Image & dstImg,
-                                       ViewerColorSpaceEnum srcColorSpace,
-                                       ViewerColorSpaceEnum dstColorSpace,
-                                       int channelForAlpha,
-                                       bool useAlpha0,
-                                       bool copyBitmap,
-                                       bool requiresUnpremult)
+Image::convertToFormatRowsForSrcComps(const RectI & rows,
+                                      ViewerColorSpaceEnum srcColorSpace,
+                                      ViewerColorSpaceEnum dstColorSpace,
+                                      int channelForAlpha,
+                                      bool useAlpha0,
+                                      bool copyBitmap,
+                                      bool requiresUnpremult,
+                                      Image* dstImg) const
 {
-    int dstNComp = dstImg.getComponents().getNumComponents();
-    int srcNComp = srcImg.getComponents().getNumComponents();
+    switch ( dstImg->getComponentsCount() ) {
+    case 1:
+        convertToFormatRowsForComps<SRCPIX, DSTPIX, srcNComps, 1>(rows, srcColorSpace, dstColorSpace, channelForAlpha, useAlpha0, copyBitmap, requiresUnpremult, dstImg);
+        break;
+    case 2:
+        convertToFormatRowsForComps<SRCPIX, DSTPIX, srcNComps, 2>(rows, srcColorSpace, dstColorSpace, channelForAlpha, useAlpha0, copyBitmap, requiresUnpremult, dstImg);
+        break;
+    case 3:
+        convertToFormatRowsForComps<SRCPIX, DSTPIX, srcNComps, 3>(rows, srcColorSpace, dstColorSpace, channelForAlpha, useAlpha0, copyBitmap, requiresUnpremult, dstImg);
+        break;
+    case 4:
+        convertToFormatRowsForComps<SRCPIX, DSTPIX, srcNComps, 4>(rows, srcColorSpace, dstColorSpace, channelForAlpha, useAlpha0, copyBitmap, requiresUnpremult, dstImg);
+        break;
+    default:
+        assert(false);
+        break;
+    }
+}
 
+template <typename SRCPIX, typename DSTPIX>
+void
+Image::convertToFormatRowsForDepth(const RectI & rows,
+                                   ViewerColorSpaceEnum srcColorSpace,
+                                   ViewerColorSpaceEnum dstColorSpace,
+                                   int channelForAlpha,
+                                   bool useAlpha0,
+                                   bool copyBitmap,
+                                   bool requiresUnpremult,
+                                   Image* dstImg) const
+{
     if (requiresUnpremult) {
-        // see convertToFormatInternalForColorSpace : it is only used in one case!
-        assert(srcNComp == 4 &&
-               dstNComp == 3);
+        // only used when converting RGBA --> RGB
+        assert( (getComponentsCount() == 4 && dstImg->getComponentsCount() == 3) || getComponentsCount() == dstImg->getComponentsCount() );
     }
 
-    switch (srcNComp) {
+    switch ( getComponentsCount() ) {
     case 1:
-        switch (dstNComp) {
-        case 2:
-            convertToFormatInternal<SRCPIX, DSTPIX, srcMaxValue, dstMaxValue, 1, 2>(renderWindow, srcImg, dstImg,
-                                                                                    srcColorSpace,
-                                                                                    dstColorSpace,
-                                                                                    channelForAlpha,
-                                                                                    useAlpha0,
-                                                                                    copyBitmap,
-                                                                                    /*requiresUnpremult=*/ false);
-            break;
-        case 3:
-            convertToFormatInternal<SRCPIX, DSTPIX, srcMaxValue, dstMaxValue, 1, 3>(renderWindow, srcImg, dstImg,
-                                                                                    srcColorSpace,
-                                                                                    dstColorSpace,
-                                                                                    channelForAlpha,
-                                                                                    useAlpha0,
-                                                                                    copyBitmap,
-                                                                                    /*requiresUnpremult=*/ false);
-            break;
-        case 4:
-            convertToFormatInternal<SRCPIX, DSTPIX, srcMaxValue, dstMaxValue, 1, 4>(renderWindow, srcImg, dstImg,
-                                                                                    srcColorSpace,
-                                                                                    dstColorSpace,
-                                                                                    channelForAlpha,
-                                                                                    useAlpha0,
-                                                                                    copyBitmap,
-                                                                                    /*requiresUnpremult=*/ false);
-            break;
-        default:
-            assert(false);
-            break;
-        }
+        convertToFormatRowsForSrcComps<SRCPIX, DSTPIX, 1>(rows, srcColorSpace, dstColorSpace, channelForAlpha, useAlpha0, copyBitmap, requiresUnpremult, dstImg);
         break;
     case 2:
-        switch (dstNComp) {
-        case 1:
-            convertToFormatInternal<SRCPIX, DSTPIX, srcMaxValue, dstMaxValue, 2, 1>(renderWindow, srcImg, dstImg,
-                                                                                    srcColorSpace,
-                                                                                    dstColorSpace,
-                                                                                    channelForAlpha,
-                                                                                    useAlpha0,
-                                                                                    copyBitmap,
-                                                                                    /*requiresUnpremult=*/ false);
+        convertToFormatRowsForSrcComps<SRCPIX, DSTPIX, 2>(rows, srcColorSpace, dstColorSpace, channelForAlpha, useAlpha0, copyBitmap, requiresUnpremult, dstImg);
+        break;
+    case 3:
+        convertToFormatRowsForSrcComps<SRCPIX, DSTPIX, 3>(rows, srcColorSpace, dstColorSpace, channelForAlpha, useAlpha0, copyBitmap, requiresUnpremult, dstImg);
+        break;
+    case 4:
+        convertToFormatRowsForSrcComps<SRCPIX, DSTPIX, 4>(rows, srcColorSpace, dstColorSpace, channelForAlpha, useAlpha0, copyBitmap, requiresUnpremult, dstImg);
+        break;
+    default:
+        break;
+    }
+}
+
+void
+Image::convertToFormatRows(const RectI & rows,
+                           ViewerColorSpaceEnum srcColorSpace,
+                           ViewerColorSpaceEnum dstColorSpace,
+                           int channelForAlpha,
+                           bool useAlpha0,
+                           bool copyBitmap,
+                           bool requiresUnpremult,
+                           Image* dstImg) const
+{
+    switch ( dstImg->getBitDepth() ) {
+    case eImageBitDepthByte: {
+        switch ( getBitDepth() ) {
+        case eImageBitDepthByte:
+            convertToFormatRowsForDepth<unsigned char, unsigned char>(rows, srcColorSpace, dstColorSpace, channelForAlpha, useAlpha0, copyBitmap, requiresUnpremult, dstImg);
             break;
-        case 3:
-            convertToFormatInternal<SRCPIX, DSTPIX, srcMaxValue, dstMaxValue, 2, 3>(renderWindow, srcImg, dstImg,
-                                                                                    srcColorSpace,
-                                                                                    dstColorSpace,
-                                                                                    channelForAlpha,
-                                                                                    useAlpha0,
-                                                                                    copyBitmap,
-                                                                                    /*requiresUnpremult=*/ false);
+        case eImageBitDepthShort:
+            convertToFormatRowsForDepth<unsigned short, unsigned char>(rows, srcColorSpace, dstColorSpace, channelForAlpha, useAlpha0, copyBitmap, requiresUnpremult, dstImg);
             break;
-        case 4:
-            convertToFormatInternal<SRCPIX, DSTPIX, srcMaxValue, dstMaxValue, 2, 4>(renderWindow, srcImg, dstImg,
-                                                                                    srcColorSpace,
-                                                                                    dstColorSpace,
-                                                                                    channelForAlpha,
-                                                                                    useAlpha0,
-                                                                                    copyBitmap,
-                                                                                    /*requiresUnpremult=*/ false);
+        case eImageBitDepthFloat:
+            convertToFormatRowsForDepth<float, unsigned char>(rows, srcColorSpace, dstColorSpace, channelForAlpha, useAlpha0, copyBitmap, requiresUnpremult, dstImg);
             break;
-        default:
-            assert(false);
+        case eImageBitDepthHalf:
+        case eImageBitDepthNone:
             break;
         }
         break;
-    case 3:
-        switch (dstNComp) {
-        case 1:
-            convertToFormatInternal<SRCPIX, DSTPIX, srcMaxValue, dstMaxValue, 3, 1>(renderWindow, srcImg, dstImg,
-                                                                                    srcColorSpace,
-                                                                                    dstColorSpace,
-                                                                                    channelForAlpha,
-                                                                                    useAlpha0,
-                                                                                    copyBitmap,
-                                                                                    /*requiresUnpremult=*/ false);
+    }
+    case eImageBitDepthShort: {
+        switch ( getBitDepth() ) {
+        case eImageBitDepthByte:
+            convertToFormatRowsForDepth<unsigned char, unsigned short>(rows, srcColorSpace, dstColorSpace, channelForAlpha, useAlpha0, copyBitmap, requiresUnpremult, dstImg);
             break;
-        case 2:
-            convertToFormatInternal<SRCPIX, DSTPIX, srcMaxValue, dstMaxValue, 3, 2>(renderWindow, srcImg, dstImg,
-                                                                                    srcColorSpace,
-                                                                                    dstColorSpace,
-                                                                                    channelForAlpha,
-                                                                                    useAlpha0,
-                                                                                    copyBitmap,
-                                                                                    /*requiresUnpremult=*/ false);
+        case eImageBitDepthShort:
+            convertToFormatRowsForDepth<unsigned short, unsigned short>(rows, srcColorSpace, dstColorSpace, channelForAlpha, useAlpha0, copyBitmap, requiresUnpremult, dstImg);
             break;
-        case 4:
-            convertToFormatInternal<SRCPIX, DSTPIX, srcMaxValue, dstMaxValue, 3, 4>(renderWindow, srcImg, dstImg,
-                                                                                    srcColorSpace,
-                                                                                    dstColorSpace,
-                                                                                    channelForAlpha,
-                                                                                    useAlpha0,
-                                                                                    copyBitmap,
-                                                                                    /*requiresUnpremult=*/ false);
+        case eImageBitDepthFloat:
+            convertToFormatRowsForDepth<float, unsigned short>(rows, srcColorSpace, dstColorSpace, channelForAlpha, useAlpha0, copyBitmap, requiresUnpremult, dstImg);
             break;
-        default:
-            assert(false);
+        case eImageBitDepthHalf:
+        case eImageBitDepthNone:
             break;
         }
         break;
-    case 4:
-        switch (dstNComp) {
-        case 1:
-            convertToFormatInternal<SRCPIX, DSTPIX, srcMaxValue, dstMaxValue, 4, 1>(renderWindow, srcImg, dstImg,
-                                                                                    srcColorSpace,
-                                                                                    dstColorSpace,
-                                                                                    channelForAlpha,
-                                                                                    useAlpha0,
-                                                                                    copyBitmap,
-                                                                                    /*requiresUnpremult=*/ false);
+    }
+    case eImageBitDepthFloat: {
+        switch ( getBitDepth() ) {
+        case eImageBitDepthByte:
+            convertToFormatRowsForDepth<unsigned char, float>(rows, srcColorSpace, dstColorSpace, channelForAlpha, useAlpha0, copyBitmap, requiresUnpremult, dstImg);
             break;
-        case 2:
-            convertToFormatInternal<SRCPIX, DSTPIX, srcMaxValue, dstMaxValue, 4, 2>(renderWindow, srcImg, dstImg,
-                                                                                    srcColorSpace,
-                                                                                    dstColorSpace,
-                                                                                    channelForAlpha,
-                                                                                    useAlpha0,
-                                                                                    copyBitmap,
-                                                                                    /*requiresUnpremult=*/ false);
+        case eImageBitDepthShort:
+            convertToFormatRowsForDepth<unsigned short, float>(rows, srcColorSpace, dstColorSpace, channelForAlpha, useAlpha0, copyBitmap, requiresUnpremult, dstImg);
             break;
-        case 3:
-            convertToFormatInternal<SRCPIX, DSTPIX, srcMaxValue, dstMaxValue, 4, 3>(renderWindow, srcImg, dstImg,
-                                                                                    srcColorSpace,
-                                                                                    dstColorSpace,
-                                                                                    channelForAlpha,
-                                                                                    useAlpha0,
-                                                                                    copyBitmap,
-                                                                                    requiresUnpremult);       // only case where requiresUnpremult seems to be useful
+        case eImageBitDepthFloat:
+            convertToFormatRowsForDepth<float, float>(rows, srcColorSpace, dstColorSpace, channelForAlpha, useAlpha0, copyBitmap, requiresUnpremult, dstImg);
             break;
-        default:
-            assert(false);
+        case eImageBitDepthHalf:
+        case eImageBitDepthNone:
             break;
         }
         break;
-    default:
+    }
+    case eImageBitDepthHalf:
+    case eImageBitDepthNone:
         break;
     } // switch
-} // Image::convertToFormatInternalForDepth
+} // Image::convertToFormatRows
 
 void
 Image::convertToFormatCommon(const RectI & renderWindow,
@@ -683,206 +624,40 @@ Image::convertToFormatCommon(const RectI & renderWindow,
 
     assert( _bounds.contains(renderWindow) &&  dstImg->_bounds.contains(renderWindow) );
 
-    if ( dstImg->getComponents().getNumComponents() == getComponents().getNumComponents() ) {
-        switch ( dstImg->getBitDepth() ) {
-        case eImageBitDepthByte: {
-            switch ( getBitDepth() ) {
-            case eImageBitDepthByte:
-                ///Same as a copy
-                convertToFormatInternal_sameComps<unsigned char, unsigned char, 255, 255>(renderWindow, *this, *dstImg,
-                                                                                          srcColorSpace,
-                                                                                          dstColorSpace, copyBitmap);
-                break;
-            case eImageBitDepthShort:
-                convertToFormatInternal_sameComps<unsigned short, unsigned char, 65535, 255>(renderWindow, *this, *dstImg,
-                                                                                             srcColorSpace,
-                                                                                             dstColorSpace, copyBitmap);
-                break;
-            case eImageBitDepthHalf:
-                break;
-            case eImageBitDepthFloat:
-                convertToFormatInternal_sameComps<float, unsigned char, 1, 255>(renderWindow, *this, *dstImg,
-                                                                                srcColorSpace,
-                                                                                dstColorSpace, copyBitmap);
-                break;
-            case eImageBitDepthNone:
-                break;
-            }
-            break;
-        }
-
-        case eImageBitDepthShort: {
-            switch ( getBitDepth() ) {
-            case eImageBitDepthByte:
-                convertToFormatInternal_sameComps<unsigned char, unsigned short, 255, 65535>(renderWindow, *this, *dstImg,
-                                                                                             srcColorSpace,
-                                                                                             dstColorSpace, copyBitmap);
-                break;
-            case eImageBitDepthShort:
-                ///Same as a copy
-                convertToFormatInternal_sameComps<unsigned short, unsigned short, 65535, 65535>(renderWindow, *this, *dstImg,
-                                                                                                srcColorSpace,
-                                                                                                dstColorSpace, copyBitmap);
-                break;
-            case eImageBitDepthHalf:
-                break;
-            case eImageBitDepthFloat:
-                convertToFormatInternal_sameComps<float, unsigned short, 1, 65535>(renderWindow, *this, *dstImg,
-                                                                                   srcColorSpace,
-                                                                                   dstColorSpace, copyBitmap);
-                break;
-            case eImageBitDepthNone:
-                break;
-            }
-            break;
-        }
+    if ( renderWindow.isNull() ) {
+        return;
+    }
 
-        case eImageBitDepthHalf:
-            break;
+    /*
+     * The rows of the render window are split in bands converted in parallel, unless the window is small
+     * or the global thread pool is already busy (e.g. with the render threads).
+     */
+    int nBands = 1;
+    if (appPTR) {
+        U64 maxBandsForSize = renderWindow.area() / NATRON_IMAGE_CONVERT_MIN_PIXELS_PER_THREAD;
+        nBands = std::min( appPTR->getMaxThreadCount(), renderWindow.height() );
+        nBands = (int)std::min( (U64)nBands, maxBandsForSize );
+    }
+    bool runInCurrentThread = nBands <= 1 || QThreadPool::globalInstance()->activeThreadCount() >= QThreadPool::globalInstance()->maxThreadCount();
 
-        case eImageBitDepthFloat: {
-            switch ( getBitDepth() ) {
-            case eImageBitDepthByte:
-                convertToFormatInternal_sameComps<unsigned char, float, 255, 1>(renderWindow, *this, *dstImg,
-                                                                                srcColorSpace,
-                                                                                dstColorSpace, copyBitmap);
-                break;
-            case eImageBitDepthShort:
-                convertToFormatInternal_sameComps<unsigned short, float, 65535, 1>(renderWindow, *this, *dstImg,
-                                                                                   srcColorSpace,
-                                                                                   dstColorSpace, copyBitmap);
-                break;
-            case eImageBitDepthHalf:
-                break;
-            case eImageBitDepthFloat:
-                ///Same as a copy
-                convertToFormatInternal_sameComps<float, float, 1, 1>(renderWindow, *this, *dstImg,
-                                                                      srcColorSpace,
-                                                                      dstColorSpace, copyBitmap);
-                break;
-            case eImageBitDepthNone:
-                break;
-            }
-            break;
-        }
+    if (runInCurrentThread) {
+        convertToFormatRows(renderWindow, srcColorSpace, dstColorSpace, channelForAlpha, useAlpha0, copyBitmap, requiresUnpremult, dstImg);
 
-        case eImageBitDepthNone:
-            break;
-        } // switch
-    } else {
-        switch ( dstImg->getBitDepth() ) {
-        case eImageBitDepthByte: {
-            switch ( getBitDepth() ) {
-            case eImageBitDepthByte:
-                convertToFormatInternalForDepth<unsigned char, unsigned char, 255, 255>(renderWindow, *this, *dstImg,
-                                                                                        srcColorSpace,
-                                                                                        dstColorSpace,
-                                                                                        channelForAlpha,
-                                                                                        useAlpha0,
-                                                                                        copyBitmap, requiresUnpremult);
-                break;
-            case eImageBitDepthShort:
-                convertToFormatInternalForDepth<unsigned short, unsigned char, 65535, 255>(renderWindow, *this, *dstImg,
-                                                                                           srcColorSpace,
-                                                                                           dstColorSpace,
-                                                                                           channelForAlpha,
-                                                                                           useAlpha0,
-                                                                                           copyBitmap, requiresUnpremult);
-                break;
-            case eImageBitDepthHalf:
-                break;
-            case eImageBitDepthFloat:
-                convertToFormatInternalForDepth<float, unsigned char, 1, 255>(renderWindow, *this, *dstImg,
-                                                                              srcColorSpace,
-                                                                              dstColorSpace,
-                                                                              channelForAlpha,
-                                                                              useAlpha0,
-                                                                              copyBitmap, requiresUnpremult);
-
-                break;
-            case eImageBitDepthNone:
-                break;
-            }
-            break;
-        }
-        case eImageBitDepthShort: {
-            switch ( getBitDepth() ) {
-            case eImageBitDepthByte:
-                convertToFormatInternalForDepth<unsigned char, unsigned short, 255, 65535>(renderWindow, *this, *dstImg,
-                                                                                           srcColorSpace,
-                                                                                           dstColorSpace,
-                                                                                           channelForAlpha,
-                                                                                           useAlpha0,
-                                                                                           copyBitmap, requiresUnpremult);
-
-                break;
-            case eImageBitDepthShort:
-                convertToFormatInternalForDepth<unsigned short, unsigned short, 65535, 65535>(renderWindow, *this, *dstImg,
-                                                                                              srcColorSpace,
-                                                                                              dstColorSpace,
-                                                                                              channelForAlpha,
-                                                                                              useAlpha0,
-                                                                                              copyBitmap, requiresUnpremult);
-
-                break;
-            case eImageBitDepthHalf:
-                break;
-            case eImageBitDepthFloat:
-                convertToFormatInternalForDepth<float, unsigned short, 1, 65535>(renderWindow, *this, *dstImg,
-                                                                                 srcColorSpace,
-                                                                                 dstColorSpace,
-                                                                                 channelForAlpha,
-                                                                                 useAlpha0,
-                                                                                 copyBitmap, requiresUnpremult);
-                break;
-            case eImageBitDepthNone:
-                break;
-            }
-            break;
-        }
-        case eImageBitDepthHalf:
-            break;
-        case eImageBitDepthFloat: {
-            switch ( getBitDepth() ) {
-            case eImageBitDepthByte:
-                convertToFormatInternalForDepth<unsigned char, float, 255, 1>(renderWindow, *this, *dstImg,
-                                                                              srcColorSpace,
-                                                                              dstColorSpace,
-                                                                              channelForAlpha,
-                                                                              useAlpha0,
-                                                                              copyBitmap, requiresUnpremult);
-                break;
-            case eImageBitDepthShort:
-                convertToFormatInternalForDepth<unsigned short, float, 65535, 1>(renderWindow, *this, *dstImg,
-                                                                                 srcColorSpace,
-                                                                                 dstColorSpace,
-                                                                                 channelForAlpha,
-                                                                                 useAlpha0,
-                                                                                 copyBitmap, requiresUnpremult);
-
-                break;
-            case eImageBitDepthHalf:
-                break;
-            case eImageBitDepthFloat:
-                convertToFormatInternalForDepth<float, float, 1, 1>(renderWindow, *this, *dstImg,
-                                                                    srcColorSpace,
-                                                                    dstColorSpace,
-                                                                    channelForAlpha,
-                                                                    useAlpha0,
-                                                                    copyBitmap, requiresUnpremult);
-                break;
-            case eImageBitDepthNone:
-                break;
-            }
-            break;
-        }
+        return;
+    }
 
-        default:
-            break;
-        } // switch
+    std::vector<RectI> bands(nBands);
+    const int bandHeight = renderWindow.height() / nBands;
+    for (int i = 0; i < nBands; ++i) {
+        bands[i].x1 = renderWindow.x1;
+        bands[i].x2 = renderWindow.x2;
+        bands[i].y1 = renderWindow.y1 + i * bandHeight;
+        bands[i].y2 = (i == nBands - 1) ? renderWindow.y2 : bands[i].y1 + bandHeight;
     }
+    QtConcurrent::map( bands, boost::bind(&Image::convertToFormatRows, this, _1, srcColorSpace, dstColorSpace, channelForAlpha, useAlpha0, copyBitmap, requiresUnpremult, dstImg) ).waitForFinished();
 } // Image::convertToFormatCommon
 
+
 void
 Image::convertToFormat(const RectI & renderWindow,
                        ViewerColorSpaceEnum srcColorSpace,
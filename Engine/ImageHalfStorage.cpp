@@ -0,0 +1,346 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Image.h"
+
+#include <cassert>
+#include <cmath> // fabs
+#include <cstring> // for std::memcpy
+
+// The conversions use the F16C instructions when the processor supports them, with the GCC/Clang target attribute so
+// that the rest of the code does not require them
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) )
+#define NATRON_HALF_STORAGE_F16C
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+// Largest finite half float: the larger values, infinities and NaNs are never stored as half floats
+#define NATRON_HALF_STORAGE_MAX_VALUE 65504.f
+
+NATRON_NAMESPACE_ENTER
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+// Rounds to the nearest half float, ties to even, as the F16C instructions
+unsigned short
+floatToHalf(float value)
+{
+    U32 x;
+
+    std::memcpy( &x, &value, sizeof(U32) );
+    const U32 sign = (x >> 16) & 0x8000;
+    x &= 0x7fffffff;
+
+    if (x >= 0x47800000) {
+        // Out of range, infinite or NaN
+        return (unsigned short)( sign | ( (x > 0x7f800000) ? 0x7e00 : 0x7c00 ) );
+    }
+    if (x < 0x38800000) {
+        // Subnormal half float or zero: let the FPU round the mantissa by adding 0.5
+        float f;
+        std::memcpy( &f, &x, sizeof(U32) );
+        f += 0.5f;
+        std::memcpy( &x, &f, sizeof(U32) );
+
+        return (unsigned short)( sign | (x - 0x3f000000) );
+    }
+    // Normal half float: rebias the exponent and round the mantissa
+    const U32 mantissaOdd = (x >> 13) & 1;
+    x += 0xc8000fff + mantissaOdd; // ((15 - 127) << 23) + 0xfff
+
+    return (unsigned short)( sign | (x >> 13) );
+}
+
+float
+halfToFloat(unsigned short value)
+{
+    const U32 sign = (U32)(value & 0x8000) << 16;
+    const U32 exponent = value & 0x7c00;
+    const U32 mantissa = value & 0x03ff;
+    U32 x;
+
+    if (exponent == 0x7c00) {
+        x = sign | 0x7f800000 | (mantissa << 13);
+    } else if (exponent != 0) {
+        x = sign | ( ( (U32)(value & 0x7fff) << 13 ) + 0x38000000 );
+    } else {
+        // Zero or subnormal half float, exactly representable
+        float f = mantissa * (1.f / 16777216.f);
+        std::memcpy( &x, &f, sizeof(U32) );
+        x |= sign;
+    }
+    float ret;
+    std::memcpy( &ret, &x, sizeof(U32) );
+
+    return ret;
+}
+
+// The error is absolute, in units of the nominal [0,1] range of a color channel: it grows with the magnitude of the
+// values (a half float keeps 11 significant bits) and is negligible for the small and subnormal ones
+bool
+isWithinHalfErrorBound(float value,
+                       float roundTrip,
+                       float maxError)
+{
+    // Both comparisons are false for NaNs
+    return ( std::fabs(value) <= NATRON_HALF_STORAGE_MAX_VALUE ) && ( std::fabs(roundTrip - value) <= maxError );
+}
+
+/**
+ * @brief Converts count floats to half floats. Returns false as soon as a value exceeds the error bound.
+ **/
+bool
+floatsToHalfsScalar(const float* src,
+                    unsigned short* dst,
+                    U64 count,
+                    float maxError)
+{
+    for (U64 i = 0; i < count; ++i) {
+        dst[i] = floatToHalf(src[i]);
+        if ( !isWithinHalfErrorBound(src[i], halfToFloat(dst[i]), maxError) ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void
+halfsToFloatsScalar(const unsigned short* src,
+                    float* dst,
+                    U64 count)
+{
+    for (U64 i = 0; i < count; ++i) {
+        dst[i] = halfToFloat(src[i]);
+    }
+}
+
+#ifdef NATRON_HALF_STORAGE_F16C
+
+bool
+detectF16C()
+{
+    // The F16C instructions are VEX encoded: the OS support for AVX is also required
+    unsigned int eax, ebx, ecx, edx;
+
+    if ( !__builtin_cpu_supports("avx") || !__get_cpuid(1, &eax, &ebx, &ecx, &edx) ) {
+        return false;
+    }
+
+    return (ecx & bit_F16C) != 0;
+}
+
+bool
+isF16CSupported()
+{
+    static const bool supported = detectF16C();
+
+    return supported;
+}
+
+__attribute__( ( target("avx,f16c") ) )
+bool
+floatsToHalfsF16C(const float* src,
+                  unsigned short* dst,
+                  U64 count,
+                  float maxError)
+{
+    const __m256 signMask = _mm256_set1_ps(-0.f);
+    const __m256 maxErrorV = _mm256_set1_ps(maxError);
+    const __m256 maxValue = _mm256_set1_ps(NATRON_HALF_STORAGE_MAX_VALUE);
+    U64 i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        const __m256 v = _mm256_loadu_ps(src + i);
+        const __m128i h = _mm256_cvtps_ph(v, 0 /*round to nearest even*/);
+        _mm_storeu_si128( (__m128i*)(dst + i), h );
+        const __m256 absValue = _mm256_andnot_ps(signMask, v);
+        const __m256 error = _mm256_andnot_ps( signMask, _mm256_sub_ps(_mm256_cvtph_ps(h), v) );
+        // Both comparisons are false for NaNs
+        const __m256 withinBound = _mm256_cmp_ps(error, maxErrorV, _CMP_LE_OQ);
+        const __m256 inRange = _mm256_cmp_ps(absValue, maxValue, _CMP_LE_OQ);
+        if ( _mm256_movemask_ps( _mm256_and_ps(withinBound, inRange) ) != 0xff ) {
+            return false;
+        }
+    }
+
+    return floatsToHalfsScalar(src + i, dst + i, count - i, maxError);
+}
+
+__attribute__( ( target("avx,f16c") ) )
+void
+halfsToFloatsF16C(const unsigned short* src,
+                  float* dst,
+                  U64 count)
+{
+    U64 i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps( dst + i, _mm256_cvtph_ps( _mm_loadu_si128( (const __m128i*)(src + i) ) ) );
+    }
+    halfsToFloatsScalar(src + i, dst + i, count - i);
+}
+
+#endif // NATRON_HALF_STORAGE_F16C
+
+bool
+floatsToHalfs(const float* src,
+              unsigned short* dst,
+              U64 count,
+              float maxError)
+{
+#ifdef NATRON_HALF_STORAGE_F16C
+    if ( isF16CSupported() ) {
+        return floatsToHalfsF16C(src, dst, count, maxError);
+    }
+#endif
+
+    return floatsToHalfsScalar(src, dst, count, maxError);
+}
+
+void
+halfsToFloats(const unsigned short* src,
+              float* dst,
+              U64 count)
+{
+#ifdef NATRON_HALF_STORAGE_F16C
+    if ( isF16CSupported() ) {
+        halfsToFloatsF16C(src, dst, count);
+
+        return;
+    }
+#endif
+    halfsToFloatsScalar(src, dst, count);
+}
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+void
+Image::setHalfStorageAllowed(bool allowed,
+                             double maxError)
+{
+    QWriteLocker k(&_entryLock);
+
+    _halfStorageAllowed = allowed;
+    _halfStorageMaxError = (float)maxError;
+}
+
+void
+Image::registerWeakReference()
+{
+    QWriteLocker k(&_entryLock);
+
+    ++_weakReferencesCount;
+}
+
+void
+Image::unregisterWeakReference()
+{
+    QWriteLocker k(&_entryLock);
+
+    assert(_weakReferencesCount > 0);
+    --_weakReferencesCount;
+}
+
+bool
+Image::isStoredAsHalf() const
+{
+    QReadLocker k(&_entryLock);
+
+    return _halfData.size() > 0;
+}
+
+bool
+Image::compactMemory()
+{
+    std::size_t oldSize, newSize;
+    {
+        QWriteLocker k(&_entryLock);
+
+        // Only the color plane may be stored with a loss of precision: data planes such as motion vectors or depth
+        // are kept as is
+        if ( !_halfStorageAllowed || (_weakReferencesCount > 0) || (_halfData.size() > 0) || (_bitDepth != eImageBitDepthFloat) ||
+             ( getStorageMode() != eStorageModeRAM ) || ( _data.getStorageMode() != eStorageModeRAM ) || !_data.isAllocated() ||
+             !getComponents().isColorPlane() ) {
+            return false;
+        }
+
+        const U64 count = _data.size() / sizeof(float);
+        oldSize = _data.size() + _bitmap.getBounds().area();
+        _halfData.resize(count);
+        if ( !floatsToHalfs( (const float*)_data.readable(), _halfData.getData(), count, _halfStorageMaxError ) ) {
+            _halfData.clear();
+            // Do not try again until the image is rendered again
+            _halfStorageAllowed = false;
+
+            return false;
+        }
+        _data.deallocate();
+        newSize = count * sizeof(unsigned short) + _bitmap.getBounds().area();
+    }
+
+    if (_cache) {
+        _cache->notifyEntrySizeChanged(oldSize, newSize);
+    }
+
+    return true;
+}
+
+void
+Image::expandHalfStorage()
+{
+    // Called by allocateMemory() under the write lock, once the float buffer is allocated
+    assert( _halfData.size() > 0 && _data.isAllocated() );
+    assert( _data.size() == _halfData.size() * sizeof(float) );
+
+    halfsToFloats( _halfData.getData(), (float*)_data.writable(), _halfData.size() );
+
+    // allocateMemory() then notifies the cache of the size of the expanded image
+    std::size_t compactSize = _halfData.size() * sizeof(unsigned short) + _bitmap.getBounds().area();
+    _halfData.clear();
+    if (_cache) {
+        _cache->notifyEntrySizeChanged(compactSize, 0);
+    }
+}
+
+void
+Image::releaseHalfStorage()
+{
+    std::size_t compactSize;
+    {
+        QWriteLocker k(&_entryLock);
+        if (_halfData.size() == 0) {
+            return;
+        }
+        compactSize = _halfData.size() * sizeof(unsigned short) + _bitmap.getBounds().area();
+        _halfData.clear();
+    }
+
+    if (_cache) {
+        _cache->notifyEntryDestroyed(getTime(), compactSize, eStorageModeRAM);
+    }
+}
+
+NATRON_NAMESPACE_EXIT
@@ -0,0 +1,471 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Image.h"
+
+#include <algorithm> // min, max, sort
+#include <cassert>
+
+#include <QtCore/QDebug>
+
+NATRON_NAMESPACE_ENTER
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+/*
+ * Fused post-render pass.
+ *
+ * Each step of copyUnProcessedChannels, applyMaskMix and premultImage/unpremultImage only reads the pixel it
+ * writes and the pixels of the original and mask images at the same position, so they can be applied one
+ * after the other on each pixel instead of one after the other on the whole image, with the same results.
+ * The rows are cut in spans where the original and the mask images are either defined or not, so that the
+ * kernels are loops over contiguous memory without per-pixel lookups.
+ */
+
+enum PremultOpEnum
+{
+    ePremultOpNone = 0,
+    ePremultOpPremult,
+    ePremultOpUnpremult
+};
+
+struct PostRenderPixelSteps
+{
+    // copyUnProcessedChannels
+    bool copy;
+    bool doR, doG, doB, doA;
+    // applyMaskMix
+    bool maskMix;
+    bool masked;
+    bool maskInvert;
+    float mix;
+    // premultImage/unpremultImage
+    PremultOpEnum premultOp;
+};
+
+/**
+ * @brief Applies the steps on a span of count pixels. src is null if the original image is not defined on the span,
+ * mask is null if the mask image is not defined on the span.
+ **/
+template <typename PIX, int maxValue, int srcNComps, int dstNComps>
+void
+applyPostRenderStepsToSpan(PIX* dst,
+                           const PIX* src,
+                           const PIX* mask,
+                           int maskNComps,
+                           int count,
+                           const PostRenderPixelSteps& steps)
+{
+    for (int x = 0; x < count; ++x, dst += dstNComps) {
+        const PIX* srcPix = src ? src + x * srcNComps : 0;
+
+        if (steps.copy) {
+            // Same as copyUnProcessedChannels: just copy the channels
+            PIX srcA = srcPix ? maxValue : 0; /* be opaque for anything that doesn't contain alpha */
+            if ( ( (srcNComps == 1) || (srcNComps == 4) ) && srcPix ) {
+                srcA = srcPix[srcNComps - 1];
+            }
+            if (steps.doR) {
+                dst[0] = (!srcPix || 0 >= srcNComps) ? 0 : srcPix[0];
+            }
+            if (steps.doG) {
+                dst[1] = (!srcPix || 1 >= srcNComps) ? 0 : srcPix[1];
+            }
+            if (steps.doB) {
+                dst[2] = (!srcPix || 2 >= srcNComps) ? 0 : srcPix[2];
+            }
+            if (steps.doA) {
+                dst[dstNComps - 1] = srcA;
+            }
+        }
+
+        if (steps.maskMix) {
+            float alpha = steps.mix;
+            if (steps.masked) {
+                float maskScale;
+                if (!mask) {
+                    maskScale = steps.maskInvert ? 1.f : 0.f;
+                } else {
+                    maskScale = mask[x * maskNComps] * (1.f / maxValue);
+                    if (steps.maskInvert) {
+                        maskScale = 1.f - maskScale;
+                    }
+                }
+                alpha = steps.mix * maskScale;
+            }
+            if (srcPix) {
+                for (int c = 0; c < dstNComps && c < srcNComps; ++c) {
+                    float v = float(dst[c]) * alpha + (1.f - alpha) * float(srcPix[c]);
+                    dst[c] = Image::clampIfInt<PIX>(v);
+                }
+            } else {
+                for (int c = 0; c < dstNComps; ++c) {
+                    float v = float(dst[c]) * alpha;
+                    dst[c] = Image::clampIfInt<PIX>(v);
+                }
+            }
+        }
+
+        if (dstNComps == 4) {
+            if (steps.premultOp == ePremultOpPremult) {
+                for (int c = 0; c < 3; ++c) {
+                    dst[c] = PIX(float(dst[c]) * dst[3]);
+                }
+            } else if ( (steps.premultOp == ePremultOpUnpremult) && (dst[3] != 0) ) {
+                for (int c = 0; c < 3; ++c) {
+                    dst[c] = PIX( dst[c] / float(dst[3]) );
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Float RGBA kernel, used on the spans where the original image is defined, and the mask image if there
+ * is one. All the branches are resolved at compile time or turned into selects, so that the loop is
+ * vectorized by the compiler.
+ **/
+template <bool maskMix, bool masked, bool maskInvert, PremultOpEnum premultOp>
+void
+applyPostRenderStepsToSpanRGBAFloat(float* dst,
+                                    const float* src,
+                                    const float* mask,
+                                    int maskNComps,
+                                    int count,
+                                    const PostRenderPixelSteps& steps)
+{
+    const bool copyR = steps.copy && steps.doR;
+    const bool copyG = steps.copy && steps.doG;
+    const bool copyB = steps.copy && steps.doB;
+    const bool copyA = steps.copy && steps.doA;
+    const float mix = steps.mix;
+
+    for (int x = 0; x < count; ++x, dst += 4, src += 4) {
+        float r = copyR ? src[0] : dst[0];
+        float g = copyG ? src[1] : dst[1];
+        float b = copyB ? src[2] : dst[2];
+        float a = copyA ? src[3] : dst[3];
+
+        if (maskMix) {
+            float alpha = mix;
+            if (masked) {
+                float maskScale = mask[x * maskNComps];
+                if (maskInvert) {
+                    maskScale = 1.f - maskScale;
+                }
+                alpha = mix * maskScale;
+            }
+            r = r * alpha + (1.f - alpha) * src[0];
+            g = g * alpha + (1.f - alpha) * src[1];
+            b = b * alpha + (1.f - alpha) * src[2];
+            a = a * alpha + (1.f - alpha) * src[3];
+        }
+
+        if (premultOp == ePremultOpPremult) {
+            r = r * a;
+            g = g * a;
+            b = b * a;
+        } else if (premultOp == ePremultOpUnpremult) {
+            r = (a != 0) ? r / a : r;
+            g = (a != 0) ? g / a : g;
+            b = (a != 0) ? b / a : b;
+        }
+
+        dst[0] = r;
+        dst[1] = g;
+        dst[2] = b;
+        dst[3] = a;
+    }
+}
+
+template <bool maskMix, bool masked, bool maskInvert>
+void
+applyPostRenderStepsToSpanRGBAFloatForMaskInvert(float* dst,
+                                                 const float* src,
+                                                 const float* mask,
+                                                 int maskNComps,
+                                                 int count,
+                                                 const PostRenderPixelSteps& steps)
+{
+    switch (steps.premultOp) {
+    case ePremultOpNone:
+        applyPostRenderStepsToSpanRGBAFloat<maskMix, masked, maskInvert, ePremultOpNone>(dst, src, mask, maskNComps, count, steps);
+        break;
+    case ePremultOpPremult:
+        applyPostRenderStepsToSpanRGBAFloat<maskMix, masked, maskInvert, ePremultOpPremult>(dst, src, mask, maskNComps, count, steps);
+        break;
+    case ePremultOpUnpremult:
+        applyPostRenderStepsToSpanRGBAFloat<maskMix, masked, maskInvert, ePremultOpUnpremult>(dst, src, mask, maskNComps, count, steps);
+        break;
+    }
+}
+
+/**
+ * @brief Applies the steps on a span with a specialized kernel if there is one for these pixel types.
+ * Returns false if the span must go through applyPostRenderStepsToSpan.
+ **/
+template <typename PIX, int srcNComps, int dstNComps>
+bool
+applyPostRenderStepsToSpanSpecialized(PIX* /*dst*/,
+                               const PIX* /*src*/,
+                               const PIX* /*mask*/,
+                               int /*maskNComps*/,
+                               int /*count*/,
+                               const PostRenderPixelSteps& /*steps*/)
+{
+    return false;
+}
+
+template <>
+bool
+applyPostRenderStepsToSpanSpecialized<float, 4, 4>(float* dst,
+                                            const float* src,
+                                            const float* mask,
+                                            int maskNComps,
+                                            int count,
+                                            const PostRenderPixelSteps& steps)
+{
+    if (!src) {
+        return false;
+    }
+    if (!steps.maskMix) {
+        applyPostRenderStepsToSpanRGBAFloatForMaskInvert<false, false, false>(dst, src, mask, maskNComps, count, steps);
+    } else if (!steps.masked) {
+        applyPostRenderStepsToSpanRGBAFloatForMaskInvert<true, false, false>(dst, src, mask, maskNComps, count, steps);
+    } else if (!mask) {
+        return false;
+    } else if (steps.maskInvert) {
+        applyPostRenderStepsToSpanRGBAFloatForMaskInvert<true, true, true>(dst, src, mask, maskNComps, count, steps);
+    } else {
+        applyPostRenderStepsToSpanRGBAFloatForMaskInvert<true, true, false>(dst, src, mask, maskNComps, count, steps);
+    }
+
+    return true;
+}
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+template <typename PIX, int maxValue, int srcNComps, int dstNComps>
+void
+Image::applyPostRenderStepsForComponents(const RectI& roi,
+                                         const PostRenderSteps& steps)
+{
+    const Image* originalImg = steps.originalImage.get();
+    const Image* maskImg = (steps.maskMix && steps.masked) ? steps.maskImg : 0;
+    PostRenderPixelSteps pixelSteps;
+
+    pixelSteps.copy = steps.copyUnProcessedChannels;
+    pixelSteps.doR = !steps.processChannels[0] && (dstNComps >= 2);
+    pixelSteps.doG = !steps.processChannels[1] && (dstNComps >= 2);
+    pixelSteps.doB = !steps.processChannels[2] && (dstNComps >= 3);
+    pixelSteps.doA = !steps.processChannels[3] && (dstNComps == 1 || dstNComps == 4);
+    pixelSteps.maskMix = steps.maskMix;
+    pixelSteps.masked = steps.masked;
+    pixelSteps.maskInvert = steps.maskInvert;
+    pixelSteps.mix = steps.mix;
+    pixelSteps.premultOp = steps.premult ? ePremultOpPremult : (steps.unpremult ? ePremultOpUnpremult : ePremultOpNone);
+
+    const RectI srcBounds = originalImg ? originalImg->getBounds() : RectI();
+    const RectI maskBounds = maskImg ? maskImg->getBounds() : RectI();
+    const int maskNComps = maskImg ? (int)maskImg->getComponentsCount() : 0;
+    const int dstRowElements = dstNComps * _bounds.width();
+    PIX* dstRow = (PIX*)pixelAt(roi.x1, roi.y1);
+    assert(dstRow);
+
+    for (int y = roi.y1; y < roi.y2; ++y, dstRow += dstRowElements) {
+        // Find where the original and the mask images are defined on the row: outside they are handled as in
+        // the separate functions, where pixelAt returns NULL
+        int srcX1 = roi.x2, srcX2 = roi.x2;
+        const PIX* srcRow = 0;
+        if ( originalImg && (y >= srcBounds.y1) && (y < srcBounds.y2) ) {
+            int x1 = std::max(roi.x1, srcBounds.x1);
+            int x2 = std::min(roi.x2, srcBounds.x2);
+            if (x1 < x2) {
+                srcRow = (const PIX*)originalImg->pixelAt(x1, y);
+                if (srcRow) {
+                    srcX1 = x1;
+                    srcX2 = x2;
+                }
+            }
+        }
+        int maskX1 = roi.x2, maskX2 = roi.x2;
+        const PIX* maskRow = 0;
+        if ( maskImg && (y >= maskBounds.y1) && (y < maskBounds.y2) ) {
+            int x1 = std::max(roi.x1, maskBounds.x1);
+            int x2 = std::min(roi.x2, maskBounds.x2);
+            if (x1 < x2) {
+                maskRow = (const PIX*)maskImg->pixelAt(x1, y);
+                if (maskRow) {
+                    maskX1 = x1;
+                    maskX2 = x2;
+                }
+            }
+        }
+
+        int cuts[6] = { roi.x1, srcX1, srcX2, maskX1, maskX2, roi.x2 };
+        std::sort(cuts, cuts + 6);
+        for (int i = 0; i < 5; ++i) {
+            const int x1 = cuts[i];
+            const int x2 = cuts[i + 1];
+            if (x1 >= x2) {
+                continue;
+            }
+            PIX* dst = dstRow + (x1 - roi.x1) * dstNComps;
+            const PIX* src = (srcRow && x1 >= srcX1 && x1 < srcX2) ? srcRow + (x1 - srcX1) * srcNComps : 0;
+            const PIX* mask = (maskRow && x1 >= maskX1 && x1 < maskX2) ? maskRow + (x1 - maskX1) * maskNComps : 0;
+            if ( !applyPostRenderStepsToSpanSpecialized<PIX, srcNComps, dstNComps>(dst, src, mask, maskNComps, x2 - x1, pixelSteps) ) {
+                applyPostRenderStepsToSpan<PIX, maxValue, srcNComps, dstNComps>(dst, src, mask, maskNComps, x2 - x1, pixelSteps);
+            }
+        }
+    }
+} // Image::applyPostRenderStepsForComponents
+
+template <typename PIX, int maxValue, int srcNComps>
+void
+Image::applyPostRenderStepsForSrcComponents(const RectI& roi,
+                                            const PostRenderSteps& steps)
+{
+    switch ( getComponentsCount() ) {
+    case 1:
+        applyPostRenderStepsForComponents<PIX, maxValue, srcNComps, 1>(roi, steps);
+        break;
+    case 2:
+        applyPostRenderStepsForComponents<PIX, maxValue, srcNComps, 2>(roi, steps);
+        break;
+    case 3:
+        applyPostRenderStepsForComponents<PIX, maxValue, srcNComps, 3>(roi, steps);
+        break;
+    case 4:
+        applyPostRenderStepsForComponents<PIX, maxValue, srcNComps, 4>(roi, steps);
+        break;
+    default:
+        assert(false);
+        break;
+    }
+}
+
+template <typename PIX, int maxValue>
+void
+Image::applyPostRenderStepsForDepth(const RectI& roi,
+                                    const PostRenderSteps& steps)
+{
+    int srcNComps = steps.originalImage ? (int)steps.originalImage->getComponentsCount() : 0;
+
+    switch (srcNComps) {
+    case 0:
+        applyPostRenderStepsForSrcComponents<PIX, maxValue, 0>(roi, steps);
+        break;
+    case 1:
+        applyPostRenderStepsForSrcComponents<PIX, maxValue, 1>(roi, steps);
+        break;
+    case 2:
+        applyPostRenderStepsForSrcComponents<PIX, maxValue, 2>(roi, steps);
+        break;
+    case 3:
+        applyPostRenderStepsForSrcComponents<PIX, maxValue, 3>(roi, steps);
+        break;
+    case 4:
+        applyPostRenderStepsForSrcComponents<PIX, maxValue, 4>(roi, steps);
+        break;
+    default:
+        assert(false);
+        break;
+    }
+}
+
+void
+Image::applyPostRenderSteps(const RectI& roi,
+                            const PostRenderSteps& steps,
+                            const OSGLContextPtr& glContext)
+{
+    assert( !(steps.premult && steps.unpremult) );
+    const Image* originalImg = steps.originalImage.get();
+
+    // Keep only the steps that have an effect, with the same conditions as the separate functions
+    PostRenderSteps fused = steps;
+    fused.copyUnProcessedChannels = steps.copyUnProcessedChannels && canCallCopyUnProcessedChannels(steps.processChannels);
+    fused.maskMix = steps.maskMix && originalImg && ( steps.masked || (steps.mix != 1) );
+    fused.premult = steps.premult && (getComponentsCount() == 4);
+    fused.unpremult = steps.unpremult && (getComponentsCount() == 4);
+
+    const int nSteps = (int)fused.copyUnProcessedChannels + (int)fused.maskMix + (int)(fused.premult || fused.unpremult);
+    const ImageBitDepthEnum depth = getBitDepth();
+    const bool canFuse = (nSteps > 1) &&
+                         ( getStorageMode() != eStorageModeGLTex ) &&
+                         ( (depth == eImageBitDepthByte) || (depth == eImageBitDepthShort) || (depth == eImageBitDepthFloat) ) &&
+                         // copyUnProcessedChannels only warns in that case
+                         ( !fused.copyUnProcessedChannels || !originalImg || ( getMipMapLevel() == originalImg->getMipMapLevel() ) );
+
+    if (!canFuse) {
+        // A single pass anyway
+        if (steps.copyUnProcessedChannels) {
+            copyUnProcessedChannels(roi, steps.outputPremult, steps.originalImagePremult, steps.processChannels, steps.originalImage, steps.ignorePremult, glContext);
+        }
+        if (steps.maskMix) {
+            applyMaskMix(roi, steps.maskImg, originalImg, steps.masked, steps.maskInvert, steps.mix, glContext);
+        }
+        if (fused.premult) {
+            premultImage(roi);
+        } else if (fused.unpremult) {
+            unpremultImage(roi);
+        }
+
+        return;
+    }
+
+    QWriteLocker k(&_entryLock);
+    boost::scoped_ptr<QReadLocker> originalLock;
+    boost::scoped_ptr<QReadLocker> maskLock;
+    if (originalImg) {
+        originalLock.reset( new QReadLocker(&originalImg->_entryLock) );
+    }
+    if (fused.maskMix && fused.maskImg) {
+        maskLock.reset( new QReadLocker(&fused.maskImg->_entryLock) );
+    }
+
+    assert( !originalImg || getBitDepth() == originalImg->getBitDepth() );
+    assert( !fused.maskMix || !fused.masked || !fused.maskImg || fused.maskImg->getComponents() == ImagePlaneDesc::getAlphaComponents() );
+
+    RectI realRoI;
+    if ( !roi.intersect(_bounds, &realRoI) ) {
+        return;
+    }
+
+    switch (depth) {
+    case eImageBitDepthByte:
+        applyPostRenderStepsForDepth<unsigned char, 255>(realRoI, fused);
+        break;
+    case eImageBitDepthShort:
+        applyPostRenderStepsForDepth<unsigned short, 65535>(realRoI, fused);
+        break;
+    case eImageBitDepthFloat:
+        applyPostRenderStepsForDepth<float, 1>(realRoI, fused);
+        break;
+    default:
+        assert(false);
+        break;
+    }
+} // applyPostRenderSteps
+
+NATRON_NAMESPACE_EXIT
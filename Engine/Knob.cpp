@@ -1194,6 +1194,70 @@ KnobHelper::cloneCurve(ViewSpec view,
     }
 }
 
+void
+KnobHelper::setKeyFrames(const std::vector<KeyFrame>& keys,
+                         ViewSpec view,
+                         int dimension,
+                         ValueChangedReasonEnum reason)
+{
+    if ( ( dimension >= (int)_imp->curves.size() ) || (dimension < 0) ) {
+        throw std::invalid_argument("KnobHelper::setKeyFrames(): Dimension out of range");
+    }
+    if ( dynamic_cast<AnimatingKnobStringHelper*>(this) ) {
+        throw std::invalid_argument("KnobHelper::setKeyFrames(): Not supported on string parameters");
+    }
+    if ( !canAnimate() || !isAnimationEnabled() ) {
+        return;
+    }
+
+    CurvePtr curve;
+    KnobGuiIPtr hasGui = getKnobGuiPointer();
+    bool useGuiCurve = _imp->shouldUseGuiCurve();
+    if (!useGuiCurve) {
+        curve = _imp->curves[dimension];
+    } else {
+        assert(hasGui);
+        curve = hasGui->getCurve(view, dimension);
+        setGuiCurveHasChanged(view, dimension, true);
+    }
+    assert(curve);
+
+    const bool clampToIntegers = curve->areKeyFramesValuesClampedToIntegers();
+    const bool clampToBooleans = curve->areKeyFramesValuesClampedToBooleans();
+    std::vector<KeyFrame> clampedKeys;
+    std::list<double> times;
+    clampedKeys.reserve( keys.size() );
+    for (std::vector<KeyFrame>::const_iterator it = keys.begin(); it != keys.end(); ++it) {
+        KeyFrame k(*it);
+        if (clampToIntegers) {
+            k.setValue( std::floor(k.getValue() + 0.5) );
+        } else if (clampToBooleans) {
+            k.setValue( (bool)k.getValue() );
+        }
+        clampedKeys.push_back(k);
+        times.push_back( k.getTime() );
+    }
+    if ( clampedKeys.empty() ) {
+        return;
+    }
+
+    curve->addKeyFrames(clampedKeys);
+
+    if (_imp->holder) {
+        _imp->holder->setHasAnimation(true);
+    }
+    if (!useGuiCurve) {
+        checkAnimationLevel(view, dimension);
+        evaluateValueChange(dimension, getCurrentTime(), view, reason);
+        guiCurveCloneInternalCurve(eCurveChangeReasonInternal, view, dimension, reason);
+    }
+
+    if (_signalSlotHandler) {
+        _signalSlotHandler->s_redrawGuiCurve(eCurveChangeReasonInternal, view, dimension);
+        _signalSlotHandler->s_multipleKeyFramesSet(times, view, dimension, (int)reason);
+    }
+} // KnobHelper::setKeyFrames
+
 bool
 KnobHelper::setInterpolationAtTime(CurveChangeReason reason,
                                    ViewSpec view,
@@ -4652,6 +4716,22 @@ KnobHelper::getAllExpressionDependenciesRecursive(std::set<NodePtr>& nodes) cons
     }
 }
 
+U64
+KnobHelper::getExpressionDependenciesAge() const
+{
+    std::set<NodePtr> nodes;
+
+    getAllExpressionDependenciesRecursive(nodes);
+
+    Hash64 hash;
+    for (std::set<NodePtr>::const_iterator it = nodes.begin(); it != nodes.end(); ++it) {
+        hash.append( (*it)->getKnobsAge() );
+    }
+    hash.computeHash();
+
+    return hash.value();
+}
+
 /***************************KNOB HOLDER******************************************/
 
 struct KnobHolder::KnobHolderPrivate
@@ -4681,6 +4761,9 @@ struct KnobHolder::KnobHolderPrivate
     int nbSignificantChangesDuringEvaluationBlock;
     int nbChangesDuringEvaluationBlock;
     int nbChangesRequiringMetadataRefresh;
+
+    // True while the changes of this holder are recorded by a change transaction of the app
+    bool changesDeferred;
     QMutex knobsFrozenMutex;
     bool knobsFrozen;
     mutable QMutex hasAnimationMutex;
@@ -4706,6 +4789,7 @@ struct KnobHolder::KnobHolderPrivate
         , nbSignificantChangesDuringEvaluationBlock(0)
         , nbChangesDuringEvaluationBlock(0)
         , nbChangesRequiringMetadataRefresh(0)
+        , changesDeferred(false)
         , knobsFrozenMutex()
         , knobsFrozen(false)
         , hasAnimationMutex()
@@ -4734,6 +4818,7 @@ struct KnobHolder::KnobHolderPrivate
     , nbSignificantChangesDuringEvaluationBlock(0)
     , nbChangesDuringEvaluationBlock(0)
     , nbChangesRequiringMetadataRefresh(0)
+    , changesDeferred(false)
     , knobsFrozenMutex()
     , knobsFrozen(false)
     , hasAnimationMutex()
@@ -5503,6 +5588,16 @@ KnobHolder::endChanges(bool discardRendering)
     {
         QMutexLocker l(&_imp->evaluationBlockedMutex);
 
+        if (isMT && _imp->changesDeferred) {
+            // The app records a change transaction: keep the changes and the counters,
+            // the handlers and the evaluation will run once when it is committed.
+            if (_imp->evaluationBlocked > 0) {
+                --_imp->evaluationBlocked;
+            }
+
+            return false;
+        }
+
         knobChanged = _imp->knobChanged;
         for (KnobChanges::iterator it = knobChanged.begin(); it != knobChanged.end(); ++it) {
             if ( it->knob->getEvaluateOnChange() ) {
@@ -5648,6 +5743,8 @@ KnobHolder::appendValueChange(const KnobIPtr& knob,
     if ( isInitializingKnobs() ) {
         return;
     }
+    bool isMT = QThread::currentThread() == qApp->thread();
+    bool significant = knob->getEvaluateOnChange();
     {
         QMutexLocker l(&_imp->evaluationBlockedMutex);
         KnobChange* foundChange = 0;
@@ -5666,7 +5763,7 @@ KnobHolder::appendValueChange(const KnobIPtr& knob,
 
         foundChange->reason = reason;
         foundChange->originalReason = originalReason;
-        foundChange->originatedFromMainThread = QThread::currentThread() == qApp->thread();
+        foundChange->originatedFromMainThread = isMT;
         foundChange->refreshGui |= refreshGui;
         foundChange->time = time;
         foundChange->view = view;
@@ -5684,7 +5781,7 @@ KnobHolder::appendValueChange(const KnobIPtr& knob,
             ++_imp->nbChangesRequiringMetadataRefresh;
         }
 
-        if ( knob->getEvaluateOnChange() ) {
+        if (significant) {
             ++_imp->nbSignificantChangesDuringEvaluationBlock;
         }
         ++_imp->nbChangesDuringEvaluationBlock;
@@ -5696,8 +5793,31 @@ KnobHolder::appendValueChange(const KnobIPtr& knob,
             return;
            }*/
     }
+
+    if (isMT) {
+        AppInstancePtr app = getApp();
+        if (app) {
+            app->deferHolderChanges(this, significant);
+        }
+    }
 } // KnobHolder::appendValueChange
 
+void
+KnobHolder::setChangesDeferred(bool deferred)
+{
+    QMutexLocker l(&_imp->evaluationBlockedMutex);
+
+    _imp->changesDeferred = deferred;
+}
+
+bool
+KnobHolder::areChangesDeferred() const
+{
+    QMutexLocker l(&_imp->evaluationBlockedMutex);
+
+    return _imp->changesDeferred;
+}
+
 void
 KnobHolder::beginChanges()
 {
@@ -593,6 +593,15 @@ public:
      **/
     virtual void cloneCurve(ViewSpec view, int dimension, const Curve& curve) = 0;
 
+    /**
+     * @brief Adds all the given keyframes to the animation curve at the given dimension, replacing the existing
+     * keyframes at the same times. The value change is evaluated and the keyframes are notified only once,
+     * which makes it much faster than calling setValueAtTime for each keyframe.
+     * Values are clamped to integers or booleans like in setValueAtTime.
+     * This is not supported on string parameters.
+     **/
+    virtual void setKeyFrames(const std::vector<KeyFrame>& keys, ViewSpec view, int dimension, ValueChangedReasonEnum reason) = 0;
+
     /**
      * @brief Changes the interpolation type for the given keyframe
      **/
@@ -1152,6 +1161,13 @@ public:
                              const KnobIPtr& listener) = 0;
     virtual void getAllExpressionDependenciesRecursive(std::set<NodePtr>& nodes) const = 0;
 
+    /**
+     * @brief Returns a value that changes whenever one of the nodes holding the knobs the expressions of this knob
+     * depend on (directly or through other expressions) has its knobs age changed.
+     * Used to know whether values sampled from the expressions are still valid.
+     **/
+    virtual U64 getExpressionDependenciesAge() const = 0;
+
 private:
     virtual void removeListener(KnobI* listener, int listenerDimension) = 0;
 
@@ -1412,6 +1428,7 @@ private:
 public:
 
     virtual void cloneCurve(ViewSpec view, int dimension, const Curve& curve) OVERRIDE FINAL;
+    virtual void setKeyFrames(const std::vector<KeyFrame>& keys, ViewSpec view, int dimension, ValueChangedReasonEnum reason) OVERRIDE FINAL;
     virtual bool setInterpolationAtTime(CurveChangeReason reason, ViewSpec view, int dimension, double time, KeyframeTypeEnum interpolation, KeyFrame* newKey) OVERRIDE FINAL;
     virtual bool moveDerivativesAtTime(CurveChangeReason reason, ViewSpec view, int dimension, double time, double left, double right)  OVERRIDE FINAL WARN_UNUSED_RETURN;
     virtual bool moveDerivativeAtTime(CurveChangeReason reason, ViewSpec view, int dimension, double time, double derivative, bool isLeft) OVERRIDE FINAL WARN_UNUSED_RETURN;
@@ -1607,6 +1624,7 @@ public:
     virtual void addListener(bool isFromExpr, int fromExprDimension, int thisDimension, const KnobIPtr& knob) OVERRIDE FINAL;
     virtual void removeListener(KnobI* listener, int listenerDimension) OVERRIDE FINAL;
     virtual void getAllExpressionDependenciesRecursive(std::set<NodePtr>& nodes) const OVERRIDE FINAL;
+    virtual U64 getExpressionDependenciesAge() const OVERRIDE FINAL;
     virtual void getListeners(KnobI::ListenerDimsMap& listeners) const OVERRIDE FINAL;
     virtual void clearExpressionsResults(int /*dimension*/) OVERRIDE {}
 
@@ -2568,6 +2586,13 @@ public:
     // Returns true if at least 1 knob changed handler was called
     bool endChanges(bool discardEverything = false);
 
+    /**
+     * @brief Set by the app while a change transaction records the changes of this holder: endChanges()
+     * then keeps the changes until the transaction is committed.
+     **/
+    void setChangesDeferred(bool deferred);
+    bool areChangesDeferred() const;
+
 
     /**
      * @brief The virtual portion of notifyProjectBeginValuesChanged(). This is called by the project
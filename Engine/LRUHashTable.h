@@ -42,7 +42,9 @@
 //ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
 //OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 
+#include <cassert>
 #include <map>
+#include <set>
 #include <list>
 #include <utility>
 #if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
@@ -95,6 +97,258 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
  *
  **/
 
+/**
+ * @brief Priority queue implementing the GreedyDual-Size replacement policy, used by the LRU hash
+ * tables below when cost-aware eviction is enabled.
+ * Each key gets a priority H = L + cost / size, where cost is the time it took to compute the entries
+ * of the key and L is an inflation value set to the priority of the last evicted key: entries that
+ * have not been accessed for a long time eventually get evicted even if they are expensive to recompute.
+ * The key with the lowest priority is evicted first.
+ * The cost of an entry is only known once it has been computed, which is after it was inserted,
+ * hence priorities are refreshed lazily when keys reach the front of the queue.
+ *
+ * The values stored in the table must provide getRecomputeCost() and size().
+ **/
+template <typename K>
+class GreedyDualSizeIndex
+{
+    struct Record
+    {
+        double priority;
+        double inflation;
+        double costPerByte;
+    };
+
+    typedef std::set<std::pair<double, K> > queue_type;
+    typedef std::map<K, Record> record_map;
+
+public:
+
+    typedef typename queue_type::const_iterator const_iterator;
+
+    GreedyDualSizeIndex()
+        : _queue()
+        , _records()
+        , _inflation(0.)
+    {
+    }
+
+    template <typename LIST>
+    static double getCostPerByte(const LIST& values)
+    {
+        double cost = 0.;
+        double size = 0.;
+
+        for (typename LIST::const_iterator it = values.begin(); it != values.end(); ++it) {
+            cost += (*it)->getRecomputeCost();
+            size += (double)(*it)->size();
+        }
+
+        return size > 0. ? cost / size : 0.;
+    }
+
+    // Lowest priority first
+    const_iterator begin() const
+    {
+        return _queue.begin();
+    }
+
+    const_iterator end() const
+    {
+        return _queue.end();
+    }
+
+    // Must be called whenever the key is inserted or accessed
+    template <typename LIST>
+    void touch(const K & k,
+               const LIST& values)
+    {
+        remove(k);
+        insertRecord( k, _inflation, getCostPerByte(values) );
+    }
+
+    /**
+     * @brief Re-evaluates the cost of the entries of the key pointed to by it. If they became more
+     * expensive since the key was last touched, the key is moved further in the queue, its new position is
+     * returned in newPos and this function returns true. In that case it is no longer valid.
+     **/
+    template <typename LIST>
+    bool refresh(const_iterator it,
+                 const LIST& values,
+                 const_iterator* newPos)
+    {
+        typename record_map::iterator found = _records.find(it->second);
+
+        assert( found != _records.end() );
+        double costPerByte = getCostPerByte(values);
+        if (costPerByte <= found->second.costPerByte) {
+            return false;
+        }
+        K k = it->second;
+        double inflation = found->second.inflation;
+        _queue.erase(it);
+        _records.erase(found);
+        *newPos = insertRecord(k, inflation, costPerByte);
+
+        return true;
+    }
+
+    // Must be called with the key that is about to be evicted
+    void setInflationFromEvicted(const_iterator it)
+    {
+        _inflation = it->first;
+    }
+
+    void remove(const K & k)
+    {
+        typename record_map::iterator found = _records.find(k);
+
+        if ( found != _records.end() ) {
+            _queue.erase( std::make_pair(found->second.priority, k) );
+            _records.erase(found);
+        }
+    }
+
+    void clear()
+    {
+        _queue.clear();
+        _records.clear();
+        _inflation = 0.;
+    }
+
+private:
+
+    const_iterator insertRecord(const K & k,
+                                double inflation,
+                                double costPerByte)
+    {
+        Record r;
+
+        r.priority = inflation + costPerByte;
+        r.inflation = inflation;
+        r.costPerByte = costPerByte;
+        _records.insert( std::make_pair(k, r) );
+
+        return _queue.insert( std::make_pair(r.priority, k) ).first;
+    }
+
+    queue_type _queue;
+    record_map _records;
+    double _inflation;
+};
+
+/**
+ * @brief Base class of the LRU hash tables below holding the GreedyDual-Size bookkeeping shared by
+ * all of them, see GreedyDualSizeIndex.
+ * TABLE is the derived table (curiously recurring template) and must provide, possibly as private
+ * members if it declares this class as a friend:
+ * - std::list<V>* findValues(const K& k): the entries of k or NULL
+ * - void eraseKey(const K& k): removes k and its entries from the table
+ * - void indexEntriesByCost(): calls onKeyTouched() for every key, from the least to the most recently used
+ * Derived tables must call onKeyTouched() whenever a key is inserted or accessed and onKeyErased()
+ * whenever a key is removed.
+ **/
+template <typename TABLE, typename K, typename V>
+class CostAwareLRUHashTableBase
+{
+    typedef GreedyDualSizeIndex<K> index_type;
+
+public:
+
+    /**
+     * @brief When enabled, evict() uses the GreedyDual-Size policy instead of evicting the least
+     * recently used entry. See GreedyDualSizeIndex.
+     **/
+    void setCostAwareEvictionEnabled(bool enabled)
+    {
+        if (enabled == _costAware) {
+            return;
+        }
+        _costAware = enabled;
+        _costIndex.clear();
+        if (enabled) {
+            static_cast<TABLE*>(this)->indexEntriesByCost();
+        }
+    }
+
+    bool isCostAwareEvictionEnabled() const
+    {
+        return _costAware;
+    }
+
+protected:
+
+    CostAwareLRUHashTableBase()
+        : _costIndex()
+        , _costAware(false)
+    {
+    }
+
+    void onKeyTouched(const K & k,
+                      const std::list<V>& values)
+    {
+        if (_costAware) {
+            _costIndex.touch(k, values);
+        }
+    }
+
+    void onKeyErased(const K & k)
+    {
+        if (_costAware) {
+            _costIndex.remove(k);
+        }
+    }
+
+    void clearCostIndex()
+    {
+        _costIndex.clear();
+    }
+
+    // Purge the entry with the lowest GreedyDual-Size priority that is not referenced outside of the table
+    std::pair<K, V> evictLowestPriority()
+    {
+        TABLE* table = static_cast<TABLE*>(this);
+        typename index_type::const_iterator it = _costIndex.begin();
+
+        while ( it != _costIndex.end() ) {
+            std::list<V>* values = table->findValues(it->second);
+            assert(values);
+            typename index_type::const_iterator next = it;
+            ++next;
+            typename index_type::const_iterator moved;
+            if ( _costIndex.refresh(it, *values, &moved) ) {
+                // The entries became more expensive since they were last accessed, carry on from the
+                // lowest priority key
+                it = ( next == _costIndex.end() || *moved < *next ) ? moved : next;
+                continue;
+            }
+            for (typename std::list<V>::iterator it2 = values->begin(); it2 != values->end(); ++it2) {
+                if (it2->use_count() == 1) {
+                    std::pair<K, V> ret = std::make_pair(it->second, *it2);
+                    _costIndex.setInflationFromEvicted(it);
+                    if (values->size() == 1) {
+                        _costIndex.remove(ret.first);
+                        table->eraseKey(ret.first);
+                    } else {
+                        values->erase(it2);
+                    }
+
+                    return ret;
+                }
+            }
+            ++it;
+        }
+
+        return std::make_pair( K(), V() );
+    }
+
+private:
+
+    // Eviction order of the keys for the cost-aware policy
+    index_type _costIndex;
+    bool _costAware;
+};
+
 #ifdef USE_VARIADIC_TEMPLATES // c++11 is defined as well as unordered_map
 
 #  ifndef NATRON_CACHE_USE_BOOST
@@ -131,6 +385,12 @@ public:
     {
     }
 
+    // Find the value of k without updating the access record
+    typename key_to_value_type::iterator find(const key_type & k)
+    {
+        return _key_to_value.find(k);
+    }
+
     // Obtain value of the cached function for k
     typename key_to_value_type::iterator operator()(const key_type & k)
     {
@@ -250,6 +510,12 @@ public:
     {
     }
 
+    // Find the value of k without updating the access record
+    typename container_type::left_iterator find(const key_type & k)
+    {
+        return _container.left.find(k);
+    }
+
     // Obtain value of the cached function for k
     typename container_type::left_iterator operator()(const key_type & k)
     {
@@ -350,10 +616,13 @@ private:
 #  ifndef NATRON_CACHE_USE_BOOST
 template <typename K, typename V>
 class StlLRUHashTable
+    : public CostAwareLRUHashTableBase<StlLRUHashTable<K, V>, K, V>
 {
+    friend class CostAwareLRUHashTableBase<StlLRUHashTable<K, V>, K, V>;
+
 public:
     typedef K key_type;
-    typedef V value_type;
+    typedef std::list<V> value_type;
     // Key access history, most recent at back
     typedef std::list<key_type> key_tracker_type;
     // Key to value and key history iterator
@@ -362,9 +631,18 @@ public:
     // Constuctor specifies the cached function and
     // the maximum number of records to be stored
     StlLRUHashTable()
+        : CostAwareLRUHashTableBase<StlLRUHashTable<K, V>, K, V>()
+        , _key_tracker()
+        , _key_to_value()
     {
     }
 
+    // Find the value of k without updating the access record
+    typename key_to_value_type::iterator find(const key_type & k)
+    {
+        return _key_to_value.find(k);
+    }
+
     // Obtain value of the cached function for k
     typename key_to_value_type::iterator operator()(const key_type & k)
     {
@@ -375,6 +653,7 @@ public:
             // Update access record by moving
             // accessed key to back of list
             _key_tracker.splice(_key_tracker.end(), _key_tracker, (*it).second.second);
+            this->onKeyTouched(k, it->second.first);
         }
 
         return it;
@@ -382,6 +661,7 @@ public:
 
     void erase(typename key_to_value_type::iterator it)
     {
+        this->onKeyErased(it->first);
         _key_tracker.erase(it->second.second);
         _key_to_value.erase(it);
     }
@@ -401,15 +681,17 @@ public:
     {
         typename key_tracker_type::iterator it = _key_tracker.insert(_key_tracker.end(), k);
         _key_to_value.insert( std::make_pair( k, std::make_pair(list, it) ) );
+        this->onKeyTouched(k, list);
     }
 
     // Record a fresh key-value pair in the cache
     void insert(const key_type & k,
-                const value_type & v)
+                const V & v)
     {
         typename key_to_value_type::iterator found =  _key_to_value.find(k);
         if ( found != _key_to_value.end() ) {
             found->second.first.push_back(v);
+            this->onKeyTouched(k, found->second.first);
         } else {
             value_type list;
             list.push_back(v);
@@ -417,6 +699,7 @@ public:
             // linked to the usage record.
             typename key_tracker_type::iterator it = _key_tracker.insert(_key_tracker.end(), k);
             _key_to_value.insert( std::make_pair( k, std::make_pair(list, it) ) );
+            this->onKeyTouched(k, list);
         }
     }
 
@@ -424,6 +707,7 @@ public:
     {
         _key_to_value.clear();
         _key_tracker.clear();
+        this->clearCostIndex();
     }
 
     // Purge the least-recently-used element in the cache
@@ -431,6 +715,9 @@ public:
     {
         // Assert method is never called when cache is empty
         assert( !_key_tracker.empty() );
+        if ( this->isCostAwareEvictionEnabled() ) {
+            return this->evictLowestPriority();
+        }
         // Identify least recently used key
         const typename key_to_value_type::iterator it  = _key_to_value.find( _key_tracker.front() );
         for (typename std::list<V>::iterator it2 = it->second.first.begin();
@@ -459,6 +746,31 @@ public:
     }
 
 private:
+
+    value_type* findValues(const key_type & k)
+    {
+        typename key_to_value_type::iterator found = _key_to_value.find(k);
+
+        return found == _key_to_value.end() ? NULL : &found->second.first;
+    }
+
+    void eraseKey(const key_type & k)
+    {
+        typename key_to_value_type::iterator found = _key_to_value.find(k);
+
+        if ( found != _key_to_value.end() ) {
+            _key_tracker.erase(found->second.second);
+            _key_to_value.erase(found);
+        }
+    }
+
+    void indexEntriesByCost()
+    {
+        for (typename key_tracker_type::iterator it = _key_tracker.begin(); it != _key_tracker.end(); ++it) {
+            this->onKeyTouched(*it, _key_to_value[*it].first);
+        }
+    }
+
     // Key access history
     key_tracker_type _key_tracker;
 
@@ -471,16 +783,27 @@ private:
 #    ifdef NATRON_CACHE_USE_HASH
 template <typename K, typename V>
 class BoostLRUHashTable
+    : public CostAwareLRUHashTableBase<BoostLRUHashTable<K, V>, K, V>
 {
+    friend class CostAwareLRUHashTableBase<BoostLRUHashTable<K, V>, K, V>;
+
 public:
     typedef K key_type;
     typedef std::list<V> value_type;
     typedef boost::bimaps::bimap<boost::bimaps::unordered_set_of<key_type>, boost::bimaps::list_of<value_type> > container_type;
 
     BoostLRUHashTable()
+        : CostAwareLRUHashTableBase<BoostLRUHashTable<K, V>, K, V>()
+        , _container()
     {
     }
 
+    // Find the value of k without updating the access record
+    typename container_type::left_iterator find(const key_type & k)
+    {
+        return _container.left.find(k);
+    }
+
     typename container_type::left_iterator operator()(const key_type & k)
     {
         // Attempt to find existing record
@@ -489,6 +812,7 @@ public:
             // We do have it:
             // Update the access record view.
             _container.right.relocate( _container.right.end(), _container.project_right(it) );
+            this->onKeyTouched(k, it->second);
         }
 
         return it;
@@ -496,6 +820,7 @@ public:
 
     void erase(typename container_type::left_iterator it)
     {
+        this->onKeyErased(it->first);
         _container.left.erase(it);
     }
 
@@ -515,6 +840,7 @@ public:
                 const value_type& list)
     {
         _container.insert( typename container_type::value_type(k, list) );
+        this->onKeyTouched(k, list);
     }
 
     void insert(const key_type & k,
@@ -526,20 +852,26 @@ public:
         typename container_type::left_iterator found = this->operator ()(k);
         if ( found != _container.left.end() ) {
             found->second.push_back(v);
+            this->onKeyTouched(k, found->second);
         } else {
             value_type list;
             list.push_back(v);
             _container.insert( typename container_type::value_type(k, list) );
+            this->onKeyTouched(k, list);
         }
     }
 
     void clear()
     {
         _container.clear();
+        this->clearCostIndex();
     }
 
     std::pair<key_type, V> evict()
     {
+        if ( this->isCostAwareEvictionEnabled() ) {
+            return this->evictLowestPriority();
+        }
         typename container_type::right_iterator it = _container.right.begin();
         while ( it != _container.right.end() ) {
             for (typename std::list<V>::iterator it2 = it->first.begin(); it2 != it->first.end(); ++it2) {
@@ -566,6 +898,27 @@ public:
     }
 
 private:
+
+    value_type* findValues(const key_type & k)
+    {
+        typename container_type::left_iterator found = _container.left.find(k);
+
+        return found == _container.left.end() ? NULL : &found->second;
+    }
+
+    void eraseKey(const key_type & k)
+    {
+        _container.left.erase(k);
+    }
+
+    void indexEntriesByCost()
+    {
+        // From the least to the most recently used
+        for (typename container_type::right_iterator it = _container.right.begin(); it != _container.right.end(); ++it) {
+            this->onKeyTouched(it->second, it->first);
+        }
+    }
+
     container_type _container;
 };
 
@@ -573,14 +926,25 @@ private:
 
 template <typename K, typename V>
 class BoostLRUHashTable
+    : public CostAwareLRUHashTableBase<BoostLRUHashTable<K, V>, K, V>
 {
+    friend class CostAwareLRUHashTableBase<BoostLRUHashTable<K, V>, K, V>;
+
 public:
     typedef K key_type;
-    typedef V value_type;
+    typedef std::list<V> value_type;
     typedef boost::bimaps::bimap<boost::bimaps::set_of<key_type>, boost::bimaps::list_of<value_type> > container_type;
 
     BoostLRUHashTable()
+        : CostAwareLRUHashTableBase<BoostLRUHashTable<K, V>, K, V>()
+        , _container()
+    {
+    }
+
+    // Find the value of k without updating the access record
+    typename container_type::left_iterator find(const key_type & k)
     {
+        return _container.left.find(k);
     }
 
     typename container_type::left_iterator operator()(const key_type & k)
@@ -591,6 +955,7 @@ public:
             // We do have it:
             // Update the access record view.
             _container.right.relocate( _container.right.end(), _container.project_right(it) );
+            this->onKeyTouched(k, it->second);
         }
 
         return it;
@@ -598,6 +963,7 @@ public:
 
     void erase(typename container_type::left_iterator it)
     {
+        this->onKeyErased(it->first);
         _container.left.erase(it);
     }
 
@@ -617,6 +983,7 @@ public:
                 const value_type& list)
     {
         _container.insert( typename container_type::value_type(k, list) );
+        this->onKeyTouched(k, list);
     }
 
     void insert(const key_type & k,
@@ -628,24 +995,30 @@ public:
         typename container_type::left_iterator found = this->operator ()(k);
         if ( found != _container.left.end() ) {
             found->second.push_back(v);
+            this->onKeyTouched(k, found->second);
         } else {
             value_type list;
             list.push_back(v);
             _container.insert( typename container_type::value_type(k, list) );
+            this->onKeyTouched(k, list);
         }
     }
 
     void clear()
     {
         _container.clear();
+        this->clearCostIndex();
     }
 
     std::pair<key_type, V> evict()
     {
+        if ( this->isCostAwareEvictionEnabled() ) {
+            return this->evictLowestPriority();
+        }
         typename container_type::right_iterator it = _container.right.begin();
         while ( it != _container.right.end() ) {
             for (typename std::list<V>::iterator it2 = it->first.begin(); it2 != it->first.end(); ++it2) {
-                if ( (*it2).use_count() == 1 ) {
+                if (it2->use_count() == 1) {
                     std::pair<key_type, V> ret = std::make_pair(it->second, *it2);
                     if (it->first.size() == 1) {
                         _container.right.erase(it);
@@ -668,6 +1041,27 @@ public:
     }
 
 private:
+
+    value_type* findValues(const key_type & k)
+    {
+        typename container_type::left_iterator found = _container.left.find(k);
+
+        return found == _container.left.end() ? NULL : &found->second;
+    }
+
+    void eraseKey(const key_type & k)
+    {
+        _container.left.erase(k);
+    }
+
+    void indexEntriesByCost()
+    {
+        // From the least to the most recently used
+        for (typename container_type::right_iterator it = _container.right.begin(); it != _container.right.end(); ++it) {
+            this->onKeyTouched(it->second, it->first);
+        }
+    }
+
     container_type _container;
 };
 
@@ -0,0 +1,245 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "MemoryGovernor.h"
+
+#include <algorithm> // min, max
+
+#include <QtCore/QMutex>
+#include <QtCore/QCoreApplication>
+
+#include "Engine/MemoryInfo.h"
+#include "Engine/Timer.h"
+
+// Minimum time in seconds between two samples of the memory counters
+#define NATRON_MEMORY_GOVERNOR_POLL_INTERVAL 0.5
+
+// Memory pressure stall (in percent of the last 10 seconds) above which the state is elevated / critical
+#define NATRON_MEMORY_GOVERNOR_PRESSURE_ELEVATED 10.
+#define NATRON_MEMORY_GOVERNOR_PRESSURE_CRITICAL 40.
+
+// Fraction of the cgroup memory limit in use above which the state is elevated / critical
+#define NATRON_MEMORY_GOVERNOR_USAGE_ELEVATED 0.85
+#define NATRON_MEMORY_GOVERNOR_USAGE_CRITICAL 0.95
+
+// To leave a state, the pressure must go under half its threshold and the usage 5% under its threshold
+#define NATRON_MEMORY_GOVERNOR_PRESSURE_HYSTERESIS 0.5
+#define NATRON_MEMORY_GOVERNOR_USAGE_HYSTERESIS 0.05
+
+// Factor applied to the cache budgets in the elevated / critical states
+#define NATRON_MEMORY_GOVERNOR_ELEVATED_CACHE_FACTOR 0.75
+#define NATRON_MEMORY_GOVERNOR_CRITICAL_CACHE_FACTOR 0.5
+
+NATRON_NAMESPACE_ENTER
+
+struct MemoryGovernorPrivate
+{
+    mutable QMutex lock;
+
+    // Clock used to rate limit the sampling
+    TimeLapse clock;
+
+    // Time of the last sample, -1 if never sampled
+    double lastSampleTime;
+
+    MemoryGovernorStatus status;
+
+    MemoryGovernorPrivate()
+        : lock()
+        , clock()
+        , lastSampleTime(-1.)
+        , status()
+    {
+    }
+
+    static MemoryGovernorStateEnum computeState(U64 memoryLimit,
+                                                U64 memoryUsage,
+                                                double pressure,
+                                                bool relaxed)
+    {
+        double pressureElevated = NATRON_MEMORY_GOVERNOR_PRESSURE_ELEVATED;
+        double pressureCritical = NATRON_MEMORY_GOVERNOR_PRESSURE_CRITICAL;
+        double usageElevated = NATRON_MEMORY_GOVERNOR_USAGE_ELEVATED;
+        double usageCritical = NATRON_MEMORY_GOVERNOR_USAGE_CRITICAL;
+
+        if (relaxed) {
+            pressureElevated *= NATRON_MEMORY_GOVERNOR_PRESSURE_HYSTERESIS;
+            pressureCritical *= NATRON_MEMORY_GOVERNOR_PRESSURE_HYSTERESIS;
+            usageElevated -= NATRON_MEMORY_GOVERNOR_USAGE_HYSTERESIS;
+            usageCritical -= NATRON_MEMORY_GOVERNOR_USAGE_HYSTERESIS;
+        }
+
+        double usageRatio = memoryLimit ? (double)memoryUsage / memoryLimit : 0.;
+
+        if ( (pressure >= pressureCritical) || (usageRatio >= usageCritical) ) {
+            return eMemoryGovernorStateCritical;
+        } else if ( (pressure >= pressureElevated) || (usageRatio >= usageElevated) ) {
+            return eMemoryGovernorStateElevated;
+        }
+
+        return eMemoryGovernorStateNormal;
+    }
+
+    static double getCacheBudgetFactor(MemoryGovernorStateEnum state)
+    {
+        switch (state) {
+        case eMemoryGovernorStateNormal:
+
+            return 1.;
+        case eMemoryGovernorStateElevated:
+
+            return NATRON_MEMORY_GOVERNOR_ELEVATED_CACHE_FACTOR;
+        case eMemoryGovernorStateCritical:
+
+            return NATRON_MEMORY_GOVERNOR_CRITICAL_CACHE_FACTOR;
+        }
+
+        return 1.;
+    }
+};
+
+MemoryGovernor::MemoryGovernor()
+    : _imp( new MemoryGovernorPrivate() )
+{
+}
+
+MemoryGovernor::~MemoryGovernor()
+{
+}
+
+bool
+MemoryGovernor::update(bool force)
+{
+    {
+        QMutexLocker k(&_imp->lock);
+        double now = _imp->clock.getTimeSinceCreation();
+        if ( !force && (_imp->lastSampleTime >= 0) && (now - _imp->lastSampleTime < NATRON_MEMORY_GOVERNOR_POLL_INTERVAL) ) {
+            return false;
+        }
+        _imp->lastSampleTime = now;
+    }
+
+    // Read the counters outside of the lock, this may hit the file-system.
+    // The cgroup counters are also recorded for getSystemTotalRAM() and getAmountFreePhysicalRAM().
+    U64 memoryLimit, memoryUsage;
+    sampleCGroupMemory(&memoryLimit, &memoryUsage);
+    double pressure = getMemoryPressure();
+
+    return setCounters(memoryLimit, memoryUsage, pressure);
+}
+
+bool
+MemoryGovernor::setCounters(U64 memoryLimit,
+                            U64 memoryUsage,
+                            double pressure)
+{
+    QMutexLocker k(&_imp->lock);
+    MemoryGovernorStateEnum state = MemoryGovernorPrivate::computeState(memoryLimit, memoryUsage, pressure, false);
+
+    if (state < _imp->status.state) {
+        // Only leave the current state once the counters went under the relaxed thresholds
+        MemoryGovernorStateEnum relaxedState = MemoryGovernorPrivate::computeState(memoryLimit, memoryUsage, pressure, true);
+        state = std::min(_imp->status.state, relaxedState);
+    }
+
+    bool changed = state != _imp->status.state;
+    _imp->status.state = state;
+    _imp->status.memoryLimit = memoryLimit;
+    _imp->status.memoryUsage = memoryUsage;
+    _imp->status.pressure = pressure;
+    _imp->status.cacheBudgetFactor = MemoryGovernorPrivate::getCacheBudgetFactor(state);
+
+    return changed;
+}
+
+MemoryGovernorStatus
+MemoryGovernor::getStatus() const
+{
+    QMutexLocker k(&_imp->lock);
+
+    return _imp->status;
+}
+
+int
+MemoryGovernor::throttleParallelRenders(int nRenders) const
+{
+    MemoryGovernorStateEnum state;
+    {
+        QMutexLocker k(&_imp->lock);
+        state = _imp->status.state;
+    }
+    switch (state) {
+    case eMemoryGovernorStateNormal:
+
+        return nRenders;
+    case eMemoryGovernorStateElevated:
+
+        return std::max(1, (nRenders + 1) / 2);
+    case eMemoryGovernorStateCritical:
+
+        return 1;
+    }
+
+    return nRenders;
+}
+
+QString
+MemoryGovernor::getStateString(MemoryGovernorStateEnum state)
+{
+    switch (state) {
+    case eMemoryGovernorStateNormal:
+
+        return QCoreApplication::translate("MemoryGovernor", "Normal");
+    case eMemoryGovernorStateElevated:
+
+        return QCoreApplication::translate("MemoryGovernor", "Elevated");
+    case eMemoryGovernorStateCritical:
+
+        return QCoreApplication::translate("MemoryGovernor", "Critical");
+    }
+
+    return QString();
+}
+
+QString
+MemoryGovernor::printStatus(const MemoryGovernorStatus& status)
+{
+    QString ret = QCoreApplication::translate("MemoryGovernor", "Memory state: %1, cache budget: %2%")
+                  .arg( getStateString(status.state) )
+                  .arg( (int)(status.cacheBudgetFactor * 100) );
+
+    if (status.memoryLimit) {
+        ret += QCoreApplication::translate("MemoryGovernor", ", cgroup memory: %1 / %2")
+               .arg( printAsRAM(status.memoryUsage) )
+               .arg( printAsRAM(status.memoryLimit) );
+    }
+    if (status.pressure >= 0) {
+        ret += QCoreApplication::translate("MemoryGovernor", ", memory pressure: %1%")
+               .arg(status.pressure, 0, 'f', 2);
+    }
+
+    return ret;
+}
+
+NATRON_NAMESPACE_EXIT
@@ -0,0 +1,117 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef Engine_MemoryGovernor_h
+#define Engine_MemoryGovernor_h
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/scoped_ptr.hpp>
+#endif
+
+#include <QtCore/QString>
+
+#include "Global/GlobalDefines.h"
+
+#include "Engine/EngineFwd.h"
+
+NATRON_NAMESPACE_ENTER
+
+/**
+ * @brief A snapshot of the memory counters sampled by the MemoryGovernor and of the decisions taken from them.
+ **/
+struct MemoryGovernorStatus
+{
+    MemoryGovernorStateEnum state;
+    U64 memoryLimit; // memory limit of the cgroup of the process in bytes, 0 if not limited
+    U64 memoryUsage; // memory charged to the cgroup of the process in bytes, 0 if unknown
+    double pressure; // memory pressure stall in percent, -1 if unavailable
+    double cacheBudgetFactor; // factor applied to the RAM cache size set in the preferences
+
+    MemoryGovernorStatus()
+        : state(eMemoryGovernorStateNormal)
+        , memoryLimit(0)
+        , memoryUsage(0)
+        , pressure(-1.)
+        , cacheBudgetFactor(1.)
+    {
+    }
+};
+
+/**
+ * @brief Adapts the memory budgets of the application to the memory actually available to the process.
+ * The host RAM may be much larger than what the process is allowed to use, e.g when running in a container:
+ * the governor samples the memory limit and usage of the cgroup of the process and the kernel memory
+ * pressure (PSI) and derives a state from them. The state is used to scale down the cache budgets and to
+ * throttle the number of parallel renders before the process gets killed by the OOM killer.
+ * Sampling is rate limited so that update() may be called very often, e.g before each cache allocation.
+ * This class is MT-safe.
+ **/
+struct MemoryGovernorPrivate;
+class MemoryGovernor
+{
+public:
+
+    MemoryGovernor();
+
+    ~MemoryGovernor();
+
+    /**
+     * @brief Samples the memory counters if the last sample is older than the poll interval, or always if force is true.
+     * Returns true if the state changed.
+     **/
+    bool update(bool force = false);
+
+    /**
+     * @brief Updates the state from the given counters. Returns true if the state changed.
+     * To go back to a lower state, the counters must go under lower thresholds than the ones
+     * used to enter it, so that the governor does not oscillate when the caches are shrunk.
+     **/
+    bool setCounters(U64 memoryLimit,
+                     U64 memoryUsage,
+                     double pressure);
+
+    MemoryGovernorStatus getStatus() const;
+
+    /**
+     * @brief Returns how many of the given number of parallel renders may run in the current state.
+     **/
+    int throttleParallelRenders(int nRenders) const;
+
+    static QString getStateString(MemoryGovernorStateEnum state);
+
+    /**
+     * @brief Returns a human readable description of the status, used in the logs and render statistics.
+     **/
+    static QString printStatus(const MemoryGovernorStatus& status);
+
+private:
+
+    boost::scoped_ptr<MemoryGovernorPrivate> _imp;
+};
+
+NATRON_NAMESPACE_EXIT
+
+#endif // Engine_MemoryGovernor_h
@@ -36,6 +36,8 @@
 #include <algorithm> // min, max
 #include <stdexcept>
 #include <sstream> // stringstream
+#include <fstream>
+#include <string>
 
 #if defined(_WIN32)
 #  include <windows.h>
@@ -73,11 +75,289 @@
 #include <QtCore/QLocale>
 #include <QtCore/QCoreApplication>
 #include <QtCore/QDebug>
+#include <QtCore/QMutex>
 
 #include "Global/GlobalDefines.h"
 
 NATRON_NAMESPACE_ENTER
 
+#if defined(__linux__) || defined(__linux) || defined(linux) || defined(__gnu_linux__)
+
+// cgroup v1 reports "no limit" as PAGE_COUNTER_MAX rounded to the page size, i.e. a value close to 2^63
+#define NATRON_CGROUP_UNLIMITED_THRESHOLD (1ULL << 60)
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+struct CGroupMemoryController
+{
+    std::string dir; // directory of the memory controller of our cgroup, empty if memory is not controlled
+    bool isV2; // true for the unified hierarchy (cgroup v2)
+
+    CGroupMemoryController()
+        : dir()
+        , isV2(false)
+    {
+    }
+};
+
+bool
+fileExists(const std::string& path)
+{
+    std::ifstream ifs( path.c_str() );
+
+    return ifs.good();
+}
+
+/**
+ * @brief Reads a cgroup file containing a single number. Returns false if the file cannot be read
+ * or contains "max" (no limit).
+ **/
+bool
+readCGroupValue(const std::string& path,
+                U64* value)
+{
+    std::ifstream ifs( path.c_str() );
+    std::string str;
+
+    if ( !ifs || !(ifs >> str) || (str == "max") ) {
+        return false;
+    }
+    std::stringstream ss(str);
+    unsigned long long v;
+    if ( !(ss >> v) ) {
+        return false;
+    }
+    *value = (U64)v;
+
+    return true;
+}
+
+/**
+ * @brief Returns the value of the given key in a memory.stat file, or 0 if not found.
+ **/
+U64
+readCGroupStat(const std::string& path,
+               const std::string& key)
+{
+    std::ifstream ifs( path.c_str() );
+    std::string name;
+    unsigned long long v;
+
+    while (ifs >> name >> v) {
+        if (name == key) {
+            return (U64)v;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Finds the memory controller of the cgroup of this process from /proc/self/cgroup.
+ * Inside a container the cgroup namespace usually makes our cgroup the root of /sys/fs/cgroup,
+ * which is why the mount point itself is tried as a fallback.
+ **/
+CGroupMemoryController
+findCGroupMemoryController()
+{
+    CGroupMemoryController ret;
+    std::string v1Path, v2Path;
+    bool hasV1 = false, hasV2 = false;
+    {
+        std::ifstream ifs("/proc/self/cgroup");
+        std::string line;
+        while ( std::getline(ifs, line) ) {
+            // Format is hierarchy-ID:controller-list:cgroup-path
+            std::size_t first = line.find(':');
+            if (first == std::string::npos) {
+                continue;
+            }
+            std::size_t second = line.find(':', first + 1);
+            if (second == std::string::npos) {
+                continue;
+            }
+            std::string controllers = line.substr(first + 1, second - first - 1);
+            std::string path = line.substr(second + 1);
+            if ( controllers.empty() && (line.compare(0, first, "0") == 0) ) {
+                v2Path = path;
+                hasV2 = true;
+            } else if ( ( std::string(",") + controllers + "," ).find(",memory,") != std::string::npos ) {
+                v1Path = path;
+                hasV1 = true;
+            }
+        }
+    }
+
+    if (hasV1) {
+        const std::string candidates[2] = { std::string("/sys/fs/cgroup/memory") + v1Path, std::string("/sys/fs/cgroup/memory") };
+        for (int i = 0; i < 2; ++i) {
+            if ( fileExists(candidates[i] + "/memory.limit_in_bytes") ) {
+                ret.dir = candidates[i];
+                ret.isV2 = false;
+
+                return ret;
+            }
+        }
+    }
+    if (hasV2) {
+        const std::string candidates[2] = { std::string("/sys/fs/cgroup") + v2Path, std::string("/sys/fs/cgroup") };
+        for (int i = 0; i < 2; ++i) {
+            if ( fileExists(candidates[i] + "/memory.max") ) {
+                ret.dir = candidates[i];
+                ret.isV2 = true;
+
+                return ret;
+            }
+        }
+    }
+
+    return ret;
+}
+
+const CGroupMemoryController&
+getCGroupMemoryController()
+{
+    // The cgroup of a process does not change during its lifetime in practice, look it up only once
+    static const CGroupMemoryController controller = findCGroupMemoryController();
+
+    return controller;
+}
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+#endif // __linux__
+
+U64
+getCGroupMemoryLimit()
+{
+#if defined(__linux__) || defined(__linux) || defined(linux) || defined(__gnu_linux__)
+    const CGroupMemoryController& cg = getCGroupMemoryController();
+    if ( cg.dir.empty() ) {
+        return 0;
+    }
+    U64 limit = 0;
+    if ( !readCGroupValue(cg.dir + ( cg.isV2 ? "/memory.max" : "/memory.limit_in_bytes" ), &limit) ||
+         ( limit >= NATRON_CGROUP_UNLIMITED_THRESHOLD ) ) {
+        return 0;
+    }
+
+    return limit;
+#else
+
+    return 0;
+#endif
+}
+
+U64
+getCGroupMemoryUsage()
+{
+#if defined(__linux__) || defined(__linux) || defined(linux) || defined(__gnu_linux__)
+    const CGroupMemoryController& cg = getCGroupMemoryController();
+    if ( cg.dir.empty() ) {
+        return 0;
+    }
+    U64 usage = 0;
+    if ( !readCGroupValue(cg.dir + ( cg.isV2 ? "/memory.current" : "/memory.usage_in_bytes" ), &usage) ) {
+        return 0;
+    }
+    // Inactive page cache is reclaimed by the kernel before the OOM killer is triggered,
+    // do not count it (this is the "working set" used by container orchestrators)
+    U64 inactiveFile = readCGroupStat(cg.dir + "/memory.stat", cg.isV2 ? "inactive_file" : "total_inactive_file");
+
+    return inactiveFile < usage ? usage - inactiveFile : 0;
+#else
+
+    return 0;
+#endif
+}
+
+double
+getMemoryPressure()
+{
+#if defined(__linux__) || defined(__linux) || defined(linux) || defined(__gnu_linux__)
+    // Prefer the pressure of our cgroup, fall back on the system-wide pressure
+    std::string paths[2];
+    const CGroupMemoryController& cg = getCGroupMemoryController();
+    if (cg.isV2) {
+        paths[0] = cg.dir + "/memory.pressure";
+    }
+    paths[1] = "/proc/pressure/memory";
+    for (int i = 0; i < 2; ++i) {
+        if ( paths[i].empty() ) {
+            continue;
+        }
+        FILE* fp = fopen(paths[i].c_str(), "r");
+        if (!fp) {
+            continue;
+        }
+        // First line is: some avg10=0.00 avg60=0.00 avg300=0.00 total=0
+        double avg10;
+        int nRead = fscanf(fp, "some avg10=%lf", &avg10);
+        fclose(fp);
+        if (nRead == 1) {
+            return avg10;
+        }
+    }
+
+    return -1.;
+#else
+
+    return -1.;
+#endif
+}
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+// The counters read by the last call to sampleCGroupMemory()
+struct CGroupMemorySample
+{
+    bool sampled;
+    U64 memoryLimit;
+    U64 memoryUsage;
+};
+
+QMutex cgroupMemorySampleMutex;
+CGroupMemorySample cgroupMemorySample = { false, 0, 0 };
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+void
+sampleCGroupMemory(U64* memoryLimit,
+                   U64* memoryUsage)
+{
+    *memoryLimit = getCGroupMemoryLimit();
+    *memoryUsage = *memoryLimit ? getCGroupMemoryUsage() : 0;
+
+    QMutexLocker k(&cgroupMemorySampleMutex);
+    cgroupMemorySample.sampled = true;
+    cgroupMemorySample.memoryLimit = *memoryLimit;
+    cgroupMemorySample.memoryUsage = *memoryUsage;
+}
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+/**
+ * @brief Returns the last counters read by sampleCGroupMemory(), reading them if it was never called.
+ **/
+void
+getLastCGroupMemorySample(U64* memoryLimit,
+                          U64* memoryUsage)
+{
+    {
+        QMutexLocker k(&cgroupMemorySampleMutex);
+        if (cgroupMemorySample.sampled) {
+            *memoryLimit = cgroupMemorySample.memoryLimit;
+            *memoryUsage = cgroupMemorySample.memoryUsage;
+
+            return;
+        }
+    }
+    sampleCGroupMemory(memoryLimit, memoryUsage);
+}
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+
 U64
 getSystemTotalRAM()
 {
@@ -144,8 +424,16 @@ getSystemTotalRAM()
 
     long pages = sysconf(_SC_PHYS_PAGES);
     long page_size = sysconf(_SC_PAGE_SIZE);
+    U64 total = (U64)pages * (U64)page_size;
+
+    // When running in a container, the memory we may use is bounded by the cgroup limit, not by the host RAM
+    U64 cgroupLimit, cgroupUsage;
+    getLastCGroupMemorySample(&cgroupLimit, &cgroupUsage);
+    if ( cgroupLimit && (cgroupLimit < total) ) {
+        total = cgroupLimit;
+    }
 
-    return pages * page_size;
+    return total;
 
 #endif
 }
@@ -188,7 +476,6 @@ printAsRAM(U64 bytes)
 }
 
 
-#if 0 // not used for now
 /**
  * Returns the peak (maximum so far) resident set size (physical
  * memory use) measured in bytes, or zero if the value cannot be
@@ -238,9 +525,7 @@ getPeakRSS( )
     return (size_t)0L;          /* Unsupported. */
 #endif
 }
-#endif // 0
 
-#if 0 // not used for now
 /**
  * Returns the current resident set size (physical memory use) measured
  * in bytes, or zero if the value cannot be determined on this OS.
@@ -297,7 +582,6 @@ getCurrentRSS( )
     return (size_t)0L;          /* Unsupported. */
 #endif
 } // getCurrentRSS
-#endif // 0
 
 
 std::size_t
@@ -317,6 +601,14 @@ getAmountFreePhysicalRAM()
     long long totalAvailableRAM = memInfo.freeram;
     totalAvailableRAM *= memInfo.mem_unit;
 
+    // This is called before each cache allocation: do not read the cgroup files here
+    U64 cgroupLimit, cgroupUsage;
+    getLastCGroupMemorySample(&cgroupLimit, &cgroupUsage);
+    if (cgroupLimit) {
+        long long cgroupAvailableRAM = cgroupUsage < cgroupLimit ? (long long)(cgroupLimit - cgroupUsage) : 0;
+        totalAvailableRAM = std::min(totalAvailableRAM, cgroupAvailableRAM);
+    }
+
     return totalAvailableRAM;
 #elif defined(__FreeBSD__) || defined(__FreeBSD_kernel__) || defined(__NetBSD__) || defined(__OpenBSD__) || defined(__DragonFly__) || defined(__APPLE__)
     // and http://source.winehq.org/git/wine.git/blob/HEAD:/dlls/kernel32/heap.c
@@ -49,7 +49,6 @@ U64 getSystemTotalRAM_conditionnally();
 // prints RAM value as KB, MB or GB
 QString printAsRAM(U64 bytes);
 
-#if 0 // not used for now
 /**
  * Returns the peak (maximum so far) resident set size (physical
  * memory use) measured in bytes, or zero if the value cannot be
@@ -62,10 +61,34 @@ std::size_t getPeakRSS( );
  * in bytes, or zero if the value cannot be determined on this OS.
  */
 std::size_t getCurrentRSS( );
-#endif // 0
 
 std::size_t getAmountFreePhysicalRAM();
 
+/**
+ * @brief Returns the memory limit of the control group (cgroup v1 or v2) of the process,
+ * or 0 if there is no limit or if it cannot be determined on this OS.
+ **/
+U64 getCGroupMemoryLimit();
+
+/**
+ * @brief Returns the memory charged to the control group of the process, minus the inactive
+ * page cache the kernel can reclaim, or 0 if it cannot be determined.
+ **/
+U64 getCGroupMemoryUsage();
+
+/**
+ * @brief Returns the share of time (in percent) during the last 10 seconds where at least one task
+ * was stalled waiting for memory (Linux PSI "some avg10"), or -1 if it is not available.
+ **/
+double getMemoryPressure();
+
+/**
+ * @brief Reads the memory limit and usage of the cgroup of the process and records them: getSystemTotalRAM()
+ * and getAmountFreePhysicalRAM() use the recorded values until the next call instead of reading the cgroup files.
+ * This is called by the MemoryGovernor, at most once per poll interval unless a sample is forced.
+ **/
+void sampleCGroupMemory(U64* memoryLimit, U64* memoryUsage);
+
 NATRON_NAMESPACE_EXIT
 
 #endif // ifndef Engine_MemoryInfo_h
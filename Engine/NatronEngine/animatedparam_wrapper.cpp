@@ -424,6 +424,89 @@ static PyObject* Sbk_AnimatedParamFunc_getIsAnimated(PyObject* self, PyObject* a
         return 0;
 }
 
+static PyObject* Sbk_AnimatedParamFunc_getKeyFrames(PyObject* self, PyObject* args, PyObject* kwds)
+{
+    AnimatedParamWrapper* cppSelf = 0;
+    SBK_UNUSED(cppSelf)
+    if (!Shiboken::Object::isValid(self))
+        return 0;
+    cppSelf = (AnimatedParamWrapper*)((::AnimatedParam*)Shiboken::Conversions::cppPointer(SbkNatronEngineTypes[SBK_ANIMATEDPARAM_IDX], (SbkObject*)self));
+    PyObject* pyResult = 0;
+    int overloadId = -1;
+    PythonToCppFunc pythonToCpp[] = { 0 };
+    SBK_UNUSED(pythonToCpp)
+    int numNamedArgs = (kwds ? PyDict_Size(kwds) : 0);
+    int numArgs = PyTuple_GET_SIZE(args);
+    PyObject* pyArgs[] = {0};
+
+    // invalid argument lengths
+    if (numArgs + numNamedArgs > 1) {
+        PyErr_SetString(PyExc_TypeError, "NatronEngine.AnimatedParam.getKeyFrames(): too many arguments");
+        return 0;
+    }
+
+    if (!PyArg_ParseTuple(args, "|O:getKeyFrames", &(pyArgs[0])))
+        return 0;
+
+
+    // Overloaded function decisor
+    // 0: getKeyFrames(std::vector<double>*,std::vector<double>*,std::vector<double>*,std::vector<double>*,int)const
+    if (numArgs == 0) {
+        overloadId = 0; // getKeyFrames(std::vector<double>*,std::vector<double>*,std::vector<double>*,std::vector<double>*,int)const
+    } else if ((pythonToCpp[0] = Shiboken::Conversions::isPythonToCppConvertible(Shiboken::Conversions::PrimitiveTypeConverter<int>(), (pyArgs[0])))) {
+        overloadId = 0; // getKeyFrames(std::vector<double>*,std::vector<double>*,std::vector<double>*,std::vector<double>*,int)const
+    }
+
+    // Function signature not found.
+    if (overloadId == -1) goto Sbk_AnimatedParamFunc_getKeyFrames_TypeError;
+
+    // Call function/method
+    {
+        if (kwds) {
+            PyObject* value = PyDict_GetItemString(kwds, "dimension");
+            if (value && pyArgs[0]) {
+                PyErr_SetString(PyExc_TypeError, "NatronEngine.AnimatedParam.getKeyFrames(): got multiple values for keyword argument 'dimension'.");
+                return 0;
+            } else if (value) {
+                pyArgs[0] = value;
+                if (!(pythonToCpp[0] = Shiboken::Conversions::isPythonToCppConvertible(Shiboken::Conversions::PrimitiveTypeConverter<int>(), (pyArgs[0]))))
+                    goto Sbk_AnimatedParamFunc_getKeyFrames_TypeError;
+            }
+        }
+        int cppArg0 = 0;
+        if (pythonToCpp[0]) pythonToCpp[0](pyArgs[0], &cppArg0);
+
+        if (!PyErr_Occurred()) {
+            // getKeyFrames(std::vector<double>*,std::vector<double>*,std::vector<double>*,std::vector<double>*,int)const
+            // Begin code injection
+
+            std::vector<double> times, values, leftDerivatives, rightDerivatives;
+            cppSelf->getKeyFrames(&times,&values,&leftDerivatives,&rightDerivatives,cppArg0);
+            pyResult = PyTuple_New(4);
+            PyTuple_SET_ITEM(pyResult, 0, Shiboken::Conversions::copyToPython(SbkNatronEngineTypeConverters[SBK_NATRONENGINE_STD_VECTOR_DOUBLE_IDX], &times));
+            PyTuple_SET_ITEM(pyResult, 1, Shiboken::Conversions::copyToPython(SbkNatronEngineTypeConverters[SBK_NATRONENGINE_STD_VECTOR_DOUBLE_IDX], &values));
+            PyTuple_SET_ITEM(pyResult, 2, Shiboken::Conversions::copyToPython(SbkNatronEngineTypeConverters[SBK_NATRONENGINE_STD_VECTOR_DOUBLE_IDX], &leftDerivatives));
+            PyTuple_SET_ITEM(pyResult, 3, Shiboken::Conversions::copyToPython(SbkNatronEngineTypeConverters[SBK_NATRONENGINE_STD_VECTOR_DOUBLE_IDX], &rightDerivatives));
+            return pyResult;
+
+            // End of code injection
+
+
+        }
+    }
+
+    if (PyErr_Occurred() || !pyResult) {
+        Py_XDECREF(pyResult);
+        return 0;
+    }
+    return pyResult;
+
+    Sbk_AnimatedParamFunc_getKeyFrames_TypeError:
+        const char* overloads[] = {"int = 0", 0};
+        Shiboken::setErrorAboutWrongArguments(args, "NatronEngine.AnimatedParam.getKeyFrames", overloads);
+        return 0;
+}
+
 static PyObject* Sbk_AnimatedParamFunc_getKeyIndex(PyObject* self, PyObject* args, PyObject* kwds)
 {
     AnimatedParamWrapper* cppSelf = 0;
@@ -879,6 +962,118 @@ static PyObject* Sbk_AnimatedParamFunc_setInterpolationAtTime(PyObject* self, Py
         return 0;
 }
 
+static PyObject* Sbk_AnimatedParamFunc_setKeyFrames(PyObject* self, PyObject* args, PyObject* kwds)
+{
+    AnimatedParamWrapper* cppSelf = 0;
+    SBK_UNUSED(cppSelf)
+    if (!Shiboken::Object::isValid(self))
+        return 0;
+    cppSelf = (AnimatedParamWrapper*)((::AnimatedParam*)Shiboken::Conversions::cppPointer(SbkNatronEngineTypes[SBK_ANIMATEDPARAM_IDX], (SbkObject*)self));
+    PyObject* pyResult = 0;
+    int overloadId = -1;
+    PythonToCppFunc pythonToCpp[] = { 0, 0, 0, 0, 0 };
+    SBK_UNUSED(pythonToCpp)
+    int numNamedArgs = (kwds ? PyDict_Size(kwds) : 0);
+    int numArgs = PyTuple_GET_SIZE(args);
+    PyObject* pyArgs[] = {0, 0, 0, 0, 0};
+
+    // invalid argument lengths
+    if (numArgs + numNamedArgs > 5) {
+        PyErr_SetString(PyExc_TypeError, "NatronEngine.AnimatedParam.setKeyFrames(): too many arguments");
+        return 0;
+    } else if (numArgs < 2) {
+        PyErr_SetString(PyExc_TypeError, "NatronEngine.AnimatedParam.setKeyFrames(): not enough arguments");
+        return 0;
+    }
+
+    if (!PyArg_ParseTuple(args, "|OOOOO:setKeyFrames", &(pyArgs[0]), &(pyArgs[1]), &(pyArgs[2]), &(pyArgs[3]), &(pyArgs[4])))
+        return 0;
+
+
+    // Overloaded function decisor
+    // 0: setKeyFrames(std::vector<double>,std::vector<double>,int,std::vector<double>,std::vector<double>)
+    if (numArgs >= 2
+        && (pythonToCpp[0] = Shiboken::Conversions::isPythonToCppConvertible(SbkNatronEngineTypeConverters[SBK_NATRONENGINE_STD_VECTOR_DOUBLE_IDX], (pyArgs[0])))
+        && (pythonToCpp[1] = Shiboken::Conversions::isPythonToCppConvertible(SbkNatronEngineTypeConverters[SBK_NATRONENGINE_STD_VECTOR_DOUBLE_IDX], (pyArgs[1])))) {
+        if (numArgs == 2) {
+            overloadId = 0; // setKeyFrames(std::vector<double>,std::vector<double>,int,std::vector<double>,std::vector<double>)
+        } else if ((pythonToCpp[2] = Shiboken::Conversions::isPythonToCppConvertible(Shiboken::Conversions::PrimitiveTypeConverter<int>(), (pyArgs[2])))) {
+            if (numArgs == 3) {
+                overloadId = 0; // setKeyFrames(std::vector<double>,std::vector<double>,int,std::vector<double>,std::vector<double>)
+            } else if ((pythonToCpp[3] = Shiboken::Conversions::isPythonToCppConvertible(SbkNatronEngineTypeConverters[SBK_NATRONENGINE_STD_VECTOR_DOUBLE_IDX], (pyArgs[3])))) {
+                if (numArgs == 4) {
+                    overloadId = 0; // setKeyFrames(std::vector<double>,std::vector<double>,int,std::vector<double>,std::vector<double>)
+                } else if ((pythonToCpp[4] = Shiboken::Conversions::isPythonToCppConvertible(SbkNatronEngineTypeConverters[SBK_NATRONENGINE_STD_VECTOR_DOUBLE_IDX], (pyArgs[4])))) {
+                    overloadId = 0; // setKeyFrames(std::vector<double>,std::vector<double>,int,std::vector<double>,std::vector<double>)
+                }
+            }
+        }
+    }
+
+    // Function signature not found.
+    if (overloadId == -1) goto Sbk_AnimatedParamFunc_setKeyFrames_TypeError;
+
+    // Call function/method
+    {
+        if (kwds) {
+            PyObject* value = PyDict_GetItemString(kwds, "dimension");
+            if (value && pyArgs[2]) {
+                PyErr_SetString(PyExc_TypeError, "NatronEngine.AnimatedParam.setKeyFrames(): got multiple values for keyword argument 'dimension'.");
+                return 0;
+            } else if (value) {
+                pyArgs[2] = value;
+                if (!(pythonToCpp[2] = Shiboken::Conversions::isPythonToCppConvertible(Shiboken::Conversions::PrimitiveTypeConverter<int>(), (pyArgs[2]))))
+                    goto Sbk_AnimatedParamFunc_setKeyFrames_TypeError;
+            }
+            value = PyDict_GetItemString(kwds, "leftDerivatives");
+            if (value && pyArgs[3]) {
+                PyErr_SetString(PyExc_TypeError, "NatronEngine.AnimatedParam.setKeyFrames(): got multiple values for keyword argument 'leftDerivatives'.");
+                return 0;
+            } else if (value) {
+                pyArgs[3] = value;
+                if (!(pythonToCpp[3] = Shiboken::Conversions::isPythonToCppConvertible(SbkNatronEngineTypeConverters[SBK_NATRONENGINE_STD_VECTOR_DOUBLE_IDX], (pyArgs[3]))))
+                    goto Sbk_AnimatedParamFunc_setKeyFrames_TypeError;
+            }
+            value = PyDict_GetItemString(kwds, "rightDerivatives");
+            if (value && pyArgs[4]) {
+                PyErr_SetString(PyExc_TypeError, "NatronEngine.AnimatedParam.setKeyFrames(): got multiple values for keyword argument 'rightDerivatives'.");
+                return 0;
+            } else if (value) {
+                pyArgs[4] = value;
+                if (!(pythonToCpp[4] = Shiboken::Conversions::isPythonToCppConvertible(SbkNatronEngineTypeConverters[SBK_NATRONENGINE_STD_VECTOR_DOUBLE_IDX], (pyArgs[4]))))
+                    goto Sbk_AnimatedParamFunc_setKeyFrames_TypeError;
+            }
+        }
+        ::std::vector<double > cppArg0;
+        pythonToCpp[0](pyArgs[0], &cppArg0);
+        ::std::vector<double > cppArg1;
+        pythonToCpp[1](pyArgs[1], &cppArg1);
+        int cppArg2 = 0;
+        if (pythonToCpp[2]) pythonToCpp[2](pyArgs[2], &cppArg2);
+        ::std::vector<double > cppArg3 = std::vector<double>();
+        if (pythonToCpp[3]) pythonToCpp[3](pyArgs[3], &cppArg3);
+        ::std::vector<double > cppArg4 = std::vector<double>();
+        if (pythonToCpp[4]) pythonToCpp[4](pyArgs[4], &cppArg4);
+
+        if (!PyErr_Occurred()) {
+            // setKeyFrames(std::vector<double>,std::vector<double>,int,std::vector<double>,std::vector<double>)
+            bool cppResult = cppSelf->setKeyFrames(cppArg0, cppArg1, cppArg2, cppArg3, cppArg4);
+            pyResult = Shiboken::Conversions::copyToPython(Shiboken::Conversions::PrimitiveTypeConverter<bool>(), &cppResult);
+        }
+    }
+
+    if (PyErr_Occurred() || !pyResult) {
+        Py_XDECREF(pyResult);
+        return 0;
+    }
+    return pyResult;
+
+    Sbk_AnimatedParamFunc_setKeyFrames_TypeError:
+        const char* overloads[] = {"list, list, int = 0, list = std.vector< double >(), list = std.vector< double >()", 0};
+        Shiboken::setErrorAboutWrongArguments(args, "NatronEngine.AnimatedParam.setKeyFrames", overloads);
+        return 0;
+}
+
 static PyMethodDef Sbk_AnimatedParam_methods[] = {
     {"deleteValueAtTime", (PyCFunction)Sbk_AnimatedParamFunc_deleteValueAtTime, METH_VARARGS|METH_KEYWORDS},
     {"getCurrentTime", (PyCFunction)Sbk_AnimatedParamFunc_getCurrentTime, METH_NOARGS},
@@ -886,12 +1081,14 @@ static PyMethodDef Sbk_AnimatedParam_methods[] = {
     {"getExpression", (PyCFunction)Sbk_AnimatedParamFunc_getExpression, METH_O},
     {"getIntegrateFromTimeToTime", (PyCFunction)Sbk_AnimatedParamFunc_getIntegrateFromTimeToTime, METH_VARARGS|METH_KEYWORDS},
     {"getIsAnimated", (PyCFunction)Sbk_AnimatedParamFunc_getIsAnimated, METH_VARARGS|METH_KEYWORDS},
+    {"getKeyFrames", (PyCFunction)Sbk_AnimatedParamFunc_getKeyFrames, METH_VARARGS|METH_KEYWORDS},
     {"getKeyIndex", (PyCFunction)Sbk_AnimatedParamFunc_getKeyIndex, METH_VARARGS|METH_KEYWORDS},
     {"getKeyTime", (PyCFunction)Sbk_AnimatedParamFunc_getKeyTime, METH_VARARGS},
     {"getNumKeys", (PyCFunction)Sbk_AnimatedParamFunc_getNumKeys, METH_VARARGS|METH_KEYWORDS},
     {"removeAnimation", (PyCFunction)Sbk_AnimatedParamFunc_removeAnimation, METH_VARARGS|METH_KEYWORDS},
     {"setExpression", (PyCFunction)Sbk_AnimatedParamFunc_setExpression, METH_VARARGS|METH_KEYWORDS},
     {"setInterpolationAtTime", (PyCFunction)Sbk_AnimatedParamFunc_setInterpolationAtTime, METH_VARARGS|METH_KEYWORDS},
+    {"setKeyFrames", (PyCFunction)Sbk_AnimatedParamFunc_setKeyFrames, METH_VARARGS|METH_KEYWORDS},
 
     {0} // Sentinel
 };
@@ -133,6 +133,35 @@ static PyObject* Sbk_AppFunc_addProjectLayer(PyObject* self, PyObject* pyArg)
         return 0;
 }
 
+static PyObject* Sbk_AppFunc_changeTransaction(PyObject* self)
+{
+    AppWrapper* cppSelf = 0;
+    SBK_UNUSED(cppSelf)
+    if (!Shiboken::Object::isValid(self))
+        return 0;
+    cppSelf = (AppWrapper*)((::App*)Shiboken::Conversions::cppPointer(SbkNatronEngineTypes[SBK_APP_IDX], (SbkObject*)self));
+    PyObject* pyResult = 0;
+
+    // Call function/method
+    {
+
+        if (!PyErr_Occurred()) {
+            // changeTransaction()const
+            ChangeTransaction * cppResult = const_cast<const ::AppWrapper*>(cppSelf)->changeTransaction();
+            pyResult = Shiboken::Conversions::pointerToPython((SbkObjectType*)SbkNatronEngineTypes[SBK_CHANGETRANSACTION_IDX], cppResult);
+
+            // Ownership transferences.
+            Shiboken::Object::getOwnership(pyResult);
+        }
+    }
+
+    if (PyErr_Occurred() || !pyResult) {
+        Py_XDECREF(pyResult);
+        return 0;
+    }
+    return pyResult;
+}
+
 static PyObject* Sbk_AppFunc_closeProject(PyObject* self)
 {
     AppWrapper* cppSelf = 0;
@@ -1110,6 +1139,7 @@ static PyObject* Sbk_AppFunc_writeToScriptEditor(PyObject* self, PyObject* pyArg
 static PyMethodDef Sbk_App_methods[] = {
     {"addFormat", (PyCFunction)Sbk_AppFunc_addFormat, METH_O},
     {"addProjectLayer", (PyCFunction)Sbk_AppFunc_addProjectLayer, METH_O},
+    {"changeTransaction", (PyCFunction)Sbk_AppFunc_changeTransaction, METH_NOARGS},
     {"closeProject", (PyCFunction)Sbk_AppFunc_closeProject, METH_NOARGS},
     {"createNode", (PyCFunction)Sbk_AppFunc_createNode, METH_VARARGS|METH_KEYWORDS},
     {"createReader", (PyCFunction)Sbk_AppFunc_createReader, METH_VARARGS|METH_KEYWORDS},
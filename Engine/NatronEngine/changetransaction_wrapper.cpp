@@ -0,0 +1,312 @@
+
+// default includes
+#include "Global/Macros.h"
+CLANG_DIAG_OFF(mismatched-tags)
+GCC_DIAG_OFF(unused-parameter)
+GCC_DIAG_OFF(missing-field-initializers)
+GCC_DIAG_OFF(missing-declarations)
+GCC_DIAG_OFF(uninitialized)
+GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_OFF
+#include <shiboken.h> // produces many warnings
+#include <pysidesignal.h>
+#include <pysideproperty.h>
+#include <pyside.h>
+#include <typeresolver.h>
+#include <typeinfo>
+#include "natronengine_python.h"
+
+#include "changetransaction_wrapper.h"
+
+// Extra includes
+NATRON_NAMESPACE_USING NATRON_PYTHON_NAMESPACE_USING
+#include <PyAppInstance.h>
+
+
+
+// Target ---------------------------------------------------------
+
+extern "C" {
+static PyObject* Sbk_ChangeTransactionFunc___enter__(PyObject* self)
+{
+    ::ChangeTransaction* cppSelf = 0;
+    SBK_UNUSED(cppSelf)
+    if (!Shiboken::Object::isValid(self))
+        return 0;
+    cppSelf = ((::ChangeTransaction*)Shiboken::Conversions::cppPointer(SbkNatronEngineTypes[SBK_CHANGETRANSACTION_IDX], (SbkObject*)self));
+    PyObject* pyResult = 0;
+
+    // Call function/method
+    {
+
+        if (!PyErr_Occurred()) {
+            // __enter__()
+            // Begin code injection
+
+            cppSelf->begin();
+            Py_INCREF(self);
+            pyResult = self;
+
+            // End of code injection
+
+        }
+    }
+
+    if (PyErr_Occurred() || !pyResult) {
+        Py_XDECREF(pyResult);
+        return 0;
+    }
+    return pyResult;
+}
+
+static PyObject* Sbk_ChangeTransactionFunc___exit__(PyObject* self, PyObject* args)
+{
+    ::ChangeTransaction* cppSelf = 0;
+    SBK_UNUSED(cppSelf)
+    if (!Shiboken::Object::isValid(self))
+        return 0;
+    cppSelf = ((::ChangeTransaction*)Shiboken::Conversions::cppPointer(SbkNatronEngineTypes[SBK_CHANGETRANSACTION_IDX], (SbkObject*)self));
+    PyObject* pyResult = 0;
+    int overloadId = -1;
+    PythonToCppFunc pythonToCpp[] = { 0, 0, 0 };
+    SBK_UNUSED(pythonToCpp)
+    int numArgs = PyTuple_GET_SIZE(args);
+    PyObject* pyArgs[] = {0, 0, 0};
+
+    // invalid argument lengths
+
+
+    if (!PyArg_UnpackTuple(args, "__exit__", 3, 3, &(pyArgs[0]), &(pyArgs[1]), &(pyArgs[2])))
+        return 0;
+
+
+    // Overloaded function decisor
+    // 0: __exit__(PyObject*,PyObject*,PyObject*)
+    if (numArgs == 3) {
+        overloadId = 0; // __exit__(PyObject*,PyObject*,PyObject*)
+    }
+
+    // Function signature not found.
+    if (overloadId == -1) goto Sbk_ChangeTransactionFunc___exit___TypeError;
+
+    // Call function/method
+    {
+
+        if (!PyErr_Occurred()) {
+            // __exit__(PyObject*,PyObject*,PyObject*)
+            // Begin code injection
+
+            cppSelf->commit();
+            Py_INCREF(Py_False);
+            pyResult = Py_False;
+
+            // End of code injection
+
+        }
+    }
+
+    if (PyErr_Occurred() || !pyResult) {
+        Py_XDECREF(pyResult);
+        return 0;
+    }
+    return pyResult;
+
+    Sbk_ChangeTransactionFunc___exit___TypeError:
+        const char* overloads[] = {"PyObject, PyObject, PyObject", 0};
+        Shiboken::setErrorAboutWrongArguments(args, "NatronEngine.ChangeTransaction.__exit__", overloads);
+        return 0;
+}
+
+static PyObject* Sbk_ChangeTransactionFunc_begin(PyObject* self)
+{
+    ::ChangeTransaction* cppSelf = 0;
+    SBK_UNUSED(cppSelf)
+    if (!Shiboken::Object::isValid(self))
+        return 0;
+    cppSelf = ((::ChangeTransaction*)Shiboken::Conversions::cppPointer(SbkNatronEngineTypes[SBK_CHANGETRANSACTION_IDX], (SbkObject*)self));
+
+    // Call function/method
+    {
+
+        if (!PyErr_Occurred()) {
+            // begin()
+            cppSelf->begin();
+        }
+    }
+
+    if (PyErr_Occurred()) {
+        return 0;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject* Sbk_ChangeTransactionFunc_commit(PyObject* self)
+{
+    ::ChangeTransaction* cppSelf = 0;
+    SBK_UNUSED(cppSelf)
+    if (!Shiboken::Object::isValid(self))
+        return 0;
+    cppSelf = ((::ChangeTransaction*)Shiboken::Conversions::cppPointer(SbkNatronEngineTypes[SBK_CHANGETRANSACTION_IDX], (SbkObject*)self));
+
+    // Call function/method
+    {
+
+        if (!PyErr_Occurred()) {
+            // commit()
+            cppSelf->commit();
+        }
+    }
+
+    if (PyErr_Occurred()) {
+        return 0;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject* Sbk_ChangeTransactionFunc_isActive(PyObject* self)
+{
+    ::ChangeTransaction* cppSelf = 0;
+    SBK_UNUSED(cppSelf)
+    if (!Shiboken::Object::isValid(self))
+        return 0;
+    cppSelf = ((::ChangeTransaction*)Shiboken::Conversions::cppPointer(SbkNatronEngineTypes[SBK_CHANGETRANSACTION_IDX], (SbkObject*)self));
+    PyObject* pyResult = 0;
+
+    // Call function/method
+    {
+
+        if (!PyErr_Occurred()) {
+            // isActive()const
+            bool cppResult = const_cast<const ::ChangeTransaction*>(cppSelf)->isActive();
+            pyResult = Shiboken::Conversions::copyToPython(Shiboken::Conversions::PrimitiveTypeConverter<bool>(), &cppResult);
+        }
+    }
+
+    if (PyErr_Occurred() || !pyResult) {
+        Py_XDECREF(pyResult);
+        return 0;
+    }
+    return pyResult;
+}
+
+static PyMethodDef Sbk_ChangeTransaction_methods[] = {
+    {"__enter__", (PyCFunction)Sbk_ChangeTransactionFunc___enter__, METH_NOARGS},
+    {"__exit__", (PyCFunction)Sbk_ChangeTransactionFunc___exit__, METH_VARARGS},
+    {"begin", (PyCFunction)Sbk_ChangeTransactionFunc_begin, METH_NOARGS},
+    {"commit", (PyCFunction)Sbk_ChangeTransactionFunc_commit, METH_NOARGS},
+    {"isActive", (PyCFunction)Sbk_ChangeTransactionFunc_isActive, METH_NOARGS},
+
+    {0} // Sentinel
+};
+
+} // extern "C"
+
+static int Sbk_ChangeTransaction_traverse(PyObject* self, visitproc visit, void* arg)
+{
+    return reinterpret_cast<PyTypeObject*>(&SbkObject_Type)->tp_traverse(self, visit, arg);
+}
+static int Sbk_ChangeTransaction_clear(PyObject* self)
+{
+    return reinterpret_cast<PyTypeObject*>(&SbkObject_Type)->tp_clear(self);
+}
+// Class Definition -----------------------------------------------
+extern "C" {
+static SbkObjectType Sbk_ChangeTransaction_Type = { { {
+    PyVarObject_HEAD_INIT(&SbkObjectType_Type, 0)
+    /*tp_name*/             "NatronEngine.ChangeTransaction",
+    /*tp_basicsize*/        sizeof(SbkObject),
+    /*tp_itemsize*/         0,
+    /*tp_dealloc*/          &SbkDeallocWrapper,
+    /*tp_print*/            0,
+    /*tp_getattr*/          0,
+    /*tp_setattr*/          0,
+    /*tp_compare*/          0,
+    /*tp_repr*/             0,
+    /*tp_as_number*/        0,
+    /*tp_as_sequence*/      0,
+    /*tp_as_mapping*/       0,
+    /*tp_hash*/             0,
+    /*tp_call*/             0,
+    /*tp_str*/              0,
+    /*tp_getattro*/         0,
+    /*tp_setattro*/         0,
+    /*tp_as_buffer*/        0,
+    /*tp_flags*/            Py_TPFLAGS_DEFAULT|Py_TPFLAGS_CHECKTYPES|Py_TPFLAGS_HAVE_GC,
+    /*tp_doc*/              0,
+    /*tp_traverse*/         Sbk_ChangeTransaction_traverse,
+    /*tp_clear*/            Sbk_ChangeTransaction_clear,
+    /*tp_richcompare*/      0,
+    /*tp_weaklistoffset*/   0,
+    /*tp_iter*/             0,
+    /*tp_iternext*/         0,
+    /*tp_methods*/          Sbk_ChangeTransaction_methods,
+    /*tp_members*/          0,
+    /*tp_getset*/           0,
+    /*tp_base*/             reinterpret_cast<PyTypeObject*>(&SbkObject_Type),
+    /*tp_dict*/             0,
+    /*tp_descr_get*/        0,
+    /*tp_descr_set*/        0,
+    /*tp_dictoffset*/       0,
+    /*tp_init*/             0,
+    /*tp_alloc*/            0,
+    /*tp_new*/              0,
+    /*tp_free*/             0,
+    /*tp_is_gc*/            0,
+    /*tp_bases*/            0,
+    /*tp_mro*/              0,
+    /*tp_cache*/            0,
+    /*tp_subclasses*/       0,
+    /*tp_weaklist*/         0
+}, },
+    /*priv_data*/           0
+};
+} //extern
+
+
+// Type conversion functions.
+
+// Python to C++ pointer conversion - returns the C++ object of the Python wrapper (keeps object identity).
+static void ChangeTransaction_PythonToCpp_ChangeTransaction_PTR(PyObject* pyIn, void* cppOut) {
+    Shiboken::Conversions::pythonToCppPointer(&Sbk_ChangeTransaction_Type, pyIn, cppOut);
+}
+static PythonToCppFunc is_ChangeTransaction_PythonToCpp_ChangeTransaction_PTR_Convertible(PyObject* pyIn) {
+    if (pyIn == Py_None)
+        return Shiboken::Conversions::nonePythonToCppNullPtr;
+    if (PyObject_TypeCheck(pyIn, (PyTypeObject*)&Sbk_ChangeTransaction_Type))
+        return ChangeTransaction_PythonToCpp_ChangeTransaction_PTR;
+    return 0;
+}
+
+// C++ to Python pointer conversion - tries to find the Python wrapper for the C++ object (keeps object identity).
+static PyObject* ChangeTransaction_PTR_CppToPython_ChangeTransaction(const void* cppIn) {
+    PyObject* pyOut = (PyObject*)Shiboken::BindingManager::instance().retrieveWrapper(cppIn);
+    if (pyOut) {
+        Py_INCREF(pyOut);
+        return pyOut;
+    }
+    const char* typeName = typeid(*((::ChangeTransaction*)cppIn)).name();
+    return Shiboken::Object::newObject(&Sbk_ChangeTransaction_Type, const_cast<void*>(cppIn), false, false, typeName);
+}
+
+void init_ChangeTransaction(PyObject* module)
+{
+    SbkNatronEngineTypes[SBK_CHANGETRANSACTION_IDX] = reinterpret_cast<PyTypeObject*>(&Sbk_ChangeTransaction_Type);
+
+    if (!Shiboken::ObjectType::introduceWrapperType(module, "ChangeTransaction", "ChangeTransaction*",
+        &Sbk_ChangeTransaction_Type, &Shiboken::callCppDestructor< ::ChangeTransaction >)) {
+        return;
+    }
+
+    // Register Converter
+    SbkConverter* converter = Shiboken::Conversions::createConverter(&Sbk_ChangeTransaction_Type,
+        ChangeTransaction_PythonToCpp_ChangeTransaction_PTR,
+        is_ChangeTransaction_PythonToCpp_ChangeTransaction_PTR_Convertible,
+        ChangeTransaction_PTR_CppToPython_ChangeTransaction);
+
+    Shiboken::Conversions::registerConverterName(converter, "ChangeTransaction");
+    Shiboken::Conversions::registerConverterName(converter, "ChangeTransaction*");
+    Shiboken::Conversions::registerConverterName(converter, "ChangeTransaction&");
+    Shiboken::Conversions::registerConverterName(converter, typeid(::ChangeTransaction).name());
+
+
+
+}
@@ -0,0 +1,9 @@
+#ifndef SBK_CHANGETRANSACTION_H
+#define SBK_CHANGETRANSACTION_H
+
+#include <shiboken.h>
+
+#include <PyAppInstance.h>
+
+#endif // SBK_CHANGETRANSACTION_H
+
@@ -251,6 +251,76 @@ static PyObject* Sbk_EffectFunc_connectInput(PyObject* self, PyObject* args)
         return 0;
 }
 
+static PyObject* Sbk_EffectFunc_createImageBuffer(PyObject* self, PyObject* args)
+{
+    ::Effect* cppSelf = 0;
+    SBK_UNUSED(cppSelf)
+    if (!Shiboken::Object::isValid(self))
+        return 0;
+    cppSelf = ((::Effect*)Shiboken::Conversions::cppPointer(SbkNatronEngineTypes[SBK_EFFECT_IDX], (SbkObject*)self));
+    PyObject* pyResult = 0;
+    int overloadId = -1;
+    PythonToCppFunc pythonToCpp[] = { 0, 0 };
+    SBK_UNUSED(pythonToCpp)
+    int numArgs = PyTuple_GET_SIZE(args);
+    PyObject* pyArgs[] = {0, 0};
+
+    // invalid argument lengths
+
+
+    if (!PyArg_UnpackTuple(args, "createImageBuffer", 2, 2, &(pyArgs[0]), &(pyArgs[1])))
+        return 0;
+
+
+    // Overloaded function decisor
+    // 0: createImageBuffer(ImageLayer,RectI)const
+    if (numArgs == 2
+        && (pythonToCpp[0] = Shiboken::Conversions::isPythonToCppReferenceConvertible((SbkObjectType*)SbkNatronEngineTypes[SBK_IMAGELAYER_IDX], (pyArgs[0])))
+        && (pythonToCpp[1] = Shiboken::Conversions::isPythonToCppReferenceConvertible((SbkObjectType*)SbkNatronEngineTypes[SBK_RECTI_IDX], (pyArgs[1])))) {
+        overloadId = 0; // createImageBuffer(ImageLayer,RectI)const
+    }
+
+    // Function signature not found.
+    if (overloadId == -1) goto Sbk_EffectFunc_createImageBuffer_TypeError;
+
+    // Call function/method
+    {
+        if (!Shiboken::Object::isValid(pyArgs[0]))
+            return 0;
+        ::ImageLayer cppArg0_local = ::ImageLayer(::QString(), ::QString(), ::QStringList());
+        ::ImageLayer* cppArg0 = &cppArg0_local;
+        if (Shiboken::Conversions::isImplicitConversion((SbkObjectType*)SbkNatronEngineTypes[SBK_IMAGELAYER_IDX], pythonToCpp[0]))
+            pythonToCpp[0](pyArgs[0], &cppArg0_local);
+        else
+            pythonToCpp[0](pyArgs[0], &cppArg0);
+
+        if (!Shiboken::Object::isValid(pyArgs[1]))
+            return 0;
+        ::RectI* cppArg1;
+        pythonToCpp[1](pyArgs[1], &cppArg1);
+
+        if (!PyErr_Occurred()) {
+            // createImageBuffer(ImageLayer,RectI)const
+            ImageBuffer * cppResult = const_cast<const ::Effect*>(cppSelf)->createImageBuffer(*cppArg0, *cppArg1);
+            pyResult = Shiboken::Conversions::pointerToPython((SbkObjectType*)SbkNatronEngineTypes[SBK_IMAGEBUFFER_IDX], cppResult);
+
+            // Ownership transferences.
+            Shiboken::Object::getOwnership(pyResult);
+        }
+    }
+
+    if (PyErr_Occurred() || !pyResult) {
+        Py_XDECREF(pyResult);
+        return 0;
+    }
+    return pyResult;
+
+    Sbk_EffectFunc_createImageBuffer_TypeError:
+        const char* overloads[] = {"NatronEngine.ImageLayer, NatronEngine.RectI", 0};
+        Shiboken::setErrorAboutWrongArguments(args, "NatronEngine.Effect.createImageBuffer", overloads);
+        return 0;
+}
+
 static PyObject* Sbk_EffectFunc_destroy(PyObject* self, PyObject* args, PyObject* kwds)
 {
     ::Effect* cppSelf = 0;
@@ -1236,6 +1306,85 @@ static PyObject* Sbk_EffectFunc_isWriterNode(PyObject* self)
     return pyResult;
 }
 
+static PyObject* Sbk_EffectFunc_renderImage(PyObject* self, PyObject* args)
+{
+    ::Effect* cppSelf = 0;
+    SBK_UNUSED(cppSelf)
+    if (!Shiboken::Object::isValid(self))
+        return 0;
+    cppSelf = ((::Effect*)Shiboken::Conversions::cppPointer(SbkNatronEngineTypes[SBK_EFFECT_IDX], (SbkObject*)self));
+    PyObject* pyResult = 0;
+    int overloadId = -1;
+    PythonToCppFunc pythonToCpp[] = { 0, 0, 0, 0, 0 };
+    SBK_UNUSED(pythonToCpp)
+    int numArgs = PyTuple_GET_SIZE(args);
+    PyObject* pyArgs[] = {0, 0, 0, 0, 0};
+
+    // invalid argument lengths
+
+
+    if (!PyArg_UnpackTuple(args, "renderImage", 5, 5, &(pyArgs[0]), &(pyArgs[1]), &(pyArgs[2]), &(pyArgs[3]), &(pyArgs[4])))
+        return 0;
+
+
+    // Overloaded function decisor
+    // 0: renderImage(double,int,double,ImageLayer,RectI)const
+    if (numArgs == 5
+        && (pythonToCpp[0] = Shiboken::Conversions::isPythonToCppConvertible(Shiboken::Conversions::PrimitiveTypeConverter<double>(), (pyArgs[0])))
+        && (pythonToCpp[1] = Shiboken::Conversions::isPythonToCppConvertible(Shiboken::Conversions::PrimitiveTypeConverter<int>(), (pyArgs[1])))
+        && (pythonToCpp[2] = Shiboken::Conversions::isPythonToCppConvertible(Shiboken::Conversions::PrimitiveTypeConverter<double>(), (pyArgs[2])))
+        && (pythonToCpp[3] = Shiboken::Conversions::isPythonToCppReferenceConvertible((SbkObjectType*)SbkNatronEngineTypes[SBK_IMAGELAYER_IDX], (pyArgs[3])))
+        && (pythonToCpp[4] = Shiboken::Conversions::isPythonToCppReferenceConvertible((SbkObjectType*)SbkNatronEngineTypes[SBK_RECTI_IDX], (pyArgs[4])))) {
+        overloadId = 0; // renderImage(double,int,double,ImageLayer,RectI)const
+    }
+
+    // Function signature not found.
+    if (overloadId == -1) goto Sbk_EffectFunc_renderImage_TypeError;
+
+    // Call function/method
+    {
+        double cppArg0;
+        pythonToCpp[0](pyArgs[0], &cppArg0);
+        int cppArg1;
+        pythonToCpp[1](pyArgs[1], &cppArg1);
+        double cppArg2;
+        pythonToCpp[2](pyArgs[2], &cppArg2);
+        if (!Shiboken::Object::isValid(pyArgs[3]))
+            return 0;
+        ::ImageLayer cppArg3_local = ::ImageLayer(::QString(), ::QString(), ::QStringList());
+        ::ImageLayer* cppArg3 = &cppArg3_local;
+        if (Shiboken::Conversions::isImplicitConversion((SbkObjectType*)SbkNatronEngineTypes[SBK_IMAGELAYER_IDX], pythonToCpp[3]))
+            pythonToCpp[3](pyArgs[3], &cppArg3_local);
+        else
+            pythonToCpp[3](pyArgs[3], &cppArg3);
+
+        if (!Shiboken::Object::isValid(pyArgs[4]))
+            return 0;
+        ::RectI* cppArg4;
+        pythonToCpp[4](pyArgs[4], &cppArg4);
+
+        if (!PyErr_Occurred()) {
+            // renderImage(double,int,double,ImageLayer,RectI)const
+            ImageBuffer * cppResult = const_cast<const ::Effect*>(cppSelf)->renderImage(cppArg0, cppArg1, cppArg2, *cppArg3, *cppArg4);
+            pyResult = Shiboken::Conversions::pointerToPython((SbkObjectType*)SbkNatronEngineTypes[SBK_IMAGEBUFFER_IDX], cppResult);
+
+            // Ownership transferences.
+            Shiboken::Object::getOwnership(pyResult);
+        }
+    }
+
+    if (PyErr_Occurred() || !pyResult) {
+        Py_XDECREF(pyResult);
+        return 0;
+    }
+    return pyResult;
+
+    Sbk_EffectFunc_renderImage_TypeError:
+        const char* overloads[] = {"float, int, float, NatronEngine.ImageLayer, NatronEngine.RectI", 0};
+        Shiboken::setErrorAboutWrongArguments(args, "NatronEngine.Effect.renderImage", overloads);
+        return 0;
+}
+
 static PyObject* Sbk_EffectFunc_setColor(PyObject* self, PyObject* args)
 {
     ::Effect* cppSelf = 0;
@@ -1592,6 +1741,7 @@ static PyMethodDef Sbk_Effect_methods[] = {
     {"beginChanges", (PyCFunction)Sbk_EffectFunc_beginChanges, METH_NOARGS},
     {"canConnectInput", (PyCFunction)Sbk_EffectFunc_canConnectInput, METH_VARARGS},
     {"connectInput", (PyCFunction)Sbk_EffectFunc_connectInput, METH_VARARGS},
+    {"createImageBuffer", (PyCFunction)Sbk_EffectFunc_createImageBuffer, METH_VARARGS},
     {"destroy", (PyCFunction)Sbk_EffectFunc_destroy, METH_VARARGS|METH_KEYWORDS},
     {"disconnectInput", (PyCFunction)Sbk_EffectFunc_disconnectInput, METH_O},
     {"endChanges", (PyCFunction)Sbk_EffectFunc_endChanges, METH_NOARGS},
@@ -1620,6 +1770,7 @@ static PyMethodDef Sbk_Effect_methods[] = {
     {"isNodeSelected", (PyCFunction)Sbk_EffectFunc_isNodeSelected, METH_NOARGS},
     {"isReaderNode", (PyCFunction)Sbk_EffectFunc_isReaderNode, METH_NOARGS},
     {"isWriterNode", (PyCFunction)Sbk_EffectFunc_isWriterNode, METH_NOARGS},
+    {"renderImage", (PyCFunction)Sbk_EffectFunc_renderImage, METH_VARARGS},
     {"setColor", (PyCFunction)Sbk_EffectFunc_setColor, METH_VARARGS},
     {"setLabel", (PyCFunction)Sbk_EffectFunc_setLabel, METH_O},
     {"setPagesOrder", (PyCFunction)Sbk_EffectFunc_setPagesOrder, METH_O},
@@ -0,0 +1,484 @@
+
+// default includes
+#include "Global/Macros.h"
+CLANG_DIAG_OFF(mismatched-tags)
+GCC_DIAG_OFF(unused-parameter)
+GCC_DIAG_OFF(missing-field-initializers)
+GCC_DIAG_OFF(missing-declarations)
+GCC_DIAG_OFF(uninitialized)
+GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_OFF
+#include <shiboken.h> // produces many warnings
+#include <pysidesignal.h>
+#include <pysideproperty.h>
+#include <pyside.h>
+#include <typeresolver.h>
+#include <typeinfo>
+#include "natronengine_python.h"
+
+#include "imagebuffer_wrapper.h"
+
+// Extra includes
+NATRON_NAMESPACE_USING NATRON_PYTHON_NAMESPACE_USING
+#include <PyNode.h>
+#include <RectI.h>
+
+
+// Begin code injection
+
+static const char*
+ImageBuffer_getFormat(NATRON_NAMESPACE::ImageBitDepthEnum depth)
+{
+    switch (depth) {
+    case NATRON_NAMESPACE::eImageBitDepthByte:
+        return "B";
+    case NATRON_NAMESPACE::eImageBitDepthShort:
+        return "H";
+    case NATRON_NAMESPACE::eImageBitDepthHalf:
+        return "e";
+    case NATRON_NAMESPACE::eImageBitDepthFloat:
+        return "f";
+    case NATRON_NAMESPACE::eImageBitDepthNone:
+        break;
+    }
+
+    return 0;
+}
+
+struct ImageBufferViewInfo
+{
+    Py_ssize_t shape[3];
+    Py_ssize_t strides[3];
+};
+
+// Same as PyBuffer_IsContiguous(), which is not available on the strides before the view is filled
+static bool
+ImageBuffer_isContiguous(const Py_ssize_t* shape, const Py_ssize_t* strides, int ndim, Py_ssize_t itemsize, char order)
+{
+    Py_ssize_t expectedStride = itemsize;
+    for (int i = 0; i < ndim; ++i) {
+        int dim = (order == 'C') ? ndim - 1 - i : i;
+        if (shape[dim] == 0) {
+            return true;
+        }
+        // The stride of a dimension of extent 1 does not matter
+        if ( (shape[dim] > 1) && (strides[dim] != expectedStride) ) {
+            return false;
+        }
+        expectedStride *= shape[dim];
+    }
+
+    return true;
+}
+
+extern "C" {
+static int
+ImageBuffer_getbuffer(PyObject* self, Py_buffer* view, int flags)
+{
+    view->obj = 0;
+    if (!Shiboken::Object::isValid(self)) {
+        return -1;
+    }
+    ::ImageBuffer* cppSelf = ((::ImageBuffer*)Shiboken::Conversions::cppPointer(SbkNatronEngineTypes[SBK_IMAGEBUFFER_IDX], (SbkObject*)self));
+    if ( !cppSelf->isValid() ) {
+        PyErr_SetString(PyExc_BufferError, "the ImageBuffer was released");
+        return -1;
+    }
+    if ( ( (flags & PyBUF_WRITABLE) == PyBUF_WRITABLE ) && !cppSelf->isWritable() ) {
+        PyErr_SetString(PyExc_BufferError, "the ImageBuffer is read-only, pixels are written to an ImageBuffer node with Effect.createImageBuffer");
+        return -1;
+    }
+
+    RectI bounds = cppSelf->getBounds();
+    int nComps = cppSelf->getComponentsCount();
+    int bytesPerComp = cppSelf->getBytesPerComponent();
+
+    ImageBufferViewInfo* info = new ImageBufferViewInfo;
+    info->shape[0] = bounds.height();
+    info->shape[1] = bounds.width();
+    info->shape[2] = nComps;
+    info->strides[0] = cppSelf->getRowBytes();
+    info->strides[1] = nComps * bytesPerComp;
+    info->strides[2] = bytesPerComp;
+
+    // Rows are not contiguous when the buffer is narrower than the image, and the layout is never Fortran-contiguous
+    // unless the extent of all but one dimension is 1
+    bool cContiguous = ImageBuffer_isContiguous(info->shape, info->strides, 3, bytesPerComp, 'C');
+    bool fContiguous = ImageBuffer_isContiguous(info->shape, info->strides, 3, bytesPerComp, 'F');
+    const char* error = 0;
+    if ( (flags & PyBUF_C_CONTIGUOUS) == PyBUF_C_CONTIGUOUS ) {
+        if (!cContiguous) {
+            error = "the ImageBuffer is not C-contiguous";
+        }
+    } else if ( (flags & PyBUF_F_CONTIGUOUS) == PyBUF_F_CONTIGUOUS ) {
+        if (!fContiguous) {
+            error = "the ImageBuffer is not Fortran-contiguous";
+        }
+    } else if ( (flags & PyBUF_ANY_CONTIGUOUS) == PyBUF_ANY_CONTIGUOUS ) {
+        if (!cContiguous && !fContiguous) {
+            error = "the ImageBuffer is not contiguous";
+        }
+    } else if ( ( (flags & PyBUF_STRIDES) != PyBUF_STRIDES ) && !cContiguous ) {
+        // Without strides, the consumer assumes C-contiguous memory
+        error = "the rows of the ImageBuffer are not contiguous, a strided buffer must be requested";
+    }
+    if (error) {
+        delete info;
+        PyErr_SetString(PyExc_BufferError, error);
+        return -1;
+    }
+
+    view->buf = cppSelf->getPixelData();
+    view->len = (Py_ssize_t)bounds.height() * bounds.width() * nComps * bytesPerComp;
+    view->readonly = cppSelf->isWritable() ? 0 : 1;
+    view->itemsize = bytesPerComp;
+    view->format = ( (flags & PyBUF_FORMAT) == PyBUF_FORMAT ) ? const_cast<char*>( ImageBuffer_getFormat( cppSelf->getBitDepth() ) ) : 0;
+    // Without PyBUF_ND, the buffer is seen as a single dimension of len bytes
+    view->ndim = ( (flags & PyBUF_ND) == PyBUF_ND ) ? 3 : 1;
+    view->shape = ( (flags & PyBUF_ND) == PyBUF_ND ) ? info->shape : 0;
+    view->strides = ( (flags & PyBUF_STRIDES) == PyBUF_STRIDES ) ? info->strides : 0;
+    view->suboffsets = 0;
+    view->internal = info;
+
+    // The view keeps the ImageBuffer (and thus the image and its lock) alive
+    cppSelf->retainView();
+    Py_INCREF(self);
+    view->obj = self;
+
+    return 0;
+}
+
+static void
+ImageBuffer_releasebuffer(PyObject* self, Py_buffer* view)
+{
+    delete (ImageBufferViewInfo*)view->internal;
+    view->internal = 0;
+    if (!Shiboken::Object::isValid(self, false)) {
+        return;
+    }
+    ::ImageBuffer* cppSelf = ((::ImageBuffer*)Shiboken::Conversions::cppPointer(SbkNatronEngineTypes[SBK_IMAGEBUFFER_IDX], (SbkObject*)self));
+    cppSelf->releaseView();
+}
+} // extern "C"
+
+static PyBufferProcs ImageBuffer_BufferProcs;
+
+// End of code injection
+
+
+// Target ---------------------------------------------------------
+
+extern "C" {
+static PyObject* Sbk_ImageBufferFunc_getBitDepth(PyObject* self)
+{
+    ::ImageBuffer* cppSelf = 0;
+    SBK_UNUSED(cppSelf)
+    if (!Shiboken::Object::isValid(self))
+        return 0;
+    cppSelf = ((::ImageBuffer*)Shiboken::Conversions::cppPointer(SbkNatronEngineTypes[SBK_IMAGEBUFFER_IDX], (SbkObject*)self));
+    PyObject* pyResult = 0;
+
+    // Call function/method
+    {
+
+        if (!PyErr_Occurred()) {
+            // getBitDepth()const
+            NATRON_NAMESPACE::ImageBitDepthEnum cppResult = NATRON_NAMESPACE::ImageBitDepthEnum(const_cast<const ::ImageBuffer*>(cppSelf)->getBitDepth());
+            pyResult = Shiboken::Conversions::copyToPython(SBK_CONVERTER(SbkNatronEngineTypes[SBK_NATRON_NAMESPACE_IMAGEBITDEPTHENUM_IDX]), &cppResult);
+        }
+    }
+
+    if (PyErr_Occurred() || !pyResult) {
+        Py_XDECREF(pyResult);
+        return 0;
+    }
+    return pyResult;
+}
+
+static PyObject* Sbk_ImageBufferFunc_getBounds(PyObject* self)
+{
+    ::ImageBuffer* cppSelf = 0;
+    SBK_UNUSED(cppSelf)
+    if (!Shiboken::Object::isValid(self))
+        return 0;
+    cppSelf = ((::ImageBuffer*)Shiboken::Conversions::cppPointer(SbkNatronEngineTypes[SBK_IMAGEBUFFER_IDX], (SbkObject*)self));
+    PyObject* pyResult = 0;
+
+    // Call function/method
+    {
+
+        if (!PyErr_Occurred()) {
+            // getBounds()const
+            RectI* cppResult = new RectI(const_cast<const ::ImageBuffer*>(cppSelf)->getBounds());
+            pyResult = Shiboken::Object::newObject((SbkObjectType*)SbkNatronEngineTypes[SBK_RECTI_IDX], cppResult, true, true);
+        }
+    }
+
+    if (PyErr_Occurred() || !pyResult) {
+        Py_XDECREF(pyResult);
+        return 0;
+    }
+    return pyResult;
+}
+
+static PyObject* Sbk_ImageBufferFunc_getComponentsCount(PyObject* self)
+{
+    ::ImageBuffer* cppSelf = 0;
+    SBK_UNUSED(cppSelf)
+    if (!Shiboken::Object::isValid(self))
+        return 0;
+    cppSelf = ((::ImageBuffer*)Shiboken::Conversions::cppPointer(SbkNatronEngineTypes[SBK_IMAGEBUFFER_IDX], (SbkObject*)self));
+    PyObject* pyResult = 0;
+
+    // Call function/method
+    {
+
+        if (!PyErr_Occurred()) {
+            // getComponentsCount()const
+            int cppResult = const_cast<const ::ImageBuffer*>(cppSelf)->getComponentsCount();
+            pyResult = Shiboken::Conversions::copyToPython(Shiboken::Conversions::PrimitiveTypeConverter<int>(), &cppResult);
+        }
+    }
+
+    if (PyErr_Occurred() || !pyResult) {
+        Py_XDECREF(pyResult);
+        return 0;
+    }
+    return pyResult;
+}
+
+static PyObject* Sbk_ImageBufferFunc_getLayer(PyObject* self)
+{
+    ::ImageBuffer* cppSelf = 0;
+    SBK_UNUSED(cppSelf)
+    if (!Shiboken::Object::isValid(self))
+        return 0;
+    cppSelf = ((::ImageBuffer*)Shiboken::Conversions::cppPointer(SbkNatronEngineTypes[SBK_IMAGEBUFFER_IDX], (SbkObject*)self));
+    PyObject* pyResult = 0;
+
+    // Call function/method
+    {
+
+        if (!PyErr_Occurred()) {
+            // getLayer()const
+            ImageLayer cppResult = const_cast<const ::ImageBuffer*>(cppSelf)->getLayer();
+            pyResult = Shiboken::Conversions::copyToPython((SbkObjectType*)SbkNatronEngineTypes[SBK_IMAGELAYER_IDX], &cppResult);
+        }
+    }
+
+    if (PyErr_Occurred() || !pyResult) {
+        Py_XDECREF(pyResult);
+        return 0;
+    }
+    return pyResult;
+}
+
+static PyObject* Sbk_ImageBufferFunc_isValid(PyObject* self)
+{
+    ::ImageBuffer* cppSelf = 0;
+    SBK_UNUSED(cppSelf)
+    if (!Shiboken::Object::isValid(self))
+        return 0;
+    cppSelf = ((::ImageBuffer*)Shiboken::Conversions::cppPointer(SbkNatronEngineTypes[SBK_IMAGEBUFFER_IDX], (SbkObject*)self));
+    PyObject* pyResult = 0;
+
+    // Call function/method
+    {
+
+        if (!PyErr_Occurred()) {
+            // isValid()const
+            bool cppResult = const_cast<const ::ImageBuffer*>(cppSelf)->isValid();
+            pyResult = Shiboken::Conversions::copyToPython(Shiboken::Conversions::PrimitiveTypeConverter<bool>(), &cppResult);
+        }
+    }
+
+    if (PyErr_Occurred() || !pyResult) {
+        Py_XDECREF(pyResult);
+        return 0;
+    }
+    return pyResult;
+}
+
+static PyObject* Sbk_ImageBufferFunc_isWritable(PyObject* self)
+{
+    ::ImageBuffer* cppSelf = 0;
+    SBK_UNUSED(cppSelf)
+    if (!Shiboken::Object::isValid(self))
+        return 0;
+    cppSelf = ((::ImageBuffer*)Shiboken::Conversions::cppPointer(SbkNatronEngineTypes[SBK_IMAGEBUFFER_IDX], (SbkObject*)self));
+    PyObject* pyResult = 0;
+
+    // Call function/method
+    {
+
+        if (!PyErr_Occurred()) {
+            // isWritable()const
+            bool cppResult = const_cast<const ::ImageBuffer*>(cppSelf)->isWritable();
+            pyResult = Shiboken::Conversions::copyToPython(Shiboken::Conversions::PrimitiveTypeConverter<bool>(), &cppResult);
+        }
+    }
+
+    if (PyErr_Occurred() || !pyResult) {
+        Py_XDECREF(pyResult);
+        return 0;
+    }
+    return pyResult;
+}
+
+static PyObject* Sbk_ImageBufferFunc_release(PyObject* self)
+{
+    ::ImageBuffer* cppSelf = 0;
+    SBK_UNUSED(cppSelf)
+    if (!Shiboken::Object::isValid(self))
+        return 0;
+    cppSelf = ((::ImageBuffer*)Shiboken::Conversions::cppPointer(SbkNatronEngineTypes[SBK_IMAGEBUFFER_IDX], (SbkObject*)self));
+
+    // Call function/method
+    {
+
+        if (!PyErr_Occurred()) {
+            // release()
+            cppSelf->release();
+        }
+    }
+
+    if (PyErr_Occurred()) {
+        return 0;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyMethodDef Sbk_ImageBuffer_methods[] = {
+    {"getBitDepth", (PyCFunction)Sbk_ImageBufferFunc_getBitDepth, METH_NOARGS},
+    {"getBounds", (PyCFunction)Sbk_ImageBufferFunc_getBounds, METH_NOARGS},
+    {"getComponentsCount", (PyCFunction)Sbk_ImageBufferFunc_getComponentsCount, METH_NOARGS},
+    {"getLayer", (PyCFunction)Sbk_ImageBufferFunc_getLayer, METH_NOARGS},
+    {"isValid", (PyCFunction)Sbk_ImageBufferFunc_isValid, METH_NOARGS},
+    {"isWritable", (PyCFunction)Sbk_ImageBufferFunc_isWritable, METH_NOARGS},
+    {"release", (PyCFunction)Sbk_ImageBufferFunc_release, METH_NOARGS},
+
+    {0} // Sentinel
+};
+
+} // extern "C"
+
+static int Sbk_ImageBuffer_traverse(PyObject* self, visitproc visit, void* arg)
+{
+    return reinterpret_cast<PyTypeObject*>(&SbkObject_Type)->tp_traverse(self, visit, arg);
+}
+static int Sbk_ImageBuffer_clear(PyObject* self)
+{
+    return reinterpret_cast<PyTypeObject*>(&SbkObject_Type)->tp_clear(self);
+}
+// Class Definition -----------------------------------------------
+extern "C" {
+static SbkObjectType Sbk_ImageBuffer_Type = { { {
+    PyVarObject_HEAD_INIT(&SbkObjectType_Type, 0)
+    /*tp_name*/             "NatronEngine.ImageBuffer",
+    /*tp_basicsize*/        sizeof(SbkObject),
+    /*tp_itemsize*/         0,
+    /*tp_dealloc*/          &SbkDeallocWrapper,
+    /*tp_print*/            0,
+    /*tp_getattr*/          0,
+    /*tp_setattr*/          0,
+    /*tp_compare*/          0,
+    /*tp_repr*/             0,
+    /*tp_as_number*/        0,
+    /*tp_as_sequence*/      0,
+    /*tp_as_mapping*/       0,
+    /*tp_hash*/             0,
+    /*tp_call*/             0,
+    /*tp_str*/              0,
+    /*tp_getattro*/         0,
+    /*tp_setattro*/         0,
+    /*tp_as_buffer*/        0,
+    /*tp_flags*/            Py_TPFLAGS_DEFAULT|Py_TPFLAGS_CHECKTYPES|Py_TPFLAGS_HAVE_GC,
+    /*tp_doc*/              0,
+    /*tp_traverse*/         Sbk_ImageBuffer_traverse,
+    /*tp_clear*/            Sbk_ImageBuffer_clear,
+    /*tp_richcompare*/      0,
+    /*tp_weaklistoffset*/   0,
+    /*tp_iter*/             0,
+    /*tp_iternext*/         0,
+    /*tp_methods*/          Sbk_ImageBuffer_methods,
+    /*tp_members*/          0,
+    /*tp_getset*/           0,
+    /*tp_base*/             reinterpret_cast<PyTypeObject*>(&SbkObject_Type),
+    /*tp_dict*/             0,
+    /*tp_descr_get*/        0,
+    /*tp_descr_set*/        0,
+    /*tp_dictoffset*/       0,
+    /*tp_init*/             0,
+    /*tp_alloc*/            0,
+    /*tp_new*/              0,
+    /*tp_free*/             0,
+    /*tp_is_gc*/            0,
+    /*tp_bases*/            0,
+    /*tp_mro*/              0,
+    /*tp_cache*/            0,
+    /*tp_subclasses*/       0,
+    /*tp_weaklist*/         0
+}, },
+    /*priv_data*/           0
+};
+} //extern
+
+
+// Type conversion functions.
+
+// Python to C++ pointer conversion - returns the C++ object of the Python wrapper (keeps object identity).
+static void ImageBuffer_PythonToCpp_ImageBuffer_PTR(PyObject* pyIn, void* cppOut) {
+    Shiboken::Conversions::pythonToCppPointer(&Sbk_ImageBuffer_Type, pyIn, cppOut);
+}
+static PythonToCppFunc is_ImageBuffer_PythonToCpp_ImageBuffer_PTR_Convertible(PyObject* pyIn) {
+    if (pyIn == Py_None)
+        return Shiboken::Conversions::nonePythonToCppNullPtr;
+    if (PyObject_TypeCheck(pyIn, (PyTypeObject*)&Sbk_ImageBuffer_Type))
+        return ImageBuffer_PythonToCpp_ImageBuffer_PTR;
+    return 0;
+}
+
+// C++ to Python pointer conversion - tries to find the Python wrapper for the C++ object (keeps object identity).
+static PyObject* ImageBuffer_PTR_CppToPython_ImageBuffer(const void* cppIn) {
+    PyObject* pyOut = (PyObject*)Shiboken::BindingManager::instance().retrieveWrapper(cppIn);
+    if (pyOut) {
+        Py_INCREF(pyOut);
+        return pyOut;
+    }
+    const char* typeName = typeid(*((::ImageBuffer*)cppIn)).name();
+    return Shiboken::Object::newObject(&Sbk_ImageBuffer_Type, const_cast<void*>(cppIn), false, false, typeName);
+}
+
+void init_ImageBuffer(PyObject* module)
+{
+    SbkNatronEngineTypes[SBK_IMAGEBUFFER_IDX] = reinterpret_cast<PyTypeObject*>(&Sbk_ImageBuffer_Type);
+    // Begin code injection
+
+    ImageBuffer_BufferProcs.bf_getbuffer = ImageBuffer_getbuffer;
+    ImageBuffer_BufferProcs.bf_releasebuffer = ImageBuffer_releasebuffer;
+    Sbk_ImageBuffer_Type.super.ht_type.tp_as_buffer = &ImageBuffer_BufferProcs;
+    #if PY_MAJOR_VERSION < 3
+    Sbk_ImageBuffer_Type.super.ht_type.tp_flags |= Py_TPFLAGS_HAVE_NEWBUFFER;
+    #endif
+
+    // End of code injection
+
+
+    if (!Shiboken::ObjectType::introduceWrapperType(module, "ImageBuffer", "ImageBuffer*",
+        &Sbk_ImageBuffer_Type, &Shiboken::callCppDestructor< ::ImageBuffer >)) {
+        return;
+    }
+
+    // Register Converter
+    SbkConverter* converter = Shiboken::Conversions::createConverter(&Sbk_ImageBuffer_Type,
+        ImageBuffer_PythonToCpp_ImageBuffer_PTR,
+        is_ImageBuffer_PythonToCpp_ImageBuffer_PTR_Convertible,
+        ImageBuffer_PTR_CppToPython_ImageBuffer);
+
+    Shiboken::Conversions::registerConverterName(converter, "ImageBuffer");
+    Shiboken::Conversions::registerConverterName(converter, "ImageBuffer*");
+    Shiboken::Conversions::registerConverterName(converter, "ImageBuffer&");
+    Shiboken::Conversions::registerConverterName(converter, typeid(::ImageBuffer).name());
+
+
+
+}
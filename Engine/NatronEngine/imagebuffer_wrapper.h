@@ -0,0 +1,9 @@
+#ifndef SBK_IMAGEBUFFER_H
+#define SBK_IMAGEBUFFER_H
+
+#include <shiboken.h>
+
+#include <PyNode.h>
+
+#endif // SBK_IMAGEBUFFER_H
+
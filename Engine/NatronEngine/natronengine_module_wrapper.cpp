@@ -42,6 +42,7 @@ void init_Roto(PyObject* module);
 void init_Track(PyObject* module);
 void init_Tracker(PyObject* module);
 void init_ImageLayer(PyObject* module);
+void init_ImageBuffer(PyObject* module);
 void init_UserParamHolder(PyObject* module);
 void init_Param(PyObject* module);
 void init_AnimatedParam(PyObject* module);
@@ -73,6 +74,7 @@ void init_ExprUtils(PyObject* module);
 void init_PyCoreApplication(PyObject* module);
 void init_Group(PyObject* module);
 void init_Effect(PyObject* module);
+void init_ChangeTransaction(PyObject* module);
 void init_App(PyObject* module);
 void init_AppSettings(PyObject* module);
 void init_NodeCreationProperty(PyObject* module);
@@ -865,6 +867,7 @@ SBK_MODULE_INIT_FUNCTION_BEGIN(NatronEngine)
     init_Track(module);
     init_Tracker(module);
     init_ImageLayer(module);
+    init_ImageBuffer(module);
     init_UserParamHolder(module);
     init_Param(module);
     init_AnimatedParam(module);
@@ -896,6 +899,7 @@ SBK_MODULE_INIT_FUNCTION_BEGIN(NatronEngine)
     init_PyCoreApplication(module);
     init_Group(module);
     init_Effect(module);
+    init_ChangeTransaction(module);
     init_App(module);
     init_AppSettings(module);
     init_NodeCreationProperty(module);
@@ -59,71 +59,73 @@ CLANG_DIAG_ON(keyword-macro)
 #include <set>
 
 // Type indices
-#define SBK_NATRON_NAMESPACE_IDX                                     30
-#define SBK_NATRON_NAMESPACE_STATUSENUM_IDX                          41
-#define SBK_NATRON_NAMESPACE_STANDARDBUTTONENUM_IDX                  40
-#define SBK_QFLAGS_NATRON_NAMESPACE_STANDARDBUTTONENUM__IDX          52
-#define SBK_NATRON_NAMESPACE_KEYFRAMETYPEENUM_IDX                    35
-#define SBK_NATRON_NAMESPACE_PIXMAPENUM_IDX                          38
-#define SBK_NATRON_NAMESPACE_VALUECHANGEDREASONENUM_IDX              42
-#define SBK_NATRON_NAMESPACE_ANIMATIONLEVELENUM_IDX                  31
-#define SBK_NATRON_NAMESPACE_IMAGEPREMULTIPLICATIONENUM_IDX          34
-#define SBK_NATRON_NAMESPACE_VIEWERCOMPOSITINGOPERATORENUM_IDX       44
-#define SBK_NATRON_NAMESPACE_VIEWERCOLORSPACEENUM_IDX                43
-#define SBK_NATRON_NAMESPACE_IMAGEBITDEPTHENUM_IDX                   33
-#define SBK_NATRON_NAMESPACE_ORIENTATIONENUM_IDX                     37
-#define SBK_NATRON_NAMESPACE_PLAYBACKMODEENUM_IDX                    39
-#define SBK_NATRON_NAMESPACE_DISPLAYCHANNELSENUM_IDX                 32
-#define SBK_NATRON_NAMESPACE_MERGINGFUNCTIONENUM_IDX                 36
-#define SBK_RECTD_IDX                                                53
-#define SBK_RECTI_IDX                                                54
-#define SBK_NODECREATIONPROPERTY_IDX                                 45
+#define SBK_NATRON_NAMESPACE_IDX                                     32
+#define SBK_NATRON_NAMESPACE_STATUSENUM_IDX                          43
+#define SBK_NATRON_NAMESPACE_STANDARDBUTTONENUM_IDX                  42
+#define SBK_QFLAGS_NATRON_NAMESPACE_STANDARDBUTTONENUM__IDX          54
+#define SBK_NATRON_NAMESPACE_KEYFRAMETYPEENUM_IDX                    37
+#define SBK_NATRON_NAMESPACE_PIXMAPENUM_IDX                          40
+#define SBK_NATRON_NAMESPACE_VALUECHANGEDREASONENUM_IDX              44
+#define SBK_NATRON_NAMESPACE_ANIMATIONLEVELENUM_IDX                  33
+#define SBK_NATRON_NAMESPACE_IMAGEPREMULTIPLICATIONENUM_IDX          36
+#define SBK_NATRON_NAMESPACE_VIEWERCOMPOSITINGOPERATORENUM_IDX       46
+#define SBK_NATRON_NAMESPACE_VIEWERCOLORSPACEENUM_IDX                45
+#define SBK_NATRON_NAMESPACE_IMAGEBITDEPTHENUM_IDX                   35
+#define SBK_NATRON_NAMESPACE_ORIENTATIONENUM_IDX                     39
+#define SBK_NATRON_NAMESPACE_PLAYBACKMODEENUM_IDX                    41
+#define SBK_NATRON_NAMESPACE_DISPLAYCHANNELSENUM_IDX                 34
+#define SBK_NATRON_NAMESPACE_MERGINGFUNCTIONENUM_IDX                 38
+#define SBK_RECTD_IDX                                                55
+#define SBK_RECTI_IDX                                                56
+#define SBK_NODECREATIONPROPERTY_IDX                                 47
 #define SBK_BOOLNODECREATIONPROPERTY_IDX                             4
-#define SBK_INTNODECREATIONPROPERTY_IDX                              26
+#define SBK_INTNODECREATIONPROPERTY_IDX                              28
 #define SBK_APPSETTINGS_IDX                                          2
-#define SBK_GROUP_IDX                                                19
-#define SBK_PYCOREAPPLICATION_IDX                                    51
-#define SBK_EXPRUTILS_IDX                                            16
-#define SBK_COLORTUPLE_IDX                                           9
-#define SBK_DOUBLE3DTUPLE_IDX                                        13
-#define SBK_DOUBLE2DTUPLE_IDX                                        11
-#define SBK_INT3DTUPLE_IDX                                           25
-#define SBK_INT2DTUPLE_IDX                                           23
-#define SBK_PARAM_IDX                                                48
-#define SBK_GROUPPARAM_IDX                                           20
-#define SBK_SEPARATORPARAM_IDX                                       56
+#define SBK_GROUP_IDX                                                20
+#define SBK_PYCOREAPPLICATION_IDX                                    53
+#define SBK_EXPRUTILS_IDX                                            17
+#define SBK_COLORTUPLE_IDX                                           10
+#define SBK_DOUBLE3DTUPLE_IDX                                        14
+#define SBK_DOUBLE2DTUPLE_IDX                                        12
+#define SBK_INT3DTUPLE_IDX                                           27
+#define SBK_INT2DTUPLE_IDX                                           25
+#define SBK_PARAM_IDX                                                50
+#define SBK_GROUPPARAM_IDX                                           21
+#define SBK_SEPARATORPARAM_IDX                                       58
 #define SBK_BUTTONPARAM_IDX                                          6
 #define SBK_ANIMATEDPARAM_IDX                                        0
-#define SBK_DOUBLEPARAM_IDX                                          14
-#define SBK_DOUBLE2DPARAM_IDX                                        10
-#define SBK_DOUBLE3DPARAM_IDX                                        12
-#define SBK_INTPARAM_IDX                                             27
-#define SBK_INT2DPARAM_IDX                                           22
-#define SBK_INT3DPARAM_IDX                                           24
-#define SBK_STRINGPARAMBASE_IDX                                      60
-#define SBK_PATHPARAM_IDX                                            50
-#define SBK_OUTPUTFILEPARAM_IDX                                      46
-#define SBK_FILEPARAM_IDX                                            17
-#define SBK_STRINGPARAM_IDX                                          58
-#define SBK_STRINGPARAM_TYPEENUM_IDX                                 59
+#define SBK_DOUBLEPARAM_IDX                                          15
+#define SBK_DOUBLE2DPARAM_IDX                                        11
+#define SBK_DOUBLE3DPARAM_IDX                                        13
+#define SBK_INTPARAM_IDX                                             29
+#define SBK_INT2DPARAM_IDX                                           24
+#define SBK_INT3DPARAM_IDX                                           26
+#define SBK_STRINGPARAMBASE_IDX                                      62
+#define SBK_PATHPARAM_IDX                                            52
+#define SBK_OUTPUTFILEPARAM_IDX                                      48
+#define SBK_FILEPARAM_IDX                                            18
+#define SBK_STRINGPARAM_IDX                                          60
+#define SBK_STRINGPARAM_TYPEENUM_IDX                                 61
 #define SBK_BOOLEANPARAM_IDX                                         5
-#define SBK_CHOICEPARAM_IDX                                          7
-#define SBK_COLORPARAM_IDX                                           8
-#define SBK_PARAMETRICPARAM_IDX                                      49
-#define SBK_PAGEPARAM_IDX                                            47
+#define SBK_CHOICEPARAM_IDX                                          8
+#define SBK_COLORPARAM_IDX                                           9
+#define SBK_PARAMETRICPARAM_IDX                                      51
+#define SBK_PAGEPARAM_IDX                                            49
+#define SBK_CHANGETRANSACTION_IDX                                    7
 #define SBK_APP_IDX                                                  1
-#define SBK_STRINGNODECREATIONPROPERTY_IDX                           57
-#define SBK_FLOATNODECREATIONPROPERTY_IDX                            18
-#define SBK_USERPARAMHOLDER_IDX                                      63
-#define SBK_EFFECT_IDX                                               15
-#define SBK_IMAGELAYER_IDX                                           21
-#define SBK_TRACKER_IDX                                              62
-#define SBK_TRACK_IDX                                                61
-#define SBK_ROTO_IDX                                                 55
-#define SBK_ITEMBASE_IDX                                             28
+#define SBK_STRINGNODECREATIONPROPERTY_IDX                           59
+#define SBK_FLOATNODECREATIONPROPERTY_IDX                            19
+#define SBK_USERPARAMHOLDER_IDX                                      65
+#define SBK_EFFECT_IDX                                               16
+#define SBK_IMAGEBUFFER_IDX                                          22
+#define SBK_IMAGELAYER_IDX                                           23
+#define SBK_TRACKER_IDX                                              64
+#define SBK_TRACK_IDX                                                63
+#define SBK_ROTO_IDX                                                 57
+#define SBK_ITEMBASE_IDX                                             30
 #define SBK_BEZIERCURVE_IDX                                          3
-#define SBK_LAYER_IDX                                                29
-#define SBK_NatronEngine_IDX_COUNT                                   64
+#define SBK_LAYER_IDX                                                31
+#define SBK_NatronEngine_IDX_COUNT                                   66
 
 // This variable stores all Python types exported by this module.
 extern PyTypeObject** SbkNatronEngineTypes;
@@ -212,6 +214,7 @@ template<> inline PyTypeObject* SbkType<NATRON_NAMESPACE::NATRON_PYTHON_NAMESPAC
 template<> inline PyTypeObject* SbkType<NATRON_NAMESPACE::NATRON_PYTHON_NAMESPACE::ColorParam >() { return reinterpret_cast<PyTypeObject*>(SbkNatronEngineTypes[SBK_COLORPARAM_IDX]); }
 template<> inline PyTypeObject* SbkType<NATRON_NAMESPACE::NATRON_PYTHON_NAMESPACE::ParametricParam >() { return reinterpret_cast<PyTypeObject*>(SbkNatronEngineTypes[SBK_PARAMETRICPARAM_IDX]); }
 template<> inline PyTypeObject* SbkType<NATRON_NAMESPACE::NATRON_PYTHON_NAMESPACE::PageParam >() { return reinterpret_cast<PyTypeObject*>(SbkNatronEngineTypes[SBK_PAGEPARAM_IDX]); }
+template<> inline PyTypeObject* SbkType<NATRON_NAMESPACE::NATRON_PYTHON_NAMESPACE::ChangeTransaction >() { return reinterpret_cast<PyTypeObject*>(SbkNatronEngineTypes[SBK_CHANGETRANSACTION_IDX]); }
 template<> inline PyTypeObject* SbkType<NATRON_NAMESPACE::NATRON_PYTHON_NAMESPACE::App >() { return reinterpret_cast<PyTypeObject*>(SbkNatronEngineTypes[SBK_APP_IDX]); }
 template<> inline PyTypeObject* SbkType<NATRON_NAMESPACE::NATRON_PYTHON_NAMESPACE::StringNodeCreationProperty >() { return reinterpret_cast<PyTypeObject*>(SbkNatronEngineTypes[SBK_STRINGNODECREATIONPROPERTY_IDX]); }
 template<> inline PyTypeObject* SbkType<NATRON_NAMESPACE::NATRON_PYTHON_NAMESPACE::FloatNodeCreationProperty >() { return reinterpret_cast<PyTypeObject*>(SbkNatronEngineTypes[SBK_FLOATNODECREATIONPROPERTY_IDX]); }
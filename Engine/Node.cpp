@@ -29,6 +29,7 @@
 #include <algorithm> // min, max
 #include <bitset>
 #include <cassert>
+#include <set>
 #include <stdexcept>
 #include <sstream> // stringstream
 
@@ -892,9 +893,19 @@ Node::computeHashRecursive(std::list<Node*>& marked)
     }
 
 
-    bool isRotoPaint = _imp->effect->isRotoPaintNode();
+    NodesList dependents;
+    getHashDependents(&dependents);
+    for (NodesList::iterator it = dependents.begin(); it != dependents.end(); ++it) {
+        (*it)->computeHashRecursive(marked);
+    }
+}
+
+void
+Node::getHashDependents(NodesList* dependents) const
+{
+    bool isRotoPaint = _imp->effect && _imp->effect->isRotoPaintNode();
 
-    ///call it on all the outputs
+    ///The outputs hash depend on this node's hash
     NodesList outputs;
     getOutputsWithGroupRedirection(outputs);
     for (NodesList::iterator it = outputs.begin(); it != outputs.end(); ++it) {
@@ -905,16 +916,60 @@ Node::computeHashRecursive(std::list<Node*>& marked)
         if ( isRotoPaint && attachedStroke && (attachedStroke->getContext()->getNode().get() == this) ) {
             continue;
         }
-        (*it)->computeHashRecursive(marked);
+        dependents->push_back(*it);
     }
 
 
-    ///If the node has a rotopaint tree, compute the hash of the nodes in the tree
+    ///If the node has a rotopaint tree, the nodes in the tree too
     if (_imp->rotoContext) {
-        NodesList allItems;
-        _imp->rotoContext->getRotoPaintTreeNodes(&allItems);
-        for (NodesList::iterator it = allItems.begin(); it != allItems.end(); ++it) {
-            (*it)->computeHashRecursive(marked);
+        _imp->rotoContext->getRotoPaintTreeNodes(dependents);
+    }
+}
+
+static void
+sortNodesForHashRecursive(const NodePtr& node,
+                          std::set<Node*>& visited,
+                          NodesList* postOrder)
+{
+    if ( !visited.insert( node.get() ).second ) {
+        return;
+    }
+    NodesList dependents;
+    node->getHashDependents(&dependents);
+    for (NodesList::iterator it = dependents.begin(); it != dependents.end(); ++it) {
+        sortNodesForHashRecursive(*it, visited, postOrder);
+    }
+    postOrder->push_front(node);
+}
+
+void
+Node::computeHashOfNodes(const NodesList& nodes)
+{
+    assert( QThread::currentThread() == qApp->thread() );
+
+    // Sort the nodes and everything downstream so that a node comes before the nodes depending on its hash
+    std::set<Node*> visited;
+    NodesList sorted;
+    for (NodesList::const_iterator it = nodes.begin(); it != nodes.end(); ++it) {
+        sortNodesForHashRecursive(*it, visited, &sorted);
+    }
+
+    // Compute each hash once, after all its inputs, and only if the node or one of its inputs changed
+    std::set<Node*> dirty;
+    for (NodesList::const_iterator it = nodes.begin(); it != nodes.end(); ++it) {
+        dirty.insert( it->get() );
+    }
+    for (NodesList::iterator it = sorted.begin(); it != sorted.end(); ++it) {
+        if ( dirty.find( it->get() ) == dirty.end() ) {
+            continue;
+        }
+        if ( !(*it)->computeHashInternal() ) {
+            continue;
+        }
+        NodesList dependents;
+        (*it)->getHashDependents(&dependents);
+        for (NodesList::iterator it2 = dependents.begin(); it2 != dependents.end(); ++it2) {
+            dirty.insert( it2->get() );
         }
     }
 }
@@ -972,6 +1027,11 @@ Node::computeHash()
 
         return;
     }
+    AppInstancePtr app = getApp();
+    if ( app && app->deferNodeHashComputation( shared_from_this() ) ) {
+        // Computed once with the other nodes modified in the change transaction, when it is committed
+        return;
+    }
     std::list<Node*> marked;
     computeHashRecursive(marked);
 } // computeHash
@@ -1838,6 +1898,24 @@ Node::createNodePage(const KnobPagePtr& settingsPage)
         _imp->openglRenderingEnabledKnob = openglRenderingKnob;
     }
 
+    KnobChoicePtr cacheStorageKnob = AppManager::createKnob<KnobChoice>(_imp->effect.get(), tr("Cache storage"), 1, false);
+    cacheStorageKnob->setAnimationEnabled(false);
+    {
+        std::vector<ChoiceOption> entries;
+        entries.push_back(ChoiceOption("Default", "", tr("Use the \"Store cached images as half floats\" preference.").toStdString() ));
+        entries.push_back(ChoiceOption("Float", "", tr("Always keep the images of this node in the cache in full precision.").toStdString() ));
+        entries.push_back(ChoiceOption("Half", "", tr("Convert the images of this node to half floats when the cache is full.").toStdString() ));
+        cacheStorageKnob->populateChoices(entries);
+    }
+    cacheStorageKnob->setName("cacheStorage");
+    cacheStorageKnob->setIsPersistent(true);
+    cacheStorageKnob->setEvaluateOnChange(false);
+    cacheStorageKnob->setHintToolTip( tr("Select whether the floating point images of this node may be converted to 16-bit half floats when the "
+                                         "RAM cache is full, to halve their memory footprint. Only the color plane is converted, and only if no "
+                                         "value changes by more than the \"Half float maximum error\" preference.") );
+    settingsPage->addKnob(cacheStorageKnob);
+    _imp->cacheStorage = cacheStorageKnob;
+
 
     KnobStringPtr knobChangedCallback = AppManager::createKnob<KnobString>(_imp->effect.get(), tr("After param changed callback"), 1, false);
     knobChangedCallback->setHintToolTip( tr("Set here the name of a function defined in Python which will be called for each  "
@@ -2602,6 +2680,22 @@ Node::isForceCachingEnabled() const
     return b ? b->getValue() : false;
 }
 
+bool
+Node::isHalfCacheStorageEnabled() const
+{
+    KnobChoicePtr k = _imp->cacheStorage.lock();
+    int index = k ? k->getValue() : 0;
+
+    switch (index) {
+    case 1: // Float
+        return false;
+    case 2: // Half
+        return true;
+    default:
+        return appPTR->getCurrentSettings()->isHalfCacheStorageEnabled();
+    }
+}
+
 void
 Node::onSetSupportRenderScaleMaybeSet(int support)
 {
@@ -3249,6 +3343,115 @@ renderPreviewForDepth(const Image & srcImg,
     }
 }     // renderPreviewForDepth
 
+///Fills the preview buffer from the given image, whatever its bit depth
+void
+renderPreviewFromImage(const Image & img,
+                       bool convertToSrgb,
+                       int *width,
+                       int *height,
+                       unsigned int* buf)
+{
+    int elemCount = img.getComponents().getNumComponents();
+
+    switch ( img.getBitDepth() ) {
+    case eImageBitDepthByte: {
+        renderPreviewForDepth<unsigned char, 255>(img, elemCount, width, height, convertToSrgb, buf);
+        break;
+    }
+    case eImageBitDepthShort: {
+        renderPreviewForDepth<unsigned short, 65535>(img, elemCount, width, height, convertToSrgb, buf);
+        break;
+    }
+    case eImageBitDepthHalf:
+        break;
+    case eImageBitDepthFloat: {
+        renderPreviewForDepth<float, 1>(img, elemCount, width, height, convertToSrgb, buf);
+        break;
+    }
+    case eImageBitDepthNone:
+        break;
+    }
+}
+
+///The mipmap level at which a preview of the given size is made for an image with the given region of definition
+unsigned int
+getPreviewMipMapLevel(const RectD & rod,
+                      int width,
+                      int height)
+{
+    double yZoomFactor = (double)height / (double)rod.height();
+    double xZoomFactor = (double)width / (double)rod.width();
+    double closestPowerOf2X = xZoomFactor >= 1 ? 1 : std::pow( 2, -std::ceil( std::log(xZoomFactor) / std::log(2.) ) );
+    double closestPowerOf2Y = yZoomFactor >= 1 ? 1 : std::pow( 2, -std::ceil( std::log(yZoomFactor) / std::log(2.) ) );
+    int closestPowerOf2 = std::max(closestPowerOf2X, closestPowerOf2Y);
+
+    return std::min(std::log( (double)closestPowerOf2 ) / std::log(2.), 5.);
+}
+
+/**
+ * @brief Returns the best image of the effect at the given time found in the RAM cache to make a preview at the given mipmap level:
+ * an image of the color plane covering the whole region of definition, preferably at the given level, otherwise at the closest
+ * finer level (which is downscaled), otherwise at the closest coarser level.
+ **/
+ImagePtr
+findCachedPreviewSource(EffectInstance* effect,
+                        U64 nodeHash,
+                        double time,
+                        const RectD & rod,
+                        unsigned int mipMapLevel)
+{
+    const bool frameVaryingOrAnimated = effect->isFrameVaryingOrAnimated_Recursive();
+    const double par = effect->getAspectRatio(-1);
+    ImagePtr best;
+
+    // The images rendered by the viewer may have been rendered in draft mode and with full scale input images
+    for (int draft = 0; draft < 2; ++draft) {
+        for (int fullScaleWithDownscaleInputs = 0; fullScaleWithDownscaleInputs < 2; ++fullScaleWithDownscaleInputs) {
+            ImageKey key = Image::makeKey(effect->getNode().get(), nodeHash, frameVaryingOrAnimated, time, ViewIdx(0), (bool)draft, (bool)fullScaleWithDownscaleInputs);
+            std::list<ImagePtr> cachedImages;
+            // Probing must not make the images more likely to stay in the cache nor count as cache hits
+            if ( !appPTR->peekImage(key, &cachedImages) ) {
+                continue;
+            }
+            for (std::list<ImagePtr>::const_iterator it = cachedImages.begin(); it != cachedImages.end(); ++it) {
+                const ImagePtr& img = *it;
+                if ( (img->getStorageMode() != eStorageModeRAM) || !img->getComponents().isColorPlane() || (img->getBitDepth() == eImageBitDepthHalf) ) {
+                    continue;
+                }
+                // The image must cover the region of definition and be fully rendered
+                RectI rodPixel;
+                rod.toPixelEnclosing(img->getMipMapLevel(), par, &rodPixel);
+                RectI roi;
+                if ( !rodPixel.intersect(img->getBounds(), &roi) || (roi != rodPixel) ) {
+                    continue;
+                }
+                std::list<RectI> restToRender;
+                img->getRestToRender(roi, restToRender);
+                if ( !restToRender.empty() ) {
+                    continue;
+                }
+                if (!best) {
+                    best = img;
+                } else {
+                    unsigned int level = img->getMipMapLevel();
+                    unsigned int bestLevel = best->getMipMapLevel();
+                    bool isBetter;
+                    if (level <= mipMapLevel) {
+                        isBetter = (bestLevel > mipMapLevel) || (level > bestLevel);
+                    } else {
+                        isBetter = (bestLevel > mipMapLevel) && (level < bestLevel);
+                    }
+                    if (isBetter) {
+                        best = img;
+                    }
+                }
+            }
+        }
+    }
+
+    return best;
+} // findCachedPreviewSource
+
 NATRON_NAMESPACE_ANONYMOUS_EXIT
 
 
@@ -3272,11 +3475,92 @@ public:
     }
 };
 
+bool
+Node::makePreviewImageFromCache(SequenceTime time,
+                                int *width,
+                                int *height,
+                                unsigned int* buf)
+{
+    assert(_imp->knobsInitialized);
+
+    {
+        QMutexLocker k(&_imp->isBeingDestroyedMutex);
+        if (_imp->isBeingDestroyed) {
+            return false;
+        }
+    }
+
+    if ( _imp->checkForExitPreview() ) {
+        return false;
+    }
+
+    /// prevent 2 previews to occur at the same time since there's only 1 preview instance
+    ComputingPreviewSetter_RAII computingPreviewRAII( _imp.get() );
+    EffectInstance* effect = 0;
+    NodeGroup* isGroup = dynamic_cast<NodeGroup*>( _imp->effect.get() );
+    if (isGroup) {
+        NodePtr outputNode = isGroup->getOutputNode(false);
+        if (!outputNode) {
+            return false;
+        }
+        effect = outputNode->getEffectInstance().get();
+    } else {
+        effect = _imp->effect.get();
+    }
+
+    if (!effect) {
+        return false;
+    }
+
+    RectD rod;
+    bool isProjectFormat;
+    U64 nodeHash = effect->getHash();
+    StatusEnum stat = effect->getRegionOfDefinition_public(nodeHash, time, RenderScale(1.), ViewIdx(0), &rod, &isProjectFormat);
+    if ( (stat == eStatusFailed) || rod.isNull() ) {
+        return false;
+    }
+    unsigned int mipMapLevel = getPreviewMipMapLevel(rod, *width, *height);
+
+    ImagePtr img = findCachedPreviewSource(effect, nodeHash, time, rod, mipMapLevel);
+    if (!img) {
+        return false;
+    }
+    // Restores the image if it was compacted by the cache
+    img->allocateMemory();
+
+    if ( img->getMipMapLevel() < mipMapLevel ) {
+        // Downscale to the preview level in a single pass rather than sampling a few pixels of the large image
+        RectI roi;
+        rod.toPixelEnclosing( img->getMipMapLevel(), img->getPixelAspectRatio(), &roi );
+        unsigned int fromLevel = img->getMipMapLevel();
+        RectI dstBounds = roi.downscalePowerOfTwoSmallestEnclosing(mipMapLevel - fromLevel);
+        ImagePtr downscaled( new Image( img->getComponents(),
+                                        rod,
+                                        dstBounds,
+                                        mipMapLevel,
+                                        img->getPixelAspectRatio(),
+                                        img->getBitDepth(),
+                                        img->getPremultiplication(),
+                                        img->getFieldingOrder(),
+                                        false ) );
+        img->downscaleMipMap(rod, roi, fromLevel, mipMapLevel, false, downscaled.get());
+        img = downscaled;
+    }
+
+    ///we convert only when input is Linear.
+    //Rec709 and srGB is acceptable for preview
+    bool convertToSrgb = getApp()->getDefaultColorSpaceForBitDepth( img->getBitDepth() ) == eViewerColorSpaceLinear;
+    renderPreviewFromImage(*img, convertToSrgb, width, height, buf);
+
+    return true;
+} // makePreviewImageFromCache
+
 bool
 Node::makePreviewImage(SequenceTime time,
                        int *width,
                        int *height,
-                       unsigned int* buf)
+                       unsigned int* buf,
+                       const AbortableRenderInfoPtr& abortInfo)
 {
     assert(_imp->knobsInitialized);
 
@@ -3317,12 +3601,7 @@ Node::makePreviewImage(SequenceTime time,
         return false;
     }
     assert( !rod.isNull() );
-    double yZoomFactor = (double)*height / (double)rod.height();
-    double xZoomFactor = (double)*width / (double)rod.width();
-    double closestPowerOf2X = xZoomFactor >= 1 ? 1 : std::pow( 2, -std::ceil( std::log(xZoomFactor) / std::log(2.) ) );
-    double closestPowerOf2Y = yZoomFactor >= 1 ? 1 : std::pow( 2, -std::ceil( std::log(yZoomFactor) / std::log(2.) ) );
-    int closestPowerOf2 = std::max(closestPowerOf2X, closestPowerOf2Y);
-    unsigned int mipMapLevel = std::min(std::log( (double)closestPowerOf2 ) / std::log(2.), 5.);
+    unsigned int mipMapLevel = getPreviewMipMapLevel(rod, *width, *height);
 
     scale.x = Image::getScaleFromMipMapLevel(mipMapLevel);
     scale.y = scale.x;
@@ -3336,7 +3615,7 @@ Node::makePreviewImage(SequenceTime time,
 
 
     {
-        AbortableRenderInfoPtr abortInfo = AbortableRenderInfo::create(true, 0);
+        assert(abortInfo);
         const bool isRenderUserInteraction = true;
         const bool isSequentialRender = false;
         AbortableThread* isAbortable = dynamic_cast<AbortableThread*>( QThread::currentThread() );
@@ -3403,31 +3682,11 @@ Node::makePreviewImage(SequenceTime time,
         }
 
         const ImagePtr& img = planes.begin()->second;
-        const ImagePlaneDesc& components = img->getComponents();
-        int elemCount = components.getNumComponents();
 
         ///we convert only when input is Linear.
         //Rec709 and srGB is acceptable for preview
         bool convertToSrgb = getApp()->getDefaultColorSpaceForBitDepth( img->getBitDepth() ) == eViewerColorSpaceLinear;
-
-        switch ( img->getBitDepth() ) {
-        case eImageBitDepthByte: {
-            renderPreviewForDepth<unsigned char, 255>(*img, elemCount, width, height, convertToSrgb, buf);
-            break;
-        }
-        case eImageBitDepthShort: {
-            renderPreviewForDepth<unsigned short, 65535>(*img, elemCount, width, height, convertToSrgb, buf);
-            break;
-        }
-        case eImageBitDepthHalf:
-            break;
-        case eImageBitDepthFloat: {
-            renderPreviewForDepth<float, 1>(*img, elemCount, width, height, convertToSrgb, buf);
-            break;
-        }
-        case eImageBitDepthNone:
-            break;
-        }
+        renderPreviewFromImage(*img, convertToSrgb, width, height, buf);
     } // ParallelRenderArgsSetter
 
     ///Exit of the thread
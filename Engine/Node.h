@@ -781,8 +781,17 @@ public:
      *
      * The width and height might be modified by the function, so their value can
      * be queried at the end of the function
+     * The render can be aborted with abortInfo.
+     * makePreviewImageFromCache() should be tried first.
      **/
-    bool makePreviewImage(SequenceTime time, int *width, int *height, unsigned int* buf);
+    bool makePreviewImage(SequenceTime time, int *width, int *height, unsigned int* buf, const AbortableRenderInfoPtr& abortInfo);
+
+    /**
+     * @brief Same as makePreviewImage() but the preview is made from an image of the node at the given time
+     * found in the cache, e.g: rendered by the viewer, which is much cheaper than rendering it.
+     * Returns false if no suitable image is cached.
+     **/
+    bool makePreviewImageFromCache(SequenceTime time, int *width, int *height, unsigned int* buf);
 
     /**
      * @brief Returns true if the node is currently rendering a preview image.
@@ -1080,6 +1089,12 @@ public:
 
     bool isForceCachingEnabled() const;
 
+    /**
+     * @brief Returns true if the float images of this node may be stored as half floats in the cache when it is full,
+     * from the "Cache storage" parameter or the preference.
+     **/
+    bool isHalfCacheStorageEnabled() const;
+
 
     /**
      * @brief Declares to Python all parameters as attribute of the variable representing this node.
@@ -1328,6 +1343,17 @@ public:
 
     void refreshEnabledKnobsLabel(const ImagePlaneDesc& layer);
 
+    /**
+     * @brief Appends the nodes whose hash depends on the hash of this node: its outputs and the nodes of its rotopaint tree.
+     **/
+    void getHashDependents(NodesList* dependents) const;
+
+    /**
+     * @brief Recompute the hash of the given nodes and of the nodes downstream. Nodes are visited in topological order
+     * so that each hash is computed at most once, after the hash of its inputs.
+     **/
+    static void computeHashOfNodes(const NodesList& nodes);
+
 private:
 
     bool setStreamWarningInternal(StreamWarningEnum warning, const QString& message);
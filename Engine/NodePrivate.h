@@ -191,6 +191,7 @@ public:
         , refreshInfoButton()
         , useFullScaleImagesWhenRenderScaleUnsupported()
         , forceCaching()
+        , cacheStorage()
         , hideInputs()
         , beforeFrameRender()
         , beforeRender()
@@ -385,6 +386,7 @@ public:
     KnobButtonWPtr refreshInfoButton;
     KnobBoolWPtr useFullScaleImagesWhenRenderScaleUnsupported;
     KnobBoolWPtr forceCaching;
+    KnobChoiceWPtr cacheStorage;
     KnobBoolWPtr hideInputs;
     KnobStringWPtr beforeFrameRender;
     KnobStringWPtr beforeRender;
@@ -31,16 +31,19 @@ NATRON_NAMESPACE_ENTER
 
 NonKeyParams::NonKeyParams()
     : _storageInfo()
+    , _recomputeCost(0.)
 {
 }
 
 NonKeyParams::NonKeyParams(const CacheEntryStorageInfo& info)
     : _storageInfo(info)
+    , _recomputeCost(0.)
 {
 }
 
 NonKeyParams::NonKeyParams(const NonKeyParams & other)
     : _storageInfo(other._storageInfo)
+    , _recomputeCost(other._recomputeCost)
 {
 }
 
@@ -56,4 +59,16 @@ NonKeyParams::getStorageInfo() const
     return _storageInfo;
 }
 
+double
+NonKeyParams::getRecomputeCost() const
+{
+    return _recomputeCost;
+}
+
+void
+NonKeyParams::setRecomputeCost(double seconds)
+{
+    _recomputeCost = seconds;
+}
+
 NATRON_NAMESPACE_EXIT
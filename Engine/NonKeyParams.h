@@ -101,6 +101,14 @@ public:
     const CacheEntryStorageInfo& getStorageInfo() const;
     CacheEntryStorageInfo& getStorageInfo();
 
+    /**
+     * @brief The time in seconds it took to compute the data of the entry. This is used by the cost-aware
+     * eviction policy of the cache. It is neither part of the comparison operator nor serialized.
+     * Not thread safe, use CacheEntryHelper::addRecomputeCost instead.
+     **/
+    double getRecomputeCost() const;
+    void setRecomputeCost(double seconds);
+
     template<class Archive>
     void serialize(Archive & ar, const unsigned int /*version*/);
 
@@ -119,6 +127,7 @@ protected:
 private:
 
     CacheEntryStorageInfo _storageInfo;
+    double _recomputeCost;
 };
 
 NATRON_NAMESPACE_EXIT
@@ -0,0 +1,319 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "NumaPlacement.h"
+
+#include <cassert>
+#include <cstdlib> // atoi
+#include <cstring> // memcpy
+#include <fstream>
+#include <sstream> // stringstream
+#include <string>
+
+#ifdef __NATRON_LINUX__
+#include <sched.h> // sched_setaffinity, sched_getaffinity
+#include <sys/syscall.h> // SYS_mbind
+#include <unistd.h>
+#endif
+
+#include <QtCore/QMutex>
+#include <QtCore/QThreadStorage>
+#include <QtCore/QCoreApplication>
+
+// From <linux/mempolicy.h>: prefer the given node and fall back on other nodes if it is full
+#define NATRON_NUMA_MPOL_PREFERRED 1
+
+NATRON_NAMESPACE_ENTER
+
+namespace {
+
+struct NumaNode
+{
+    // Identifier of the node in the system
+    int id;
+    std::vector<int> cpus;
+};
+
+struct NumaPlacementState
+{
+    QMutex lock;
+    bool topologyRead;
+    std::vector<NumaNode> nodes;
+    bool enabled;
+
+    // Node index + 1 of each thread, 0 or no data if the thread is not bound
+    QThreadStorage<int> threadNode;
+
+    NumaPlacementState()
+        : lock()
+        , topologyRead(false)
+        , nodes()
+        , enabled(false)
+        , threadNode()
+    {
+    }
+};
+
+// Never destroyed: threads may still exit after static destructors ran
+NumaPlacementState* gNuma = new NumaPlacementState;
+
+/**
+ * @brief Parses a list in the format used by the kernel, e.g "0-15,32-47"
+ **/
+std::vector<int>
+parseList(const std::string& str)
+{
+    std::vector<int> ret;
+    std::stringstream ss(str);
+    std::string range;
+
+    while ( std::getline(ss, range, ',') ) {
+        if ( range.empty() || (range[0] < '0') || (range[0] > '9') ) {
+            continue;
+        }
+        std::size_t dash = range.find('-');
+        int first = std::atoi( range.substr(0, dash).c_str() );
+        int last = dash == std::string::npos ? first : std::atoi( range.substr(dash + 1).c_str() );
+        for (int i = first; i <= last; ++i) {
+            ret.push_back(i);
+        }
+    }
+
+    return ret;
+}
+
+bool
+readFirstLine(const std::string& path,
+              std::string* line)
+{
+    std::ifstream ifile( path.c_str() );
+
+    if (!ifile) {
+        return false;
+    }
+    std::getline(ifile, *line);
+
+    return true;
+}
+
+// Must be called with the lock held
+void
+readTopology()
+{
+    if (gNuma->topologyRead) {
+        return;
+    }
+    gNuma->topologyRead = true;
+#ifdef __NATRON_LINUX__
+    std::string online;
+    if ( !readFirstLine("/sys/devices/system/node/online", &online) ) {
+        return;
+    }
+    std::vector<int> ids = parseList(online);
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+        std::stringstream path;
+        path << "/sys/devices/system/node/node" << ids[i] << "/cpulist";
+        std::string cpuList;
+        if ( !readFirstLine(path.str(), &cpuList) ) {
+            continue;
+        }
+        NumaNode node;
+        node.id = ids[i];
+        node.cpus = parseList(cpuList);
+        // Memory only nodes cannot run threads
+        if ( !node.cpus.empty() ) {
+            gNuma->nodes.push_back(node);
+        }
+    }
+#endif
+}
+
+#ifdef __NATRON_LINUX__
+/**
+ * @brief Restricts the calling thread to the CPUs of the given node. Returns false if it could not be done.
+ **/
+bool
+bindCurrentThread(int node)
+{
+    std::vector<int> cpus;
+    {
+        QMutexLocker k(&gNuma->lock);
+        readTopology();
+        if ( (node < 0) || ( node >= (int)gNuma->nodes.size() ) ) {
+            return false;
+        }
+        cpus = gNuma->nodes[node].cpus;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (std::size_t i = 0; i < cpus.size(); ++i) {
+        if (cpus[i] < CPU_SETSIZE) {
+            CPU_SET(cpus[i], &set);
+        }
+    }
+    // A pid of 0 designates the calling thread
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+        return false;
+    }
+    gNuma->threadNode.setLocalData(node + 1);
+
+    return true;
+}
+#endif
+} // anon namespace
+
+int
+NumaPlacement::getNumberOfNodes()
+{
+    QMutexLocker k(&gNuma->lock);
+
+    readTopology();
+
+    return gNuma->nodes.empty() ? 1 : (int)gNuma->nodes.size();
+}
+
+std::vector<int>
+NumaPlacement::getNodeCPUs(int node)
+{
+    QMutexLocker k(&gNuma->lock);
+
+    readTopology();
+    if ( (node < 0) || ( node >= (int)gNuma->nodes.size() ) ) {
+        return std::vector<int>();
+    }
+
+    return gNuma->nodes[node].cpus;
+}
+
+void
+NumaPlacement::setEnabled(bool enabled)
+{
+    QMutexLocker k(&gNuma->lock);
+
+    gNuma->enabled = enabled;
+}
+
+bool
+NumaPlacement::isActive()
+{
+    QMutexLocker k(&gNuma->lock);
+
+    readTopology();
+
+    return gNuma->enabled && gNuma->nodes.size() > 1;
+}
+
+int
+NumaPlacement::getCurrentThreadNode()
+{
+    if ( !gNuma->threadNode.hasLocalData() ) {
+        return -1;
+    }
+
+    return gNuma->threadNode.localData() - 1;
+}
+
+NumaPlacement::ThreadScope::ThreadScope(int node)
+    : _previousNode( getCurrentThreadNode() )
+    , _bound(false)
+    , _previousAffinity()
+{
+    if ( (node < 0) || (node == _previousNode) ) {
+        return;
+    }
+#ifdef __NATRON_LINUX__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+        return;
+    }
+    if ( !bindCurrentThread(node) ) {
+        return;
+    }
+    _previousAffinity.resize( sizeof(set) );
+    std::memcpy( &_previousAffinity[0], &set, sizeof(set) );
+    _bound = true;
+#endif
+}
+
+NumaPlacement::ThreadScope::~ThreadScope()
+{
+    if (!_bound) {
+        return;
+    }
+#ifdef __NATRON_LINUX__
+    cpu_set_t set;
+    assert( _previousAffinity.size() == sizeof(set) );
+    std::memcpy( &set, &_previousAffinity[0], sizeof(set) );
+    sched_setaffinity(0, sizeof(set), &set);
+    gNuma->threadNode.setLocalData(_previousNode + 1);
+#endif
+}
+
+void
+NumaPlacement::setMemoryNode(void* data,
+                             std::size_t bytes,
+                             int node)
+{
+#if defined(__NATRON_LINUX__) && defined(SYS_mbind)
+    int id;
+    {
+        QMutexLocker k(&gNuma->lock);
+        if ( (node < 0) || ( node >= (int)gNuma->nodes.size() ) ) {
+            return;
+        }
+        id = gNuma->nodes[node].id;
+    }
+    const int nBits = (int)sizeof(unsigned long) * 8;
+    if (id >= nBits) {
+        return;
+    }
+    unsigned long mask = 1UL << id;
+    // The kernel expects the number of bits of the mask plus one
+    syscall(SYS_mbind, data, bytes, NATRON_NUMA_MPOL_PREFERRED, &mask, (unsigned long)nBits + 1, 0);
+#else
+    Q_UNUSED(data);
+    Q_UNUSED(bytes);
+    Q_UNUSED(node);
+#endif
+}
+
+QString
+NumaPlacement::printTopology()
+{
+    QMutexLocker k(&gNuma->lock);
+
+    readTopology();
+    if ( gNuma->nodes.empty() ) {
+        return QCoreApplication::translate("NumaPlacement", "NUMA topology unavailable");
+    }
+    QString ret = QCoreApplication::translate("NumaPlacement", "%1 NUMA node(s):").arg( gNuma->nodes.size() );
+    for (std::size_t i = 0; i < gNuma->nodes.size(); ++i) {
+        ret += QCoreApplication::translate("NumaPlacement", " node %1 (%2 CPUs)").arg(gNuma->nodes[i].id).arg( gNuma->nodes[i].cpus.size() );
+    }
+
+    return ret;
+}
+
+NATRON_NAMESPACE_EXIT
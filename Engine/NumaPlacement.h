@@ -0,0 +1,115 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef Engine_NumaPlacement_h
+#define Engine_NumaPlacement_h
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <cstddef>
+#include <vector>
+
+#include <QtCore/QString>
+
+#include "Engine/EngineFwd.h"
+
+NATRON_NAMESPACE_ENTER
+
+/**
+ * @brief Placement of the render threads and of the image memory on the NUMA nodes of the machine.
+ * On machines with several sockets, accessing the memory attached to another socket is much slower than accessing
+ * local memory. When enabled, the OutputSchedulerThread assigns the frames it renders to the nodes in turn: the thread
+ * rendering a frame, and the threads it spawns to render tiles or for the OpenFX multi-thread suite, are restricted to
+ * the CPUs of that node, and the image buffers they allocate are placed in the memory of that node
+ * (see ImageBufferPool).
+ * The topology is read from /sys/devices/system/node on Linux; on other systems and on machines with a single node
+ * this does nothing.
+ * Nodes are identified by their index in [0, getNumberOfNodes()), -1 meaning no node in particular.
+ * This class is MT-safe.
+ **/
+class NumaPlacement
+{
+public:
+
+    /**
+     * @brief Returns the number of NUMA nodes having CPUs, 1 if the topology is unknown.
+     **/
+    static int getNumberOfNodes();
+
+    /**
+     * @brief Returns the CPUs of the given node.
+     **/
+    static std::vector<int> getNodeCPUs(int node);
+
+    static void setEnabled(bool enabled);
+
+    /**
+     * @brief Returns true if NUMA-aware placement is enabled and the machine has several nodes.
+     **/
+    static bool isActive();
+
+    /**
+     * @brief Restricts the current thread to the CPUs of the given node while the object lives, then gives the thread
+     * back the CPU affinity it had before. The render threads are shared (e.g the global thread pool): they must not
+     * stay bound once the work placed on the node is done.
+     * This does nothing if node is -1 or if the thread is already placed on that node.
+     **/
+    class ThreadScope
+    {
+    public:
+
+        ThreadScope(int node);
+
+        ~ThreadScope();
+
+    private:
+
+        // The node the thread was placed on before, -1 if none
+        int _previousNode;
+        bool _bound;
+
+        // The CPU affinity mask of the thread before it was bound
+        std::vector<unsigned char> _previousAffinity;
+    };
+
+    /**
+     * @brief Returns the node the current thread is restricted to, or -1.
+     **/
+    static int getCurrentThreadNode();
+
+    /**
+     * @brief Asks the system to place the pages of the given memory range, which must not have been accessed yet,
+     * in the memory of the given node.
+     **/
+    static void setMemoryNode(void* data, std::size_t bytes, int node);
+
+    /**
+     * @brief Returns a human readable description of the nodes, used in the logs.
+     **/
+    static QString printTopology();
+};
+
+NATRON_NAMESPACE_EXIT
+
+#endif // Engine_NumaPlacement_h
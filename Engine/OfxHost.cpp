@@ -99,12 +99,15 @@ CLANG_DIAG_ON(unknown-pragmas)
 #include "Engine/MemoryInfo.h" // printAsRAM
 #include "Engine/Node.h"
 #include "Engine/NodeSerialization.h"
+#include "Engine/NumaPlacement.h"
 #include "Engine/OfxEffectInstance.h"
 #include "Engine/OfxImageEffectInstance.h"
 #include "Engine/OutputSchedulerThread.h"
 #include "Engine/OfxMemory.h"
 #include "Engine/Plugin.h"
+#include "Engine/ParallelRenderArgs.h"
 #include "Engine/Project.h"
+#include "Engine/RenderStats.h"
 #include "Engine/Settings.h"
 #include "Engine/StandardPaths.h"
 #include "Engine/TLSHolder.h"
@@ -1208,12 +1211,46 @@ NATRON_NAMESPACE_ANONYMOUS_ENTER
 ///We think this is because Furnace must keep an internal thread-local state that becomes then dirty
 ///if we re-use the same thread.
 
+/**
+ * @brief If the current thread is rendering a node with in-depth profiling enabled, returns the render stats
+ * so that the multi-thread suite jobs appear in the render trace.
+ **/
+static void
+getCurrentThreadRenderStats(RenderStatsPtr* stats,
+                            NodePtr* node,
+                            double* time)
+{
+    AbortableThread* isAbortable = dynamic_cast<AbortableThread*>( QThread::currentThread() );
+
+    if (!isAbortable) {
+        return;
+    }
+    std::string actionName;
+    NodePtr actionNode;
+    isAbortable->getCurrentActionInfos(&actionName, &actionNode);
+    if (!actionNode) {
+        return;
+    }
+    EffectInstancePtr effect = actionNode->getEffectInstance();
+    ParallelRenderArgsPtr frameArgs = effect ? effect->getParallelRenderArgsTLS() : ParallelRenderArgsPtr();
+    if ( !frameArgs || !frameArgs->stats || !frameArgs->stats->isInDepthProfilingEnabled() ) {
+        return;
+    }
+    *stats = frameArgs->stats;
+    *node = actionNode;
+    *time = frameArgs->time;
+}
+
 static OfxStatus
 threadFunctionWrapper(OfxThreadFunctionV1 func,
                       unsigned int threadIndex,
                       unsigned int threadMax,
                       QThread* spawnerThread,
-                      void *customArg)
+                      void *customArg,
+                      const RenderStatsPtr& stats,
+                      const NodePtr& node,
+                      double time,
+                      int numaNode)
 {
 #ifdef DEBUG
     boost_adaptbx::floating_point::exception_trapping trap(boost_adaptbx::floating_point::exception_trapping::division_by_zero |
@@ -1228,9 +1265,12 @@ threadFunctionWrapper(OfxThreadFunctionV1 func,
     if (spawnedThread != spawnerThread) {
         appPTR->getAppTLS()->softCopy(spawnerThread, spawnedThread);
     }
+    // Run on the NUMA node of the spawner thread, the pool thread gets its CPU affinity back when done
+    NumaPlacement::ThreadScope numaScope(numaNode);
 
     OfxStatus ret = kOfxStatOK;
     try {
+        RenderStatsTraceScope traceScope(stats, node, "multiThread", time);
         func(threadIndex, threadMax, customArg);
     } catch (const std::bad_alloc & ba) {
         ret =  kOfxStatErrMemory;
@@ -1258,7 +1298,11 @@ public:
               unsigned int threadMax,
               QThread* spawnerThread,
               void *customArg,
-              OfxStatus *stat)
+              OfxStatus *stat,
+              const RenderStatsPtr& stats,
+              const NodePtr& node,
+              double time,
+              int numaNode)
         : QThread()
         , AbortableThread(this)
         , _func(func)
@@ -1267,6 +1311,10 @@ public:
         , _spawnerThread(spawnerThread)
         , _customArg(customArg)
         , _stat(stat)
+        , _stats(stats)
+        , _node(node)
+        , _time(time)
+        , _numaNode(numaNode)
     {
         setThreadName("Multi-thread suite");
     }
@@ -1283,9 +1331,11 @@ public:
         tls->threadIndexes.push_back( (int)_threadIndex );
 
         appPTR->getAppTLS()->softCopy(_spawnerThread, this);
+        NumaPlacement::ThreadScope numaScope(_numaNode);
 
         assert(*_stat == kOfxStatFailed);
         try {
+            RenderStatsTraceScope traceScope(_stats, _node, "multiThread", _time);
             _func(_threadIndex, _threadMax, _customArg);
             *_stat = kOfxStatOK;
         } catch (const std::bad_alloc & ba) {
@@ -1306,6 +1356,10 @@ private:
     QThread* _spawnerThread;
     void *_customArg;
     OfxStatus *_stat;
+    RenderStatsPtr _stats;
+    NodePtr _node;
+    double _time;
+    int _numaNode;
 };
 
 NATRON_NAMESPACE_ANONYMOUS_EXIT
@@ -1338,8 +1392,14 @@ OfxHost::multiThread(OfxThreadFunctionV1 func,
     // "nThreads can be more than the value returned by multiThreadNumCPUs, however
     // the threads will be limitted to the number of CPUs returned by multiThreadNumCPUs."
 
+    RenderStatsPtr stats;
+    NodePtr statsNode;
+    double statsTime = 0.;
+    getCurrentThreadRenderStats(&stats, &statsNode, &statsTime);
+
     if ( (nThreads == 1) || (maxConcurrentThread <= 1) || (appPTR->getCurrentSettings()->getNumberOfThreads() == -1) ) {
         try {
+            RenderStatsTraceScope traceScope(stats, statsNode, "multiThread", statsTime);
             for (unsigned int i = 0; i < nThreads; ++i) {
                 func(i, nThreads, customArg);
             }
@@ -1351,6 +1411,7 @@ OfxHost::multiThread(OfxThreadFunctionV1 func,
     }
 
     QThread* spawnerThread = QThread::currentThread();
+    int numaNode = NumaPlacement::getCurrentThreadNode();
     bool useThreadPool = appPTR->getUseThreadPool();
 
     if (useThreadPool) {
@@ -1361,7 +1422,7 @@ OfxHost::multiThread(OfxThreadFunctionV1 func,
 
         /// DON'T set the maximum thread count, this is a global application setting, and see the documentation excerpt above
         //QThreadPool::globalInstance()->setMaxThreadCount(nThreads);
-        QFuture<OfxStatus> future = QtConcurrent::mapped( threadIndexes, boost::bind(threadFunctionWrapper, func, _1, nThreads, spawnerThread, customArg) );
+        QFuture<OfxStatus> future = QtConcurrent::mapped( threadIndexes, boost::bind(threadFunctionWrapper, func, _1, nThreads, spawnerThread, customArg, stats, statsNode, statsTime, numaNode) );
         future.waitForFinished();
         ///DON'T reset back to the original value the maximum thread count
         //QThreadPool::globalInstance()->setMaxThreadCount(QThread::idealThreadCount());
@@ -1379,7 +1440,7 @@ OfxHost::multiThread(OfxThreadFunctionV1 func,
             // at most maxConcurrentThread should be running at the same time
             QVector<OfxThread*> threads(nThreads);
             for (unsigned int i = 0; i < nThreads; ++i) {
-                threads[i] = new OfxThread(func, i, nThreads, spawnerThread, customArg, &status[i]);
+                threads[i] = new OfxThread(func, i, nThreads, spawnerThread, customArg, &status[i], stats, statsNode, statsTime, numaNode);
             }
             unsigned int i = 0; // index of next thread to launch
             unsigned int running = 0; // number of running threads
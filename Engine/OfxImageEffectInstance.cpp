@@ -65,6 +65,7 @@ CLANG_DIAG_ON(uninitialized)
 #include "Engine/OfxOverlayInteract.h"
 #include "Engine/OfxParamInstance.h"
 #include "Engine/Project.h"
+#include "Engine/RenderAbortToken.h"
 #include "Engine/TimeLine.h"
 #include "Engine/ViewIdx.h"
 #include "Engine/ViewerInstance.h"
@@ -1089,6 +1090,12 @@ OfxImageEffectInstance::timeLineGetBounds(double &t1,
 int
 OfxImageEffectInstance::abort()
 {
+    // Plug-ins may poll this for every scan-line: check the token of the current render before looking up the effect
+    bool aborted;
+    if ( RenderAbortToken::isCurrentThreadAborted(&aborted) ) {
+        return (int)aborted;
+    }
+
     return (int)getOfxEffectInstance()->aborted();
 }
 
@@ -55,10 +55,12 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #include "Engine/BlockingBackgroundRender.h"
 #include "Engine/DiskCacheNode.h"
 #include "Engine/Image.h"
+#include "Engine/ImageBufferPool.h"
 #include "Engine/ImageParams.h"
 #include "Engine/KnobFile.h"
 #include "Engine/KnobTypes.h"
 #include "Engine/Log.h"
+#include "Engine/MemoryGovernor.h"
 #include "Engine/Node.h"
 #include "Engine/OfxEffectInstance.h"
 #include "Engine/OfxEffectInstance.h"
@@ -67,6 +69,7 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #include "Engine/PluginMemory.h"
 #include "Engine/Project.h"
 #include "Engine/RenderStats.h"
+#include "Engine/RenderTaskScheduler.h"
 #include "Engine/RotoContext.h"
 #include "Engine/RotoDrawableItem.h"
 #include "Engine/Settings.h"
@@ -79,6 +82,9 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 //#define NATRON_ALWAYS_ALLOCATE_FULL_IMAGE_BOUNDS
 
 
+// Maximum number of render trace events kept between two exports, older events are dropped
+#define NATRON_RENDER_TRACE_MAX_EVENTS 1000000
+
 NATRON_NAMESPACE_ENTER
 
 
@@ -87,6 +93,7 @@ OutputEffectInstance::OutputEffectInstance(NodePtr node)
     , _outputEffectDataLock()
     , _renderSequenceRequests()
     , _engine()
+    , _traceEvents()
 {
 }
 
@@ -95,6 +102,7 @@ OutputEffectInstance::OutputEffectInstance(const OutputEffectInstance& other)
 , _outputEffectDataLock()
 , _renderSequenceRequests()
 , _engine(other._engine)
+, _traceEvents()
 {
 }
 
@@ -357,6 +365,11 @@ OutputEffectInstance::notifyRenderFinished()
         QMutexLocker k(&_outputEffectDataLock);
         if ( !_renderSequenceRequests.empty() ) {
             const RenderSequenceArgs& args = _renderSequenceRequests.front();
+            // Write the timeline before notifying the render controller, which may exit the application
+            if ( args.useStats && !_traceEvents.empty() ) {
+                writeTraceFile(_traceEvents);
+                _traceEvents.clear();
+            }
             if (args.renderController) {
                 args.renderController->notifyFinished();
             }
@@ -403,7 +416,8 @@ void
 OutputEffectInstance::reportStats(int time,
                                   ViewIdx view,
                                   double wallTime,
-                                  const std::map<NodePtr, NodeRenderStats > & stats)
+                                  const std::map<NodePtr, NodeRenderStats > & stats,
+                                  const MemoryGovernorStatus& memoryStatus)
 {
     std::string filename;
     KnobIPtr fileKnob = getKnobByName(kOfxImageEffectFileParamName);
@@ -438,6 +452,10 @@ OutputEffectInstance::reportStats(int time,
     }
 
     ofile << "Time spent to render frame (wall clock time): " << Timer::printAsTime(wallTime, false).toStdString() << std::endl;
+    ofile << MemoryGovernor::printStatus(memoryStatus).toStdString() << std::endl;
+    ofile << appPTR->getNodeCacheStatisticsString().toStdString() << std::endl;
+    ofile << ImageBufferPool::printStatistics( ImageBufferPool::getStatistics() ).toStdString() << std::endl;
+    ofile << RenderTaskScheduler::printStatistics( RenderTaskScheduler::getStatistics() ).toStdString() << std::endl;
     for (std::map<NodePtr, NodeRenderStats >::const_iterator it = stats.begin(); it != stats.end(); ++it) {
         ofile << "------------------------------- " << it->first->getScriptName_mt_safe() << "------------------------------- " << std::endl;
         ofile << "Time spent rendering: " << Timer::printAsTime(it->second.getTotalTimeSpentRendering(), false).toStdString() << std::endl;
@@ -529,6 +547,58 @@ OutputEffectInstance::reportStats(int time,
     }
 } // OutputEffectInstance::reportStats
 
+void
+OutputEffectInstance::appendTraceEvents(const RenderTraceEventList& events)
+{
+    if ( events.empty() ) {
+        return;
+    }
+    QMutexLocker k(&_outputEffectDataLock);
+    _traceEvents.insert( _traceEvents.end(), events.begin(), events.end() );
+    if (_traceEvents.size() > NATRON_RENDER_TRACE_MAX_EVENTS) {
+        _traceEvents.erase( _traceEvents.begin(), _traceEvents.begin() + (_traceEvents.size() - NATRON_RENDER_TRACE_MAX_EVENTS) );
+    }
+}
+
+RenderTraceEventList
+OutputEffectInstance::takeTraceEvents()
+{
+    RenderTraceEventList ret;
+    QMutexLocker k(&_outputEffectDataLock);
+
+    ret.swap(_traceEvents);
+
+    return ret;
+}
+
+void
+OutputEffectInstance::writeTraceFile(const RenderTraceEventList& events)
+{
+    KnobOutputFile* fileKnob = dynamic_cast<KnobOutputFile*>( getKnobByName(kOfxImageEffectFileParamName).get() );
+
+    if (!fileKnob) {
+        return;
+    }
+
+    // Remove the frame number and view placeholders of the pattern so that one file is written for the whole sequence
+    QString qfileName = QString::fromUtf8( fileKnob->getValue().c_str() );
+    QtCompat::removeFileExtension(qfileName);
+    qfileName.remove( QRegExp( QString::fromUtf8("%[0-9]*d|#+|%[vV]") ) );
+    while ( qfileName.endsWith( QLatin1Char('.') ) || qfileName.endsWith( QLatin1Char('_') ) ) {
+        qfileName.chop(1);
+    }
+    qfileName.append( QString::fromUtf8("-trace.json") );
+
+    FStreamsSupport::ofstream ofile;
+    FStreamsSupport::open( &ofile, qfileName.toStdString() );
+    if (!ofile) {
+        std::cout << tr("Failure to write render trace file.").toStdString() << std::endl;
+
+        return;
+    }
+    RenderStats::writeChromeTrace(events, ofile);
+}
+
 NATRON_NAMESPACE_EXIT
 
 NATRON_NAMESPACE_USING
@@ -67,6 +67,7 @@ private:
     mutable QMutex _outputEffectDataLock;
     std::list<RenderSequenceArgs> _renderSequenceRequests;
     RenderEnginePtr _engine;
+    RenderTraceEventList _traceEvents;
 
 public:
 
@@ -114,7 +115,23 @@ public:
 
 
     virtual void initializeData() OVERRIDE FINAL;
-    virtual void reportStats(int time, ViewIdx view, double wallTime, const std::map<NodePtr, NodeRenderStats > & stats);
+    /**
+     * @brief Writes the statistics of the render of a frame. memoryStatus is the state of the memory governor
+     * when the render of the frame started.
+     **/
+    virtual void reportStats(int time, ViewIdx view, double wallTime, const std::map<NodePtr, NodeRenderStats > & stats,
+                             const MemoryGovernorStatus& memoryStatus);
+
+    /**
+     * @brief Accumulates the render timeline of the frames rendered by this node when in-depth profiling is enabled.
+     * The oldest events are dropped when too many are accumulated.
+     **/
+    void appendTraceEvents(const RenderTraceEventList& events);
+
+    /**
+     * @brief Returns the accumulated render timeline and clears it.
+     **/
+    RenderTraceEventList takeTraceEvents();
 
 protected:
 
@@ -122,6 +139,11 @@ protected:
 
     void launchRenderSequence(const RenderSequenceArgs& args);
 
+    /**
+     * @brief Writes the render timeline next to the output files, as <filename>-trace.json
+     **/
+    void writeTraceFile(const RenderTraceEventList& events);
+
     /**
      * @brief Creates the engine that will control the output rendering
      **/
@@ -54,11 +54,15 @@
 #include "Engine/EffectInstance.h"
 #include "Engine/Image.h"
 #include "Engine/KnobFile.h"
+#include "Engine/MemoryGovernor.h"
+#include "Engine/MemoryInfo.h" // getSystemTotalRAM
 #include "Engine/Node.h"
+#include "Engine/NumaPlacement.h"
 #include "Engine/OpenGLViewerI.h"
 #include "Engine/GenericSchedulerThreadWatcher.h"
 #include "Engine/Project.h"
 #include "Engine/RenderStats.h"
+#include "Engine/RenderTaskScheduler.h"
 #include "Engine/RotoContext.h"
 #include "Engine/Settings.h"
 #include "Engine/Timer.h"
@@ -90,6 +94,9 @@
 
 #define NATRON_SCHEDULER_ABORT_AFTER_X_UNSUCCESSFUL_ITERATIONS 5000
 
+// Fraction of the RAM allowed to the caches that frames waiting in the buffer to be processed in order may use
+#define NATRON_SCHEDULER_BUFFER_MAX_RAM_FRACTION 0.25
+
 NATRON_NAMESPACE_ENTER
 
 
@@ -174,9 +181,17 @@ typedef boost::shared_ptr<OutputSchedulerThreadExecMTArgs> OutputSchedulerThread
 #ifndef NATRON_PLAYBACK_USES_THREAD_POOL
 static bool
 isBufferFull(int nbBufferedElement,
+             std::size_t bufferedSizeInRAM,
              int hardwardIdealThreadCount)
 {
-    return nbBufferedElement >= hardwardIdealThreadCount * 3;
+    if (nbBufferedElement >= hardwardIdealThreadCount * 3) {
+        return true;
+    }
+    // Frames rendered ahead may be big (e.g: a 4K sequence rendered for a sequential writer)
+    double maxSize = (double)getSystemTotalRAM() * appPTR->getCurrentSettings()->getRamMaximumPercent() * NATRON_SCHEDULER_BUFFER_MAX_RAM_FRACTION;
+    maxSize *= appPTR->getMemoryGovernorStatus().cacheBudgetFactor;
+
+    return nbBufferedElement > 0 && (double)bufferedSizeInRAM >= maxSize;
 }
 
 #endif
@@ -242,6 +257,10 @@ struct OutputSchedulerThreadPrivate
     QMutex bufferedOutputMutex;
     int lastBufferedOutputSize;
 
+    // The NUMA node on which the next frame will be rendered, see getNextNumaNode()
+    QMutex numaNodeMutex;
+    int nextNumaNode;
+
 
     OutputSchedulerThreadPrivate(RenderEngine* engine,
                                  const OutputEffectInstancePtr& effect,
@@ -281,6 +300,8 @@ struct OutputSchedulerThreadPrivate
 #endif
         , bufferedOutputMutex()
         , lastBufferedOutputSize(0)
+        , numaNodeMutex()
+        , nextNumaNode(0)
     {
     }
 
@@ -418,6 +439,21 @@ struct OutputSchedulerThreadPrivate
         return buf.size();
     }
 
+    std::size_t getBufferSizeInRAM() const
+    {
+        ///Private, shouldn't lock
+        assert( !bufMutex.tryLock() );
+
+        std::size_t ret = 0;
+        for (FrameBuffer::const_iterator it = buf.begin(); it != buf.end(); ++it) {
+            if (it->second.frame) {
+                ret += it->second.frame->sizeInRAM();
+            }
+        }
+
+        return ret;
+    }
+
     static bool getNextFrameInSequence(PlaybackModeEnum pMode,
                                        RenderDirectionEnum direction,
                                        int frame,
@@ -1025,6 +1061,20 @@ OutputSchedulerThread::notifyThreadAboutToQuit(RenderThreadTask* thread)
     }
 }
 
+int
+OutputSchedulerThread::getNextNumaNode()
+{
+    if ( !NumaPlacement::isActive() ) {
+        return -1;
+    }
+    int nNodes = NumaPlacement::getNumberOfNodes();
+    QMutexLocker l(&_imp->numaNodeMutex);
+    int node = _imp->nextNumaNode % nNodes;
+    _imp->nextNumaNode = (node + 1) % nNodes;
+
+    return node;
+}
+
 void
 OutputSchedulerThread::startRender()
 {
@@ -1363,7 +1413,7 @@ OutputSchedulerThread::threadLoopOnce(const GenericThreadStartArgsPtr &inArgs)
                     {
                         QMutexLocker k(&_imp->bufMutex);
                         int nbThreadsHardware = appPTR->getHardwareIdealThreadCount();
-                        bufferFull = isBufferFull(_imp->buf.size(), nbThreadsHardware);
+                        bufferFull = isBufferFull(_imp->buf.size(), _imp->getBufferSizeInRAM(), nbThreadsHardware);
                     }
                     if (!bufferFull) {
                         pushFramesToRender(newNThreads);
@@ -1528,6 +1578,10 @@ OutputSchedulerThread::adjustNumberOfThreads(int* newNThreads,
     }
     optimalNThreads = std::max(1, optimalNThreads);
 
+    ///Render less frames in parallel when the memory available to the process is getting scarce
+    appPTR->updateMemoryGovernor();
+    optimalNThreads = appPTR->getMaxParallelRendersForMemory(optimalNThreads);
+
 
     if ( ( (runningThreads < optimalNThreads) && (currentParallelRenders < optimalNThreads) ) || (currentParallelRenders == 0) ) {
         ////////
@@ -1567,8 +1621,9 @@ OutputSchedulerThread::notifyFrameRendered(int frame,
         double timeSpentForFrame;
         std::map<NodePtr, NodeRenderStats > statResults = stats->getStats(&timeSpentForFrame);
         if ( !statResults.empty() ) {
-            effect->reportStats(frame, viewIndex, timeSpentForFrame, statResults);
+            effect->reportStats( frame, viewIndex, timeSpentForFrame, statResults, stats->getMemoryGovernorStatus() );
         }
+        effect->appendTraceEvents( stats->getTraceEvents() );
     }
 
 
@@ -1618,26 +1673,26 @@ OutputSchedulerThread::notifyFrameRendered(int frame,
         }
         //renderingIsFinished = _imp->renderFinished;
     } else {
-        nbTotalFrames = std::floor( (double)(runArgs->lastFrame - runArgs->firstFrame + 1) / runArgs->frameStep );
+        // Frames are processed in order: this frame and all the ones before it were rendered
+        nbTotalFrames = std::ceil( (double)(runArgs->lastFrame - runArgs->firstFrame + 1) / runArgs->frameStep );
         if (runArgs->processTimelineDirection == eRenderDirectionForward) {
-            nbFramesRendered = (frame - runArgs->firstFrame) / runArgs->frameStep;
+            nbFramesRendered = (frame - runArgs->firstFrame) / runArgs->frameStep + 1;
         } else {
-            nbFramesRendered = (runArgs->lastFrame - frame) / runArgs->frameStep;
+            nbFramesRendered = (runArgs->lastFrame - frame) / runArgs->frameStep + 1;
         }
     } // if (policy == eSchedulingPolicyFFA) {
 
     double fractionDone = 0.;
     assert(nbTotalFrames > 0);
     if (nbTotalFrames != 0) {
-        QMutexLocker k(&_imp->renderFinishedMutex);
-        fractionDone = (double)_imp->nFramesRendered / nbTotalFrames;
+        fractionDone = (double)nbFramesRendered / nbTotalFrames;
     }
     assert(_imp->renderTimer);
     double timeSpentSinceStartSec = _imp->renderTimer->getTimeSinceCreation();
     double estimatedFps = (double)nbFramesRendered / timeSpentSinceStartSec;
     // total estimated time is: timeSpentSinceStartSec / fractionDone
     // remaning time is thus:
-    double timeRemaining = (nbTotalFrames <= 0 || _imp->nFramesRendered <= 0) ? -1. : timeSpentSinceStartSec / fractionDone - timeSpentSinceStartSec;
+    double timeRemaining = (nbTotalFrames <= 0 || nbFramesRendered <= 0) ? -1. : timeSpentSinceStartSec / fractionDone - timeSpentSinceStartSec;
 
     // If running in background, notify to the pipe that we rendered a frame
     if (isBackground) {
@@ -2074,7 +2129,10 @@ RenderThreadTask::run()
 #ifdef TRACE_SCHEDULER
         qDebug() << "Parallel Render Thread: Picking frame to render: " << time;
 #endif
-        renderFrame(time, viewsToRender, enableRenderStats);
+        {
+            NumaPlacement::ThreadScope numaScope( _imp->scheduler->getNextNumaNode() );
+            renderFrame(time, viewsToRender, enableRenderStats);
+        }
 
         appPTR->getAppTLS()->cleanupTLSForThread();
 
@@ -2090,7 +2148,10 @@ RenderThreadTask::run()
     notifyIsRunning(false);
     _imp->scheduler->notifyThreadAboutToQuit(this);
 #else // NATRON_PLAYBACK_USES_THREAD_POOL
-    renderFrame(_imp->time, _imp->viewsToRender, _imp->useRenderStats);
+    {
+        NumaPlacement::ThreadScope numaScope( _imp->scheduler->getNextNumaNode() );
+        renderFrame(_imp->time, _imp->viewsToRender, _imp->useRenderStats);
+    }
     _imp->scheduler->notifyThreadAboutToQuit(this);
 #endif
 }
@@ -2156,6 +2217,35 @@ DefaultScheduler::~DefaultScheduler()
 {
 }
 
+/**
+ * @brief Returns the effect writing the frames: for a WriteNode this is the embedded writer.
+ **/
+static EffectInstancePtr
+getActiveWriter(const OutputEffectInstancePtr& output)
+{
+    WriteNode* isWriteNode = dynamic_cast<WriteNode*>( output.get() );
+
+    if (isWriteNode) {
+        NodePtr embeddedWriter = isWriteNode->getEmbeddedWriter();
+        if (embeddedWriter) {
+            return embeddedWriter->getEffectInstance();
+        }
+    }
+
+    return output;
+}
+
+/**
+ * @brief Writers which can only encode frames in order (e.g: WriteFFmpeg) do not render in the render threads:
+ * these only render the input of the writer, in any order, and the scheduler thread feeds the writer
+ * with the buffered images in order (see DefaultScheduler::processFrame).
+ **/
+static bool
+isWriterOrdered(const EffectInstancePtr& writer)
+{
+    return writer && writer->getSequentialPreference() == eSequentialPreferenceOnlySequential;
+}
+
 class DefaultRenderFrameRunnable
     : public RenderThreadTask
 {
@@ -2265,19 +2355,22 @@ private:
             // Do not catch exceptions: if an exception occurs here it is probably fatal, since
             // it comes from Natron itself. All exceptions from plugins are already caught
             // by the HostSupport library.
-            EffectInstancePtr activeInputToRender;
-            //if (renderDirectly) {
-            activeInputToRender = output;
+            EffectInstancePtr activeInputToRender = getActiveWriter(output);
             WriteNode* isWriteNode = dynamic_cast<WriteNode*>( output.get() );
-            if (isWriteNode) {
-                NodePtr embeddedWriter = isWriteNode->getEmbeddedWriter();
-                if (embeddedWriter) {
-                    activeInputToRender = embeddedWriter->getEffectInstance();
-                }
-            }
             assert(activeInputToRender);
             NodePtr activeInputNode = activeInputToRender->getNode();
             U64 activeInputToRenderHash = isWriteNode ? isWriteNode->getHash() : activeInputToRender->getHash();
+
+            // If the writer is ordered, only render its input: the scheduler thread writes the frames
+            EffectInstancePtr writerInput;
+            if ( isWriterOrdered(activeInputToRender) ) {
+                writerInput = activeInputToRender->getInput(0);
+                if (!writerInput) {
+                    _imp->scheduler->notifyRenderFailure( activeInputToRender->getScriptName_mt_safe() + ": no input to render" );
+
+                    return;
+                }
+            }
             const double par = activeInputToRender->getAspectRatio(-1);
             const bool isRenderDueToRenderInteraction = false;
             const bool isSequentialRender = true;
@@ -2345,6 +2438,47 @@ private:
                     }
                     frameRenderArgs.updateNodesRequest(request);
                 }
+
+                if (writerInput) {
+                    std::list<ImagePlaneDesc> inputComponents;
+                    EffectInstance::ComponentsNeededMap::iterator foundInput = neededComps.find(0);
+                    if ( foundInput != neededComps.end() ) {
+                        inputComponents = foundInput->second;
+                    }
+                    if ( inputComponents.empty() ) {
+                        inputComponents = components;
+                    }
+                    RenderingFlagSetter flagIsRendering( writerInput->getNode() );
+                    std::map<ImagePlaneDesc, ImagePtr> planes;
+                    boost::scoped_ptr<EffectInstance::RenderRoIArgs> renderArgs( new EffectInstance::RenderRoIArgs(time,
+                                                                                                                   scale,
+                                                                                                                   mipMapLevel,
+                                                                                                                   viewsToRender[view],
+                                                                                                                   false,
+                                                                                                                   renderWindow,
+                                                                                                                   RectD(),
+                                                                                                                   inputComponents,
+                                                                                                                   activeInputToRender->getBitDepth(0),
+                                                                                                                   false,
+                                                                                                                   activeInputToRender.get(),
+                                                                                                                   eStorageModeRAM,
+                                                                                                                   time) );
+                    EffectInstance::RenderRoIRetCode retCode = writerInput->renderRoI(*renderArgs, &planes);
+                    if ( (retCode != EffectInstance::eRenderRoIRetCodeOk) || planes.empty() ) {
+                        if (retCode == EffectInstance::eRenderRoIRetCodeAborted) {
+                            _imp->scheduler->notifyRenderFailure("Render aborted");
+                        } else {
+                            _imp->scheduler->notifyRenderFailure("Error caught while rendering");
+                        }
+
+                        return;
+                    }
+
+                    // The image stays in the scheduler buffer until all frames before it are written
+                    _imp->scheduler->appendToBuffer( time, viewsToRender[view], stats, boost::dynamic_pointer_cast<BufferableObject>(planes.begin()->second) );
+                    continue;
+                }
+
                 RenderingFlagSetter flagIsRendering( activeInputToRender->getNode() );
                 std::map<ImagePlaneDesc, ImagePtr> planes;
                 boost::scoped_ptr<EffectInstance::RenderRoIArgs> renderArgs( new EffectInstance::RenderRoIArgs(time, //< the time at which to render
@@ -2422,8 +2556,10 @@ DefaultScheduler::processFrame(const BufferedFrames& frames)
 
     ///Writers render to scale 1 always
     RenderScale scale(1.);
-    OutputEffectInstancePtr effect = _effect.lock();
-    U64 hash = effect->getHash();
+    OutputEffectInstancePtr output = _effect.lock();
+    // The frames in the buffer are the rendered images of the input of the writer (see DefaultRenderFrameRunnable)
+    EffectInstancePtr effect = getActiveWriter(output);
+    U64 hash = output->getHash();
     bool isProjectFormat;
     RectD rod;
     RectI roi;
@@ -2545,12 +2681,11 @@ DefaultScheduler::handleRenderFailure(const std::string& errorMessage)
 SchedulingPolicyEnum
 DefaultScheduler::getSchedulingPolicy() const
 {
-    /*SequentialPreferenceEnum sequentiallity = _effect.lock()->getSequentialPreference();
-       if (sequentiallity == eSequentialPreferenceNotSequential) {*/
-    return eSchedulingPolicyFFA;
-    /*} else {
+    if ( isWriterOrdered( getActiveWriter( _effect.lock() ) ) ) {
         return eSchedulingPolicyOrdered;
-       }*/
+    }
+
+    return eSchedulingPolicyFFA;
 }
 
 void
@@ -2841,10 +2976,12 @@ private:
         };
         bool clearTexture[2] = { false, false };
         BufferableObjectPtrList toAppend;
+        unsigned int playbackResolutionLevel = 0;
 
         for (int i = 0; i < 2; ++i) {
             args[i] = boost::make_shared<ViewerArgs>();
             status[i] = viewer->getRenderViewerArgsAndCheckCache_public( time, true, view, i, viewerHash, true, NodePtr(), stats, args[i].get() );
+            playbackResolutionLevel = std::max(playbackResolutionLevel, args[i]->playbackResolutionLevel);
             clearTexture[i] = status[i] == ViewerInstance::eViewerRenderRetCodeFail || status[i] == ViewerInstance::eViewerRenderRetCodeBlack;
             if (status[i] == ViewerInstance::eViewerRenderRetCodeFail) {
                 //Just clear the viewer, nothing to do
@@ -2888,11 +3025,16 @@ private:
 
 
         if ( ( args[0] && (status[0] != ViewerInstance::eViewerRenderRetCodeFail) ) || ( args[1] && (status[1] != ViewerInstance::eViewerRenderRetCodeFail) ) ) {
+            TimeLapse renderTimer;
             try {
                 stat = viewer->renderViewer(view, false, true, viewerHash, true, NodePtr(), true,  args, ViewerCurrentFrameRequestSchedulerStartArgsPtr(), stats);
             } catch (...) {
                 stat = ViewerInstance::eViewerRenderRetCodeFail;
             }
+            if (stat == ViewerInstance::eViewerRenderRetCodeRender) {
+                // Feed the adaptive playback resolution
+                viewer->reportPlaybackFrameRenderTime( renderTimer.getTimeSinceCreation(), playbackResolutionLevel, _imp->scheduler->getNRenderThreads(), _imp->scheduler->getDesiredFPS() );
+            }
         }
         if (stat == ViewerInstance::eViewerRenderRetCodeFail) {
             ///Don't report any error message otherwise we will flood the viewer with irrelevant messages such as
@@ -2997,6 +3139,17 @@ struct RenderEnginePrivate
         , refreshQueue()
     {
     }
+
+    // A render started while a change transaction is active must see the changes recorded so far
+    void flushChangeTransaction()
+    {
+        OutputEffectInstancePtr effect = output.lock();
+        AppInstancePtr app = effect ? effect->getApp() : AppInstancePtr();
+
+        if (app) {
+            app->flushChangeTransaction();
+        }
+    }
 };
 
 RenderEngine::RenderEngine(const OutputEffectInstancePtr& output)
@@ -3035,6 +3188,7 @@ RenderEngine::renderFrameRange(bool isBlocking,
                                RenderDirectionEnum forward)
 {
     setPlaybackAutoRestartEnabled(true);
+    _imp->flushChangeTransaction();
 
     {
         QMutexLocker k(&_imp->schedulerCreationLock);
@@ -3052,6 +3206,7 @@ RenderEngine::renderFromCurrentFrame(bool enableRenderStats,
                                      RenderDirectionEnum forward)
 {
     setPlaybackAutoRestartEnabled(true);
+    _imp->flushChangeTransaction();
 
     {
         QMutexLocker k(&_imp->schedulerCreationLock);
@@ -3137,6 +3292,7 @@ RenderEngine::renderCurrentFrame(bool enableRenderStats,
                                  bool canAbort)
 {
     assert( QThread::currentThread() == qApp->thread() );
+    _imp->flushChangeTransaction();
     RenderEnginePrivate::RefreshRequest r;
     r.enableStats = enableRenderStats;
     r.enableAbort = canAbort;
@@ -3415,6 +3571,9 @@ public:
     ViewerArgsPtr args[2];
     bool isRotoNeatRender;
 
+    // Started when the render is requested, to measure the latency of interactive renders
+    TimeLapse requestTimer;
+
     CurrentFrameFunctorArgs()
         : GenericThreadStartArgs()
         , view(0)
@@ -3429,6 +3588,7 @@ public:
         , strokeItem()
         , args()
         , isRotoNeatRender(false)
+        , requestTimer()
     {
     }
 
@@ -3455,6 +3615,7 @@ public:
         , strokeItem(strokeItem)
         , args()
         , isRotoNeatRender(isRotoNeatRender)
+        , requestTimer()
     {
         if (isRotoPaintRequest && isRotoNeatRender) {
             isRotoPaintRequest->getRotoContext()->setIsDoingNeatRender(true);
@@ -3486,6 +3647,13 @@ struct ViewerCurrentFrameRequestSchedulerPrivate
      * activity to keep the renders responsive even if the thread pool is choking.
      **/
     ViewerCurrentFrameRequestRendererBackup backupThread;
+
+    // Renders the frames around the current frame when the viewer is idle
+    ViewerSpeculativeRenderer speculativeRenderer;
+
+    // The frame of the last render request and the direction in which the timeline was last moved, only accessed on the main thread
+    int lastRequestedFrame;
+    int scrubDirection;
     mutable QMutex currentFrameRenderTasksMutex;
     QWaitCondition currentFrameRenderTasksCond;
     std::list<RenderCurrentFrameFunctorRunnable*> currentFrameRenderTasks;
@@ -3500,6 +3668,9 @@ struct ViewerCurrentFrameRequestSchedulerPrivate
         , producedFrames()
         , producedFramesNotEmpty()
         , backupThread()
+        , speculativeRenderer(viewer)
+        , lastRequestedFrame(0)
+        , scrubDirection(0)
         , currentFrameRenderTasksCond()
         , currentFrameRenderTasks()
         , ageCounter(0)
@@ -3554,6 +3725,20 @@ struct ViewerCurrentFrameRequestSchedulerPrivate
     }
 
     void processProducedFrame(const RenderStatsPtr& stats, const BufferableObjectPtrList& frames);
+
+    /**
+     * @brief Called once the given frame is displayed to render the frames around it in advance
+     **/
+    void startSpeculativeRender(int time, ViewIdx view)
+    {
+        if ( !appPTR->getCurrentSettings()->isSpeculativeRenderingEnabled() || viewer->getRenderEngine()->isDoingSequentialRender() ||
+             viewer->isDoingPartialUpdates() || (time != viewer->getTimeline()->currentFrame()) ) {
+            return;
+        }
+        int firstFrame, lastFrame;
+        viewer->getTimelineBounds(&firstFrame, &lastFrame);
+        speculativeRenderer.renderFramesAround(time, view, scrubDirection, firstFrame, lastFrame);
+    }
 };
 
 class RenderCurrentFrameFunctorRunnable
@@ -3601,6 +3786,7 @@ public:
             _args->viewer->disconnectViewer();
             ret.clear();
         } else {
+            RenderTaskScheduler::reportInteractiveLatency( _args->requestTimer.getTimeSinceCreation() );
             for (int i = 0; i < 2; ++i) {
                 if (_args->args[i] && _args->args[i]->params) {
                     if (_args->args[i]->params->tiles.size() > 0) {
@@ -3669,6 +3855,9 @@ ViewerCurrentFrameRequestScheduler::~ViewerCurrentFrameRequestScheduler()
     if (_imp->backupThread.quitThread(false)) {
         _imp->backupThread.waitForAbortToComplete_enforce_blocking();
     }
+    if (_imp->speculativeRenderer.quitThread(false)) {
+        _imp->speculativeRenderer.waitForAbortToComplete_enforce_blocking();
+    }
 }
 
 GenericSchedulerThread::TaskQueueBehaviorEnum
@@ -3782,15 +3971,18 @@ ViewerCurrentFrameRequestSchedulerPrivate::processProducedFrame(const RenderStat
     }
 
     //bool hasDoneSomething = false;
+    UpdateViewerParamsPtr displayedFrame;
     for (BufferableObjectPtrList::const_iterator it2 = frames.begin(); it2 != frames.end(); ++it2) {
         assert(*it2);
         UpdateViewerParamsPtr params = boost::dynamic_pointer_cast<UpdateViewerParams>(*it2);
         assert(params);
         if ( params && (params->tiles.size() >= 1) ) {
+            displayedFrame = params;
             if (stats) {
                 double timeSpent;
                 std::map<NodePtr, NodeRenderStats > ret = stats->getStats(&timeSpent);
-                viewer->reportStats(0, ViewIdx(0), timeSpent, ret);
+                viewer->appendTraceEvents( stats->getTraceEvents() );
+                viewer->reportStats( 0, ViewIdx(0), timeSpent, ret, stats->getMemoryGovernorStatus() );
             }
 
             viewer->updateViewer(params);
@@ -3800,6 +3992,10 @@ ViewerCurrentFrameRequestSchedulerPrivate::processProducedFrame(const RenderStat
 
     ///At least redraw the viewer, we might be here when the user removed a node upstream of the viewer.
     viewer->redrawViewer();
+
+    if ( displayedFrame && !displayedFrame->isPartialRect ) {
+        startSpeculativeRender( displayedFrame->time, displayedFrame->view );
+    }
 }
 
 void
@@ -3810,15 +4006,17 @@ ViewerCurrentFrameRequestScheduler::onAbortRequested(bool keepOldestRender)
 #endif
     //This will make all processing nodes that call the abort() function return true
     //This function marks all active renders of the viewer as aborted (except the oldest one)
-    //and each node actually check if the render has been aborted in EffectInstance::Implementation::aborted()
+    //and each node actually check if the render has been aborted in RenderAbortToken::isRenderAborted()
     _imp->viewer->markAllOnGoingRendersAsAborted(keepOldestRender);
     _imp->backupThread.abortThreadedTask();
+    _imp->speculativeRenderer.abortThreadedTask();
 }
 
 void
 ViewerCurrentFrameRequestScheduler::onQuitRequested(bool allowRestarts)
 {
     _imp->backupThread.quitThread(allowRestarts);
+    _imp->speculativeRenderer.quitThread(allowRestarts);
 }
 
 void
@@ -3826,6 +4024,7 @@ ViewerCurrentFrameRequestScheduler::onWaitForThreadToQuit()
 {
     _imp->waitForRunnableTasks();
     _imp->backupThread.waitForThreadToQuit_enforce_blocking();
+    _imp->speculativeRenderer.waitForThreadToQuit_enforce_blocking();
 }
 
 void
@@ -3833,6 +4032,7 @@ ViewerCurrentFrameRequestScheduler::onWaitForAbortCompleted()
 {
     _imp->waitForRunnableTasks();
     _imp->backupThread.waitForAbortToComplete_enforce_blocking();
+    _imp->speculativeRenderer.waitForAbortToComplete_enforce_blocking();
 }
 
 void
@@ -3860,6 +4060,13 @@ ViewerCurrentFrameRequestScheduler::renderCurrentFrame(bool enableRenderStats,
         return;
     }
 
+    // Frames rendered in advance must not delay this render
+    _imp->speculativeRenderer.abortThreadedTask();
+    if (frame != _imp->lastRequestedFrame) {
+        _imp->scrubDirection = frame > _imp->lastRequestedFrame ? 1 : -1;
+        _imp->lastRequestedFrame = frame;
+    }
+
     RenderStatsPtr stats;
     if (enableRenderStats) {
         stats.reset( new RenderStats(enableRenderStats) );
@@ -3942,9 +4149,13 @@ ViewerCurrentFrameRequestScheduler::renderCurrentFrame(bool enableRenderStats,
                 if ( stats && (i == 0) ) {
                     double timeSpent;
                     std::map<NodePtr, NodeRenderStats > statResults = stats->getStats(&timeSpent);
-                    _imp->viewer->reportStats(frame, view, timeSpent, statResults);
+                    _imp->viewer->appendTraceEvents( stats->getTraceEvents() );
+                    _imp->viewer->reportStats( frame, view, timeSpent, statResults, stats->getMemoryGovernorStatus() );
                 }
                 _imp->viewer->updateViewer(args[i]->params);
+                if (i == 0) {
+                    _imp->startSpeculativeRender(frame, view);
+                }
                 args[i].reset();
             }
         }
@@ -4041,6 +4252,149 @@ ViewerCurrentFrameRequestRendererBackup::threadLoopOnce(const GenericThreadStart
     return eThreadStateActive;
 }
 
+class ViewerSpeculativeRenderArgs
+    : public GenericThreadStartArgs
+{
+public:
+
+    int time;
+    ViewIdx view;
+    int direction;
+    int firstFrame, lastFrame;
+
+    ViewerSpeculativeRenderArgs()
+        : GenericThreadStartArgs()
+        , time(0)
+        , view(0)
+        , direction(0)
+        , firstFrame(0)
+        , lastFrame(0)
+    {
+    }
+};
+
+typedef boost::shared_ptr<ViewerSpeculativeRenderArgs> ViewerSpeculativeRenderArgsPtr;
+
+struct ViewerSpeculativeRendererPrivate
+{
+    ViewerInstance* viewer;
+
+    // Protects renderAbortInfo
+    QMutex renderAbortInfoMutex;
+
+    // The abort info of the frame being rendered
+    AbortableRenderInfoPtr renderAbortInfo;
+
+    ViewerSpeculativeRendererPrivate(ViewerInstance* viewer)
+        : viewer(viewer)
+        , renderAbortInfoMutex()
+        , renderAbortInfo()
+    {
+    }
+};
+
+ViewerSpeculativeRenderer::ViewerSpeculativeRenderer(ViewerInstance* viewer)
+    : GenericSchedulerThread()
+    , _imp( new ViewerSpeculativeRendererPrivate(viewer) )
+{
+    setThreadName("ViewerSpeculativeRenderer");
+}
+
+ViewerSpeculativeRenderer::~ViewerSpeculativeRenderer()
+{
+}
+
+void
+ViewerSpeculativeRenderer::renderFramesAround(int time,
+                                              ViewIdx view,
+                                              int direction,
+                                              int firstFrame,
+                                              int lastFrame)
+{
+    ViewerSpeculativeRenderArgsPtr args = boost::make_shared<ViewerSpeculativeRenderArgs>();
+
+    args->time = time;
+    args->view = view;
+    args->direction = direction;
+    args->firstFrame = firstFrame;
+    args->lastFrame = lastFrame;
+    startTask(args);
+}
+
+void
+ViewerSpeculativeRenderer::onAbortRequested(bool /*keepOldestRender*/)
+{
+    // Stop the frame being rendered right away rather than when it is done
+    QMutexLocker k(&_imp->renderAbortInfoMutex);
+
+    if (_imp->renderAbortInfo) {
+        _imp->renderAbortInfo->setAborted();
+    }
+}
+
+GenericSchedulerThread::ThreadStateEnum
+ViewerSpeculativeRenderer::threadLoopOnce(const GenericThreadStartArgsPtr& inArgs)
+{
+    ViewerSpeculativeRenderArgsPtr args = boost::dynamic_pointer_cast<ViewerSpeculativeRenderArgs>(inArgs);
+
+    assert(args);
+
+    // Frames in the scrubbing direction come first, with one frame on the other side every 2 frames
+    int nFrames = appPTR->getCurrentSettings()->getSpeculativeRenderingFrames();
+    int ahead = args->direction < 0 ? -1 : 1;
+    std::vector<int> frames;
+    for (int d = 1; d <= nFrames; ++d) {
+        frames.push_back(args->time + ahead * d);
+        if (args->direction == 0) {
+            frames.push_back(args->time - ahead * d);
+        } else if (d % 2 == 0) {
+            frames.push_back(args->time - ahead * (d / 2) );
+        }
+    }
+
+    ThreadStateEnum state = eThreadStateActive;
+    for (std::vector<int>::const_iterator it = frames.begin(); it != frames.end(); ++it) {
+        if ( (*it < args->firstFrame) || (*it > args->lastFrame) ) {
+            continue;
+        }
+
+        state = resolveState();
+        if ( (state == eThreadStateAborted) || (state == eThreadStateStopped) ) {
+            return state;
+        }
+
+        // Stop if the viewer is busy or if there are no spare resources
+        if ( !appPTR->getCurrentSettings()->isSpeculativeRenderingEnabled() ||
+             _imp->viewer->getRenderEngine()->isDoingSequentialRender() ||
+             (appPTR->getMemoryGovernorStatus().state == eMemoryGovernorStateCritical) ||
+             ( QThreadPool::globalInstance()->activeThreadCount() >= QThreadPool::globalInstance()->maxThreadCount() ) ) {
+            break;
+        }
+
+        AbortableRenderInfoPtr abortInfo = AbortableRenderInfo::create(true, 0, true /*isSpeculative*/);
+        {
+            QMutexLocker k(&_imp->renderAbortInfoMutex);
+            _imp->renderAbortInfo = abortInfo;
+        }
+
+        // An abort may have been requested before the abort info was set
+        state = resolveState();
+        if ( (state != eThreadStateAborted) && (state != eThreadStateStopped) ) {
+            _imp->viewer->renderFrameToCache(*it, args->view, abortInfo);
+        }
+
+        {
+            QMutexLocker k(&_imp->renderAbortInfoMutex);
+            _imp->renderAbortInfo.reset();
+        }
+        if ( (state == eThreadStateAborted) || (state == eThreadStateStopped) ) {
+            return state;
+        }
+    }
+
+    return state;
+} // ViewerSpeculativeRenderer::threadLoopOnce
+
 NATRON_NAMESPACE_EXIT
 
 NATRON_NAMESPACE_USING
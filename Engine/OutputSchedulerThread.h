@@ -308,6 +308,12 @@ public:
      **/
     void notifyThreadAboutToQuit(RenderThreadTask* thread);
 
+    /**
+     * @brief Returns the NUMA node on which the render-thread calling this should render its next frame.
+     * Frames are distributed on the nodes in turn, or -1 is returned if NUMA-aware rendering is not active.
+     **/
+    int getNextNumaNode();
+
     /**
      *@brief The slot called by the GUI to set the requested fps.
      **/
@@ -623,6 +629,42 @@ private:
 };
 
 
+/**
+ * @brief Used by the ViewerCurrentFrameRequestScheduler to render the frames around the current frame into the viewer cache
+ * once the current frame is displayed, so that they are already cached when the user scrubs the timeline.
+ * Any new request to render the current frame aborts it right away.
+ **/
+struct ViewerSpeculativeRendererPrivate;
+class ViewerSpeculativeRenderer
+    : public GenericSchedulerThread
+{
+public:
+
+    ViewerSpeculativeRenderer(ViewerInstance* viewer);
+
+    virtual ~ViewerSpeculativeRenderer();
+
+    /**
+     * @brief Renders the frames around the given time within [firstFrame, lastFrame]. More frames are rendered
+     * in the given direction (1 = forward, -1 = backward), or as many on both sides if it is 0.
+     **/
+    void renderFramesAround(int time, ViewIdx view, int direction, int firstFrame, int lastFrame);
+
+private:
+
+    virtual TaskQueueBehaviorEnum tasksQueueBehaviour() const OVERRIDE FINAL
+    {
+        return eTaskQueueBehaviorSkipToMostRecent;
+    }
+
+    virtual void onAbortRequested(bool keepOldestRender) OVERRIDE FINAL;
+
+    virtual ThreadStateEnum threadLoopOnce(const GenericThreadStartArgsPtr& inArgs) OVERRIDE FINAL WARN_UNUSED_RETURN;
+
+    boost::scoped_ptr<ViewerSpeculativeRendererPrivate> _imp;
+};
+
+
 /**
  * @brief This class manages multiple OutputThreadScheduler so that each render request gets processed as soon as possible.
  **/
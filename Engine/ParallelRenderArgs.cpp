@@ -38,6 +38,7 @@
 #include "Engine/NodeGroup.h"
 #include "Engine/GPUContextPool.h"
 #include "Engine/OSGLContext.h"
+#include "Engine/RenderAbortToken.h"
 #include "Engine/RotoContext.h"
 #include "Engine/RotoDrawableItem.h"
 #include "Engine/ViewIdx.h"
@@ -699,9 +700,14 @@ ParallelRenderArgsSetter::ParallelRenderArgsSetter(double time,
                                                    bool draftMode,
                                                    const RenderStatsPtr& stats)
     :  argsMap()
+    , nodes()
+    , abortTokenPushed(true)
 {
     assert(treeRoot);
 
+    // Let EffectInstance::aborted() find the abort info of this render without looking up the thread-local storage of the node
+    RenderAbortToken::push( isRenderUserInteraction, abortInfo, treeRoot->getEffectInstance() );
+
     // Ensure this thread gets an OpenGL context for the render of the frame
     OSGLContextPtr glContext;
     try {
@@ -817,6 +823,8 @@ ParallelRenderArgsSetter::updateNodesRequest(const FrameRequestMap& request)
 
 ParallelRenderArgsSetter::ParallelRenderArgsSetter(const boost::shared_ptr<std::map<NodePtr, ParallelRenderArgsPtr> >& args)
     : argsMap(args)
+    , nodes()
+    , abortTokenPushed(false)
 {
     // Ensure this thread gets an OpenGL context for the render of the frame
     OSGLContextPtr glContext;
@@ -832,11 +840,24 @@ ParallelRenderArgsSetter::ParallelRenderArgsSetter(const boost::shared_ptr<std::
             it->second->openGLContext = glContext;
             it->first->getEffectInstance()->setParallelRenderArgsTLS(it->second);
         }
+
+        // All nodes render the same frame, any of them holds the abort info of the render
+        if ( !argsMap->empty() ) {
+            const ParallelRenderArgsPtr& frameArgs = argsMap->begin()->second;
+            RenderAbortToken::push( frameArgs->isRenderResponseToUserInteraction,
+                                    frameArgs->abortInfo.lock(),
+                                    frameArgs->treeRoot ? frameArgs->treeRoot->getEffectInstance() : EffectInstancePtr() );
+            abortTokenPushed = true;
+        }
     }
 }
 
 ParallelRenderArgsSetter::~ParallelRenderArgsSetter()
 {
+    if (abortTokenPushed) {
+        RenderAbortToken::pop();
+    }
+
     for (NodesList::iterator it = nodes.begin(); it != nodes.end(); ++it) {
         if ( !(*it) || !(*it)->getEffectInstance() ) {
             continue;
@@ -893,6 +914,7 @@ ParallelRenderArgs::ParallelRenderArgs()
     , isDuringPaintStrokeCreation(false)
     , doNansHandling(true)
     , draftMode(false)
+    , isSpeculativeRender(false)
     , tilesSupported(false)
 {
 }
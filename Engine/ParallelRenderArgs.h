@@ -149,6 +149,9 @@ public:
     ///When true, this is a hint for plug-ins that the render will be used for draft such as previewing while scrubbing the timeline
     bool draftMode : 1;
 
+    ///True for the frames rendered in advance by the viewer when it is idle, see AbortableRenderInfo::isSpeculative()
+    bool isSpeculativeRender : 1;
+
     ///The support for tiles is local to a render and may change depending on GPU usage or other parameters
     bool tilesSupported : 1;
 
@@ -250,6 +253,9 @@ class ParallelRenderArgsSetter
     boost::shared_ptr<std::map<NodePtr, ParallelRenderArgsPtr> > argsMap;
     NodesList nodes;
 
+    // True if a RenderAbortToken was pushed on the thread for the duration of the render
+    bool abortTokenPushed;
+
 protected:
 
     OSGLContextWPtr _openGLContext;
@@ -482,5 +482,55 @@ App::addProjectLayer(const ImageLayer& layer)
     getInternalApp()->getProject()->addProjectDefaultLayer( layer.getInternalComps() );
 }
 
+ChangeTransaction*
+App::changeTransaction() const
+{
+    return new ChangeTransaction( getInternalApp() );
+}
+
+ChangeTransaction::ChangeTransaction(const AppInstancePtr& app)
+    : _app(app)
+    , _level(0)
+{
+}
+
+ChangeTransaction::~ChangeTransaction()
+{
+    while (_level > 0) {
+        commit();
+    }
+}
+
+void
+ChangeTransaction::begin()
+{
+    AppInstancePtr app = _app.lock();
+
+    if (!app) {
+        return;
+    }
+    app->beginChangeTransaction();
+    ++_level;
+}
+
+void
+ChangeTransaction::commit()
+{
+    if (_level == 0) {
+        return;
+    }
+    --_level;
+    AppInstancePtr app = _app.lock();
+    if (app) {
+        app->commitChangeTransaction();
+    }
+}
+
+bool
+ChangeTransaction::isActive() const
+{
+    return _level > 0;
+}
+
 NATRON_PYTHON_NAMESPACE_EXIT
 NATRON_NAMESPACE_EXIT
@@ -254,6 +254,43 @@ public:
 };
 
 
+/**
+ * @brief A change transaction on an App, see AppInstance::beginChangeTransaction().
+ * In Python it is a context manager:
+ *     with app.changeTransaction():
+ *         ...
+ * The transaction is committed when the object is destroyed if commit() was not called.
+ **/
+class ChangeTransaction
+{
+public:
+
+    ChangeTransaction(const AppInstancePtr& app);
+
+    ~ChangeTransaction();
+
+    /**
+     * @brief Opens the transaction. It may be called several times, each call must be matched by a call to commit().
+     **/
+    void begin();
+
+    /**
+     * @brief Closes the transaction. When the outermost transaction of the app is committed, the knobChanged handlers
+     * run once per parameter changed, the hashes are recomputed once and the viewers are rendered once.
+     **/
+    void commit();
+
+    /**
+     * @brief Returns true if this object has opened a transaction that is not committed yet.
+     **/
+    bool isActive() const;
+
+private:
+
+    AppInstanceWPtr _app;
+    int _level;
+};
+
 class App
     : public Group
 {
@@ -323,6 +360,11 @@ public:
 
     void addProjectLayer(const ImageLayer& layer);
 
+    /**
+     * @brief Returns a new transaction on this app, see ChangeTransaction.
+     **/
+    ChangeTransaction* changeTransaction() const;
+
 protected:
 
     void renderInternal(bool forceBlocking, Effect* writeNode, int firstFrame, int lastFrame, int frameStep);
@@ -27,6 +27,10 @@
 #include <cassert>
 #include <stdexcept>
 
+#include "Engine/AbortableRenderInfo.h"
+#include "Engine/AppManager.h"
+#include "Engine/Image.h"
+#include "Engine/ImageBufferNode.h"
 #include "Engine/Node.h"
 #include "Engine/KnobTypes.h"
 #include "Engine/KnobFile.h"
@@ -37,6 +41,7 @@
 #include "Engine/PyTracker.h"
 #include "Engine/TimeLine.h"
 #include "Engine/Hash64.h"
+#include "Engine/ParallelRenderArgs.h"
 
 NATRON_NAMESPACE_ENTER
 NATRON_PYTHON_NAMESPACE_ENTER
@@ -177,6 +182,193 @@ ImageLayer::getDisparityRightComponents()
     return ImageLayer( ImagePlaneDesc::getDisparityRightComponents() );
 }
 
+struct ImageBufferPrivate
+{
+    NodeWPtr node;
+    ImagePtr image;
+    RectI bounds;
+    bool writable;
+
+    // Only one of them is set, depending on writable
+    Image::ReadAccessPtr readAccess;
+    Image::WriteAccessPtr writeAccess;
+
+    // Views exported through the buffer protocol, only accessed with the GIL held
+    int viewsCount;
+    bool releasePending;
+
+    ImageBufferPrivate(const NodePtr& node,
+                       const ImagePtr& image,
+                       const RectI& roi,
+                       bool writable)
+        : node(node)
+        , image(image)
+        , bounds()
+        , writable(writable)
+        , readAccess()
+        , writeAccess()
+        , viewsCount(0)
+        , releasePending(false)
+    {
+        if ( !image || !roi.intersect(image->getBounds(), &bounds) ) {
+            this->image.reset();
+
+            return;
+        }
+        if (writable) {
+            writeAccess.reset( new Image::WriteAccess( image.get() ) );
+        } else {
+            readAccess.reset( new Image::ReadAccess( image.get() ) );
+        }
+    }
+};
+
+ImageBuffer::ImageBuffer(const NodePtr& node,
+                         const ImagePtr& image,
+                         const RectI& roi,
+                         bool writable)
+    : _imp( new ImageBufferPrivate(node, image, roi, writable) )
+{
+}
+
+ImageBuffer::~ImageBuffer()
+{
+    releaseInternal();
+}
+
+bool
+ImageBuffer::isValid() const
+{
+    return _imp->image && !_imp->releasePending;
+}
+
+bool
+ImageBuffer::isWritable() const
+{
+    return _imp->writable;
+}
+
+RectI
+ImageBuffer::getBounds() const
+{
+    return _imp->bounds;
+}
+
+int
+ImageBuffer::getComponentsCount() const
+{
+    if (!_imp->image) {
+        return 0;
+    }
+
+    return (int)_imp->image->getComponentsCount();
+}
+
+ImageLayer
+ImageBuffer::getLayer() const
+{
+    if (!_imp->image) {
+        return ImageLayer::getNoneComponents();
+    }
+
+    return ImageLayer( _imp->image->getComponents() );
+}
+
+ImageBitDepthEnum
+ImageBuffer::getBitDepth() const
+{
+    if (!_imp->image) {
+        return eImageBitDepthNone;
+    }
+
+    return _imp->image->getBitDepth();
+}
+
+unsigned char*
+ImageBuffer::getPixelData() const
+{
+    if ( !isValid() ) {
+        return 0;
+    }
+    if (_imp->writeAccess) {
+        return _imp->writeAccess->pixelAt(_imp->bounds.x1, _imp->bounds.y1);
+    }
+
+    // The buffer protocol honors the read-only flag, the pixels are never written through this pointer
+    return const_cast<unsigned char*>( _imp->readAccess->pixelAt(_imp->bounds.x1, _imp->bounds.y1) );
+}
+
+int
+ImageBuffer::getRowBytes() const
+{
+    if (!_imp->image) {
+        return 0;
+    }
+
+    return (int)_imp->image->getRowElements() * getBytesPerComponent();
+}
+
+int
+ImageBuffer::getBytesPerComponent() const
+{
+    if (!_imp->image) {
+        return 0;
+    }
+
+    return getSizeOfForBitDepth( _imp->image->getBitDepth() );
+}
+
+void
+ImageBuffer::retainView()
+{
+    ++_imp->viewsCount;
+}
+
+void
+ImageBuffer::releaseView()
+{
+    assert(_imp->viewsCount > 0);
+    --_imp->viewsCount;
+    if ( (_imp->viewsCount == 0) && _imp->releasePending ) {
+        releaseInternal();
+    }
+}
+
+void
+ImageBuffer::release()
+{
+    if (_imp->viewsCount > 0) {
+        _imp->releasePending = true;
+
+        return;
+    }
+    releaseInternal();
+}
+
+void
+ImageBuffer::releaseInternal()
+{
+    if (!_imp->image) {
+        return;
+    }
+    _imp->readAccess.reset();
+    _imp->writeAccess.reset();
+    ImagePtr image = _imp->image;
+    _imp->image.reset();
+    _imp->releasePending = false;
+
+    if (!_imp->writable) {
+        return;
+    }
+
+    // The pixels become the output of the ImageBuffer node: they are never written again
+    NodePtr node = _imp->node.lock();
+    ImageBufferNode* isImageBufferNode = node ? dynamic_cast<ImageBufferNode*>( node->getEffectInstance().get() ) : 0;
+    if (isImageBufferNode) {
+        isImageBufferNode->setBuffer(image);
+    }
+}
+
 UserParamHolder::UserParamHolder()
     : _holder(0)
 {
@@ -964,6 +1156,129 @@ Effect::getRegionOfDefinition(double time,
     return rod;
 }
 
+ImageBuffer*
+Effect::renderImage(double time,
+                    int view,
+                    double scale,
+                    const ImageLayer& layer,
+                    const RectI& roi) const
+{
+    NodePtr node = getInternalNode();
+
+    if ( !node || !node->getEffectInstance() || roi.isNull() || (scale <= 0.) || (scale > 1.) ) {
+        return 0;
+    }
+
+    // The render must see the values and hashes of the changes recorded so far by a change transaction
+    AppInstancePtr app = node->getApp();
+    if (app) {
+        app->flushChangeTransaction();
+    }
+
+    // Groups render through their output node
+    NodePtr renderNode = node;
+    NodeGroup* isGroup = node->isEffectGroup();
+    if (isGroup) {
+        renderNode = isGroup->getOutputNode(false);
+        if (!renderNode) {
+            return 0;
+        }
+    }
+    EffectInstancePtr effect = renderNode->getEffectInstance();
+    unsigned int mipMapLevel = Image::getLevelFromScale(scale);
+    RenderScale renderScale( Image::getScaleFromMipMapLevel(mipMapLevel) );
+
+    RectD rod;
+    bool isProjectFormat;
+    StatusEnum stat = effect->getRegionOfDefinition_public(renderNode->getHashValue(), time, renderScale, ViewIdx(view), &rod, &isProjectFormat);
+    if ( (stat == eStatusFailed) || rod.isNull() ) {
+        return 0;
+    }
+
+    std::map<ImagePlaneDesc, ImagePtr> planes;
+    {
+        const bool isRenderUserInteraction = true;
+        const bool isSequentialRender = false;
+        AbortableRenderInfoPtr abortInfo = AbortableRenderInfo::create(false, 0);
+        // The render is an analysis so that the output of the tree root is always created in the cache:
+        // the returned buffer points to that cached image.
+        ParallelRenderArgsSetter frameRenderArgs( time,
+                                                  ViewIdx(view),
+                                                  isRenderUserInteraction, //<isRenderUserInteraction
+                                                  isSequentialRender, //isSequential
+                                                  abortInfo, // abort info
+                                                  renderNode, // requester
+                                                  0, //texture index
+                                                  node->getApp()->getTimeLine().get(), // timeline
+                                                  NodePtr(), //rotoPaint node
+                                                  true, // isAnalysis
+                                                  false, // isDraft
+                                                  RenderStatsPtr() );
+        FrameRequestMap request;
+        stat = EffectInstance::computeRequestPass(time, ViewIdx(view), mipMapLevel, rod, renderNode, request);
+        if (stat == eStatusFailed) {
+            return 0;
+        }
+        frameRenderArgs.updateNodesRequest(request);
+
+        std::list<ImagePlaneDesc> requestedComps;
+        requestedComps.push_back( layer.getInternalComps() );
+        try {
+            EffectInstance::RenderRoIArgs args( time,
+                                                renderScale,
+                                                mipMapLevel,
+                                                ViewIdx(view),
+                                                false, // byPassCache
+                                                roi,
+                                                rod,
+                                                requestedComps,
+                                                effect->getBitDepth(-1),
+                                                false,
+                                                effect.get(),
+                                                eStorageModeRAM /*returnStorage*/,
+                                                time /*callerRenderTime*/);
+            EffectInstance::RenderRoIRetCode retCode = effect->renderRoI(args, &planes);
+            if (retCode != EffectInstance::eRenderRoIRetCodeOk) {
+                return 0;
+            }
+        } catch (...) {
+            return 0;
+        }
+    }
+
+    if ( planes.empty() ) {
+        return 0;
+    }
+
+    ImageBuffer* ret = new ImageBuffer(renderNode, planes.begin()->second, roi, false);
+    if ( !ret->isValid() ) {
+        delete ret;
+
+        return 0;
+    }
+
+    return ret;
+} // renderImage
+
+ImageBuffer*
+Effect::createImageBuffer(const ImageLayer& layer,
+                          const RectI& bounds) const
+{
+    NodePtr node = getInternalNode();
+    ImageBufferNode* isImageBufferNode = node ? dynamic_cast<ImageBufferNode*>( node->getEffectInstance().get() ) : 0;
+
+    if (!isImageBufferNode) {
+        return 0;
+    }
+
+    ImagePtr buffer = isImageBufferNode->createBuffer(layer.getInternalComps(), bounds);
+    if (!buffer) {
+        return 0;
+    }
+
+    return new ImageBuffer(node, buffer, bounds, true);
+}
+
 void
 Effect::setSubGraphEditable(bool editable)
 {
@@ -35,6 +35,7 @@
 #include <list>
 #if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
 #include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
 #endif
 
 #include "Engine/ImagePlaneDesc.h"
@@ -101,6 +102,72 @@ public:
     static ImageLayer getDisparityRightComponents();
 };
 
+struct ImageBufferPrivate;
+
+/**
+ * @brief The pixels of an image rendered by Effect::renderImage, or the pixels to output from an ImageBuffer node
+ * created by Effect::createImageBuffer.
+ * A rendered buffer directly points to the image held by the cache: no copy of the pixels is made.
+ * While the buffer is alive, it holds a reference on the image and locks it for reading, which prevents renders
+ * from modifying the pixels underneath.
+ * Call release() as soon as the pixels are no longer needed so that renders touching this image can proceed.
+ * A writable buffer is owned by the ImageBuffer node and only becomes its output once released.
+ *
+ * Rows are laid out bottom-up: the first row of the buffer is the bottom row of getBounds().
+ **/
+class ImageBuffer
+{
+public:
+
+    ImageBuffer(const NodePtr& node,
+                const ImagePtr& image,
+                const RectI& roi,
+                bool writable);
+
+    ~ImageBuffer();
+
+    /**
+     * @brief Returns false once release() has been called.
+     **/
+    bool isValid() const;
+
+    bool isWritable() const;
+
+    /**
+     * @brief The pixel rectangle covered by the buffer, this is the RoI passed to Effect::renderImage
+     * clipped to the bounds of the rendered image.
+     **/
+    RectI getBounds() const;
+
+    int getComponentsCount() const;
+
+    ImageLayer getLayer() const;
+
+    NATRON_NAMESPACE::ImageBitDepthEnum getBitDepth() const;
+
+    /**
+     * @brief Unlocks the image and drops the reference held on it. If the buffer was writable, it becomes the output
+     * of the ImageBuffer node, which changes the hash of the node and of the nodes downstream.
+     * If views on the buffer are still alive, the release is deferred until the last of them goes away.
+     **/
+    void release();
+
+    /*
+     * Used by the bindings to implement the buffer protocol: the pointer is the bottom-left pixel of getBounds().
+     */
+    unsigned char* getPixelData() const;
+    int getRowBytes() const;
+    int getBytesPerComponent() const;
+    void retainView();
+    void releaseView();
+
+private:
+
+    void releaseInternal();
+
+    boost::scoped_ptr<ImageBufferPrivate> _imp;
+};
+
 class UserParamHolder
 {
     KnobHolder* _holder;
@@ -369,6 +436,27 @@ public:
 
     RectD getRegionOfDefinition(double time, int /* Python API: do not use ViewIdx */ view) const;
 
+    /**
+     * @brief Renders the given layer of the node over the roi (in pixel coordinates at the given scale) and returns
+     * the pixels, read-only, without copying them out of the cache.
+     * @returns NULL if the render failed, the caller is responsible for freeing the returned buffer.
+     **/
+    ImageBuffer* renderImage(double time,
+                             int /* Python API: do not use ViewIdx */ view,
+                             double scale,
+                             const ImageLayer& layer,
+                             const RectI& roi) const;
+
+    /**
+     * @brief Returns a writable buffer of the given color layer and bounds (in pixel coordinates at full resolution)
+     * for this node, which must be an ImageBuffer node. The buffer is initialized with the current output of the node
+     * where they overlap and becomes the output of the node once released.
+     * @returns NULL if this is not an ImageBuffer node or if the layer is not a color layer,
+     * the caller is responsible for freeing the returned buffer.
+     **/
+    ImageBuffer* createImageBuffer(const ImageLayer& layer,
+                                   const RectI& bounds) const;
+
     static Param* createParamWrapperForKnob(const KnobIPtr& knob);
 
     void setSubGraphEditable(bool editable);
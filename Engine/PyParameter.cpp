@@ -27,6 +27,8 @@
 #include <cassert>
 #include <stdexcept>
 
+#include <boost/math/special_functions/fpclassify.hpp>
+
 #include "Engine/EffectInstance.h"
 #include "Engine/Node.h"
 #include "Engine/AppInstance.h"
@@ -529,6 +531,84 @@ AnimatedParam::removeAnimation(int dimension)
     knob->removeAnimation(ViewSpec::all(), dimension);
 }
 
+static bool
+isFinite(double v)
+{
+    return !(boost::math::isnan)(v) && !(boost::math::isinf)(v);
+}
+
+bool
+AnimatedParam::setKeyFrames(const std::vector<double>& times,
+                            const std::vector<double>& values,
+                            int dimension,
+                            const std::vector<double>& leftDerivatives,
+                            const std::vector<double>& rightDerivatives)
+{
+    KnobIPtr knob = getInternalKnob();
+
+    if (!knob) {
+        return false;
+    }
+    if ( ( values.size() != times.size() ) || ( leftDerivatives.size() != rightDerivatives.size() ) ||
+         ( !leftDerivatives.empty() && ( leftDerivatives.size() != times.size() ) ) ) {
+        return false;
+    }
+
+    bool hasDerivatives = !leftDerivatives.empty();
+    std::vector<KeyFrame> keys;
+    keys.reserve( times.size() );
+    for (std::size_t i = 0; i < times.size(); ++i) {
+        if ( !isFinite(times[i]) || !isFinite(values[i]) ) {
+            continue;
+        }
+        if (hasDerivatives) {
+            if ( !isFinite(leftDerivatives[i]) || !isFinite(rightDerivatives[i]) ) {
+                continue;
+            }
+            KeyframeTypeEnum interp = leftDerivatives[i] == rightDerivatives[i] ? eKeyframeTypeFree : eKeyframeTypeBroken;
+            keys.push_back( KeyFrame(times[i], values[i], leftDerivatives[i], rightDerivatives[i], interp) );
+        } else {
+            keys.push_back( KeyFrame(times[i], values[i]) );
+        }
+    }
+    try {
+        knob->setKeyFrames(keys, ViewSpec::current(), dimension, eValueChangedReasonNatronInternalEdited);
+    } catch (const std::invalid_argument&) {
+        return false;
+    }
+
+    return true;
+}
+
+void
+AnimatedParam::getKeyFrames(std::vector<double>* times,
+                            std::vector<double>* values,
+                            std::vector<double>* leftDerivatives,
+                            std::vector<double>* rightDerivatives,
+                            int dimension) const
+{
+    KnobIPtr knob = getInternalKnob();
+
+    if ( !knob || (dimension < 0) || ( dimension >= knob->getDimension() ) ) {
+        return;
+    }
+    CurvePtr curve = knob->getCurve(ViewSpec::current(), dimension);
+    if (!curve) {
+        return;
+    }
+    KeyFrameSet keys = curve->getKeyFrames_mt_safe();
+    times->reserve( keys.size() );
+    values->reserve( keys.size() );
+    leftDerivatives->reserve( keys.size() );
+    rightDerivatives->reserve( keys.size() );
+    for (KeyFrameSet::const_iterator it = keys.begin(); it != keys.end(); ++it) {
+        times->push_back( it->getTime() );
+        values->push_back( it->getValue() );
+        leftDerivatives->push_back( it->getLeftDerivative() );
+        rightDerivatives->push_back( it->getRightDerivative() );
+    }
+}
+
 double
 AnimatedParam::getDerivativeAtTime(double time,
                                    int dimension) const
@@ -245,6 +245,29 @@ public:
      **/
     void removeAnimation(int dimension = 0);
 
+    /**
+     * @brief Sets all the keyframes at once on the given dimension, replacing the existing keyframes at the same times.
+     * values must have the same size as times. If leftDerivatives and rightDerivatives are not empty, they must have
+     * the same size as well: the keyframes then get a Free interpolation (or Broken if the derivatives differ),
+     * otherwise their derivatives are computed automatically.
+     * The parameter changes only once, which is much faster than calling setValueAtTime for each keyframe.
+     * Returns false if the arguments are invalid or if the parameter cannot be animated this way (e.g. strings).
+     **/
+    bool setKeyFrames(const std::vector<double>& times,
+                      const std::vector<double>& values,
+                      int dimension = 0,
+                      const std::vector<double>& leftDerivatives = std::vector<double>(),
+                      const std::vector<double>& rightDerivatives = std::vector<double>());
+
+    /**
+     * @brief Returns all the keyframes of the given dimension at once, ordered by time.
+     **/
+    void getKeyFrames(std::vector<double>* times,
+                      std::vector<double>* values,
+                      std::vector<double>* leftDerivatives,
+                      std::vector<double>* rightDerivatives,
+                      int dimension = 0) const;
+
     /**
      * @brief Compute the derivative at time as a double
      **/
@@ -0,0 +1,229 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "RenderAbortToken.h"
+
+#include <vector>
+#include <cassert>
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QThreadStorage>
+
+#include "Engine/AbortableRenderInfo.h"
+#include "Engine/OutputEffectInstance.h"
+
+NATRON_NAMESPACE_ENTER
+
+namespace {
+
+struct TokenEntry
+{
+    bool isRenderResponseToUserInteraction;
+    AbortableRenderInfoPtr abortInfo;
+    EffectInstanceWPtr treeRoot;
+
+    // Epoch at which the render was last found not aborted by the full check
+    bool checked;
+    int checkedEpoch;
+
+    TokenEntry()
+        : isRenderResponseToUserInteraction(false)
+        , abortInfo()
+        , treeRoot()
+        , checked(false)
+        , checkedEpoch(0)
+    {
+    }
+};
+
+typedef std::vector<TokenEntry> TokenStack;
+
+struct RenderAbortTokenState
+{
+    QAtomicInt epoch;
+    QThreadStorage<TokenStack> tokens;
+
+    RenderAbortTokenState()
+        : epoch(0)
+        , tokens()
+    {
+    }
+};
+
+// Never destroyed: threads may still exit after static destructors ran
+RenderAbortTokenState* gTokens = new RenderAbortTokenState;
+
+TokenEntry
+makeEntry(bool isRenderResponseToUserInteraction,
+          const AbortableRenderInfoPtr& abortInfo,
+          const EffectInstancePtr& treeRoot)
+{
+    TokenEntry entry;
+
+    entry.isRenderResponseToUserInteraction = isRenderResponseToUserInteraction;
+    entry.abortInfo = abortInfo;
+    entry.treeRoot = treeRoot;
+
+    return entry;
+}
+} // anonymous namespace
+
+void
+RenderAbortToken::push(bool isRenderResponseToUserInteraction,
+                       const AbortableRenderInfoPtr& abortInfo,
+                       const EffectInstancePtr& treeRoot)
+{
+    gTokens->tokens.localData().push_back( makeEntry(isRenderResponseToUserInteraction, abortInfo, treeRoot) );
+}
+
+void
+RenderAbortToken::pop()
+{
+    TokenStack& tokens = gTokens->tokens.localData();
+
+    // The tokens may have been cleared by AppTLS::cleanupTLSForThread() in the meantime
+    if ( !tokens.empty() ) {
+        tokens.pop_back();
+    }
+}
+
+void
+RenderAbortToken::set(bool isRenderResponseToUserInteraction,
+                      const AbortableRenderInfoPtr& abortInfo,
+                      const EffectInstancePtr& treeRoot)
+{
+    TokenStack& tokens = gTokens->tokens.localData();
+
+    tokens.clear();
+    tokens.push_back( makeEntry(isRenderResponseToUserInteraction, abortInfo, treeRoot) );
+}
+
+void
+RenderAbortToken::clear()
+{
+    if ( gTokens->tokens.hasLocalData() ) {
+        gTokens->tokens.localData().clear();
+    }
+}
+
+bool
+RenderAbortToken::isCurrentThreadAborted(bool* aborted)
+{
+    TokenStack& tokens = gTokens->tokens.localData();
+
+    if ( tokens.empty() ) {
+        return false;
+    }
+    TokenEntry& token = tokens.back();
+
+    if (token.isRenderResponseToUserInteraction) {
+        if ( !token.abortInfo || !token.abortInfo->canAbort() ) {
+            *aborted = false;
+
+            return true;
+        }
+    }
+
+    // This is very fast, we just peek the atomic int inside the abort info
+    if ( token.abortInfo && token.abortInfo->isAborted() ) {
+        *aborted = true;
+
+        return true;
+    }
+
+    // Nothing that could abort this render changed since the last full check
+    int epoch = (int)gTokens->epoch;
+    if ( token.checked && (token.checkedEpoch == epoch) ) {
+        *aborted = false;
+
+        return true;
+    }
+
+    *aborted = isRenderAborted( token.isRenderResponseToUserInteraction, token.abortInfo, token.treeRoot.lock() );
+    if (!*aborted) {
+        token.checked = true;
+        token.checkedEpoch = epoch;
+    }
+
+    return true;
+}
+
+bool
+RenderAbortToken::isRenderAborted(bool isRenderResponseToUserInteraction,
+                                  const AbortableRenderInfoPtr& abortInfo,
+                                  const EffectInstancePtr& treeRoot)
+{
+    if (!isRenderResponseToUserInteraction) {
+        // Rendering is playback or render on disk
+
+        // If we have abort info, e just peek the atomic int inside the abort info, this is very fast
+        if ( abortInfo && abortInfo->isAborted() ) {
+            return true;
+        }
+
+        // Fallback on the flag set on the node that requested the render in OutputSchedulerThread
+        if (treeRoot) {
+            OutputEffectInstance* effect = dynamic_cast<OutputEffectInstance*>( treeRoot.get() );
+            assert(effect);
+            if (effect) {
+                return effect->isSequentialRenderBeingAborted();
+            }
+        }
+
+        // We have no other means to know if abort was called
+        return false;
+    } else {
+        // This is a render issued to refresh the image on the Viewer
+
+        if ( !abortInfo || !abortInfo->canAbort() ) {
+            // We do not have any abortInfo set or this render is not abortable. This should be avoided as much as possible!
+            return false;
+        }
+
+        // This is very fast, we just peek the atomic int inside the abort info
+        if ( (int)abortInfo->isAborted() ) {
+            return true;
+        }
+
+        // If this node can start sequential renders (e.g: start playback like on the viewer or render on disk) and it is already doing a sequential render, abort
+        // this render
+        OutputEffectInstance* isRenderEffect = dynamic_cast<OutputEffectInstance*>( treeRoot.get() );
+        if (isRenderEffect) {
+            if ( isRenderEffect->isDoingSequentialRender() ) {
+                return true;
+            }
+        }
+
+        // The render was not aborted
+        return false;
+    }
+} // RenderAbortToken::isRenderAborted
+
+void
+RenderAbortToken::notifyAbortStateChanged()
+{
+    gTokens->epoch.fetchAndAddRelease(1);
+}
+
+NATRON_NAMESPACE_EXIT
@@ -0,0 +1,96 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef Engine_RenderAbortToken_h
+#define Engine_RenderAbortToken_h
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include "Engine/EngineFwd.h"
+
+NATRON_NAMESPACE_ENTER
+
+/**
+ * @brief A cheap way for a thread to know whether the render it is currently working on was aborted.
+ * Each thread has a stack of tokens in thread-local storage. A token is pushed by ParallelRenderArgsSetter for the
+ * duration of a render, and copied to the threads spawned for host frame threading and the OpenFX multi-thread suite.
+ *
+ * Checking a token only reads the atomic flag of the AbortableRenderInfo and a global abort epoch. The epoch is
+ * incremented whenever a render engine is aborted or starts/stops working, which are the other conditions
+ * that may abort a render (see isRenderAborted()). The full check is only done again when the epoch changed since the
+ * last check, so that polling from the inner loops of a render is cheap and an abort is seen at the next poll.
+ * This class is MT-safe.
+ **/
+class RenderAbortToken
+{
+public:
+
+    /**
+     * @brief Pushes the token of the given render on the current thread
+     **/
+    static void push(bool isRenderResponseToUserInteraction,
+                     const AbortableRenderInfoPtr& abortInfo,
+                     const EffectInstancePtr& treeRoot);
+
+    /**
+     * @brief Pops the token pushed last on the current thread
+     **/
+    static void pop();
+
+    /**
+     * @brief Replaces all tokens of the current thread by the given one. This is used for threads spawned to help
+     * rendering, which are cleared with clear() when their work is done.
+     **/
+    static void set(bool isRenderResponseToUserInteraction,
+                    const AbortableRenderInfoPtr& abortInfo,
+                    const EffectInstancePtr& treeRoot);
+
+    /**
+     * @brief Removes all tokens of the current thread
+     **/
+    static void clear();
+
+    /**
+     * @brief Returns true if the current thread has a token, in which case aborted is set to whether its render was aborted.
+     * This is fast enough to be called for every scan-line of a render.
+     **/
+    static bool isCurrentThreadAborted(bool* aborted);
+
+    /**
+     * @brief Determines whether the given render was aborted, without using the token of the current thread.
+     **/
+    static bool isRenderAborted(bool isRenderResponseToUserInteraction,
+                                const AbortableRenderInfoPtr& abortInfo,
+                                const EffectInstancePtr& treeRoot);
+
+    /**
+     * @brief Increments the abort epoch. This must be called whenever a condition checked by isRenderAborted()
+     * may have changed, except for AbortableRenderInfo::setAborted() whose flag is always checked.
+     **/
+    static void notifyAbortStateChanged();
+};
+
+NATRON_NAMESPACE_EXIT
+
+#endif // Engine_RenderAbortToken_h
@@ -0,0 +1,285 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "RenderServer.h"
+
+#include <cassert>
+#include <iostream>
+#include <list>
+#include <stdexcept>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDateTime>
+#include <QtCore/QFileInfo>
+#include <QtNetwork/QLocalServer>
+#include <QtNetwork/QLocalSocket>
+
+#include "Engine/AppInstance.h"
+#include "Engine/AppManager.h"
+#include "Engine/CLArgs.h"
+#include "Engine/Project.h"
+#include "Engine/Timer.h"
+
+NATRON_NAMESPACE_ENTER
+
+struct RenderServerPrivate
+{
+    AppInstanceWPtr app;
+    QLocalServer* server;
+    std::list<QLocalSocket*> clients;
+
+    // Describes the project currently loaded in the app, so that the next job can reuse it
+    RenderServerLoadedProject loadedProject;
+    int nJobs;
+    bool mustQuit;
+
+    RenderServerPrivate(const AppInstancePtr& app)
+        : app(app)
+        , server(0)
+        , clients()
+        , loadedProject()
+        , nJobs(0)
+        , mustQuit(false)
+    {
+    }
+};
+
+RenderServer::RenderServer(const AppInstancePtr& app)
+    : QObject()
+    , _imp( new RenderServerPrivate(app) )
+{
+}
+
+RenderServer::~RenderServer()
+{
+    for (std::list<QLocalSocket*>::iterator it = _imp->clients.begin(); it != _imp->clients.end(); ++it) {
+        (*it)->disconnect(this);
+        (*it)->deleteLater();
+    }
+    delete _imp->server;
+}
+
+bool
+RenderServer::listen(const QString& serverName)
+{
+    assert(!_imp->server);
+    _imp->server = new QLocalServer();
+    QObject::connect( _imp->server, SIGNAL(newConnection()), this, SLOT(onNewConnectionPending()) );
+
+    // A stale socket file may remain if a previous server crashed
+    QLocalServer::removeServer(serverName);
+    if ( !_imp->server->listen(serverName) ) {
+        std::cerr << tr("Render server: failed to listen on %1: %2").arg(serverName).arg( _imp->server->errorString() ).toStdString() << std::endl;
+
+        return false;
+    }
+    std::cout << tr("Render server: listening on %1").arg( _imp->server->fullServerName() ).toStdString() << std::endl;
+
+    return true;
+}
+
+void
+RenderServer::onNewConnectionPending()
+{
+    while ( _imp->server->hasPendingConnections() ) {
+        QLocalSocket* client = _imp->server->nextPendingConnection();
+        if (!client) {
+            break;
+        }
+        QObject::connect( client, SIGNAL(readyRead()), this, SLOT(onClientDataReceived()) );
+        QObject::connect( client, SIGNAL(disconnected()), this, SLOT(onClientDisconnected()) );
+        _imp->clients.push_back(client);
+    }
+}
+
+void
+RenderServer::onClientDisconnected()
+{
+    QLocalSocket* client = qobject_cast<QLocalSocket*>( sender() );
+
+    if (!client) {
+        return;
+    }
+    _imp->clients.remove(client);
+    client->deleteLater();
+}
+
+void
+RenderServer::onClientDataReceived()
+{
+    QLocalSocket* client = qobject_cast<QLocalSocket*>( sender() );
+
+    if (!client) {
+        return;
+    }
+
+    while ( !_imp->mustQuit && client->canReadLine() ) {
+        QString line = QString::fromUtf8( client->readLine() );
+        while ( line.endsWith( QChar::fromLatin1('\n') ) || line.endsWith( QChar::fromLatin1('\r') ) ) {
+            line.chop(1);
+        }
+        if ( line.trimmed().isEmpty() ) {
+            continue;
+        }
+        if ( line == QString::fromUtf8(kRenderServerQuit) ) {
+            _imp->mustQuit = true;
+            break;
+        }
+
+        QStringList arguments = line.split( QChar::fromLatin1('\t'), QString::SkipEmptyParts );
+        QString errorMessage;
+        QString reply;
+        if ( executeJob(arguments, &errorMessage) ) {
+            reply = QString::fromUtf8(kRenderServerJobDone);
+        } else {
+            reply = QString::fromUtf8(kRenderServerJobError) + QLatin1Char(' ') + errorMessage.simplified();
+        }
+        client->write( ( reply + QLatin1Char('\n') ).toUtf8() );
+        client->flush();
+    }
+
+    if (_imp->mustQuit) {
+        std::cout << tr("Render server: quitting after %1 job(s)").arg(_imp->nJobs).toStdString() << std::endl;
+        qApp->quit();
+    }
+}
+
+bool
+RenderServerLoadedProject::jobModifiesProject(const CLArgs& cl)
+{
+    // Python commands and scripts may change anything in the project
+    if ( !cl.getPythonCommands().empty() || cl.isPythonScript() ) {
+        return true;
+    }
+    // Reader overrides change the file parameter of Read nodes
+    if ( !cl.getReaderArgs().empty() ) {
+        return true;
+    }
+    // Writer overrides change the file parameter of Write nodes, or create new Write nodes
+    const std::list<CLArgs::WriterArg>& writers = cl.getWriterArgs();
+    for (std::list<CLArgs::WriterArg>::const_iterator it = writers.begin(); it != writers.end(); ++it) {
+        if ( it->mustCreate || !it->filename.isEmpty() ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool
+RenderServerLoadedProject::canBeReusedBy(const CLArgs& cl) const
+{
+    if ( dirty || path.isEmpty() || cl.isPythonScript() ) {
+        return false;
+    }
+    // Python commands are executed before the project is loaded: only a reload runs them
+    if ( !cl.getPythonCommands().empty() ) {
+        return false;
+    }
+    if ( cl.getDefaultOnProjectLoadedScript() != onLoadScript ) {
+        return false;
+    }
+    QFileInfo info( cl.getScriptFilename() );
+    if ( !info.exists() || ( info.canonicalFilePath() != path ) ) {
+        return false;
+    }
+
+    return info.lastModified() == lastModified;
+}
+
+bool
+RenderServer::executeJob(const QStringList& arguments,
+                         QString* errorMessage)
+{
+    AppInstancePtr app = _imp->app.lock();
+
+    if (!app) {
+        *errorMessage = tr("The render server application instance is no longer available.");
+
+        return false;
+    }
+
+    ++_imp->nJobs;
+
+    // CLArgs expects the program name as first argument
+    QStringList args = arguments;
+    args.push_front( QCoreApplication::applicationFilePath() );
+
+    CLArgs cl(args, true);
+    if ( cl.getError() ) {
+        *errorMessage = tr("Invalid arguments: %1").arg( arguments.join( QString::fromUtf8(" ") ) );
+
+        return false;
+    }
+    if ( cl.isInterpreterMode() || cl.isRenderServerMode() ) {
+        *errorMessage = tr("The interpreter and render server modes cannot be used for a render server job.");
+
+        return false;
+    }
+
+    TimeLapse jobTimer;
+    bool reuseProject = _imp->loadedProject.canBeReusedBy(cl);
+    try {
+        if (!reuseProject) {
+            if ( !_imp->loadedProject.path.isEmpty() || _imp->loadedProject.dirty ) {
+                app->resetProject();
+            }
+            _imp->loadedProject.clear();
+
+            app->executeCommandLinePythonCommands(cl);
+            app->loadProjectFromCommandLine(cl);
+
+            QFileInfo info( cl.getScriptFilename() );
+            _imp->loadedProject.path = info.canonicalFilePath();
+            _imp->loadedProject.onLoadScript = cl.getDefaultOnProjectLoadedScript();
+            _imp->loadedProject.lastModified = info.lastModified();
+        }
+
+        // Mark the project dirty before rendering so that a failing job is never reused
+        _imp->loadedProject.dirty = RenderServerLoadedProject::jobModifiesProject(cl);
+        double loadTime = jobTimer.getTimeElapsedReset();
+
+        app->renderFromCommandLine(cl);
+
+        std::cout << tr("Render server: job %1 finished in %2s (project %3 in %4s)")
+            .arg(_imp->nJobs)
+            .arg( jobTimer.getTimeSinceCreation() )
+            .arg( reuseProject ? tr("reused") : tr("loaded") )
+            .arg(loadTime).toStdString() << std::endl;
+    } catch (const std::exception& e) {
+        // Do not trust the state of the project after a failure
+        _imp->loadedProject.dirty = true;
+        *errorMessage = QString::fromUtf8( e.what() );
+        std::cerr << tr("Render server: job %1 failed: %2").arg(_imp->nJobs).arg(*errorMessage).toStdString() << std::endl;
+
+        return false;
+    }
+
+    return true;
+} // RenderServer::executeJob
+
+NATRON_NAMESPACE_EXIT
+
+NATRON_NAMESPACE_USING
+#include "moc_RenderServer.cpp"
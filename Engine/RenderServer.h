@@ -0,0 +1,144 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef Engine_RenderServer_h
+#define Engine_RenderServer_h
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+CLANG_DIAG_OFF(deprecated)
+#include <QtCore/QDateTime>
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+CLANG_DIAG_ON(deprecated)
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/scoped_ptr.hpp>
+#endif
+
+#include "Global/GlobalDefines.h"
+
+#include "Engine/EngineFwd.h"
+
+NATRON_NAMESPACE_ENTER
+
+/**
+ * @brief Describes the project loaded by the previous job of a RenderServer.
+ **/
+struct RenderServerLoadedProject
+{
+    QString path; // canonical path of the project file, empty if no project is loaded
+    QString onLoadScript;
+    QDateTime lastModified;
+    bool dirty; // true if the previous job modified the project
+
+    RenderServerLoadedProject()
+        : path()
+        , onLoadScript()
+        , lastModified()
+        , dirty(false)
+    {
+    }
+
+    void clear()
+    {
+        path.clear();
+        onLoadScript.clear();
+        lastModified = QDateTime();
+        dirty = false;
+    }
+
+    /**
+     * @brief Returns true if the job may render the loaded project as-is: it targets the same unchanged file
+     * with the same on project loaded script, and neither the previous job nor this one modifies the project.
+     **/
+    bool canBeReusedBy(const CLArgs& cl) const;
+
+    /**
+     * @brief Returns true if the job changes the project it renders, which must then be reloaded for the next job.
+     **/
+    static bool jobModifiesProject(const CLArgs& cl);
+};
+
+/**
+ * @brief A persistent render server used by NatronRenderer --render-server <name>.
+ * The AppManager is loaded only once: OpenFX plug-in binaries, the RAM/disk caches and the
+ * Python interpreter stay warm between jobs. Jobs are received on a local socket (a named pipe on Windows).
+ *
+ * Protocol: each message is exactly 1 line, i.e a string terminated with the \n character.
+ * - A job is a line containing the command-line arguments that would be given to NatronRenderer
+ *   (without the program name), separated by tab characters, e.g:
+ *   -w<TAB>Write1<TAB>1-10<TAB>/path/to/project.ntp
+ * - kRenderServerQuit stops the server once the current job is finished.
+ *
+ * The server answers each job with kRenderServerJobDone or kRenderServerJobError followed by the error message.
+ *
+ * Jobs are rendered one at a time on the main thread, in the order they were received.
+ * If a job targets the project that was loaded by the previous job, the project is reused as-is
+ * unless the file changed on disk or the previous job modified it (Python commands, reader/writer
+ * overrides, Python scripts), in which case it is reloaded. A job with Python commands always reloads
+ * the project, since the commands must run before the project is loaded.
+ **/
+struct RenderServerPrivate;
+class RenderServer
+    : public QObject
+{
+GCC_DIAG_SUGGEST_OVERRIDE_OFF
+    Q_OBJECT
+GCC_DIAG_SUGGEST_OVERRIDE_ON
+
+public:
+
+    RenderServer(const AppInstancePtr& app);
+
+    virtual ~RenderServer();
+
+    /**
+     * @brief Starts listening on the given server name. Returns false if the server could not be started.
+     **/
+    bool listen(const QString& serverName);
+
+    /**
+     * @brief Executes one job, as described in the class documentation. Returns true on success, otherwise
+     * the error is returned in errorMessage.
+     **/
+    bool executeJob(const QStringList& arguments, QString* errorMessage);
+
+public Q_SLOTS:
+
+    void onNewConnectionPending();
+
+    void onClientDataReceived();
+
+    void onClientDisconnected();
+
+private:
+
+    boost::scoped_ptr<RenderServerPrivate> _imp;
+};
+
+NATRON_NAMESPACE_EXIT
+
+#endif // Engine_RenderServer_h
@@ -24,12 +24,17 @@
 
 #include "RenderStats.h"
 
+#include <algorithm> // max
 #include <bitset>
 #include <cassert>
 #include <stdexcept>
+#include <iomanip>
 
 #include <QtCore/QMutex>
+#include <QtCore/QThread>
 
+#include "Engine/AppManager.h"
+#include "Engine/MemoryGovernor.h"
 #include "Engine/Node.h"
 #include "Engine/Timer.h"
 #include "Engine/RectI.h"
@@ -314,12 +319,20 @@ struct RenderStatsPrivate
     typedef std::map<NodeWPtr, NodeRenderStats > NodeInfosMap;
     NodeInfosMap nodeInfos;
 
+    //The timeline of actions, only recorded when doNodesProfiling is true
+    RenderTraceEventList traceEvents;
+
+    //The state of the memory governor when the render started
+    MemoryGovernorStatus memoryStatus;
+
 
     RenderStatsPrivate()
         : lock()
         , totalTimeSpentForFrameTimer()
         , doNodesProfiling(false)
         , nodeInfos()
+        , traceEvents()
+        , memoryStatus()
     {
     }
 
@@ -355,6 +368,9 @@ RenderStats::RenderStats(bool enableInDepthProfiling)
     : _imp( new RenderStatsPrivate() )
 {
     _imp->doNodesProfiling = enableInDepthProfiling;
+    if (appPTR) {
+        _imp->memoryStatus = appPTR->getMemoryGovernorStatus();
+    }
 }
 
 RenderStats::~RenderStats()
@@ -453,4 +469,149 @@ RenderStats::getStats(double *totalTimeSpent) const
     return ret;
 }
 
+MemoryGovernorStatus
+RenderStats::getMemoryGovernorStatus() const
+{
+    // Set once in the constructor, no need to lock
+    return _imp->memoryStatus;
+}
+
+double
+RenderStats::getTraceTimestamp()
+{
+    timeval now;
+
+    gettimeofday(&now, 0);
+
+    return (double)now.tv_sec * 1e6 + (double)now.tv_usec;
+}
+
+void
+RenderStats::addTraceEvent(const NodePtr& node,
+                           const char* action,
+                           double time,
+                           double startUs,
+                           double endUs)
+{
+    assert(_imp->doNodesProfiling);
+
+    RenderTraceEvent e;
+    if (node) {
+        e.nodeName = node->getScriptName_mt_safe();
+    }
+    e.action = action;
+    e.startUs = startUs;
+    e.durationUs = std::max(0., endUs - startUs);
+    e.threadID = (unsigned long long)(quintptr)QThread::currentThreadId();
+    e.frame = (int)time;
+
+    QMutexLocker k(&_imp->lock);
+    _imp->traceEvents.push_back(e);
+}
+
+RenderTraceEventList
+RenderStats::getTraceEvents() const
+{
+    QMutexLocker k(&_imp->lock);
+
+    return _imp->traceEvents;
+}
+
+static void
+writeJSONString(const std::string& str,
+                std::ostream& os)
+{
+    os << '"';
+    for (std::size_t i = 0; i < str.size(); ++i) {
+        char c = str[i];
+        switch (c) {
+        case '"':
+            os << "\\\"";
+            break;
+        case '\\':
+            os << "\\\\";
+            break;
+        case '\n':
+            os << "\\n";
+            break;
+        case '\t':
+            os << "\\t";
+            break;
+        default:
+            if ( (unsigned char)c < 0x20 ) {
+                os << ' ';
+            } else {
+                os << c;
+            }
+            break;
+        }
+    }
+    os << '"';
+}
+
+void
+RenderStats::writeChromeTrace(const RenderTraceEventList& events,
+                              std::ostream& os)
+{
+    // Map the native thread IDs to small integers so that the timeline is readable
+    std::map<unsigned long long, int> threadIndexes;
+    double origin = 0;
+
+    for (RenderTraceEventList::const_iterator it = events.begin(); it != events.end(); ++it) {
+        threadIndexes.insert( std::make_pair( it->threadID, (int)threadIndexes.size() ) );
+        if ( (it == events.begin()) || (it->startUs < origin) ) {
+            origin = it->startUs;
+        }
+    }
+
+    os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    os << std::fixed << std::setprecision(3);
+    bool first = true;
+    for (std::map<unsigned long long, int>::const_iterator it = threadIndexes.begin(); it != threadIndexes.end(); ++it) {
+        os << (first ? "\n" : ",\n");
+        first = false;
+        os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << it->second
+           << ",\"args\":{\"name\":\"Thread " << it->second << "\"}}";
+    }
+    for (RenderTraceEventList::const_iterator it = events.begin(); it != events.end(); ++it) {
+        os << (first ? "\n" : ",\n");
+        first = false;
+        os << "{\"name\":";
+        writeJSONString(it->nodeName.empty() ? it->action : it->nodeName + ' ' + it->action, os);
+        os << ",\"cat\":";
+        writeJSONString(it->action, os);
+        os << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << threadIndexes[it->threadID]
+           << ",\"ts\":" << it->startUs - origin
+           << ",\"dur\":" << it->durationUs
+           << ",\"args\":{\"node\":";
+        writeJSONString(it->nodeName, os);
+        os << ",\"frame\":" << it->frame << "}}";
+    }
+    os << "\n]}" << std::endl;
+} // RenderStats::writeChromeTrace
+
+RenderStatsTraceScope::RenderStatsTraceScope(const RenderStatsPtr& stats,
+                                             const NodePtr& node,
+                                             const char* action,
+                                             double time)
+    : _stats()
+    , _node()
+    , _action(action)
+    , _time(time)
+    , _startUs(0)
+{
+    if ( stats && stats->isInDepthProfilingEnabled() ) {
+        _stats = stats;
+        _node = node;
+        _startUs = RenderStats::getTraceTimestamp();
+    }
+}
+
+RenderStatsTraceScope::~RenderStatsTraceScope()
+{
+    if (_stats) {
+        _stats->addTraceEvent( _node, _action, _time, _startUs, RenderStats::getTraceTimestamp() );
+    }
+}
+
 NATRON_NAMESPACE_EXIT
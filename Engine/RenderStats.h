@@ -27,11 +27,13 @@
 
 #include "Global/Macros.h"
 
+#include <deque>
 #include <list>
 #include <map>
 #include <set>
 #include <string>
 #include <bitset>
+#include <ostream>
 
 #if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
 #include <boost/shared_ptr.hpp>
@@ -104,8 +106,38 @@ private:
     boost::scoped_ptr<NodeRenderStatsPrivate> _imp;
 };
 
+/**
+ * @brief One record of the render timeline: an action of a node, executed on a given thread.
+ * Timestamps are wall-clock times in microseconds, see RenderStats::getTraceTimestamp().
+ **/
+struct RenderTraceEvent
+{
+    std::string nodeName;
+    std::string action;
+    double startUs;
+    double durationUs;
+    unsigned long long threadID;
+    int frame;
+
+    RenderTraceEvent()
+        : nodeName()
+        , action()
+        , startUs(0)
+        , durationUs(0)
+        , threadID(0)
+        , frame(0)
+    {
+    }
+};
+
+// A deque: the oldest events are dropped when too many are accumulated
+typedef std::deque<RenderTraceEvent> RenderTraceEventList;
+
 /**
  * @brief Holds render infos for all nodes in a compositing tree for a frame.
+ * When in-depth profiling is enabled, a timeline of the actions called on each node
+ * (see RenderStatsTraceScope) is also recorded and can be exported to the Chrome Trace Event format.
+ * The state of the memory governor is recorded when the object is created.
  **/
 struct RenderStatsPrivate;
 class RenderStats
@@ -144,11 +176,59 @@ public:
 
     std::map<NodePtr, NodeRenderStats > getStats(double *totalTimeSpent) const;
 
+    /**
+     * @brief Returns the state of the memory governor when the render of the frame started.
+     **/
+    MemoryGovernorStatus getMemoryGovernorStatus() const;
+
+    /**
+     * @brief Returns the current wall-clock time in microseconds, used to timestamp trace events.
+     **/
+    static double getTraceTimestamp();
+
+    /**
+     * @brief Records that the given action of the node ran on the current thread between startUs and endUs.
+     **/
+    void addTraceEvent(const NodePtr& node,
+                       const char* action,
+                       double time,
+                       double startUs,
+                       double endUs);
+
+    RenderTraceEventList getTraceEvents() const;
+
+    /**
+     * @brief Writes the given events as a Chrome Trace Event JSON document, which can be loaded
+     * in chrome://tracing or https://ui.perfetto.dev
+     **/
+    static void writeChromeTrace(const RenderTraceEventList& events, std::ostream& os);
+
 private:
 
     boost::scoped_ptr<RenderStatsPrivate> _imp;
 };
 
+/**
+ * @brief Records a trace event spanning the lifetime of this object if stats is set and in-depth profiling is enabled.
+ **/
+class RenderStatsTraceScope
+{
+    RenderStatsPtr _stats;
+    NodePtr _node;
+    const char* _action;
+    double _time;
+    double _startUs;
+
+public:
+
+    RenderStatsTraceScope(const RenderStatsPtr& stats,
+                          const NodePtr& node,
+                          const char* action,
+                          double time);
+
+    ~RenderStatsTraceScope();
+};
+
 NATRON_NAMESPACE_EXIT
 
 
@@ -0,0 +1,361 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "RenderTaskScheduler.h"
+
+#include <algorithm> // std::sort, std::max
+#include <vector>
+
+#include <QtCore/QMutex>
+#include <QtCore/QWaitCondition>
+#include <QtCore/QThreadPool>
+#include <QtCore/QThreadStorage>
+#include <QtCore/QCoreApplication>
+
+#include "Engine/Node.h"
+#include "Engine/ParallelRenderArgs.h"
+#include "Engine/RenderAbortToken.h"
+#include "Engine/Timer.h"
+
+// A tile waits at most this long to start when no tile is running, since no tile end can then wake it up
+#define NATRON_RENDER_TASK_MAX_WAIT_SECONDS 1.
+
+// Waiting tiles check whether their render was aborted at this interval
+#define NATRON_RENDER_TASK_WAIT_SLICE_MS 10
+
+// Number of recent interactive renders used to compute the latency percentiles
+#define NATRON_RENDER_TASK_N_LATENCY_SAMPLES 256
+
+NATRON_NAMESPACE_ENTER
+
+namespace {
+
+struct RenderTaskSchedulerState
+{
+    QMutex lock;
+
+    // Woken up whenever a tile ends or stops waiting
+    QWaitCondition tileFinished;
+    RenderTaskSlots slots;
+    RenderTaskSchedulerStatistics stats;
+    double totalInteractiveLatency;
+
+    // Circular buffer of the latencies of the most recent interactive renders
+    std::vector<double> recentLatencies;
+    std::size_t nextLatencyIndex;
+
+    // Number of nested tiles of each thread
+    QThreadStorage<int> tileDepth;
+
+    RenderTaskSchedulerState()
+        : lock()
+        , tileFinished()
+        , slots()
+        , stats()
+        , totalInteractiveLatency(0)
+        , recentLatencies()
+        , nextLatencyIndex(0)
+        , tileDepth()
+    {
+    }
+};
+
+// Never destroyed: render threads may still exit after static destructors ran
+RenderTaskSchedulerState* gScheduler = new RenderTaskSchedulerState;
+
+const char* const gClassNames[eRenderTaskClassCount] = {
+    QT_TRANSLATE_NOOP("RenderTaskScheduler", "Interactive"),
+    QT_TRANSLATE_NOOP("RenderTaskScheduler", "Playback"),
+    QT_TRANSLATE_NOOP("RenderTaskScheduler", "Analysis"),
+    QT_TRANSLATE_NOOP("RenderTaskScheduler", "Preview"),
+    QT_TRANSLATE_NOOP("RenderTaskScheduler", "Background"),
+};
+
+bool
+isCurrentRenderAborted()
+{
+    bool aborted = false;
+
+    return RenderAbortToken::isCurrentThreadAborted(&aborted) && aborted;
+}
+
+} // anon namespace
+
+RenderTaskSlots::RenderTaskSlots()
+    : prioritiesEnabled(false)
+    , nWaitingForPendingImages(0)
+{
+    for (int i = 0; i < eRenderTaskClassCount; ++i) {
+        maxThreads[i] = 0;
+        nRunning[i] = 0;
+        nWaiting[i] = 0;
+    }
+}
+
+bool
+RenderTaskSlots::isAtThreadCap(int taskClass) const
+{
+    return maxThreads[taskClass] > 0 && nRunning[taskClass] >= maxThreads[taskClass];
+}
+
+bool
+RenderTaskSlots::mustWait(int taskClass) const
+{
+    // The tiles waiting for their turn may be producing the images that the render waits for
+    if (nWaitingForPendingImages > 0) {
+        return false;
+    }
+    if ( isAtThreadCap(taskClass) ) {
+        return true;
+    }
+    if (prioritiesEnabled) {
+        // A higher class that reached its thread cap cannot use more threads, do not wait for it
+        for (int c = 0; c < taskClass; ++c) {
+            if ( ( (nRunning[c] > 0) || (nWaiting[c] > 0) ) && !isAtThreadCap(c) ) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+bool
+RenderTaskSlots::hasRunningTiles() const
+{
+    for (int i = 0; i < eRenderTaskClassCount; ++i) {
+        if (nRunning[i] > 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+RenderTaskClassEnum
+RenderTaskScheduler::getRenderTaskClass(const ParallelRenderArgs& frameArgs)
+{
+    if (frameArgs.isAnalysis) {
+        return eRenderTaskClassAnalysis;
+    }
+    const NodePtr& treeRoot = frameArgs.treeRoot;
+    if (treeRoot) {
+        if ( treeRoot->isRenderingPreview() ) {
+            return eRenderTaskClassPreview;
+        }
+        if ( treeRoot->isEffectViewer() ) {
+            if (frameArgs.isRenderResponseToUserInteraction) {
+                return eRenderTaskClassInteractive;
+            }
+
+            // Frames rendered in advance around the current frame only use spare CPUs
+            return frameArgs.isSpeculativeRender ? eRenderTaskClassBackground : eRenderTaskClassPlayback;
+        }
+    }
+
+    return eRenderTaskClassBackground;
+}
+
+void
+RenderTaskScheduler::setPrioritiesEnabled(bool enabled)
+{
+    QMutexLocker k(&gScheduler->lock);
+
+    gScheduler->slots.prioritiesEnabled = enabled;
+    gScheduler->tileFinished.wakeAll();
+}
+
+void
+RenderTaskScheduler::setMaxThreads(RenderTaskClassEnum taskClass,
+                                   int maxThreads)
+{
+    assert(taskClass >= 0 && taskClass < eRenderTaskClassCount);
+    QMutexLocker k(&gScheduler->lock);
+
+    gScheduler->slots.maxThreads[taskClass] = std::max(0, maxThreads);
+    gScheduler->tileFinished.wakeAll();
+}
+
+void
+RenderTaskScheduler::reportInteractiveLatency(double seconds)
+{
+    QMutexLocker k(&gScheduler->lock);
+    RenderTaskSchedulerStatistics& stats = gScheduler->stats;
+
+    ++stats.nInteractiveRenders;
+    gScheduler->totalInteractiveLatency += seconds;
+    stats.maxInteractiveLatency = std::max(stats.maxInteractiveLatency, seconds);
+    if (gScheduler->recentLatencies.size() < NATRON_RENDER_TASK_N_LATENCY_SAMPLES) {
+        gScheduler->recentLatencies.push_back(seconds);
+    } else {
+        gScheduler->recentLatencies[gScheduler->nextLatencyIndex] = seconds;
+    }
+    gScheduler->nextLatencyIndex = (gScheduler->nextLatencyIndex + 1) % NATRON_RENDER_TASK_N_LATENCY_SAMPLES;
+}
+
+RenderTaskSchedulerStatistics
+RenderTaskScheduler::getStatistics()
+{
+    std::vector<double> latencies;
+    RenderTaskSchedulerStatistics ret;
+    {
+        QMutexLocker k(&gScheduler->lock);
+        ret = gScheduler->stats;
+        latencies = gScheduler->recentLatencies;
+        if (ret.nInteractiveRenders > 0) {
+            ret.meanInteractiveLatency = gScheduler->totalInteractiveLatency / ret.nInteractiveRenders;
+        }
+    }
+    if ( !latencies.empty() ) {
+        std::sort( latencies.begin(), latencies.end() );
+        ret.medianInteractiveLatency = latencies[latencies.size() / 2];
+        ret.p95InteractiveLatency = latencies[(latencies.size() * 95) / 100];
+    }
+
+    return ret;
+}
+
+QString
+RenderTaskScheduler::printStatistics(const RenderTaskSchedulerStatistics& stats)
+{
+    QString ret = QCoreApplication::translate("RenderTaskScheduler", "Render task scheduler: interactive renders latency: %1 renders, mean %2 ms, median %3 ms, 95th percentile %4 ms, max %5 ms")
+                  .arg(stats.nInteractiveRenders)
+                  .arg(stats.meanInteractiveLatency * 1000., 0, 'f', 1)
+                  .arg(stats.medianInteractiveLatency * 1000., 0, 'f', 1)
+                  .arg(stats.p95InteractiveLatency * 1000., 0, 'f', 1)
+                  .arg(stats.maxInteractiveLatency * 1000., 0, 'f', 1);
+
+    for (int i = 0; i < eRenderTaskClassCount; ++i) {
+        const RenderTaskClassStatistics& classStats = stats.classes[i];
+        if (classStats.nTiles == 0) {
+            continue;
+        }
+        ret += QLatin1Char('\n');
+        ret += QCoreApplication::translate("RenderTaskScheduler", "%1 renders: %2 tiles, %3 delayed, mean wait %4 ms, max wait %5 ms")
+               .arg( QCoreApplication::translate("RenderTaskScheduler", gClassNames[i]) )
+               .arg(classStats.nTiles)
+               .arg(classStats.nDelayedTiles)
+               .arg(classStats.totalWaitTime * 1000. / classStats.nTiles, 0, 'f', 2)
+               .arg(classStats.maxWaitTime * 1000., 0, 'f', 2);
+    }
+
+    return ret;
+}
+
+bool
+RenderTaskScheduler::isCurrentThreadInTile()
+{
+    return gScheduler->tileDepth.hasLocalData() && gScheduler->tileDepth.localData() > 0;
+}
+
+RenderTaskScheduler::PendingImageWaitScope::PendingImageWaitScope()
+{
+    QMutexLocker k(&gScheduler->lock);
+
+    ++gScheduler->slots.nWaitingForPendingImages;
+    gScheduler->tileFinished.wakeAll();
+}
+
+RenderTaskScheduler::PendingImageWaitScope::~PendingImageWaitScope()
+{
+    QMutexLocker k(&gScheduler->lock);
+
+    --gScheduler->slots.nWaitingForPendingImages;
+}
+
+RenderTaskScheduler::TileScope::TileScope(const ParallelRenderArgsPtr& frameArgs,
+                                          bool schedule)
+    : _taskClass(eRenderTaskClassBackground)
+    , _scheduled(false)
+{
+    int& depth = gScheduler->tileDepth.localData();
+    ++depth;
+    if ( (depth > 1) || !schedule ) {
+        // The thread already holds a running tile, or works for one
+        return;
+    }
+    _scheduled = true;
+    if (frameArgs) {
+        _taskClass = getRenderTaskClass(*frameArgs);
+    }
+
+    QMutexLocker k(&gScheduler->lock);
+    RenderTaskClassStatistics& stats = gScheduler->stats.classes[_taskClass];
+    ++stats.nTiles;
+    RenderTaskSlots& slots = gScheduler->slots;
+    if ( !slots.mustWait(_taskClass) ) {
+        ++slots.nRunning[_taskClass];
+
+        return;
+    }
+
+    ++slots.nWaiting[_taskClass];
+    ++stats.nDelayedTiles;
+    TimeLapse timer;
+    k.unlock();
+
+    // Let the thread-pool start another thread for the renders we are waiting for
+    QThreadPool::globalInstance()->releaseThread();
+
+    k.relock();
+    while ( slots.mustWait(_taskClass) ) {
+        // Block until a tile ends and frees a slot. Only when no tile is running can no tile end wake this thread up,
+        // in which case it does not wait forever
+        if ( !slots.hasRunningTiles() && (timer.getTimeSinceCreation() >= NATRON_RENDER_TASK_MAX_WAIT_SECONDS) ) {
+            break;
+        }
+        gScheduler->tileFinished.wait(&gScheduler->lock, NATRON_RENDER_TASK_WAIT_SLICE_MS);
+
+        // Do not hold the lock while checking the abort token, it may lock the render engine
+        k.unlock();
+        bool aborted = isCurrentRenderAborted();
+        k.relock();
+        if (aborted) {
+            break;
+        }
+    }
+    double waitTime = timer.getTimeSinceCreation();
+    --slots.nWaiting[_taskClass];
+    ++slots.nRunning[_taskClass];
+    stats.totalWaitTime += waitTime;
+    stats.maxWaitTime = std::max(stats.maxWaitTime, waitTime);
+    gScheduler->tileFinished.wakeAll();
+    k.unlock();
+
+    QThreadPool::globalInstance()->reserveThread();
+}
+
+RenderTaskScheduler::TileScope::~TileScope()
+{
+    --gScheduler->tileDepth.localData();
+    if (!_scheduled) {
+        return;
+    }
+
+    QMutexLocker k(&gScheduler->lock);
+    --gScheduler->slots.nRunning[_taskClass];
+    gScheduler->tileFinished.wakeAll();
+}
+
+NATRON_NAMESPACE_EXIT
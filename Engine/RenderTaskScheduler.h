@@ -0,0 +1,195 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef Engine_RenderTaskScheduler_h
+#define Engine_RenderTaskScheduler_h
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <QtCore/QString>
+
+#include "Global/GlobalDefines.h"
+#include "Global/Enums.h"
+#include "Engine/EngineFwd.h"
+
+NATRON_NAMESPACE_ENTER
+
+struct RenderTaskClassStatistics
+{
+    // Number of tiles rendered
+    U64 nTiles;
+
+    // Number of tiles that had to wait for renders of a higher class or for the thread cap of the class
+    U64 nDelayedTiles;
+
+    // Time spent by tiles waiting to start, in seconds
+    double totalWaitTime;
+    double maxWaitTime;
+
+    RenderTaskClassStatistics()
+        : nTiles(0)
+        , nDelayedTiles(0)
+        , totalWaitTime(0)
+        , maxWaitTime(0)
+    {
+    }
+};
+
+struct RenderTaskSchedulerStatistics
+{
+    RenderTaskClassStatistics classes[eRenderTaskClassCount];
+
+    // Time between the request of an interactive render and the production of its frame, in seconds
+    U64 nInteractiveRenders;
+    double meanInteractiveLatency;
+    double medianInteractiveLatency; // over the most recent renders
+    double p95InteractiveLatency; // over the most recent renders
+    double maxInteractiveLatency;
+
+    RenderTaskSchedulerStatistics()
+        : classes()
+        , nInteractiveRenders(0)
+        , meanInteractiveLatency(0)
+        , medianInteractiveLatency(0)
+        , p95InteractiveLatency(0)
+        , maxInteractiveLatency(0)
+    {
+    }
+};
+
+/**
+ * @brief Number of tiles of each render class running and waiting, and thread caps of the classes.
+ * This is the bookkeeping of the RenderTaskScheduler, which protects it with its lock: this class is not MT-safe.
+ **/
+struct RenderTaskSlots
+{
+    bool prioritiesEnabled;
+    int maxThreads[eRenderTaskClassCount];
+    int nRunning[eRenderTaskClassCount];
+    int nWaiting[eRenderTaskClassCount];
+
+    // Number of threads waiting for an image that another render is producing
+    int nWaitingForPendingImages;
+
+    RenderTaskSlots();
+
+    bool isAtThreadCap(int taskClass) const;
+
+    /**
+     * @brief Returns true if a tile of the given class cannot start now
+     **/
+    bool mustWait(int taskClass) const;
+
+    /**
+     * @brief Returns true if a tile of any class is running. Otherwise no tile end can free a slot for a waiting tile.
+     **/
+    bool hasRunningTiles() const;
+};
+
+/**
+ * @brief Gives the CPUs to the most urgent renders. Each render belongs to a class, by decreasing priority:
+ * interactive, playback, analysis, preview and background (see RenderTaskClassEnum). The class is determined from the
+ * ParallelRenderArgs of the render.
+ *
+ * Renders are scheduled at tile boundaries: before rendering a tile, a thread waits while renders of a higher class
+ * are rendering tiles or waiting to, or while its class has reached its thread cap. Waiting threads are handed back to
+ * the global thread-pool so that the renders of the higher class can use them.
+ * A waiting thread blocks until a tile ends and frees a slot, or until its render is aborted. The wait is only bounded
+ * when no tile is running at all: then no tile end can ever wake the thread up.
+ * Renders may depend on each other through the cache (a render waiting for an image that another render is producing).
+ * While a render waits for an image that another render is producing (see PendingImageWaitScope), no tile waits at
+ * all: the waiting tiles may be the ones producing it, and a higher priority render must not wait for a lower priority
+ * one that is paused.
+ * This class is MT-safe.
+ **/
+class RenderTaskScheduler
+{
+public:
+
+    /**
+     * @brief Returns the class of a render made with the given frame args
+     **/
+    static RenderTaskClassEnum getRenderTaskClass(const ParallelRenderArgs& frameArgs);
+
+    /**
+     * @brief When disabled, tiles never wait for renders of a higher class. Thread caps still apply.
+     **/
+    static void setPrioritiesEnabled(bool enabled);
+
+    /**
+     * @brief Sets the maximum number of threads rendering tiles of the given class at the same time, 0 meaning no limit
+     **/
+    static void setMaxThreads(RenderTaskClassEnum taskClass, int maxThreads);
+
+    /**
+     * @brief Records the time between the request of an interactive render and the production of its frame
+     **/
+    static void reportInteractiveLatency(double seconds);
+
+    static RenderTaskSchedulerStatistics getStatistics();
+
+    static QString printStatistics(const RenderTaskSchedulerStatistics& stats);
+
+    /**
+     * @brief Returns true if the current thread is rendering a tile
+     **/
+    static bool isCurrentThreadInTile();
+
+    /**
+     * @brief Declares that the current thread waits for an image that another render is producing, for the lifetime
+     * of the object. Meanwhile, the tiles waiting for their turn are let run.
+     **/
+    class PendingImageWaitScope
+    {
+    public:
+
+        PendingImageWaitScope();
+
+        ~PendingImageWaitScope();
+    };
+
+    /**
+     * @brief Waits if needed for a tile of the render with the given frame args to be allowed to run, and accounts it
+     * as running for its lifetime. Only the outermost tile of a thread is scheduled: tiles rendered recursively by a thread
+     * inside a tile (e.g identity tiles rendering their input) run right away, and so do tiles when schedule is false,
+     * which is used for the tiles that a thread rendering a tile spawns on other threads.
+     **/
+    class TileScope
+    {
+    public:
+
+        TileScope(const ParallelRenderArgsPtr& frameArgs, bool schedule = true);
+
+        ~TileScope();
+
+    private:
+
+        RenderTaskClassEnum _taskClass;
+        bool _scheduled;
+    };
+};
+
+NATRON_NAMESPACE_EXIT
+
+#endif // Engine_RenderTaskScheduler_h
@@ -1637,10 +1637,15 @@ RotoPaint::render(const RenderActionArgs& args)
             } else {
                 plane->second->pasteFrom(*(rotoImagesIt->second), args.roi, false);
             }
-            plane->second->copyUnProcessedChannels(args.roi, outputPremult, bgImg ? bgImg->getPremultiplication() : eImagePremultiplicationOpaque, copyChannels, bgImg, false);
-            if ( premultiply && ( plane->second->getComponents() == ImagePlaneDesc::getRGBAComponents() ) ) {
-                plane->second->premultImage(args.roi);
-            }
+            Image::PostRenderSteps steps;
+            steps.copyUnProcessedChannels = true;
+            steps.processChannels = copyChannels;
+            steps.outputPremult = outputPremult;
+            steps.originalImagePremult = bgImg ? bgImg->getPremultiplication() : eImagePremultiplicationOpaque;
+            steps.ignorePremult = false;
+            steps.originalImage = bgImg;
+            steps.premult = premultiply && ( plane->second->getComponents() == ImagePlaneDesc::getRGBAComponents() );
+            plane->second->applyPostRenderSteps(args.roi, steps);
         }
     } // RenderingFlagSetter
 
@@ -42,16 +42,19 @@
 
 #include "Engine/AppManager.h"
 #include "Engine/AppInstance.h"
+#include "Engine/ImageBufferPool.h"
 #include "Engine/KnobFactory.h"
 #include "Engine/KnobFile.h"
 #include "Engine/KnobTypes.h"
 #include "Engine/LibraryBinary.h"
 #include "Engine/MemoryInfo.h" // getSystemTotalRAM, isApplication32Bits, printAsRAM
 #include "Engine/Node.h"
+#include "Engine/NumaPlacement.h"
 #include "Engine/OSGLContext.h"
 #include "Engine/OutputSchedulerThread.h"
 #include "Engine/Plugin.h"
 #include "Engine/Project.h"
+#include "Engine/RenderTaskScheduler.h"
 #include "Engine/StandardPaths.h"
 #include "Engine/Utils.h"
 #include "Engine/ViewIdx.h"
@@ -314,6 +317,15 @@ Settings::initializeKnobsThreading()
                                        "make sure to uncheck this option first otherwise it will crash %1.").arg( QString::fromUtf8(NATRON_APPLICATION_NAME) ) );
     _threadingPage->addKnob(_useThreadPool);
 
+    _numaAwareRendering = AppManager::createKnob<KnobBool>( this, tr("NUMA-aware rendering") );
+    _numaAwareRendering->setName("numaAwareRendering");
+    _numaAwareRendering->setHintToolTip( tr("When checked on a computer with several NUMA nodes (multi-socket workstations), "
+                                            "the frames are distributed across the nodes in turn and all the threads rendering "
+                                            "a frame are pinned to the CPUs of the same node, with the images they allocate placed "
+                                            "in that node's memory. This avoids slow cross-node memory accesses. "
+                                            "This is only supported on Linux and has no effect on computers with a single node.") );
+    _threadingPage->addKnob(_numaAwareRendering);
+
     _nThreadsPerEffect = AppManager::createKnob<KnobInt>( this, tr("Max threads usable per effect (0=\"guess\")") );
     _nThreadsPerEffect->setName("nThreadsPerEffect");
     _nThreadsPerEffect->setHintToolTip( tr("Controls how many threads a specific effect can use at most to do its processing. "
@@ -326,6 +338,37 @@ Settings::initializeKnobsThreading()
     _nThreadsPerEffect->disableSlider();
     _threadingPage->addKnob(_nThreadsPerEffect);
 
+    _prioritizeRenders = AppManager::createKnob<KnobBool>( this, tr("Prioritize interactive renders") );
+    _prioritizeRenders->setName("prioritizeRenders");
+    _prioritizeRenders->setHintToolTip( tr("When checked, renders are given the CPUs by order of priority: the viewer render of the current frame "
+                                           "(e.g. after a parameter change) first, then viewer playback, analysis (e.g. tracking), "
+                                           "node graph previews and finally renders to disk. Renders of a lower priority pause between "
+                                           "two tiles while renders of a higher priority are running, unless a render waits for an image "
+                                           "that a paused render is producing.") );
+    _threadingPage->addKnob(_prioritizeRenders);
+
+    {
+        const char* names[eRenderTaskClassCount] = {
+            "maxThreadsInteractiveRenders", "maxThreadsPlaybackRenders", "maxThreadsAnalysisRenders", "maxThreadsPreviewRenders", "maxThreadsBackgroundRenders"
+        };
+        QString labels[eRenderTaskClassCount] = {
+            tr("Max threads for interactive renders (0=\"no limit\")"),
+            tr("Max threads for playback renders (0=\"no limit\")"),
+            tr("Max threads for analysis renders (0=\"no limit\")"),
+            tr("Max threads for previews (0=\"no limit\")"),
+            tr("Max threads for background renders (0=\"no limit\")")
+        };
+        for (int i = 0; i < eRenderTaskClassCount; ++i) {
+            _renderClassMaxThreads[i] = AppManager::createKnob<KnobInt>(this, labels[i]);
+            _renderClassMaxThreads[i]->setName(names[i]);
+            _renderClassMaxThreads[i]->setHintToolTip( tr("Controls how many threads can render tiles for this kind of render at the same time. "
+                                                          "Limiting the renders to disk or the previews leaves CPUs to the viewer while working.") );
+            _renderClassMaxThreads[i]->setMinimum(0);
+            _renderClassMaxThreads[i]->disableSlider();
+            _threadingPage->addKnob(_renderClassMaxThreads[i]);
+        }
+    }
+
     _renderInSeparateProcess = AppManager::createKnob<KnobBool>( this, tr("Render in a separate process") );
     _renderInSeparateProcess->setName("renderNewProcess");
     _renderInSeparateProcess->setHintToolTip( tr("If true, %1 will render frames to disk in "
@@ -1113,6 +1156,48 @@ Settings::initializeKnobsViewers()
 
     _viewersTab->addKnob(_autoProxyLevel);
 
+    _adaptivePlaybackResolution = AppManager::createKnob<KnobBool>( this, tr("Adaptive resolution during playback") );
+    _adaptivePlaybackResolution->setName("adaptivePlaybackResolution");
+    _adaptivePlaybackResolution->setHintToolTip( tr("When checked, the time spent to render each frame is measured during playback "
+                                                    "and the resolution of the viewer is lowered as needed to reach the "
+                                                    "frame rate set in the viewer. The resolution is raised again when frames render "
+                                                    "fast enough, and the full resolution image is rendered when playback stops.") );
+    _adaptivePlaybackResolution->setAddNewLine(false);
+    _viewersTab->addKnob(_adaptivePlaybackResolution);
+
+    _adaptivePlaybackMaxLevel = AppManager::createKnob<KnobChoice>( this, tr("Max. playback downscale") );
+    _adaptivePlaybackMaxLevel->setName("adaptivePlaybackMaxLevel");
+    _adaptivePlaybackMaxLevel->setHintToolTip( tr("The maximum factor by which the resolution may be lowered during playback "
+                                                  "when adaptive resolution is enabled.") );
+    _adaptivePlaybackMaxLevel->populateChoices(autoProxyChoices);
+    _viewersTab->addKnob(_adaptivePlaybackMaxLevel);
+
+    _adaptivePlaybackDraft = AppManager::createKnob<KnobBool>( this, tr("Draft render when playback resolution is lowered") );
+    _adaptivePlaybackDraft->setName("adaptivePlaybackDraft");
+    _adaptivePlaybackDraft->setHintToolTip( tr("When checked, frames rendered at a lowered resolution during playback "
+                                               "are also rendered in draft mode, which lets plug-ins that support it "
+                                               "use faster, lower quality algorithms.") );
+    _viewersTab->addKnob(_adaptivePlaybackDraft);
+
+    _speculativeRendering = AppManager::createKnob<KnobBool>( this, tr("Render neighbour frames when idle") );
+    _speculativeRendering->setName("speculativeRendering");
+    _speculativeRendering->setHintToolTip( tr("When checked, once the current frame is displayed and the viewer is idle, the frames "
+                                              "around the current time are rendered in the background at the current zoom level "
+                                              "and stored in the viewer cache, favouring the direction in which the timeline "
+                                              "was last scrubbed. Scrubbing over these frames then does not need to render them. "
+                                              "These renders are aborted as soon as the viewer needs to render something else.") );
+    _speculativeRendering->setAddNewLine(false);
+    _viewersTab->addKnob(_speculativeRendering);
+
+    _speculativeRenderingFrames = AppManager::createKnob<KnobInt>( this, tr("Frames") );
+    _speculativeRenderingFrames->setName("speculativeRenderingFrames");
+    _speculativeRenderingFrames->setHintToolTip( tr("How many frames are rendered in advance in the direction of scrubbing when "
+                                                    "rendering neighbour frames. Half as many are rendered in the other direction.") );
+    _speculativeRenderingFrames->setMinimum(1);
+    _speculativeRenderingFrames->setMaximum(100);
+    _speculativeRenderingFrames->disableSlider();
+    _viewersTab->addKnob(_speculativeRenderingFrames);
+
     _maximumNodeViewerUIOpened = AppManager::createKnob<KnobInt>( this, tr("Max. opened node viewer interface") );
     _maximumNodeViewerUIOpened->setName("maxNodeUiOpened");
     _maximumNodeViewerUIOpened->setMinimum(1);
@@ -1266,6 +1351,59 @@ Settings::initializeKnobsCaching()
     _maxDiskCacheNodeGB->setHintToolTip( tr("The maximum size that may be used by the DiskCache node on disk (in GiB)") );
     _cachingTab->addKnob(_maxDiskCacheNodeGB);
 
+    _cacheEvictionPolicy = AppManager::createKnob<KnobChoice>( this, tr("Cache eviction policy") );
+    _cacheEvictionPolicy->setName("cacheEvictionPolicy");
+    {
+        std::vector<ChoiceOption> entries;
+        assert(entries.size() == (int)eCacheEvictionPolicyLRU);
+        entries.push_back(ChoiceOption("lru",
+                                       tr("Least Recently Used").toStdString(),
+                                       tr("The images that were not used for the longest time are removed first.").toStdString()));
+        assert(entries.size() == (int)eCacheEvictionPolicyCostAware);
+        entries.push_back(ChoiceOption("costaware",
+                                       tr("Cost-Aware").toStdString(),
+                                       tr("The images that were fastest to render relative to their size are removed first, so that "
+                                          "expensive results are kept longer than cheap ones (GreedyDual-Size).").toStdString()));
+        _cacheEvictionPolicy->populateChoices(entries);
+    }
+    _cacheEvictionPolicy->setHintToolTip( tr("Selects which images are removed from the RAM and DiskCache node caches when they are full. "
+                                             "The hit ratio and the render time saved by the cache with the previous policy are written "
+                                             "to the error log when this is changed, and printed on exit by %1.").arg( QString::fromUtf8(NATRON_APPLICATION_NAME "Renderer") ) );
+    _cachingTab->addKnob(_cacheEvictionPolicy);
+
+    _useHugePages = AppManager::createKnob<KnobBool>( this, tr("Use huge pages for large images") );
+    _useHugePages->setName("useHugePages");
+    _useHugePages->setHintToolTip( tr("When checked, the memory of large images is backed by huge pages, which speeds up "
+                                      "the processing of large images. Huge pages reserved by the system administrator are "
+                                      "used if available, transparent huge pages otherwise. This is only supported on Linux "
+                                      "and applies to images allocated after the change.") );
+    _cachingTab->addKnob(_useHugePages);
+
+    _halfCacheStorage = AppManager::createKnob<KnobBool>( this, tr("Store cached images as half floats") );
+    _halfCacheStorage->setName("halfFloatCacheStorage");
+    _halfCacheStorage->setHintToolTip( tr("When checked, the floating point images kept in the RAM cache are converted to "
+                                          "16-bit half floats when the cache is full, before any image is removed from it. "
+                                          "This halves their memory footprint so that more frames fit in the cache, and they "
+                                          "are converted back when used again. Only the color plane is converted, and only if "
+                                          "no value changes by more than the \"Half float maximum error\": images with larger "
+                                          "errors or values out of the half float range, as well as motion vectors, disparity "
+                                          "and depth, are kept in full precision. "
+                                          "This can be overridden for each node in its Node tab.") );
+    _cachingTab->addKnob(_halfCacheStorage);
+
+    _halfCacheStorageMaxError = AppManager::createKnob<KnobDouble>( this, tr("Half float maximum error") );
+    _halfCacheStorageMaxError->setName("halfFloatCacheStorageMaxError");
+    _halfCacheStorageMaxError->setMinimum(0.);
+    _halfCacheStorageMaxError->setDisplayMinimum(0.);
+    _halfCacheStorageMaxError->setDisplayMaximum(0.01);
+    _halfCacheStorageMaxError->setHintToolTip( tr("The largest change of a value allowed when an image is stored as half floats, "
+                                                  "where 1 is the nominal range of a color channel. A half float keeps 11 "
+                                                  "significant bits, so the error grows with the values: the default, 0.001, "
+                                                  "accepts every image whose values are below 4, and the images with brighter "
+                                                  "values only if they happen to convert precisely enough. "
+                                                  "At 0, only the images that convert exactly are stored as half floats.") );
+    _cachingTab->addKnob(_halfCacheStorageMaxError);
+
 
     _diskCachePath = AppManager::createKnob<KnobPath>( this, tr("Disk cache path (empty = default)") );
     _diskCachePath->setName("diskCachePath");
@@ -1445,7 +1583,12 @@ Settings::setDefaultValues()
     _numberOfParallelRenders->setDefaultValue(0, 0);
 #endif
     _useThreadPool->setDefaultValue(true);
+    _numaAwareRendering->setDefaultValue(false);
     _nThreadsPerEffect->setDefaultValue(0);
+    _prioritizeRenders->setDefaultValue(false);
+    for (int i = 0; i < eRenderTaskClassCount; ++i) {
+        _renderClassMaxThreads[i]->setDefaultValue(0);
+    }
     _renderInSeparateProcess->setDefaultValue(false, 0);
     _queueRenders->setDefaultValue(false);
 
@@ -1500,6 +1643,10 @@ Settings::setDefaultValues()
     _unreachableRAMPercent->setDefaultValue(5);
     _maxViewerDiskCacheGB->setDefaultValue(5, 0);
     _maxDiskCacheNodeGB->setDefaultValue(10, 0);
+    _cacheEvictionPolicy->setDefaultValue(0);
+    _useHugePages->setDefaultValue(false);
+    _halfCacheStorage->setDefaultValue(false);
+    _halfCacheStorageMaxError->setDefaultValue(0.001);
     //_diskCachePath
     setCachingLabels();
 
@@ -1518,6 +1665,11 @@ Settings::setDefaultValues()
     _autoWipe->setDefaultValue(true);
     _autoProxyWhenScrubbingTimeline->setDefaultValue(true);
     _autoProxyLevel->setDefaultValue(1);
+    _adaptivePlaybackResolution->setDefaultValue(false);
+    _adaptivePlaybackMaxLevel->setDefaultValue(1);
+    _adaptivePlaybackDraft->setDefaultValue(false);
+    _speculativeRendering->setDefaultValue(false);
+    _speculativeRenderingFrames->setDefaultValue(4);
     _maximumNodeViewerUIOpened->setDefaultValue(2);
     _viewerKeys->setDefaultValue(true);
 
@@ -2121,6 +2273,13 @@ Settings::restoreSettings(bool useDefault)
         appPTR->setNThreadsToRender( getNumberOfThreads() );
         appPTR->setUseThreadPool( _useThreadPool->getValue() );
         appPTR->setPluginsUseInputImageCopyToRender( _pluginUseImageCopyForSource->getValue() );
+        appPTR->setApplicationsCachesEvictionPolicy( getCacheEvictionPolicy() );
+        ImageBufferPool::setHugePagesEnabled( _useHugePages->getValue() );
+        NumaPlacement::setEnabled( _numaAwareRendering->getValue() );
+        RenderTaskScheduler::setPrioritiesEnabled( _prioritizeRenders->getValue() );
+        for (int i = 0; i < eRenderTaskClassCount; ++i) {
+            RenderTaskScheduler::setMaxThreads( (RenderTaskClassEnum)i, _renderClassMaxThreads[i]->getValue() );
+        }
     } catch (std::logic_error) {
         // ignore
     }
@@ -2247,6 +2406,12 @@ Settings::onKnobValueChanged(KnobI* k,
         if (!_restoringSettings) {
             appPTR->setApplicationsCachesMaximumDiskSpace( getMaximumDiskCacheNodeSize() );
         }
+    } else if ( k == _useHugePages.get() ) {
+        ImageBufferPool::setHugePagesEnabled( _useHugePages->getValue() );
+    } else if ( k == _cacheEvictionPolicy.get() ) {
+        if (!_restoringSettings) {
+            appPTR->setApplicationsCachesEvictionPolicy( getCacheEvictionPolicy() );
+        }
     } else if ( k == _maxRAMPercent.get() ) {
         if (!_restoringSettings) {
             appPTR->setApplicationsCachesMaximumMemoryPercent( getRamMaximumPercent() );
@@ -2281,6 +2446,10 @@ Settings::onKnobValueChanged(KnobI* k,
     } else if ( k == _useThreadPool.get() ) {
         bool useTP = _useThreadPool->getValue();
         appPTR->setUseThreadPool(useTP);
+    } else if ( k == _numaAwareRendering.get() ) {
+        NumaPlacement::setEnabled( _numaAwareRendering->getValue() );
+    } else if ( k == _prioritizeRenders.get() ) {
+        RenderTaskScheduler::setPrioritiesEnabled( _prioritizeRenders->getValue() );
     } else if ( k == _customOcioConfigFile.get() ) {
         if ( _customOcioConfigFile->isEnabled(0) ) {
             tryLoadOpenColorIOConfig();
@@ -2310,6 +2479,11 @@ Settings::onKnobValueChanged(KnobI* k,
         appPTR->toggleAutoHideGraphInputs();
     } else if ( k == _autoProxyWhenScrubbingTimeline.get() ) {
         _autoProxyLevel->setSecret( !_autoProxyWhenScrubbingTimeline->getValue() );
+    } else if ( k == _speculativeRendering.get() ) {
+        _speculativeRenderingFrames->setSecret( !_speculativeRendering->getValue() );
+    } else if ( k == _adaptivePlaybackResolution.get() ) {
+        _adaptivePlaybackMaxLevel->setSecret( !_adaptivePlaybackResolution->getValue() );
+        _adaptivePlaybackDraft->setSecret( !_adaptivePlaybackResolution->getValue() );
     } else if ( !_restoringSettings &&
                 ( ( k == _sunkenColor.get() ) ||
                   ( k == _baseColor.get() ) ||
@@ -2371,6 +2545,13 @@ Settings::onKnobValueChanged(KnobI* k,
         }
     } else {
         ret = false;
+        for (int i = 0; i < eRenderTaskClassCount; ++i) {
+            if ( k == _renderClassMaxThreads[i].get() ) {
+                RenderTaskScheduler::setMaxThreads( (RenderTaskClassEnum)i, _renderClassMaxThreads[i]->getValue() );
+                ret = true;
+                break;
+            }
+        }
     }
     if (ret) {
         if ( ( ( k == _hostName.get() ) || ( k == _customHostName.get() ) ) && !_restoringSettings ) {
@@ -2455,6 +2636,36 @@ Settings::getAutoProxyMipMapLevel() const
     return (unsigned int)_autoProxyLevel->getValue() + 1;
 }
 
+bool
+Settings::isAdaptivePlaybackResolutionEnabled() const
+{
+    return _adaptivePlaybackResolution->getValue();
+}
+
+unsigned int
+Settings::getAdaptivePlaybackMaxMipMapLevel() const
+{
+    return (unsigned int)_adaptivePlaybackMaxLevel->getValue() + 1;
+}
+
+bool
+Settings::isAdaptivePlaybackDraftEnabled() const
+{
+    return _adaptivePlaybackDraft->getValue();
+}
+
+bool
+Settings::isSpeculativeRenderingEnabled() const
+{
+    return _speculativeRendering->getValue();
+}
+
+int
+Settings::getSpeculativeRenderingFrames() const
+{
+    return _speculativeRenderingFrames->getValue();
+}
+
 int
 Settings::getMaxOpenedNodesViewerContext() const
 {
@@ -2494,6 +2705,24 @@ Settings::getMaximumDiskCacheNodeSize() const
     return (U64)( _maxDiskCacheNodeGB->getValue() ) * std::pow(1024., 3.);
 }
 
+CacheEvictionPolicyEnum
+Settings::getCacheEvictionPolicy() const
+{
+    return (CacheEvictionPolicyEnum)_cacheEvictionPolicy->getValue();
+}
+
+bool
+Settings::isHalfCacheStorageEnabled() const
+{
+    return _halfCacheStorage->getValue();
+}
+
+double
+Settings::getHalfCacheStorageMaxError() const
+{
+    return _halfCacheStorageMaxError->getValue();
+}
+
 ///////////////////////////////////////////////////
 
 double
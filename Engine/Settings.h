@@ -110,6 +110,12 @@ public:
 
     U64 getMaximumDiskCacheNodeSize() const;
 
+    CacheEvictionPolicyEnum getCacheEvictionPolicy() const;
+
+    bool isHalfCacheStorageEnabled() const;
+
+    double getHalfCacheStorageMaxError() const;
+
     double getUnreachableRamPercent() const;
 
     bool getColorPickerLinear() const;
@@ -247,6 +253,11 @@ public:
     bool isAutoWipeEnabled() const;
     bool isAutoProxyEnabled() const;
     unsigned int getAutoProxyMipMapLevel() const;
+    bool isAdaptivePlaybackResolutionEnabled() const;
+    unsigned int getAdaptivePlaybackMaxMipMapLevel() const;
+    bool isAdaptivePlaybackDraftEnabled() const;
+    bool isSpeculativeRenderingEnabled() const;
+    int getSpeculativeRenderingFrames() const;
     int getMaxOpenedNodesViewerContext() const;
     bool isViewerKeysEnabled() const;
     ///////////////////////////////////////////////////////
@@ -434,7 +445,10 @@ private:
     KnobIntPtr _numberOfThreads;
     KnobIntPtr _numberOfParallelRenders;
     KnobBoolPtr _useThreadPool;
+    KnobBoolPtr _numaAwareRendering;
     KnobIntPtr _nThreadsPerEffect;
+    KnobBoolPtr _prioritizeRenders;
+    KnobIntPtr _renderClassMaxThreads[eRenderTaskClassCount];
     KnobBoolPtr _renderInSeparateProcess;
     KnobBoolPtr _queueRenders;
 
@@ -512,6 +526,10 @@ private:
     ///The total disk space allowed for all Natron's caches
     KnobIntPtr _maxViewerDiskCacheGB;
     KnobIntPtr _maxDiskCacheNodeGB;
+    KnobChoicePtr _cacheEvictionPolicy;
+    KnobBoolPtr _useHugePages;
+    KnobBoolPtr _halfCacheStorage;
+    KnobDoublePtr _halfCacheStorageMaxError;
     KnobPathPtr _diskCachePath;
     KnobButtonPtr _wipeDiskCache;
 
@@ -525,6 +543,11 @@ private:
     KnobBoolPtr _autoWipe;
     KnobBoolPtr _autoProxyWhenScrubbingTimeline;
     KnobChoicePtr _autoProxyLevel;
+    KnobBoolPtr _adaptivePlaybackResolution;
+    KnobChoicePtr _adaptivePlaybackMaxLevel;
+    KnobBoolPtr _adaptivePlaybackDraft;
+    KnobBoolPtr _speculativeRendering;
+    KnobIntPtr _speculativeRenderingFrames;
     KnobIntPtr _maximumNodeViewerUIOpened;
     KnobBoolPtr _viewerKeys;
 
@@ -32,6 +32,7 @@
 #include "Engine/OfxHost.h"
 #include "Engine/OfxParamInstance.h"
 #include "Engine/Project.h"
+#include "Engine/RenderAbortToken.h"
 #include "Engine/ThreadPool.h"
 
 #include <QtCore/QWaitCondition>
@@ -70,15 +71,26 @@ copyAbortInfo(QThread* fromThread,
               QThread* toThread)
 {
     AbortableThread* fromAbortable = dynamic_cast<AbortableThread*>(fromThread);
-    AbortableThread* toAbortable = dynamic_cast<AbortableThread*>(toThread);
 
-    if (fromAbortable && toAbortable) {
-        bool isRenderResponseToUserInteraction;
-        AbortableRenderInfoPtr abortInfo;
-        EffectInstancePtr treeRoot;
-        fromAbortable->getAbortInfo(&isRenderResponseToUserInteraction, &abortInfo, &treeRoot);
+    if (!fromAbortable) {
+        return;
+    }
+    bool isRenderResponseToUserInteraction;
+    AbortableRenderInfoPtr abortInfo;
+    EffectInstancePtr treeRoot;
+    if ( !fromAbortable->getAbortInfo(&isRenderResponseToUserInteraction, &abortInfo, &treeRoot) ) {
+        return;
+    }
+
+    AbortableThread* toAbortable = dynamic_cast<AbortableThread*>(toThread);
+    if (toAbortable) {
         toAbortable->setAbortInfo(isRenderResponseToUserInteraction, abortInfo, treeRoot);
     }
+
+    // The spawned thread polls the same render as the spawner thread, this is cleared in cleanupTLSForThread()
+    if ( toThread == QThread::currentThread() ) {
+        RenderAbortToken::set(isRenderResponseToUserInteraction, abortInfo, treeRoot);
+    }
 }
 
 void
@@ -125,6 +137,7 @@ AppTLS::cleanupTLSForThread()
     if (isAbortableThread) {
         isAbortableThread->clearAbortInfo();
     }
+    RenderAbortToken::clear();
 
     //Cleanup any cached data on the TLSHolder
     {
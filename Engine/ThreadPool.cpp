@@ -31,12 +31,33 @@
 #include <QtCore/QMutex>
 #include <QtCore/QThread>
 #include <QtCore/QThreadPool>
+#include <QtCore/QThreadStorage>
 
 #include "Engine/AbortableRenderInfo.h"
 #include "Engine/Node.h"
 
 NATRON_NAMESPACE_ENTER
 
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+// The AbortableThread of each thread, resolved on the first call to AbortableThread::getCurrentThread()
+struct CurrentAbortableThread
+{
+    bool resolved;
+    AbortableThread* thread;
+
+    CurrentAbortableThread()
+        : resolved(false)
+        , thread(0)
+    {
+    }
+};
+
+// Never destroyed: threads may still exit after static destructors ran
+QThreadStorage<CurrentAbortableThread>* gCurrentAbortableThread = new QThreadStorage<CurrentAbortableThread>;
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
 
 struct AbortableThreadPrivate
 {
@@ -73,6 +94,19 @@ AbortableThread::~AbortableThread()
 {
 }
 
+AbortableThread*
+AbortableThread::getCurrentThread()
+{
+    CurrentAbortableThread& current = gCurrentAbortableThread->localData();
+
+    if (!current.resolved) {
+        current.thread = dynamic_cast<AbortableThread*>( QThread::currentThread() );
+        current.resolved = true;
+    }
+
+    return current.thread;
+}
+
 void
 AbortableThread::setThreadName(const std::string& threadName)
 {
@@ -52,6 +52,12 @@ public:
 
     virtual ~AbortableThread();
 
+    /**
+     * @brief Returns the current thread if it is an AbortableThread, NULL otherwise. This is faster than a dynamic_cast
+     * of QThread::currentThread() since the result is kept in thread-local storage.
+     **/
+    static AbortableThread* getCurrentThread();
+
     /**
      * @brief Set the informations related to a specific render so we know if it was aborted or not in getAbortInfo()
      **/
@@ -107,8 +113,7 @@ private:
 
 #define REPORT_CURRENT_THREAD_ACTION(actionName, node) \
     { \
-        QThread* thread = QThread::currentThread(); \
-        AbortableThread* isAbortable = dynamic_cast<AbortableThread*>(thread); \
+        AbortableThread* isAbortable = AbortableThread::getCurrentThread(); \
         if (isAbortable) {  \
             isAbortable->setCurrentActionInfos(actionName, node); \
         } \
@@ -1156,6 +1156,11 @@ TrackerContext::trackMarkers(const std::list<TrackMarkerPtr>& markers,
         viewer = overlayInteract->getInternalViewerNode();
     }
 
+    // The tracker renders its input: it must see the changes recorded so far by a change transaction
+    AppInstancePtr app = getNode()->getApp();
+    if (app) {
+        app->flushChangeTransaction();
+    }
 
     /// The channels we are going to use for tracking
     bool enabledChannels[3];
@@ -79,6 +79,12 @@ CLANG_DIAG_ON(deprecated)
 
 #define NATRON_TIME_ELASPED_BEFORE_PROGRESS_REPORT 4. //!< do not display the progress report if estimated total time is less than this (in seconds)
 
+// Adaptive playback resolution, see ViewerInstance::reportPlaybackFrameRenderTime
+#define NATRON_PLAYBACK_RESOLUTION_SMOOTHING 0.3 //!< weight of the last frame in the average frame time
+#define NATRON_PLAYBACK_RESOLUTION_MIN_FRAMES 3 //!< frames to measure at a resolution before changing it again
+#define NATRON_PLAYBACK_RESOLUTION_LEVEL_SPEEDUP 3. //!< expected speedup from one mipmap level to the next: 4 times less pixels, but not all costs scale with pixels
+#define NATRON_PLAYBACK_RESOLUTION_HEADROOM 0.8 //!< only raise the resolution if the predicted frame time uses less than this fraction of the frame budget
+
 NATRON_NAMESPACE_ENTER
 
 using std::make_pair;
@@ -702,6 +708,54 @@ ViewerInstance::renderViewer(ViewIdx view,
     return eViewerRenderRetCodeRender;
 } // ViewerInstance::renderViewer
 
+bool
+ViewerInstance::renderFrameToCache(SequenceTime time,
+                                   ViewIdx view,
+                                   const AbortableRenderInfoPtr& abortInfo)
+{
+    // Partial updates (e.g. while tracking) are displayed directly by renderViewer_internal
+    if ( !_imp->uiContext || isDoingPartialUpdates() ) {
+        return false;
+    }
+
+    U64 viewerHash = getHash();
+    bool ok = true;
+    for (int i = 0; i < 2; ++i) {
+        if ( (i == 1) && (_imp->uiContext->getCompositingOperator() == eViewerCompositingOperatorNone) ) {
+            break;
+        }
+        if ( abortInfo->isAborted() ) {
+            ok = false;
+            break;
+        }
+
+        // The arguments are those of a single frame render, so that the frame is rendered at the resolution used when the timeline is moved to it
+        ViewerArgs args;
+        ViewerRenderRetCode stat = getRenderViewerArgsAndCheckCache(time, false, view, i, viewerHash, NodePtr(), abortInfo, RenderStatsPtr(), &args);
+        if ( (stat != eViewerRenderRetCodeRender) || !args.params || args.params->isViewerPaused ) {
+            continue;
+        }
+        if ( !args.mustComputeRoDAndLookupCache && ( args.params->nbCachedTile == (int)args.params->tiles.size() ) ) {
+            // Already cached
+            continue;
+        }
+
+        // Render it as a sequential render so that it does not take part in the render ages of the viewer, which
+        // decide which of the renders of the current frame get displayed
+        try {
+            stat = renderViewer_internal(view, false, true, viewerHash, true, NodePtr(), true, ViewerCurrentFrameRequestSchedulerStartArgsPtr(), RenderStatsPtr(), args);
+        } catch (...) {
+            stat = eViewerRenderRetCodeFail;
+        }
+        args.isRenderingFlag.reset();
+        if (stat != eViewerRenderRetCodeRender) {
+            ok = false;
+        }
+    }
+
+    return ok && !abortInfo->isAborted();
+} // ViewerInstance::renderFrameToCache
+
 static bool
 checkTreeCanRender_internal(Node* node,
                             std::list<Node*>& marked)
@@ -884,6 +938,18 @@ ViewerInstance::setupMinimalUpdateViewerParams(const SequenceTime time,
         outArgs->mipMapLevelWithDraft = (unsigned int)std::max( (int)outArgs->mipmapLevelWithoutDraft, (int)autoProxyLevel );
     }
 
+    // During playback, lower the resolution further if needed to reach the desired frame rate
+    outArgs->playbackResolutionLevel = 0;
+    if ( isSequential && appPTR->getCurrentSettings()->isAdaptivePlaybackResolutionEnabled() ) {
+        outArgs->playbackResolutionLevel = getPlaybackResolutionLevel();
+        if (outArgs->playbackResolutionLevel > 0) {
+            outArgs->mipMapLevelWithDraft = std::max(outArgs->mipMapLevelWithDraft, outArgs->mipmapLevelWithoutDraft + outArgs->playbackResolutionLevel);
+            if ( appPTR->getCurrentSettings()->isAdaptivePlaybackDraftEnabled() ) {
+                outArgs->draftModeEnabled = true;
+            }
+        }
+    }
+
 
     // The hash of the node to render, we store it and make sure we never call getHash() again for the render of this frame
     outArgs->activeInputHash = outArgs->activeInputToRender->getHash();
@@ -909,7 +975,7 @@ ViewerInstance::setupMinimalUpdateViewerParams(const SequenceTime time,
     // Is it playback ?
     outArgs->params->isSequential = isSequential;
 
-    // Used to identify this render when calling EffectInstance::Implementation::aborted
+    // Used to identify this render when calling EffectInstance::aborted()
     outArgs->params->abortInfo = abortInfo;
 
     // Used to differentiate the 2 different textures when wipe is enabled
@@ -1172,8 +1238,9 @@ ViewerInstance::getRoDAndLookupCache(const bool useOnlyRoDCache,
     EffectInstance::SupportsEnum supportsRS = outArgs->activeInputToRender->supportsRenderScaleMaybe();
 
 
-    // When in draft mode first try to get a texture without draft and then try with draft
-    const int nLookups = outArgs->draftModeEnabled ? 2 : 1;
+    // When in draft mode or when the resolution is lowered for playback, first try to get a texture at the
+    // full viewer resolution and then try at the lowered resolution
+    const int nLookups = ( outArgs->draftModeEnabled || (outArgs->mipMapLevelWithDraft != outArgs->mipmapLevelWithoutDraft) ) ? 2 : 1;
 
     for (int lookup = 0; lookup < nLookups; ++lookup) {
         const unsigned mipMapLevel = lookup == 0 ? outArgs->mipmapLevelWithoutDraft : outArgs->mipMapLevelWithDraft;
@@ -1223,7 +1290,7 @@ ViewerInstance::getRoDAndLookupCache(const bool useOnlyRoDCache,
         Q_UNUSED(isRodProjectFormat);
 
         // Ok we go the RoD, we can actually compute the RoI and look-up the cache
-        ViewerRenderRetCode retCode = getViewerRoIAndTexture(rod, viewerHash, useTextureCache, lookup == 1, mipMapLevel, stats, outArgs);
+        ViewerRenderRetCode retCode = getViewerRoIAndTexture(rod, viewerHash, useTextureCache, lookup == 1 && outArgs->draftModeEnabled, mipMapLevel, stats, outArgs);
         if (retCode != eViewerRenderRetCodeRender) {
             return retCode;
         }
@@ -3072,6 +3139,81 @@ ViewerInstance::getViewerMipMapLevel() const
     return _imp->viewerMipMapLevel;
 }
 
+unsigned int
+ViewerInstance::getPlaybackResolutionLevel() const
+{
+    QMutexLocker l(&_imp->playbackResolutionMutex);
+
+    return _imp->playbackResolutionLevel;
+}
+
+void
+ViewerInstance::reportPlaybackFrameRenderTime(double renderTime,
+                                              unsigned int playbackResolutionLevel,
+                                              int nParallelRenders,
+                                              double desiredFPS)
+{
+    if (desiredFPS <= 0) {
+        return;
+    }
+    unsigned int maxLevel = appPTR->getCurrentSettings()->getAdaptivePlaybackMaxMipMapLevel();
+    QMutexLocker l(&_imp->playbackResolutionMutex);
+
+    if (playbackResolutionLevel != _imp->playbackResolutionLevel) {
+        // This frame was started before the last change, it does not tell anything about the current resolution
+        return;
+    }
+
+    // Frames are rendered concurrently, what matters is the rate at which they come out
+    double frameTime = renderTime / std::max(1, nParallelRenders);
+    if (_imp->playbackFrameTimeAverage < 0) {
+        _imp->playbackFrameTimeAverage = frameTime;
+    } else {
+        _imp->playbackFrameTimeAverage = _imp->playbackFrameTimeAverage * (1. - NATRON_PLAYBACK_RESOLUTION_SMOOTHING) + frameTime * NATRON_PLAYBACK_RESOLUTION_SMOOTHING;
+    }
+    ++_imp->playbackNbFramesMeasured;
+    if (_imp->playbackNbFramesMeasured < NATRON_PLAYBACK_RESOLUTION_MIN_FRAMES) {
+        return;
+    }
+
+    const double frameBudget = 1. / desiredFPS;
+    double predictedFrameTime = _imp->playbackFrameTimeAverage;
+    unsigned int level = playbackResolutionLevel;
+    if (predictedFrameTime > frameBudget) {
+        // Too slow: go down as many levels as needed at once so that playback catches up quickly
+        while (predictedFrameTime > frameBudget && level < maxLevel) {
+            predictedFrameTime /= NATRON_PLAYBACK_RESOLUTION_LEVEL_SPEEDUP;
+            ++level;
+        }
+    } else {
+        // Fast enough: go up while the frame time at the higher resolution is expected to fit in the budget
+        while ( level > 0 && (predictedFrameTime * NATRON_PLAYBACK_RESOLUTION_LEVEL_SPEEDUP <= frameBudget * NATRON_PLAYBACK_RESOLUTION_HEADROOM) ) {
+            predictedFrameTime *= NATRON_PLAYBACK_RESOLUTION_LEVEL_SPEEDUP;
+            --level;
+        }
+    }
+    level = std::min(level, maxLevel);
+
+    if (level != _imp->playbackResolutionLevel) {
+        _imp->playbackResolutionLevel = level;
+        _imp->playbackFrameTimeAverage = -1.;
+        _imp->playbackNbFramesMeasured = 0;
+    }
+}
+
+bool
+ViewerInstance::resetPlaybackResolution()
+{
+    QMutexLocker l(&_imp->playbackResolutionMutex);
+    bool wasLowered = _imp->playbackResolutionLevel > 0;
+
+    _imp->playbackResolutionLevel = 0;
+    _imp->playbackFrameTimeAverage = -1.;
+    _imp->playbackNbFramesMeasured = 0;
+
+    return wasLowered;
+}
+
 void
 ViewerInstance::onMipMapLevelChanged(int level)
 {
@@ -3537,8 +3679,11 @@ void
 ViewerInstance::reportStats(int time,
                             ViewIdx view,
                             double wallTime,
-                            const RenderStatsMap& stats)
+                            const RenderStatsMap& stats,
+                            const MemoryGovernorStatus& memoryStatus)
 {
+    // The render statistics window does not show the memory state
+    Q_UNUSED(memoryStatus);
     Q_EMIT renderStatsAvailable(time, view, wallTime, stats);
 }
 
@@ -55,6 +55,7 @@ public:
     RenderingFlagSetterPtr isRenderingFlag;
     bool draftModeEnabled;
     unsigned int mipMapLevelWithDraft, mipmapLevelWithoutDraft;
+    unsigned int playbackResolutionLevel; // mipmap levels added to lower the resolution during playback, see getPlaybackResolutionLevel()
     bool autoContrast;
     DisplayChannelsEnum channels;
     bool userRoIEnabled;
@@ -215,6 +216,15 @@ public:
                                                      ViewerArgsPtr* argsA,
                                                      ViewerArgsPtr* argsB);
 
+    /**
+     * @brief Renders the frame at the given time with the current settings of the viewer (zoom, channels, etc...) and stores it
+     * in the viewer cache without displaying it, so that it is found in the cache when the timeline is moved to that frame.
+     * This does nothing if the frame is already cached. abortInfo must be speculative (see AbortableRenderInfo::isSpeculative()),
+     * so that the render is scheduled as a background render.
+     * Returns false if the render failed or was aborted with abortInfo.
+     **/
+    bool renderFrameToCache(SequenceTime time, ViewIdx view, const AbortableRenderInfoPtr& abortInfo);
+
     void aboutToUpdateTextures();
 
     void updateViewer(UpdateViewerParamsPtr & frame);
@@ -319,7 +329,8 @@ public:
     void setDoingPartialUpdates(bool doing);
     bool isDoingPartialUpdates() const;
 
-    virtual void reportStats(int time, ViewIdx view, double wallTime, const RenderStatsMap& stats) OVERRIDE FINAL;
+    virtual void reportStats(int time, ViewIdx view, double wallTime, const RenderStatsMap& stats,
+                             const MemoryGovernorStatus& memoryStatus) OVERRIDE FINAL;
 
     ///Only callable on MT
     void setActivateInputChangeRequestedFromViewer(bool fromViewer);
@@ -332,6 +343,27 @@ public:
 
     unsigned int getViewerMipMapLevel() const;
 
+    /**
+     * @brief When adaptive playback resolution is enabled in the preferences, returns the number of mipmap levels
+     * added to the mipmap level of the viewer during playback so that frames render fast enough to reach the desired frame rate.
+     **/
+    unsigned int getPlaybackResolutionLevel() const;
+
+    /**
+     * @brief Called by the playback render threads after each frame rendered at the given playback resolution level.
+     * The level is adjusted from the measured render times so that nParallelRenders renders keep up with desiredFPS.
+     **/
+    void reportPlaybackFrameRenderTime(double renderTime,
+                                       unsigned int playbackResolutionLevel,
+                                       int nParallelRenders,
+                                       double desiredFPS);
+
+    /**
+     * @brief Goes back to full resolution, to be called when playback stops.
+     * Returns true if the resolution was lowered, in which case the current frame should be rendered again.
+     **/
+    bool resetPlaybackResolution();
+
 public Q_SLOTS:
 
 
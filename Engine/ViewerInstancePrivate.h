@@ -140,6 +140,10 @@ public:
         , viewerParamsAlphaLayer( ImagePlaneDesc::getRGBAComponents() )
         , viewerParamsAlphaChannelName("a")
         , viewerMipMapLevel(0)
+        , playbackResolutionMutex()
+        , playbackResolutionLevel(0)
+        , playbackFrameTimeAverage(-1.)
+        , playbackNbFramesMeasured(0)
         , fullFrameProcessingEnabled(false)
         , activateInputChangedFromViewer(false)
         , gammaLookupMutex()
@@ -387,6 +391,12 @@ public:
     ImagePlaneDesc viewerParamsAlphaLayer;
     std::string viewerParamsAlphaChannelName;
     unsigned int viewerMipMapLevel; //< the mipmap level the viewer should render at (0 == no downscaling)
+
+    // Adaptive playback resolution
+    mutable QMutex playbackResolutionMutex; //< protects playbackResolutionLevel, playbackFrameTimeAverage, playbackNbFramesMeasured
+    unsigned int playbackResolutionLevel; //< mipmap levels added to viewerMipMapLevel during playback
+    double playbackFrameTimeAverage; //< smoothed time per frame at playbackResolutionLevel in seconds, -1 if not measured yet
+    int playbackNbFramesMeasured; //< number of frames measured at playbackResolutionLevel
     bool fullFrameProcessingEnabled;
 
     ///Only accessed from MT
@@ -486,6 +486,29 @@ enum SchedulingPolicyEnum
     eSchedulingPolicyOrdered ///frames will be rendered in order
 };
 
+enum MemoryGovernorStateEnum
+{
+    eMemoryGovernorStateNormal = 0, ///memory is plentiful, caches use their full budget
+    eMemoryGovernorStateElevated, ///memory is getting scarce, cache budgets and parallel renders are reduced
+    eMemoryGovernorStateCritical ///the process is close to its memory limit, cache budgets and parallel renders are cut down
+};
+
+enum CacheEvictionPolicyEnum
+{
+    eCacheEvictionPolicyLRU = 0, ///the least recently used entry is evicted first
+    eCacheEvictionPolicyCostAware ///entries with a low recompute time per byte are evicted first (GreedyDual-Size)
+};
+
+enum RenderTaskClassEnum
+{
+    eRenderTaskClassInteractive = 0, ///the viewer render of the current frame, e.g after a parameter change or a seek
+    eRenderTaskClassPlayback, ///the viewer renders during playback
+    eRenderTaskClassAnalysis, ///renders made by analysis tools such as the tracker
+    eRenderTaskClassPreview, ///the renders of the node graph previews
+    eRenderTaskClassBackground, ///renders to disk, frames rendered in advance by the viewer and any other render
+    eRenderTaskClassCount
+};
+
 enum DisplayChannelsEnum
 {
     eDisplayChannelsRGB = 0,
@@ -105,6 +105,13 @@ typedef OfxRangeD RangeD;
 
 #define kBgProcessServerCreatedShort "--bg_server_created"
 
+///these are used by the render server (NatronRenderer --render-server) to communicate with its clients
+#define kRenderServerQuit "quit"
+
+#define kRenderServerJobDone "done"
+
+#define kRenderServerJobError "error"
+
 //Increment this to wipe all disk cache structure and ensure that the user has a clean cache when starting the next version of Natron
 #define NATRON_CACHE_VERSION 4
 #define kNatronCacheVersionSettingsKey "NatronCacheVersionSettingsKey"
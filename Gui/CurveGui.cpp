@@ -32,8 +32,10 @@
 #include <QtCore/QObject>
 #include <QtCore/QCoreApplication>
 #include <QtCore/QDebug>
+#include <QtConcurrentRun> // QtCore on Qt4, QtConcurrent on Qt5
 
 #include "Engine/Bezier.h"
+#include "Engine/EffectInstance.h"
 #include "Engine/Knob.h"
 #include "Engine/KnobTypes.h"
 #include "Engine/RotoContext.h" // Bezier
@@ -43,6 +45,11 @@
 #include "Gui/CurveWidgetPrivate.h"
 #include "Gui/KnobGui.h"
 
+// Expression curves are first sampled every NATRON_CURVE_EXPRESSION_COARSE_STEP pixels
+#define NATRON_CURVE_EXPRESSION_COARSE_STEP 8.
+// A segment is subdivided while its middle is further than this from the chord, in pixels
+#define NATRON_CURVE_EXPRESSION_TOLERANCE 0.5
+
 NATRON_NAMESPACE_ENTER
 
 CurveGui::CurveGui(CurveWidget *curveWidget,
@@ -57,6 +64,14 @@ CurveGui::CurveGui(CurveWidget *curveWidget,
     , _thickness(thickness)
     , _visible(false)
     , _selected(false)
+    , _curveSamplesKey()
+    , _curveSamplesValid(false)
+    , _curveSamples()
+    , _exprSamplesKey()
+    , _exprSamplesValid(false)
+    , _exprSamples()
+    , _exprSamplesComputingKey()
+    , _exprSamplesWatcher()
 {
     // always running in the main thread
     assert( qApp && qApp->thread() == QThread::currentThread() );
@@ -66,6 +81,224 @@ CurveGui::~CurveGui()
 {
     // always running in the main thread
     assert( qApp && qApp->thread() == QThread::currentThread() );
+    // A computation still running holds its own reference to the knob, its result is just dropped
+    if (_exprSamplesWatcher) {
+        _exprSamplesWatcher->disconnect(this);
+    }
+}
+
+bool
+CurveGui::CurveSamplingKey::operator==(const CurveSamplingKey& other) const
+{
+    return origin == other.origin &&
+           unit == other.unit &&
+           widgetWidth == other.widgetWidth &&
+           isPeriodic == other.isPeriodic &&
+           parametricRange == other.parametricRange &&
+           yRange.min == other.yRange.min &&
+           yRange.max == other.yRange.max &&
+           keyframes.size() == other.keyframes.size() &&
+           std::equal( keyframes.begin(), keyframes.end(), other.keyframes.begin() );
+}
+
+bool
+CurveGui::ExpressionSamplingKey::operator==(const ExpressionSamplingKey& other) const
+{
+    return origin == other.origin &&
+           unit == other.unit &&
+           widgetWidth == other.widgetWidth &&
+           knobsAge == other.knobsAge &&
+           dependenciesAge == other.dependenciesAge &&
+           expression == other.expression;
+}
+
+void
+CurveGui::invalidateSamples()
+{
+    // always running in the main thread
+    assert( qApp && qApp->thread() == QThread::currentThread() );
+
+    _curveSamplesValid = false;
+    _exprSamplesValid = false;
+}
+
+namespace {
+struct ExpressionSamplingArgs
+{
+    KnobIPtr knob;
+    int dimension;
+    double xMin, xMax;
+    double pixelsPerUnitX, pixelsPerUnitY;
+};
+
+class ExpressionSampler
+{
+    const ExpressionSamplingArgs& _args;
+    std::vector<float>* _vertices;
+
+public:
+
+    ExpressionSampler(const ExpressionSamplingArgs& args,
+                      std::vector<float>* vertices)
+        : _args(args)
+        , _vertices(vertices)
+    {
+    }
+
+    double evaluate(double x) const
+    {
+        return _args.knob->getValueAtWithExpression( x, ViewIdx(0), _args.dimension );
+    }
+
+    void addVertex(double x,
+                   double y)
+    {
+        _vertices->push_back( (float)x );
+        _vertices->push_back( (float)y );
+    }
+
+    /**
+     * @brief Adds the vertices of ]x0, x1], subdividing while the middle of the segment does not lie on its chord.
+     * Segments are never subdivided below one pixel.
+     **/
+    void subdivide(double x0,
+                   double y0,
+                   double x1,
+                   double y1)
+    {
+        if ( (x1 - x0) * _args.pixelsPerUnitX > 1. ) {
+            double xm = (x0 + x1) / 2.;
+            double ym = evaluate(xm);
+            if ( std::abs( ym - (y0 + y1) / 2. ) * _args.pixelsPerUnitY > NATRON_CURVE_EXPRESSION_TOLERANCE ) {
+                subdivide(x0, y0, xm, ym);
+                subdivide(xm, ym, x1, y1);
+
+                return;
+            }
+        }
+        addVertex(x1, y1);
+    }
+};
+} // anon
+
+/**
+ * @brief Samples the expression curve: it is evaluated on a coarse regular grid first and each segment
+ * is then subdivided where the curve bends. This runs in a thread of the global thread pool since the expression
+ * may be Python.
+ **/
+static std::vector<float>
+sampleExpressionCurve(ExpressionSamplingArgs args)
+{
+    std::vector<float> vertices;
+
+    if ( (args.xMax <= args.xMin) || (args.pixelsPerUnitX <= 0.) ) {
+        return vertices;
+    }
+    ExpressionSampler sampler(args, &vertices);
+    try {
+        const double step = NATRON_CURVE_EXPRESSION_COARSE_STEP / args.pixelsPerUnitX;
+        double x0 = args.xMin;
+        double y0 = sampler.evaluate(x0);
+        sampler.addVertex(x0, y0);
+        while (x0 < args.xMax) {
+            double x1 = std::min(x0 + step, args.xMax);
+            double y1 = sampler.evaluate(x1);
+            sampler.subdivide(x0, y0, x1, y1);
+            x0 = x1;
+            y0 = y1;
+        }
+    } catch (...) {
+        // Draw what could be evaluated
+    }
+
+    return vertices;
+}
+
+void
+CurveGui::requestExpressionSamples(const KnobIPtr& knob,
+                                   int dimension,
+                                   const ExpressionSamplingKey& key)
+{
+    // always running in the main thread
+    assert( qApp && qApp->thread() == QThread::currentThread() );
+
+    if ( _exprSamplesWatcher && _exprSamplesWatcher->isRunning() ) {
+        // Only one computation at a time: the latest state is requested again when this one finishes
+        return;
+    }
+    if (!_exprSamplesWatcher) {
+        _exprSamplesWatcher.reset(new QFutureWatcher<std::vector<float> >);
+        QObject::connect( _exprSamplesWatcher.get(), SIGNAL(finished()), this, SLOT(onExpressionSamplesComputed()) );
+    }
+
+    ExpressionSamplingArgs args;
+    args.knob = knob;
+    args.dimension = dimension;
+    args.xMin = _curveWidget->toZoomCoordinates(0, 0).x();
+    args.xMax = _curveWidget->toZoomCoordinates(key.widgetWidth - 1, 0).x();
+    args.pixelsPerUnitX = key.unit.x() - key.origin.x();
+    args.pixelsPerUnitY = std::abs( key.unit.y() - key.origin.y() );
+    _exprSamplesComputingKey = key;
+    _exprSamplesWatcher->setFuture( QtConcurrent::run(sampleExpressionCurve, args) );
+}
+
+void
+CurveGui::onExpressionSamplesComputed()
+{
+    // always running in the main thread
+    assert( qApp && qApp->thread() == QThread::currentThread() );
+
+    _exprSamples = _exprSamplesWatcher->result();
+    _exprSamplesKey = _exprSamplesComputingKey;
+    _exprSamplesValid = true;
+    // Redraw: if the curve changed in the meantime, this also requests the samples of the new state
+    _curveWidget->update();
+}
+
+void
+CurveGui::computeCurveSamples(const KeyFrameSet& keyframes,
+                              bool isPeriodic,
+                              const std::pair<double, double>& parametricRange,
+                              std::vector<float>* vertices)
+{
+    // always running in the main thread
+    assert( qApp && qApp->thread() == QThread::currentThread() );
+    assert( !keyframes.empty() );
+
+    vertices->clear();
+
+    const double widgetWidth = _curveWidget->width();
+    double x1 = 0;
+    double x2;
+    try {
+        bool isX1AKey = false;
+        KeyFrame x1Key;
+        KeyFrameSet::const_iterator lastUpperIt = keyframes.end();
+
+        while ( x1 < (widgetWidth - 1) ) {
+            double x, y;
+            if (!isX1AKey) {
+                x = _curveWidget->toZoomCoordinates(x1, 0).x();
+                y = evaluate(false, x);
+            } else {
+                x = x1Key.getTime();
+                y = x1Key.getValue();
+            }
+
+            vertices->push_back( (float)x );
+            vertices->push_back( (float)y );
+            nextPointForSegment(x, keyframes, isPeriodic, parametricRange.first, parametricRange.second,  &lastUpperIt, &x2, &x1Key, &isX1AKey);
+            x1 = x2;
+        }
+        //also add the last point
+        {
+            double x = _curveWidget->toZoomCoordinates(x1, 0).x();
+            double y = evaluate(false, x);
+            vertices->push_back( (float)x );
+            vertices->push_back( (float)y );
+        }
+    } catch (...) {
+    }
 }
 
 void
@@ -298,13 +531,11 @@ CurveGui::drawCurve(int curveIndex,
 
     assert( QGLContext::currentContext() == _curveWidget->context() );
 
-    std::vector<float> vertices, exprVertices;
-    double x1 = 0;
-    double x2;
-    const double widgetWidth = _curveWidget->width();
     KeyFrameSet keyframes;
     BezierCPCurveGui* isBezier = dynamic_cast<BezierCPCurveGui*>(this);
     KnobCurveGui* isKnobCurve = dynamic_cast<KnobCurveGui*>(this);
+    const QPointF widgetOrigin = _curveWidget->toWidgetCoordinates(0, 0);
+    const QPointF widgetUnit = _curveWidget->toWidgetCoordinates(1, 1);
     bool hasDrawnExpr = false;
     if (isKnobCurve) {
         std::string expr;
@@ -312,61 +543,63 @@ CurveGui::drawCurve(int curveIndex,
         assert(knob);
         expr = knob->getExpression( isKnobCurve->getDimension() );
         if ( !expr.empty() ) {
-            //we have no choice but to evaluate the expression at each time
-            for (int i = x1; i < widgetWidth; ++i) {
-                double x = _curveWidget->toZoomCoordinates(i, 0).x();;
-                double y = knob->getValueAtWithExpression( x, ViewIdx(0), isKnobCurve->getDimension() );
-                exprVertices.push_back(x);
-                exprVertices.push_back(y);
+            // The expression has to be evaluated at each time: do it only if anything changed
+            ExpressionSamplingKey key;
+            key.origin = widgetOrigin;
+            key.unit = widgetUnit;
+            key.widgetWidth = _curveWidget->width();
+            key.expression = expr;
+            EffectInstance* effect = dynamic_cast<EffectInstance*>( knob->getHolder() );
+            if (effect) {
+                key.knobsAge = effect->getKnobsAge();
+            }
+            key.dependenciesAge = knob->getExpressionDependenciesAge();
+            if ( !_exprSamplesValid || !(key == _exprSamplesKey) ) {
+                requestExpressionSamples(knob, isKnobCurve->getDimension(), key);
             }
             hasDrawnExpr = true;
+        } else {
+            _exprSamples.clear();
+            _exprSamplesValid = false;
         }
     }
     bool isPeriodic = false;
     std::pair<double,double> parametricRange = std::make_pair(-std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity());
     if (isBezier) {
-        std::set<double> keys;
-        isBezier->getBezier()->getKeyframeTimes(&keys);
+        std::list<std::pair<double, KeyframeTypeEnum> > keys;
+        isBezier->getBezier()->getKeyframeTimesAndInterpolation(&keys);
         int i = 0;
-        for (std::set<double>::iterator it = keys.begin(); it != keys.end(); ++it, ++i) {
-            keyframes.insert( KeyFrame(*it, i) );
+        for (std::list<std::pair<double, KeyframeTypeEnum> >::iterator it = keys.begin(); it != keys.end(); ++it, ++i) {
+            KeyFrame k(it->first, i);
+            // The interpolation is part of the sampling key
+            k.setInterpolation(it->second);
+            keyframes.insert(k);
         }
     } else {
         keyframes = getInternalCurve()->getKeyFrames_mt_safe();
         isPeriodic = getInternalCurve()->isCurvePeriodic();
         parametricRange = getInternalCurve()->getXRange();
     }
-    if ( !keyframes.empty() ) {
-        try {
-            bool isX1AKey = false;
-            KeyFrame x1Key;
-            KeyFrameSet::const_iterator lastUpperIt = keyframes.end();
-
-            while ( x1 < (widgetWidth - 1) ) {
-                double x, y;
-                if (!isX1AKey) {
-                    x = _curveWidget->toZoomCoordinates(x1, 0).x();
-                    y = evaluate(false, x);
-                } else {
-                    x = x1Key.getTime();
-                    y = x1Key.getValue();
-                }
-
-                vertices.push_back( (float)x );
-                vertices.push_back( (float)y );
-                nextPointForSegment(x, keyframes, isPeriodic, parametricRange.first, parametricRange.second,  &lastUpperIt, &x2, &x1Key, &isX1AKey);
-                x1 = x2;
-            }
-            //also add the last point
-            {
-                double x = _curveWidget->toZoomCoordinates(x1, 0).x();
-                double y = evaluate(false, x);
-                vertices.push_back( (float)x );
-                vertices.push_back( (float)y );
-            }
-        } catch (...) {
+    if ( keyframes.empty() ) {
+        _curveSamples.clear();
+        _curveSamplesValid = false;
+    } else {
+        CurveSamplingKey key;
+        key.origin = widgetOrigin;
+        key.unit = widgetUnit;
+        key.widgetWidth = _curveWidget->width();
+        key.keyframes = keyframes;
+        key.isPeriodic = isPeriodic;
+        key.parametricRange = parametricRange;
+        key.yRange = getCurveYRange();
+        if ( !_curveSamplesValid || !(key == _curveSamplesKey) ) {
+            computeCurveSamples(keyframes, isPeriodic, parametricRange, &_curveSamples);
+            _curveSamplesKey = key;
+            _curveSamplesValid = true;
         }
     }
+    const std::vector<float>& vertices = _curveSamples;
+    const std::vector<float>& exprVertices = _exprSamples;
 
     QPointF btmLeft = _curveWidget->toZoomCoordinates(0, _curveWidget->height() - 1);
     QPointF topRight = _curveWidget->toZoomCoordinates(_curveWidget->width() - 1, 0);
@@ -645,6 +878,7 @@ KnobCurveGui::~KnobCurveGui()
 void
 KnobCurveGui::onKnobInternalCurveChanged()
 {
+    invalidateSamples();
     _curveWidget->updateSelectionAfterCurveChange(this);
     _curveWidget->update();
 }
@@ -652,6 +886,7 @@ KnobCurveGui::onKnobInternalCurveChanged()
 void
 KnobCurveGui::onKnobInterpolationChanged()
 {
+    invalidateSamples();
     _curveWidget->updateSelectionAfterCurveChange(this);
     _curveWidget->update();
 }
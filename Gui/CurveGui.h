@@ -35,10 +35,15 @@
 CLANG_DIAG_OFF(deprecated)
 CLANG_DIAG_OFF(uninitialized)
 #include <QtCore/QObject> // QObject
+#include <QtCore/QPointF>
+#include <QFutureWatcher>
 #include <QtGui/QColor> // QColor
 CLANG_DIAG_ON(deprecated)
 CLANG_DIAG_ON(uninitialized)
 
+#include <string>
+#include <vector>
+
 #include "Engine/Curve.h" // Curve
 
 #include "Gui/CurveGui.h" // Curves
@@ -134,8 +139,77 @@ public:
     virtual int getKeyFrameIndex(double time) const = 0;
     virtual KeyFrame setKeyFrameInterpolation(KeyframeTypeEnum interp, int index) = 0;
 
+    /**
+     * @brief Forces the sampled vertices of the curve to be recomputed on the next redraw.
+     **/
+    void invalidateSamples();
+
+public Q_SLOTS:
+
+    void onExpressionSamplesComputed();
+
 private:
 
+    /**
+     * @brief Everything the vertices sampled from the keyframes depend on. If none of it changed since the previous
+     * redraw, the cached vertices are drawn again without evaluating the curve.
+     **/
+    struct CurveSamplingKey
+    {
+        QPointF origin, unit; // widget coordinates of the (0,0) and (1,1) curve coordinates
+        int widgetWidth;
+        KeyFrameSet keyframes;
+        bool isPeriodic;
+        std::pair<double, double> parametricRange;
+        Curve::YRange yRange;
+
+        CurveSamplingKey()
+            : origin()
+            , unit()
+            , widgetWidth(0)
+            , keyframes()
+            , isPeriodic(false)
+            , parametricRange()
+            , yRange(0., 0.)
+        {
+        }
+
+        bool operator==(const CurveSamplingKey& other) const;
+    };
+
+    /**
+     * @brief Same as CurveSamplingKey for the curve produced by the expression of the knob. The expression
+     * may depend on any parameter of the node, hence the knobs age, and on parameters of other nodes,
+     * hence the age of the expression dependencies.
+     **/
+    struct ExpressionSamplingKey
+    {
+        QPointF origin, unit;
+        int widgetWidth;
+        std::string expression;
+        U64 knobsAge;
+        U64 dependenciesAge;
+
+        ExpressionSamplingKey()
+            : origin()
+            , unit()
+            , widgetWidth(0)
+            , expression()
+            , knobsAge(0)
+            , dependenciesAge(0)
+        {
+        }
+
+        bool operator==(const ExpressionSamplingKey& other) const;
+    };
+
+    void computeCurveSamples(const KeyFrameSet& keyframes,
+                             bool isPeriodic,
+                             const std::pair<double, double>& parametricRange,
+                             std::vector<float>* vertices);
+
+    void requestExpressionSamples(const KnobIPtr& knob, int dimension, const ExpressionSamplingKey& key);
+
     void nextPointForSegment(const double x,
                              const KeyFrameSet & keyframes,
                              const bool isPeriodic,
@@ -158,6 +232,19 @@ private:
     int _thickness; /// its thickness
     bool _visible; /// should we draw this curve ?
     bool _selected; /// is this curve selected
+
+    // Vertices of the curve (in curve coordinates) drawn by the last call to drawCurve
+    CurveSamplingKey _curveSamplesKey;
+    bool _curveSamplesValid;
+    std::vector<float> _curveSamples;
+
+    // Vertices of the expression curve. They are computed in a separate thread since the expression
+    // may be a Python script: until the computation ends, the previous samples are drawn.
+    ExpressionSamplingKey _exprSamplesKey;
+    bool _exprSamplesValid;
+    std::vector<float> _exprSamples;
+    ExpressionSamplingKey _exprSamplesComputingKey;
+    boost::shared_ptr<QFutureWatcher<std::vector<float> > > _exprSamplesWatcher;
 };
 
 typedef std::list<CurveGuiPtr> Curves;
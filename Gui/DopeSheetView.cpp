@@ -25,7 +25,9 @@
 #include "DopeSheetView.h"
 
 #include <algorithm> // min, max
+#include <cmath>
 #include <limits>
+#include <set>
 #include <stdexcept>
 
 // Qt includes
@@ -216,11 +218,33 @@ public:
     void drawRange(const DSNodePtr &dsNode) const;
     void drawKeyframes(const DSNodePtr &dsNode) const;
 
-    void drawTexturedKeyframe(DopeSheetViewPrivate::KeyframeTexture textureType,
-                              bool drawTime,
-                              double time,
-                              const QColor& textColor,
-                              const RectD &rect) const;
+    /**
+     * @brief Keyframe icons to draw, grouped by texture so that each texture is drawn with a single call
+     **/
+    struct KeyframeBatch
+    {
+        std::vector<GLfloat> vertices[KF_TEXTURES_COUNT];
+        std::vector<GLfloat> texCoords[KF_TEXTURES_COUNT];
+
+        // The keyframes next to which the selected time is written
+        std::vector<RectD> timeLabels;
+    };
+
+    int keyframePixelColumn(double time) const;
+
+    void addMasterKeyframesToBatch(const std::map<double, bool>& keyTimes,
+                                   QTreeWidgetItem* item,
+                                   bool drawSelectedTime,
+                                   KeyframeBatch* batch) const;
+
+    void addKeyframeToBatch(DopeSheetViewPrivate::KeyframeTexture textureType,
+                            bool drawTime,
+                            const RectD &rect,
+                            KeyframeBatch* batch) const;
+
+    void drawKeyframeBatch(const KeyframeBatch& batch,
+                           double time,
+                           const QColor& textColor) const;
 
     void drawGroupOverlay(const DSNodePtr &dsNode, const DSNodePtr &group) const;
 
@@ -1246,7 +1270,9 @@ DopeSheetViewPrivate::drawRange(const DSNodePtr &dsNode) const
 /**
  * @brief DopeSheetViewPrivate::drawKeyframes
  *
- *
+ * Only the keyframes in the visible time range are fetched from the curves, and keyframes falling in the same
+ * pixel column of a row are drawn once, so that the cost does not depend on the number of keyframes when
+ * zoomed out (e.g trackers with a keyframe at each frame).
  */
 void
 DopeSheetViewPrivate::drawKeyframes(const DSNodePtr &dsNode) const
@@ -1259,183 +1285,223 @@ DopeSheetViewPrivate::drawKeyframes(const DSNodePtr &dsNode) const
     QColor selectionColor;
     selectionColor.setRgbF(selectionColorRGB[0], selectionColorRGB[1], selectionColorRGB[2]);
 
-    // Perform drawing
+    const DSTreeItemKnobMap& knobItems = dsNode->getItemKnobMap();
+    double kfTimeSelected;
+    int hasSingleKfTimeSelected = model->getSelectionModel()->hasSingleKeyFrameTimeSelected(&kfTimeSelected);
+    std::map<double, bool> nodeKeytimes;
+    std::map<DSKnob *, std::map<double, bool> > knobsKeytimes;
+
+    // Index the selected keyframes by row, DopeSheetSelectionModel::keyframeIsSelected() is linear in the selection size
+    std::map<DSKnob *, std::set<double> > selectedKeytimes;
     {
-        GLProtectAttrib a(GL_CURRENT_BIT | GL_COLOR_BUFFER_BIT | GL_ENABLE_BIT);
+        DopeSheetKeyPtrList selectedKeys;
+        std::vector<DSNodePtr> selectedNodes;
+        model->getSelectionModel()->getCurrentSelection(&selectedKeys, &selectedNodes);
+        for (DopeSheetKeyPtrList::const_iterator it = selectedKeys.begin(); it != selectedKeys.end(); ++it) {
+            DSKnobPtr knobContext = (*it)->context.lock();
+            if (knobContext) {
+                selectedKeytimes[knobContext.get()].insert( (*it)->key.getTime() );
+            }
+        }
+    }
 
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    KeyframeBatch batch;
+    std::vector<KeyFrame> keyframes;
 
-        const DSTreeItemKnobMap& knobItems = dsNode->getItemKnobMap();
-        double kfTimeSelected;
-        int hasSingleKfTimeSelected = model->getSelectionModel()->hasSingleKeyFrameTimeSelected(&kfTimeSelected);
-        std::map<double, bool> nodeKeytimes;
-        std::map<DSKnob *, std::map<double, bool> > knobsKeytimes;
+    for (DSTreeItemKnobMap::const_iterator it = knobItems.begin();
+         it != knobItems.end();
+         ++it) {
+        DSKnobPtr dsKnob = (*it).second;
+        QTreeWidgetItem *knobTreeItem = dsKnob->getTreeItem();
 
-        for (DSTreeItemKnobMap::const_iterator it = knobItems.begin();
-             it != knobItems.end();
-             ++it) {
-            DSKnobPtr dsKnob = (*it).second;
-            QTreeWidgetItem *knobTreeItem = dsKnob->getTreeItem();
+        // The knob is no longer animated
+        if ( knobTreeItem->isHidden() ) {
+            continue;
+        }
 
-            // The knob is no longer animated
-            if ( knobTreeItem->isHidden() ) {
-                continue;
-            }
+        int dim = dsKnob->getDimension();
 
-            int dim = dsKnob->getDimension();
+        if (dim == -1) {
+            continue;
+        }
 
-            if (dim == -1) {
-                continue;
-            }
+        // Clip keyframes horizontally //TODO Clip vertically too
+        keyframes.clear();
+        dsKnob->getKnobGui()->getCurve(ViewIdx(0), dim)->getKeyFramesInRange(zoomContext.left(), zoomContext.right(), &keyframes);
+        if ( keyframes.empty() ) {
+            continue;
+        }
 
-            KeyFrameSet keyframes = dsKnob->getKnobGui()->getCurve(ViewIdx(0), dim)->getKeyFrames_mt_safe();
+        std::map<DSKnob *, std::set<double> >::const_iterator foundSelected = selectedKeytimes.find( dsKnob.get() );
+        const std::set<double>* knobSelectedTimes = ( foundSelected != selectedKeytimes.end() ) ? &foundSelected->second : 0;
 
-            for (KeyFrameSet::const_iterator kIt = keyframes.begin();
-                 kIt != keyframes.end();
-                 ++kIt) {
-                KeyFrame kf = (*kIt);
-                double keyTime = kf.getTime();
+        // Draw keyframe in the knob dim row only if it's visible
+        bool drawInDimRow = hierarchyView->itemIsVisibleFromOutside(knobTreeItem);
+        double rowCenterYWidget = drawInDimRow ? hierarchyView->visualItemRect(knobTreeItem).center().y() : 0.;
+
+        DSKnobPtr rootDSKnob = model->mapNameItemToDSKnob( knobTreeItem->parent() );
+        std::map<double, bool>* knobTimes = rootDSKnob ? &knobsKeytimes[rootDSKnob.get()] : 0;
 
-                // Clip keyframes horizontally //TODO Clip vertically too
-                if ( ( keyTime < zoomContext.left() ) || ( keyTime > zoomContext.right() ) ) {
+        // Only the last keyframe of each pixel column is drawn, as selected if any keyframe of the column is selected
+        bool columnSelected = false;
+        int column = keyframePixelColumn( keyframes.front().getTime() );
+        for (std::vector<KeyFrame>::const_iterator kIt = keyframes.begin(); kIt != keyframes.end(); ++kIt) {
+            const double keyTime = kIt->getTime();
+            if ( knobSelectedTimes && ( knobSelectedTimes->find(keyTime) != knobSelectedTimes->end() ) ) {
+                columnSelected = true;
+            }
+
+            std::vector<KeyFrame>::const_iterator next = kIt;
+            ++next;
+            if ( next != keyframes.end() ) {
+                int nextColumn = keyframePixelColumn( next->getTime() );
+                if (nextColumn == column) {
                     continue;
                 }
+                column = nextColumn;
+            }
 
-                double rowCenterYWidget = hierarchyView->visualItemRect( dsKnob->getTreeItem() ).center().y();
+            const bool kfSelected = columnSelected;
+            columnSelected = false;
+
+            if (drawInDimRow) {
                 RectD zoomKfRect = getKeyFrameBoundingRectZoomCoords(keyTime, rowCenterYWidget);
-                bool kfSelected = model->getSelectionModel()->keyframeIsSelected(dsKnob, kf);
+                DopeSheetViewPrivate::KeyframeTexture texType = kfTextureFromKeyframeType( kIt->getInterpolation(),
+                                                                                           kfSelected || selectionRect.intersects(zoomKfRect) );
 
-                // Draw keyframe in the knob dim row only if it's visible
-                bool drawInDimRow = hierarchyView->itemIsVisibleFromOutside(knobTreeItem);
+                if (texType != DopeSheetViewPrivate::kfTextureNone) {
+                    addKeyframeToBatch(texType, hasSingleKfTimeSelected && kfSelected, zoomKfRect, &batch);
+                }
+            }
 
-                if (drawInDimRow) {
-                    DopeSheetViewPrivate::KeyframeTexture texType = kfTextureFromKeyframeType( kf.getInterpolation(),
-                                                                                               kfSelected || selectionRect.intersects(zoomKfRect) );
+            // Fill the knob times map
+            if (knobTimes) {
+                bool& knobTimeIsSelected = knobTimes->insert( std::make_pair(keyTime, false) ).first->second;
+                knobTimeIsSelected = knobTimeIsSelected || kfSelected;
+            }
 
-                    if (texType != DopeSheetViewPrivate::kfTextureNone) {
-                        drawTexturedKeyframe(texType, hasSingleKfTimeSelected && kfSelected,
-                                             kfTimeSelected, selectionColor, zoomKfRect);
-                    }
-                }
+            // Fill the node times map
+            bool& nodeTimeIsSelected = nodeKeytimes.insert( std::make_pair(keyTime, false) ).first->second;
+            nodeTimeIsSelected = nodeTimeIsSelected || kfSelected;
+        }
+    }
 
-                // Fill the knob times map
-                {
-                    DSKnobPtr rootDSKnob = model->mapNameItemToDSKnob( knobTreeItem->parent() );
-                    if (rootDSKnob) {
-                        assert(rootDSKnob);
-                        const std::map<double, bool>& map = knobsKeytimes[rootDSKnob.get()];
-                        bool knobTimeExists = ( map.find(keyTime) != map.end() );
-
-                        if (!knobTimeExists) {
-                            knobsKeytimes[rootDSKnob.get()][keyTime] = kfSelected;
-                        } else {
-                            bool knobTimeIsSelected = knobsKeytimes[rootDSKnob.get()][keyTime];
-
-                            if (!knobTimeIsSelected && kfSelected) {
-                                knobsKeytimes[rootDSKnob.get()][keyTime] = true;
-                            }
-                        }
-                    }
-                }
+    // Draw master keys in knob root section
+    for (std::map<DSKnob *, std::map<double, bool> >::const_iterator it = knobsKeytimes.begin();
+         it != knobsKeytimes.end();
+         ++it) {
+        addMasterKeyframesToBatch(it->second, it->first->getTreeItem(), hasSingleKfTimeSelected, &batch);
+    }
 
-                // Fill the node times map
-                bool nodeTimeExists = ( nodeKeytimes.find(keyTime) != nodeKeytimes.end() );
+    // Draw master keys in node section
+    addMasterKeyframesToBatch(nodeKeytimes, dsNode->getTreeItem(), hasSingleKfTimeSelected, &batch);
 
-                if (!nodeTimeExists) {
-                    nodeKeytimes[keyTime] = kfSelected;
-                } else {
-                    bool nodeTimeIsSelected = nodeKeytimes[keyTime];
+    drawKeyframeBatch(batch, kfTimeSelected, selectionColor);
+} // DopeSheetViewPrivate::drawKeyframes
 
-                    if (!nodeTimeIsSelected && kfSelected) {
-                        nodeKeytimes[keyTime] = true;
-                    }
-                }
-            }
-        }
+int
+DopeSheetViewPrivate::keyframePixelColumn(double time) const
+{
+    return (int)std::floor( zoomContext.toWidgetCoordinates(time, 0).x() );
+}
 
-        // Draw master keys in knob root section
-        for (std::map<DSKnob *, std::map<double, bool> >::const_iterator it = knobsKeytimes.begin();
-             it != knobsKeytimes.end();
-             ++it) {
-            QTreeWidgetItem *knobRootItem = (*it).first->getTreeItem();
-            std::map<double, bool> knobTimes = (*it).second;
-
-            for (std::map<double, bool>::const_iterator mIt = knobTimes.begin();
-                 mIt != knobTimes.end();
-                 ++mIt) {
-                double time = (*mIt).first;
-                bool drawSelected = (*mIt).second;
-                bool drawInKnobRootRow = hierarchyView->itemIsVisibleFromOutside(knobRootItem);
-
-                if (drawInKnobRootRow) {
-                    double newCenterY = hierarchyView->visualItemRect(knobRootItem).center().y();
-                    RectD zoomKfRect = getKeyFrameBoundingRectZoomCoords(time, newCenterY);
-                    DopeSheetViewPrivate::KeyframeTexture textureType = (drawSelected)
-                                                                        ? DopeSheetViewPrivate::kfTextureMasterSelected
-                                                                        : DopeSheetViewPrivate::kfTextureMaster;
-
-                    drawTexturedKeyframe(textureType, hasSingleKfTimeSelected && drawSelected,
-                                         kfTimeSelected, selectionColor, zoomKfRect);
-                }
-            }
-        }
+void
+DopeSheetViewPrivate::addMasterKeyframesToBatch(const std::map<double, bool>& keyTimes,
+                                                QTreeWidgetItem* item,
+                                                bool drawSelectedTime,
+                                                KeyframeBatch* batch) const
+{
+    if ( keyTimes.empty() || !hierarchyView->itemIsVisibleFromOutside(item) ) {
+        return;
+    }
 
-        // Draw master keys in node section
-        for (std::map<double, bool>::const_iterator it = nodeKeytimes.begin();
-             it != nodeKeytimes.end();
-             ++it) {
-            double time = (*it).first;
-            bool drawSelected = (*it).second;
-            QTreeWidgetItem *nodeItem = dsNode->getTreeItem();
-            bool drawInNodeRow = hierarchyView->itemIsVisibleFromOutside(nodeItem);
-
-            if (drawInNodeRow) {
-                double newCenterY = hierarchyView->visualItemRect(nodeItem).center().y();
-                RectD zoomKfRect = getKeyFrameBoundingRectZoomCoords(time, newCenterY);
-                DopeSheetViewPrivate::KeyframeTexture textureType = (drawSelected)
-                                                                    ? DopeSheetViewPrivate::kfTextureMasterSelected
-                                                                    : DopeSheetViewPrivate::kfTextureMaster;
-
-                drawTexturedKeyframe(textureType, hasSingleKfTimeSelected && drawSelected,
-                                     kfTimeSelected, selectionColor, zoomKfRect);
+    double newCenterY = hierarchyView->visualItemRect(item).center().y();
+    bool columnSelected = false;
+    int column = keyframePixelColumn(keyTimes.begin()->first);
+    for (std::map<double, bool>::const_iterator it = keyTimes.begin(); it != keyTimes.end(); ++it) {
+        columnSelected = columnSelected || it->second;
+
+        std::map<double, bool>::const_iterator next = it;
+        ++next;
+        if ( next != keyTimes.end() ) {
+            int nextColumn = keyframePixelColumn(next->first);
+            if (nextColumn == column) {
+                continue;
             }
+            column = nextColumn;
         }
+
+        RectD zoomKfRect = getKeyFrameBoundingRectZoomCoords(it->first, newCenterY);
+        DopeSheetViewPrivate::KeyframeTexture textureType = (columnSelected)
+                                                            ? DopeSheetViewPrivate::kfTextureMasterSelected
+                                                            : DopeSheetViewPrivate::kfTextureMaster;
+        addKeyframeToBatch(textureType, drawSelectedTime && columnSelected, zoomKfRect, batch);
+        columnSelected = false;
     }
-} // DopeSheetViewPrivate::drawKeyframes
+}
 
 void
-DopeSheetViewPrivate::drawTexturedKeyframe(DopeSheetViewPrivate::KeyframeTexture textureType,
-                                           bool drawTime,
-                                           double time,
-                                           const QColor& textColor,
-                                           const RectD &rect) const
+DopeSheetViewPrivate::addKeyframeToBatch(DopeSheetViewPrivate::KeyframeTexture textureType,
+                                         bool drawTime,
+                                         const RectD &rect,
+                                         KeyframeBatch* batch) const
 {
-    GLProtectAttrib a(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_CURRENT_BIT | GL_TRANSFORM_BIT);
-    GLProtectMatrix pr(GL_MODELVIEW);
+    std::vector<GLfloat>& vertices = batch->vertices[textureType];
+    std::vector<GLfloat>& texCoords = batch->texCoords[textureType];
+    const GLfloat quadTexCoords[8] = { 0.f, 1.f, 0.f, 0.f, 1.f, 0.f, 1.f, 1.f };
+    const GLfloat quadVertices[8] = {
+        (GLfloat)rect.left(), (GLfloat)rect.top(),
+        (GLfloat)rect.left(), (GLfloat)rect.bottom(),
+        (GLfloat)rect.right(), (GLfloat)rect.bottom(),
+        (GLfloat)rect.right(), (GLfloat)rect.top()
+    };
 
-    glEnable(GL_TEXTURE_2D);
-    glBindTexture(GL_TEXTURE_2D, kfTexturesIDs[textureType]);
+    vertices.insert(vertices.end(), quadVertices, quadVertices + 8);
+    texCoords.insert(texCoords.end(), quadTexCoords, quadTexCoords + 8);
 
-    glBegin(GL_POLYGON);
-    glTexCoord2f(0.0f, 1.0f);
-    glVertex2f( rect.left(), rect.top() );
-    glTexCoord2f(0.0f, 0.0f);
-    glVertex2f( rect.left(), rect.bottom() );
-    glTexCoord2f(1.0f, 0.0f);
-    glVertex2f( rect.right(), rect.bottom() );
-    glTexCoord2f(1.0f, 1.0f);
-    glVertex2f( rect.right(), rect.top() );
-    glEnd();
+    if (drawTime) {
+        batch->timeLabels.push_back(rect);
+    }
+}
 
-    glColor4f(1, 1, 1, 1);
-    glBindTexture(GL_TEXTURE_2D, 0);
+void
+DopeSheetViewPrivate::drawKeyframeBatch(const KeyframeBatch& batch,
+                                        double time,
+                                        const QColor& textColor) const
+{
+    {
+        GLProtectAttrib a(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_CURRENT_BIT | GL_TRANSFORM_BIT);
+        GLProtectMatrix pr(GL_MODELVIEW);
 
-    glDisable(GL_TEXTURE_2D);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glEnable(GL_TEXTURE_2D);
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 
-    if (drawTime) {
+        for (int i = 0; i < KF_TEXTURES_COUNT; ++i) {
+            const std::vector<GLfloat>& vertices = batch.vertices[i];
+            if ( vertices.empty() ) {
+                continue;
+            }
+            glBindTexture(GL_TEXTURE_2D, kfTexturesIDs[i]);
+            glVertexPointer(2, GL_FLOAT, 0, &vertices.front());
+            glTexCoordPointer(2, GL_FLOAT, 0, &batch.texCoords[i].front());
+            glDrawArrays(GL_QUADS, 0, (GLsizei)(vertices.size() / 2));
+        }
+
+        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+        glDisableClientState(GL_VERTEX_ARRAY);
+        glColor4f(1, 1, 1, 1);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glDisable(GL_TEXTURE_2D);
+        glCheckError();
+    }
+
+    for (std::vector<RectD>::const_iterator it = batch.timeLabels.begin(); it != batch.timeLabels.end(); ++it) {
         QString text = QString::number(time);
-        QPointF p = zoomContext.toWidgetCoordinates( rect.right(), rect.bottom() );
+        QPointF p = zoomContext.toWidgetCoordinates( it->right(), it->bottom() );
         p.rx() += 3;
         p = zoomContext.toZoomCoordinates( p.x(), p.y() );
         renderText(p.x(), p.y(), text, textColor, *font);
@@ -743,6 +743,24 @@ Edge::isNearbyBendPoint(const QPointF & scenePoint)
     return false;
 }
 
+void
+Edge::getCurrentColors(QColor* lineColor,
+                       QColor* arrowColor) const
+{
+    if (_imp->useSelected) {
+        *lineColor = *arrowColor = Qt::white;
+    } else if (_imp->useHighlight) {
+        *lineColor = *arrowColor = Qt::green;
+    } else if (_imp->useRenderingColor) {
+        *lineColor = *arrowColor = _imp->renderingColor;
+    } else {
+        *lineColor = *arrowColor = _imp->defaultColor;
+        if (_imp->optional && !_imp->paintWithDash) {
+            lineColor->setAlphaF(0.4);
+        }
+    }
+}
+
 void
 Edge::paint(QPainter *painter,
             const QStyleOptionGraphicsItem * /*options*/,
@@ -762,6 +780,13 @@ Edge::paint(QPainter *painter,
         }
     }
 
+    // In low detail mode, all edges are drawn at once by the NodeGraph
+    NodeGuiPtr owner = dst ? dst : _imp->source.lock();
+    NodeGraph* graph = owner ? owner->getDagGui() : 0;
+    if ( graph && graph->isLowDetailMode() ) {
+        return;
+    }
+
     if (_imp->paintWithDash) {
         QVector<qreal> dashStyle;
         qreal space = 4;
@@ -772,18 +797,7 @@ Edge::paint(QPainter *painter,
     }
 
     QColor color, arrowColor;
-    if (_imp->useSelected) {
-        color = arrowColor = Qt::white;
-    } else if (_imp->useHighlight) {
-        color = arrowColor = Qt::green;
-    } else if (_imp->useRenderingColor) {
-        color = arrowColor = _imp->renderingColor;
-    } else {
-        color = arrowColor = _imp->defaultColor;
-        if (_imp->optional && !_imp->paintWithDash) {
-            color.setAlphaF(0.4);
-        }
-    }
+    getCurrentColors(&color, &arrowColor);
     myPen.setColor(color);
     painter->setPen(myPen);
 
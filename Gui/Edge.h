@@ -124,6 +124,11 @@ public:
 
     bool computeVisibility(bool hovered) const;
 
+    /**
+     * @brief Returns the colors of the line and the arrow head, depending on the selection, highlight and rendering state.
+     **/
+    void getCurrentColors(QColor* lineColor, QColor* arrowColor) const;
+
 private:
 
     virtual void paint(QPainter *painter, const QStyleOptionGraphicsItem *options, QWidget *parent = 0) OVERRIDE FINAL;
@@ -148,6 +148,9 @@ PasteUndoCommand::copyFrom(const KnobIPtr& serializedKnob,
                            bool isRedo)
 {
     KnobIPtr internalKnob = _imp->knob.lock()->getKnob();
+    KnobHolder* knobHolder = internalKnob->getHolder();
+    // Evaluate and render once for all the dimensions pasted
+    ChangeTransaction_RAII transaction( knobHolder ? knobHolder->getApp() : AppInstancePtr() );
 
     switch (_imp->type) {
     case eKnobClipBoardTypeCopyAnim: {
@@ -309,6 +312,8 @@ MultipleKnobEditsUndoCommand::undo()
 {
     assert( !knobs.empty() );
     KnobHolder* holder = knobs.begin()->first.lock()->getKnob()->getHolder();
+    // Run the knobChanged handlers once per knob and render once for all the edits
+    ChangeTransaction_RAII transaction( holder ? holder->getApp() : AppInstancePtr() );
     if (holder) {
         holder->beginChanges();
     }
@@ -384,6 +389,8 @@ MultipleKnobEditsUndoCommand::redo()
 {
     assert( !knobs.empty() );
     KnobHolder* holder = knobs.begin()->first.lock()->getKnob()->getHolder();
+    // Run the knobChanged handlers once per knob and render once for all the edits
+    ChangeTransaction_RAII transaction( holder ? holder->getApp() : AppInstancePtr() );
     if (holder) {
         holder->beginChanges();
     }
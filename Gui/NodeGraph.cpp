@@ -112,7 +112,7 @@ NodeGraph::NodeGraph(Gui* gui,
 
 
     setMouseTracking(true);
-    setCacheMode(CacheBackground);
+    // The background is not cached since edges are drawn in drawBackground() in low detail mode
     setViewportUpdateMode(QGraphicsView::BoundingRectViewportUpdate);
     setRenderHint(QPainter::Antialiasing);
     setTransformationAnchor(QGraphicsView::AnchorUnderMouse);
@@ -264,6 +264,7 @@ NodeGraph::onNodesCleared()
     _imp->_selection.clear();
     _imp->_magnifiedNode.reset();
     _imp->_undoStack->clear();
+    _imp->spatialIndex.clear();
 }
 
 void
@@ -296,6 +297,10 @@ NodeGraph::paintEvent(QPaintEvent* e)
 
     bool drawLockedMode = !isGroupEditable || !groupEdited;
 
+    // The zoom factor may have been changed by scale() in many places, update the level of detail before items get painted
+    double zoomFactor = transform().mapRect( QRectF(0, 0, 1, 1) ).width();
+    _imp->lowDetailMode = zoomFactor < NATRON_NODEGRAPH_LOW_DETAIL_ZOOM_FACTOR;
+
     if (_imp->_refreshOverlays) {
         ///The visible portion of the scene, in scene coordinates
         QRectF visibleScene = visibleSceneRect();
@@ -353,6 +358,61 @@ NodeGraph::paintEvent(QPaintEvent* e)
     }
 } // NodeGraph::paintEvent
 
+typedef std::map<QRgb, QVector<QLineF> > EdgeLinesPerColorMap;
+
+static void
+appendEdgeLine(Edge* edge,
+               const QRectF& rect,
+               EdgeLinesPerColorMap* linesPerColor)
+{
+    if ( !edge || !edge->isVisible() ) {
+        return;
+    }
+    QLineF line = edge->line();
+    QLineF sceneLine( edge->mapToScene( line.p1() ), edge->mapToScene( line.p2() ) );
+    if ( !QRectF( sceneLine.p1(), sceneLine.p2() ).normalized().adjusted(-1, -1, 1, 1).intersects(rect) ) {
+        return;
+    }
+    QColor color, arrowColor;
+    edge->getCurrentColors(&color, &arrowColor);
+    (*linesPerColor)[color.rgba()].push_back(sceneLine);
+}
+
+void
+NodeGraph::drawBackground(QPainter* painter,
+                          const QRectF& rect)
+{
+    QGraphicsView::drawBackground(painter, rect);
+
+    if (!_imp->lowDetailMode) {
+        return;
+    }
+
+    // In low detail mode edges do not paint themselves: they are drawn here as plain lines, with one call per color,
+    // which is much cheaper than painting thousands of items with their arrow heads.
+    EdgeLinesPerColorMap linesPerColor;
+    {
+        QMutexLocker l(&_imp->_nodesMutex);
+        for (NodesGuiList::const_iterator it = _imp->_nodes.begin(); it != _imp->_nodes.end(); ++it) {
+            const std::vector<Edge*>& inputEdges = (*it)->getInputsArrows();
+            for (std::vector<Edge*>::const_iterator it2 = inputEdges.begin(); it2 != inputEdges.end(); ++it2) {
+                appendEdgeLine(*it2, rect, &linesPerColor);
+            }
+            appendEdgeLine( (*it)->getOutputArrow(), rect, &linesPerColor );
+        }
+    }
+
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing, false);
+    for (EdgeLinesPerColorMap::const_iterator it = linesPerColor.begin(); it != linesPerColor.end(); ++it) {
+        QPen pen( QColor::fromRgba(it->first) );
+        pen.setCosmetic(true);
+        painter->setPen(pen);
+        painter->drawLines(it->second);
+    }
+    painter->restore();
+} // NodeGraph::drawBackground
+
 QRectF
 NodeGraph::visibleSceneRect() const
 {
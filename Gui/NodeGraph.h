@@ -173,6 +173,25 @@ public:
 
     bool isDoingNavigatorRender() const;
 
+    /**
+     * @brief Updates the bounding box of the node in the spatial index of the graph, or removes the node
+     * from the index if it has no parent item anymore.
+     * This is called by NodeGui::itemChange() when the node moves and by NodeGui::resize().
+     **/
+    void refreshNodeSpatialIndex(NodeGui* node);
+
+    /**
+     * @brief Returns the nodes whose bounding box intersects the given rectangle in scene coordinates.
+     * This does not check whether the nodes are visible.
+     **/
+    void getNodesWithinSceneRect(const QRectF& sceneRect, std::set<NodeGui*>* nodes) const;
+
+    /**
+     * @brief Returns true when the graph is zoomed out so much that text, icons and previews of the nodes
+     * are not drawn and edges are drawn as plain lines all at once.
+     **/
+    bool isLowDetailMode() const;
+
 public Q_SLOTS:
 
     void deleteSelection();
@@ -270,6 +289,7 @@ private:
     virtual void mouseDoubleClickEvent(QMouseEvent* e) OVERRIDE FINAL;
     virtual void resizeEvent(QResizeEvent* e) OVERRIDE FINAL;
     virtual void paintEvent(QPaintEvent* e) OVERRIDE FINAL;
+    virtual void drawBackground(QPainter* painter, const QRectF& rect) OVERRIDE FINAL;
     virtual void wheelEvent(QWheelEvent* e) OVERRIDE FINAL;
     virtual void focusInEvent(QFocusEvent* e) OVERRIDE FINAL;
     virtual void focusOutEvent(QFocusEvent* e) OVERRIDE FINAL;
@@ -89,13 +89,7 @@ void
 NodeGraph::getNodesWithinViewportRect(const QRect& rect,
                                       std::set<NodeGui*>* nodes) const
 {
-    QList<QGraphicsItem*> selectedItems = items(rect, Qt::IntersectsItemShape);
-    for (QList<QGraphicsItem*>::Iterator it = selectedItems.begin(); it != selectedItems.end(); ++it) {
-        NodeGui* n = isNodeGuiChild(*it);
-        if (n) {
-            nodes->insert(n);
-        }
-    }
+    getNodesWithinSceneRect(mapToScene(rect).boundingRect(), nodes);
 }
 
 NodeGraph::NearbyItemEnum
@@ -454,12 +454,12 @@ NodeGraph::selectAllNodes(bool onlyInVisiblePortion)
 {
     _imp->resetSelection();
     if (onlyInVisiblePortion) {
-        QRectF r = visibleSceneRect();
-        for (NodesGuiList::iterator it = _imp->_nodes.begin(); it != _imp->_nodes.end(); ++it) {
-            QRectF bbox = (*it)->mapToScene( (*it)->boundingRect() ).boundingRect();
-            if ( r.intersects(bbox) && (*it)->isActive() && (*it)->isVisible() ) {
+        std::set<NodeGui*> nodesInRect;
+        getNodesWithinSceneRect(visibleSceneRect(), &nodesInRect);
+        for (std::set<NodeGui*>::iterator it = nodesInRect.begin(); it != nodesInRect.end(); ++it) {
+            if ( (*it)->isActive() && (*it)->isVisible() ) {
                 (*it)->setUserSelected(true);
-                _imp->_selection.push_back(*it);
+                _imp->_selection.push_back( (*it)->shared_from_this() );
             }
         }
     } else {
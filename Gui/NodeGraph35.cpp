@@ -38,6 +38,7 @@ GCC_DIAG_UNUSED_PRIVATE_FIELD_ON
 CLANG_DIAG_ON(deprecated)
 CLANG_DIAG_ON(uninitialized)
 
+#include "Engine/ImageBufferPool.h"
 #include "Engine/KnobSerialization.h" // createDefaultValueForParam
 #include "Engine/Node.h"
 #include "Engine/Project.h"
@@ -266,6 +267,12 @@ NodeGraph::updateCacheSizeText()
     if (newText != oldText) {
         _imp->_cacheSizeText->setText(newText);
     }
+
+    // The memory cache size includes the free image buffers kept for reuse
+    QString toolTip = ImageBufferPool::printStatistics( ImageBufferPool::getStatistics() );
+    if ( toolTip != _imp->_cacheSizeText->toolTip() ) {
+        _imp->_cacheSizeText->setToolTip(toolTip);
+    }
 }
 
 void
@@ -383,6 +383,8 @@ void
 NodeGraph::deleteNodePermanantly(const NodeGuiPtr& n)
 {
     assert(n);
+    _imp->spatialIndex.remove( n.get() );
+
     NodesGuiList::iterator it = std::find(_imp->_nodesTrash.begin(), _imp->_nodesTrash.end(), n);
 
     if ( it != _imp->_nodesTrash.end() ) {
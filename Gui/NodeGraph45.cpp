@@ -689,4 +689,31 @@ NodeGraph::getRootPos() const
     return _imp->_root->pos();
 }
 
+void
+NodeGraph::refreshNodeSpatialIndex(NodeGui* node)
+{
+    assert(node);
+    if ( !node->parentItem() ) {
+        // The node was taken out of the graph
+        _imp->spatialIndex.remove(node);
+
+        return;
+    }
+    // Use the coordinates of the parent of all nodes so that the index remains valid when the graph is panned
+    _imp->spatialIndex.insertOrUpdate( node, node->mapRectToItem( _imp->_nodeRoot, node->boundingRect() ) );
+}
+
+void
+NodeGraph::getNodesWithinSceneRect(const QRectF& sceneRect,
+                                   std::set<NodeGui*>* nodes) const
+{
+    _imp->spatialIndex.query(_imp->_nodeRoot->mapRectFromScene(sceneRect), nodes);
+}
+
+bool
+NodeGraph::isLowDetailMode() const
+{
+    return _imp->lowDetailMode;
+}
+
 NATRON_NAMESPACE_EXIT
@@ -60,6 +60,8 @@ NodeGraphPrivate::NodeGraphPrivate(NodeGraph* p,
     , _nodesMutex()
     , _nodes()
     , _nodesTrash()
+    , spatialIndex()
+    , lowDetailMode(false)
     , _nodeCreationShortcutEnabled(false)
     , _lastNodeCreatedName()
     , _root(NULL)
@@ -121,16 +123,23 @@ NodeGraphPrivate::editSelectionFromSelectionRectangle(bool addToSelection)
     }
 
     const QRectF& selection = _selectionRect;
+    std::set<NodeGui*> nodesInRect;
 
-    for (NodesGuiList::iterator it = _nodes.begin(); it != _nodes.end(); ++it) {
+    _publicInterface->getNodesWithinSceneRect(selection, &nodesInRect);
+    for (std::set<NodeGui*>::iterator it = nodesInRect.begin(); it != nodesInRect.end(); ++it) {
+        // Nodes in the trash are hidden
+        if ( !(*it)->isVisible() ) {
+            continue;
+        }
         QRectF bbox = (*it)->mapToScene( (*it)->boundingRect() ).boundingRect();
         if ( selection.contains(bbox) ) {
-            NodesGuiList::iterator foundInSel = std::find(_selection.begin(), _selection.end(), *it);
+            NodeGuiPtr node = (*it)->shared_from_this();
+            NodesGuiList::iterator foundInSel = std::find(_selection.begin(), _selection.end(), node);
             if ( foundInSel != _selection.end() ) {
                 continue;
             }
 
-            _selection.push_back(*it);
+            _selection.push_back(node);
             (*it)->setUserSelected(true);
         }
     }
@@ -52,6 +52,7 @@ CLANG_DIAG_OFF(uninitialized)
 CLANG_DIAG_ON(deprecated)
 CLANG_DIAG_ON(uninitialized)
 
+#include "Gui/NodeGraphSpatialIndex.h"
 #include "Gui/NodeGraphUndoRedo.h" // NodeGuiPtr
 #include "Gui/GuiFwd.h"
 
@@ -68,6 +69,9 @@ CLANG_DIAG_ON(uninitialized)
 #define NATRON_SCENE_MAX 1e6
 #define NATRON_SCENE_MIN 0
 
+///Below this zoom factor, the graph is drawn in low detail mode (see NodeGraph::isLowDetailMode())
+#define NATRON_NODEGRAPH_LOW_DETAIL_ZOOM_FACTOR 0.3
+
 NATRON_NAMESPACE_ENTER
 
 enum EventStateEnum
@@ -171,6 +175,12 @@ public:
     NodesGuiList _nodes;
     NodesGuiList _nodesTrash;
 
+    ///Bounding boxes of the nodes, in _nodeRoot coordinates. Only accessed on the main-thread
+    NodeGraphSpatialIndex spatialIndex;
+
+    ///Set in paintEvent according to the current zoom factor
+    bool lowDetailMode;
+
     ///Enables the "Tab" shortcut to popup the node creation dialog.
     ///This is set to true on enterEvent and set back to false on leaveEvent
     bool _nodeCreationShortcutEnabled;
@@ -26,6 +26,7 @@
 #include "NodeGraphRectItem.h"
 
 #include <QPainter>
+#include <QStyleOptionGraphicsItem>
 
 NATRON_NAMESPACE_ENTER
 
@@ -41,7 +42,12 @@ NodeGraphRectItem::paint(QPainter *painter, const QStyleOptionGraphicsItem* /*op
 {
     painter->setPen(pen());
     painter->setBrush(brush());
-    painter->drawRoundedRect(rect(), _cornerRadiusPx, _cornerRadiusPx);
+    // When zoomed out, the rounded corners are smaller than a pixel: draw a plain rectangle which is much cheaper
+    if (_cornerRadiusPx * QStyleOptionGraphicsItem::levelOfDetailFromTransform( painter->worldTransform() ) < 1.) {
+        painter->drawRect( rect() );
+    } else {
+        painter->drawRoundedRect(rect(), _cornerRadiusPx, _cornerRadiusPx);
+    }
 }
 
 NATRON_NAMESPACE_EXIT
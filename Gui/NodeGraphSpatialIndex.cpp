@@ -0,0 +1,162 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "NodeGraphSpatialIndex.h"
+
+#include <cmath>
+
+// Size of a cell of the grid, in scene units. A default node is about 80x30.
+#define NODEGRAPH_SPATIAL_INDEX_CELL_SIZE 256.
+
+NATRON_NAMESPACE_ENTER
+
+NodeGraphSpatialIndex::NodeGraphSpatialIndex()
+    : _cells()
+    , _rects()
+{
+}
+
+NodeGraphSpatialIndex::~NodeGraphSpatialIndex()
+{
+}
+
+void
+NodeGraphSpatialIndex::getCellsRange(const QRectF& rect,
+                                     int* x1,
+                                     int* y1,
+                                     int* x2,
+                                     int* y2)
+{
+    *x1 = (int)std::floor(rect.left() / NODEGRAPH_SPATIAL_INDEX_CELL_SIZE);
+    *y1 = (int)std::floor(rect.top() / NODEGRAPH_SPATIAL_INDEX_CELL_SIZE);
+    *x2 = (int)std::floor(rect.right() / NODEGRAPH_SPATIAL_INDEX_CELL_SIZE);
+    *y2 = (int)std::floor(rect.bottom() / NODEGRAPH_SPATIAL_INDEX_CELL_SIZE);
+}
+
+void
+NodeGraphSpatialIndex::removeFromCells(NodeGui* node,
+                                       const QRectF& rect)
+{
+    int x1, y1, x2, y2;
+
+    getCellsRange(rect, &x1, &y1, &x2, &y2);
+    for (int y = y1; y <= y2; ++y) {
+        for (int x = x1; x <= x2; ++x) {
+            CellsMap::iterator found = _cells.find( Cell(x, y) );
+            if ( found != _cells.end() ) {
+                found->second.erase(node);
+                if ( found->second.empty() ) {
+                    _cells.erase(found);
+                }
+            }
+        }
+    }
+}
+
+void
+NodeGraphSpatialIndex::insertOrUpdate(NodeGui* node,
+                                      const QRectF& rect)
+{
+    QRectF normalized = rect.normalized();
+    RectsMap::iterator found = _rects.find(node);
+
+    if ( found != _rects.end() ) {
+        if (found->second == normalized) {
+            return;
+        }
+        removeFromCells(node, found->second);
+        found->second = normalized;
+    } else {
+        _rects.insert( std::make_pair(node, normalized) );
+    }
+
+    int x1, y1, x2, y2;
+    getCellsRange(normalized, &x1, &y1, &x2, &y2);
+    for (int y = y1; y <= y2; ++y) {
+        for (int x = x1; x <= x2; ++x) {
+            _cells[Cell(x, y)].insert(node);
+        }
+    }
+}
+
+void
+NodeGraphSpatialIndex::remove(NodeGui* node)
+{
+    RectsMap::iterator found = _rects.find(node);
+
+    if ( found == _rects.end() ) {
+        return;
+    }
+    removeFromCells(node, found->second);
+    _rects.erase(found);
+}
+
+void
+NodeGraphSpatialIndex::clear()
+{
+    _cells.clear();
+    _rects.clear();
+}
+
+void
+NodeGraphSpatialIndex::query(const QRectF& rect,
+                             std::set<NodeGui*>* nodes) const
+{
+    QRectF normalized = rect.normalized();
+    int x1, y1, x2, y2;
+
+    getCellsRange(normalized, &x1, &y1, &x2, &y2);
+
+    // When the area covers more cells than there are nodes (e.g: the graph is zoomed out), it is cheaper to test all nodes
+    double nCells = ( (double)x2 - x1 + 1 ) * ( (double)y2 - y1 + 1 );
+    if ( nCells > (double)_rects.size() ) {
+        for (RectsMap::const_iterator it = _rects.begin(); it != _rects.end(); ++it) {
+            if ( it->second.intersects(normalized) ) {
+                nodes->insert(it->first);
+            }
+        }
+
+        return;
+    }
+
+    for (int y = y1; y <= y2; ++y) {
+        for (int x = x1; x <= x2; ++x) {
+            CellsMap::const_iterator found = _cells.find( Cell(x, y) );
+            if ( found == _cells.end() ) {
+                continue;
+            }
+            for (std::set<NodeGui*>::const_iterator it = found->second.begin(); it != found->second.end(); ++it) {
+                if ( nodes->find(*it) != nodes->end() ) {
+                    continue;
+                }
+                RectsMap::const_iterator foundRect = _rects.find(*it);
+                if ( ( foundRect != _rects.end() ) && foundRect->second.intersects(normalized) ) {
+                    nodes->insert(*it);
+                }
+            }
+        }
+    }
+} // NodeGraphSpatialIndex::query
+
+NATRON_NAMESPACE_EXIT
@@ -0,0 +1,94 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef NODEGRAPHSPATIALINDEX_H
+#define NODEGRAPHSPATIALINDEX_H
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <map>
+#include <set>
+#include <utility>
+
+CLANG_DIAG_OFF(deprecated)
+CLANG_DIAG_OFF(uninitialized)
+#include <QtCore/QRectF>
+CLANG_DIAG_ON(deprecated)
+CLANG_DIAG_ON(uninitialized)
+
+#include "Gui/GuiFwd.h"
+
+NATRON_NAMESPACE_ENTER
+
+/**
+ * @brief A uniform grid storing the bounding box of the nodes of a NodeGraph, used to find the nodes
+ * in a given area without iterating over all the nodes of the graph.
+ * Rectangles are expressed in the coordinates of the item holding the nodes, so that panning the graph
+ * (which moves the root item) does not invalidate the index.
+ * This is only accessed from the main-thread.
+ **/
+class NodeGraphSpatialIndex
+{
+public:
+
+    NodeGraphSpatialIndex();
+
+    ~NodeGraphSpatialIndex();
+
+    /**
+     * @brief Adds the node to the index or updates its bounding box if it is already in the index.
+     **/
+    void insertOrUpdate(NodeGui* node, const QRectF& rect);
+
+    void remove(NodeGui* node);
+
+    void clear();
+
+    /**
+     * @brief Appends to nodes all the nodes whose bounding box intersects rect.
+     **/
+    void query(const QRectF& rect, std::set<NodeGui*>* nodes) const;
+
+    std::size_t size() const
+    {
+        return _rects.size();
+    }
+
+private:
+
+    typedef std::pair<int, int> Cell;
+    typedef std::map<Cell, std::set<NodeGui*> > CellsMap;
+    typedef std::map<NodeGui*, QRectF> RectsMap;
+
+    static void getCellsRange(const QRectF& rect, int* x1, int* y1, int* x2, int* y2);
+
+    void removeFromCells(NodeGui* node, const QRectF& rect);
+
+    CellsMap _cells;
+    RectsMap _rects;
+};
+
+NATRON_NAMESPACE_EXIT
+
+#endif // NODEGRAPHSPATIALINDEX_H
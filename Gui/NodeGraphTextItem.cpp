@@ -28,6 +28,7 @@
 #include <stdexcept>
 
 #include <QtCore/QDebug>
+#include <QPainter>
 #include <QStyleOption>
 
 #include "Engine/Settings.h"
@@ -69,13 +70,12 @@ NodeGraphTextItem::paint(QPainter *painter,
     bool isTooSmall = false;
 
     if (!_alwaysDrawText) {
-        if ( _graph->isDoingNavigatorRender() ) {
+        if ( _graph->isDoingNavigatorRender() || _graph->isLowDetailMode() ) {
             isTooSmall = true;
         } else {
+            // The painter transform maps the item coordinates to the viewport
             QFontMetrics fm( font() );
-            QPoint topLeft = _graph->mapFromScene( mapToScene( QPointF(0, 0) ) );
-            QPoint btmLeft = _graph->mapFromScene( mapToScene( QPointF( 0, fm.height() ) ) );
-            int height = std::abs( btmLeft.y() - topLeft.y() );
+            double height = fm.height() * QStyleOptionGraphicsItem::levelOfDetailFromTransform( painter->worldTransform() );
             isTooSmall = height < NODEGRAPH_TEXT_ITEM_MIN_HEIGHT_PX;
         }
     }
@@ -113,13 +113,12 @@ NodeGraphSimpleTextItem::paint(QPainter *painter,
     bool isTooSmall = false;
 
     if (!_alwaysDrawText) {
-        if ( _graph->isDoingNavigatorRender() ) {
+        if ( _graph->isDoingNavigatorRender() || _graph->isLowDetailMode() ) {
             isTooSmall = true;
         } else {
+            // The painter transform maps the item coordinates to the viewport
             QFontMetrics fm( font() );
-            QPoint topLeft = _graph->mapFromScene( mapToScene( QPointF(0, 0) ) );
-            QPoint btmLeft = _graph->mapFromScene( mapToScene( QPointF( 0, fm.height() ) ) );
-            int height = std::abs( btmLeft.y() - topLeft.y() );
+            double height = fm.height() * QStyleOptionGraphicsItem::levelOfDetailFromTransform( painter->worldTransform() );
             isTooSmall = height < NODEGRAPH_SIMPLE_TEXT_ITEM_MIN_HEIGHT_PX;
         }
     }
@@ -145,11 +144,10 @@ NodeGraphPixmapItem::paint(QPainter *painter,
                            const QStyleOptionGraphicsItem *option,
                            QWidget *widget)
 {
-    if ( _graph->isDoingNavigatorRender() ) {
+    if ( _graph->isDoingNavigatorRender() || _graph->isLowDetailMode() ) {
         return;
     }
-    QRect br = _graph->mapFromScene( mapToScene( boundingRect() ).boundingRect() ).boundingRect();
-    int height = br.height();
+    double height = boundingRect().height() * QStyleOptionGraphicsItem::levelOfDetailFromTransform( painter->worldTransform() );
     if (height < NODEGRAPH_PIXMAP_ITEM_MIN_HEIGHT_PX) {
         return;
     }
@@ -1069,6 +1069,19 @@ RearrangeNodesCommand::redo()
     setText( tr("Rearrange nodes") );
 }
 
+static AppInstancePtr
+getAppOfNodes(const std::list<NodeGuiWPtr>& nodes)
+{
+    for (std::list<NodeGuiWPtr>::const_iterator it = nodes.begin(); it != nodes.end(); ++it) {
+        NodeGuiPtr node = it->lock();
+        if (node) {
+            return node->getNode()->getApp();
+        }
+    }
+
+    return AppInstancePtr();
+}
+
 DisableNodesCommand::DisableNodesCommand(const std::list<NodeGuiPtr> & nodes,
                                          QUndoCommand *parent)
     : QUndoCommand(parent)
@@ -1082,6 +1095,8 @@ DisableNodesCommand::DisableNodesCommand(const std::list<NodeGuiPtr> & nodes,
 void
 DisableNodesCommand::undo()
 {
+    ChangeTransaction_RAII transaction( getAppOfNodes(_nodes) );
+
     for (std::list<NodeGuiWPtr>::iterator it = _nodes.begin(); it != _nodes.end(); ++it) {
         it->lock()->getNode()->setNodeDisabled(false);
     }
@@ -1091,6 +1106,8 @@ DisableNodesCommand::undo()
 void
 DisableNodesCommand::redo()
 {
+    ChangeTransaction_RAII transaction( getAppOfNodes(_nodes) );
+
     for (std::list<NodeGuiWPtr>::iterator it = _nodes.begin(); it != _nodes.end(); ++it) {
         it->lock()->getNode()->setNodeDisabled(true);
     }
@@ -1110,6 +1127,8 @@ EnableNodesCommand::EnableNodesCommand(const std::list<NodeGuiPtr> & nodes,
 void
 EnableNodesCommand::undo()
 {
+    ChangeTransaction_RAII transaction( getAppOfNodes(_nodes) );
+
     for (std::list<NodeGuiWPtr>::iterator it = _nodes.begin(); it != _nodes.end(); ++it) {
         it->lock()->getNode()->setNodeDisabled(true);
     }
@@ -1119,6 +1138,8 @@ EnableNodesCommand::undo()
 void
 EnableNodesCommand::redo()
 {
+    ChangeTransaction_RAII transaction( getAppOfNodes(_nodes) );
+
     for (std::list<NodeGuiWPtr>::iterator it = _nodes.begin(); it != _nodes.end(); ++it) {
         it->lock()->getNode()->setNodeDisabled(false);
     }
@@ -1156,6 +1177,7 @@ LoadNodePresetsCommand::undo()
 
     NodeGuiPtr node = _node.lock();
     NodePtr internalNode = node->getNode();
+    ChangeTransaction_RAII transaction( internalNode->getApp() );
     MultiInstancePanelPtr panel = node->getMultiInstancePanel();
     internalNode->loadKnobs(*_oldSerialization.front(), true);
     if (panel) {
@@ -1175,6 +1197,8 @@ LoadNodePresetsCommand::redo()
 {
     NodeGuiPtr node = _node.lock();
     NodePtr internalNode = node->getNode();
+    // Apply all the values of the preset before running the knobChanged handlers and rendering once
+    ChangeTransaction_RAII transaction( internalNode->getApp() );
     MultiInstancePanelPtr panel = node->getMultiInstancePanel();
 
     if (!_firstRedoCalled) {
@@ -249,6 +249,8 @@ NodeGui::initialize(NodeGraph* dag,
     QObject::connect( internalNode.get(), SIGNAL(inputVisibilityChanged(int)), this, SLOT(onInputVisibilityChanged(int)) );
     QObject::connect( this, SIGNAL(previewImageComputed()), this, SLOT(onPreviewImageComputed()) );
     setCacheMode(DeviceCoordinateCache);
+    // Needed for itemChange() to be notified of the position changes
+    setFlag(QGraphicsItem::ItemSendsGeometryChanges, true);
 
     OutputEffectInstance* isOutput = dynamic_cast<OutputEffectInstance*>( internalNode->getEffectInstance().get() );
     if (isOutput) {
@@ -977,9 +979,34 @@ NodeGui::resize(int width,
 
     resizeExtraContent(width, height, forceSize);
 
+    // The bounding box changed without moving the item: itemChange() is not called
+    if (_graph) {
+        _graph->refreshNodeSpatialIndex(this);
+    }
+
     refreshPosition( pos().x(), pos().y(), true );
 } // NodeGui::resize
 
+QVariant
+NodeGui::itemChange(GraphicsItemChange change,
+                    const QVariant & value)
+{
+    switch (change) {
+    case ItemPositionHasChanged:
+    case ItemTransformHasChanged:
+    case ItemScaleHasChanged:
+    case ItemParentHasChanged:
+        if (_graph) {
+            _graph->refreshNodeSpatialIndex(this);
+        }
+        break;
+    default:
+        break;
+    }
+
+    return QGraphicsItem::itemChange(change, value);
+}
+
 void
 NodeGui::refreshPositionEnd(double x,
                             double y)
@@ -987,11 +1014,12 @@ NodeGui::refreshPositionEnd(double x,
     setPos(x, y);
     if (_graph) {
         QRectF bbox = mapRectToScene( boundingRect() );
-        const NodesGuiList & allNodes = _graph->getAllActiveNodes();
+        std::set<NodeGui*> nodesInRect;
+        _graph->getNodesWithinSceneRect(bbox, &nodesInRect);
 
-        for (NodesGuiList::const_iterator it = allNodes.begin(); it != allNodes.end(); ++it) {
-            if ( (*it)->isVisible() && (it->get() != this) && (*it)->intersects(bbox) ) {
-                setAboveItem( it->get() );
+        for (std::set<NodeGui*>::const_iterator it = nodesInRect.begin(); it != nodesInRect.end(); ++it) {
+            if ( (*it)->isVisible() && (*it != this) && (*it)->intersects(bbox) ) {
+                setAboveItem(*it);
             }
         }
     }
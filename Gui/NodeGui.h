@@ -552,6 +552,12 @@ protected:
 
     virtual void applyBrush(const QBrush & brush);
 
+    /**
+     * @brief Keeps the spatial index of the graph up to date: every change of position, scale,
+     * transform or parent goes through here, whoever makes it.
+     **/
+    virtual QVariant itemChange(GraphicsItemChange change, const QVariant & value) OVERRIDE;
+
 private:
 
     int getPluginIconWidth() const;
@@ -25,6 +25,7 @@
 #include "PreviewThread.h"
 
 #include <list>
+#include <map>
 #include <vector>
 #include <stdexcept>
 #include <cstring> // for std::memcpy, std::memset
@@ -35,6 +36,7 @@
 #include "Gui/GuiDefines.h"
 #include "Gui/NodeGui.h"
 
+#include "Engine/AbortableRenderInfo.h"
 #include "Engine/Node.h"
 
 
@@ -48,10 +50,14 @@ public:
     double time;
     NodeGuiWPtr node;
 
+    // Identifies the request, a request is stale if a more recent one was made for the same node
+    U64 requestID;
+
     ComputePreviewRequest()
         : GenericThreadStartArgs()
         , time(0)
         , node()
+        , requestID(0)
     {}
 
     virtual ~ComputePreviewRequest()
@@ -65,12 +71,63 @@ struct PreviewThreadPrivate
 {
     std::vector<unsigned int> data;
 
+    // Protects all fields below
+    QMutex requestsMutex;
+
+    // The most recent request of each node that was not processed yet
+    PreviewRequests lastRequests;
+
+    // The node whose preview is being rendered and the abort info of the render
+    const NodeGui* renderingNode;
+    AbortableRenderInfoPtr renderAbortInfo;
+
     PreviewThreadPrivate()
         : data( NATRON_PREVIEW_HEIGHT * NATRON_PREVIEW_WIDTH * sizeof(unsigned int) )
+        , requestsMutex()
+        , lastRequests()
+        , renderingNode(0)
+        , renderAbortInfo()
     {
     }
 };
 
+PreviewRequests::PreviewRequests()
+    : _lastRequests()
+    , _nextRequestID(0)
+{
+}
+
+U64
+PreviewRequests::addRequest(const NodeGuiWPtr& node)
+{
+    U64 requestID = ++_nextRequestID;
+
+    _lastRequests[node] = requestID;
+
+    return requestID;
+}
+
+bool
+PreviewRequests::isRequestStale(const NodeGuiWPtr& node,
+                                U64 requestID) const
+{
+    std::map<NodeGuiWPtr, U64, boost::owner_less<NodeGuiWPtr> >::const_iterator found = _lastRequests.find(node);
+
+    return found != _lastRequests.end() && found->second != requestID;
+}
+
+void
+PreviewRequests::removeNode(const NodeGuiWPtr& node)
+{
+    _lastRequests.erase(node);
+}
+
+std::size_t
+PreviewRequests::size() const
+{
+    return _lastRequests.size();
+}
+
 PreviewThread::PreviewThread()
     : GenericSchedulerThread()
     , _imp( new PreviewThreadPrivate() )
@@ -92,6 +149,15 @@ PreviewThread::appendToQueue(const NodeGuiPtr& node,
 
     r->node = node;
     r->time = time;
+    {
+        QMutexLocker k(&_imp->requestsMutex);
+        r->requestID = _imp->lastRequests.addRequest(node);
+
+        // The preview being rendered for this node is outdated, e.g: the timeline moved
+        if ( (_imp->renderingNode == node.get()) && _imp->renderAbortInfo ) {
+            _imp->renderAbortInfo->setAborted();
+        }
+    }
     startTask(r);
 }
 
@@ -103,6 +169,15 @@ PreviewThread::threadLoopOnce(const GenericThreadStartArgsPtr& inArgs)
     assert(args);
 
 
+    {
+        QMutexLocker k(&_imp->requestsMutex);
+        if ( _imp->lastRequests.isRequestStale(args->node, args->requestID) ) {
+            // A more recent request for this node is queued, skip this one
+            return eThreadStateActive;
+        }
+        // The node may have been deleted since the request was made: use the weak pointer to find it
+        _imp->lastRequests.removeNode(args->node);
+    }
     NodeGuiPtr node = args->node.lock();
     if (node) {
         ///Mark this thread as running
@@ -122,9 +197,31 @@ PreviewThread::threadLoopOnce(const GenericThreadStartArgsPtr& inArgs)
 #endif
         NodePtr internalNode = node->getNode();
         if (internalNode) {
-            bool ok = internalNode->makePreviewImage( args->time, &w, &h, &_imp->data.front() );
-            Q_UNUSED(ok);
-            node->copyPreviewImageBuffer(_imp->data, w, h);
+            // Prefer an image that was already rendered, e.g by the viewer, over rendering the node again
+            bool ok = internalNode->makePreviewImageFromCache( args->time, &w, &h, &_imp->data.front() );
+            bool aborted = false;
+            if (!ok) {
+                AbortableRenderInfoPtr abortInfo = AbortableRenderInfo::create(true, 0);
+                {
+                    QMutexLocker k(&_imp->requestsMutex);
+                    _imp->renderingNode = node.get();
+                    _imp->renderAbortInfo = abortInfo;
+                }
+
+                // The tiles of the preview belong to the preview class of the RenderTaskScheduler: when render priorities
+                // are enabled, they pause while the viewer renders
+                ok = internalNode->makePreviewImage( args->time, &w, &h, &_imp->data.front(), abortInfo );
+
+                {
+                    QMutexLocker k(&_imp->requestsMutex);
+                    _imp->renderingNode = 0;
+                    _imp->renderAbortInfo.reset();
+                }
+                aborted = abortInfo->isAborted();
+            }
+            if (!aborted) {
+                node->copyPreviewImageBuffer(_imp->data, w, h);
+            }
         }
 
         ///Unmark this thread as running
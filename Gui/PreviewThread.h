@@ -33,14 +33,53 @@
 #include <boost/shared_ptr.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <boost/weak_ptr.hpp>
+#include <boost/smart_ptr/owner_less.hpp>
 #endif
 
+#include <map>
+
 #include "Engine/GenericSchedulerThread.h"
 
+#include "Global/GlobalDefines.h"
+
 #include "Gui/GuiFwd.h"
 
 NATRON_NAMESPACE_ENTER
 
+/**
+ * @brief The most recent preview request of each node. Nodes are held weakly so that the entry of a node deleted while
+ * its request is queued can still be removed, and is never confused with a node created later at the same address.
+ * This class is not MT-safe.
+ **/
+class PreviewRequests
+{
+public:
+
+    PreviewRequests();
+
+    /**
+     * @brief Records a new request for the node and returns its ID
+     **/
+    U64 addRequest(const NodeGuiWPtr& node);
+
+    /**
+     * @brief Returns true if a more recent request than requestID was made for the node
+     **/
+    bool isRequestStale(const NodeGuiWPtr& node, U64 requestID) const;
+
+    /**
+     * @brief Forgets the request of the node, which may have been deleted
+     **/
+    void removeNode(const NodeGuiWPtr& node);
+
+    std::size_t size() const;
+
+private:
+
+    std::map<NodeGuiWPtr, U64, boost::owner_less<NodeGuiWPtr> > _lastRequests;
+    U64 _nextRequestID;
+};
+
 struct PreviewThreadPrivate;
 class PreviewThread
     : public GenericSchedulerThread
@@ -35,6 +35,9 @@
 #include <QItemSelectionModel>
 #include <QtCore/QRegExp>
 
+#include "Global/FStreamsSupport.h"
+
+#include "Engine/AppManager.h" // Dialogs
 #include "Engine/Node.h"
 #include "Engine/Timer.h"
 #include "Engine/Utils.h" // convertFromPlainText
@@ -45,6 +48,7 @@
 #include "Gui/Label.h"
 #include "Gui/LineEdit.h"
 #include "Gui/NodeGui.h"
+#include "Gui/SequenceFileDialog.h"
 #include "Gui/TableModelView.h"
 
 
@@ -704,6 +708,8 @@ struct RenderStatsDialogPrivate
     Label* totalTimeSpentValueLabel;
     double totalSpentTime;
     Button* resetButton;
+    Button* exportTraceButton;
+    RenderTraceEventList traceEvents;
     QWidget* filterContainer;
     QHBoxLayout* filterLayout;
     Label* filtersLabel;
@@ -730,6 +736,8 @@ struct RenderStatsDialogPrivate
         , totalTimeSpentValueLabel(0)
         , totalSpentTime(0)
         , resetButton(0)
+        , exportTraceButton(0)
+        , traceEvents()
         , filterContainer(0)
         , filterLayout(0)
         , filtersLabel(0)
@@ -815,6 +823,13 @@ RenderStatsDialog::RenderStatsDialog(Gui* gui)
     QObject::connect( _imp->resetButton, SIGNAL(clicked(bool)), this, SLOT(resetStats()) );
     _imp->globalInfosLayout->addWidget(_imp->resetButton);
 
+    _imp->exportTraceButton = new Button(tr("Export Trace..."), _imp->globalInfosContainer);
+    _imp->exportTraceButton->setToolTip( NATRON_NAMESPACE::convertFromPlainText(tr("Saves the timeline of the actions called on each node and thread "
+                                                                                     "in the Chrome Trace Event format, which can be viewed in chrome://tracing or "
+                                                                                     "https://ui.perfetto.dev."), NATRON_NAMESPACE::WhiteSpaceNormal) );
+    QObject::connect( _imp->exportTraceButton, SIGNAL(clicked(bool)), this, SLOT(onExportTraceButtonClicked()) );
+    _imp->globalInfosLayout->addWidget(_imp->exportTraceButton);
+
     _imp->globalInfosLayout->addStretch();
 
     _imp->mainLayout->addWidget(_imp->globalInfosContainer);
@@ -972,6 +987,40 @@ RenderStatsDialog::resetStats()
     _imp->model->clearRows();
     _imp->totalTimeSpentValueLabel->setText( QString::fromUtf8("0.0 sec") );
     _imp->totalSpentTime = 0;
+    _imp->traceEvents.clear();
+}
+
+void
+RenderStatsDialog::addTraceEvents(const RenderTraceEventList& events)
+{
+    if ( !_imp->accumulateCheckbox->isChecked() ) {
+        _imp->traceEvents.clear();
+    }
+    _imp->traceEvents.insert( _imp->traceEvents.end(), events.begin(), events.end() );
+}
+
+void
+RenderStatsDialog::onExportTraceButtonClicked()
+{
+    std::vector<std::string> filters;
+    filters.push_back("json");
+    SequenceFileDialog dialog(this, filters, false, SequenceFileDialog::eFileDialogModeSave, "", _imp->gui, false);
+    if ( !dialog.exec() ) {
+        return;
+    }
+    std::string filename = dialog.filesToSave();
+    if ( filename.empty() ) {
+        return;
+    }
+
+    FStreamsSupport::ofstream ofile;
+    FStreamsSupport::open(&ofile, filename);
+    if (!ofile) {
+        Dialogs::errorDialog( tr("Export Trace").toStdString(), tr("Failure to write render trace file %1.").arg( QString::fromUtf8( filename.c_str() ) ).toStdString() );
+
+        return;
+    }
+    RenderStats::writeChromeTrace(_imp->traceEvents, ofile);
 }
 
 void
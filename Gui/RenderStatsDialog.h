@@ -63,9 +63,15 @@ public:
 
     void addStats(int time, ViewIdx view, double wallTime, const std::map<NodePtr, NodeRenderStats >& stats);
 
+    /**
+     * @brief Appends the render timeline of the last rendered frame, which can then be exported to a trace file.
+     **/
+    void addTraceEvents(const RenderTraceEventList& events);
+
 public Q_SLOTS:
 
     void resetStats();
+    void onExportTraceButtonClicked();
     void refreshAdvancedColsVisibility();
     void onSelectionChanged(const QItemSelection &selected, const QItemSelection &deselected);
 
@@ -1090,6 +1090,10 @@ SequenceFileDialog::updateView(const QString &directory)
     assert(directoryItem);
 
     QModelIndex index = _model->index( directoryItem.get() );
+    if ( index == _view->rootIndex() ) {
+        /*the directory is already shown while its content is loaded, keep the selection*/
+        return;
+    }
     /*update the view to show the newly loaded directory*/
     setRootIndex(index);
 
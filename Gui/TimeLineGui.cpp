@@ -25,6 +25,7 @@
 #include "TimeLineGui.h"
 
 #include <cmath>
+#include <map>
 #include <set>
 #include <stdexcept>
 
@@ -89,29 +90,139 @@ struct TimeLineZoomContext
     double zoomFactor; /// the zoom factor applied to the current image
 };
 
-struct CachedFrame
+/**
+ * @brief The frames of the viewer cache, stored as ranges of consecutive frames with the same storage
+ * so that long sequences of cached frames are cheap to update and to draw.
+ **/
+class CachedFrameRanges
 {
-    SequenceTime time;
-    StorageModeEnum mode;
+public:
 
-    CachedFrame(SequenceTime t,
-                StorageModeEnum m)
-        : time(t)
-        , mode(m)
+    struct Range
+    {
+        SequenceTime last;
+        StorageModeEnum mode;
+
+        Range(SequenceTime l,
+              StorageModeEnum m)
+            : last(l)
+            , mode(m)
+        {
+        }
+    };
+
+    // Ranges indexed by their first frame
+    typedef std::map<SequenceTime, Range> RangesMap;
+
+    CachedFrameRanges()
+        : _ranges()
     {
     }
-};
 
-struct CachedFrame_compare_time
-{
-    bool operator() (const CachedFrame & lhs,
-                     const CachedFrame & rhs) const
+    const RangesMap& getRanges() const
     {
-        return lhs.time < rhs.time;
+        return _ranges;
     }
-};
 
-typedef std::set<CachedFrame, CachedFrame_compare_time> CachedFrames;
+    /**
+     * @brief Returns an iterator to the first range that ends after the given time.
+     **/
+    RangesMap::const_iterator firstRangeEndingAfter(double time) const
+    {
+        RangesMap::const_iterator it = _ranges.upper_bound( (SequenceTime)std::floor(time) );
+        if ( it != _ranges.begin() ) {
+            RangesMap::const_iterator prev = it;
+            --prev;
+            if (prev->second.last + 1 >= time) {
+                return prev;
+            }
+        }
+
+        return it;
+    }
+
+    /**
+     * @brief Sets the storage of the frame at the given time, or removes it if mode is eStorageModeNone.
+     * This is in O(log(n)) where n is the number of ranges.
+     **/
+    void setFrame(SequenceTime time,
+                  StorageModeEnum mode)
+    {
+        RangesMap::iterator it = findRange(time);
+        if ( it != _ranges.end() ) {
+            if (it->second.mode == mode) {
+                return;
+            }
+            // Remove the frame from its range
+            SequenceTime first = it->first;
+            Range range = it->second;
+            _ranges.erase(it);
+            if (first < time) {
+                _ranges.insert( std::make_pair( first, Range(time - 1, range.mode) ) );
+            }
+            if (time < range.last) {
+                _ranges.insert( std::make_pair( time + 1, Range(range.last, range.mode) ) );
+            }
+        }
+        if (mode == eStorageModeNone) {
+            return;
+        }
+
+        SequenceTime first = time;
+        SequenceTime last = time;
+        // Merge with the range that ends just before
+        RangesMap::iterator next = _ranges.upper_bound(time);
+        if ( next != _ranges.begin() ) {
+            RangesMap::iterator prev = next;
+            --prev;
+            if ( (prev->second.last == time - 1) && (prev->second.mode == mode) ) {
+                first = prev->first;
+                _ranges.erase(prev);
+            }
+        }
+        // Merge with the range that starts just after
+        if ( ( next != _ranges.end() ) && (next->first == time + 1) && (next->second.mode == mode) ) {
+            last = next->second.last;
+            _ranges.erase(next);
+        }
+        _ranges.insert( std::make_pair( first, Range(last, mode) ) );
+    }
+
+    /**
+     * @brief Removes all the frames with the given storage.
+     **/
+    void removeFrames(StorageModeEnum mode)
+    {
+        RangesMap::iterator it = _ranges.begin();
+        while ( it != _ranges.end() ) {
+            if (it->second.mode == mode) {
+                _ranges.erase(it++);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    void clear()
+    {
+        _ranges.clear();
+    }
+
+private:
+
+    RangesMap::iterator findRange(SequenceTime time)
+    {
+        RangesMap::iterator it = _ranges.upper_bound(time);
+        if ( it == _ranges.begin() ) {
+            return _ranges.end();
+        }
+        --it;
+
+        return (it->second.last >= time) ? it : _ranges.end();
+    }
+
+    RangesMap _ranges;
+};
 
 static
 QString
@@ -157,7 +268,7 @@ struct TimelineGuiPrivate
     TextRenderer textRenderer;
     QFont font;
     bool firstPaint;
-    CachedFrames cachedFrames;
+    CachedFrameRanges cachedFrames;
     mutable QMutex boundariesMutex;
     SequenceTime leftBoundary, rightBoundary;
     mutable QMutex frameRangeEditedMutex;
@@ -738,16 +849,16 @@ TimeLineGui::paintGL()
         glLineWidth(2);
         glCheckError();
         glBegin(GL_LINES);
-        for (CachedFrames::const_iterator i = _imp->cachedFrames.begin(); i != _imp->cachedFrames.end(); ++i) {
-            if ( ( i->time >= btmLeft.x() ) && ( i->time <= topRight.x() ) ) {
-                if (i->mode == eStorageModeRAM) {
-                    glColor4f(cachedR, cachedG, cachedB, 1.);
-                } else if (i->mode == eStorageModeDisk) {
-                    glColor4f(dcR, dcG, dcB, 1.);
-                }
-                glVertex2f(i->time, cachedLineYPos);
-                glVertex2f(i->time + 1, cachedLineYPos);
+        const CachedFrameRanges::RangesMap& cachedRanges = _imp->cachedFrames.getRanges();
+        for (CachedFrameRanges::RangesMap::const_iterator i = _imp->cachedFrames.firstRangeEndingAfter( btmLeft.x() );
+             i != cachedRanges.end() && i->first <= topRight.x(); ++i) {
+            if (i->second.mode == eStorageModeRAM) {
+                glColor4f(cachedR, cachedG, cachedB, 1.);
+            } else if (i->second.mode == eStorageModeDisk) {
+                glColor4f(dcR, dcG, dcB, 1.);
             }
+            glVertex2f(std::max<double>( i->first, btmLeft.x() ), cachedLineYPos);
+            glVertex2f(std::min<double>( i->second.last + 1, topRight.x() ), cachedLineYPos);
         }
         glEnd();
 
@@ -1246,12 +1357,7 @@ TimeLineGui::connectSlotsToViewerCache()
     assert( qApp && qApp->thread() == QThread::currentThread() );
 
     CacheSignalEmitterPtr emitter = appPTR->getOrActivateViewerCacheSignalEmitter();
-    QObject::connect( emitter.get(), SIGNAL(addedEntry(SequenceTime)), this, SLOT(onCachedFrameAdded(SequenceTime)) );
-    QObject::connect( emitter.get(), SIGNAL(removedEntry(SequenceTime,int)), this, SLOT(onCachedFrameRemoved(SequenceTime,int)) );
-    QObject::connect( emitter.get(), SIGNAL(entryStorageChanged(SequenceTime,int,int)), this,
-                      SLOT(onCachedFrameStorageChanged(SequenceTime,int,int)) );
-    QObject::connect( emitter.get(), SIGNAL(clearedDiskPortion()), this, SLOT(onDiskCacheCleared()) );
-    QObject::connect( emitter.get(), SIGNAL(clearedInMemoryPortion()), this, SLOT(onMemoryCacheCleared()) );
+    QObject::connect( emitter.get(), SIGNAL(entriesChanged(CacheEntriesChanges)), this, SLOT(onCacheEntriesChanged(CacheEntriesChanges)) );
 }
 
 void
@@ -1261,12 +1367,7 @@ TimeLineGui::disconnectSlotsFromViewerCache()
     assert( qApp && qApp->thread() == QThread::currentThread() );
 
     CacheSignalEmitterPtr emitter = appPTR->getOrActivateViewerCacheSignalEmitter();
-    QObject::disconnect( emitter.get(), SIGNAL(addedEntry(SequenceTime)), this, SLOT(onCachedFrameAdded(SequenceTime)) );
-    QObject::disconnect( emitter.get(), SIGNAL(removedEntry(SequenceTime,int)), this, SLOT(onCachedFrameRemoved(SequenceTime,int)) );
-    QObject::disconnect( emitter.get(), SIGNAL(entryStorageChanged(SequenceTime,int,int)), this,
-                         SLOT(onCachedFrameStorageChanged(SequenceTime,int,int)) );
-    QObject::disconnect( emitter.get(), SIGNAL(clearedDiskPortion()), this, SLOT(onDiskCacheCleared()) );
-    QObject::disconnect( emitter.get(), SIGNAL(clearedInMemoryPortion()), this, SLOT(onMemoryCacheCleared()) );
+    QObject::disconnect( emitter.get(), SIGNAL(entriesChanged(CacheEntriesChanges)), this, SLOT(onCacheEntriesChanged(CacheEntriesChanges)) );
 }
 
 bool
@@ -1292,63 +1393,17 @@ TimeLineGui::setTimeFormatFrames(bool value)
 }
 
 void
-TimeLineGui::onCachedFrameAdded(SequenceTime time)
-{
-    _imp->cachedFrames.insert( CachedFrame(time, eStorageModeRAM) );
-}
-
-void
-TimeLineGui::onCachedFrameRemoved(SequenceTime time,
-                                  int /*storage*/)
-{
-    for (CachedFrames::iterator it = _imp->cachedFrames.begin(); it != _imp->cachedFrames.end(); ++it) {
-        if (it->time == time) {
-            _imp->cachedFrames.erase(it);
-            break;
-        }
-    }
-    _imp->startKeyframeChangesTimer();
-}
-
-void
-TimeLineGui::onCachedFrameStorageChanged(SequenceTime time,
-                                         int /*oldStorage*/,
-                                         int newStorage)
+TimeLineGui::onCacheEntriesChanged(const CacheEntriesChanges& changes)
 {
-    for (CachedFrames::iterator it = _imp->cachedFrames.begin(); it != _imp->cachedFrames.end(); ++it) {
-        if (it->time == time) {
-            _imp->cachedFrames.erase(it);
-            _imp->cachedFrames.insert( CachedFrame(time, (StorageModeEnum)newStorage) );
-            break;
-        }
+    if (changes.clearedInMemoryPortion) {
+        _imp->cachedFrames.removeFrames(eStorageModeRAM);
     }
-}
-
-void
-TimeLineGui::onMemoryCacheCleared()
-{
-    CachedFrames copy;
-
-    for (CachedFrames::iterator it = _imp->cachedFrames.begin(); it != _imp->cachedFrames.end(); ++it) {
-        if (it->mode == eStorageModeDisk) {
-            copy.insert(*it);
-        }
+    if (changes.clearedDiskPortion) {
+        _imp->cachedFrames.removeFrames(eStorageModeDisk);
     }
-    _imp->cachedFrames = copy;
-    _imp->startKeyframeChangesTimer();
-}
-
-void
-TimeLineGui::onDiskCacheCleared()
-{
-    CachedFrames copy;
-
-    for (CachedFrames::iterator it = _imp->cachedFrames.begin(); it != _imp->cachedFrames.end(); ++it) {
-        if (it->mode == eStorageModeRAM) {
-            copy.insert(*it);
-        }
+    for (std::map<SequenceTime, StorageModeEnum>::const_iterator it = changes.frames.begin(); it != changes.frames.end(); ++it) {
+        _imp->cachedFrames.setFrame(it->first, it->second);
     }
-    _imp->cachedFrames = copy;
     _imp->startKeyframeChangesTimer();
 }
 
@@ -112,9 +112,8 @@ public:
     double toWidget(double t) const;
 
     /**
-     * @brief Activates the SLOT onViewerCacheFrameAdded() and the SIGNALS removedLRUCachedFrame() and  clearedViewerCache()
-     * by connecting them to the ViewerCache emitted signals. They in turn are used by the GUI to refresh the "cached line" on
-     * the timeline.
+     * @brief Connects the SLOT onCacheEntriesChanged() to the changes of the ViewerCache.
+     * They in turn are used by the GUI to refresh the "cached line" on the timeline.
      **/
     void connectSlotsToViewerCache();
 
@@ -142,11 +141,7 @@ public Q_SLOTS:
 
     void onFrameChanged(SequenceTime, int);
 
-    void onCachedFrameAdded(SequenceTime time);
-    void onCachedFrameRemoved(SequenceTime time, int storage);
-    void onCachedFrameStorageChanged(SequenceTime time, int oldStorage, int newStorage);
-    void onMemoryCacheCleared();
-    void onDiskCacheCleared();
+    void onCacheEntriesChanged(const CacheEntriesChanges& changes);
 
     void clearCachedFrames();
 
@@ -346,6 +346,12 @@ ViewerTab::onEngineStopped()
 
     _imp->currentFrameBox->setValue( _imp->viewerNode->getTimeline()->currentFrame() );
 
+    // Playback may have lowered the resolution to reach the desired frame rate, show the current frame at full resolution
+    RenderEnginePtr engine = _imp->viewerNode->getRenderEngine();
+    if ( engine && !engine->isDoingSequentialRender() && _imp->viewerNode->resetPlaybackResolution() ) {
+        _imp->viewerNode->renderCurrentFrame(true);
+    }
+
     if ( getGui() && getGui()->isGUIFrozen() && appPTR->getCurrentSettings()->isAutoTurboEnabled() ) {
         getGui()->onFreezeUIButtonClicked(false);
     } else {
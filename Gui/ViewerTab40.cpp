@@ -1275,9 +1275,11 @@ ViewerTab::onRenderStatsAvailable(int time,
                                   const RenderStatsMap& stats)
 {
     assert( QThread::currentThread() == qApp->thread() );
+    RenderTraceEventList traceEvents = getInternalNode()->takeTraceEvents();
     RenderStatsDialog* dialog = getGui()->getRenderStatsDialog();
     if (dialog) {
         dialog->addStats(time, view, wallTime, stats);
+        dialog->addTraceEvents(traceEvents);
     }
 }
 
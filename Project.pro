@@ -34,6 +34,7 @@ SUBDIRS += \
     libtess \
     Engine \
     Renderer \
+    Benchmarks \
     Gui \
     Tests \
     PythonBin \
@@ -56,6 +57,7 @@ libmv.depends = gflags ceres
 openMVG.depends = ceres
 Engine.depends = libmv openMVG HostSupport libtess ceres
 Renderer.depends = Engine
+Benchmarks.depends = Engine
 Gui.depends = Engine qhttpserver
 Tests.depends = Gui Engine
 App.depends = Gui Engine
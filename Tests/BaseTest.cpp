@@ -28,7 +28,10 @@
 
 #include "BaseTest.h"
 
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QFile>
+#include <QtCore/QThread>
 #include <QtCore/QThreadPool>
 
 // ofxhPropertySuite.h:565:37: warning: 'this' pointer cannot be null in well-defined C++ code; comparison may be assumed to always evaluate to true [-Wtautological-undefined-compare]
@@ -50,6 +53,8 @@ CLANG_DIAG_ON(unknown-pragmas)
 #include "Engine/AppInstance.h"
 #include "Engine/KnobTypes.h"
 #include "Engine/EffectInstance.h"
+#include "Engine/OutputEffectInstance.h"
+#include "Engine/OutputSchedulerThread.h"
 #include "Engine/Plugin.h"
 #include "Engine/Curve.h"
 #include "Engine/CLArgs.h"
@@ -280,6 +285,112 @@ TEST_F(BaseTest, GenerateDot)
     QFile::remove(filePath);
 }
 
+///Aborts a render from another thread once the writer started rendering
+class RenderAborter
+    : public QThread
+{
+public:
+    RenderAborter(OutputEffectInstance* writer,
+                  const QElapsedTimer* clock)
+        : QThread()
+        , _writer(writer)
+        , _clock(clock)
+        , _abortTime(-1)
+    {
+    }
+
+    /**
+     * @brief The time of the abort on the clock, or -1 if the render was not aborted.
+     * Only valid once the thread is finished (after wait()).
+     **/
+    qint64 getAbortTime() const
+    {
+        assert( isFinished() );
+
+        return _abortTime;
+    }
+
+private:
+    virtual void run() OVERRIDE FINAL
+    {
+        QElapsedTimer waitTimer;
+        waitTimer.start();
+        while ( !_writer->isDoingSequentialRender() && (waitTimer.elapsed() < 10000) ) {
+            QThread::msleep(10);
+        }
+        // Let the render threads get deep into the render of their frames
+        QThread::msleep(500);
+
+        _abortTime = _clock->elapsed();
+        _writer->getRenderEngine()->abortRenderingNoRestart();
+    }
+
+    OutputEffectInstance* _writer;
+    const QElapsedTimer* _clock;
+    qint64 _abortTime;
+};
+
+///Render a long sequence and abort it: the render must stop quickly
+TEST_F(BaseTest, AbortLongRender)
+{
+    NodePtr generator = createNode(_generatorPluginID);
+    NodePtr writer = createNode(_writeOIIOPluginID);
+
+    ASSERT_TRUE( bool(generator) && bool(writer) );
+
+    const int lastFrame = 1000;
+    KnobIPtr frameRange = generator->getApp()->getProject()->getKnobByName("frameRange");
+    ASSERT_TRUE( bool(frameRange) );
+    KnobInt* knob = dynamic_cast<KnobInt*>( frameRange.get() );
+    ASSERT_TRUE(knob);
+    knob->setValue(1, ViewSpec::all(), 0);
+    knob->setValue(lastFrame, ViewSpec::all(), 1);
+
+    // Large enough for a frame to take a while to render
+    Format f(0, 0, 4096, 4096, "abortTest", 1.);
+    generator->getApp()->getProject()->setOrAddProjectFormat(f);
+
+    const QString& binPath = appPTR->getApplicationBinaryPath();
+    QString filePath = binPath + QString::fromUtf8("/test_abort_render_####.tif");
+    writer->setOutputFilesForWriter( filePath.toStdString() );
+
+    connectNodes(generator, writer, 0, true);
+
+    std::list<AppInstance::RenderWork> works;
+    AppInstance::RenderWork w;
+    w.writer = dynamic_cast<OutputEffectInstance*>( writer->getEffectInstance().get() );
+    ASSERT_TRUE(w.writer);
+    w.firstFrame = INT_MIN;
+    w.lastFrame = INT_MAX;
+    w.frameStep = INT_MIN;
+    w.useRenderStats = false;
+    works.push_back(w);
+
+    QElapsedTimer clock;
+    clock.start();
+    RenderAborter aborter(w.writer, &clock);
+    aborter.start();
+
+    ///This call is blocking until the render is finished or aborted
+    getApp()->startWritersRendering(false, works);
+    const qint64 idleTime = clock.elapsed();
+    // The abort time is only read once the aborter thread is finished
+    aborter.wait();
+
+    const qint64 abortTime = aborter.getAbortTime();
+    ASSERT_GE(abortTime, 0);
+    ASSERT_LE(abortTime, idleTime);
+    EXPECT_LT(idleTime - abortTime, 2000);
+    EXPECT_FALSE( w.writer->isDoingSequentialRender() );
+    EXPECT_FALSE( QFile::exists( binPath + QString::fromUtf8("/test_abort_render_%1.tif").arg(lastFrame) ) );
+
+    QDir binDir(binPath);
+    QStringList rendered = binDir.entryList( QStringList( QString::fromUtf8("test_abort_render_*.tif") ) );
+    for (int i = 0; i < rendered.size(); ++i) {
+        binDir.remove(rendered[i]);
+    }
+}
+
 TEST_F(BaseTest, SetValues)
 {
     NodePtr generator = createNode(_generatorPluginID);
@@ -305,6 +416,36 @@ TEST_F(BaseTest, SetValues)
     }
 }
 
+TEST_F(BaseTest, ChangeTransaction)
+{
+    NodePtr generator = createNode(_generatorPluginID);
+    NodePtr writer = createNode(_writeOIIOPluginID);
+
+    ASSERT_TRUE(writer && generator);
+    connectNodes(generator, writer, 0, true);
+
+    KnobDouble* slope = dynamic_cast<KnobDouble*>( generator->getKnobByName("noiseZSlope").get() );
+    ASSERT_TRUE(slope != 0);
+
+    U64 generatorHash = generator->getHashValue();
+    U64 writerHash = writer->getHashValue();
+    AppInstancePtr app = getApp();
+    app->beginChangeTransaction();
+    EXPECT_TRUE( app->isChangeTransactionActive() );
+    slope->setValue(0.25);
+    slope->setValue(0.75);
+
+    // The values are set but the hashes are only computed on commit
+    EXPECT_TRUE(slope->getValue() == 0.75);
+    EXPECT_EQ( generatorHash, generator->getHashValue() );
+    EXPECT_EQ( writerHash, writer->getHashValue() );
+
+    app->commitChangeTransaction();
+    EXPECT_FALSE( app->isChangeTransactionActive() );
+    EXPECT_NE( generatorHash, generator->getHashValue() );
+    EXPECT_NE( writerHash, writer->getHashValue() );
+}
+
 ///High level test: simple node connections test
 TEST_F(BaseTest, SimpleNodeConnections) {
     ///create the generator
@@ -123,4 +123,30 @@ TEST(Curve, Basic)
     KeyFrame k2(1., 20.);
 }
 
-
+TEST(Curve, AddKeyFrames)
+{
+    Curve incremental;
+    Curve bulk;
+    std::vector<KeyFrame> keys;
+
+    for (int i = 0; i < 10; ++i) {
+        // add the keyframes in reverse order, with a linear section in the middle
+        KeyFrame k(10. - i, (i % 3) * 2., 0., 0., (i == 4 || i == 5) ? eKeyframeTypeLinear : eKeyframeTypeSmooth);
+        incremental.addKeyFrame(k);
+        keys.push_back(k);
+    }
+    EXPECT_EQ( 10, bulk.addKeyFrames(keys) );
+    EXPECT_EQ( incremental.getKeyFramesCount(), bulk.getKeyFramesCount() );
+    for (double t = -1.; t <= 12.; t += 0.25) {
+        EXPECT_DOUBLE_EQ( incremental.getValueAt(t), bulk.getValueAt(t) );
+        EXPECT_DOUBLE_EQ( incremental.getDerivativeAt(t), bulk.getDerivativeAt(t) );
+    }
+
+    // keyframes already in the curve are replaced
+    keys.clear();
+    keys.push_back( KeyFrame(1., 100.) );
+    keys.push_back( KeyFrame(20., 5.) );
+    EXPECT_EQ( 1, bulk.addKeyFrames(keys) );
+    EXPECT_EQ( 11, bulk.getKeyFramesCount() );
+    EXPECT_EQ( 100., bulk.getValueAt(1.) );
+}
@@ -0,0 +1,166 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <gtest/gtest.h>
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/make_shared.hpp>
+#endif
+
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+
+#include "Engine/DirectoryContent.h"
+#include "Engine/FileSystemModel.h"
+
+NATRON_NAMESPACE_USING
+
+static FileSystemItemPtr
+findItem(const std::vector<FileSystemItemPtr>& items,
+         const QString& userFriendlyFilename)
+{
+    for (std::vector<FileSystemItemPtr>::const_iterator it = items.begin(); it != items.end(); ++it) {
+        if ( (*it)->getUserFriendlyFilename() == userFriendlyFilename ) {
+            return *it;
+        }
+    }
+
+    return FileSystemItemPtr();
+}
+
+TEST(FileSystemModel, GroupNumberedSequences)
+{
+    FileSystemModelPtr model = boost::make_shared<FileSystemModel>();
+    const QString path = QDir::tempPath();
+    FileSystemItemPtr directory = FileSystemItem::create( model, true, path, path, SequenceParsing::SequenceFromFilesPtr(), QDateTime(), 0 );
+
+    // The entries are not listed in order
+    DirectoryContentGrouper grouper(directory, model, true, false);
+    grouper.addEntry(QString::fromUtf8("shot.0002.exr"), false);
+    grouper.addEntry(QString::fromUtf8("notes.txt"), false);
+    grouper.addEntry(QString::fromUtf8("shot.0001.exr"), false);
+    grouper.addEntry(QString::fromUtf8("renders"), true);
+    grouper.addEntry(QString::fromUtf8("shot.0003.exr"), false);
+    grouper.addEntry(QString::fromUtf8("plate.0001.exr"), false);
+
+    boost::shared_ptr<FileGathererContent> content = grouper.takeContent(true);
+    ASSERT_TRUE(content);
+    EXPECT_TRUE(content->isFirstContent);
+    EXPECT_TRUE(content->isLastContent);
+    ASSERT_EQ( (std::size_t)4, content->newItems.size() ) << "The numbered files of a sequence must be grouped in a single item";
+
+    FileSystemItemPtr shot;
+    for (std::vector<FileSystemItemPtr>::const_iterator it = content->newItems.begin(); it != content->newItems.end(); ++it) {
+        if ( (*it)->fileName().startsWith( QString::fromUtf8("shot.") ) ) {
+            ASSERT_FALSE(shot) << "Only one item for the files of the sequence";
+            shot = *it;
+        }
+    }
+    ASSERT_TRUE(shot);
+    EXPECT_TRUE( shot->getSequence() );
+    EXPECT_FALSE( shot->isDir() );
+
+    FileSystemItemPtr renders = findItem( content->newItems, QString::fromUtf8("renders") );
+    ASSERT_TRUE(renders);
+    EXPECT_TRUE( renders->isDir() );
+
+    int nPlates = 0;
+    int nNotes = 0;
+    for (std::vector<FileSystemItemPtr>::const_iterator it = content->newItems.begin(); it != content->newItems.end(); ++it) {
+        if ( (*it)->fileName().startsWith( QString::fromUtf8("plate.") ) ) {
+            ++nPlates;
+        } else if ( (*it)->fileName().startsWith( QString::fromUtf8("notes") ) ) {
+            ++nNotes;
+        }
+    }
+    EXPECT_EQ(1, nPlates) << "A file with another name is not part of the sequence";
+    EXPECT_EQ(1, nNotes);
+}
+
+TEST(FileSystemModel, GroupWithoutSequenceMode)
+{
+    FileSystemModelPtr model = boost::make_shared<FileSystemModel>();
+    const QString path = QDir::tempPath();
+    FileSystemItemPtr directory = FileSystemItem::create( model, true, path, path, SequenceParsing::SequenceFromFilesPtr(), QDateTime(), 0 );
+    DirectoryContentGrouper grouper(directory, model, false, false);
+
+    grouper.addEntry(QString::fromUtf8("shot.0001.exr"), false);
+    grouper.addEntry(QString::fromUtf8("shot.0002.exr"), false);
+
+    boost::shared_ptr<FileGathererContent> content = grouper.takeContent(true);
+    EXPECT_EQ( (std::size_t)2, content->newItems.size() );
+}
+
+TEST(FileSystemModel, DroppedItemsAreUnregistered)
+{
+    FileSystemModelPtr model = boost::make_shared<FileSystemModel>();
+    const QString path = QDir::tempPath();
+    FileSystemItemPtr directory = FileSystemItem::create( model, true, path, path, SequenceParsing::SequenceFromFilesPtr(), QDateTime(), 0 );
+    DirectoryContentGrouper grouper(directory, model, true, false);
+
+    grouper.addEntry(QString::fromUtf8("notes.txt"), false);
+    boost::shared_ptr<FileGathererContent> content = grouper.takeContent(true);
+    ASSERT_EQ( (std::size_t)1, content->newItems.size() );
+    FileSystemItemPtr item = content->newItems.front();
+    EXPECT_EQ( item, model->getSharedItemPtr( item.get() ) );
+
+    content->unregisterNewItems();
+    EXPECT_FALSE( model->getSharedItemPtr( item.get() ) );
+}
+
+TEST(FileSystemModel, DirectoryListingCacheInvalidation)
+{
+    DirectoryListingCache cache;
+    const QString path = QDir::tempPath();
+    const QDir::Filters filters = QDir::AllEntries | QDir::NoDotAndDotDot;
+    const QDateTime lastModified = QDateTime::currentDateTime().addSecs(-60);
+    DirectoryEntries entries;
+
+    entries.push_back( std::make_pair(QString::fromUtf8("shot.0001.exr"), false) );
+    entries.push_back( std::make_pair(QString::fromUtf8("renders"), true) );
+    cache.insert(path, filters, lastModified, entries);
+
+    DirectoryEntries cached;
+    ASSERT_TRUE( cache.get(path, filters, lastModified, &cached) );
+    EXPECT_TRUE(cached == entries);
+
+    EXPECT_FALSE( cache.get(path, filters, lastModified.addSecs(1), &cached) ) << "The directory was modified since it was listed";
+    EXPECT_FALSE( cache.get(path, QDir::Files, lastModified, &cached) ) << "The directory was listed with other filters";
+
+    // Once listed again, the new entries replace the old ones
+    const QDateTime newLastModified = lastModified.addSecs(10);
+    entries.pop_back();
+    cache.insert(path, filters, newLastModified, entries);
+    EXPECT_FALSE( cache.get(path, filters, lastModified, &cached) );
+    ASSERT_TRUE( cache.get(path, filters, newLastModified, &cached) );
+    EXPECT_EQ( (std::size_t)1, cached.size() );
+
+    // A directory modified within the last seconds may still change without its date changing
+    const QString otherPath = QDir(path).absoluteFilePath( QString::fromUtf8("renders") );
+    const QDateTime now = QDateTime::currentDateTime();
+    cache.insert(otherPath, filters, now, entries);
+    EXPECT_FALSE( cache.get(otherPath, filters, now, &cached) );
+}
@@ -0,0 +1,106 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <gtest/gtest.h>
+
+#include "Engine/ImageBufferPool.h"
+
+NATRON_NAMESPACE_USING
+
+// Sizes that the images of the other tests are unlikely to use, so that their buffers do not interfere
+#define kPoolTestBytes (7 * 1024 * 1024 + 12345)
+#define kPoolTestOtherBytes (11 * 1024 * 1024 + 6789)
+
+TEST(ImageBufferPool, SizeClasses)
+{
+    // Small buffers are not rounded
+    EXPECT_EQ( (std::size_t)1000, ImageBufferPool::getAllocatedSize(1000, false) );
+
+    for (std::size_t bytes = 256 * 1024; bytes < 64 * 1024 * 1024; bytes = bytes * 5 / 4 + 4321) {
+        const std::size_t classBytes = ImageBufferPool::getAllocatedSize(bytes, false);
+        EXPECT_GE(classBytes, bytes);
+        // At most 1/8th of the block is wasted, plus the rounding to the page size
+        EXPECT_LE(classBytes, bytes + bytes / 8 + 4096);
+        EXPECT_EQ( (std::size_t)0, classBytes % 4096 );
+        // A class is its own class
+        EXPECT_EQ( classBytes, ImageBufferPool::getAllocatedSize(classBytes, false) );
+
+        const std::size_t hugeClassBytes = ImageBufferPool::getAllocatedSize(bytes, true);
+        EXPECT_GE(hugeClassBytes, classBytes);
+        if ( hugeClassBytes >= (std::size_t)(2 * 1024 * 1024) ) {
+            EXPECT_EQ( (std::size_t)0, hugeClassBytes % (2 * 1024 * 1024) );
+        }
+    }
+}
+
+TEST(ImageBufferPool, ReuseAndTrim)
+{
+    const U64 savedMaximum = ImageBufferPool::getStatistics().maximumPooledBytes;
+
+    ImageBufferPool::setHugePagesEnabled(false);
+    ImageBufferPool::setMaximumPooledBytes(256 * 1024 * 1024);
+    ImageBufferPool::trim(0);
+
+    // A released block is reused by the next allocation of the same class
+    ImageBufferPool::Block block = ImageBufferPool::allocate(kPoolTestBytes);
+    ASSERT_TRUE(block.data != 0);
+    EXPECT_EQ( ImageBufferPool::getAllocatedSize(kPoolTestBytes, false), block.bytes );
+    void* data = block.data;
+    const std::size_t bytes = block.bytes;
+    ImageBufferPool::release(&block);
+    EXPECT_TRUE(block.data == 0);
+
+    ImageBufferPoolStatistics stats = ImageBufferPool::getStatistics();
+    EXPECT_GE(stats.pooledBytes, (U64)bytes);
+
+    block = ImageBufferPool::allocate(kPoolTestBytes - 100);
+    EXPECT_EQ(data, block.data);
+    EXPECT_EQ(bytes, block.bytes);
+    EXPECT_EQ(stats.nReused + 1, ImageBufferPool::getStatistics().nReused);
+
+    // Blocks of different classes are pooled separately
+    ImageBufferPool::Block other = ImageBufferPool::allocate(kPoolTestOtherBytes);
+    ASSERT_TRUE(other.data != 0);
+    ImageBufferPool::release(&block);
+    ImageBufferPool::release(&other);
+    stats = ImageBufferPool::getStatistics();
+    EXPECT_GE(stats.nFreeBlocks, (U64)2);
+    EXPECT_GE(stats.nFreeSizeClasses, (U64)2);
+
+    // Trimming returns the free blocks to the system
+    ImageBufferPool::trim(0);
+    stats = ImageBufferPool::getStatistics();
+    EXPECT_EQ( (U64)0, stats.pooledBytes );
+    EXPECT_EQ( (U64)0, stats.nFreeBlocks );
+
+    // Blocks larger than the pool are not kept
+    ImageBufferPool::setMaximumPooledBytes(1024 * 1024);
+    block = ImageBufferPool::allocate(kPoolTestBytes);
+    ImageBufferPool::release(&block);
+    EXPECT_EQ( (U64)0, ImageBufferPool::getStatistics().pooledBytes );
+
+    ImageBufferPool::setMaximumPooledBytes(savedMaximum);
+}
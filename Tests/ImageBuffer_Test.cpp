@@ -0,0 +1,153 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <string>
+
+#include "BaseTest.h"
+
+#include "Engine/AppInstance.h"
+#include "Engine/AppManager.h"
+#include "Engine/EffectInstance.h"
+#include "Engine/Node.h"
+
+NATRON_NAMESPACE_USING
+
+#ifndef NATRON_RUN_WITHOUT_PYTHON
+
+static PyObject*
+getPythonVariable(const char* name)
+{
+    PyObject* dict = PyModule_GetDict( NATRON_PYTHON_NAMESPACE::getMainModule() );
+
+    return PyDict_GetItemString(dict, name); // borrowed reference
+}
+
+// Requests a buffer with the given flags and checks whether it fails with a BufferError
+static bool
+canGetBuffer(PyObject* obj,
+             int flags)
+{
+    Py_buffer view;
+
+    if (PyObject_GetBuffer(obj, &view, flags) == 0) {
+        PyBuffer_Release(&view);
+
+        return true;
+    }
+    EXPECT_TRUE( PyErr_ExceptionMatches(PyExc_BufferError) );
+    PyErr_Clear();
+
+    return false;
+}
+
+TEST_F(BaseTest, ImageBufferRoundTrip)
+{
+    NodePtr source = createNode( QString::fromUtf8(PLUGINID_NATRON_IMAGEBUFFER) );
+    ASSERT_TRUE(source);
+
+    const int width = 8;
+    const int height = 4;
+    const std::string effect = getApp()->getAppIDString() + "." + source->getScriptName();
+    std::string err;
+    ASSERT_TRUE( NATRON_PYTHON_NAMESPACE::interpretPythonScript("import NatronEngine\n"
+                                                                "buf = " + effect + ".createImageBuffer(NatronEngine.ImageLayer.getRGBAComponents(), NatronEngine.RectI(0, 0, 8, 4))\n",
+                                                                &err, 0) ) << err;
+
+    U64 hashBefore = source->getHashValue();
+    {
+        PythonGILLocker pgl;
+        PyObject* buf = getPythonVariable("buf");
+        ASSERT_TRUE(buf != 0 && buf != Py_None);
+
+        // The buffer spans whole rows: it is C-contiguous but not Fortran-contiguous
+        EXPECT_TRUE( canGetBuffer(buf, PyBUF_C_CONTIGUOUS) );
+        EXPECT_TRUE( canGetBuffer(buf, PyBUF_ANY_CONTIGUOUS) );
+        EXPECT_FALSE( canGetBuffer(buf, PyBUF_F_CONTIGUOUS) );
+
+        Py_buffer view;
+        ASSERT_EQ( 0, PyObject_GetBuffer(buf, &view, PyBUF_SIMPLE) );
+        EXPECT_EQ(1, view.ndim);
+        EXPECT_TRUE(view.shape == 0);
+        EXPECT_TRUE(view.format == 0);
+        EXPECT_EQ( (Py_ssize_t)(width * height * 4 * sizeof(float)), view.len );
+        PyBuffer_Release(&view);
+
+        ASSERT_EQ( 0, PyObject_GetBuffer(buf, &view, PyBUF_RECORDS) );
+        EXPECT_EQ(3, view.ndim);
+        EXPECT_EQ(height, view.shape[0]);
+        EXPECT_EQ(width, view.shape[1]);
+        EXPECT_EQ(4, view.shape[2]);
+        EXPECT_EQ( (Py_ssize_t)(width * 4 * sizeof(float)), view.strides[0] );
+        EXPECT_EQ( (Py_ssize_t)(4 * sizeof(float)), view.strides[1] );
+        EXPECT_EQ( (Py_ssize_t)sizeof(float), view.strides[2] );
+        EXPECT_EQ( std::string("f"), std::string(view.format) );
+        EXPECT_EQ(0, view.readonly);
+        float* pixels = (float*)view.buf;
+        for (int i = 0; i < width * height * 4; ++i) {
+            pixels[i] = i * 0.25f;
+        }
+        PyBuffer_Release(&view);
+    }
+
+    // The released pixels become the output of the node and change its hash
+    ASSERT_TRUE( NATRON_PYTHON_NAMESPACE::interpretPythonScript("buf.release()\n"
+                                                                "out = " + effect + ".renderImage(0, 0, 1., NatronEngine.ImageLayer.getRGBAComponents(), NatronEngine.RectI(2, 1, 6, 3))\n",
+                                                                &err, 0) ) << err;
+    EXPECT_NE( hashBefore, source->getHashValue() );
+
+    {
+        PythonGILLocker pgl;
+        PyObject* out = getPythonVariable("out");
+        ASSERT_TRUE(out != 0 && out != Py_None);
+
+        // Rendered images are read-only
+        EXPECT_FALSE( canGetBuffer(out, PyBUF_WRITABLE) );
+        EXPECT_FALSE( canGetBuffer(out, PyBUF_F_CONTIGUOUS) );
+
+        Py_buffer view;
+        ASSERT_EQ( 0, PyObject_GetBuffer(out, &view, PyBUF_RECORDS_RO) );
+        EXPECT_EQ(1, view.readonly);
+        ASSERT_EQ(2, view.shape[0]);
+        ASSERT_EQ(4, view.shape[1]);
+        ASSERT_EQ(4, view.shape[2]);
+        // The rendered image may be larger than the RoI, in which case its rows are not contiguous
+        EXPECT_EQ( view.strides[0] == (Py_ssize_t)(4 * 4 * sizeof(float)), canGetBuffer(out, PyBUF_C_CONTIGUOUS) );
+        for (int y = 0; y < 2; ++y) {
+            for (int x = 0; x < 4; ++x) {
+                for (int c = 0; c < 4; ++c) {
+                    const char* pix = (const char*)view.buf + y * view.strides[0] + x * view.strides[1] + c * view.strides[2];
+                    EXPECT_EQ( ( ( (y + 1) * width + (x + 2) ) * 4 + c ) * 0.25f, *(const float*)pix );
+                }
+            }
+        }
+        PyBuffer_Release(&view);
+    }
+
+    ASSERT_TRUE( NATRON_PYTHON_NAMESPACE::interpretPythonScript("out.release()\n"
+                                                                "del buf, out\n", &err, 0) ) << err;
+} // TEST_F
+
+#endif // NATRON_RUN_WITHOUT_PYTHON
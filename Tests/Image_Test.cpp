@@ -24,10 +24,14 @@
 
 #include "Global/Macros.h"
 
+#include <algorithm> // min, max
+#include <cmath> // abs
 #include <cstring>
 #include <gtest/gtest.h>
 
+#include "Engine/FrameEntry.h"
 #include "Engine/Image.h"
+#include "Engine/Lut.h"
 #include "Engine/ViewIdx.h"
 
 NATRON_NAMESPACE_USING
@@ -159,3 +163,429 @@ TEST(ImageKeyTest, Difference) {
     ASSERT_TRUE(keyHash1 != keyHash2);
 }
 
+
+TEST(ImageTest, DownscaleMipMap) {
+    // A 4 levels downscale must give the average of each 16x16 block, including the incomplete blocks
+    // on the borders of the region
+    const RectI bounds(0, 0, 100, 70);
+    const RectD rod(0, 0, 100, 70);
+    const unsigned int level = 4;
+    const int scale = 1 << level;
+    Image src(ImagePlaneDesc::getRGBAComponents(), rod, bounds, 0, 1., eImageBitDepthFloat,
+              eImagePremultiplicationPremultiplied, eImageFieldingOrderNone, false);
+
+    {
+        Image::WriteAccess acc(&src);
+        for (int y = bounds.y1; y < bounds.y2; ++y) {
+            float* pix = (float*)acc.pixelAt(bounds.x1, y);
+            for (int x = bounds.x1; x < bounds.x2; ++x, pix += 4) {
+                pix[0] = (float)x;
+                pix[1] = (float)y;
+                pix[2] = (float)( (x * 7 + y * 13) % 17 );
+                pix[3] = 1.f;
+            }
+        }
+    }
+
+    const RectI dstBounds = bounds.downscalePowerOfTwoSmallestEnclosing(level);
+    Image dst(ImagePlaneDesc::getRGBAComponents(), rod, dstBounds, level, 1., eImageBitDepthFloat,
+              eImagePremultiplicationPremultiplied, eImageFieldingOrderNone, false);
+    src.downscaleMipMap(rod, bounds, 0, level, false, &dst);
+
+    Image::ReadAccess srcAcc(&src);
+    Image::ReadAccess dstAcc(&dst);
+    for (int y = dstBounds.y1; y < dstBounds.y2; ++y) {
+        const float* pix = (const float*)dstAcc.pixelAt(dstBounds.x1, y);
+        for (int x = dstBounds.x1; x < dstBounds.x2; ++x, pix += 4) {
+            double expected[4] = {0., 0., 0., 0.};
+            int count = 0;
+            for (int sy = std::max(y * scale, bounds.y1); sy < std::min( (y + 1) * scale, bounds.y2 ); ++sy) {
+                const float* srcPix = (const float*)srcAcc.pixelAt(std::max(x * scale, bounds.x1), sy);
+                for (int sx = std::max(x * scale, bounds.x1); sx < std::min( (x + 1) * scale, bounds.x2 ); ++sx, srcPix += 4) {
+                    for (int k = 0; k < 4; ++k) {
+                        expected[k] += srcPix[k];
+                    }
+                    ++count;
+                }
+            }
+            ASSERT_TRUE(count > 0);
+            for (int k = 0; k < 4; ++k) {
+                EXPECT_NEAR(expected[k] / count, pix[k], 1e-4);
+            }
+        }
+    }
+}
+
+// Fills the image with values covering the range of its depth, including out of [0,1] float values
+static void
+fillConvertTestImage(Image* img)
+{
+    const RectI bounds = img->getBounds();
+    const int nComps = (int)img->getComponentsCount();
+    Image::WriteAccess acc(img);
+    unsigned int seed = 1;
+
+    for (int y = bounds.y1; y < bounds.y2; ++y) {
+        unsigned char* pix = acc.pixelAt(bounds.x1, y);
+        for (int i = 0; i < bounds.width() * nComps; ++i) {
+            seed = seed * 1103515245 + 12345;
+            const unsigned int r = (seed >> 8) & 0xffff;
+            switch ( img->getBitDepth() ) {
+            case eImageBitDepthByte:
+                pix[i] = (unsigned char)(r & 0xff);
+                break;
+            case eImageBitDepthShort:
+                ( (unsigned short*)pix )[i] = (unsigned short)r;
+                break;
+            case eImageBitDepthFloat:
+                ( (float*)pix )[i] = r / 50000.f - 0.1f;
+                break;
+            default:
+                break;
+            }
+        }
+    }
+}
+
+template <typename SRCPIX, typename DSTPIX>
+static void
+checkConvertDepth(ImageBitDepthEnum srcDepth,
+                  ImageBitDepthEnum dstDepth)
+{
+    // Large enough to be converted by several threads
+    const RectI bounds(0, 0, 640, 480);
+    const RectD rod(0, 0, 640, 480);
+    Image src(ImagePlaneDesc::getRGBAComponents(), rod, bounds, 0, 1., srcDepth,
+              eImagePremultiplicationPremultiplied, eImageFieldingOrderNone, false);
+    Image dst(ImagePlaneDesc::getRGBAComponents(), rod, bounds, 0, 1., dstDepth,
+              eImagePremultiplicationPremultiplied, eImageFieldingOrderNone, false);
+
+    fillConvertTestImage(&src);
+    src.convertToFormat(bounds, eViewerColorSpaceLinear, eViewerColorSpaceLinear, -1, false, false, &dst);
+
+    Image::ReadAccess srcAcc(&src);
+    Image::ReadAccess dstAcc(&dst);
+    for (int y = bounds.y1; y < bounds.y2; ++y) {
+        const SRCPIX* srcPix = (const SRCPIX*)srcAcc.pixelAt(bounds.x1, y);
+        const DSTPIX* dstPix = (const DSTPIX*)dstAcc.pixelAt(bounds.x1, y);
+        for (int i = 0; i < bounds.width() * 4; ++i) {
+            ASSERT_EQ( (Image::convertPixelDepth<SRCPIX, DSTPIX>(srcPix[i])), dstPix[i] );
+        }
+    }
+}
+
+TEST(ImageTest, ConvertToFormatDepth) {
+    // Without colorspace conversion, each value is converted with convertPixelDepth
+    checkConvertDepth<unsigned char, unsigned char>(eImageBitDepthByte, eImageBitDepthByte);
+    checkConvertDepth<unsigned char, unsigned short>(eImageBitDepthByte, eImageBitDepthShort);
+    checkConvertDepth<unsigned char, float>(eImageBitDepthByte, eImageBitDepthFloat);
+    checkConvertDepth<unsigned short, unsigned char>(eImageBitDepthShort, eImageBitDepthByte);
+    checkConvertDepth<unsigned short, unsigned short>(eImageBitDepthShort, eImageBitDepthShort);
+    checkConvertDepth<unsigned short, float>(eImageBitDepthShort, eImageBitDepthFloat);
+    checkConvertDepth<float, unsigned char>(eImageBitDepthFloat, eImageBitDepthByte);
+    checkConvertDepth<float, unsigned short>(eImageBitDepthFloat, eImageBitDepthShort);
+    checkConvertDepth<float, float>(eImageBitDepthFloat, eImageBitDepthFloat);
+}
+
+TEST(ImageTest, ConvertToFormatComponents) {
+    const RectI bounds(0, 0, 640, 480);
+    const RectD rod(0, 0, 640, 480);
+    Image rgba(ImagePlaneDesc::getRGBAComponents(), rod, bounds, 0, 1., eImageBitDepthFloat,
+               eImagePremultiplicationPremultiplied, eImageFieldingOrderNone, false);
+    Image xy(ImagePlaneDesc::getXYComponents(), rod, bounds, 0, 1., eImageBitDepthFloat,
+             eImagePremultiplicationOpaque, eImageFieldingOrderNone, false);
+    Image alpha(ImagePlaneDesc::getAlphaComponents(), rod, bounds, 0, 1., eImageBitDepthFloat,
+                eImagePremultiplicationPremultiplied, eImageFieldingOrderNone, false);
+    Image rgb(ImagePlaneDesc::getRGBComponents(), rod, bounds, 0, 1., eImageBitDepthFloat,
+              eImagePremultiplicationOpaque, eImageFieldingOrderNone, false);
+    Image rgbaFromXY(ImagePlaneDesc::getRGBAComponents(), rod, bounds, 0, 1., eImageBitDepthFloat,
+                     eImagePremultiplicationOpaque, eImageFieldingOrderNone, false);
+    Image rgbaFromAlpha(ImagePlaneDesc::getRGBAComponents(), rod, bounds, 0, 1., eImageBitDepthFloat,
+                        eImagePremultiplicationPremultiplied, eImageFieldingOrderNone, false);
+
+    fillConvertTestImage(&rgba);
+    fillConvertTestImage(&xy);
+    // RGBA --> Alpha takes the alpha channel
+    rgba.convertToFormat(bounds, eViewerColorSpaceLinear, eViewerColorSpaceLinear, -1, false, false, &alpha);
+    // RGBA --> RGB with unpremultiplication and colorspace conversion
+    rgba.convertToFormat(bounds, eViewerColorSpaceLinear, eViewerColorSpaceSRGB, -1, false, true, &rgb);
+    // XY --> RGBA: B is black and A is opaque
+    xy.convertToFormat(bounds, eViewerColorSpaceLinear, eViewerColorSpaceLinear, -1, false, false, &rgbaFromXY);
+    // Alpha --> RGBA: the channel is copied to all the channels
+    alpha.convertToFormat(bounds, eViewerColorSpaceLinear, eViewerColorSpaceLinear, -1, false, false, &rgbaFromAlpha);
+
+    const Color::Lut* srgb = Color::LutManager::sRGBLut();
+    Image::ReadAccess rgbaAcc(&rgba);
+    Image::ReadAccess xyAcc(&xy);
+    Image::ReadAccess alphaAcc(&alpha);
+    Image::ReadAccess rgbAcc(&rgb);
+    Image::ReadAccess rgbaFromXYAcc(&rgbaFromXY);
+    Image::ReadAccess rgbaFromAlphaAcc(&rgbaFromAlpha);
+    for (int y = bounds.y1; y < bounds.y2; ++y) {
+        const float* rgbaPix = (const float*)rgbaAcc.pixelAt(bounds.x1, y);
+        const float* xyPix = (const float*)xyAcc.pixelAt(bounds.x1, y);
+        const float* alphaPix = (const float*)alphaAcc.pixelAt(bounds.x1, y);
+        const float* rgbPix = (const float*)rgbAcc.pixelAt(bounds.x1, y);
+        const float* rgbaFromXYPix = (const float*)rgbaFromXYAcc.pixelAt(bounds.x1, y);
+        const float* rgbaFromAlphaPix = (const float*)rgbaFromAlphaAcc.pixelAt(bounds.x1, y);
+        for (int x = bounds.x1; x < bounds.x2; ++x) {
+            ASSERT_EQ(rgbaPix[3], alphaPix[0]);
+            for (int k = 0; k < 3; ++k) {
+                const float a = rgbaPix[3];
+                const float unpremult = a == 0.f ? 0.f : rgbaPix[k] / a;
+                ASSERT_EQ(srgb->toColorSpaceFloatFromLinearFloat(unpremult), rgbPix[k]);
+            }
+            ASSERT_EQ(xyPix[0], rgbaFromXYPix[0]);
+            ASSERT_EQ(xyPix[1], rgbaFromXYPix[1]);
+            ASSERT_EQ(0.f, rgbaFromXYPix[2]);
+            ASSERT_EQ(1.f, rgbaFromXYPix[3]);
+            for (int k = 0; k < 4; ++k) {
+                ASSERT_EQ(alphaPix[0], rgbaFromAlphaPix[k]);
+            }
+            rgbaPix += 4;
+            xyPix += 2;
+            alphaPix += 1;
+            rgbPix += 3;
+            rgbaFromXYPix += 4;
+            rgbaFromAlphaPix += 4;
+        }
+    }
+}
+
+TEST(ImageTest, ConvertToFormatDither) {
+    // 8 bits outputs of a components conversion are dithered: each value is rounded either down or up
+    const RectI bounds(0, 0, 640, 480);
+    const RectD rod(0, 0, 640, 480);
+    Image src(ImagePlaneDesc::getRGBAComponents(), rod, bounds, 0, 1., eImageBitDepthFloat,
+              eImagePremultiplicationPremultiplied, eImageFieldingOrderNone, false);
+    Image dst(ImagePlaneDesc::getRGBComponents(), rod, bounds, 0, 1., eImageBitDepthByte,
+              eImagePremultiplicationOpaque, eImageFieldingOrderNone, false);
+
+    fillConvertTestImage(&src);
+    src.convertToFormat(bounds, eViewerColorSpaceLinear, eViewerColorSpaceLinear, -1, false, false, &dst);
+
+    Image::ReadAccess srcAcc(&src);
+    Image::ReadAccess dstAcc(&dst);
+    for (int y = bounds.y1; y < bounds.y2; ++y) {
+        const float* srcPix = (const float*)srcAcc.pixelAt(bounds.x1, y);
+        const unsigned char* dstPix = (const unsigned char*)dstAcc.pixelAt(bounds.x1, y);
+        for (int x = bounds.x1; x < bounds.x2; ++x, srcPix += 4, dstPix += 3) {
+            for (int k = 0; k < 3; ++k) {
+                const int value = Color::floatToInt<0xff01>(srcPix[k]);
+                ASSERT_TRUE( dstPix[k] == (value >> 8) || dstPix[k] == (value >> 8) + 1 );
+            }
+        }
+    }
+}
+
+static void
+checkPostRenderSteps(bool masked,
+                     bool premult,
+                     bool unpremult)
+{
+    const RectI bounds(0, 0, 320, 240);
+    const RectD rod(0, 0, 400, 300);
+    // The original and the mask images only partially cover the rendered image
+    const RectI originalBounds(-20, 30, 300, 300);
+    const RectI maskBounds(50, -10, 400, 200);
+    Image sequential(ImagePlaneDesc::getRGBAComponents(), rod, bounds, 0, 1., eImageBitDepthFloat,
+                     eImagePremultiplicationPremultiplied, eImageFieldingOrderNone, false);
+    Image fused(ImagePlaneDesc::getRGBAComponents(), rod, bounds, 0, 1., eImageBitDepthFloat,
+                eImagePremultiplicationPremultiplied, eImageFieldingOrderNone, false);
+    ImagePtr original( new Image(ImagePlaneDesc::getRGBAComponents(), rod, originalBounds, 0, 1., eImageBitDepthFloat,
+                                 eImagePremultiplicationPremultiplied, eImageFieldingOrderNone, false) );
+    Image mask(ImagePlaneDesc::getAlphaComponents(), rod, maskBounds, 0, 1., eImageBitDepthFloat,
+               eImagePremultiplicationOpaque, eImageFieldingOrderNone, false);
+
+    fillConvertTestImage(&sequential);
+    fillConvertTestImage(&fused);
+    fillConvertTestImage( original.get() );
+    fillConvertTestImage(&mask);
+
+    Image::PostRenderSteps steps;
+    steps.copyUnProcessedChannels = true;
+    steps.processChannels[0] = steps.processChannels[1] = steps.processChannels[2] = true; // alpha is copied
+    steps.originalImage = original;
+    steps.maskMix = true;
+    steps.maskImg = &mask;
+    steps.masked = masked;
+    steps.mix = 0.7f;
+    steps.premult = premult;
+    steps.unpremult = unpremult;
+
+    const RectI roi(10, 10, 310, 230);
+    sequential.copyUnProcessedChannels(roi, steps.outputPremult, steps.originalImagePremult, steps.processChannels, original, steps.ignorePremult);
+    sequential.applyMaskMix(roi, &mask, original.get(), masked, false, steps.mix);
+    if (premult) {
+        sequential.premultImage(roi);
+    } else if (unpremult) {
+        sequential.unpremultImage(roi);
+    }
+    fused.applyPostRenderSteps(roi, steps);
+
+    Image::ReadAccess sequentialAcc(&sequential);
+    Image::ReadAccess fusedAcc(&fused);
+    for (int y = bounds.y1; y < bounds.y2; ++y) {
+        const float* sequentialPix = (const float*)sequentialAcc.pixelAt(bounds.x1, y);
+        const float* fusedPix = (const float*)fusedAcc.pixelAt(bounds.x1, y);
+        for (int i = 0; i < bounds.width() * 4; ++i) {
+            ASSERT_EQ(sequentialPix[i], fusedPix[i]);
+        }
+    }
+}
+
+TEST(ImageTest, PostRenderSteps) {
+    // The fused pass gives the same results as the separate functions
+    checkPostRenderSteps(false, false, false);
+    checkPostRenderSteps(true, false, false);
+    checkPostRenderSteps(true, true, false);
+    checkPostRenderSteps(true, false, true);
+}
+
+TEST(ImageTest, HalfStorage) {
+    const RectI bounds(0, 0, 320, 240);
+    const RectD rod(0, 0, 320, 240);
+    Image img(ImagePlaneDesc::getRGBAComponents(), rod, bounds, 0, 1., eImageBitDepthFloat,
+              eImagePremultiplicationPremultiplied, eImageFieldingOrderNone, false);
+    Image reference(ImagePlaneDesc::getRGBAComponents(), rod, bounds, 0, 1., eImageBitDepthFloat,
+                    eImagePremultiplicationPremultiplied, eImageFieldingOrderNone, false);
+
+    // Values in [0.001, 1.31]: a half float changes them by at most 2^-11 of their value
+    {
+        Image::WriteAccess imgAcc(&img);
+        Image::WriteAccess referenceAcc(&reference);
+        unsigned int seed = 1;
+        for (int y = bounds.y1; y < bounds.y2; ++y) {
+            float* imgPix = (float*)imgAcc.pixelAt(bounds.x1, y);
+            float* referencePix = (float*)referenceAcc.pixelAt(bounds.x1, y);
+            for (int i = 0; i < bounds.width() * 4; ++i) {
+                seed = seed * 1103515245 + 12345;
+                imgPix[i] = referencePix[i] = (i % 5 == 0) ? 0.f : ( (seed >> 8) & 0xffff ) / 50000.f + 0.001f;
+            }
+        }
+    }
+
+    // Only allowed images are compacted
+    ASSERT_FALSE( img.compactMemory() );
+    img.setHalfStorageAllowed(true, 0.001);
+    ASSERT_TRUE( img.compactMemory() );
+    ASSERT_TRUE( img.isStoredAsHalf() );
+    ASSERT_LT( img.size(), reference.size() );
+
+    // allocateMemory() restores the floats, within the precision of a half float
+    img.allocateMemory();
+    ASSERT_FALSE( img.isStoredAsHalf() );
+    {
+        Image::ReadAccess imgAcc(&img);
+        Image::ReadAccess referenceAcc(&reference);
+        for (int y = bounds.y1; y < bounds.y2; ++y) {
+            const float* imgPix = (const float*)imgAcc.pixelAt(bounds.x1, y);
+            const float* referencePix = (const float*)referenceAcc.pixelAt(bounds.x1, y);
+            for (int i = 0; i < bounds.width() * 4; ++i) {
+                ASSERT_LE( std::abs(imgPix[i] - referencePix[i]), std::abs(referencePix[i]) / 2048.f );
+            }
+        }
+    }
+
+    // Subnormal half floats are within the error bound
+    {
+        Image::WriteAccess acc(&img);
+        ( (float*)acc.pixelAt(10, 10) )[0] = 2e-5f;
+    }
+    ASSERT_TRUE( img.compactMemory() );
+    img.allocateMemory();
+    {
+        Image::ReadAccess acc(&img);
+        ASSERT_LE( std::abs( ( (const float*)acc.pixelAt(10, 10) )[0] - 2e-5f ), 1.f / 33554432.f );
+    }
+
+    // Values out of the half float range are kept in full precision
+    {
+        Image::WriteAccess acc(&img);
+        ( (float*)acc.pixelAt(10, 10) )[0] = 1e6f;
+    }
+    img.setHalfStorageAllowed(true, 1.);
+    ASSERT_FALSE( img.compactMemory() );
+    ASSERT_FALSE( img.isStoredAsHalf() );
+
+    // So are the data planes
+    Image motion(ImagePlaneDesc::getForwardMotionComponents(), rod, bounds, 0, 1., eImageBitDepthFloat,
+                 eImagePremultiplicationOpaque, eImageFieldingOrderNone, false);
+    fillConvertTestImage(&motion);
+    motion.setHalfStorageAllowed(true, 1.);
+    ASSERT_FALSE( motion.compactMemory() );
+}
+
+TEST(ImageTest, HalfStorageMaxError) {
+    // Values in [8, 12) change by up to 2^-8 when stored as half floats
+    const RectI bounds(0, 0, 64, 64);
+    Image img(ImagePlaneDesc::getRGBAComponents(), RectD(0, 0, 64, 64), bounds, 0, 1., eImageBitDepthFloat,
+              eImagePremultiplicationPremultiplied, eImageFieldingOrderNone, false);
+    {
+        Image::WriteAccess acc(&img);
+        for (int y = bounds.y1; y < bounds.y2; ++y) {
+            float* pix = (float*)acc.pixelAt(bounds.x1, y);
+            for (int i = 0; i < bounds.width() * 4; ++i) {
+                pix[i] = 8.f + (y * bounds.width() * 4 + i) * (4.f / 16384.f) + 0.001f;
+            }
+        }
+    }
+
+    // The error exceeds a budget of 0.001...
+    img.setHalfStorageAllowed(true, 0.001);
+    ASSERT_FALSE( img.compactMemory() );
+    ASSERT_FALSE( img.isStoredAsHalf() );
+
+    // ...but not a budget of 0.01
+    img.setHalfStorageAllowed(true, 0.01);
+    ASSERT_TRUE( img.compactMemory() );
+    img.allocateMemory();
+    {
+        Image::ReadAccess acc(&img);
+        for (int y = bounds.y1; y < bounds.y2; ++y) {
+            const float* pix = (const float*)acc.pixelAt(bounds.x1, y);
+            for (int i = 0; i < bounds.width() * 4; ++i) {
+                ASSERT_LE( std::abs( pix[i] - ( 8.f + (y * bounds.width() * 4 + i) * (4.f / 16384.f) + 0.001f ) ), 1.f / 256.f );
+            }
+        }
+    }
+}
+
+TEST(ImageTest, HalfStorageWeakReference) {
+    // The viewer cache entries keep a weak pointer to the image they were made from and read its pixels without calling
+    // allocateMemory(): the image must not be compacted while they reference it
+    const RectI bounds(0, 0, 64, 64);
+    ImagePtr img( new Image(ImagePlaneDesc::getRGBAComponents(), RectD(0, 0, 64, 64), bounds, 0, 1., eImageBitDepthFloat,
+                            eImagePremultiplicationPremultiplied, eImageFieldingOrderNone, false) );
+
+    img->fill(bounds, 0.5f, 0.25f, 0.125f, 1.f);
+    img->setHalfStorageAllowed(true, 0.001);
+    {
+        FrameParams paramsCopy;
+        {
+            FrameParamsPtr params( new FrameParams(bounds, eImageBitDepthFloat, bounds, img) );
+            FrameEntry entry(FrameKey(), params, NULL);
+
+            ASSERT_FALSE( img->compactMemory() );
+            ASSERT_FALSE( img->isStoredAsHalf() );
+
+            ImagePtr internalImage = entry.getInternalImage();
+            ASSERT_TRUE(internalImage == img);
+            {
+                Image::ReadAccess acc( internalImage.get() );
+                const float* pix = (const float*)acc.pixelAt(32, 32);
+                ASSERT_TRUE(pix);
+                ASSERT_EQ(0.5f, pix[0]);
+                ASSERT_EQ(0.125f, pix[2]);
+            }
+            paramsCopy = *params;
+        }
+
+        // The copies of the parameters reference the image too
+        ASSERT_FALSE( img->compactMemory() );
+    }
+
+    // Once no entry references it, the image may be compacted again
+    ASSERT_TRUE( img->compactMemory() );
+    ASSERT_TRUE( img->isStoredAsHalf() );
+}
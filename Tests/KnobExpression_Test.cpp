@@ -0,0 +1,66 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <string>
+
+#include "BaseTest.h"
+
+#include "Engine/EffectInstance.h"
+#include "Engine/KnobTypes.h"
+#include "Engine/Node.h"
+
+NATRON_NAMESPACE_USING
+
+#ifndef NATRON_RUN_WITHOUT_PYTHON
+
+TEST_F(BaseTest, ExpressionDependenciesAge)
+{
+    NodePtr source = createNode( QString::fromUtf8(PLUGINID_NATRON_IMAGEBUFFER) );
+    NodePtr target = createNode( QString::fromUtf8(PLUGINID_NATRON_IMAGEBUFFER) );
+    ASSERT_TRUE(source && target);
+
+    KnobDoublePtr sourceKnob = source->getEffectInstance()->createDoubleKnob("exprSource", "Source", 1, true);
+    KnobDoublePtr targetKnob = target->getEffectInstance()->createDoubleKnob("exprTarget", "Target", 1, true);
+    ASSERT_TRUE(sourceKnob && targetKnob);
+
+    // Without expression there is nothing to depend on
+    U64 noExpressionAge = targetKnob->getExpressionDependenciesAge();
+    sourceKnob->setValue(2.);
+    EXPECT_EQ( noExpressionAge, targetKnob->getExpressionDependenciesAge() );
+
+    targetKnob->setExpression(0, "thisGroup." + source->getScriptName() + ".exprSource.get() * 2", false, true);
+    EXPECT_EQ( 4., targetKnob->getValue() );
+
+    U64 age = targetKnob->getExpressionDependenciesAge();
+    EXPECT_EQ( age, targetKnob->getExpressionDependenciesAge() );
+
+    // Changing the referenced parameter of the other node must be seen by whoever caches the expression results
+    sourceKnob->setValue(3.);
+    EXPECT_EQ( 6., targetKnob->getValue() );
+    EXPECT_NE( age, targetKnob->getExpressionDependenciesAge() );
+}
+
+#endif // NATRON_RUN_WITHOUT_PYTHON
@@ -0,0 +1,137 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <cstddef>
+#include <gtest/gtest.h>
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+#endif
+
+#include "Global/GlobalDefines.h"
+#include "Engine/LRUHashTable.h"
+
+NATRON_NAMESPACE_USING
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+class FakeCacheEntry
+{
+public:
+
+    FakeCacheEntry(double recomputeCost,
+                   std::size_t bytes)
+        : _recomputeCost(recomputeCost)
+        , _bytes(bytes)
+    {
+    }
+
+    double getRecomputeCost() const
+    {
+        return _recomputeCost;
+    }
+
+    std::size_t size() const
+    {
+        return _bytes;
+    }
+
+private:
+    double _recomputeCost;
+    std::size_t _bytes;
+};
+
+typedef boost::shared_ptr<FakeCacheEntry> FakeCacheEntryPtr;
+typedef BoostLRUHashTable<U64, FakeCacheEntryPtr> FakeCacheTable;
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+TEST(LRUHashTable, LeastRecentlyUsedEviction)
+{
+    FakeCacheTable table;
+
+    table.insert( 1, boost::make_shared<FakeCacheEntry>(10., 100) );
+    table.insert( 2, boost::make_shared<FakeCacheEntry>(0.1, 1000000) );
+
+    // Accessing the first key makes the second one the least recently used
+    ASSERT_TRUE( table(1) != table.end() );
+    EXPECT_EQ( (U64)2, table.evict().first );
+    EXPECT_EQ( (U64)1, table.evict().first );
+}
+
+TEST(LRUHashTable, CostAwareEvictionOrder)
+{
+    FakeCacheTable table;
+
+    table.setCostAwareEvictionEnabled(true);
+    ASSERT_TRUE( table.isCostAwareEvictionEnabled() );
+
+    // The expensive small entry is the least recently used: LRU would evict it first
+    table.insert( 1, boost::make_shared<FakeCacheEntry>(10., 100) );
+    table.insert( 2, boost::make_shared<FakeCacheEntry>(0.1, 1000000) );
+
+    std::pair<U64, FakeCacheEntryPtr> evicted = table.evict();
+    ASSERT_TRUE( evicted.second.get() );
+    EXPECT_EQ( (U64)2, evicted.first ) << "The cheap large entry must be evicted before the expensive small one";
+    EXPECT_EQ( 1u, table.size() );
+
+    evicted = table.evict();
+    EXPECT_EQ( (U64)1, evicted.first );
+    EXPECT_EQ( 0u, table.size() );
+}
+
+TEST(LRUHashTable, CostAwareEvictionSkipsReferencedEntries)
+{
+    FakeCacheTable table;
+
+    table.insert( 1, boost::make_shared<FakeCacheEntry>(10., 100) );
+    table.insert( 2, boost::make_shared<FakeCacheEntry>(0.1, 1000000) );
+
+    // Entries indexed when the policy is enabled must be ordered the same way
+    table.setCostAwareEvictionEnabled(true);
+
+    FakeCacheTable::container_type::left_iterator cheap = table(2);
+    ASSERT_TRUE( cheap != table.end() );
+    FakeCacheEntryPtr inUse = cheap->second.front();
+
+    EXPECT_EQ( (U64)1, table.evict().first ) << "An entry referenced outside of the table cannot be evicted";
+    inUse.reset();
+    EXPECT_EQ( (U64)2, table.evict().first );
+}
+
+TEST(LRUHashTable, EraseRemovesCostIndexRecord)
+{
+    FakeCacheTable table;
+
+    table.setCostAwareEvictionEnabled(true);
+    table.insert( 1, boost::make_shared<FakeCacheEntry>(0.1, 1000000) );
+    table.insert( 2, boost::make_shared<FakeCacheEntry>(10., 100) );
+
+    table.erase( table(1) );
+    EXPECT_EQ( (U64)2, table.evict().first );
+    EXPECT_FALSE( table.evict().second.get() );
+}
@@ -0,0 +1,87 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <set>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Gui/NodeGraphSpatialIndex.h"
+
+NATRON_NAMESPACE_USING
+
+// The index only uses the nodes as keys and never dereferences them
+static NodeGui*
+fakeNode(std::vector<char>& storage,
+         int i)
+{
+    return reinterpret_cast<NodeGui*>(&storage[i]);
+}
+
+static bool
+queryContains(const NodeGraphSpatialIndex& index,
+              const QRectF& rect,
+              NodeGui* node)
+{
+    std::set<NodeGui*> nodes;
+
+    index.query(rect, &nodes);
+
+    return nodes.find(node) != nodes.end();
+}
+
+TEST(NodeGraphSpatialIndex, BackdropResize)
+{
+    std::vector<char> storage(64);
+    NodeGraphSpatialIndex index;
+
+    // A row of small nodes, so that small queries go through the grid and not through the linear scan
+    for (int i = 1; i < 64; ++i) {
+        index.insertOrUpdate( fakeNode(storage, i), QRectF(i * 300., -1000., 80., 30.) );
+    }
+
+    // What NodeGui::resize() does for a backdrop: update the bounding box of the node without moving it
+    NodeGui* backdrop = fakeNode(storage, 0);
+    index.insertOrUpdate( backdrop, QRectF(0., 0., 200., 100.) );
+    const QRectF farCorner(750., 550., 10., 10.);
+    EXPECT_FALSE( queryContains(index, farCorner, backdrop) );
+
+    index.insertOrUpdate( backdrop, QRectF(0., 0., 800., 600.) );
+    EXPECT_TRUE( queryContains(index, farCorner, backdrop) );
+    EXPECT_TRUE( queryContains(index, QRectF(10., 10., 10., 10.), backdrop) );
+    // A query covering more cells than there are nodes scans all the nodes
+    EXPECT_TRUE( queryContains(index, QRectF(-5000., -5000., 10000., 10000.), backdrop) );
+    EXPECT_EQ( (std::size_t)64, index.size() );
+
+    // Shrinking it back must remove it from the cells it no longer covers
+    index.insertOrUpdate( backdrop, QRectF(0., 0., 200., 100.) );
+    EXPECT_FALSE( queryContains(index, farCorner, backdrop) );
+    EXPECT_TRUE( queryContains(index, QRectF(10., 10., 10., 10.), backdrop) );
+
+    index.remove(backdrop);
+    EXPECT_FALSE( queryContains(index, QRectF(10., 10., 10., 10.), backdrop) );
+    EXPECT_EQ( (std::size_t)63, index.size() );
+}
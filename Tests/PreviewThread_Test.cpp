@@ -0,0 +1,96 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Gui/PreviewThread.h"
+
+NATRON_NAMESPACE_USING
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+struct NullDeleter
+{
+    void operator()(NodeGui*) const
+    {
+    }
+};
+
+// The requests only use the nodes as keys and never dereference them
+NodeGuiPtr
+fakeNode(std::vector<char>& storage,
+         int i)
+{
+    return NodeGuiPtr( reinterpret_cast<NodeGui*>(&storage[i]), NullDeleter() );
+}
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+TEST(PreviewThread, StaleRequests)
+{
+    std::vector<char> storage(2);
+    NodeGuiPtr a = fakeNode(storage, 0);
+    NodeGuiPtr b = fakeNode(storage, 1);
+    PreviewRequests requests;
+
+    U64 first = requests.addRequest(a);
+    U64 second = requests.addRequest(a);
+    U64 other = requests.addRequest(b);
+
+    EXPECT_TRUE( requests.isRequestStale(a, first) );
+    EXPECT_FALSE( requests.isRequestStale(a, second) );
+    EXPECT_FALSE( requests.isRequestStale(b, other) );
+
+    requests.removeNode(a);
+    EXPECT_FALSE( requests.isRequestStale(a, first) ) << "Requests of a node without a queued request are not stale";
+    EXPECT_EQ( (std::size_t)1, requests.size() );
+}
+
+TEST(PreviewThread, DeletedNodeRequests)
+{
+    std::vector<char> storage(1);
+    PreviewRequests requests;
+    NodeGuiPtr deleted = fakeNode(storage, 0);
+    NodeGuiWPtr deletedWeak = deleted;
+
+    U64 deletedRequest = requests.addRequest(deleted);
+    deleted.reset();
+    ASSERT_TRUE( deletedWeak.expired() );
+
+    // A node created at the same address is another node
+    NodeGuiPtr reused = fakeNode(storage, 0);
+    U64 reusedRequest = requests.addRequest(reused);
+    EXPECT_EQ( (std::size_t)2, requests.size() );
+    EXPECT_FALSE( requests.isRequestStale(deletedWeak, deletedRequest) );
+    EXPECT_FALSE( requests.isRequestStale(reused, reusedRequest) );
+
+    // The request of the deleted node is removed through its expired pointer
+    requests.removeNode(deletedWeak);
+    EXPECT_EQ( (std::size_t)1, requests.size() );
+    EXPECT_FALSE( requests.isRequestStale(reused, reusedRequest) );
+}
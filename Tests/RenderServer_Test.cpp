@@ -0,0 +1,88 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <gtest/gtest.h>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+
+#include "Engine/CLArgs.h"
+#include "Engine/RenderServer.h"
+
+NATRON_NAMESPACE_USING
+
+static CLArgs
+makeJobArgs(const QStringList& arguments)
+{
+    QStringList args = arguments;
+
+    args.push_front( QCoreApplication::applicationFilePath() );
+
+    return CLArgs(args, true);
+}
+
+TEST(RenderServer, ProjectReuse)
+{
+    const QString projectPath = QDir::temp().absoluteFilePath( QString::fromUtf8("RenderServer_Test.ntp") );
+    {
+        QFile file(projectPath);
+        ASSERT_TRUE( file.open(QIODevice::WriteOnly) );
+        file.write("test");
+    }
+    QFileInfo info(projectPath);
+
+    CLArgs job = makeJobArgs( QStringList() << projectPath );
+    ASSERT_FALSE( job.getError() );
+
+    // What RenderServer::executeJob() records after loading the project
+    RenderServerLoadedProject loaded;
+    EXPECT_FALSE( loaded.canBeReusedBy(job) );
+    loaded.path = info.canonicalFilePath();
+    loaded.onLoadScript = job.getDefaultOnProjectLoadedScript();
+    loaded.lastModified = info.lastModified();
+    loaded.dirty = RenderServerLoadedProject::jobModifiesProject(job);
+    EXPECT_FALSE(loaded.dirty);
+    EXPECT_TRUE( loaded.canBeReusedBy(job) );
+
+    // Python commands run before the project is loaded: the project must be reloaded for them to run
+    CLArgs jobWithCommands = makeJobArgs( QStringList() << QString::fromUtf8("-c") << QString::fromUtf8("print(1)") << projectPath );
+    ASSERT_FALSE( jobWithCommands.getError() );
+    EXPECT_FALSE( loaded.canBeReusedBy(jobWithCommands) );
+    EXPECT_TRUE( RenderServerLoadedProject::jobModifiesProject(jobWithCommands) );
+
+    // A project modified by the previous job is reloaded
+    loaded.dirty = true;
+    EXPECT_FALSE( loaded.canBeReusedBy(job) );
+    loaded.dirty = false;
+
+    // So is a project file modified on disk
+    loaded.lastModified = info.lastModified().addSecs(-10);
+    EXPECT_FALSE( loaded.canBeReusedBy(job) );
+
+    QFile::remove(projectPath);
+}
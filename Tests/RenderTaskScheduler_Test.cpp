@@ -0,0 +1,163 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * Copyright (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <gtest/gtest.h>
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+
+#include "Engine/ParallelRenderArgs.h"
+#include "Engine/RenderTaskScheduler.h"
+
+NATRON_NAMESPACE_USING
+
+TEST(RenderTaskScheduler, ThreadCap)
+{
+    RenderTaskSlots slots;
+
+    EXPECT_FALSE( slots.mustWait(eRenderTaskClassBackground) ) << "No class is capped by default";
+    slots.nRunning[eRenderTaskClassBackground] = 8;
+    EXPECT_FALSE( slots.mustWait(eRenderTaskClassBackground) );
+
+    slots.maxThreads[eRenderTaskClassBackground] = 2;
+    EXPECT_TRUE( slots.isAtThreadCap(eRenderTaskClassBackground) );
+    EXPECT_TRUE( slots.mustWait(eRenderTaskClassBackground) );
+    EXPECT_FALSE( slots.mustWait(eRenderTaskClassPreview) ) << "Caps are per class";
+
+    slots.nRunning[eRenderTaskClassBackground] = 1;
+    EXPECT_FALSE( slots.mustWait(eRenderTaskClassBackground) );
+
+    slots.nRunning[eRenderTaskClassBackground] = 2;
+    slots.nWaitingForPendingImages = 1;
+    EXPECT_FALSE( slots.mustWait(eRenderTaskClassBackground) ) << "Tiles never wait while a render waits for a pending image";
+}
+
+TEST(RenderTaskScheduler, Priorities)
+{
+    RenderTaskSlots slots;
+
+    slots.nRunning[eRenderTaskClassInteractive] = 1;
+    EXPECT_FALSE( slots.mustWait(eRenderTaskClassBackground) ) << "Lower classes only wait when priorities are enabled";
+
+    slots.prioritiesEnabled = true;
+    EXPECT_TRUE( slots.mustWait(eRenderTaskClassBackground) );
+    EXPECT_FALSE( slots.mustWait(eRenderTaskClassInteractive) );
+
+    slots.nRunning[eRenderTaskClassInteractive] = 0;
+    slots.nWaiting[eRenderTaskClassPlayback] = 1;
+    EXPECT_TRUE( slots.mustWait(eRenderTaskClassPreview) ) << "Tiles also wait for the waiting tiles of a higher class";
+    EXPECT_FALSE( slots.mustWait(eRenderTaskClassInteractive) );
+
+    slots.nWaiting[eRenderTaskClassPlayback] = 0;
+    slots.nRunning[eRenderTaskClassPlayback] = 1;
+    slots.maxThreads[eRenderTaskClassPlayback] = 1;
+    EXPECT_FALSE( slots.mustWait(eRenderTaskClassPreview) ) << "A higher class at its thread cap cannot use more threads";
+
+    EXPECT_TRUE( slots.hasRunningTiles() );
+    slots.nRunning[eRenderTaskClassPlayback] = 0;
+    EXPECT_FALSE( slots.hasRunningTiles() );
+}
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+class TileThread
+    : public QThread
+{
+public:
+
+    TileThread()
+        : QThread()
+        , started(0)
+        , mustFinishMutex()
+        , mustFinishCond()
+        , mustFinish(false)
+    {
+    }
+
+    void finishTile()
+    {
+        QMutexLocker k(&mustFinishMutex);
+
+        mustFinish = true;
+        mustFinishCond.wakeAll();
+    }
+
+    // Set once the thread is allowed to render its tile
+    QAtomicInt started;
+
+private:
+
+    virtual void run() OVERRIDE FINAL
+    {
+        // No frame args: the tile is a background render
+        RenderTaskScheduler::TileScope tile( ParallelRenderArgsPtr() );
+
+        started.fetchAndStoreOrdered(1);
+        QMutexLocker k(&mustFinishMutex);
+        while (!mustFinish) {
+            mustFinishCond.wait(&mustFinishMutex);
+        }
+    }
+
+    QMutex mustFinishMutex;
+    QWaitCondition mustFinishCond;
+    bool mustFinish;
+};
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+TEST(RenderTaskScheduler, ThreadCapHoldsUnderLoad)
+{
+    RenderTaskScheduler::setMaxThreads(eRenderTaskClassBackground, 1);
+
+    TileThread first;
+    first.start();
+    while ( !first.started.fetchAndAddOrdered(0) ) {
+        QThread::yieldCurrentThread();
+    }
+
+    // The second tile must wait for the first one to end, however long it takes
+    TileThread second;
+    second.start();
+    second.wait(1500);
+    EXPECT_FALSE( second.started.fetchAndAddOrdered(0) );
+
+    first.finishTile();
+    first.wait();
+    while ( !second.started.fetchAndAddOrdered(0) ) {
+        QThread::yieldCurrentThread();
+    }
+    second.finishTile();
+    second.wait();
+
+    RenderTaskScheduler::setMaxThreads(eRenderTaskClassBackground, 0);
+
+    RenderTaskSchedulerStatistics stats = RenderTaskScheduler::getStatistics();
+    EXPECT_GE( stats.classes[eRenderTaskClassBackground].nDelayedTiles, (U64)1 );
+    EXPECT_GE( stats.classes[eRenderTaskClassBackground].maxWaitTime, 1.5 );
+}
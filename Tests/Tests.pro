@@ -43,9 +43,18 @@ SOURCES += \
     google-test/src/gtest-all.cc \
     google-mock/src/gmock-all.cc \
     BaseTest.cpp \
+    FileSystemModel_Test.cpp \
     Hash64_Test.cpp \
     Image_Test.cpp \
+    ImageBuffer_Test.cpp \
+    ImageBufferPool_Test.cpp \
+    KnobExpression_Test.cpp \
+    LRUHashTable_Test.cpp \
     Lut_Test.cpp \
+    NodeGraphSpatialIndex_Test.cpp \
+    PreviewThread_Test.cpp \
+    RenderServer_Test.cpp \
+    RenderTaskScheduler_Test.cpp \
     KnobFile_Test.cpp \
     Curve_Test.cpp \
     Tracker_Test.cpp \
@@ -0,0 +1,87 @@
+# -*- coding: utf-8 -*-
+# Compares two result files of the engine benchmark harness (NatronBenchmarks).
+#
+# Prints the relative change of every metric of every scenario and flags the changes that are worse
+# than the threshold: metrics ending in "PerSecond" or starting with "cacheHitRate" are better when
+# higher, the times, sizes and memory are better when lower. The metrics starting with "process" (e.g.
+# processPeakRSSBytes) are measured on the whole process so far and depend on the scenarios run before, they
+# are printed but never flagged. The exit status is 1 if any metric regressed.
+#
+# Usage:
+#     NatronBenchmarks --output baseline.json      (with the previous release)
+#     NatronBenchmarks --output current.json       (with the new build)
+#     python compare_engine_benchmarks.py baseline.json current.json [--threshold 10]
+
+from __future__ import print_function
+
+import json
+import sys
+
+
+def _higherIsBetter(metric):
+    return metric.endswith("PerSecond") or metric.startswith("cacheHitRate")
+
+
+def _isProcessWide(metric):
+    return metric.startswith("process")
+
+
+def _scenarios(results):
+    return dict((s["name"], s) for s in results.get("scenarios", []))
+
+
+def compareResults(baseline, current, threshold):
+    """Prints the comparison and returns the number of regressed metrics."""
+    regressions = 0
+    baseScenarios = _scenarios(baseline)
+    for name, scenario in sorted(_scenarios(current).items()):
+        base = baseScenarios.get(name)
+        if base is None:
+            print("%s: not in the baseline" % name)
+            continue
+        if not scenario.get("ok", False):
+            print("%s: FAILED: %s" % (name, scenario.get("error", "")))
+            regressions += 1
+            continue
+        if base.get("size") != scenario.get("size"):
+            print("%s: size changed from %s to %s, skipped" % (name, base.get("size"), scenario.get("size")))
+            continue
+        print(name)
+        baseMetrics = base.get("metrics", {})
+        for metric, value in sorted(scenario.get("metrics", {}).items()):
+            baseValue = baseMetrics.get(metric)
+            if value is None or baseValue is None or baseValue == 0:
+                continue
+            change = 100. * (value - baseValue) / abs(baseValue)
+            worse = -change if _higherIsBetter(metric) else change
+            flag = ""
+            if worse > threshold and not _isProcessWide(metric):
+                flag = "  <-- REGRESSION"
+                regressions += 1
+            print("  %-24s %14.6g -> %14.6g  %+7.1f%%%s" % (metric, baseValue, value, change, flag))
+    return regressions
+
+
+def main(argv):
+    args = [a for a in argv[1:]]
+    threshold = 10.
+    if "--threshold" in args:
+        i = args.index("--threshold")
+        threshold = float(args[i + 1])
+        del args[i:i + 2]
+    if len(args) != 2:
+        print("Usage: %s baseline.json current.json [--threshold percent]" % argv[0])
+        return 2
+    with open(args[0]) as f:
+        baseline = json.load(f)
+    with open(args[1]) as f:
+        current = json.load(f)
+    print("Baseline: %s (%s), current: %s (%s), threshold %g%%"
+          % (baseline.get("version"), baseline.get("gitCommit"), current.get("version"), current.get("gitCommit"), threshold))
+    regressions = compareResults(baseline, current, threshold)
+    print("%d regression(s)" % regressions)
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,78 @@
+# -*- coding: utf-8 -*-
+# Dope Sheet drawing benchmark.
+#
+# Creates nodes with many animated parameters (numNodes x numParams rows of numKeys keyframes each,
+# like trackers keyed at every frame), then repaints the Dope Sheet and prints the frame times,
+# both at the current zoom and once the view is fitted to the whole animation.
+# Only the nodes whose settings panel is opened are displayed in the Dope Sheet: numNodes should not
+# exceed the "Maximum number of open settings panels" preference.
+#
+# Usage, from the Script Editor of Natron, with the Dope Sheet visible:
+#     execfile("/path/to/Natron/tools/benchmarks/dopesheet_keyframes.py")
+#     runDopeSheetBenchmark(app1, numNodes=8, numParams=25, numKeys=5000, numFrames=100)
+
+from __future__ import print_function
+
+import math
+import time
+
+from PySide import QtCore, QtGui
+
+NOOP_ID = "net.sf.openfx.NoOpPlugin"
+
+
+def createBenchmarkNodes(app, numNodes, numParams, numKeys):
+    """Creates numNodes NoOp nodes, each with numParams user parameters animated with numKeys keyframes."""
+    times = [float(t) for t in range(1, numKeys + 1)]
+    for n in range(numNodes):
+        node = app.createNode(NOOP_ID)
+        for p in range(numParams):
+            param = node.createDoubleParam("benchParam%d" % p, "Bench Param %d" % p)
+            values = [math.sin(0.01 * t + p) for t in times]
+            param.setKeyFrames(times, values)
+        node.refreshUserParamsGUI()
+
+
+def findDopeSheetView():
+    for widget in QtGui.QApplication.allWidgets():
+        if widget.metaObject().className().endswith("DopeSheetView") and widget.isVisible():
+            return widget
+    return None
+
+
+def measureRepaint(view, numFrames):
+    """Repaints the view and returns the list of frame times in milliseconds."""
+    frameTimes = []
+    for i in range(numFrames):
+        start = time.time()
+        view.repaint()
+        frameTimes.append((time.time() - start) * 1000.)
+    return frameTimes
+
+
+def _report(label, frameTimes):
+    times = sorted(frameTimes)
+    n = len(times)
+    mean = sum(times) / n
+    print("%s: %d frames, mean %.2f ms (%.1f fps), median %.2f ms, p95 %.2f ms, max %.2f ms"
+          % (label, n, mean, 1000. / mean if mean > 0 else 0., times[n // 2], times[min(n - 1, int(n * 0.95))], times[-1]))
+
+
+def runDopeSheetBenchmark(app, numNodes=8, numParams=25, numKeys=5000, numFrames=100):
+    start = time.time()
+    createBenchmarkNodes(app, numNodes, numParams, numKeys)
+    print("Created %d rows of %d keyframes in %.2f s" % (numNodes * numParams, numKeys, time.time() - start))
+
+    view = findDopeSheetView()
+    if view is None:
+        print("Could not find the Dope Sheet, is it visible?")
+        return
+    QtGui.QApplication.processEvents()
+
+    _report("Current zoom", measureRepaint(view, numFrames))
+
+    # Frame the whole animation: all the keyframes are in the visible range
+    view.setFocus()
+    QtGui.QApplication.sendEvent(view, QtGui.QKeyEvent(QtCore.QEvent.KeyPress, QtCore.Qt.Key_F, QtCore.Qt.NoModifier))
+    QtGui.QApplication.processEvents()
+    _report("Fitted", measureRepaint(view, numFrames))
@@ -0,0 +1,101 @@
+# -*- coding: utf-8 -*-
+# NodeGraph panning benchmark.
+#
+# Creates a synthetic graph of N nodes (chains of Dots, with a Backdrop every 100 nodes),
+# then pans the Node Graph with simulated middle-button drags and prints the frame times,
+# both at the default zoom and at a zoom level where the graph is drawn in low detail mode.
+#
+# Usage, from the Script Editor of Natron:
+#     execfile("/path/to/Natron/tools/benchmarks/nodegraph_panning.py")
+#     runNodeGraphPanningBenchmark(app1, numNodes=2000, numFrames=200)
+# The generated graph can be saved with app1.saveProjectAs("/tmp/nodegraph_2000.ntp")
+# to compare several builds on the same project.
+
+from __future__ import print_function
+
+import time
+
+from PySide import QtCore, QtGui
+
+DOT_ID = "fr.inria.built-in.Dot"
+BACKDROP_ID = "fr.inria.built-in.BackDrop"
+
+
+def createBenchmarkGraph(app, numNodes, columns=40, spacingX=200, spacingY=120, chainLength=20):
+    """Creates numNodes Dots on a grid. Each column is made of chains of chainLength connected Dots."""
+    previous = None
+    for i in range(numNodes):
+        col = i % columns
+        row = i // columns
+        node = app.createNode(DOT_ID)
+        node.setPosition(col * spacingX, row * spacingY)
+        if previous is not None and (i % chainLength) != 0:
+            node.connectInput(0, previous)
+        previous = node
+        if (i % 100) == 0:
+            backdrop = app.createNode(BACKDROP_ID)
+            backdrop.setPosition(col * spacingX - 50, row * spacingY - 50)
+            backdrop.setSize(4 * spacingX, 2 * spacingY)
+
+
+def findNodeGraphView():
+    """Returns the QGraphicsView of the main Node Graph, i.e. the one with the most items."""
+    best = None
+    for widget in QtGui.QApplication.allWidgets():
+        if isinstance(widget, QtGui.QGraphicsView) and widget.scene() is not None and widget.isVisible():
+            if best is None or len(widget.scene().items()) > len(best.scene().items()):
+                best = widget
+    return best
+
+
+def _sendMouse(viewport, eventType, pos, buttons):
+    button = QtCore.Qt.MiddleButton if eventType != QtCore.QEvent.MouseMove else QtCore.Qt.NoButton
+    event = QtGui.QMouseEvent(eventType, pos, button, buttons, QtCore.Qt.NoModifier)
+    QtGui.QApplication.sendEvent(viewport, event)
+
+
+def measurePanning(view, numFrames, stepPx=8):
+    """Pans the view back and forth and returns the list of frame times in milliseconds."""
+    viewport = view.viewport()
+    center = viewport.rect().center()
+    _sendMouse(viewport, QtCore.QEvent.MouseButtonPress, center, QtCore.Qt.MiddleButton)
+    pos = QtCore.QPoint(center)
+    frameTimes = []
+    for i in range(numFrames):
+        direction = 1 if (i // 50) % 2 == 0 else -1
+        pos = QtCore.QPoint(pos.x() + direction * stepPx, pos.y() + direction * stepPx // 2)
+        start = time.time()
+        _sendMouse(viewport, QtCore.QEvent.MouseMove, pos, QtCore.Qt.MiddleButton)
+        viewport.repaint()
+        frameTimes.append((time.time() - start) * 1000.)
+    _sendMouse(viewport, QtCore.QEvent.MouseButtonRelease, pos, QtCore.Qt.NoButton)
+    return frameTimes
+
+
+def _report(label, frameTimes):
+    times = sorted(frameTimes)
+    n = len(times)
+    mean = sum(times) / n
+    print("%s: %d frames, mean %.2f ms, median %.2f ms, p95 %.2f ms, max %.2f ms"
+          % (label, n, mean, times[n // 2], times[min(n - 1, int(n * 0.95))], times[-1]))
+
+
+def runNodeGraphPanningBenchmark(app, numNodes=2000, numFrames=200):
+    start = time.time()
+    createBenchmarkGraph(app, numNodes)
+    print("Created %d nodes in %.2f s" % (numNodes, time.time() - start))
+
+    view = findNodeGraphView()
+    if view is None:
+        print("Could not find the Node Graph, is the GUI visible?")
+        return
+    QtGui.QApplication.processEvents()
+
+    view.resetTransform()
+    view.scale(0.8, 0.8)
+    _report("Default zoom", measurePanning(view, numFrames))
+
+    # Zoom out below the low detail threshold of the Node Graph
+    view.scale(0.25, 0.25)
+    _report("Zoomed out", measurePanning(view, numFrames))
+    view.scale(4., 4.)
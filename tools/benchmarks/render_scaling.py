@@ -0,0 +1,99 @@
+# -*- coding: utf-8 -*-
+# Render scaling benchmark.
+#
+# Builds a canned comp (CheckerBoard -> Blur -> Transform -> Write), then renders the same frame range
+# with an increasing number of render threads, with and without NUMA-aware rendering, and prints the
+# render times, the speedup relative to one thread and the parallel efficiency.
+# The NUMA-aware runs are only meaningful on machines with several NUMA nodes (multi-socket).
+#
+# Usage, with the command-line renderer:
+#     NatronRenderer -t /path/to/Natron/tools/benchmarks/render_scaling.py
+# or from the Script Editor of Natron:
+#     execfile("/path/to/Natron/tools/benchmarks/render_scaling.py")
+#     runRenderScalingBenchmark(app1, firstFrame=1, lastFrame=48)
+
+from __future__ import print_function
+
+import multiprocessing
+import os
+import tempfile
+import time
+
+import NatronEngine
+
+CHECKERBOARD_ID = "net.sf.openfx.CheckerBoardPlugin"
+BLUR_ID = "net.sf.cimg.CImgBlur"
+TRANSFORM_ID = "net.sf.openfx.TransformPlugin"
+WRITE_ID = "fr.inria.built-in.Write"
+
+
+def createBenchmarkComp(app, outputPattern):
+    """Creates the comp in the project format and returns the Write and Blur nodes.
+    The blur and the animated rotation make every frame expensive."""
+    checker = app.createNode(CHECKERBOARD_ID)
+
+    blur = app.createNode(BLUR_ID)
+    blur.connectInput(0, checker)
+    blur.getParam("size").set(40., 40.)
+
+    transform = app.createNode(TRANSFORM_ID)
+    transform.connectInput(0, blur)
+    rotate = transform.getParam("rotate")
+    rotate.setValueAtTime(0., 1)
+    rotate.setValueAtTime(360., 1000)
+
+    writer = app.createNode(WRITE_ID)
+    writer.connectInput(0, transform)
+    writer.getParam("filename").set(outputPattern)
+    return writer, blur
+
+
+def _threadCounts(maxThreads):
+    counts = []
+    n = 1
+    while n < maxThreads:
+        counts.append(n)
+        n *= 2
+    counts.append(maxThreads)
+    return counts
+
+
+def runRenderScalingBenchmark(app, firstFrame=1, lastFrame=24, maxThreads=None):
+    if maxThreads is None:
+        maxThreads = multiprocessing.cpu_count()
+    settings = NatronEngine.natron.getSettings()
+    outputDir = tempfile.mkdtemp(prefix="render_scaling_")
+    writer, blur = createBenchmarkComp(app, os.path.join(outputDir, "frame_####.exr"))
+
+    numThreadsParam = settings.getParam("noRenderThreads")
+    numaParam = settings.getParam("numaAwareRendering")
+    savedThreads = numThreadsParam.get()
+    savedNuma = numaParam.get()
+
+    run = 0
+    try:
+        for numa in (False, True):
+            numaParam.set(numa)
+            reference = None
+            print("NUMA-aware rendering: %s" % ("on" if numa else "off"))
+            for n in _threadCounts(maxThreads):
+                numThreadsParam.set(n)
+                # Change the blur slightly so that nothing is read back from the cache of the previous run
+                run += 1
+                blur.getParam("size").set(40. + run * 1e-3, 40.)
+                start = time.time()
+                app.render(writer, firstFrame, lastFrame)
+                elapsed = time.time() - start
+                if reference is None:
+                    reference = elapsed * n
+                speedup = reference / elapsed
+                print("  %3d threads: %7.2f s, %6.2f fps, speedup %5.2f, efficiency %3.0f%%"
+                      % (n, elapsed, (lastFrame - firstFrame + 1) / elapsed, speedup, 100. * speedup / n))
+    finally:
+        numThreadsParam.set(savedThreads)
+        numaParam.set(savedNuma)
+
+
+if NatronEngine.natron.isBackground():
+    # Started with NatronRenderer -t
+    runRenderScalingBenchmark(app)